@@ -2,7 +2,7 @@
 
 if [[ $# -ne 2 ]];
 then
-	echo "Usage: build-library <clang/gcc> <dynamic/static>"
+	echo "Usage: build-library <clang/gcc> <dynamic/static/lto>"
 	exit 1
 fi
 
@@ -19,7 +19,7 @@ then
 	cd ..
 	mv src/containers.so containers.so
 	echo "Now, you can copy-paste containers.h and containers.so to any project that you would like to use the dynamic library with."
-	echo "Afterwards, your project can be compiled with: $1 test.c -o test containers.so -ldl"
+	echo "Afterwards, your project can be compiled with: $1 test.c -o test containers.so -ldl -lpthread"
 elif [[ $2 == "static" ]];
 then
 	cd src
@@ -29,8 +29,23 @@ then
 	cd ..
 	mv src/containers.a containers.a
 	echo "Now, you can copy-paste containers.h and containers.a to any project that you would like to use the static library with."
-	echo "Afterwards, your project can be compiled with: $1 test.c -o test containers.a -ldl"
+	echo "Afterwards, your project can be compiled with: $1 test.c -o test containers.a -ldl -lpthread"
+elif [[ $2 == "lto" ]];
+then
+	archiver="gcc-ar"
+	if [[ $1 == "clang" ]];
+	then
+		archiver="llvm-ar"
+	fi
+	cd src
+	"$1" *.c -c -O3 -fpic -flto
+	"$archiver" rcs containers.a *.o
+	rm *.o
+	cd ..
+	mv src/containers.a containers.a
+	echo "Now, you can copy-paste containers.h and containers.a to any project that you would like to use the link-time optimized static library with."
+	echo "Afterwards, your project can be compiled with: $1 -O3 -flto test.c -o test containers.a -ldl -lpthread"
 else
-	echo "Must either be dynamic or static"
+	echo "Must either be dynamic, static, or lto"
 	exit 1
 fi
@@ -4,15 +4,24 @@ header_name="./containers.h"
 IFS=''
 first="1"
 
-find ./src -type f -name "*.h" | while read header;
+# The files are visited in a fixed order, so that the header only changes when
+# the sources do.
+export LC_ALL=C
+
+find ./src -type f -name "*.h" | sort | while read -r header;
 do
 	ignore="1"
 	if [[ $first == "1" ]];
 	then
 		first="0"
 		cp "./src/include/VERSION" "$header_name"
+		echo "" >> "$header_name"
+		echo "#if defined(CONTAINERS_IMPLEMENTATION) && !defined(_GNU_SOURCE)" \
+			>> "$header_name"
+		echo "#define _GNU_SOURCE" >> "$header_name"
+		echo "#endif" >> "$header_name"
 	fi
-	while read line;
+	while read -r line;
 	do
 		if [[ $ignore == "0" ]];
 		then
@@ -24,3 +33,79 @@ do
 		fi
 	done < "$header"
 done
+
+# Prints the names of the static functions which a source defines, whether the
+# name is on the same line as the return type or on the line after it.
+static_functions() {
+	awk '
+		/^static / && !/[;=]/ {
+			line = $0
+			if (!index(line, "(")) {
+				getline line
+			}
+			sub(/\(.*/, "", line)
+			sub(/.*[ *]/, "", line)
+			print line
+		}
+	' "$1"
+}
+
+# Matches the definition of a private constant object, and captures its name.
+# Only a name and an optional array size may come before the initializer, so
+# functions returning a const type, which have a parenthesis, never match.
+constant="^static const [a-z_ ]+[ *]+([A-Za-z_][A-Za-z0-9_]*)(\[[^]]*\])? ="
+
+# The static functions which are defined in more than one source.
+clashes=$(for source in ./src/*.c;
+do
+	static_functions "$source" | sort -u
+done | sort | uniq -d)
+
+# The sources follow the declarations, and are only compiled in the translation
+# unit which defines CONTAINERS_IMPLEMENTATION. Each source has its own private
+# struct tags and constants, and may have static functions with the same names
+# as those of another source. These are renamed with the name of the source so
+# that they do not clash with those of the other sources.
+echo "" >> "$header_name"
+echo "#ifdef CONTAINERS_IMPLEMENTATION" >> "$header_name"
+for source in ./src/*.c;
+do
+	prefix=$(basename "$source" .c)
+	names=$( (grep "^struct [a-z_]* {" "$source" \
+			| sed 's/^struct \([a-z_]*\) {$/\1/' | grep -v "^internal_";
+		grep -E "$constant" "$source" | sed -E "s/$constant.*/\\1/";
+		static_functions "$source" | grep -Fx "$clashes") \
+		| sort -u | tr '\n' ' ')
+	awk -v prefix="$prefix" -v names="$names" '
+		BEGIN {
+			count = split(names, list, " ")
+			state = 0
+		}
+		state == 0 {
+			if (index($0, "*/")) {
+				state = 1
+				print ""
+			}
+			next
+		}
+		/^#include "/ {
+			next
+		}
+		state == 1 && /^(static|struct|typedef|int|void|unsigned)/ {
+			for (i = 1; i <= count; i++) {
+				print "#define " list[i] " " prefix "_" list[i]
+			}
+			state = 2
+		}
+		{
+			print
+		}
+		END {
+			for (i = 1; i <= count; i++) {
+				print "#undef " list[i]
+			}
+		}
+	' "$source" >> "$header_name"
+done
+echo "" >> "$header_name"
+echo "#endif /* CONTAINERS_IMPLEMENTATION */" >> "$header_name"
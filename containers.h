@@ -26,186 +26,1605 @@
  * This local version is: v1.1.1
  */
 
+#if defined(CONTAINERS_IMPLEMENTATION) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 
-#ifndef CONTAINERS_UNORDERED_MAP_H
-#define CONTAINERS_UNORDERED_MAP_H
+
+#ifndef CONTAINERS_ARRAY_H
+#define CONTAINERS_ARRAY_H
 
 #include <stdlib.h>
 
 /**
- * The unordered_map data structure, which is a collection of key-value pairs,
- * hashed by keys, keys are unique
+ * The array data structure, which is a static contiguous array.
  */
-typedef struct internal_unordered_map *unordered_map;
+typedef struct internal_array *array;
+
+/* Flags for mapped storage */
+#define ARRAY_HUGE_PAGES 0x1
+#define ARRAY_READ_ONLY 0x2
+#define ARRAY_CREATE 0x4
 
 /* Starting */
-unordered_map unordered_map_init(size_t key_size,
-                                 size_t value_size,
-                                 unsigned long (*hash)(const void *const key),
-                                 int (*comparator)(const void *const one,
-                                                   const void *const two));
+array array_init(int element_count, size_t data_size);
+array array_init_mapped(int element_count, size_t data_size, int flags);
+array array_open_mapped(const char *path,
+                        int element_count,
+                        size_t data_size,
+                        int flags);
 
 /* Utility */
-int unordered_map_rehash(unordered_map me);
-int unordered_map_size(unordered_map me);
-int unordered_map_is_empty(unordered_map me);
+int array_size(array me);
+void array_copy_to_array(void *arr, array me);
+void *array_get_data(array me);
+int array_sync(array me);
+void array_sort(array me,
+                int (*comparator)(const void *const one,
+                                  const void *const two));
+int array_lower_bound(array me,
+                      void *key,
+                      int (*comparator)(const void *const one,
+                                        const void *const two));
+int array_eytzinger_layout(array me);
+int array_eytzinger_lower_bound(array me,
+                                void *key,
+                                int (*comparator)(const void *const one,
+                                                  const void *const two));
 
 /* Accessing */
-int unordered_map_put(unordered_map me, void *key, void *value);
-int unordered_map_get(void *value, unordered_map me, void *key);
-int unordered_map_contains(unordered_map me, void *key);
-int unordered_map_remove(unordered_map me, void *key);
+int array_set(array me, int index, void *data);
+int array_get(void *data, array me, int index);
 
 /* Ending */
-int unordered_map_clear(unordered_map me);
-unordered_map unordered_map_destroy(unordered_map me);
+array array_destroy(array me);
 
-#endif /* CONTAINERS_UNORDERED_MAP_H */
+#endif /* CONTAINERS_ARRAY_H */
 
 
-#ifndef CONTAINERS_MAP_H
-#define CONTAINERS_MAP_H
+#ifndef CONTAINERS_COMPARE_H
+#define CONTAINERS_COMPARE_H
+
+/*
+ * Built-in comparators, which can be passed as the key comparator of the set,
+ * map, multi-set, multi-map, and unordered containers. The containers recognize
+ * them, and compare the keys inline rather than through the function pointer
+ * when the key size matches the type. The scalar comparators also select a
+ * radix sort in containers_sort. containers_compare_key is not a function, but
+ * a marker for comparing all the bytes of the key, since the key size is only
+ * known to the container. Like SIG_IGN, it must not be called.
+ */
+
+/* Comparing */
+int containers_compare_int(const void *one, const void *two);
+int containers_compare_long(const void *one, const void *two);
+int containers_compare_uint(const void *one, const void *two);
+int containers_compare_ulong(const void *one, const void *two);
+int containers_compare_float(const void *one, const void *two);
+int containers_compare_double(const void *one, const void *two);
+
+#define containers_compare_key ((int (*)(const void *, const void *)) 1)
+
+#endif /* CONTAINERS_COMPARE_H */
+
+
+#ifndef CONTAINERS_COMPARE_INLINE_H
+#define CONTAINERS_COMPARE_INLINE_H
+
+#include <string.h>
+
+/*
+ * Internal to the library. Inline dispatch of the built-in comparators from
+ * compare.h, which must be included before these are used. Each container and
+ * algorithm which accepts a comparator compares through these macros, so that
+ * the built-in comparators are recognized in one place.
+ */
+
+/*
+ * Compares the scalars of type T which one and two point to.
+ */
+#define CONTAINERS_COMPARE_AS(T, one, two)                                    \
+    ((*(const T *) (one) > *(const T *) (two))                                \
+     - (*(const T *) (one) < *(const T *) (two)))
+
+/*
+ * Compares two elements of the given size. The built-in scalar comparators are
+ * inlined rather than called through the function pointer when they match the
+ * size, and the containers_compare_key marker, which is not callable, compares
+ * all the bytes of the elements. Any other comparator is called.
+ */
+#define CONTAINERS_COMPARE(comparator, size, one, two)                        \
+    ((comparator) == containers_compare_int && (size) == sizeof(int)          \
+     ? CONTAINERS_COMPARE_AS(int, one, two)                                   \
+     : (comparator) == containers_compare_long && (size) == sizeof(long)      \
+     ? CONTAINERS_COMPARE_AS(long, one, two)                                  \
+     : (comparator) == containers_compare_uint                                \
+       && (size) == sizeof(unsigned int)                                      \
+     ? CONTAINERS_COMPARE_AS(unsigned int, one, two)                          \
+     : (comparator) == containers_compare_ulong                               \
+       && (size) == sizeof(unsigned long)                                     \
+     ? CONTAINERS_COMPARE_AS(unsigned long, one, two)                         \
+     : (comparator) == containers_compare_key                                 \
+     ? memcmp(one, two, size)                                                 \
+     : (comparator)(one, two))
+
+/*
+ * Determines whether the comparator considers two elements of the given size
+ * to be equal exactly when their bytes are equal, which is the case for the
+ * built-in comparators other than those of floating point numbers, as long as
+ * the scalar comparators match the size.
+ */
+#define CONTAINERS_COMPARE_IS_BYTEWISE(comparator, size)                      \
+    (((comparator) == containers_compare_int && (size) == sizeof(int))        \
+     || ((comparator) == containers_compare_long && (size) == sizeof(long))   \
+     || ((comparator) == containers_compare_uint                              \
+         && (size) == sizeof(unsigned int))                                   \
+     || ((comparator) == containers_compare_ulong                             \
+         && (size) == sizeof(unsigned long))                                  \
+     || (comparator) == containers_compare_key)
+
+#endif /* CONTAINERS_COMPARE_INLINE_H */
+
+
+#ifndef CONTAINERS_DEQUE_H
+#define CONTAINERS_DEQUE_H
 
 #include <stdlib.h>
 
 /**
- * The map data structure, which is a collection of key-value pairs, sorted by
- * keys, keys are unique.
+ * The deque data structure, which is a doubly-ended queue.
  */
-typedef struct internal_map *map;
+typedef struct internal_deque *deque;
 
 /* Starting */
-map map_init(size_t key_size,
-             size_t value_size,
-             int (*comparator)(const void *const one, const void *const two));
+deque deque_init(size_t data_size);
 
-/* Capacity */
-int map_size(map me);
-int map_is_empty(map me);
+/* Utility */
+int deque_size(deque me);
+int deque_is_empty(deque me);
+int deque_trim(deque me);
+void deque_copy_to_array(void *arr, deque me);
+int deque_sort(deque me,
+               int (*comparator)(const void *const one, const void *const two));
 
-/* Accessing */
-int map_put(map me, void *key, void *value);
-int map_get(void *value, map me, void *key);
-int map_contains(map me, void *key);
-int map_remove(map me, void *key);
+/* Adding */
+int deque_push_front(deque me, void *data);
+int deque_push_back(deque me, void *data);
+
+/* Removing */
+int deque_pop_front(void *data, deque me);
+int deque_pop_back(void *data, deque me);
+
+/* Setting */
+int deque_set_first(deque me, void *data);
+int deque_set_at(deque me, int index, void *data);
+int deque_set_last(deque me, void *data);
+
+/* Getting */
+int deque_get_first(void *data, deque me);
+int deque_get_at(void *data, deque me, int index);
+int deque_get_last(void *data, deque me);
+void *deque_get_ref_at(deque me, int index);
+int deque_for_each_block(deque me,
+                         int (*callback)(void *data, int count, void *context),
+                         void *context);
 
 /* Ending */
-void map_clear(map me);
-map map_destroy(map me);
+int deque_clear(deque me);
+deque deque_destroy(deque me);
 
-#endif /* CONTAINERS_MAP_H */
+#endif /* CONTAINERS_DEQUE_H */
 
 
-#ifndef CONTAINERS_UNORDERED_MULTISET_H
-#define CONTAINERS_UNORDERED_MULTISET_H
+#ifndef CONTAINERS_FLAT_MAP_H
+#define CONTAINERS_FLAT_MAP_H
 
 #include <stdlib.h>
 
 /**
- * The unordered_multiset data structure, which is a collection of keys, hashed
- * by keys.
+ * The flat_map data structure, which is a collection of key-value pairs with
+ * unique keys, kept sorted in contiguous storage.
  */
-typedef struct internal_unordered_multiset *unordered_multiset;
+typedef struct internal_flat_map *flat_map;
 
 /* Starting */
-unordered_multiset
-unordered_multiset_init(size_t key_size,
-                        unsigned long (*hash)(const void *const key),
-                        int (*comparator)(const void *const one,
-                                          const void *const two));
+flat_map flat_map_init(size_t key_size,
+                       size_t value_size,
+                       int (*comparator)(const void *const one,
+                                         const void *const two));
+
+/* Capacity */
+int flat_map_size(flat_map me);
+int flat_map_is_empty(flat_map me);
+int flat_map_reserve(flat_map me, int size);
 
 /* Utility */
-int unordered_multiset_rehash(unordered_multiset me);
-int unordered_multiset_size(unordered_multiset me);
-int unordered_multiset_is_empty(unordered_multiset me);
+void *flat_map_get_keys(flat_map me);
+void *flat_map_get_values(flat_map me);
+int flat_map_put_all(flat_map me, void *keys, void *values, int count);
+int flat_map_assign(flat_map me, void *keys, void *values, int count);
 
 /* Accessing */
-int unordered_multiset_put(unordered_multiset me, void *key);
-int unordered_multiset_count(unordered_multiset me, void *key);
-int unordered_multiset_contains(unordered_multiset me, void *key);
-int unordered_multiset_remove(unordered_multiset me, void *key);
-int unordered_multiset_remove_all(unordered_multiset me, void *key);
+int flat_map_put(flat_map me, void *key, void *value);
+int flat_map_get(void *value, flat_map me, void *key);
+int flat_map_contains(flat_map me, void *key);
+int flat_map_lower_bound(flat_map me, void *key);
+int flat_map_get_at(void *key, void *value, flat_map me, int index);
+int flat_map_remove(flat_map me, void *key);
 
 /* Ending */
-int unordered_multiset_clear(unordered_multiset me);
-unordered_multiset unordered_multiset_destroy(unordered_multiset me);
+int flat_map_clear(flat_map me);
+flat_map flat_map_destroy(flat_map me);
 
-#endif /* CONTAINERS_UNORDERED_MULTISET_H */
+#endif /* CONTAINERS_FLAT_MAP_H */
 
 
-#ifndef CONTAINERS_MULTIMAP_H
-#define CONTAINERS_MULTIMAP_H
+#ifndef CONTAINERS_FLAT_SET_H
+#define CONTAINERS_FLAT_SET_H
 
 #include <stdlib.h>
 
 /**
- * The multimap data structure, which is a collection of key-value pairs, sorted
- * by keys.
+ * The flat_set data structure, which is a collection of unique keys, kept
+ * sorted in contiguous storage.
  */
-typedef struct internal_multimap *multimap;
+typedef struct internal_flat_set *flat_set;
 
 /* Starting */
-multimap multimap_init(size_t key_size,
-                       size_t value_size,
-                       int (*key_comparator)(const void *const one,
-                                             const void *const two),
-                       int (*value_comparator)(const void *const one,
-                                               const void *const two));
+flat_set flat_set_init(size_t key_size,
+                       int (*comparator)(const void *const one,
+                                         const void *const two));
 
 /* Capacity */
-int multimap_size(multimap me);
-int multimap_is_empty(multimap me);
+int flat_set_size(flat_set me);
+int flat_set_is_empty(flat_set me);
+int flat_set_reserve(flat_set me, int size);
+
+/* Utility */
+void *flat_set_get_data(flat_set me);
+int flat_set_put_all(flat_set me, void *keys, int count);
+int flat_set_assign(flat_set me, void *keys, int count);
 
 /* Accessing */
-int multimap_put(multimap me, void *key, void *value);
-void multimap_get_start(multimap me, void *key);
-int multimap_get_next(void *value, multimap me);
-int multimap_count(multimap me, void *key);
-int multimap_contains(multimap me, void *key);
-int multimap_remove(multimap me, void *key, void *value);
-int multimap_remove_all(multimap me, void *key);
+int flat_set_put(flat_set me, void *key);
+int flat_set_contains(flat_set me, void *key);
+int flat_set_lower_bound(flat_set me, void *key);
+int flat_set_get_at(void *key, flat_set me, int index);
+int flat_set_remove(flat_set me, void *key);
 
 /* Ending */
-void multimap_clear(multimap me);
-multimap multimap_destroy(multimap me);
+int flat_set_clear(flat_set me);
+flat_set flat_set_destroy(flat_set me);
 
-#endif /* CONTAINERS_MULTIMAP_H */
+#endif /* CONTAINERS_FLAT_SET_H */
 
 
-#ifndef CONTAINERS_PRIORITY_QUEUE_H
-#define CONTAINERS_PRIORITY_QUEUE_H
+#ifndef CONTAINERS_FORWARD_LIST_H
+#define CONTAINERS_FORWARD_LIST_H
 
 #include <stdlib.h>
 
 /**
- * The priority_queue data structure, which adapts a container to provide a
- * priority queue. Adapts the vector container.
+ * The forward_list data structure, which is a singly-linked list.
  */
-typedef struct internal_priority_queue *priority_queue;
+typedef struct internal_forward_list *forward_list;
+
+/**
+ * A position in a singly-linked list, which is owned by the caller. Its members
+ * are internal and should not be used directly.
+ */
+struct forward_list_cursor {
+    void *internal_prev;
+    void *internal_node;
+    int internal_index;
+};
 
 /* Starting */
-priority_queue priority_queue_init(size_t data_size,
-                                   int (*comparator)(const void *const one,
-                                                     const void *const two));
+forward_list forward_list_init(size_t data_size);
 
 /* Utility */
-int priority_queue_size(priority_queue me);
-int priority_queue_is_empty(priority_queue me);
+int forward_list_size(forward_list me);
+int forward_list_is_empty(forward_list me);
+void forward_list_copy_to_array(void *arr, forward_list me);
 
 /* Adding */
-int priority_queue_push(priority_queue me, void *data);
+int forward_list_add_first(forward_list me, void *data);
+int forward_list_add_at(forward_list me, int index, void *data);
+int forward_list_add_last(forward_list me, void *data);
 
 /* Removing */
-int priority_queue_pop(void *data, priority_queue me);
+int forward_list_remove_first(forward_list me);
+int forward_list_remove_at(forward_list me, int index);
+int forward_list_remove_last(forward_list me);
+
+/* Setting */
+int forward_list_set_first(forward_list me, void *data);
+int forward_list_set_at(forward_list me, int index, void *data);
+int forward_list_set_last(forward_list me, void *data);
 
 /* Getting */
-int priority_queue_front(void *data, priority_queue me);
+int forward_list_get_first(void *data, forward_list me);
+int forward_list_get_at(void *data, forward_list me, int index);
+int forward_list_get_last(void *data, forward_list me);
+
+/* Cursors */
+int forward_list_cursor_first(forward_list me,
+                              struct forward_list_cursor *cursor);
+int forward_list_cursor_next(forward_list me,
+                             struct forward_list_cursor *cursor);
+int forward_list_cursor_index(const struct forward_list_cursor *cursor);
+int forward_list_cursor_get(void *data,
+                            forward_list me,
+                            const struct forward_list_cursor *cursor);
+int forward_list_cursor_set(forward_list me,
+                            const struct forward_list_cursor *cursor,
+                            void *data);
+int forward_list_cursor_add_before(forward_list me,
+                                   struct forward_list_cursor *cursor,
+                                   void *data);
+int forward_list_cursor_add_after(forward_list me,
+                                  struct forward_list_cursor *cursor,
+                                  void *data);
+int forward_list_cursor_remove(forward_list me,
+                               struct forward_list_cursor *cursor);
 
 /* Ending */
-int priority_queue_clear(priority_queue me);
-priority_queue priority_queue_destroy(priority_queue me);
+void forward_list_clear(forward_list me);
+forward_list forward_list_destroy(forward_list me);
 
-#endif /* CONTAINERS_PRIORITY_QUEUE_H */
+#endif /* CONTAINERS_FORWARD_LIST_H */
+
+
+#ifndef CONTAINERS_GENERIC_H
+#define CONTAINERS_GENERIC_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+ * Generators of type-specialized containers. Each generator defines a handle
+ * type called name, and static functions prefixed by name which behave like
+ * the functions of the matching generic container, except that the elements
+ * are passed and returned by value. Since the element types and the hash and
+ * comparison functions are known at compile-time, the compiler can inline
+ * them. Each generator should be used at most once per name in a translation
+ * unit, and the functions which are not used are not emitted.
+ */
+
+#if defined(__GNUC__)
+#define CONTAINERS_GENERIC_API static __attribute__((unused))
+#else
+#define CONTAINERS_GENERIC_API static
+#endif
+
+#define CONTAINERS_GENERIC_START 8
+
+/**
+ * Defines a vector of T called name, which is a dynamic contiguous array. The
+ * functions are init, size, is_empty, reserve, get_data, add_at, add_last,
+ * remove_at, remove_last, set_at, get_at, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_VECTOR(name, T)                                     \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    T *data;                                                                  \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->data = malloc(CONTAINERS_GENERIC_START * sizeof(T));                \
+    if (!init->data) {                                                        \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_reserve(name me, const int size)            \
+{                                                                             \
+    T *temp;                                                                  \
+    if (size <= me->capacity) {                                               \
+        return 0;                                                             \
+    }                                                                         \
+    temp = realloc(me->data, (size_t) size * sizeof(T));                      \
+    if (!temp) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    me->data = temp;                                                          \
+    me->capacity = size;                                                      \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API T *name##_get_data(name me)                            \
+{                                                                             \
+    return me->data;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_add_at(name me, const int index, T data)    \
+{                                                                             \
+    if (index < 0 || index > me->size) {                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_reserve(me, me->capacity + me->capacity / 2);   \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    memmove(me->data + index + 1, me->data + index,                           \
+            (size_t) (me->size - index) * sizeof(T));                         \
+    me->data[index] = data;                                                   \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_add_last(name me, T data)                   \
+{                                                                             \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_reserve(me, me->capacity + me->capacity / 2);   \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    me->data[me->size] = data;                                                \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove_at(name me, const int index)         \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->size--;                                                               \
+    memmove(me->data + index, me->data + index + 1,                           \
+            (size_t) (me->size - index) * sizeof(T));                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove_last(name me)                        \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->size--;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_set_at(name me, const int index, T data)    \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->data[index] = data;                                                   \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get_at(T *const data, name me,              \
+                                         const int index)                     \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    *data = me->data[index];                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    free(me->data);                                                           \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a deque of T called name, which is a double-ended queue stored in a
+ * circular buffer. The functions are init, size, is_empty, push_front,
+ * push_back, pop_front, pop_back, set_at, get_at, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_DEQUE(name, T)                                      \
+typedef struct name##_internal {                                              \
+    int start;                                                                \
+    int size;                                                                 \
+    int capacity;                                                             \
+    T *data;                                                                  \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->start = 0;                                                          \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->data = malloc(CONTAINERS_GENERIC_START * sizeof(T));                \
+    if (!init->data) {                                                        \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_grow(name me)                               \
+{                                                                             \
+    const int capacity = 2 * me->capacity;                                    \
+    const int head = me->capacity - me->start;                                \
+    T *const data = malloc((size_t) capacity * sizeof(T));                    \
+    if (!data) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    if (me->size <= head) {                                                   \
+        memcpy(data, me->data + me->start, (size_t) me->size * sizeof(T));    \
+    } else {                                                                  \
+        memcpy(data, me->data + me->start, (size_t) head * sizeof(T));        \
+        memcpy(data + head, me->data,                                         \
+               (size_t) (me->size - head) * sizeof(T));                       \
+    }                                                                         \
+    free(me->data);                                                           \
+    me->data = data;                                                          \
+    me->start = 0;                                                            \
+    me->capacity = capacity;                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_push_front(name me, T data)                 \
+{                                                                             \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_grow(me);                                       \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    me->start = (me->start + me->capacity - 1) % me->capacity;                \
+    me->data[me->start] = data;                                               \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_push_back(name me, T data)                  \
+{                                                                             \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_grow(me);                                       \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    me->data[(me->start + me->size) % me->capacity] = data;                   \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_pop_front(T *const data, name me)           \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    *data = me->data[me->start];                                              \
+    me->start = (me->start + 1) % me->capacity;                               \
+    me->size--;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_pop_back(T *const data, name me)            \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->size--;                                                               \
+    *data = me->data[(me->start + me->size) % me->capacity];                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_set_at(name me, const int index, T data)    \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->data[(me->start + index) % me->capacity] = data;                      \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get_at(T *const data, name me,              \
+                                         const int index)                     \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    *data = me->data[(me->start + index) % me->capacity];                     \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    me->start = 0;                                                            \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    free(me->data);                                                           \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a priority queue of T called name. The compare function or macro is
+ * called with two elements, and returns a positive value if the first has a
+ * higher priority than the second. The functions are init, size, is_empty,
+ * push, pop, front, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_PRIORITY_QUEUE(name, T, compare)                    \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    T *data;                                                                  \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->data = malloc(CONTAINERS_GENERIC_START * sizeof(T));                \
+    if (!init->data) {                                                        \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_push(name me, T data)                       \
+{                                                                             \
+    int index;                                                                \
+    if (me->size == me->capacity) {                                           \
+        const int capacity = me->capacity + me->capacity / 2;                 \
+        T *const temp = realloc(me->data, (size_t) capacity * sizeof(T));     \
+        if (!temp) {                                                          \
+            return -ENOMEM;                                                   \
+        }                                                                     \
+        me->data = temp;                                                      \
+        me->capacity = capacity;                                              \
+    }                                                                         \
+    index = me->size;                                                         \
+    me->size++;                                                               \
+    while (index > 0) {                                                       \
+        const int parent = (index - 1) / 2;                                   \
+        if (compare(data, me->data[parent]) <= 0) {                           \
+            break;                                                            \
+        }                                                                     \
+        me->data[index] = me->data[parent];                                   \
+        index = parent;                                                       \
+    }                                                                         \
+    me->data[index] = data;                                                   \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_pop(T *const data, name me)                 \
+{                                                                             \
+    int index = 0;                                                            \
+    T last;                                                                   \
+    if (me->size == 0) {                                                      \
+        return 0;                                                             \
+    }                                                                         \
+    *data = me->data[0];                                                      \
+    me->size--;                                                               \
+    last = me->data[me->size];                                                \
+    for (;;) {                                                                \
+        int child = 2 * index + 1;                                            \
+        if (child >= me->size) {                                              \
+            break;                                                            \
+        }                                                                     \
+        if (child + 1 < me->size                                              \
+            && compare(me->data[child + 1], me->data[child]) > 0) {           \
+            child++;                                                          \
+        }                                                                     \
+        if (compare(me->data[child], last) <= 0) {                            \
+            break;                                                            \
+        }                                                                     \
+        me->data[index] = me->data[child];                                    \
+        index = child;                                                        \
+    }                                                                         \
+    me->data[index] = last;                                                   \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_front(T *const data, name me)               \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return 0;                                                             \
+    }                                                                         \
+    *data = me->data[0];                                                      \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    free(me->data);                                                           \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines an unordered map from K to V called name. The hash function or macro
+ * is called with a key and returns an unsigned long, and the equal function or
+ * macro is called with two keys and returns non-zero if they are equal. The
+ * functions are init, size, is_empty, put, get, contains, remove, clear, and
+ * destroy.
+ */
+#define CONTAINERS_DEFINE_UNORDERED_MAP(name, K, V, hash, equal)              \
+struct name##_node {                                                          \
+    K key;                                                                    \
+    V value;                                                                  \
+    unsigned long hash;                                                       \
+    struct name##_node *next;                                                 \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    struct name##_node **buckets;                                             \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API unsigned long name##_hash(K key)                       \
+{                                                                             \
+    unsigned long hash_value = hash(key);                                     \
+    hash_value ^= (hash_value >> 20UL) ^ (hash_value >> 12UL);                \
+    return hash_value ^ (hash_value >> 7UL) ^ (hash_value >> 4UL);            \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->buckets = calloc(CONTAINERS_GENERIC_START,                          \
+                           sizeof(struct name##_node *));                     \
+    if (!init->buckets) {                                                     \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_resize(name me, const int capacity)         \
+{                                                                             \
+    int i;                                                                    \
+    struct name##_node **const buckets =                                      \
+            calloc((size_t) capacity, sizeof(struct name##_node *));          \
+    if (!buckets) {                                                           \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            const int index = (int) (traverse->hash % capacity);              \
+            traverse->next = buckets[index];                                  \
+            buckets[index] = traverse;                                        \
+            traverse = next;                                                  \
+        }                                                                     \
+    }                                                                         \
+    free(me->buckets);                                                        \
+    me->buckets = buckets;                                                    \
+    me->capacity = capacity;                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_find(                       \
+        name me, K key, const unsigned long h)                                \
+{                                                                             \
+    struct name##_node *traverse = me->buckets[(int) (h % me->capacity)];     \
+    while (traverse) {                                                        \
+        if (traverse->hash == h && equal(traverse->key, key)) {               \
+            return traverse;                                                  \
+        }                                                                     \
+        traverse = traverse->next;                                            \
+    }                                                                         \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, K key, V value)                \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node *item = name##_find(me, key, h);                       \
+    int index;                                                                \
+    if (item) {                                                               \
+        item->value = value;                                                  \
+        return 0;                                                             \
+    }                                                                         \
+    if (4 * (me->size + 1) >= 3 * me->capacity) {                             \
+        const int rc = name##_resize(me, me->capacity + me->capacity / 2);    \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    item = malloc(sizeof(struct name##_node));                                \
+    if (!item) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    index = (int) (h % me->capacity);                                         \
+    item->key = key;                                                          \
+    item->value = value;                                                      \
+    item->hash = h;                                                           \
+    item->next = me->buckets[index];                                          \
+    me->buckets[index] = item;                                                \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get(V *const value, name me, K key)         \
+{                                                                             \
+    const struct name##_node *const item =                                    \
+            name##_find(me, key, name##_hash(key));                           \
+    if (!item) {                                                              \
+        return 0;                                                             \
+    }                                                                         \
+    *value = item->value;                                                     \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, K key)                    \
+{                                                                             \
+    return name##_find(me, key, name##_hash(key)) != NULL;                    \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, K key)                      \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node **link = &me->buckets[(int) (h % me->capacity)];       \
+    while (*link) {                                                           \
+        struct name##_node *const item = *link;                               \
+        if (item->hash == h && equal(item->key, key)) {                       \
+            *link = item->next;                                               \
+            free(item);                                                       \
+            me->size--;                                                       \
+            return 1;                                                         \
+        }                                                                     \
+        link = &item->next;                                                   \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    int i;                                                                    \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            free(traverse);                                                   \
+            traverse = next;                                                  \
+        }                                                                     \
+        me->buckets[i] = NULL;                                                \
+    }                                                                         \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me->buckets);                                                        \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines an unordered set of T called name. The hash function or macro is
+ * called with a key and returns an unsigned long, and the equal function or
+ * macro is called with two keys and returns non-zero if they are equal. The
+ * functions are init, size, is_empty, put, contains, remove, clear, and
+ * destroy.
+ */
+#define CONTAINERS_DEFINE_UNORDERED_SET(name, T, hash, equal)                 \
+struct name##_node {                                                          \
+    T key;                                                                    \
+    unsigned long hash;                                                       \
+    struct name##_node *next;                                                 \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    struct name##_node **buckets;                                             \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API unsigned long name##_hash(T key)                       \
+{                                                                             \
+    unsigned long hash_value = hash(key);                                     \
+    hash_value ^= (hash_value >> 20UL) ^ (hash_value >> 12UL);                \
+    return hash_value ^ (hash_value >> 7UL) ^ (hash_value >> 4UL);            \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->buckets = calloc(CONTAINERS_GENERIC_START,                          \
+                           sizeof(struct name##_node *));                     \
+    if (!init->buckets) {                                                     \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_resize(name me, const int capacity)         \
+{                                                                             \
+    int i;                                                                    \
+    struct name##_node **const buckets =                                      \
+            calloc((size_t) capacity, sizeof(struct name##_node *));          \
+    if (!buckets) {                                                           \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            const int index = (int) (traverse->hash % capacity);              \
+            traverse->next = buckets[index];                                  \
+            buckets[index] = traverse;                                        \
+            traverse = next;                                                  \
+        }                                                                     \
+    }                                                                         \
+    free(me->buckets);                                                        \
+    me->buckets = buckets;                                                    \
+    me->capacity = capacity;                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_find(                       \
+        name me, T key, const unsigned long h)                                \
+{                                                                             \
+    struct name##_node *traverse = me->buckets[(int) (h % me->capacity)];     \
+    while (traverse) {                                                        \
+        if (traverse->hash == h && equal(traverse->key, key)) {               \
+            return traverse;                                                  \
+        }                                                                     \
+        traverse = traverse->next;                                            \
+    }                                                                         \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, T key)                         \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node *item = name##_find(me, key, h);                       \
+    int index;                                                                \
+    if (item) {                                                               \
+        return 0;                                                             \
+    }                                                                         \
+    if (4 * (me->size + 1) >= 3 * me->capacity) {                             \
+        const int rc = name##_resize(me, me->capacity + me->capacity / 2);    \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    item = malloc(sizeof(struct name##_node));                                \
+    if (!item) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    index = (int) (h % me->capacity);                                         \
+    item->key = key;                                                          \
+    item->hash = h;                                                           \
+    item->next = me->buckets[index];                                          \
+    me->buckets[index] = item;                                                \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, T key)                    \
+{                                                                             \
+    return name##_find(me, key, name##_hash(key)) != NULL;                    \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, T key)                      \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node **link = &me->buckets[(int) (h % me->capacity)];       \
+    while (*link) {                                                           \
+        struct name##_node *const item = *link;                               \
+        if (item->hash == h && equal(item->key, key)) {                       \
+            *link = item->next;                                               \
+            free(item);                                                       \
+            me->size--;                                                       \
+            return 1;                                                         \
+        }                                                                     \
+        link = &item->next;                                                   \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    int i;                                                                    \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            free(traverse);                                                   \
+            traverse = next;                                                  \
+        }                                                                     \
+        me->buckets[i] = NULL;                                                \
+    }                                                                         \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me->buckets);                                                        \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a map from K to V called name, which is sorted by keys. The compare
+ * function or macro is called with two keys, and returns a negative value,
+ * zero, or a positive value like the comparator of a map. The functions are
+ * init, size, is_empty, put, get, contains, remove, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_MAP(name, K, V, compare)                            \
+struct name##_node {                                                          \
+    K key;                                                                    \
+    V value;                                                                  \
+    int height;                                                               \
+    struct name##_node *left;                                                 \
+    struct name##_node *right;                                                \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    struct name##_node *root;                                                 \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->root = NULL;                                                        \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_height(const struct name##_node *item)      \
+{                                                                             \
+    return item ? item->height : 0;                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_update(struct name##_node *const item)     \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    item->height = 1 + (left > right ? left : right);                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_rotate(                     \
+        struct name##_node *const item, const int is_left)                    \
+{                                                                             \
+    struct name##_node *pivot;                                                \
+    if (is_left) {                                                            \
+        pivot = item->right;                                                  \
+        item->right = pivot->left;                                            \
+        pivot->left = item;                                                   \
+    } else {                                                                  \
+        pivot = item->left;                                                   \
+        item->left = pivot->right;                                            \
+        pivot->right = item;                                                  \
+    }                                                                         \
+    name##_update(item);                                                      \
+    name##_update(pivot);                                                     \
+    return pivot;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_balance(                    \
+        struct name##_node *const item)                                       \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    name##_update(item);                                                      \
+    if (left - right > 1) {                                                   \
+        if (name##_height(item->left->left)                                   \
+            < name##_height(item->left->right)) {                             \
+            item->left = name##_rotate(item->left, 1);                        \
+        }                                                                     \
+        return name##_rotate(item, 0);                                        \
+    }                                                                         \
+    if (right - left > 1) {                                                   \
+        if (name##_height(item->right->right)                                 \
+            < name##_height(item->right->left)) {                             \
+            item->right = name##_rotate(item->right, 0);                      \
+        }                                                                     \
+        return name##_rotate(item, 1);                                        \
+    }                                                                         \
+    return item;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_insert(                     \
+        name me, struct name##_node *const item, K key, V value, int *rc)     \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        struct name##_node *const add = malloc(sizeof(struct name##_node));   \
+        if (!add) {                                                           \
+            *rc = -ENOMEM;                                                    \
+            return NULL;                                                      \
+        }                                                                     \
+        add->key = key;                                                       \
+        add->value = value;                                                   \
+        add->height = 1;                                                      \
+        add->left = NULL;                                                     \
+        add->right = NULL;                                                    \
+        me->size++;                                                           \
+        return add;                                                           \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result == 0) {                                                        \
+        item->value = value;                                                  \
+        return item;                                                          \
+    }                                                                         \
+    if (result < 0) {                                                         \
+        struct name##_node *const left =                                      \
+                name##_insert(me, item->left, key, value, rc);                \
+        if (!left) {                                                          \
+            return item;                                                      \
+        }                                                                     \
+        item->left = left;                                                    \
+    } else {                                                                  \
+        struct name##_node *const right =                                     \
+                name##_insert(me, item->right, key, value, rc);               \
+        if (!right) {                                                         \
+            return item;                                                      \
+        }                                                                     \
+        item->right = right;                                                  \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_erase(                      \
+        name me, struct name##_node *item, K key, int *removed)               \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result < 0) {                                                         \
+        item->left = name##_erase(me, item->left, key, removed);              \
+    } else if (result > 0) {                                                  \
+        item->right = name##_erase(me, item->right, key, removed);            \
+    } else if (item->left && item->right) {                                   \
+        struct name##_node *successor = item->right;                          \
+        while (successor->left) {                                             \
+            successor = successor->left;                                      \
+        }                                                                     \
+        item->key = successor->key;                                           \
+        item->value = successor->value;                                       \
+        item->right =                                                         \
+                name##_erase(me, item->right, successor->key, removed);       \
+    } else {                                                                  \
+        struct name##_node *const child =                                     \
+                item->left ? item->left : item->right;                        \
+        free(item);                                                           \
+        me->size--;                                                           \
+        *removed = 1;                                                         \
+        return child;                                                         \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, K key, V value)                \
+{                                                                             \
+    int rc = 0;                                                               \
+    struct name##_node *const root =                                          \
+            name##_insert(me, me->root, key, value, &rc);                     \
+    if (root) {                                                               \
+        me->root = root;                                                      \
+    }                                                                         \
+    return rc;                                                                \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get(V *const value, name me, K key)         \
+{                                                                             \
+    const struct name##_node *traverse = me->root;                            \
+    while (traverse) {                                                        \
+        const int result = compare(key, traverse->key);                       \
+        if (result == 0) {                                                    \
+            *value = traverse->value;                                         \
+            return 1;                                                         \
+        }                                                                     \
+        traverse = result < 0 ? traverse->left : traverse->right;             \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, K key)                    \
+{                                                                             \
+    const struct name##_node *traverse = me->root;                            \
+    while (traverse) {                                                        \
+        const int result = compare(key, traverse->key);                       \
+        if (result == 0) {                                                    \
+            return 1;                                                         \
+        }                                                                     \
+        traverse = result < 0 ? traverse->left : traverse->right;             \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, K key)                      \
+{                                                                             \
+    int removed = 0;                                                          \
+    me->root = name##_erase(me, me->root, key, &removed);                     \
+    return removed;                                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_free_subtree(struct name##_node *item)     \
+{                                                                             \
+    while (item) {                                                            \
+        struct name##_node *const right = item->right;                        \
+        name##_free_subtree(item->left);                                      \
+        free(item);                                                           \
+        item = right;                                                         \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    name##_free_subtree(me->root);                                            \
+    me->root = NULL;                                                          \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a set of T called name, which is sorted. The compare function or
+ * macro is called with two keys, and returns a negative value, zero, or a
+ * positive value like the comparator of a set. The functions are init, size,
+ * is_empty, put, contains, remove, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_SET(name, T, compare)                               \
+struct name##_node {                                                          \
+    T key;                                                                    \
+    int height;                                                               \
+    struct name##_node *left;                                                 \
+    struct name##_node *right;                                                \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    struct name##_node *root;                                                 \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->root = NULL;                                                        \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_height(const struct name##_node *item)      \
+{                                                                             \
+    return item ? item->height : 0;                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_update(struct name##_node *const item)     \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    item->height = 1 + (left > right ? left : right);                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_rotate(                     \
+        struct name##_node *const item, const int is_left)                    \
+{                                                                             \
+    struct name##_node *pivot;                                                \
+    if (is_left) {                                                            \
+        pivot = item->right;                                                  \
+        item->right = pivot->left;                                            \
+        pivot->left = item;                                                   \
+    } else {                                                                  \
+        pivot = item->left;                                                   \
+        item->left = pivot->right;                                            \
+        pivot->right = item;                                                  \
+    }                                                                         \
+    name##_update(item);                                                      \
+    name##_update(pivot);                                                     \
+    return pivot;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_balance(                    \
+        struct name##_node *const item)                                       \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    name##_update(item);                                                      \
+    if (left - right > 1) {                                                   \
+        if (name##_height(item->left->left)                                   \
+            < name##_height(item->left->right)) {                             \
+            item->left = name##_rotate(item->left, 1);                        \
+        }                                                                     \
+        return name##_rotate(item, 0);                                        \
+    }                                                                         \
+    if (right - left > 1) {                                                   \
+        if (name##_height(item->right->right)                                 \
+            < name##_height(item->right->left)) {                             \
+            item->right = name##_rotate(item->right, 0);                      \
+        }                                                                     \
+        return name##_rotate(item, 1);                                        \
+    }                                                                         \
+    return item;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_insert(                     \
+        name me, struct name##_node *const item, T key, int *rc)              \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        struct name##_node *const add = malloc(sizeof(struct name##_node));   \
+        if (!add) {                                                           \
+            *rc = -ENOMEM;                                                    \
+            return NULL;                                                      \
+        }                                                                     \
+        add->key = key;                                                       \
+        add->height = 1;                                                      \
+        add->left = NULL;                                                     \
+        add->right = NULL;                                                    \
+        me->size++;                                                           \
+        return add;                                                           \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result == 0) {                                                        \
+        return item;                                                          \
+    }                                                                         \
+    if (result < 0) {                                                         \
+        struct name##_node *const left =                                      \
+                name##_insert(me, item->left, key, rc);                       \
+        if (!left) {                                                          \
+            return item;                                                      \
+        }                                                                     \
+        item->left = left;                                                    \
+    } else {                                                                  \
+        struct name##_node *const right =                                     \
+                name##_insert(me, item->right, key, rc);                      \
+        if (!right) {                                                         \
+            return item;                                                      \
+        }                                                                     \
+        item->right = right;                                                  \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_erase(                      \
+        name me, struct name##_node *item, T key, int *removed)               \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result < 0) {                                                         \
+        item->left = name##_erase(me, item->left, key, removed);              \
+    } else if (result > 0) {                                                  \
+        item->right = name##_erase(me, item->right, key, removed);            \
+    } else if (item->left && item->right) {                                   \
+        struct name##_node *successor = item->right;                          \
+        while (successor->left) {                                             \
+            successor = successor->left;                                      \
+        }                                                                     \
+        item->key = successor->key;                                           \
+        item->right =                                                         \
+                name##_erase(me, item->right, successor->key, removed);       \
+    } else {                                                                  \
+        struct name##_node *const child =                                     \
+                item->left ? item->left : item->right;                        \
+        free(item);                                                           \
+        me->size--;                                                           \
+        *removed = 1;                                                         \
+        return child;                                                         \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, T key)                         \
+{                                                                             \
+    int rc = 0;                                                               \
+    struct name##_node *const root =                                          \
+            name##_insert(me, me->root, key, &rc);                            \
+    if (root) {                                                               \
+        me->root = root;                                                      \
+    }                                                                         \
+    return rc;                                                                \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, T key)                    \
+{                                                                             \
+    const struct name##_node *traverse = me->root;                            \
+    while (traverse) {                                                        \
+        const int result = compare(key, traverse->key);                       \
+        if (result == 0) {                                                    \
+            return 1;                                                         \
+        }                                                                     \
+        traverse = result < 0 ? traverse->left : traverse->right;             \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, T key)                      \
+{                                                                             \
+    int removed = 0;                                                          \
+    me->root = name##_erase(me, me->root, key, &removed);                     \
+    return removed;                                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_free_subtree(struct name##_node *item)     \
+{                                                                             \
+    while (item) {                                                            \
+        struct name##_node *const right = item->right;                        \
+        name##_free_subtree(item->left);                                      \
+        free(item);                                                           \
+        item = right;                                                         \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    name##_free_subtree(me->root);                                            \
+    me->root = NULL;                                                          \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+#endif /* CONTAINERS_GENERIC_H */
+
+
+#ifndef CONTAINERS_HASH_H
+#define CONTAINERS_HASH_H
+
+#include <stdlib.h>
+
+/*
+ * Built-in hash functions, which can be passed as the hash function of any of
+ * the unordered containers. The unordered containers recognize them, and call
+ * them directly rather than through the function pointer.
+ *
+ * containers_hash_key is not a function, but a marker which selects hashing
+ * all the bytes of the key, since the key size is only known to the container.
+ * Like SIG_IGN, it must not be called, so outside of a container, use
+ * containers_hash_bytes with the key size instead.
+ */
+
+/* Hashing */
+unsigned long containers_hash_bytes_seeded(const void *data,
+                                           size_t size,
+                                           unsigned long seed);
+unsigned long containers_hash_bytes(const void *data, size_t size);
+unsigned long containers_hash_int(const void *key);
+unsigned long containers_hash_long(const void *key);
+unsigned long containers_hash_string(const void *key);
+
+/* Seeding */
+int containers_hash_new_seed(unsigned long *seed, const void *salt);
+
+#define containers_hash_key ((unsigned long (*)(const void *)) 1)
+
+#endif /* CONTAINERS_HASH_H */
 
 
 #ifndef CONTAINERS_LIST_H
@@ -218,6 +1637,15 @@ priority_queue priority_queue_destroy(priority_queue me);
  */
 typedef struct internal_list *list;
 
+/**
+ * A position in a doubly-linked list, which is owned by the caller. Its members
+ * are internal and should not be used directly.
+ */
+struct list_cursor {
+    void *internal_node;
+    int internal_index;
+};
+
 /* Starting */
 list list_init(size_t data_size);
 
@@ -246,6 +1674,19 @@ int list_get_first(void *data, list me);
 int list_get_at(void *data, list me, int index);
 int list_get_last(void *data, list me);
 
+/* Cursors */
+int list_cursor_first(list me, struct list_cursor *cursor);
+int list_cursor_last(list me, struct list_cursor *cursor);
+int list_cursor_at(list me, struct list_cursor *cursor, int index);
+int list_cursor_next(list me, struct list_cursor *cursor);
+int list_cursor_prev(list me, struct list_cursor *cursor);
+int list_cursor_index(const struct list_cursor *cursor);
+int list_cursor_get(void *data, list me, const struct list_cursor *cursor);
+int list_cursor_set(list me, const struct list_cursor *cursor, void *data);
+int list_cursor_add_before(list me, struct list_cursor *cursor, void *data);
+int list_cursor_add_after(list me, struct list_cursor *cursor, void *data);
+int list_cursor_remove(list me, struct list_cursor *cursor);
+
 /* Ending */
 void list_clear(list me);
 list list_destroy(list me);
@@ -253,119 +1694,111 @@ list list_destroy(list me);
 #endif /* CONTAINERS_LIST_H */
 
 
-#ifndef CONTAINERS_UNORDERED_MULTIMAP_H
-#define CONTAINERS_UNORDERED_MULTIMAP_H
+#ifndef CONTAINERS_MAP_H
+#define CONTAINERS_MAP_H
 
 #include <stdlib.h>
 
 /**
- * The unordered_multimap data structure, which is a collection of key-value
- * pairs, hashed by keys.
+ * The map data structure, which is a collection of key-value pairs, sorted by
+ * keys, keys are unique.
  */
-typedef struct internal_unordered_multimap *unordered_multimap;
+typedef struct internal_map *map;
 
 /* Starting */
-unordered_multimap
-unordered_multimap_init(size_t key_size,
-                        size_t value_size,
-                        unsigned long (*hash)(const void *const key),
-                        int (*key_comparator)(const void *const one,
-                                              const void *const two),
-                        int (*value_comparator)(const void *const one,
-                                                const void *const two));
+map map_init(size_t key_size,
+             size_t value_size,
+             int (*comparator)(const void *const one, const void *const two));
+
+/* Capacity */
+int map_size(map me);
+int map_is_empty(map me);
 
 /* Utility */
-int unordered_multimap_rehash(unordered_multimap me);
-int unordered_multimap_size(unordered_multimap me);
-int unordered_multimap_is_empty(unordered_multimap me);
+int map_save(map me, int fd);
+int map_load(map me, int fd);
 
 /* Accessing */
-int unordered_multimap_put(unordered_multimap me, void *key, void *value);
-void unordered_multimap_get_start(unordered_multimap me, void *key);
-int unordered_multimap_get_next(void *value, unordered_multimap me);
-int unordered_multimap_count(unordered_multimap me, void *key);
-int unordered_multimap_contains(unordered_multimap me, void *key);
-int unordered_multimap_remove(unordered_multimap me, void *key, void *value);
-int unordered_multimap_remove_all(unordered_multimap me, void *key);
+int map_put(map me, void *key, void *value);
+int map_get(void *value, map me, void *key);
+int map_contains(map me, void *key);
+int map_rank(map me, void *key);
+int map_select(void *key, void *value, map me, int index);
+int map_remove(map me, void *key);
+
+/* Combining */
+int map_union(map me, map one, map two);
+int map_intersection(map me, map one, map two);
+int map_difference(map me, map one, map two);
+int map_is_subset(map me, map other);
 
 /* Ending */
-int unordered_multimap_clear(unordered_multimap me);
-unordered_multimap unordered_multimap_destroy(unordered_multimap me);
+void map_clear(map me);
+map map_destroy(map me);
 
-#endif /* CONTAINERS_UNORDERED_MULTIMAP_H */
+#endif /* CONTAINERS_MAP_H */
 
 
-#ifndef CONTAINERS_ARRAY_H
-#define CONTAINERS_ARRAY_H
+#ifndef CONTAINERS_MULTIMAP_H
+#define CONTAINERS_MULTIMAP_H
 
 #include <stdlib.h>
 
 /**
- * The array data structure, which is a static contiguous array.
+ * The multimap data structure, which is a collection of key-value pairs, sorted
+ * by keys.
  */
-typedef struct internal_array *array;
-
-/* Starting */
-array array_init(int element_count, size_t data_size);
-
-/* Utility */
-int array_size(array me);
-void array_copy_to_array(void *arr, array me);
-void *array_get_data(array me);
-
-/* Accessing */
-int array_set(array me, int index, void *data);
-int array_get(void *data, array me, int index);
-
-/* Ending */
-array array_destroy(array me);
-
-#endif /* CONTAINERS_ARRAY_H */
-
-
-#ifndef CONTAINERS_FORWARD_LIST_H
-#define CONTAINERS_FORWARD_LIST_H
-
-#include <stdlib.h>
+typedef struct internal_multimap *multimap;
 
 /**
- * The forward_list data structure, which is a singly-linked list.
+ * A cursor over the values of a key in a multi-map, which is owned by the
+ * caller. Its members are internal and should not be used directly.
  */
-typedef struct internal_forward_list *forward_list;
+struct multimap_values {
+    void *internal_values;
+    int internal_count;
+    int internal_index;
+};
 
 /* Starting */
-forward_list forward_list_init(size_t data_size);
-
-/* Utility */
-int forward_list_size(forward_list me);
-int forward_list_is_empty(forward_list me);
-void forward_list_copy_to_array(void *arr, forward_list me);
-
-/* Adding */
-int forward_list_add_first(forward_list me, void *data);
-int forward_list_add_at(forward_list me, int index, void *data);
-int forward_list_add_last(forward_list me, void *data);
+multimap multimap_init(size_t key_size,
+                       size_t value_size,
+                       int (*key_comparator)(const void *const one,
+                                             const void *const two),
+                       int (*value_comparator)(const void *const one,
+                                               const void *const two));
 
-/* Removing */
-int forward_list_remove_first(forward_list me);
-int forward_list_remove_at(forward_list me, int index);
-int forward_list_remove_last(forward_list me);
+/* Capacity */
+int multimap_size(multimap me);
+int multimap_is_empty(multimap me);
 
-/* Setting */
-int forward_list_set_first(forward_list me, void *data);
-int forward_list_set_at(forward_list me, int index, void *data);
-int forward_list_set_last(forward_list me, void *data);
+/* Utility */
+int multimap_save(multimap me, int fd);
+int multimap_load(multimap me, int fd);
 
-/* Getting */
-int forward_list_get_first(void *data, forward_list me);
-int forward_list_get_at(void *data, forward_list me, int index);
-int forward_list_get_last(void *data, forward_list me);
+/* Accessing */
+int multimap_put(multimap me, void *key, void *value);
+void multimap_get_start(multimap me, void *key);
+int multimap_get_next(void *value, multimap me);
+int multimap_values_start(multimap me,
+                          struct multimap_values *cursor,
+                          void *key);
+int multimap_values_next(void *value,
+                         multimap me,
+                         struct multimap_values *cursor);
+int multimap_get_values(void **values, multimap me, void *key);
+int multimap_count(multimap me, void *key);
+int multimap_contains(multimap me, void *key);
+int multimap_rank(multimap me, void *key);
+int multimap_select(void *key, void *value, multimap me, int index);
+int multimap_remove(multimap me, void *key, void *value);
+int multimap_remove_all(multimap me, void *key);
 
 /* Ending */
-void forward_list_clear(forward_list me);
-forward_list forward_list_destroy(forward_list me);
+void multimap_clear(multimap me);
+multimap multimap_destroy(multimap me);
 
-#endif /* CONTAINERS_FORWARD_LIST_H */
+#endif /* CONTAINERS_MULTIMAP_H */
 
 
 #ifndef CONTAINERS_MULTISET_H
@@ -388,13 +1821,25 @@ multiset multiset_init(size_t key_size,
 int multiset_size(multiset me);
 int multiset_is_empty(multiset me);
 
+/* Utility */
+int multiset_save(multiset me, int fd);
+int multiset_load(multiset me, int fd);
+
 /* Accessing */
 int multiset_put(multiset me, void *key);
 int multiset_count(multiset me, void *key);
 int multiset_contains(multiset me, void *key);
+int multiset_rank(multiset me, void *key);
+int multiset_select(void *key, multiset me, int index);
 int multiset_remove(multiset me, void *key);
 int multiset_remove_all(multiset me, void *key);
 
+/* Combining */
+int multiset_union(multiset me, multiset one, multiset two);
+int multiset_intersection(multiset me, multiset one, multiset two);
+int multiset_difference(multiset me, multiset one, multiset two);
+int multiset_is_subset(multiset me, multiset other);
+
 /* Ending */
 void multiset_clear(multiset me);
 multiset multiset_destroy(multiset me);
@@ -402,231 +1847,17901 @@ multiset multiset_destroy(multiset me);
 #endif /* CONTAINERS_MULTISET_H */
 
 
-#ifndef CONTAINERS_DEQUE_H
-#define CONTAINERS_DEQUE_H
+#ifndef CONTAINERS_PRIORITY_QUEUE_H
+#define CONTAINERS_PRIORITY_QUEUE_H
 
 #include <stdlib.h>
 
 /**
- * The deque data structure, which is a doubly-ended queue.
+ * The priority_queue data structure, which adapts a container to provide a
+ * priority queue. Adapts the vector container.
  */
-typedef struct internal_deque *deque;
+typedef struct internal_priority_queue *priority_queue;
 
 /* Starting */
-deque deque_init(size_t data_size);
+priority_queue priority_queue_init(size_t data_size,
+                                   int (*comparator)(const void *const one,
+                                                     const void *const two));
 
 /* Utility */
-int deque_size(deque me);
-int deque_is_empty(deque me);
-int deque_trim(deque me);
-void deque_copy_to_array(void *arr, deque me);
+int priority_queue_size(priority_queue me);
+int priority_queue_is_empty(priority_queue me);
 
 /* Adding */
-int deque_push_front(deque me, void *data);
-int deque_push_back(deque me, void *data);
+int priority_queue_push(priority_queue me, void *data);
 
 /* Removing */
-int deque_pop_front(void *data, deque me);
-int deque_pop_back(void *data, deque me);
-
-/* Setting */
-int deque_set_first(deque me, void *data);
-int deque_set_at(deque me, int index, void *data);
-int deque_set_last(deque me, void *data);
+int priority_queue_pop(void *data, priority_queue me);
 
 /* Getting */
-int deque_get_first(void *data, deque me);
-int deque_get_at(void *data, deque me, int index);
-int deque_get_last(void *data, deque me);
+int priority_queue_front(void *data, priority_queue me);
 
 /* Ending */
-int deque_clear(deque me);
-deque deque_destroy(deque me);
+int priority_queue_clear(priority_queue me);
+priority_queue priority_queue_destroy(priority_queue me);
 
-#endif /* CONTAINERS_DEQUE_H */
+#endif /* CONTAINERS_PRIORITY_QUEUE_H */
 
 
-#ifndef CONTAINERS_STACK_H
-#define CONTAINERS_STACK_H
+#ifndef CONTAINERS_QUEUE_H
+#define CONTAINERS_QUEUE_H
 
 #include <stdlib.h>
 
 /**
- * The stack data structure, which adapts a container to provide a stack
- * (last-in first-out). Adapts the deque container.
+ * The queue data structure, which adapts a container to provide a queue
+ * (first-in first-out). Adapts the deque container.
  */
-typedef struct internal_stack *stack;
+typedef struct internal_queue *queue;
 
 /* Starting */
-stack stack_init(size_t data_size);
+queue queue_init(size_t data_size);
 
 /* Utility */
-int stack_size(stack me);
-int stack_is_empty(stack me);
-int stack_trim(stack me);
-void stack_copy_to_array(void *arr, stack me);
+int queue_size(queue me);
+int queue_is_empty(queue me);
+int queue_trim(queue me);
+void queue_copy_to_array(void *arr, queue me);
 
 /* Adding */
-int stack_push(stack me, void *data);
+int queue_push(queue me, void *data);
 
 /* Removing */
-int stack_pop(void *data, stack me);
+int queue_pop(void *data, queue me);
 
 /* Getting */
-int stack_top(void *data, stack me);
+int queue_front(void *data, queue me);
+int queue_back(void *data, queue me);
 
 /* Ending */
-int stack_clear(stack me);
-stack stack_destroy(stack me);
+int queue_clear(queue me);
+queue queue_destroy(queue me);
 
-#endif /* CONTAINERS_STACK_H */
+#endif /* CONTAINERS_QUEUE_H */
 
 
-#ifndef CONTAINERS_UNORDERED_SET_H
-#define CONTAINERS_UNORDERED_SET_H
+#ifndef CONTAINERS_SEARCH_H
+#define CONTAINERS_SEARCH_H
+
+#include <stdlib.h>
+
+/*
+ * Searching of contiguous sorted elements, which is what the vector and array
+ * search functions are built on. Large read-mostly tables can be rearranged
+ * into Eytzinger order once, after which their searches are cache-friendly.
+ */
+
+/* Searching */
+int containers_lower_bound(void *data,
+                           int count,
+                           size_t size,
+                           void *key,
+                           int (*comparator)(const void *const one,
+                                             const void *const two));
+int containers_eytzinger_layout(void *data, int count, size_t size);
+int containers_eytzinger_lower_bound(void *data,
+                                     int count,
+                                     size_t size,
+                                     void *key,
+                                     int (*comparator)(const void *const one,
+                                                       const void *const two));
+
+#endif /* CONTAINERS_SEARCH_H */
+
+
+#ifndef CONTAINERS_SET_H
+#define CONTAINERS_SET_H
 
 #include <stdlib.h>
 
 /**
- * The unordered_set data structure, which is a collection of unique keys,
- * hashed by keys.
+ * The set data structure, which is a collection of unique keys, sorted by keys.
  */
-typedef struct internal_unordered_set *unordered_set;
+typedef struct internal_set *set;
 
 /* Starting */
-unordered_set unordered_set_init(size_t key_size,
-                                 unsigned long (*hash)(const void *const key),
-                                 int (*comparator)(const void *const one,
-                                                   const void *const two));
+set set_init(size_t key_size,
+             int (*comparator)(const void *const one, const void *const two));
+
+/* Capacity */
+int set_size(set me);
+int set_is_empty(set me);
 
 /* Utility */
-int unordered_set_rehash(unordered_set me);
-int unordered_set_size(unordered_set me);
-int unordered_set_is_empty(unordered_set me);
+int set_save(set me, int fd);
+int set_load(set me, int fd);
 
 /* Accessing */
-int unordered_set_put(unordered_set me, void *key);
-int unordered_set_contains(unordered_set me, void *key);
-int unordered_set_remove(unordered_set me, void *key);
+int set_put(set me, void *key);
+int set_contains(set me, void *key);
+int set_rank(set me, void *key);
+int set_select(void *key, set me, int index);
+int set_remove(set me, void *key);
+
+/* Combining */
+int set_union(set me, set one, set two);
+int set_intersection(set me, set one, set two);
+int set_difference(set me, set one, set two);
+int set_is_subset(set me, set other);
 
 /* Ending */
-int unordered_set_clear(unordered_set me);
-unordered_set unordered_set_destroy(unordered_set me);
+void set_clear(set me);
+set set_destroy(set me);
 
-#endif /* CONTAINERS_UNORDERED_SET_H */
+#endif /* CONTAINERS_SET_H */
 
 
-#ifndef CONTAINERS_VECTOR_H
-#define CONTAINERS_VECTOR_H
+#ifndef CONTAINERS_SORT_H
+#define CONTAINERS_SORT_H
 
 #include <stdlib.h>
 
-/**
- * The vector data structure, which is a dynamic contiguous array.
+/*
+ * Sorting of contiguous elements, which is what the vector, array, and deque
+ * sort functions are built on. When the comparator is one of the built-in
+ * scalar comparators from compare.h and it matches the element size, the
+ * elements are sorted by their bits with a radix sort instead of calling the
+ * comparator. The containers_compare_key marker sorts the elements by all of
+ * their bytes.
  */
-typedef struct internal_vector *vector;
 
-/* Starting */
-vector vector_init(size_t data_size);
+/* Sorting */
+void containers_sort(void *data,
+                     int count,
+                     size_t size,
+                     int (*comparator)(const void *const one,
+                                       const void *const two));
 
-/* Utility */
-int vector_size(vector me);
-int vector_capacity(vector me);
-int vector_is_empty(vector me);
-int vector_reserve(vector me, int size);
-int vector_trim(vector me);
-void vector_copy_to_array(void *arr, vector me);
-void *vector_get_data(vector me);
+#endif /* CONTAINERS_SORT_H */
+
+
+#ifndef CONTAINERS_STACK_H
+#define CONTAINERS_STACK_H
+
+#include <stdlib.h>
+
+/**
+ * The stack data structure, which adapts a container to provide a stack
+ * (last-in first-out). Adapts the deque container.
+ */
+typedef struct internal_stack *stack;
+
+/* Starting */
+stack stack_init(size_t data_size);
+
+/* Utility */
+int stack_size(stack me);
+int stack_is_empty(stack me);
+int stack_trim(stack me);
+void stack_copy_to_array(void *arr, stack me);
 
 /* Adding */
-int vector_add_first(vector me, void *data);
-int vector_add_at(vector me, int index, void *data);
-int vector_add_last(vector me, void *data);
+int stack_push(stack me, void *data);
 
 /* Removing */
-int vector_remove_first(vector me);
-int vector_remove_at(vector me, int index);
-int vector_remove_last(vector me);
-
-/* Setting */
-int vector_set_first(vector me, void *data);
-int vector_set_at(vector me, int index, void *data);
-int vector_set_last(vector me, void *data);
+int stack_pop(void *data, stack me);
 
 /* Getting */
-int vector_get_first(void *data, vector me);
-int vector_get_at(void *data, vector me, int index);
-int vector_get_last(void *data, vector me);
+int stack_top(void *data, stack me);
 
 /* Ending */
-int vector_clear(vector me);
-vector vector_destroy(vector me);
+int stack_clear(stack me);
+stack stack_destroy(stack me);
 
-#endif /* CONTAINERS_VECTOR_H */
+#endif /* CONTAINERS_STACK_H */
 
 
-#ifndef CONTAINERS_QUEUE_H
-#define CONTAINERS_QUEUE_H
+#ifndef CONTAINERS_UNORDERED_MAP_H
+#define CONTAINERS_UNORDERED_MAP_H
 
 #include <stdlib.h>
 
 /**
- * The queue data structure, which adapts a container to provide a queue
- * (first-in first-out). Adapts the deque container.
+ * The unordered_map data structure, which is a collection of key-value pairs,
+ * hashed by keys, keys are unique
  */
-typedef struct internal_queue *queue;
+typedef struct internal_unordered_map *unordered_map;
+
+/**
+ * A cursor over the key-value pairs of an unordered map, which is owned by the
+ * caller. Its members are internal and should not be used directly.
+ */
+struct unordered_map_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+};
 
 /* Starting */
-queue queue_init(size_t data_size);
+unordered_map unordered_map_init(size_t key_size,
+                                 size_t value_size,
+                                 unsigned long (*hash)(const void *const key),
+                                 int (*comparator)(const void *const one,
+                                                   const void *const two));
 
 /* Utility */
-int queue_size(queue me);
-int queue_is_empty(queue me);
-int queue_trim(queue me);
-void queue_copy_to_array(void *arr, queue me);
+int unordered_map_rehash(unordered_map me);
+int unordered_map_size(unordered_map me);
+int unordered_map_is_empty(unordered_map me);
+int unordered_map_reserve(unordered_map me, int size);
+int unordered_map_set_max_load_factor(unordered_map me, double max_load_factor);
+int unordered_map_set_min_load_factor(unordered_map me, double min_load_factor);
+int unordered_map_shrink_to_fit(unordered_map me);
+int unordered_map_set_incremental_resize(unordered_map me,
+                                         int buckets_per_step);
+int unordered_map_set_max_chain_length(unordered_map me, int max_chain_length);
+int unordered_map_save(unordered_map me, int fd);
+int unordered_map_load(unordered_map me, int fd);
 
-/* Adding */
-int queue_push(queue me, void *data);
+/* Accessing */
+int unordered_map_put(unordered_map me, void *key, void *value);
+int unordered_map_get(void *value, unordered_map me, void *key);
+int unordered_map_contains(unordered_map me, void *key);
+int unordered_map_remove(unordered_map me, void *key);
 
-/* Removing */
-int queue_pop(void *data, queue me);
+/* Iterating */
+int unordered_map_first(unordered_map me, struct unordered_map_cursor *cursor);
+int unordered_map_next(unordered_map me, struct unordered_map_cursor *cursor);
+int unordered_map_cursor_get(void *key,
+                             void *value,
+                             unordered_map me,
+                             const struct unordered_map_cursor *cursor);
+int unordered_map_cursor_remove(unordered_map me,
+                                struct unordered_map_cursor *cursor);
 
-/* Getting */
-int queue_front(void *data, queue me);
-int queue_back(void *data, queue me);
+/* Combining */
+int unordered_map_merge(unordered_map me, unordered_map other);
 
 /* Ending */
-int queue_clear(queue me);
-queue queue_destroy(queue me);
+int unordered_map_clear(unordered_map me);
+unordered_map unordered_map_destroy(unordered_map me);
 
-#endif /* CONTAINERS_QUEUE_H */
+#endif /* CONTAINERS_UNORDERED_MAP_H */
 
 
-#ifndef CONTAINERS_SET_H
-#define CONTAINERS_SET_H
+#ifndef CONTAINERS_UNORDERED_MULTIMAP_H
+#define CONTAINERS_UNORDERED_MULTIMAP_H
 
 #include <stdlib.h>
 
 /**
- * The set data structure, which is a collection of unique keys, sorted by keys.
+ * The unordered_multimap data structure, which is a collection of key-value
+ * pairs, hashed by keys.
  */
-typedef struct internal_set *set;
+typedef struct internal_unordered_multimap *unordered_multimap;
+
+/**
+ * A cursor over the key-value pairs of an unordered multi-map, which is owned
+ * by the caller. Its members are internal and should not be used directly.
+ */
+struct unordered_multimap_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+    int internal_index;
+};
+
+/**
+ * A cursor over the values of a key in an unordered multi-map, which is owned
+ * by the caller. Its members are internal and should not be used directly.
+ */
+struct unordered_multimap_values {
+    void *internal_values;
+    int internal_count;
+    int internal_index;
+};
 
 /* Starting */
-set set_init(size_t key_size,
-             int (*comparator)(const void *const one, const void *const two));
+unordered_multimap
+unordered_multimap_init(size_t key_size,
+                        size_t value_size,
+                        unsigned long (*hash)(const void *const key),
+                        int (*key_comparator)(const void *const one,
+                                              const void *const two),
+                        int (*value_comparator)(const void *const one,
+                                                const void *const two));
 
-/* Capacity */
-int set_size(set me);
-int set_is_empty(set me);
+/* Utility */
+int unordered_multimap_rehash(unordered_multimap me);
+int unordered_multimap_size(unordered_multimap me);
+int unordered_multimap_is_empty(unordered_multimap me);
+int unordered_multimap_reserve(unordered_multimap me, int size);
+int unordered_multimap_set_max_load_factor(unordered_multimap me,
+                                           double max_load_factor);
+int unordered_multimap_set_min_load_factor(unordered_multimap me,
+                                           double min_load_factor);
+int unordered_multimap_shrink_to_fit(unordered_multimap me);
+int unordered_multimap_set_incremental_resize(unordered_multimap me,
+                                              int buckets_per_step);
+int unordered_multimap_set_max_chain_length(unordered_multimap me,
+                                            int max_chain_length);
+int unordered_multimap_save(unordered_multimap me, int fd);
+int unordered_multimap_load(unordered_multimap me, int fd);
 
 /* Accessing */
-int set_put(set me, void *key);
-int set_contains(set me, void *key);
-int set_remove(set me, void *key);
+int unordered_multimap_put(unordered_multimap me, void *key, void *value);
+void unordered_multimap_get_start(unordered_multimap me, void *key);
+int unordered_multimap_get_next(void *value, unordered_multimap me);
+int unordered_multimap_values_start(unordered_multimap me,
+                                    struct unordered_multimap_values *cursor,
+                                    void *key);
+int unordered_multimap_values_next(void *value,
+                                   unordered_multimap me,
+                                   struct unordered_multimap_values *cursor);
+int unordered_multimap_get_values(void **values,
+                                  unordered_multimap me,
+                                  void *key);
+int unordered_multimap_count(unordered_multimap me, void *key);
+int unordered_multimap_contains(unordered_multimap me, void *key);
+int unordered_multimap_remove(unordered_multimap me, void *key, void *value);
+int unordered_multimap_remove_all(unordered_multimap me, void *key);
+
+/* Iterating */
+int unordered_multimap_first(unordered_multimap me,
+                             struct unordered_multimap_cursor *cursor);
+int unordered_multimap_next(unordered_multimap me,
+                            struct unordered_multimap_cursor *cursor);
+int
+unordered_multimap_cursor_get(void *key,
+                              void *value,
+                              unordered_multimap me,
+                              const struct unordered_multimap_cursor *cursor);
+int unordered_multimap_cursor_remove(unordered_multimap me,
+                                     struct unordered_multimap_cursor *cursor);
 
 /* Ending */
-void set_clear(set me);
-set set_destroy(set me);
+int unordered_multimap_clear(unordered_multimap me);
+unordered_multimap unordered_multimap_destroy(unordered_multimap me);
 
-#endif /* CONTAINERS_SET_H */
+#endif /* CONTAINERS_UNORDERED_MULTIMAP_H */
+
+
+#ifndef CONTAINERS_UNORDERED_MULTISET_H
+#define CONTAINERS_UNORDERED_MULTISET_H
+
+#include <stdlib.h>
+
+/**
+ * The unordered_multiset data structure, which is a collection of keys, hashed
+ * by keys.
+ */
+typedef struct internal_unordered_multiset *unordered_multiset;
+
+/**
+ * A cursor over the distinct keys of an unordered multi-set, which is owned by
+ * the caller. Its members are internal and should not be used directly.
+ */
+struct unordered_multiset_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+};
+
+/* Starting */
+unordered_multiset
+unordered_multiset_init(size_t key_size,
+                        unsigned long (*hash)(const void *const key),
+                        int (*comparator)(const void *const one,
+                                          const void *const two));
+
+/* Utility */
+int unordered_multiset_rehash(unordered_multiset me);
+int unordered_multiset_size(unordered_multiset me);
+int unordered_multiset_is_empty(unordered_multiset me);
+int unordered_multiset_reserve(unordered_multiset me, int size);
+int unordered_multiset_set_max_load_factor(unordered_multiset me,
+                                           double max_load_factor);
+int unordered_multiset_set_min_load_factor(unordered_multiset me,
+                                           double min_load_factor);
+int unordered_multiset_shrink_to_fit(unordered_multiset me);
+int unordered_multiset_set_incremental_resize(unordered_multiset me,
+                                              int buckets_per_step);
+int unordered_multiset_set_max_chain_length(unordered_multiset me,
+                                            int max_chain_length);
+int unordered_multiset_save(unordered_multiset me, int fd);
+int unordered_multiset_load(unordered_multiset me, int fd);
+
+/* Accessing */
+int unordered_multiset_put(unordered_multiset me, void *key);
+int unordered_multiset_count(unordered_multiset me, void *key);
+int unordered_multiset_contains(unordered_multiset me, void *key);
+int unordered_multiset_remove(unordered_multiset me, void *key);
+int unordered_multiset_remove_all(unordered_multiset me, void *key);
+
+/* Iterating */
+int unordered_multiset_first(unordered_multiset me,
+                             struct unordered_multiset_cursor *cursor);
+int unordered_multiset_next(unordered_multiset me,
+                            struct unordered_multiset_cursor *cursor);
+int
+unordered_multiset_cursor_get(void *key,
+                              unordered_multiset me,
+                              const struct unordered_multiset_cursor *cursor);
+int unordered_multiset_cursor_remove(unordered_multiset me,
+                                     struct unordered_multiset_cursor *cursor);
+
+/* Ending */
+int unordered_multiset_clear(unordered_multiset me);
+unordered_multiset unordered_multiset_destroy(unordered_multiset me);
+
+#endif /* CONTAINERS_UNORDERED_MULTISET_H */
+
+
+#ifndef CONTAINERS_UNORDERED_SET_H
+#define CONTAINERS_UNORDERED_SET_H
+
+#include <stdlib.h>
+
+/**
+ * The unordered_set data structure, which is a collection of unique keys,
+ * hashed by keys.
+ */
+typedef struct internal_unordered_set *unordered_set;
+
+/**
+ * A cursor over the keys of an unordered set, which is owned by the caller. Its
+ * members are internal and should not be used directly.
+ */
+struct unordered_set_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+};
+
+/* Starting */
+unordered_set unordered_set_init(size_t key_size,
+                                 unsigned long (*hash)(const void *const key),
+                                 int (*comparator)(const void *const one,
+                                                   const void *const two));
+
+/* Utility */
+int unordered_set_rehash(unordered_set me);
+int unordered_set_size(unordered_set me);
+int unordered_set_is_empty(unordered_set me);
+int unordered_set_reserve(unordered_set me, int size);
+int unordered_set_set_max_load_factor(unordered_set me, double max_load_factor);
+int unordered_set_set_min_load_factor(unordered_set me, double min_load_factor);
+int unordered_set_shrink_to_fit(unordered_set me);
+int unordered_set_set_incremental_resize(unordered_set me,
+                                         int buckets_per_step);
+int unordered_set_set_max_chain_length(unordered_set me, int max_chain_length);
+int unordered_set_save(unordered_set me, int fd);
+int unordered_set_load(unordered_set me, int fd);
+
+/* Accessing */
+int unordered_set_put(unordered_set me, void *key);
+int unordered_set_contains(unordered_set me, void *key);
+int unordered_set_remove(unordered_set me, void *key);
+
+/* Iterating */
+int unordered_set_first(unordered_set me, struct unordered_set_cursor *cursor);
+int unordered_set_next(unordered_set me, struct unordered_set_cursor *cursor);
+int unordered_set_cursor_get(void *key,
+                             unordered_set me,
+                             const struct unordered_set_cursor *cursor);
+int unordered_set_cursor_remove(unordered_set me,
+                                struct unordered_set_cursor *cursor);
+
+/* Combining */
+int unordered_set_intersect(unordered_set me,
+                            unordered_set one,
+                            unordered_set two);
+int unordered_set_difference(unordered_set me,
+                             unordered_set one,
+                             unordered_set two);
+int unordered_set_union_into(unordered_set me, unordered_set other);
+
+/* Ending */
+int unordered_set_clear(unordered_set me);
+unordered_set unordered_set_destroy(unordered_set me);
+
+#endif /* CONTAINERS_UNORDERED_SET_H */
+
+
+#ifndef CONTAINERS_VECTOR_H
+#define CONTAINERS_VECTOR_H
+
+#include <stdlib.h>
+
+/**
+ * The vector data structure, which is a dynamic contiguous array.
+ */
+typedef struct internal_vector *vector;
+
+/* Flags for mapped storage */
+#define VECTOR_HUGE_PAGES 0x1
+#define VECTOR_READ_ONLY 0x2
+#define VECTOR_CREATE 0x4
+
+/* Starting */
+vector vector_init(size_t data_size);
+vector vector_init_mapped(size_t data_size, int flags);
+vector vector_open_mapped(const char *path, size_t data_size, int flags);
+
+/* Utility */
+int vector_size(vector me);
+int vector_capacity(vector me);
+int vector_is_empty(vector me);
+int vector_reserve(vector me, int size);
+int vector_trim(vector me);
+void vector_copy_to_array(void *arr, vector me);
+void *vector_get_data(vector me);
+int vector_sync(vector me);
+void vector_sort(vector me,
+                 int (*comparator)(const void *const one,
+                                   const void *const two));
+int vector_parallel_sort(vector me,
+                         int (*comparator)(const void *const one,
+                                           const void *const two),
+                         int thread_count);
+int vector_lower_bound(vector me,
+                       void *key,
+                       int (*comparator)(const void *const one,
+                                         const void *const two));
+int vector_eytzinger_layout(vector me);
+int vector_eytzinger_lower_bound(vector me,
+                                 void *key,
+                                 int (*comparator)(const void *const one,
+                                                   const void *const two));
+
+/* Adding */
+int vector_add_first(vector me, void *data);
+int vector_add_at(vector me, int index, void *data);
+int vector_add_last(vector me, void *data);
+
+/* Removing */
+int vector_remove_first(vector me);
+int vector_remove_at(vector me, int index);
+int vector_remove_last(vector me);
+
+/* Setting */
+int vector_set_first(vector me, void *data);
+int vector_set_at(vector me, int index, void *data);
+int vector_set_last(vector me, void *data);
+
+/* Getting */
+int vector_get_first(void *data, vector me);
+int vector_get_at(void *data, vector me, int index);
+int vector_get_last(void *data, vector me);
+
+/* Ending */
+int vector_clear(vector me);
+vector vector_destroy(vector me);
+
+#endif /* CONTAINERS_VECTOR_H */
+
+#ifdef CONTAINERS_IMPLEMENTATION
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#define HEADER_SIZE array_HEADER_SIZE
+#define HUGE_PAGE_SIZE array_HUGE_PAGE_SIZE
+#define MAPPED_MAGIC array_MAPPED_MAGIC
+#define mapped_header array_mapped_header
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t HEADER_SIZE = 64;
+static const char MAPPED_MAGIC[8] = "CNTRDATA";
+
+struct internal_array {
+    size_t bytes_per_item;
+    int item_count;
+    void *data;
+    size_t mapped_size;
+    size_t map_offset;
+};
+
+/*
+ * The header at the start of a mapped file. The data follows the header, at
+ * an offset of HEADER_SIZE bytes from the start of the file. This is the same
+ * format as mapped vector files.
+ */
+struct mapped_header {
+    char magic[8];
+    unsigned long data_size;
+    unsigned long item_count;
+};
+
+/**
+ * Initializes an array.
+ *
+ * @param element_count the number of elements in the array; must not be
+ *                      negative
+ * @param data_size     the size of each element in the array; must be positive
+ *
+ * @return the newly-initialized array, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+array array_init(const int element_count, const size_t data_size)
+{
+    struct internal_array *init;
+    if (element_count < 0 || data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_array));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = element_count;
+    init->mapped_size = 0;
+    init->map_offset = 0;
+    if (init->item_count == 0) {
+        init->data = NULL;
+        return init;
+    }
+    init->data = calloc((size_t) element_count, data_size);
+    if (!init->data) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Rounds the amount of bytes up to the granularity of the mapping, which is
+ * the huge page size if huge pages were requested, otherwise the page size.
+ */
+static size_t array_map_round(const size_t size, const int flags)
+{
+    size_t granularity = (size_t) sysconf(_SC_PAGESIZE);
+    if (flags & ARRAY_HUGE_PAGES) {
+        granularity = HUGE_PAGE_SIZE;
+    }
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+/*
+ * Advises the kernel to back the mapping with transparent huge pages if the
+ * array requested it.
+ */
+static void array_map_advise(array me, const int flags)
+{
+#ifdef MADV_HUGEPAGE
+    if (flags & ARRAY_HUGE_PAGES) {
+        madvise((char *) me->data - me->map_offset, me->mapped_size,
+                MADV_HUGEPAGE);
+    }
+#else
+    (void) me;
+    (void) flags;
+#endif
+}
+
+#endif
+
+/**
+ * Initializes an array which stores its data in an anonymous memory mapping
+ * rather than on the heap. The elements are zero-initialized. If
+ * ARRAY_HUGE_PAGES is specified in the flags, the mapping is sized in multiples
+ * of the huge page size and the kernel is advised to back it with transparent
+ * huge pages, which reduces TLB pressure when scanning the data. On platforms
+ * without memory mappings, the array is stored on the heap instead.
+ *
+ * @param element_count the number of elements in the array; must not be
+ *                      negative
+ * @param data_size     the size of each element in the array; must be positive
+ * @param flags         either 0 or ARRAY_HUGE_PAGES
+ *
+ * @return the newly-initialized array, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+array array_init_mapped(const int element_count,
+                        const size_t data_size,
+                        const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_array *init;
+    if (element_count <= 0 || data_size == 0) {
+        return array_init(element_count, data_size);
+    }
+    init = malloc(sizeof(struct internal_array));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = element_count;
+    init->map_offset = 0;
+    init->mapped_size = array_map_round(element_count * data_size, flags);
+    init->data = mmap(NULL, init->mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (init->data == MAP_FAILED) {
+        free(init);
+        return NULL;
+    }
+    array_map_advise(init, flags);
+    return init;
+#else
+    (void) flags;
+    return array_init(element_count, data_size);
+#endif
+}
+
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Maps the file which is open as fd, and either validates its header or, if
+ * the file has just been created, writes the header. The item count of the
+ * header is rejected with -EINVAL if it does not fit in an int, or if the
+ * file is too small to hold that many elements.
+ */
+static int array_map_file(array me, const int fd, const int is_new,
+                          const int flags)
+{
+    struct mapped_header *header;
+    void *const base = mmap(NULL, me->mapped_size, PROT_READ | PROT_WRITE,
+                            (flags & ARRAY_READ_ONLY) ? MAP_PRIVATE
+                                                      : MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    header = base;
+    if (is_new) {
+        memcpy(header->magic, MAPPED_MAGIC, sizeof(header->magic));
+        header->data_size = me->bytes_per_item;
+        header->item_count = (unsigned long) me->item_count;
+    } else if (memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) != 0
+               || header->data_size != me->bytes_per_item
+               || header->item_count > INT_MAX
+               || header->item_count > (me->mapped_size - me->map_offset)
+                                       / me->bytes_per_item) {
+        munmap(base, me->mapped_size);
+        return -EINVAL;
+    }
+    me->item_count = (int) header->item_count;
+    me->data = (char *) base + me->map_offset;
+    array_map_advise(me, flags);
+    return 0;
+}
+
+/*
+ * Opens the file at path, creating it if requested, and maps it.
+ */
+static int array_open_file(array me, const char *const path, const int flags)
+{
+    struct stat info;
+    int is_new = 0;
+    int mode = O_RDWR;
+    int rc;
+    int fd;
+    if (flags & ARRAY_READ_ONLY) {
+        mode = O_RDONLY;
+    } else if (flags & ARRAY_CREATE) {
+        mode |= O_CREAT;
+    }
+    fd = open(path, mode, 0644);
+    if (fd == -1) {
+        return -EIO;
+    }
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return -EIO;
+    }
+    me->mapped_size = (size_t) info.st_size;
+    if (me->mapped_size == 0 && (flags & ARRAY_CREATE)
+        && !(flags & ARRAY_READ_ONLY)) {
+        is_new = 1;
+        me->mapped_size = me->map_offset + me->item_count * me->bytes_per_item;
+        if (ftruncate(fd, (off_t) me->mapped_size) == -1) {
+            close(fd);
+            return -ENOMEM;
+        }
+    }
+    rc = -EINVAL;
+    if (me->mapped_size >= me->map_offset) {
+        rc = array_map_file(me, fd, is_new, flags);
+    }
+    close(fd);
+    return rc;
+}
+
+#endif
+
+/**
+ * Opens an array which is backed by the file at the specified path. The file
+ * is memory-mapped, so opening a prebuilt file takes constant time regardless
+ * of its size, and the data is neither parsed nor copied. The file uses the
+ * same format as files opened with vector_open_mapped, thus an array may be
+ * opened from a file which was built using a vector.
+ *
+ * By default, the file is mapped as shared and writable, thus modifications to
+ * the array are written to the file. If ARRAY_READ_ONLY is specified in the
+ * flags, the file is opened as read-only and its pages are shared with every
+ * other process which maps the file. Modifications to a read-only array are
+ * private to it and are never written to the file. If ARRAY_CREATE is
+ * specified in the flags, the file is created with element_count zeroed
+ * elements if it does not exist yet. If ARRAY_HUGE_PAGES is specified in the
+ * flags, the kernel is advised to back the mapping with huge pages.
+ *
+ * The file stores the raw bytes of the elements, thus it should only be opened
+ * on a machine with the same data representation as the one it was written on.
+ *
+ * @param path          the path of the file to back the array with
+ * @param element_count the number of elements in the array if the file is
+ *                      created; otherwise, the number of elements is read from
+ *                      the file; must not be negative
+ * @param data_size     the size of each element in the array; must be positive
+ *                      and must match the element size which the file was
+ *                      created with
+ * @param flags         a combination of ARRAY_READ_ONLY, ARRAY_CREATE and
+ *                      ARRAY_HUGE_PAGES
+ *
+ * @return the newly-opened array, or NULL if it was not successfully opened
+ *         due to either invalid input arguments, the file not being a valid
+ *         array file, an error opening or mapping the file, or memory
+ *         allocation error
+ */
+array array_open_mapped(const char *const path,
+                        const int element_count,
+                        const size_t data_size,
+                        const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_array *init;
+    if (!path || element_count < 0 || data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_array));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = element_count;
+    init->map_offset = HEADER_SIZE;
+    if (array_open_file(init, path, flags) != 0) {
+        free(init);
+        return NULL;
+    }
+    return init;
+#else
+    (void) path;
+    (void) element_count;
+    (void) data_size;
+    (void) flags;
+    return NULL;
+#endif
+}
+
+/**
+ * Gets the size of the array.
+ *
+ * @param me the array to check
+ *
+ * @return the size of the array
+ */
+int array_size(array me)
+{
+    return me->item_count;
+}
+
+/**
+ * Copies the array to a raw array. Since it is a copy, the raw array may be
+ * modified without causing side effects to the array data structure. Memory
+ * is not allocated, thus the raw array being used for the copy must be
+ * allocated before this function is called. The size of the array should be
+ * queried prior to calling this function, which also serves as the size of the
+ * newly-copied raw array.
+ *
+ * @param arr the initialized raw array to copy the array to
+ * @param me  the array to copy to the raw array
+ */
+void array_copy_to_array(void *const arr, array me)
+{
+    if (me->item_count == 0) {
+        return;
+    }
+    memcpy(arr, me->data, me->item_count * me->bytes_per_item);
+}
+
+/**
+ * Gets the storage element of the array structure. The storage element is
+ * contiguous in memory. The data pointer should be assigned to the correct
+ * array type. For example, if the array holds integers, the data pointer should
+ * be assigned to a raw integer array. The size of the array should be obtained
+ * prior to calling this function, which also serves as the size of the queried
+ * raw array. This pointer is not a copy, thus any modification to the data will
+ * cause the array structure data to be modified. Operations using the array
+ * functions may invalidate this pointer. The array owns this memory, thus it
+ * should not be freed.
+ *
+ * @param me the array to get the storage element from
+ *
+ * @return the storage element of the array
+ */
+void *array_get_data(array me)
+{
+    return me->data;
+}
+
+/**
+ * Sorts the elements of the array in ascending order according to the
+ * comparator. The built-in scalar comparators from compare.h select a radix
+ * sort when they match the element size, and any other comparator is used by
+ * an introsort. The sort is not stable.
+ *
+ * @param me         the array to sort
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ */
+void array_sort(array me,
+                int (*const comparator)(const void *const one,
+                                        const void *const two))
+{
+    containers_sort(me->data, me->item_count, me->bytes_per_item, comparator);
+}
+
+/**
+ * Gets the index of the first element of the array which is not less than the
+ * key, which is the size of the array if there is no such element. The array
+ * must be sorted in ascending order according to the comparator. The search
+ * is branchless, so it does not suffer branch mispredictions.
+ *
+ * @param me         the array to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the first element which is not less than the key
+ */
+int array_lower_bound(array me,
+                      void *const key,
+                      int (*const comparator)(const void *const one,
+                                              const void *const two))
+{
+    return containers_lower_bound(me->data, me->item_count, me->bytes_per_item,
+                                  key, comparator);
+}
+
+/**
+ * Rearranges the elements of the array, which must be sorted in ascending
+ * order, into Eytzinger order. This is the breadth-first order of an implicit
+ * binary search tree, which makes searches of large arrays cache-friendly. The
+ * array is no longer sorted afterwards, and must be searched with
+ * array_eytzinger_lower_bound.
+ *
+ * @param me the array to rearrange
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int array_eytzinger_layout(array me)
+{
+    return containers_eytzinger_layout(me->data, me->item_count,
+                                       me->bytes_per_item);
+}
+
+/**
+ * Gets the index of the smallest element of the array which is not less than
+ * the key, which is the size of the array if there is no such element. The
+ * array must have been rearranged with array_eytzinger_layout. The search
+ * prefetches the elements it visits a few steps ahead, so on arrays far larger
+ * than the cache it is much faster than array_lower_bound.
+ *
+ * @param me         the array to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the smallest element which is not less than the key
+ */
+int array_eytzinger_lower_bound(array me,
+                                void *const key,
+                                int (*const comparator)(const void *const one,
+                                                        const void *const two))
+{
+    return containers_eytzinger_lower_bound(me->data, me->item_count,
+                                            me->bytes_per_item, key,
+                                            comparator);
+}
+
+/**
+ * Writes the elements of a file-backed array to its file, and waits for the
+ * write to complete. For arrays which are not backed by a file, or which were
+ * opened as read-only, this has no effect.
+ *
+ * @param me the array to synchronize
+ *
+ * @return 0    if no error
+ * @return -EIO if the file could not be written
+ */
+int array_sync(array me)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->map_offset && msync((char *) me->data - me->map_offset,
+                                me->mapped_size, MS_SYNC) == -1) {
+        return -EIO;
+    }
+#else
+    (void) me;
+#endif
+    return 0;
+}
+
+/*
+ * Determines if the input is illegal.
+ */
+static int array_is_illegal_input(array me, const int index)
+{
+    return index < 0 || index >= me->item_count;
+}
+
+/**
+ * Sets the data for a specified element in the array. The pointer to the data
+ * being passed in should point to the data type which this array holds. For
+ * example, if this array holds integers, the data pointer should be a pointer
+ * to an integer. Since the data is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me    the array to set data for
+ * @param index the location to set data at in the array
+ * @param data  the data to set at the location in the array
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int array_set(array me, const int index, void *const data)
+{
+    if (array_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    memcpy((char *) me->data + index * me->bytes_per_item, data,
+           me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Copies the element at an index of the array to data. The pointer to the data
+ * being obtained should point to the data type which this array holds. For
+ * example, if this array holds integers, the data pointer should be a pointer
+ * to an integer. Since this data is being copied from the array to the data
+ * pointer, the pointer only has to be valid when this function is called.
+ *
+ *
+ * @param data  the data to copy to
+ * @param me    the array to copy from
+ * @param index the index to copy from in the array
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int array_get(void *const data, array me, const int index)
+{
+    if (array_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    memcpy(data, (char *) me->data + index * me->bytes_per_item,
+           me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Frees the array memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the array to free from memory
+ *
+ * @return NULL
+ */
+array array_destroy(array me)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->mapped_size) {
+        munmap((char *) me->data - me->map_offset, me->mapped_size);
+    } else {
+        free(me->data);
+    }
+#else
+    free(me->data);
+#endif
+    free(me);
+    return NULL;
+}
+#undef HEADER_SIZE
+#undef HUGE_PAGE_SIZE
+#undef MAPPED_MAGIC
+#undef mapped_header
+
+
+
+/**
+ * Compares two keys which are ints.
+ *
+ * @param one the first int
+ * @param two the second int
+ *
+ * @return a negative value if the first int is smaller, a positive value if it
+ *         is larger, otherwise 0
+ */
+int containers_compare_int(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are longs.
+ *
+ * @param one the first long
+ * @param two the second long
+ *
+ * @return a negative value if the first long is smaller, a positive value if it
+ *         is larger, otherwise 0
+ */
+int containers_compare_long(const void *const one, const void *const two)
+{
+    const long a = *(const long *) one;
+    const long b = *(const long *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are unsigned ints.
+ *
+ * @param one the first unsigned int
+ * @param two the second unsigned int
+ *
+ * @return a negative value if the first unsigned int is smaller, a positive
+ *         value if it is larger, otherwise 0
+ */
+int containers_compare_uint(const void *const one, const void *const two)
+{
+    const unsigned int a = *(const unsigned int *) one;
+    const unsigned int b = *(const unsigned int *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are unsigned longs.
+ *
+ * @param one the first unsigned long
+ * @param two the second unsigned long
+ *
+ * @return a negative value if the first unsigned long is smaller, a positive
+ *         value if it is larger, otherwise 0
+ */
+int containers_compare_ulong(const void *const one, const void *const two)
+{
+    const unsigned long a = *(const unsigned long *) one;
+    const unsigned long b = *(const unsigned long *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are floats.
+ *
+ * @param one the first float
+ * @param two the second float
+ *
+ * @return a negative value if the first float is smaller, a positive value if
+ *         it is larger, otherwise 0
+ */
+int containers_compare_float(const void *const one, const void *const two)
+{
+    const float a = *(const float *) one;
+    const float b = *(const float *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are doubles.
+ *
+ * @param one the first double
+ * @param two the second double
+ *
+ * @return a negative value if the first double is smaller, a positive value if
+ *         it is larger, otherwise 0
+ */
+int containers_compare_double(const void *const one, const void *const two)
+{
+    const double a = *(const double *) one;
+    const double b = *(const double *) two;
+    return (a > b) - (a < b);
+}
+
+
+#include <string.h>
+#include <errno.h>
+
+#define BLOCK_SIZE deque_BLOCK_SIZE
+#define RESIZE_RATIO deque_RESIZE_RATIO
+#define node deque_node
+static const int BLOCK_SIZE = 8;
+static const double RESIZE_RATIO = 1.5;
+
+struct internal_deque {
+    size_t data_size;
+    int start_index;
+    int end_index;
+    int block_count;
+    struct node *block;
+};
+
+struct node {
+    void *data;
+};
+
+/**
+ * Initializes a deque.
+ *
+ * @param data_size the size of each element in the deque; must be positive
+ *
+ * @return the newly-initialized deque, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+deque deque_init(const size_t data_size)
+{
+    struct internal_deque *init;
+    struct node *block;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_deque));
+    if (!init) {
+        return NULL;
+    }
+    init->data_size = data_size;
+    init->start_index = BLOCK_SIZE / 2;
+    init->end_index = init->start_index + 1;
+    init->block_count = 1;
+    init->block = malloc(sizeof(struct node));
+    if (!init->block) {
+        free(init);
+        return NULL;
+    }
+    block = init->block;
+    block->data = malloc(BLOCK_SIZE * init->data_size);
+    if (!block->data) {
+        free(init->block);
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Determines the size of the deque. The size is the number of data spaces being
+ * used. The size starts at zero, and every time an element is added, it
+ * increases by one.
+ *
+ * @param me the deque to check the size of
+ *
+ * @return the size of the deque
+ */
+int deque_size(deque me)
+{
+    return me->end_index - me->start_index - 1;
+}
+
+/**
+ * Determines if the deque is empty. It is empty if it has no elements.
+ *
+ * @param me the deque to check if empty
+ *
+ * @return 1 if the deque is empty, otherwise 0
+ */
+int deque_is_empty(deque me)
+{
+    return deque_size(me) == 0;
+}
+
+/**
+ * Trims the deque so that it does not use memory which does not need to be
+ * used.
+ *
+ * @param me the deque to trim
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int deque_trim(deque me)
+{
+    int i;
+    /* The start and end blocks are written like this because in C89    */
+    /* negative integer division and modulo are implementation-defined. */
+    const int start_block =
+            me->start_index == -1 ? 0 : me->start_index / BLOCK_SIZE;
+    const int end_block =
+            me->end_index == 0 ? 0 : (me->end_index - 1) / BLOCK_SIZE;
+    const int new_block_count = end_block - start_block + 1;
+    void *const new_block = malloc(new_block_count * sizeof(struct node));
+    if (!new_block) {
+        return -ENOMEM;
+    }
+    for (i = 0; i < start_block; i++) {
+        const struct node block_item = me->block[i];
+        free(block_item.data);
+    }
+    for (i = end_block + 1; i < me->block_count; i++) {
+        const struct node block_item = me->block[i];
+        free(block_item.data);
+    }
+    memcpy(new_block,
+           &me->block[start_block],
+           new_block_count * sizeof(struct node));
+    free(me->block);
+    me->block = new_block;
+    me->block_count = new_block_count;
+    me->start_index -= start_block * BLOCK_SIZE;
+    me->end_index -= start_block * BLOCK_SIZE;
+    return 0;
+}
+
+/**
+ * Copies the deque to an array. Since it is a copy, the array may be modified
+ * without causing side effects to the deque data structure. Memory is not
+ * allocated, thus the array being used for the copy must be allocated before
+ * this function is called. The size of the deque should be queried prior to
+ * calling this function, which also serves as the size of the newly-copied
+ * array.
+ *
+ * @param arr the initialized array to copy the deque to
+ * @param me  the deque to copy to the array
+ */
+void deque_copy_to_array(void *const arr, deque me)
+{
+    int i;
+    for (i = 0; i < deque_size(me); i++) {
+        deque_get_at((char *) arr + i * me->data_size, me, i);
+    }
+}
+
+/*
+ * Copies the elements between the blocks of the deque and a contiguous array,
+ * a run of contiguous elements at a time. The elements are copied into the
+ * deque if to_deque is set, and out of it otherwise.
+ */
+static void deque_copy_blocks(deque me, char *arr, const int to_deque)
+{
+    int index = me->start_index + 1;
+    while (index < me->end_index) {
+        const int inner_index = index % BLOCK_SIZE;
+        char *const run = (char *) me->block[index / BLOCK_SIZE].data
+                          + inner_index * me->data_size;
+        int count = BLOCK_SIZE - inner_index;
+        if (count > me->end_index - index) {
+            count = me->end_index - index;
+        }
+        if (to_deque) {
+            memcpy(run, arr, count * me->data_size);
+        } else {
+            memcpy(arr, run, count * me->data_size);
+        }
+        arr += count * me->data_size;
+        index += count;
+    }
+}
+
+/**
+ * Sorts the elements of the deque in ascending order according to the
+ * comparator. Since the elements are stored in blocks, they are copied into a
+ * contiguous array, sorted there, and copied back. The built-in scalar
+ * comparators from compare.h select a radix sort when they match the element
+ * size, and any other comparator is used by an introsort. The sort is not
+ * stable.
+ *
+ * @param me         the deque to sort
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int deque_sort(deque me,
+               int (*const comparator)(const void *const one,
+                                       const void *const two))
+{
+    const int size = deque_size(me);
+    char *temp;
+    if (size < 2) {
+        return 0;
+    }
+    temp = malloc(size * me->data_size);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    deque_copy_blocks(me, temp, 0);
+    containers_sort(temp, size, me->data_size, comparator);
+    deque_copy_blocks(me, temp, 1);
+    free(temp);
+    return 0;
+}
+
+/**
+ * Adds an element to the front of the deque. The pointer to the data being
+ * passed in should point to the data type which this deque holds. For example,
+ * if this deque holds integers, the data pointer should be a pointer to an
+ * integer. Since the data is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me   the deque to add an element to
+ * @param data the element to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int deque_push_front(deque me, void *const data)
+{
+    struct node block_item;
+    int block_index;
+    int inner_index;
+    if (me->start_index == -1) {
+        block_index = -1;
+        inner_index = BLOCK_SIZE - 1;
+    } else {
+        block_index = me->start_index / BLOCK_SIZE;
+        inner_index = me->start_index % BLOCK_SIZE;
+    }
+    if (inner_index == BLOCK_SIZE - 1) {
+        struct node *block_item_reference;
+        if (block_index == -1) {
+            int i;
+            const int old_block_count = me->block_count;
+            const int new_block_count =
+                    (int) (RESIZE_RATIO * me->block_count) + 1;
+            const int added_blocks = new_block_count - old_block_count;
+            void *temp = realloc(me->block,
+                                 new_block_count * sizeof(struct node));
+            if (!temp) {
+                return -ENOMEM;
+            }
+            me->block = temp;
+            me->block_count = new_block_count;
+            memmove(&me->block[added_blocks],
+                    me->block,
+                    old_block_count * sizeof(struct node));
+            block_index = added_blocks - 1;
+            me->start_index += added_blocks * BLOCK_SIZE;
+            me->end_index += added_blocks * BLOCK_SIZE;
+            for (i = 0; i < added_blocks; i++) {
+                struct node *const block_item_copy = &me->block[i];
+                block_item_copy->data = NULL;
+            }
+        }
+        block_item_reference = &me->block[block_index];
+        if (!block_item_reference->data) {
+            block_item_reference->data = malloc(BLOCK_SIZE * me->data_size);
+            if (!block_item_reference->data) {
+                return -ENOMEM;
+            }
+        }
+    }
+    block_item = me->block[block_index];
+    memcpy((char *) block_item.data + inner_index * me->data_size, data,
+           me->data_size);
+    me->start_index--;
+    return 0;
+}
+
+/**
+ * Adds an element to the back of the deque. The pointer to the data being
+ * passed in should point to the data type which this deque holds. For example,
+ * if this deque holds integers, the data pointer should be a pointer to an
+ * integer. Since the data is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me   the deque to add an element to
+ * @param data the element to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int deque_push_back(deque me, void *const data)
+{
+    struct node block_item;
+    const int block_index = me->end_index / BLOCK_SIZE;
+    const int inner_index = me->end_index % BLOCK_SIZE;
+    if (inner_index == 0) {
+        struct node *block_item_reference;
+        if (block_index == me->block_count) {
+            int i;
+            const int new_block_count =
+                    (int) (RESIZE_RATIO * me->block_count) + 1;
+            void *temp = realloc(me->block,
+                                 new_block_count * sizeof(struct node));
+            if (!temp) {
+                return -ENOMEM;
+            }
+            me->block = temp;
+            me->block_count = new_block_count;
+            for (i = block_index; i < me->block_count; i++) {
+                struct node *const block_item_copy = &me->block[i];
+                block_item_copy->data = NULL;
+            }
+        }
+        block_item_reference = &me->block[block_index];
+        if (!block_item_reference->data) {
+            block_item_reference->data = malloc(BLOCK_SIZE * me->data_size);
+            if (!block_item_reference->data) {
+                return -ENOMEM;
+            }
+        }
+    }
+    block_item = me->block[block_index];
+    memcpy((char *) block_item.data + inner_index * me->data_size, data,
+           me->data_size);
+    me->end_index++;
+    return 0;
+}
+
+/**
+ * Removes the front element from the deque and copies it to a data value. The
+ * pointer to the data being obtained should point to the data type which this
+ * deque holds. For example, if this deque holds integers, the data pointer
+ * should be a pointer to an integer. Since this data is being copied from the
+ * array to the data pointer, the pointer only has to be valid when this
+ * function is called.
+ *
+ * @param data the value to copy to
+ * @param me   the deque to remove from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_pop_front(void *const data, deque me)
+{
+    int block_index;
+    int inner_index;
+    struct node block_item;
+    if (deque_is_empty(me)) {
+        return -EINVAL;
+    }
+    me->start_index++;
+    block_index = me->start_index / BLOCK_SIZE;
+    inner_index = me->start_index % BLOCK_SIZE;
+    block_item = me->block[block_index];
+    memcpy(data, (char *) block_item.data + inner_index * me->data_size,
+           me->data_size);
+    return 0;
+}
+
+/**
+ * Removes the back element from the deque and copies it to a data value. The
+ * pointer to the data being obtained should point to the data type which this
+ * deque holds. For example, if this deque holds integers, the data pointer
+ * should be a pointer to an integer. Since this data is being copied from the
+ * array to the data pointer, the pointer only has to be valid when this
+ * function is called.
+ *
+ * @param data the value to copy to
+ * @param me   the deque to remove from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_pop_back(void *const data, deque me)
+{
+    int block_index;
+    int inner_index;
+    struct node block_item;
+    if (deque_is_empty(me)) {
+        return -EINVAL;
+    }
+    me->end_index--;
+    block_index = me->end_index / BLOCK_SIZE;
+    inner_index = me->end_index % BLOCK_SIZE;
+    block_item = me->block[block_index];
+    memcpy(data, (char *) block_item.data + inner_index * me->data_size,
+           me->data_size);
+    return 0;
+}
+
+/**
+ * Sets the first value of the deque. The pointer to the data being passed in
+ * should point to the data type which this deque holds. For example, if this
+ * deque holds integers, the data pointer should be a pointer to an integer.
+ * Since the data is being copied, the pointer only has to be valid when this
+ * function is called.
+ *
+ * @param me   the deque to set the value of
+ * @param data the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_set_first(deque me, void *const data)
+{
+    return deque_set_at(me, 0, data);
+}
+
+/**
+ * Sets the value of the deque at the specified index. The pointer to the data
+ * being passed in should point to the data type which this deque holds. For
+ * example, if this deque holds integers, the data pointer should be a pointer
+ * to an integer. Since the data is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me    the deque to set the value of
+ * @param index the index to set at
+ * @param data  the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_set_at(deque me, int index, void *const data)
+{
+    int block_index;
+    int inner_index;
+    struct node block_item;
+    if (index < 0 || index >= deque_size(me)) {
+        return -EINVAL;
+    }
+    index += me->start_index + 1;
+    block_index = index / BLOCK_SIZE;
+    inner_index = index % BLOCK_SIZE;
+    block_item = me->block[block_index];
+    memcpy((char *) block_item.data + inner_index * me->data_size, data,
+           me->data_size);
+    return 0;
+}
+
+/**
+ * Sets the last value of the deque. The pointer to the data being passed in
+ * should point to the data type which this deque holds. For example, if this
+ * deque holds integers, the data pointer should be a pointer to an integer.
+ * Since the data is being copied, the pointer only has to be valid when this
+ * function is called.
+ *
+ * @param me   the deque to set the value of
+ * @param data the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_set_last(deque me, void *const data)
+{
+    return deque_set_at(me, deque_size(me) - 1, data);
+}
+
+/**
+ * Gets the first value of the deque. The pointer to the data being obtained
+ * should point to the data type which this deque holds. For example, if this
+ * deque holds integers, the data pointer should be a pointer to an integer.
+ * Since this data is being copied from the array to the data pointer, the
+ * pointer only has to be valid when this function is called.
+ *
+ * @param data the data to set
+ * @param me   the deque to set the value of
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_get_first(void *const data, deque me)
+{
+    return deque_get_at(data, me, 0);
+}
+
+/**
+ * Gets the value of the deque at the specified index. The pointer to the data
+ * being obtained should point to the data type which this deque holds. For
+ * example, if this deque holds integers, the data pointer should be a pointer
+ * to an integer. Since this data is being copied from the array to the data
+ * pointer, the pointer only has to be valid when this function is called.
+ *
+ * @param data  the data to set
+ * @param me    the deque to set the value of
+ * @param index the index to set at
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_get_at(void *const data, deque me, int index)
+{
+    int block_index;
+    int inner_index;
+    struct node block_item;
+    if (index < 0 || index >= deque_size(me)) {
+        return -EINVAL;
+    }
+    index += me->start_index + 1;
+    block_index = index / BLOCK_SIZE;
+    inner_index = index % BLOCK_SIZE;
+    block_item = me->block[block_index];
+    memcpy(data, (char *) block_item.data + inner_index * me->data_size,
+           me->data_size);
+    return 0;
+}
+
+/**
+ * Gets a reference to the element of the deque at the specified index. Since
+ * the elements are stored in blocks which are never moved, the reference
+ * remains valid when elements are added to either end of the deque. It is
+ * invalidated when its element is removed, or when the deque is trimmed,
+ * cleared, or destroyed. The element may be modified through the reference.
+ *
+ * @param me    the deque to get the reference from
+ * @param index the index of the element
+ *
+ * @return the reference to the element, or NULL if the index is out of bounds
+ */
+void *deque_get_ref_at(deque me, int index)
+{
+    if (index < 0 || index >= deque_size(me)) {
+        return NULL;
+    }
+    index += me->start_index + 1;
+    return (char *) me->block[index / BLOCK_SIZE].data
+           + (index % BLOCK_SIZE) * me->data_size;
+}
+
+/**
+ * Calls the callback on each run of contiguous elements of the deque, from the
+ * front to the back. Each call receives a pointer to the first element of the
+ * run, the amount of elements in the run, and the context. Thus, the elements
+ * can be processed in place, a block at a time. The elements may be modified,
+ * but elements must not be added to or removed from the deque by the callback.
+ * If the callback returns a non-zero value, the iteration stops.
+ *
+ * @param me       the deque to iterate over
+ * @param callback the function to call on each run of elements
+ * @param context  the context to pass to the callback
+ *
+ * @return 0 if every run was visited, otherwise the non-zero value which the
+ *         callback returned
+ */
+int deque_for_each_block(deque me,
+                         int (*const callback)(void *data, int count,
+                                               void *context),
+                         void *const context)
+{
+    int index = me->start_index + 1;
+    while (index < me->end_index) {
+        const int inner_index = index % BLOCK_SIZE;
+        int count = BLOCK_SIZE - inner_index;
+        int rc;
+        if (count > me->end_index - index) {
+            count = me->end_index - index;
+        }
+        rc = callback((char *) me->block[index / BLOCK_SIZE].data
+                      + inner_index * me->data_size, count, context);
+        if (rc != 0) {
+            return rc;
+        }
+        index += count;
+    }
+    return 0;
+}
+
+/**
+ * Gets the last value of the deque. The pointer to the data being obtained
+ * should point to the data type which this deque holds. For example, if this
+ * deque holds integers, the data pointer should be a pointer to an integer.
+ * Since this data is being copied from the array to the data pointer, the
+ * pointer only has to be valid when this function is called.
+ *
+ * @param data the data to set
+ * @param me   the deque to set the value of
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int deque_get_last(void *const data, deque me)
+{
+    return deque_get_at(data, me, deque_size(me) - 1);
+}
+
+/**
+ * Clears the deque and sets it to the original state from initialization.
+ *
+ * @param me the deque to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int deque_clear(deque me)
+{
+    void *temp_block_data;
+    int i;
+    struct node *block;
+    struct node *const temp_block = malloc(sizeof(struct node));
+    if (!temp_block) {
+        return -ENOMEM;
+    }
+    temp_block_data = malloc(BLOCK_SIZE * me->data_size);
+    if (!temp_block_data) {
+        free(temp_block);
+        return -ENOMEM;
+    }
+    for (i = 0; i < me->block_count; i++) {
+        const struct node block_item = me->block[i];
+        free(block_item.data);
+    }
+    free(me->block);
+    me->start_index = BLOCK_SIZE / 2;
+    me->end_index = me->start_index + 1;
+    me->block_count = 1;
+    me->block = temp_block;
+    block = me->block;
+    block->data = temp_block_data;
+    return 0;
+}
+
+/**
+ * Destroys the deque. Performing further operations after calling this function
+ * results in undefined behavior.
+ *
+ * @param me the deque to destroy
+ *
+ * @return NULL
+ */
+deque deque_destroy(deque me)
+{
+    int i;
+    for (i = 0; i < me->block_count; i++) {
+        const struct node block_item = me->block[i];
+        free(block_item.data);
+    }
+    free(me->block);
+    free(me);
+    return NULL;
+}
+#undef BLOCK_SIZE
+#undef RESIZE_RATIO
+#undef node
+
+
+#include <string.h>
+#include <errno.h>
+
+struct internal_flat_map {
+    size_t key_size;
+    size_t value_size;
+    int (*comparator)(const void *const one, const void *const two);
+    vector keys;
+    vector values;
+};
+
+/**
+ * Initializes a flat map, which keeps its keys sorted in a vector, and their
+ * values in a separate vector in the same order.
+ *
+ * @param key_size   the size of each key in the flat map; must be positive
+ * @param value_size the size of each value in the flat map; must be positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized flat map, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+flat_map flat_map_init(const size_t key_size,
+                       const size_t value_size,
+                       int (*const comparator)(const void *const,
+                                               const void *const))
+{
+    struct internal_flat_map *init;
+    if (key_size == 0 || value_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_flat_map));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->value_size = value_size;
+    init->comparator = comparator;
+    init->keys = vector_init(key_size);
+    if (!init->keys) {
+        free(init);
+        return NULL;
+    }
+    init->values = vector_init(value_size);
+    if (!init->values) {
+        vector_destroy(init->keys);
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Gets the size of the flat map.
+ *
+ * @param me the flat map to check
+ *
+ * @return the size of the flat map
+ */
+int flat_map_size(flat_map me)
+{
+    return vector_size(me->keys);
+}
+
+/**
+ * Determines whether or not the flat map is empty.
+ *
+ * @param me the flat map to check
+ *
+ * @return 1 if the flat map is empty, otherwise 0
+ */
+int flat_map_is_empty(flat_map me)
+{
+    return flat_map_size(me) == 0;
+}
+
+/**
+ * Reserves space for the specified amount of key-value pairs. If more space
+ * than specified is already reserved, then the previous space will be kept.
+ *
+ * @param me   the flat map to reserve space for
+ * @param size the amount of key-value pairs to reserve space for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_map_reserve(flat_map me, const int size)
+{
+    const int rc = vector_reserve(me->keys, size);
+    if (rc != 0) {
+        return rc;
+    }
+    return vector_reserve(me->values, size);
+}
+
+/**
+ * Gets the storage of the keys of the flat map, which are held contiguously in
+ * sorted order. This pointer is not a copy, and is invalidated by operations
+ * which add or remove keys. The keys must not be modified in a way which
+ * changes their order. The flat map owns this memory, thus it should not be
+ * freed.
+ *
+ * @param me the flat map to get the keys of
+ *
+ * @return the storage of the keys
+ */
+void *flat_map_get_keys(flat_map me)
+{
+    return vector_get_data(me->keys);
+}
+
+/**
+ * Gets the storage of the values of the flat map, which are held contiguously
+ * in the same order as their keys. This pointer is not a copy, and is
+ * invalidated by operations which add or remove keys. The flat map owns this
+ * memory, thus it should not be freed.
+ *
+ * @param me the flat map to get the values of
+ *
+ * @return the storage of the values
+ */
+void *flat_map_get_values(flat_map me)
+{
+    return vector_get_data(me->values);
+}
+
+/*
+ * Compares two keys.
+ */
+static int flat_map_compare(flat_map me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/*
+ * Gets the index of the first key which is not less than the specified key,
+ * with the branchless binary search of containers_lower_bound.
+ */
+static int flat_map_search(flat_map me, const void *const key)
+{
+    return containers_lower_bound(vector_get_data(me->keys),
+                                  vector_size(me->keys), me->key_size,
+                                  (void *) key, me->comparator);
+}
+
+/*
+ * Determines whether the key at the index is equal to the specified key.
+ */
+static int flat_map_is_at(flat_map me, const int index, const void *const key)
+{
+    const char *const data = vector_get_data(me->keys);
+    return index < vector_size(me->keys)
+           && flat_map_compare(me, data + index * me->key_size, key) == 0;
+}
+
+/**
+ * Adds a key-value pair to the flat map. If the flat map already contains the
+ * key, the value is updated to the new value. The pairs after it are moved to
+ * make room for it, so adding a new key takes linear time. To add many pairs,
+ * flat_map_put_all is faster. The pointers to the key and value being passed
+ * in should point to the key and value type which this flat map holds. Since
+ * the key and value are being copied, the pointers only have to be valid when
+ * this function is called.
+ *
+ * @param me    the flat map to add to
+ * @param key   the key to add
+ * @param value the value that the key maps to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_map_put(flat_map me, void *const key, void *const value)
+{
+    const int index = flat_map_search(me, key);
+    int rc;
+    if (flat_map_is_at(me, index, key)) {
+        return vector_set_at(me->values, index, value);
+    }
+    rc = vector_add_at(me->keys, index, key);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = vector_add_at(me->values, index, value);
+    if (rc != 0) {
+        vector_remove_at(me->keys, index);
+    }
+    return rc;
+}
+
+/**
+ * Adds many key-value pairs to the flat map at once. The pairs are copied and
+ * sorted with one sort, and are then merged with the pairs of the flat map from
+ * the back, so that each pair of the flat map is moved at most once. Thus, this
+ * takes O(n + k log k) time for k pairs, rather than the O(n k) time of adding
+ * them one at a time. If the flat map already contains a key, its value is
+ * updated to the new value. If a key is repeated in the pairs being added, it
+ * is only added once, with one of its values.
+ *
+ * @param me     the flat map to add to
+ * @param keys   the keys to add
+ * @param values the values that the keys map to, in the same order
+ * @param count  the amount of key-value pairs to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_map_put_all(flat_map me,
+                     void *const keys,
+                     void *const values,
+                     const int count)
+{
+    const size_t key_size = me->key_size;
+    const size_t value_size = me->value_size;
+    const size_t pair_size = key_size + value_size;
+    const int size = vector_size(me->keys);
+    char *key_data = vector_get_data(me->keys);
+    char *value_data = vector_get_data(me->values);
+    char *batch;
+    int unique = 0;
+    int index = 0;
+    int out;
+    int rc;
+    int i;
+    if (count < 0) {
+        return -EINVAL;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    batch = malloc(count * pair_size);
+    if (!batch) {
+        return -ENOMEM;
+    }
+    for (i = 0; i < count; i++) {
+        memcpy(batch + i * pair_size, (char *) keys + i * key_size, key_size);
+        memcpy(batch + i * pair_size + key_size,
+               (char *) values + i * value_size, value_size);
+    }
+    /*
+     * The pairs are larger than the keys, so the comparator only sees keys. The
+     * containers_compare_key marker compares all the bytes of each pair, which
+     * orders the pairs by their keys since the keys come first, and only orders
+     * repeated keys by their values.
+     */
+    containers_sort(batch, count, pair_size, me->comparator);
+    for (i = 0; i < count; i++) {
+        const char *const pair = batch + i * pair_size;
+        if (i > 0 && flat_map_compare(me, pair - pair_size, pair) == 0) {
+            continue;
+        }
+        while (index < size
+               && flat_map_compare(me, key_data + index * key_size, pair) < 0) {
+            index++;
+        }
+        if (flat_map_is_at(me, index, pair)) {
+            memcpy(value_data + index * value_size, pair + key_size,
+                   value_size);
+            continue;
+        }
+        if (unique != i) {
+            memcpy(batch + unique * pair_size, pair, pair_size);
+        }
+        unique++;
+    }
+    rc = flat_map_reserve(me, size + unique);
+    if (rc != 0) {
+        free(batch);
+        return rc;
+    }
+    for (i = 0; i < unique; i++) {
+        const char *const pair = batch + i * pair_size;
+        vector_add_last(me->keys, (void *) pair);
+        vector_add_last(me->values, (void *) (pair + key_size));
+    }
+    key_data = vector_get_data(me->keys);
+    value_data = vector_get_data(me->values);
+    index = size - 1;
+    out = size + unique - 1;
+    for (i = unique - 1; i >= 0; out--) {
+        const char *const pair = batch + i * pair_size;
+        if (index >= 0
+            && flat_map_compare(me, key_data + index * key_size, pair) > 0) {
+            memcpy(key_data + out * key_size, key_data + index * key_size,
+                   key_size);
+            memcpy(value_data + out * value_size,
+                   value_data + index * value_size, value_size);
+            index--;
+        } else {
+            memcpy(key_data + out * key_size, pair, key_size);
+            memcpy(value_data + out * value_size, pair + key_size, value_size);
+            i--;
+        }
+    }
+    free(batch);
+    return 0;
+}
+
+/**
+ * Replaces the key-value pairs of the flat map with the specified pairs, which
+ * are sorted with one sort. If an error occurs, the flat map is left empty.
+ *
+ * @param me     the flat map to replace the key-value pairs of
+ * @param keys   the keys to hold
+ * @param values the values that the keys map to, in the same order
+ * @param count  the amount of key-value pairs
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_map_assign(flat_map me,
+                    void *const keys,
+                    void *const values,
+                    const int count)
+{
+    if (count < 0) {
+        return -EINVAL;
+    }
+    /* The pairs are removed even if the storage could not be shrunk. */
+    vector_clear(me->keys);
+    vector_clear(me->values);
+    return flat_map_put_all(me, keys, values, count);
+}
+
+/**
+ * Gets the value associated with a key in the flat map. This takes logarithmic
+ * time. The pointer to the key being passed in and the value being obtained
+ * should point to the key and value type which this flat map holds.
+ *
+ * @param value the value to copy to
+ * @param me    the flat map to get from
+ * @param key   the key to search for
+ *
+ * @return 1 if the flat map contained the key, otherwise 0
+ */
+int flat_map_get(void *const value, flat_map me, void *const key)
+{
+    const int index = flat_map_search(me, key);
+    if (!flat_map_is_at(me, index, key)) {
+        return 0;
+    }
+    vector_get_at(value, me->values, index);
+    return 1;
+}
+
+/**
+ * Determines if the flat map contains the specified key. This takes
+ * logarithmic time. The pointer to the key being passed in should point to the
+ * key type which this flat map holds.
+ *
+ * @param me  the flat map to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the flat map contained the key, otherwise 0
+ */
+int flat_map_contains(flat_map me, void *const key)
+{
+    return flat_map_is_at(me, flat_map_search(me, key), key);
+}
+
+/**
+ * Gets the index of the first key in the flat map which is not less than the
+ * specified key, which is the size of the flat map if there is no such key.
+ * This takes logarithmic time.
+ *
+ * @param me  the flat map to search
+ * @param key the key to search for
+ *
+ * @return the index of the first key which is not less than the key
+ */
+int flat_map_lower_bound(flat_map me, void *const key)
+{
+    return flat_map_search(me, key);
+}
+
+/**
+ * Copies the key-value pair at the specified index in sorted order. Either the
+ * key or the value may be NULL if it is not needed.
+ *
+ * @param key   the key to copy to
+ * @param value the value to copy to
+ * @param me    the flat map to get the key-value pair from
+ * @param index the index of the key-value pair
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int flat_map_get_at(void *const key,
+                    void *const value,
+                    flat_map me,
+                    const int index)
+{
+    if (index < 0 || index >= vector_size(me->keys)) {
+        return -EINVAL;
+    }
+    if (key) {
+        vector_get_at(key, me->keys, index);
+    }
+    if (value) {
+        vector_get_at(value, me->values, index);
+    }
+    return 0;
+}
+
+/**
+ * Removes the key-value pair from the flat map if it contains it. The pairs
+ * after it are moved to close the gap, so this takes linear time.
+ *
+ * @param me  the flat map to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the flat map contained the key, otherwise 0
+ */
+int flat_map_remove(flat_map me, void *const key)
+{
+    const int index = flat_map_search(me, key);
+    if (!flat_map_is_at(me, index, key)) {
+        return 0;
+    }
+    vector_remove_at(me->keys, index);
+    vector_remove_at(me->values, index);
+    return 1;
+}
+
+/**
+ * Clears the key-value pairs from the flat map.
+ *
+ * @param me the flat map to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_map_clear(flat_map me)
+{
+    const int rc = vector_clear(me->keys);
+    const int value_rc = vector_clear(me->values);
+    return rc != 0 ? rc : value_rc;
+}
+
+/**
+ * Frees the flat map memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the flat map to free from memory
+ *
+ * @return NULL
+ */
+flat_map flat_map_destroy(flat_map me)
+{
+    vector_destroy(me->keys);
+    vector_destroy(me->values);
+    free(me);
+    return NULL;
+}
+
+
+#include <string.h>
+#include <errno.h>
+
+struct internal_flat_set {
+    size_t key_size;
+    int (*comparator)(const void *const one, const void *const two);
+    vector keys;
+};
+
+/**
+ * Initializes a flat set, which keeps its keys sorted in a vector.
+ *
+ * @param key_size   the size of each key in the flat set; must be positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized flat set, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+flat_set flat_set_init(const size_t key_size,
+                       int (*const comparator)(const void *const,
+                                               const void *const))
+{
+    struct internal_flat_set *init;
+    if (key_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_flat_set));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->comparator = comparator;
+    init->keys = vector_init(key_size);
+    if (!init->keys) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Gets the size of the flat set.
+ *
+ * @param me the flat set to check
+ *
+ * @return the size of the flat set
+ */
+int flat_set_size(flat_set me)
+{
+    return vector_size(me->keys);
+}
+
+/**
+ * Determines whether or not the flat set is empty.
+ *
+ * @param me the flat set to check
+ *
+ * @return 1 if the flat set is empty, otherwise 0
+ */
+int flat_set_is_empty(flat_set me)
+{
+    return flat_set_size(me) == 0;
+}
+
+/**
+ * Reserves space for the specified amount of keys. If more space than
+ * specified is already reserved, then the previous space will be kept.
+ *
+ * @param me   the flat set to reserve space for
+ * @param size the amount of keys to reserve space for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_set_reserve(flat_set me, const int size)
+{
+    return vector_reserve(me->keys, size);
+}
+
+/**
+ * Gets the storage of the flat set, which holds the keys contiguously in
+ * sorted order. This pointer is not a copy, and is invalidated by operations
+ * which add or remove keys. The keys must not be modified in a way which
+ * changes their order. The flat set owns this memory, thus it should not be
+ * freed.
+ *
+ * @param me the flat set to get the storage of
+ *
+ * @return the storage of the flat set
+ */
+void *flat_set_get_data(flat_set me)
+{
+    return vector_get_data(me->keys);
+}
+
+/*
+ * Compares two keys.
+ */
+static int flat_set_compare(flat_set me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/*
+ * Gets the index of the first key which is not less than the specified key,
+ * with the branchless binary search of containers_lower_bound.
+ */
+static int flat_set_search(flat_set me, const void *const key)
+{
+    return containers_lower_bound(vector_get_data(me->keys),
+                                  vector_size(me->keys), me->key_size,
+                                  (void *) key, me->comparator);
+}
+
+/*
+ * Determines whether the key at the index is equal to the specified key.
+ */
+static int flat_set_is_at(flat_set me, const int index, const void *const key)
+{
+    const char *const data = vector_get_data(me->keys);
+    return index < vector_size(me->keys)
+           && flat_set_compare(me, data + index * me->key_size, key) == 0;
+}
+
+/**
+ * Adds a key to the flat set if the flat set does not already contain it. The
+ * keys after it are moved to make room for it, so this takes linear time. To
+ * add many keys, flat_set_put_all is faster. The pointer to the key being
+ * passed in should point to the key type which this flat set holds. Since the
+ * key is being copied, the pointer only has to be valid when this function is
+ * called.
+ *
+ * @param me  the flat set to add to
+ * @param key the key to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_set_put(flat_set me, void *const key)
+{
+    const int index = flat_set_search(me, key);
+    if (flat_set_is_at(me, index, key)) {
+        return 0;
+    }
+    return vector_add_at(me->keys, index, key);
+}
+
+/**
+ * Adds many keys to the flat set at once. The keys are copied and sorted with
+ * one sort, and are then merged with the keys of the flat set from the back,
+ * so that each key of the flat set is moved at most once. Thus, this takes
+ * O(n + k log k) time for k keys, rather than the O(n k) time of adding them
+ * one at a time. Keys which the flat set already contains, and repeated keys,
+ * are only added once.
+ *
+ * @param me    the flat set to add to
+ * @param keys  the keys to add
+ * @param count the amount of keys to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_set_put_all(flat_set me, void *const keys, const int count)
+{
+    const size_t key_size = me->key_size;
+    const int size = vector_size(me->keys);
+    char *data = vector_get_data(me->keys);
+    char *batch;
+    int unique = 0;
+    int index = 0;
+    int out;
+    int rc;
+    int i;
+    if (count < 0) {
+        return -EINVAL;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    batch = malloc(count * key_size);
+    if (!batch) {
+        return -ENOMEM;
+    }
+    memcpy(batch, keys, count * key_size);
+    containers_sort(batch, count, key_size, me->comparator);
+    for (i = 0; i < count; i++) {
+        const char *const key = batch + i * key_size;
+        if (i > 0 && flat_set_compare(me, key - key_size, key) == 0) {
+            continue;
+        }
+        while (index < size
+               && flat_set_compare(me, data + index * key_size, key) < 0) {
+            index++;
+        }
+        if (flat_set_is_at(me, index, key)) {
+            continue;
+        }
+        if (unique != i) {
+            memcpy(batch + unique * key_size, key, key_size);
+        }
+        unique++;
+    }
+    rc = vector_reserve(me->keys, size + unique);
+    if (rc != 0) {
+        free(batch);
+        return rc;
+    }
+    for (i = 0; i < unique; i++) {
+        vector_add_last(me->keys, batch + i * key_size);
+    }
+    data = vector_get_data(me->keys);
+    index = size - 1;
+    out = size + unique - 1;
+    for (i = unique - 1; i >= 0; out--) {
+        const char *const key = batch + i * key_size;
+        if (index >= 0
+            && flat_set_compare(me, data + index * key_size, key) > 0) {
+            memcpy(data + out * key_size, data + index * key_size,
+                   key_size);
+            index--;
+        } else {
+            memcpy(data + out * key_size, key, key_size);
+            i--;
+        }
+    }
+    free(batch);
+    return 0;
+}
+
+/**
+ * Replaces the keys of the flat set with the specified keys, which are sorted
+ * with one sort. If an error occurs, the flat set is left empty.
+ *
+ * @param me    the flat set to replace the keys of
+ * @param keys  the keys to hold
+ * @param count the amount of keys
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_set_assign(flat_set me, void *const keys, const int count)
+{
+    if (count < 0) {
+        return -EINVAL;
+    }
+    /* The keys are removed even if the storage could not be shrunk. */
+    vector_clear(me->keys);
+    return flat_set_put_all(me, keys, count);
+}
+
+/**
+ * Determines if the flat set contains the specified key. This takes
+ * logarithmic time. The pointer to the key being passed in should point to the
+ * key type which this flat set holds.
+ *
+ * @param me  the flat set to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the flat set contained the key, otherwise 0
+ */
+int flat_set_contains(flat_set me, void *const key)
+{
+    return flat_set_is_at(me, flat_set_search(me, key), key);
+}
+
+/**
+ * Gets the index of the first key in the flat set which is not less than the
+ * specified key, which is the size of the flat set if there is no such key.
+ * This takes logarithmic time.
+ *
+ * @param me  the flat set to search
+ * @param key the key to search for
+ *
+ * @return the index of the first key which is not less than the key
+ */
+int flat_set_lower_bound(flat_set me, void *const key)
+{
+    return flat_set_search(me, key);
+}
+
+/**
+ * Copies the key at the specified index in sorted order.
+ *
+ * @param key   the key to copy to
+ * @param me    the flat set to get the key from
+ * @param index the index of the key
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int flat_set_get_at(void *const key, flat_set me, const int index)
+{
+    return vector_get_at(key, me->keys, index);
+}
+
+/**
+ * Removes the key from the flat set if it contains it. The keys after it are
+ * moved to close the gap, so this takes linear time.
+ *
+ * @param me  the flat set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the flat set contained the key, otherwise 0
+ */
+int flat_set_remove(flat_set me, void *const key)
+{
+    const int index = flat_set_search(me, key);
+    if (!flat_set_is_at(me, index, key)) {
+        return 0;
+    }
+    vector_remove_at(me->keys, index);
+    return 1;
+}
+
+/**
+ * Clears the keys from the flat set.
+ *
+ * @param me the flat set to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_set_clear(flat_set me)
+{
+    return vector_clear(me->keys);
+}
+
+/**
+ * Frees the flat set memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the flat set to free from memory
+ *
+ * @return NULL
+ */
+flat_set flat_set_destroy(flat_set me)
+{
+    vector_destroy(me->keys);
+    free(me);
+    return NULL;
+}
+
+
+#include <string.h>
+#include <errno.h>
+
+#define node forward_list_node
+struct internal_forward_list {
+    size_t bytes_per_item;
+    int item_count;
+    struct node *head;
+    struct node *tail;
+    int cache_index;
+    struct node *cache;
+};
+
+struct node {
+    void *data;
+    struct node *next;
+};
+
+/**
+ * Initializes a singly-linked list.
+ *
+ * @param data_size the size of data to store; must be positive
+ *
+ * @return the newly-initialized singly-linked list, or NULL if it was not
+ *         successfully initialized due to either invalid input arguments or
+ *         memory allocation error
+ */
+forward_list forward_list_init(const size_t data_size)
+{
+    struct internal_forward_list *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_forward_list));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = 0;
+    init->head = NULL;
+    init->tail = NULL;
+    init->cache_index = 0;
+    init->cache = NULL;
+    return init;
+}
+
+/**
+ * Gets the number of elements in the singly-linked list.
+ *
+ * @param me the singly-linked list to check
+ *
+ * @return the number of elements
+ */
+int forward_list_size(forward_list me)
+{
+    return me->item_count;
+}
+
+/**
+ * Determines if the singly-linked list is empty.
+ *
+ * @param me the singly-linked list to check
+ *
+ * @return 1 if the singly-linked list is empty, otherwise 0
+ */
+int forward_list_is_empty(forward_list me)
+{
+    return forward_list_size(me) == 0;
+}
+
+/**
+ * Copies the nodes of the singly-linked list to an array. Since it is a copy,
+ * the array may be modified without causing side effects to the singly-linked
+ * list data structure. Memory is not allocated, thus the array being used for
+ * the copy must be allocated before this function is called. The size of the
+ * singly-linked list should be queried prior to calling this function, which
+ * also serves as the size of the newly-copied array.
+ *
+ * @param arr the initialized array to copy the singly-linked list to
+ * @param me  the singly-linked list to copy to the array
+ */
+void forward_list_copy_to_array(void *const arr, forward_list me)
+{
+    struct node *traverse = me->head;
+    int offset = 0;
+    while (traverse) {
+        memcpy((char *) arr + offset, traverse->data, me->bytes_per_item);
+        offset += me->bytes_per_item;
+        traverse = traverse->next;
+    }
+}
+
+/*
+ * Gets the node at the specified index. The walk starts from the most recently
+ * accessed node if it is not past the index, so that accessing increasing
+ * indices one after another takes constant time.
+ */
+static struct node *forward_list_get_node_at(forward_list me, const int index)
+{
+    struct node *traverse = me->head;
+    int position = 0;
+    if (index == me->item_count - 1) {
+        return me->tail;
+    }
+    if (me->cache && me->cache_index <= index) {
+        traverse = me->cache;
+        position = me->cache_index;
+    }
+    while (position < index) {
+        traverse = traverse->next;
+        position++;
+    }
+    me->cache = traverse;
+    me->cache_index = index;
+    return traverse;
+}
+
+/*
+ * Creates a node which holds a copy of the data.
+ */
+static struct node *forward_list_create_node(forward_list me,
+                                             const void *const data)
+{
+    struct node *const add = malloc(sizeof(struct node));
+    if (!add) {
+        return NULL;
+    }
+    add->data = malloc(me->bytes_per_item);
+    if (!add->data) {
+        free(add);
+        return NULL;
+    }
+    memcpy(add->data, data, me->bytes_per_item);
+    return add;
+}
+
+/*
+ * Links the node in after the specified node, or at the start if there is
+ * none, where the index is the index which the node ends up at.
+ */
+static void forward_list_link(forward_list me,
+                              struct node *const add,
+                              struct node *const prev,
+                              const int index)
+{
+    if (prev) {
+        add->next = prev->next;
+        prev->next = add;
+    } else {
+        add->next = me->head;
+        me->head = add;
+    }
+    if (!add->next) {
+        me->tail = add;
+    }
+    if (me->cache && index <= me->cache_index) {
+        me->cache_index++;
+    }
+    me->item_count++;
+}
+
+/*
+ * Unlinks and frees the node after the specified node, or the first node if
+ * there is none, where the index is the index of the node being removed. If it
+ * is the most recently accessed node, its predecessor takes its place.
+ */
+static void forward_list_unlink(forward_list me,
+                                struct node *const prev,
+                                const int index)
+{
+    struct node *const item = prev ? prev->next : me->head;
+    if (prev) {
+        prev->next = item->next;
+    } else {
+        me->head = item->next;
+    }
+    if (me->tail == item) {
+        me->tail = prev;
+    }
+    if (me->cache == item) {
+        me->cache = prev;
+        me->cache_index--;
+    } else if (me->cache && index < me->cache_index) {
+        me->cache_index--;
+    }
+    free(item->data);
+    free(item);
+    me->item_count--;
+}
+
+/**
+ * Adds data at the first index in the singly-linked list. The pointer to the
+ * data being passed in should point to the data type which this singly-linked
+ * list holds. For example, if this singly-linked list holds integers, the data
+ * pointer should be a pointer to an integer. Since the data is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me   the singly-linked list to add data to
+ * @param data the data to add to the singly-linked list
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int forward_list_add_first(forward_list me, void *const data)
+{
+    return forward_list_add_at(me, 0, data);
+}
+
+/**
+ * Adds data at a specified index in the singly-linked list. The pointer to the
+ * data being passed in should point to the data type which this singly-linked
+ * list holds. For example, if this singly-linked list holds integers, the data
+ * pointer should be a pointer to an integer. Since the data is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me    the singly-linked list to add data to
+ * @param index the index to add the data at
+ * @param data  the data to add to the singly-linked list
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_add_at(forward_list me, const int index, void *const data)
+{
+    struct node *add;
+    if (index < 0 || index > me->item_count) {
+        return -EINVAL;
+    }
+    add = forward_list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    if (index == 0) {
+        forward_list_link(me, add, NULL, index);
+    } else {
+        forward_list_link(me, add, forward_list_get_node_at(me, index - 1),
+                          index);
+    }
+    return 0;
+}
+
+/**
+ * Adds data at the last index in the singly-linked list. The pointer to the
+ * data being passed in should point to the data type which this singly-linked
+ * list holds. For example, if this singly-linked list holds integers, the data
+ * pointer should be a pointer to an integer. Since the data is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me   the singly-linked list to add data to
+ * @param data the data to add to the singly-linked list
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int forward_list_add_last(forward_list me, void *const data)
+{
+    return forward_list_add_at(me, me->item_count, data);
+}
+
+/*
+ * Determines if the input is illegal.
+ */
+static int forward_list_is_illegal_input(forward_list me, const int index)
+{
+    return index < 0 || index >= me->item_count;
+}
+
+/**
+ * Removes the first piece of data from the singly-linked list.
+ *
+ * @param me the singly-linked list to remove data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_remove_first(forward_list me)
+{
+    return forward_list_remove_at(me, 0);
+}
+
+/**
+ * Removes data from the singly-linked list at the specified index.
+ *
+ * @param me    the singly-linked list to remove data from
+ * @param index the index to remove from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_remove_at(forward_list me, const int index)
+{
+    if (forward_list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    if (index == 0) {
+        forward_list_unlink(me, NULL, index);
+    } else {
+        forward_list_unlink(me, forward_list_get_node_at(me, index - 1),
+                            index);
+    }
+    return 0;
+}
+
+/**
+ * Removes the last piece of data from the singly-linked list.
+ *
+ * @param me the singly-linked list to remove data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_remove_last(forward_list me)
+{
+    return forward_list_remove_at(me, me->item_count - 1);
+}
+
+/**
+ * Sets the data at the first index in the singly-linked list. The pointer to
+ * the data being passed in should point to the data type which this singly-
+ * linked list holds. For example, if this singly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since the data is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me   the singly-linked list to set data for
+ * @param data the data to set in the singly-linked list
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_set_first(forward_list me, void *const data)
+{
+    return forward_list_set_at(me, 0, data);
+}
+
+/**
+ * Sets the data at the specified index in the singly-linked list. The pointer
+ * to the data being passed in should point to the data type which this singly-
+ * linked list holds. For example, if this singly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since the data is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me    the singly-linked list to set data for
+ * @param index the index to set data in the singly-linked list
+ * @param data  the data to set in the singly-linked list
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_set_at(forward_list me, const int index, void *const data)
+{
+    struct node *traverse;
+    if (forward_list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    traverse = forward_list_get_node_at(me, index);
+    memcpy(traverse->data, data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the data at the last index in the singly-linked list. The pointer to
+ * the data being passed in should point to the data type which this singly-
+ * linked list holds. For example, if this singly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since the data is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me   the singly-linked list to set data for
+ * @param data the data to set in the singly-linked list
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_set_last(forward_list me, void *const data)
+{
+    return forward_list_set_at(me, me->item_count - 1, data);
+}
+
+/**
+ * Gets the data at the first index in the singly-linked list. The pointer to
+ * the data being obtained should point to the data type which this singly-
+ * linked list holds. For example, if this singly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since this data is being
+ * copied from the array to the data pointer, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param data the data to get
+ * @param me   the singly-linked list to get data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_get_first(void *const data, forward_list me)
+{
+    return forward_list_get_at(data, me, 0);
+}
+
+/**
+ * Gets the data at the specified index in the singly-linked list. The pointer
+ * to the data being obtained should point to the data type which this singly-
+ * linked list holds. For example, if this singly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since this data is being
+ * copied from the array to the data pointer, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param data  the data to get
+ * @param me    the singly-linked list to get data from
+ * @param index the index to get data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_get_at(void *const data, forward_list me, const int index)
+{
+    struct node *traverse;
+    if (forward_list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    traverse = forward_list_get_node_at(me, index);
+    memcpy(data, traverse->data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Gets the data at the last index in the singly-linked list. The pointer to
+ * the data being obtained should point to the data type which this singly-
+ * linked list holds. For example, if this singly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since this data is being
+ * copied from the array to the data pointer, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param data the data to get
+ * @param me   the singly-linked list to get data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int forward_list_get_last(void *const data, forward_list me)
+{
+    return forward_list_get_at(data, me, me->item_count - 1);
+}
+
+/**
+ * Moves the cursor to the first element of the singly-linked list. The cursor
+ * is owned by the caller, and remains valid until the singly-linked list is
+ * modified other than through the cursor.
+ *
+ * @param me     the singly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if the singly-linked
+ *         list is empty
+ */
+int forward_list_cursor_first(forward_list me,
+                              struct forward_list_cursor *const cursor)
+{
+    cursor->internal_prev = NULL;
+    cursor->internal_node = me->head;
+    cursor->internal_index = 0;
+    return me->head != NULL;
+}
+
+/**
+ * Moves the cursor to the next element of the singly-linked list.
+ *
+ * @param me     the singly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if it moved past the
+ *         last element
+ */
+int forward_list_cursor_next(forward_list me,
+                             struct forward_list_cursor *const cursor)
+{
+    struct node *const item = cursor->internal_node;
+    (void) me;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_prev = item;
+    cursor->internal_node = item->next;
+    cursor->internal_index++;
+    return item->next != NULL;
+}
+
+/**
+ * Gets the index of the element at the cursor.
+ *
+ * @param cursor the cursor to check
+ *
+ * @return the index of the element, or -1 if the cursor is not at an element
+ */
+int forward_list_cursor_index(const struct forward_list_cursor *const cursor)
+{
+    if (!cursor->internal_node) {
+        return -1;
+    }
+    return cursor->internal_index;
+}
+
+/**
+ * Copies the element at the cursor to data. The pointer to the data being
+ * obtained should point to the data type which this singly-linked list holds.
+ *
+ * @param data   the data to get
+ * @param me     the singly-linked list to get data from
+ * @param cursor the cursor to get at
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_get(void *const data,
+                            forward_list me,
+                            const struct forward_list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(data, item->data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the element at the cursor. The pointer to the data being passed in
+ * should point to the data type which this singly-linked list holds.
+ *
+ * @param me     the singly-linked list to set data for
+ * @param cursor the cursor to set at
+ * @param data   the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_set(forward_list me,
+                            const struct forward_list_cursor *const cursor,
+                            void *const data)
+{
+    struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(item->data, data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Adds data before the element at the cursor in constant time. The cursor
+ * stays at the same element.
+ *
+ * @param me     the singly-linked list to add data to
+ * @param cursor the cursor to add before
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_add_before(forward_list me,
+                                   struct forward_list_cursor *const cursor,
+                                   void *const data)
+{
+    struct node *add;
+    if (!cursor->internal_node) {
+        return -EINVAL;
+    }
+    add = forward_list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    forward_list_link(me, add, cursor->internal_prev, cursor->internal_index);
+    cursor->internal_prev = add;
+    cursor->internal_index++;
+    return 0;
+}
+
+/**
+ * Adds data after the element at the cursor in constant time. The cursor stays
+ * at the same element.
+ *
+ * @param me     the singly-linked list to add data to
+ * @param cursor the cursor to add after
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_add_after(forward_list me,
+                                  struct forward_list_cursor *const cursor,
+                                  void *const data)
+{
+    struct node *add;
+    if (!cursor->internal_node) {
+        return -EINVAL;
+    }
+    add = forward_list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    forward_list_link(me, add, cursor->internal_node,
+                      cursor->internal_index + 1);
+    return 0;
+}
+
+/**
+ * Removes the element at the cursor in constant time, and moves the cursor to
+ * the next element.
+ *
+ * @param me     the singly-linked list to remove data from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at an element after the removal, otherwise 0
+ */
+int forward_list_cursor_remove(forward_list me,
+                               struct forward_list_cursor *const cursor)
+{
+    struct node *const prev = cursor->internal_prev;
+    if (!cursor->internal_node) {
+        return 0;
+    }
+    forward_list_unlink(me, prev, cursor->internal_index);
+    cursor->internal_node = prev ? prev->next : me->head;
+    return cursor->internal_node != NULL;
+}
+
+/**
+ * Clears all elements from the singly-linked list.
+ *
+ * @param me the singly-linked list to clear
+ */
+void forward_list_clear(forward_list me)
+{
+    struct node *traverse = me->head;
+    while (traverse) {
+        struct node *const temp = traverse;
+        traverse = traverse->next;
+        free(temp->data);
+        free(temp);
+    }
+    me->head = NULL;
+    me->tail = NULL;
+    me->item_count = 0;
+    me->cache = NULL;
+}
+
+/**
+ * Destroys the singly-linked list. Performing further operations after calling
+ * this function results in undefined behavior.
+ *
+ * @param me the singly-linked list to destroy
+ *
+ * @return NULL
+ */
+forward_list forward_list_destroy(forward_list me)
+{
+    forward_list_clear(me);
+    free(me);
+    return NULL;
+}
+#undef node
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#define CONTAINERS_HAS_THREADS
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define HASH_SECRET_ONE hash_HASH_SECRET_ONE
+#define HASH_SECRET_TWO hash_HASH_SECRET_TWO
+#define HASH_SEED hash_HASH_SEED
+static const unsigned long HASH_SEED = 0x9e3779b9UL;
+
+#if ULONG_MAX > 0xffffffffUL
+static const unsigned long HASH_SECRET_ONE = 0xa0761d6478bd642fUL;
+static const unsigned long HASH_SECRET_TWO = 0xe7037ed1a0b428dbUL;
+#else
+static const unsigned long HASH_SECRET_ONE = 0x53c5ca59UL;
+static const unsigned long HASH_SECRET_TWO = 0x74743c1bUL;
+#endif
+
+#if defined(__SIZEOF_INT128__) && ULONG_MAX > 0xffffffffUL
+#define CONTAINERS_HAS_WIDE_MULTIPLY
+__extension__ typedef unsigned __int128 hash_wide;
+#endif
+
+/*
+ * The state from which the seeds of the unordered containers are generated.
+ * The random bytes are read once, and the counter makes each seed distinct.
+ */
+static unsigned long hash_entropy = 0;
+static int hash_has_entropy = 0;
+static unsigned long hash_counter = 0;
+#ifdef CONTAINERS_HAS_THREADS
+static pthread_mutex_t hash_seed_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*
+ * Mixes all the bits of the value so that each bit of the input affects each
+ * bit of the output. The constants are those of splitmix64 when unsigned long
+ * is 64 bits, and those of the lowbias32 integer hash otherwise.
+ */
+static unsigned long hash_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Computes the full double-width product of two words, and stores its low and
+ * high halves. Without a double-width type, the product is assembled from the
+ * products of the half-words.
+ */
+static void hash_multiply(unsigned long *const low,
+                          unsigned long *const high,
+                          const unsigned long one,
+                          const unsigned long two)
+{
+#ifdef CONTAINERS_HAS_WIDE_MULTIPLY
+    const hash_wide product = (hash_wide) one * two;
+    *low = (unsigned long) product;
+    *high = (unsigned long) (product >> 64);
+#else
+    const int half_bits = (int) sizeof(unsigned long) * CHAR_BIT / 2;
+    const unsigned long mask = ULONG_MAX >> half_bits;
+    const unsigned long low_low = (one & mask) * (two & mask);
+    const unsigned long low_high = (one & mask) * (two >> half_bits);
+    const unsigned long high_low = (one >> half_bits) * (two & mask);
+    const unsigned long high_high = (one >> half_bits) * (two >> half_bits);
+    const unsigned long middle =
+            (low_low >> half_bits) + (low_high & mask) + (high_low & mask);
+    *low = (low_low & mask) | (middle << half_bits);
+    *high = high_high + (low_high >> half_bits) + (high_low >> half_bits)
+            + (middle >> half_bits);
+#endif
+}
+
+/*
+ * Multiplies two words and folds the halves of the product together, so that
+ * each bit of the result depends on every bit of both words.
+ */
+static unsigned long hash_fold(const unsigned long one, const unsigned long two)
+{
+    unsigned long low;
+    unsigned long high;
+    hash_multiply(&low, &high, one, two);
+    return low ^ high;
+}
+
+/**
+ * Hashes an arbitrary sequence of bytes with a seed. This is a multiply-fold
+ * hash in the style of wyhash: two words are consumed at a time, each keyed
+ * with the state, and folded into the state with one full-width multiply. The
+ * seed is mixed into the state before the first word, so the keys which
+ * collide under one seed do not collide under another. Thus, containers which
+ * pick a secret seed are not open to keys chosen to collide.
+ *
+ * @param data the bytes to hash
+ * @param size the amount of bytes to hash
+ * @param seed the seed which selects the hash function
+ *
+ * @return the hash of the bytes
+ */
+unsigned long containers_hash_bytes_seeded(const void *const data,
+                                           const size_t size,
+                                           unsigned long seed)
+{
+    const size_t word = sizeof(unsigned long);
+    const unsigned char *const bytes = data;
+    unsigned long one = 0;
+    unsigned long two = 0;
+    size_t remaining = size;
+    size_t i = 0;
+    seed ^= hash_fold(seed ^ HASH_SECRET_ONE, HASH_SECRET_TWO);
+    while (remaining > 2 * word) {
+        memcpy(&one, bytes + i, word);
+        memcpy(&two, bytes + i + word, word);
+        seed = hash_fold(one ^ HASH_SECRET_TWO, two ^ seed);
+        i += 2 * word;
+        remaining -= 2 * word;
+    }
+    /* The tail is zero-padded rather than mixed with the previous block. */
+    one = 0;
+    two = 0;
+    if (remaining > word) {
+        memcpy(&one, bytes + i, word);
+        memcpy(&two, bytes + i + word, remaining - word);
+    } else {
+        memcpy(&one, bytes + i, remaining);
+    }
+    hash_multiply(&one, &two, one ^ HASH_SECRET_TWO, two ^ seed);
+    return hash_fold(one ^ HASH_SECRET_ONE ^ (unsigned long) size,
+                     two ^ HASH_SECRET_TWO);
+}
+
+/**
+ * Hashes an arbitrary sequence of bytes. This is containers_hash_bytes_seeded
+ * with a fixed seed, so its collisions can be found by anyone; the unordered
+ * containers use their own secret seeds instead.
+ *
+ * @param data the bytes to hash
+ * @param size the amount of bytes to hash
+ *
+ * @return the hash of the bytes
+ */
+unsigned long containers_hash_bytes(const void *const data, const size_t size)
+{
+    return containers_hash_bytes_seeded(data, size, HASH_SEED);
+}
+
+/**
+ * Hashes a key which is an int.
+ *
+ * @param key the int to hash
+ *
+ * @return the hash of the int
+ */
+unsigned long containers_hash_int(const void *const key)
+{
+    int value;
+    memcpy(&value, key, sizeof(int));
+    return hash_mix((unsigned long) value);
+}
+
+/**
+ * Hashes a key which is a long.
+ *
+ * @param key the long to hash
+ *
+ * @return the hash of the long
+ */
+unsigned long containers_hash_long(const void *const key)
+{
+    long value;
+    memcpy(&value, key, sizeof(long));
+    return hash_mix((unsigned long) value);
+}
+
+/**
+ * Hashes a key which is a pointer to a null-terminated string. Thus, the key
+ * size of the container must be the size of a char pointer, and the characters
+ * of the string are hashed rather than the pointer itself.
+ *
+ * @param key the string pointer to hash
+ *
+ * @return the hash of the string
+ */
+unsigned long containers_hash_string(const void *const key)
+{
+    const char *string;
+    memcpy(&string, key, sizeof(char *));
+    return containers_hash_bytes(string, strlen(string));
+}
+
+/*
+ * Reads random bytes of the operating system into the entropy, unless they have
+ * already been read. A failed read is not remembered, so the next seed tries
+ * again. Without a source of random bytes, the entropy stays zero.
+ */
+static int hash_read_entropy(void)
+{
+#ifdef CONTAINERS_HAS_FD
+    ssize_t size;
+    int fd;
+    if (hash_has_entropy) {
+        return 0;
+    }
+    fd = open("/dev/urandom", O_RDONLY);
+    if (fd == -1) {
+        return -EIO;
+    }
+    size = read(fd, &hash_entropy, sizeof(unsigned long));
+    close(fd);
+    if (size != (ssize_t) sizeof(unsigned long)) {
+        return -EIO;
+    }
+#endif
+    hash_has_entropy = 1;
+    return 0;
+}
+
+/**
+ * Generates a secret seed for an unordered container, which differs between
+ * containers and between runs of the program, so that which keys share a
+ * bucket cannot be predicted. The seed is derived from random bytes of the
+ * operating system, which are read by the first call, since the time and the
+ * address of the container alone can be guessed. On Unix, the read and the
+ * counter are guarded by a lock, so seeds may be generated from several threads
+ * at once. Other platforms have neither a lock nor a source of random bytes, so
+ * there, the seed only depends on the time, the salt, and a counter, and seeds
+ * must not be generated from several threads at once.
+ *
+ * @param seed the seed to generate
+ * @param salt a value which differs between containers, such as the address
+ *             of the container
+ *
+ * @return 0    if no error
+ * @return -EIO if the random bytes of the operating system could not be read
+ */
+int containers_hash_new_seed(unsigned long *const seed, const void *const salt)
+{
+    unsigned long count;
+    int rc;
+#ifdef CONTAINERS_HAS_THREADS
+    pthread_mutex_lock(&hash_seed_lock);
+#endif
+    rc = hash_read_entropy();
+    hash_counter++;
+    count = hash_counter;
+#ifdef CONTAINERS_HAS_THREADS
+    pthread_mutex_unlock(&hash_seed_lock);
+#endif
+    if (rc != 0) {
+        return rc;
+    }
+    *seed = hash_entropy ^ (unsigned long) time(NULL);
+    *seed ^= (unsigned long) clock() << 16;
+    *seed ^= (unsigned long) (size_t) salt;
+    *seed ^= count * 0x9e3779b9UL;
+    *seed = hash_mix(*seed);
+    return 0;
+}
+#undef HASH_SECRET_ONE
+#undef HASH_SECRET_TWO
+#undef HASH_SEED
+
+
+#include <string.h>
+#include <errno.h>
+
+#define node list_node
+struct internal_list {
+    size_t bytes_per_item;
+    int item_count;
+    struct node *head;
+    struct node *tail;
+    int cache_index;
+    struct node *cache;
+};
+
+struct node {
+    struct node *prev;
+    void *data;
+    struct node *next;
+};
+
+/**
+ * Initializes a doubly-linked list.
+ *
+ * @param data_size the size of data to store; must be positive
+ *
+ * @return the newly-initialized doubly-linked list, or NULL if it was not
+ *         successfully initialized due to either invalid input arguments or
+ *         memory allocation error
+ */
+list list_init(const size_t data_size)
+{
+    struct internal_list *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_list));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = 0;
+    init->head = NULL;
+    init->tail = NULL;
+    init->cache_index = 0;
+    init->cache = NULL;
+    return init;
+}
+
+/**
+ * Gets the number of elements in the doubly-linked list.
+ *
+ * @param me the doubly-linked list to check
+ *
+ * @return the number of elements
+ */
+int list_size(list me)
+{
+    return me->item_count;
+}
+
+/**
+ * Determines if the doubly-linked list is empty.
+ *
+ * @param me the doubly-linked list to check
+ *
+ * @return 1 if the list is empty, otherwise 0
+ */
+int list_is_empty(list me)
+{
+    return list_size(me) == 0;
+}
+
+/**
+ * Copies the nodes of the doubly-linked list to an array. Since it is a copy,
+ * the array may be modified without causing side effects to the doubly-linked
+ * list data structure. Memory is not allocated, thus the array being used for
+ * the copy must be allocated before this function is called. The size of the
+ * doubly-linked list should be queried prior to calling this function, which
+ * also serves as the size of the newly-copied array.
+ *
+ * @param arr the initialized array to copy the doubly-linked list to
+ * @param me  the doubly-linked list to copy to the array
+ */
+void list_copy_to_array(void *const arr, list me)
+{
+    struct node *traverse = me->head;
+    int offset = 0;
+    while (traverse) {
+        memcpy((char *) arr + offset, traverse->data, me->bytes_per_item);
+        offset += me->bytes_per_item;
+        traverse = traverse->next;
+    }
+}
+
+/*
+ * Gets the node at the specified index. The walk starts from whichever of the
+ * head, the tail, and the most recently accessed node is closest to the index,
+ * so that accessing neighbouring indices one after another takes constant time.
+ */
+static struct node *list_get_node_at(list me, const int index)
+{
+    struct node *traverse = me->head;
+    int position = 0;
+    int distance = index;
+    if (me->item_count - 1 - index < distance) {
+        traverse = me->tail;
+        position = me->item_count - 1;
+        distance = position - index;
+    }
+    if (me->cache) {
+        const int cache_distance = index > me->cache_index
+                                   ? index - me->cache_index
+                                   : me->cache_index - index;
+        if (cache_distance < distance) {
+            traverse = me->cache;
+            position = me->cache_index;
+        }
+    }
+    while (position < index) {
+        traverse = traverse->next;
+        position++;
+    }
+    while (position > index) {
+        traverse = traverse->prev;
+        position--;
+    }
+    me->cache = traverse;
+    me->cache_index = index;
+    return traverse;
+}
+
+/*
+ * Creates a node which holds a copy of the data.
+ */
+static struct node *list_create_node(list me, const void *const data)
+{
+    struct node *const add = malloc(sizeof(struct node));
+    if (!add) {
+        return NULL;
+    }
+    add->data = malloc(me->bytes_per_item);
+    if (!add->data) {
+        free(add);
+        return NULL;
+    }
+    memcpy(add->data, data, me->bytes_per_item);
+    return add;
+}
+
+/*
+ * Links the node in before the specified node, or at the end if there is none,
+ * where the index is the index which the node ends up at.
+ */
+static void list_link(list me,
+                      struct node *const add,
+                      struct node *const before,
+                      const int index)
+{
+    add->next = before;
+    add->prev = before ? before->prev : me->tail;
+    if (add->prev) {
+        add->prev->next = add;
+    } else {
+        me->head = add;
+    }
+    if (before) {
+        before->prev = add;
+    } else {
+        me->tail = add;
+    }
+    if (me->cache && index <= me->cache_index) {
+        me->cache_index++;
+    }
+    me->item_count++;
+}
+
+/*
+ * Unlinks and frees the node at the specified index. If it is the most recently
+ * accessed node, one of its neighbours takes its place.
+ */
+static void list_unlink(list me, struct node *const item, const int index)
+{
+    if (item->prev) {
+        item->prev->next = item->next;
+    } else {
+        me->head = item->next;
+    }
+    if (item->next) {
+        item->next->prev = item->prev;
+    } else {
+        me->tail = item->prev;
+    }
+    if (me->cache == item) {
+        me->cache = item->next;
+        if (!me->cache) {
+            me->cache = item->prev;
+            me->cache_index--;
+        }
+    } else if (me->cache && index < me->cache_index) {
+        me->cache_index--;
+    }
+    free(item->data);
+    free(item);
+    me->item_count--;
+}
+
+/**
+ * Adds data at the first index in the doubly-linked list. The pointer to the
+ * data being passed in should point to the data type which this doubly-linked
+ * list holds. For example, if this doubly-linked list holds integers, the data
+ * pointer should be a pointer to an integer. Since the data is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me   the doubly-linked list to add data to
+ * @param data the data to add to the doubly-linked list
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int list_add_first(list me, void *const data)
+{
+    return list_add_at(me, 0, data);
+}
+
+/**
+ * Adds data at a specified index in the doubly-linked list. The pointer to the
+ * data being passed in should point to the data type which this doubly-linked
+ * list holds. For example, if this doubly-linked list holds integers, the data
+ * pointer should be a pointer to an integer. Since the data is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me    the doubly-linked list to add data to
+ * @param index the index to add the data at
+ * @param data  the data to add to the doubly-linked list
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if invalid argument
+ */
+int list_add_at(list me, const int index, void *const data)
+{
+    struct node *add;
+    if (index < 0 || index > me->item_count) {
+        return -EINVAL;
+    }
+    add = list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    if (index == me->item_count) {
+        list_link(me, add, NULL, index);
+    } else {
+        list_link(me, add, list_get_node_at(me, index), index);
+    }
+    return 0;
+}
+
+/**
+ * Adds data at the last index in the doubly-linked list. The pointer to the
+ * data being passed in should point to the data type which this doubly-linked
+ * list holds. For example, if this doubly-linked list holds integers, the data
+ * pointer should be a pointer to an integer. Since the data is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me   the doubly-linked list to add data to
+ * @param data the data to add to the doubly-linked list
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int list_add_last(list me, void *const data)
+{
+    return list_add_at(me, me->item_count, data);
+}
+
+/*
+ * Determines if the input is illegal.
+ */
+static int list_is_illegal_input(list me, const int index)
+{
+    return index < 0 || index >= me->item_count;
+}
+
+/**
+ * Removes the first piece of data from the doubly-linked list.
+ *
+ * @param me the doubly-linked list to remove data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_remove_first(list me)
+{
+    return list_remove_at(me, 0);
+}
+
+/**
+ * Removes data from the doubly-linked list at the specified index.
+ *
+ * @param me    the doubly-linked list to remove data from
+ * @param index the index to remove from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_remove_at(list me, const int index)
+{
+    if (list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    list_unlink(me, list_get_node_at(me, index), index);
+    return 0;
+}
+
+/**
+ * Removes the last piece of data from the doubly-linked list.
+ *
+ * @param me the doubly-linked list to remove data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_remove_last(list me)
+{
+    return list_remove_at(me, me->item_count - 1);
+}
+
+/**
+ * Sets the data at the first index in the doubly-linked list. The pointer to
+ * the data being passed in should point to the data type which this doubly-
+ * linked list holds. For example, if this doubly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since the data is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me   the doubly-linked list to set data for
+ * @param data the data to set in the doubly-linked list
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_set_first(list me, void *const data)
+{
+    return list_set_at(me, 0, data);
+}
+
+/**
+ * Sets the data at the specified index in the doubly-linked list. The pointer
+ * to the data being passed in should point to the data type which this doubly-
+ * linked list holds. For example, if this doubly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since the data is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me    the doubly-linked list to set data for
+ * @param index the index to set data in the doubly-linked list
+ * @param data  the data to set in the doubly-linked list
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_set_at(list me, const int index, void *const data)
+{
+    struct node *traverse;
+    if (list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    traverse = list_get_node_at(me, index);
+    memcpy(traverse->data, data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the data at the last index in the doubly-linked list. The pointer to
+ * the data being passed in should point to the data type which this doubly-
+ * linked list holds. For example, if this doubly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since the data is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me   the doubly-linked list to set data for
+ * @param data the data to set in the doubly-linked list
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_set_last(list me, void *const data)
+{
+    return list_set_at(me, me->item_count - 1, data);
+}
+
+/**
+ * Gets the data at the first index in the doubly-linked list. The pointer to
+ * the data being obtained should point to the data type which this doubly-
+ * linked list holds. For example, if this doubly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since this data is being
+ * copied from the array to the data pointer, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param data the data to get
+ * @param me   the doubly-linked list to get data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_get_first(void *const data, list me)
+{
+    return list_get_at(data, me, 0);
+}
+
+/**
+ * Gets the data at the specified index in the doubly-linked list. The pointer
+ * to the data being obtained should point to the data type which this doubly-
+ * linked list holds. For example, if this doubly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since this data is being
+ * copied from the array to the data pointer, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param data  the data to get
+ * @param me    the doubly-linked list to get data from
+ * @param index the index to get data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_get_at(void *const data, list me, const int index)
+{
+    struct node *traverse;
+    if (list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    traverse = list_get_node_at(me, index);
+    memcpy(data, traverse->data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Gets the data at the last index in the doubly-linked list. The pointer to
+ * the data being obtained should point to the data type which this doubly-
+ * linked list holds. For example, if this doubly-linked list holds integers,
+ * the data pointer should be a pointer to an integer. Since this data is being
+ * copied from the array to the data pointer, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param data the data to get
+ * @param me   the doubly-linked list to get data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_get_last(void *const data, list me)
+{
+    return list_get_at(data, me, me->item_count - 1);
+}
+
+/**
+ * Moves the cursor to the first element of the doubly-linked list. The cursor
+ * is owned by the caller, and remains valid until the doubly-linked list is
+ * modified other than through the cursor.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if the doubly-linked
+ *         list is empty
+ */
+int list_cursor_first(list me, struct list_cursor *const cursor)
+{
+    cursor->internal_node = me->head;
+    cursor->internal_index = 0;
+    return me->head != NULL;
+}
+
+/**
+ * Moves the cursor to the last element of the doubly-linked list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if the doubly-linked
+ *         list is empty
+ */
+int list_cursor_last(list me, struct list_cursor *const cursor)
+{
+    cursor->internal_node = me->tail;
+    cursor->internal_index = me->item_count - 1;
+    return me->tail != NULL;
+}
+
+/**
+ * Moves the cursor to the element at the specified index of the doubly-linked
+ * list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ * @param index  the index to move the cursor to
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_cursor_at(list me, struct list_cursor *const cursor, const int index)
+{
+    if (list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    cursor->internal_node = list_get_node_at(me, index);
+    cursor->internal_index = index;
+    return 0;
+}
+
+/**
+ * Moves the cursor to the next element of the doubly-linked list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if it moved past the
+ *         last element
+ */
+int list_cursor_next(list me, struct list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    (void) me;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_node = item->next;
+    cursor->internal_index++;
+    return item->next != NULL;
+}
+
+/**
+ * Moves the cursor to the previous element of the doubly-linked list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if it moved past the
+ *         first element
+ */
+int list_cursor_prev(list me, struct list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    (void) me;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_node = item->prev;
+    cursor->internal_index--;
+    return item->prev != NULL;
+}
+
+/**
+ * Gets the index of the element at the cursor.
+ *
+ * @param cursor the cursor to check
+ *
+ * @return the index of the element, or -1 if the cursor is not at an element
+ */
+int list_cursor_index(const struct list_cursor *const cursor)
+{
+    if (!cursor->internal_node) {
+        return -1;
+    }
+    return cursor->internal_index;
+}
+
+/**
+ * Copies the element at the cursor to data. The pointer to the data being
+ * obtained should point to the data type which this doubly-linked list holds.
+ *
+ * @param data   the data to get
+ * @param me     the doubly-linked list to get data from
+ * @param cursor the cursor to get at
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_get(void *const data,
+                    list me,
+                    const struct list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(data, item->data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the element at the cursor. The pointer to the data being passed in
+ * should point to the data type which this doubly-linked list holds.
+ *
+ * @param me     the doubly-linked list to set data for
+ * @param cursor the cursor to set at
+ * @param data   the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_set(list me,
+                    const struct list_cursor *const cursor,
+                    void *const data)
+{
+    struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(item->data, data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Adds data before the element at the cursor in constant time. The cursor
+ * stays at the same element.
+ *
+ * @param me     the doubly-linked list to add data to
+ * @param cursor the cursor to add before
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_add_before(list me,
+                           struct list_cursor *const cursor,
+                           void *const data)
+{
+    struct node *add;
+    if (!cursor->internal_node) {
+        return -EINVAL;
+    }
+    add = list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    list_link(me, add, cursor->internal_node, cursor->internal_index);
+    cursor->internal_index++;
+    return 0;
+}
+
+/**
+ * Adds data after the element at the cursor in constant time. The cursor stays
+ * at the same element.
+ *
+ * @param me     the doubly-linked list to add data to
+ * @param cursor the cursor to add after
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_add_after(list me,
+                          struct list_cursor *const cursor,
+                          void *const data)
+{
+    const struct node *const item = cursor->internal_node;
+    struct node *add;
+    if (!item) {
+        return -EINVAL;
+    }
+    add = list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    list_link(me, add, item->next, cursor->internal_index + 1);
+    return 0;
+}
+
+/**
+ * Removes the element at the cursor in constant time, and moves the cursor to
+ * the next element.
+ *
+ * @param me     the doubly-linked list to remove data from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at an element after the removal, otherwise 0
+ */
+int list_cursor_remove(list me, struct list_cursor *const cursor)
+{
+    struct node *const item = cursor->internal_node;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_node = item->next;
+    list_unlink(me, item, cursor->internal_index);
+    return cursor->internal_node != NULL;
+}
+
+/**
+ * Clears all elements from the doubly-linked list.
+ *
+ * @param me the doubly-linked list to clear
+ */
+void list_clear(list me)
+{
+    struct node *traverse = me->head;
+    while (traverse) {
+        struct node *const temp = traverse;
+        traverse = traverse->next;
+        free(temp->data);
+        free(temp);
+    }
+    me->head = NULL;
+    me->item_count = 0;
+    me->tail = NULL;
+    me->cache = NULL;
+}
+
+/**
+ * Destroys the doubly-linked list. Performing further operations after calling
+ * this function results in undefined behavior.
+ *
+ * @param me the doubly-linked list to destroy
+ *
+ * @return NULL
+ */
+list list_destroy(list me)
+{
+    list_clear(me);
+    free(me);
+    return NULL;
+}
+#undef node
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_BUFFER_SIZE map_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC map_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION map_SNAPSHOT_VERSION
+#define node map_node
+#define snapshot_header map_snapshot_header
+#define snapshot_stream map_snapshot_stream
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_map {
+    size_t key_size;
+    size_t value_size;
+    int (*comparator)(const void *const one, const void *const two);
+    int size;
+    struct node *root;
+};
+
+struct node {
+    struct node *parent;
+    int balance;
+    int weight;
+    void *key;
+    void *value;
+    struct node *left;
+    struct node *right;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is the key followed by the value.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
+/**
+ * Initializes a map.
+ *
+ * @param key_size   the size of each key in the map; must be positive
+ * @param value_size the size of each value in the map; must be positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized map, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+map map_init(const size_t key_size,
+             const size_t value_size,
+             int (*const comparator)(const void *const, const void *const))
+{
+    struct internal_map *init;
+    if (key_size == 0 || value_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_map));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->value_size = value_size;
+    init->comparator = comparator;
+    init->size = 0;
+    init->root = NULL;
+    return init;
+}
+
+/**
+ * Gets the size of the map.
+ *
+ * @param me the map to check
+ *
+ * @return the size of the map
+ */
+int map_size(map me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the map is empty.
+ *
+ * @param me the map to check
+ *
+ * @return 1 if the map is empty, otherwise 0
+ */
+int map_is_empty(map me)
+{
+    return map_size(me) == 0;
+}
+
+/*
+ * Resets the parent reference.
+ */
+static void map_reference_parent(map me,
+                                 struct node *const parent,
+                                 struct node *const child)
+{
+    child->parent = parent->parent;
+    if (!parent->parent) {
+        me->root = child;
+    } else if (parent->parent->left == parent) {
+        parent->parent->left = child;
+    } else {
+        parent->parent->right = child;
+    }
+}
+
+/*
+ * Gets the weight of a subtree, which is the amount of keys in it.
+ */
+static int map_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void map_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
+/*
+ * Rotates the AVL tree to the left.
+ */
+static void map_rotate_left(map me,
+                            struct node *const parent,
+                            struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    map_reference_parent(me, parent, child);
+    grand_child = child->left;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->right = grand_child;
+    child->left = parent;
+    parent->weight += map_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Rotates the AVL tree to the right.
+ */
+static void map_rotate_right(map me,
+                             struct node *const parent,
+                             struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    map_reference_parent(me, parent, child);
+    grand_child = child->right;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->left = grand_child;
+    child->right = parent;
+    parent->weight += map_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Performs a left repair.
+ */
+static struct node *map_repair_left(map me,
+                                    struct node *const parent,
+                                    struct node *const child)
+{
+    map_rotate_left(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = 1;
+        child->balance = -1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a right repair.
+ */
+static struct node *map_repair_right(map me,
+                                     struct node *const parent,
+                                     struct node *const child)
+{
+    map_rotate_right(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = -1;
+        child->balance = 1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a left-right repair.
+ */
+static struct node *map_repair_left_right(map me,
+                                          struct node *const parent,
+                                          struct node *const child,
+                                          struct node *const grand_child)
+{
+    map_rotate_left(me, child, grand_child);
+    map_rotate_right(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = 0;
+        child->balance = -1;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 1;
+        child->balance = 0;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Performs a right-left repair.
+ */
+static struct node *map_repair_right_left(map me,
+                                          struct node *const parent,
+                                          struct node *const child,
+                                          struct node *const grand_child)
+{
+    map_rotate_right(me, child, grand_child);
+    map_rotate_left(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = -1;
+        child->balance = 0;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 0;
+        child->balance = 1;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Repairs the AVL tree on insert. The only possible values of parent->balance
+ * are {-2, 2} and the only possible values of child->balance are {-1, 0, 1}.
+ */
+static struct node *map_repair(map me,
+                               struct node *const parent,
+                               struct node *const child,
+                               struct node *const grand_child)
+{
+    if (parent->balance == 2) {
+        if (child->balance == -1) {
+            return map_repair_right_left(me, parent, child, grand_child);
+        }
+        return map_repair_left(me, parent, child);
+    }
+    if (child->balance == 1) {
+        return map_repair_left_right(me, parent, child, grand_child);
+    }
+    return map_repair_right(me, parent, child);
+}
+
+/*
+ * Balances the AVL tree on insert.
+ */
+static void map_insert_balance(map me, struct node *const item)
+{
+    struct node *grand_child = NULL;
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance--;
+        } else {
+            parent->balance++;
+        }
+        /* If balance is zero after modification, then the tree is balanced. */
+        if (parent->balance == 0) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            /* After one repair, the tree is balanced. */
+            map_repair(me, parent, child, grand_child);
+            return;
+        }
+        grand_child = child;
+        child = parent;
+        parent = parent->parent;
+    }
+}
+
+/*
+ * Creates and allocates a node.
+ */
+static struct node *map_create_node(map me,
+                                    const void *const key,
+                                    const void *const value,
+                                    struct node *const parent)
+{
+    struct node *const insert = malloc(sizeof(struct node));
+    if (!insert) {
+        return NULL;
+    }
+    insert->parent = parent;
+    insert->balance = 0;
+    insert->weight = 1;
+    insert->key = malloc(me->key_size);
+    if (!insert->key) {
+        free(insert);
+        return NULL;
+    }
+    memcpy(insert->key, key, me->key_size);
+    insert->value = malloc(me->value_size);
+    if (!insert->value) {
+        free(insert->key);
+        free(insert);
+        return NULL;
+    }
+    memcpy(insert->value, value, me->value_size);
+    insert->left = NULL;
+    insert->right = NULL;
+    me->size++;
+    return insert;
+}
+
+/*
+ * Compares two keys.
+ */
+static int map_compare(map me, const void *const one, const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/**
+ * Adds a key-value pair to the map. If the map already contains the key, the
+ * value is updated to the new value. The pointer to the key and value being
+ * passed in should point to the key and value type which this map holds. For
+ * example, if this map holds integer keys and values, the key and value pointer
+ * should be a pointer to an integer. Since the key and value are being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me    the map to add to
+ * @param key   the key to add
+ * @param value the value to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int map_put(map me, void *const key, void *const value)
+{
+    struct node *traverse;
+    if (!me->root) {
+        struct node *insert = map_create_node(me, key, value, NULL);
+        if (!insert) {
+            return -ENOMEM;
+        }
+        me->root = insert;
+        return 0;
+    }
+    traverse = me->root;
+    for (;;) {
+        const int compare = map_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                struct node *insert = map_create_node(me, key, value, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->left = insert;
+                map_add_weight(traverse, 1);
+                map_insert_balance(me, insert);
+                return 0;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                struct node *insert = map_create_node(me, key, value, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->right = insert;
+                map_add_weight(traverse, 1);
+                map_insert_balance(me, insert);
+                return 0;
+            }
+        } else {
+            memcpy(traverse->value, value, me->value_size);
+            return 0;
+        }
+    }
+}
+
+/*
+ * If a match occurs, returns the match. Else, returns NULL.
+ */
+static struct node *map_equal_match(map me, const void *const key)
+{
+    struct node *traverse = me->root;
+    if (!traverse) {
+        return NULL;
+    }
+    for (;;) {
+        const int compare = map_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                return NULL;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                return NULL;
+            }
+        } else {
+            return traverse;
+        }
+    }
+}
+
+/**
+ * Gets the value associated with a key in the map. The pointer to the key being
+ * passed in and the value being obtained should point to the key and value
+ * types which this map holds. For example, if this map holds integer keys and
+ * values, the key and value pointers should be a pointer to an integer. Since
+ * the key and value are being copied, the pointer only has to be valid when
+ * this function is called.
+ *
+ * @param value the value to copy to
+ * @param me    the map to get from
+ * @param key   the key to search for
+ *
+ * @return 1 if the map contained the key-value pair, otherwise 0
+ */
+int map_get(void *const value, map me, void *const key)
+{
+    struct node *const traverse = map_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    memcpy(value, traverse->value, me->value_size);
+    return 1;
+}
+
+/**
+ * Determines if the map contains the specified key. The pointer to the key
+ * being passed in should point to the key type which this map holds. For
+ * example, if this map holds key integers, the key pointer should be a pointer
+ * to an integer. Since the key is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me  the map to check for the element
+ * @param key the key to check
+ *
+ * @return 1 if the map contained the element, otherwise 0
+ */
+int map_contains(map me, void *const key)
+{
+    return map_equal_match(me, key) != NULL;
+}
+
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of keys in its subtree. The pointer to the key
+ * being passed in should point to the key type which this map holds.
+ *
+ * @param me  the map to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of keys in the map which are less than the key
+ */
+int map_rank(map me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (map_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - map_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key-value pair at the specified index in sorted key order, so that
+ * index zero is the pair with the smallest key. Either of the key or the value
+ * may be NULL if it is not needed. This takes logarithmic time, since each node
+ * keeps track of the amount of keys in its subtree.
+ *
+ * @param key   the key to copy to, or NULL
+ * @param value the value to copy to, or NULL
+ * @param me    the map to get the key-value pair from
+ * @param index the index of the key-value pair in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int map_select(void *const key,
+               void *const value,
+               map me,
+               const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = map_weight(item->left);
+        const int own = item->weight - left - map_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            offset -= left;
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->value, me->value_size);
+    }
+    return 0;
+}
+
+/*
+ * Repairs the AVL tree by pivoting on an item.
+ */
+static struct node *map_repair_pivot(map me,
+                                     struct node *const item,
+                                     const int is_left_pivot)
+{
+    struct node *const child = is_left_pivot ? item->right : item->left;
+    struct node *const grand_child =
+            child->balance == 1 ? child->right : child->left;
+    return map_repair(me, item, child, grand_child);
+}
+
+/*
+ * Goes back up the tree repairing it along the way.
+ */
+static void map_trace_ancestors(map me, struct node *item)
+{
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance++;
+        } else {
+            parent->balance--;
+        }
+        /* The tree is balanced if balance is -1 or +1 after modification. */
+        if (parent->balance == -1 || parent->balance == 1) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            child = map_repair_pivot(me, parent, parent->left == child);
+            parent = child->parent;
+            /* If balance is -1 or +1 after modification or the parent is */
+            /* NULL, then the tree is balanced. */
+            if (!parent || child->balance == -1 || child->balance == 1) {
+                return;
+            }
+        } else {
+            child = parent;
+            parent = parent->parent;
+        }
+    }
+}
+
+/*
+ * Balances the AVL tree on deletion.
+ */
+static void map_delete_balance(map me,
+                               struct node *item,
+                               const int is_left_deleted)
+{
+    if (is_left_deleted) {
+        item->balance++;
+    } else {
+        item->balance--;
+    }
+    /* If balance is -1 or +1 after modification, then the tree is balanced. */
+    if (item->balance == -1 || item->balance == 1) {
+        return;
+    }
+    /* Must re-balance if not in {-1, 0, 1} */
+    if (item->balance > 1 || item->balance < -1) {
+        item = map_repair_pivot(me, item, is_left_deleted);
+        if (!item->parent || item->balance == -1 || item->balance == 1) {
+            return;
+        }
+    }
+    map_trace_ancestors(me, item);
+}
+
+/*
+ * Removes traverse when it has no children.
+ */
+static void map_remove_no_children(map me, const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent and no children, then the only node is traverse. */
+    if (!parent) {
+        me->root = NULL;
+        return;
+    }
+    /* No re-reference needed since traverse has no children. */
+    if (parent->left == traverse) {
+        parent->left = NULL;
+        map_delete_balance(me, parent, 1);
+    } else {
+        parent->right = NULL;
+        map_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has one child.
+ */
+static void map_remove_one_child(map me, const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent, make the child of traverse the new root. */
+    if (!parent) {
+        if (traverse->left) {
+            traverse->left->parent = NULL;
+            me->root = traverse->left;
+        } else {
+            traverse->right->parent = NULL;
+            me->root = traverse->right;
+        }
+        return;
+    }
+    /* The parent of traverse now references the child of traverse. */
+    if (parent->left == traverse) {
+        if (traverse->left) {
+            parent->left = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->left = traverse->right;
+            traverse->right->parent = parent;
+        }
+        map_delete_balance(me, parent, 1);
+    } else {
+        if (traverse->left) {
+            parent->right = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->right = traverse->right;
+            traverse->right->parent = parent;
+        }
+        map_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has two children.
+ */
+static void map_remove_two_children(map me, const struct node *const traverse)
+{
+    struct node *item;
+    struct node *parent;
+    const int is_left_deleted = traverse->right->left != NULL;
+    if (!is_left_deleted) {
+        item = traverse->right;
+        parent = item;
+        item->balance = traverse->balance;
+        item->parent = traverse->parent;
+        item->left = traverse->left;
+        item->left->parent = item;
+    } else {
+        item = traverse->right->left;
+        while (item->left) {
+            item = item->left;
+        }
+        parent = item->parent;
+        item->balance = traverse->balance;
+        item->parent->left = item->right;
+        if (item->right) {
+            item->right->parent = item->parent;
+        }
+        item->left = traverse->left;
+        item->left->parent = item;
+        item->right = traverse->right;
+        item->right->parent = item;
+        item->parent = traverse->parent;
+    }
+    if (!traverse->parent) {
+        me->root = item;
+    } else if (traverse->parent->left == traverse) {
+        item->parent->left = item;
+    } else {
+        item->parent->right = item;
+    }
+    map_delete_balance(me, parent, is_left_deleted);
+}
+
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void map_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - map_weight(traverse->left)
+                    - map_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    map_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - map_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
+/*
+ * Removes the element from the map.
+ */
+static void map_remove_element(map me, struct node *const traverse)
+{
+    map_remove_weight(traverse);
+    if (!traverse->left && !traverse->right) {
+        map_remove_no_children(me, traverse);
+    } else if (!traverse->left || !traverse->right) {
+        map_remove_one_child(me, traverse);
+    } else {
+        map_remove_two_children(me, traverse);
+    }
+    free(traverse->key);
+    free(traverse->value);
+    free(traverse);
+    me->size--;
+}
+
+/**
+ * Removes the key-value pair from the map if it contains it. The pointer to the
+ * key being passed in should point to the key type which this map holds. For
+ * example, if this map holds key integers, the key pointer should be a pointer
+ * to an integer. Since the key is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me  the map to remove an element from
+ * @param key the key to remove
+ *
+ * @return 1 if the map contained the key-value pair, otherwise 0
+ */
+int map_remove(map me, void *const key)
+{
+    struct node *const traverse = map_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    map_remove_element(me, traverse);
+    return 1;
+}
+
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *map_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was only partially built.
+ */
+static void map_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    map_free_subtree(item->left);
+    map_free_subtree(item->right);
+    free(item->key);
+    free(item->value);
+    free(item);
+}
+
+/*
+ * Gets the node with the smallest key in the subtree.
+ */
+static struct node *map_first_node(struct node *item)
+{
+    if (item) {
+        while (item->left) {
+            item = item->left;
+        }
+    }
+    return item;
+}
+
+/*
+ * Builds a balanced subtree from copies of the sorted items. The middle item is
+ * the root of the subtree, and the items before and after it form the left and
+ * right subtrees.
+ */
+static int map_build_subtree(map me,
+                             const struct node *const *const items,
+                             const int count,
+                             struct node **const subtree,
+                             int *const height)
+{
+    const int left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = map_build_subtree(me, items, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    item = map_create_node(me, items[left_count]->key,
+                           items[left_count]->value, NULL);
+    if (!item) {
+        map_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = map_build_subtree(me, items + left_count + 1,
+                           count - 1 - left_count, &right, &right_height);
+    if (rc != 0) {
+        map_free_subtree(left);
+        map_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + map_weight(left) + map_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+/*
+ * Merges the key-value pairs of two maps in sorted key order into an empty map.
+ * The flags specify whether the keys which are only in the first map, in both
+ * maps, or only in the second map are kept. When a key is in both maps, its
+ * value is taken from the first map.
+ */
+static int map_combine(map me,
+                       map one,
+                       map two,
+                       const int keep_one,
+                       const int keep_both,
+                       const int keep_two)
+{
+    struct node *first = map_first_node(one->root);
+    struct node *second = map_first_node(two->root);
+    const struct node **items;
+    int count = 0;
+    int height;
+    int rc;
+    if (me->root || me->key_size != one->key_size
+        || me->key_size != two->key_size || me->value_size != one->value_size
+        || me->value_size != two->value_size) {
+        return -EINVAL;
+    }
+    if (one->size + two->size == 0) {
+        return 0;
+    }
+    items = malloc((one->size + two->size) * sizeof(const struct node *));
+    if (!items) {
+        return -ENOMEM;
+    }
+    while (first || second) {
+        int compare;
+        if (!first) {
+            compare = 1;
+        } else if (!second) {
+            compare = -1;
+        } else {
+            compare = map_compare(one, first->key, second->key);
+        }
+        if (compare < 0) {
+            if (keep_one) {
+                items[count++] = first;
+            }
+            first = map_next_node(first);
+        } else if (compare > 0) {
+            if (keep_two) {
+                items[count++] = second;
+            }
+            second = map_next_node(second);
+        } else {
+            if (keep_both) {
+                items[count++] = first;
+            }
+            first = map_next_node(first);
+            second = map_next_node(second);
+        }
+    }
+    rc = map_build_subtree(me, items, count, &me->root, &height);
+    if (rc != 0) {
+        me->size = 0;
+    }
+    free(items);
+    return rc;
+}
+
+/**
+ * Stores the union of two maps in an empty map, which is every key that is in
+ * either of the maps. The value of a key which is in both maps is taken from
+ * the first map. Since both maps are traversed in sorted order at the same
+ * time, and the balanced tree is built directly from the result, this takes
+ * linear time. The maps must all have the same key size, value size, and
+ * comparator function. If an error occurs, the map is left empty.
+ *
+ * @param me  the empty map to store the union in
+ * @param one the first map
+ * @param two the second map
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the key or value sizes do not
+ *                 match
+ */
+int map_union(map me, map one, map two)
+{
+    return map_combine(me, one, two, 1, 1, 1);
+}
+
+/**
+ * Stores the intersection of two maps in an empty map, which is every key that
+ * is in both of the maps, along with its value in the first map. This takes
+ * linear time. The maps must all have the same key size, value size, and
+ * comparator function. If an error occurs, the map is left empty.
+ *
+ * @param me  the empty map to store the intersection in
+ * @param one the first map
+ * @param two the second map
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the key or value sizes do not
+ *                 match
+ */
+int map_intersection(map me, map one, map two)
+{
+    return map_combine(me, one, two, 0, 1, 0);
+}
+
+/**
+ * Stores the difference of two maps in an empty map, which is every key that is
+ * in the first map but not in the second map, along with its value. This takes
+ * linear time. The maps must all have the same key size, value size, and
+ * comparator function. If an error occurs, the map is left empty.
+ *
+ * @param me  the empty map to store the difference in
+ * @param one the map to take the keys from
+ * @param two the map whose keys to leave out
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the key or value sizes do not
+ *                 match
+ */
+int map_difference(map me, map one, map two)
+{
+    return map_combine(me, one, two, 1, 0, 0);
+}
+
+/**
+ * Determines if every key of the map is also in the other map. The values are
+ * not compared. This takes linear time, since both maps are traversed in sorted
+ * order at the same time. The maps must have the same comparator function.
+ *
+ * @param me    the map which may be a subset
+ * @param other the map which may contain it
+ *
+ * @return 1 if the map is a subset of the other map, otherwise 0
+ */
+int map_is_subset(map me, map other)
+{
+    struct node *first = map_first_node(me->root);
+    struct node *second = map_first_node(other->root);
+    if (me->size > other->size) {
+        return 0;
+    }
+    while (first) {
+        int compare;
+        if (!second) {
+            return 0;
+        }
+        compare = map_compare(me, first->key, second->key);
+        if (compare < 0) {
+            return 0;
+        }
+        if (compare == 0) {
+            first = map_next_node(first);
+        }
+        second = map_next_node(second);
+    }
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void map_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void map_stream_write(struct snapshot_stream *const stream,
+                             const void *const data,
+                             const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            map_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void map_stream_read(struct snapshot_stream *const stream,
+                            void *const data,
+                            const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int map_load_subtree(map me,
+                            struct snapshot_stream *const stream,
+                            const unsigned long count,
+                            struct node **const subtree,
+                            int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = map_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    map_stream_read(stream, stream->record, me->key_size + me->value_size);
+    if (stream->rc != 0) {
+        map_free_subtree(left);
+        return stream->rc;
+    }
+    item = map_create_node(me, stream->record,
+                           stream->record + me->key_size, NULL);
+    if (!item) {
+        map_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = map_load_subtree(me, stream, count - 1 - left_count, &right,
+                          &right_height);
+    if (rc != 0) {
+        map_free_subtree(left);
+        map_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + map_weight(left) + map_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the map to a file descriptor. The snapshot
+ * consists of a header, which holds the key size, the value size, and the
+ * amount of key-value pairs, followed by the key and the value of each pair in
+ * sorted order. Since the keys and values are copied byte for byte, they should
+ * not contain pointers unless the snapshot is loaded by the same process.
+ *
+ * @param me the map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int map_save(map me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *traverse = me->root;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    header.count = (unsigned long) me->size;
+    map_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    if (traverse) {
+        while (traverse->left) {
+            traverse = traverse->left;
+        }
+    }
+    while (stream.rc == 0 && traverse) {
+        map_stream_write(&stream, traverse->key, me->key_size);
+        map_stream_write(&stream, traverse->value, me->value_size);
+        traverse = map_next_node(traverse);
+    }
+    map_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by map_save into an empty map.
+ * Since the snapshot is sorted, the balanced tree is built directly from it in
+ * linear time without calling the comparator function. Thus, the map must have
+ * been initialized with the same key size, value size, and comparator function
+ * as the map which was saved. If an error occurs, the map is left empty. When
+ * the file descriptor is seekable, it is left positioned right after the
+ * snapshot.
+ *
+ * @param me the map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the snapshot does not match the
+ *                 map
+ * @return -EIO    if the snapshot could not be read
+ */
+int map_load(map me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer =
+            malloc(SNAPSHOT_BUFFER_SIZE + me->key_size + me->value_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    map_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != (unsigned long) me->value_size
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = map_load_subtree(me, &stream, header.count, &me->root, &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the key-value pairs from the map.
+ *
+ * @param me the map to clear
+ */
+void map_clear(map me)
+{
+    while (me->root) {
+        map_remove_element(me, me->root);
+    }
+}
+
+/**
+ * Frees the map memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the map to free from memory
+ *
+ * @return NULL
+ */
+map map_destroy(map me)
+{
+    map_clear(me);
+    free(me);
+    return NULL;
+}
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef node
+#undef snapshot_header
+#undef snapshot_stream
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_BUFFER_SIZE multimap_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC multimap_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION multimap_SNAPSHOT_VERSION
+#define node multimap_node
+#define snapshot_header multimap_snapshot_header
+#define snapshot_stream multimap_snapshot_stream
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_multimap {
+    size_t key_size;
+    size_t value_size;
+    int (*key_comparator)(const void *const one, const void *const two);
+    int (*value_comparator)(const void *const one, const void *const two);
+    int size;
+    struct node *root;
+    struct multimap_values iterate;
+};
+
+struct node {
+    struct node *parent;
+    int balance;
+    int weight;
+    void *key;
+    int value_count;
+    int value_capacity;
+    char *values;
+    struct node *left;
+    struct node *right;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is the value count followed by the key and the
+ * values.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
+/**
+ * Initializes a multi-map.
+ *
+ * @param key_size         the size of each key in the multi-map; must be
+ *                         positive
+ * @param value_size       the size of each value in the multi-map; must be
+ *                         positive
+ * @param key_comparator   the key comparator function; must not be NULL; may be
+ *                         one of the built-in comparators from compare.h
+ * @param value_comparator the value comparator function; must not be NULL
+ *
+ * @return the newly-initialized multi-map, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+multimap multimap_init(const size_t key_size,
+                       const size_t value_size,
+                       int (*const key_comparator)(const void *const,
+                                                   const void *const),
+                       int (*const value_comparator)(const void *const,
+                                                     const void *const))
+{
+    struct internal_multimap *init;
+    if (key_size == 0 || value_size == 0
+        || !key_comparator || !value_comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_multimap));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->value_size = value_size;
+    init->key_comparator = key_comparator;
+    init->value_comparator = value_comparator;
+    init->size = 0;
+    init->root = NULL;
+    init->iterate.internal_values = NULL;
+    init->iterate.internal_count = 0;
+    init->iterate.internal_index = 0;
+    return init;
+}
+
+/**
+ * Gets the size of the multi-map.
+ *
+ * @param me the multi-map to check
+ *
+ * @return the size of the multi-map
+ */
+int multimap_size(multimap me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the multi-map is empty.
+ *
+ * @param me the multi-map to check
+ *
+ * @return 1 if the multi-map is empty, otherwise 0
+ */
+int multimap_is_empty(multimap me)
+{
+    return multimap_size(me) == 0;
+}
+
+/*
+ * Resets the parent reference.
+ */
+static void multimap_reference_parent(multimap me,
+                                      struct node *const parent,
+                                      struct node *const child)
+{
+    child->parent = parent->parent;
+    if (!parent->parent) {
+        me->root = child;
+    } else if (parent->parent->left == parent) {
+        parent->parent->left = child;
+    } else {
+        parent->parent->right = child;
+    }
+}
+
+/*
+ * Gets the weight of a subtree, which is the amount of elements in it.
+ */
+static int multimap_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void multimap_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
+/*
+ * Rotates the AVL tree to the left.
+ */
+static void multimap_rotate_left(multimap me,
+                                 struct node *const parent,
+                                 struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    multimap_reference_parent(me, parent, child);
+    grand_child = child->left;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->right = grand_child;
+    child->left = parent;
+    parent->weight += multimap_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Rotates the AVL tree to the right.
+ */
+static void multimap_rotate_right(multimap me,
+                                  struct node *const parent,
+                                  struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    multimap_reference_parent(me, parent, child);
+    grand_child = child->right;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->left = grand_child;
+    child->right = parent;
+    parent->weight += multimap_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Performs a left repair.
+ */
+static struct node *multimap_repair_left(multimap me,
+                                         struct node *const parent,
+                                         struct node *const child)
+{
+    multimap_rotate_left(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = 1;
+        child->balance = -1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a right repair.
+ */
+static struct node *multimap_repair_right(multimap me,
+                                          struct node *const parent,
+                                          struct node *const child)
+{
+    multimap_rotate_right(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = -1;
+        child->balance = 1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a left-right repair.
+ */
+static struct node *multimap_repair_left_right(multimap me,
+                                               struct node *const parent,
+                                               struct node *const child,
+                                               struct node *const grand_child)
+{
+    multimap_rotate_left(me, child, grand_child);
+    multimap_rotate_right(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = 0;
+        child->balance = -1;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 1;
+        child->balance = 0;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Performs a right-left repair.
+ */
+static struct node *multimap_repair_right_left(multimap me,
+                                               struct node *const parent,
+                                               struct node *const child,
+                                               struct node *const grand_child)
+{
+    multimap_rotate_right(me, child, grand_child);
+    multimap_rotate_left(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = -1;
+        child->balance = 0;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 0;
+        child->balance = 1;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Repairs the AVL tree on insert. The only possible values of parent->balance
+ * are {-2, 2} and the only possible values of child->balance are {-1, 0, 1}.
+ */
+static struct node *multimap_repair(multimap me,
+                                    struct node *const parent,
+                                    struct node *const child,
+                                    struct node *const grand_child)
+{
+    if (parent->balance == 2) {
+        if (child->balance == -1) {
+            return multimap_repair_right_left(me, parent, child, grand_child);
+        }
+        return multimap_repair_left(me, parent, child);
+    }
+    if (child->balance == 1) {
+        return multimap_repair_left_right(me, parent, child, grand_child);
+    }
+    return multimap_repair_right(me, parent, child);
+}
+
+/*
+ * Balances the AVL tree on insert.
+ */
+static void multimap_insert_balance(multimap me, struct node *const item)
+{
+    struct node *grand_child = NULL;
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance--;
+        } else {
+            parent->balance++;
+        }
+        /* If balance is zero after modification, then the tree is balanced. */
+        if (parent->balance == 0) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            /* After one repair, the tree is balanced. */
+            multimap_repair(me, parent, child, grand_child);
+            return;
+        }
+        grand_child = child;
+        child = parent;
+        parent = parent->parent;
+    }
+}
+
+/*
+ * Resizes the array which holds the values of a key. The values of a key are
+ * stored contiguously in insertion order.
+ */
+static int multimap_resize_values(multimap me,
+                                  struct node *const item,
+                                  const int capacity)
+{
+    char *const temp = realloc(item->values, capacity * me->value_size);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    item->values = temp;
+    item->value_capacity = capacity;
+    return 0;
+}
+
+/*
+ * Appends a value to the values of a key, doubling the capacity of the array
+ * when it is full.
+ */
+static int multimap_append_value(multimap me,
+                                 struct node *const item,
+                                 const void *const value)
+{
+    if (item->value_count == item->value_capacity) {
+        const int rc = multimap_resize_values(me, item,
+                                              2 * item->value_capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    memcpy(item->values + item->value_count * me->value_size, value,
+           me->value_size);
+    item->value_count++;
+    multimap_add_weight(item, 1);
+    me->size++;
+    return 0;
+}
+
+/*
+ * Creates and allocates a node.
+ */
+static struct node *multimap_create_node(multimap me,
+                                         const void *const key,
+                                         const void *const value,
+                                         struct node *const parent)
+{
+    struct node *const insert = malloc(sizeof(struct node));
+    if (!insert) {
+        return NULL;
+    }
+    insert->parent = parent;
+    insert->balance = 0;
+    insert->weight = 1;
+    insert->key = malloc(me->key_size);
+    if (!insert->key) {
+        free(insert);
+        return NULL;
+    }
+    memcpy(insert->key, key, me->key_size);
+    insert->value_count = 1;
+    insert->value_capacity = 1;
+    insert->values = malloc(me->value_size);
+    if (!insert->values) {
+        free(insert->key);
+        free(insert);
+        return NULL;
+    }
+    memcpy(insert->values, value, me->value_size);
+    insert->left = NULL;
+    insert->right = NULL;
+    me->size++;
+    return insert;
+}
+
+/*
+ * Compares two keys.
+ */
+static int multimap_compare(multimap me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->key_comparator, me->key_size, one, two);
+}
+
+/*
+ * Compares two values.
+ */
+static int multimap_compare_values(multimap me,
+                                   const void *const one,
+                                   const void *const two)
+{
+    return CONTAINERS_COMPARE(me->value_comparator, me->value_size, one, two);
+}
+
+/**
+ * Adds a key-value pair to the multi-map. If the multi-map already contains the
+ * key, the value is updated to the new value. The pointer to the key and value
+ * being passed in should point to the key and value type which this multi-map
+ * holds. For example, if this multi-map holds integer keys and values, the key
+ * and value pointer should be a pointer to an integer. Since the key and value
+ * are being copied, the pointer only has to be valid when this function is
+ * called.
+ *
+ * @param me    the multi-map to add to
+ * @param key   the key to add
+ * @param value the value to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int multimap_put(multimap me, void *const key, void *const value)
+{
+    struct node *traverse;
+    if (!me->root) {
+        struct node *insert = multimap_create_node(me, key, value, NULL);
+        if (!insert) {
+            return -ENOMEM;
+        }
+        me->root = insert;
+        return 0;
+    }
+    traverse = me->root;
+    for (;;) {
+        const int compare = multimap_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                struct node *insert =
+                        multimap_create_node(me, key, value, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->left = insert;
+                multimap_add_weight(traverse, 1);
+                multimap_insert_balance(me, insert);
+                return 0;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                struct node *insert =
+                        multimap_create_node(me, key, value, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->right = insert;
+                multimap_add_weight(traverse, 1);
+                multimap_insert_balance(me, insert);
+                return 0;
+            }
+        } else {
+            return multimap_append_value(me, traverse, value);
+        }
+    }
+}
+
+/*
+ * If a match occurs, returns the match. Else, returns NULL.
+ */
+static struct node *multimap_equal_match(multimap me, const void *const key)
+{
+    struct node *traverse = me->root;
+    if (!traverse) {
+        return 0;
+    }
+    for (;;) {
+        const int compare = multimap_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                return NULL;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                return NULL;
+            }
+        } else {
+            return traverse;
+        }
+    }
+}
+
+/**
+ * Creates the iterator for the specified key. To iterate over the values, keep
+ * getting the next value. Since the iterator is kept in the multi-map, only one
+ * iteration may be in progress at a time, which multimap_values_start avoids.
+ * Between starting and iterations, the multi-map must not be mutated. The
+ * pointer to the key being passed in should point to the key type which this
+ * multi-map holds. For example, if this multi-map holds key integers, the key
+ * pointer should be a pointer to an integer. Since the key is being copied, the
+ * pointer only has to be valid when this function is called.
+ *
+ * @param me  the multi-map to start the iterator for
+ * @param key the key to start the iterator for
+ */
+void multimap_get_start(multimap me, void *const key)
+{
+    multimap_values_start(me, &me->iterate, key);
+}
+
+/**
+ * Iterates over the values for the specified key. Must be called after starting
+ * the iterator. The multi-map must not be mutated between start and iterations.
+ * The pointer to the value being obtained should point to the value type which
+ * this multi-map holds. For example, if this multi-map holds value integers,
+ * the value pointer should be a pointer to an integer. Since the value is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param value the value to be copied to from iteration
+ * @param me    the multi-map to iterate over
+ *
+ * @return 1 if there exist no more values for the key which is being iterated
+ *         over, otherwise 0
+ */
+int multimap_get_next(void *const value, multimap me)
+{
+    return multimap_values_next(value, me, &me->iterate);
+}
+
+/**
+ * Starts iterating over the values for the specified key with a cursor which is
+ * owned by the caller. Unlike multimap_get_start, this does not modify the
+ * multi-map, so several iterations may be in progress at the same time,
+ * including from different threads as long as none of them mutates the
+ * multi-map. The cursor is only valid until the multi-map is next mutated. The
+ * pointer to the key being passed in should point to the key type which this
+ * multi-map holds.
+ *
+ * @param me     the multi-map to iterate over
+ * @param cursor the cursor to start
+ * @param key    the key to iterate over the values of
+ *
+ * @return the number of values for the key
+ */
+int multimap_values_start(multimap me,
+                          struct multimap_values *const cursor,
+                          void *const key)
+{
+    const struct node *const item = multimap_equal_match(me, key);
+    cursor->internal_index = 0;
+    if (!item) {
+        cursor->internal_values = NULL;
+        cursor->internal_count = 0;
+        return 0;
+    }
+    cursor->internal_values = item->values;
+    cursor->internal_count = item->value_count;
+    return item->value_count;
+}
+
+/**
+ * Copies the next value of the cursor, and advances the cursor. The pointer to
+ * the value being obtained should point to the value type which this multi-map
+ * holds.
+ *
+ * @param value  the value to be copied to
+ * @param me     the multi-map being iterated over
+ * @param cursor the cursor to advance
+ *
+ * @return 1 if a value was copied, otherwise 0 if there are no more values
+ */
+int multimap_values_next(void *const value,
+                         multimap me,
+                         struct multimap_values *const cursor)
+{
+    const char *item;
+    if (cursor->internal_index == cursor->internal_count) {
+        return 0;
+    }
+    item = cursor->internal_values;
+    memcpy(value, item + cursor->internal_index * me->value_size,
+           me->value_size);
+    cursor->internal_index++;
+    return 1;
+}
+
+/**
+ * Gets all the values for the specified key at once. The values are stored
+ * contiguously in the order in which they were added, so the span may be read
+ * directly as an array of the value type which this multi-map holds. The span
+ * is owned by the multi-map, and is only valid until the multi-map is next
+ * mutated. The pointer to the key being passed in should point to the key type
+ * which this multi-map holds.
+ *
+ * @param values the pointer to set to the start of the values, or to NULL if
+ *               the multi-map does not contain the key
+ * @param me     the multi-map to get the values from
+ * @param key    the key to get the values for
+ *
+ * @return the number of values in the span
+ */
+int multimap_get_values(void **const values, multimap me, void *const key)
+{
+    struct node *const traverse = multimap_equal_match(me, key);
+    if (!traverse) {
+        *values = NULL;
+        return 0;
+    }
+    *values = traverse->values;
+    return traverse->value_count;
+}
+
+/**
+ * Determines the number of times the key appears in the multi-map. The pointer
+ * to the key being passed in should point to the key type which this multi-map
+ * holds. For example, if this multi-map holds key integers, the key pointer
+ * should be a pointer to an integer. Since the key is being copied, the pointer
+ * only has to be valid when this function is called.
+ *
+ * @param me  the multi-map to check for the key
+ * @param key the key to check
+ *
+ * @return the number of times the key appears in the multi-map
+ */
+int multimap_count(multimap me, void *const key)
+{
+    struct node *const traverse = multimap_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    return traverse->value_count;
+}
+
+/**
+ * Determines if the multi-map contains the specified key. The pointer to the
+ * key being passed in should point to the key type which this multi-map holds.
+ * For example, if this multi-map holds key integers, the key pointer should be
+ * a pointer to an integer. Since the key is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me  the multi-map to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the multi-map contained the key, otherwise 0
+ */
+int multimap_contains(multimap me, void *const key)
+{
+    return multimap_equal_match(me, key) != NULL;
+}
+
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of key-value pairs in its subtree. The pointer to the key
+ * being passed in should point to the key type which this multi-map holds.
+ *
+ * @param me  the multi-map to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of key-value pairs in the multi-map whose key is less
+ *         than the key
+ */
+int multimap_rank(multimap me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (multimap_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - multimap_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key-value pair at the specified index in sorted key order, where
+ * the values of a key are in the order in which they were added, so that index
+ * zero is the first value of the smallest key. Either of the key or the value
+ * may be NULL if it is not needed. This takes logarithmic time, since each node
+ * keeps track of the amount of key-value pairs in its subtree.
+ *
+ * @param key   the key to copy to, or NULL
+ * @param value the value to copy to, or NULL
+ * @param me    the multi-map to get the key-value pair from
+ * @param index the index of the key-value pair in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int multimap_select(void *const key,
+                    void *const value,
+                    multimap me,
+                    const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = multimap_weight(item->left);
+        const int own = item->weight - left - multimap_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            offset -= left;
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->values + offset * me->value_size, me->value_size);
+    }
+    return 0;
+}
+
+/*
+ * Repairs the AVL tree by pivoting on an item.
+ */
+static struct node *multimap_repair_pivot(multimap me,
+                                          struct node *const item,
+                                          const int is_left_pivot)
+{
+    struct node *const child = is_left_pivot ? item->right : item->left;
+    struct node *const grand_child =
+            child->balance == 1 ? child->right : child->left;
+    return multimap_repair(me, item, child, grand_child);
+}
+
+/*
+ * Goes back up the tree repairing it along the way.
+ */
+static void multimap_trace_ancestors(multimap me, struct node *item)
+{
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance++;
+        } else {
+            parent->balance--;
+        }
+        /* The tree is balanced if balance is -1 or +1 after modification. */
+        if (parent->balance == -1 || parent->balance == 1) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            child = multimap_repair_pivot(me, parent, parent->left == child);
+            parent = child->parent;
+            /* If balance is -1 or +1 after modification or the parent is */
+            /* NULL, then the tree is balanced. */
+            if (!parent || child->balance == -1 || child->balance == 1) {
+                return;
+            }
+        } else {
+            child = parent;
+            parent = parent->parent;
+        }
+    }
+}
+
+/*
+ * Balances the AVL tree on deletion.
+ */
+static void multimap_delete_balance(multimap me,
+                                    struct node *item,
+                                    const int is_left_deleted)
+{
+    if (is_left_deleted) {
+        item->balance++;
+    } else {
+        item->balance--;
+    }
+    /* If balance is -1 or +1 after modification, then the tree is balanced. */
+    if (item->balance == -1 || item->balance == 1) {
+        return;
+    }
+    /* Must re-balance if not in {-1, 0, 1} */
+    if (item->balance > 1 || item->balance < -1) {
+        item = multimap_repair_pivot(me, item, is_left_deleted);
+        if (!item->parent || item->balance == -1 || item->balance == 1) {
+            return;
+        }
+    }
+    multimap_trace_ancestors(me, item);
+}
+
+/*
+ * Removes traverse when it has no children.
+ */
+static void multimap_remove_no_children(multimap me,
+                                        const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent and no children, then the only node is traverse. */
+    if (!parent) {
+        me->root = NULL;
+        return;
+    }
+    /* No re-reference needed since traverse has no children. */
+    if (parent->left == traverse) {
+        parent->left = NULL;
+        multimap_delete_balance(me, parent, 1);
+    } else {
+        parent->right = NULL;
+        multimap_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has one child.
+ */
+static void multimap_remove_one_child(multimap me,
+                                      const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent, make the child of traverse the new root. */
+    if (!parent) {
+        if (traverse->left) {
+            traverse->left->parent = NULL;
+            me->root = traverse->left;
+        } else {
+            traverse->right->parent = NULL;
+            me->root = traverse->right;
+        }
+        return;
+    }
+    /* The parent of traverse now references the child of traverse. */
+    if (parent->left == traverse) {
+        if (traverse->left) {
+            parent->left = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->left = traverse->right;
+            traverse->right->parent = parent;
+        }
+        multimap_delete_balance(me, parent, 1);
+    } else {
+        if (traverse->left) {
+            parent->right = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->right = traverse->right;
+            traverse->right->parent = parent;
+        }
+        multimap_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has two children.
+ */
+static void multimap_remove_two_children(multimap me,
+                                         const struct node *const traverse)
+{
+    struct node *item;
+    struct node *parent;
+    const int is_left_deleted = traverse->right->left != NULL;
+    if (!is_left_deleted) {
+        item = traverse->right;
+        parent = item;
+        item->balance = traverse->balance;
+        item->parent = traverse->parent;
+        item->left = traverse->left;
+        item->left->parent = item;
+    } else {
+        item = traverse->right->left;
+        while (item->left) {
+            item = item->left;
+        }
+        parent = item->parent;
+        item->balance = traverse->balance;
+        item->parent->left = item->right;
+        if (item->right) {
+            item->right->parent = item->parent;
+        }
+        item->left = traverse->left;
+        item->left->parent = item;
+        item->right = traverse->right;
+        item->right->parent = item;
+        item->parent = traverse->parent;
+    }
+    if (!traverse->parent) {
+        me->root = item;
+    } else if (traverse->parent->left == traverse) {
+        item->parent->left = item;
+    } else {
+        item->parent->right = item;
+    }
+    multimap_delete_balance(me, parent, is_left_deleted);
+}
+
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void multimap_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - multimap_weight(traverse->left)
+                    - multimap_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    multimap_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - multimap_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
+/*
+ * Removes the element from the map.
+ */
+static void multimap_remove_element(multimap me, struct node *const traverse)
+{
+    multimap_remove_weight(traverse);
+    if (!traverse->left && !traverse->right) {
+        multimap_remove_no_children(me, traverse);
+    } else if (!traverse->left || !traverse->right) {
+        multimap_remove_one_child(me, traverse);
+    } else {
+        multimap_remove_two_children(me, traverse);
+    }
+    free(traverse->values);
+    free(traverse->key);
+    free(traverse);
+}
+
+/**
+ * Removes the key-value pair from the multi-map if it contains it. The pointer
+ * to the key and value being passed in should point to the key and value type
+ * which this multi-map holds. For example, if this multi-map holds integer keys
+ * and values, the key and value pointer should be a pointer to an integer.
+ * Since the key and value are being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me    the multi-map to remove a key from
+ * @param key   the key to remove
+ * @param value the value to remove
+ *
+ * @return 1 if the multi-map contained the key, otherwise 0
+ */
+int multimap_remove(multimap me, void *const key, void *const value)
+{
+    char *position;
+    char *end;
+    struct node *const traverse = multimap_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    position = traverse->values;
+    end = traverse->values + traverse->value_count * me->value_size;
+    while (position < end
+           && multimap_compare_values(me, position, value) != 0) {
+        position += me->value_size;
+    }
+    if (position == end) {
+        return 0;
+    }
+    memmove(position, position + me->value_size,
+            end - position - me->value_size);
+    traverse->value_count--;
+    multimap_add_weight(traverse, -1);
+    me->size--;
+    if (traverse->value_count == 0) {
+        multimap_remove_element(me, traverse);
+    } else if (traverse->value_count <= traverse->value_capacity / 4) {
+        multimap_resize_values(me, traverse, traverse->value_capacity / 2);
+    }
+    return 1;
+}
+
+/*
+ * Removes all values associated with a key.
+ */
+static void multimap_remove_all_element(multimap me,
+                                        struct node *const traverse)
+{
+    me->size -= traverse->value_count;
+    multimap_remove_element(me, traverse);
+}
+
+/**
+ * Removes all the key-value pairs from the multi-map specified by the key. The
+ * pointer to the key being passed in should point to the key type which this
+ * multi-map holds. For example, if this multi-map holds key integers, the key
+ * pointer should be a pointer to an integer. Since the key is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me  the multi-map to remove a key-value pair from
+ * @param key the key to remove
+ *
+ * @return 1 if the multi-map contained the key, otherwise 0
+ */
+int multimap_remove_all(multimap me, void *const key)
+{
+    struct node *const traverse = multimap_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    multimap_remove_all_element(me, traverse);
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void multimap_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void multimap_stream_write(struct snapshot_stream *const stream,
+                                  const void *const data,
+                                  const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            multimap_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void multimap_stream_read(struct snapshot_stream *const stream,
+                                 void *const data,
+                                 const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *multimap_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was partially loaded from a snapshot.
+ */
+static void multimap_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    multimap_free_subtree(item->left);
+    multimap_free_subtree(item->right);
+    free(item->values);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int multimap_load_subtree(multimap me,
+                                 struct snapshot_stream *const stream,
+                                 const unsigned long count,
+                                 struct node **const subtree,
+                                 int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    char *const value = stream->record + me->key_size;
+    unsigned long value_count;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = multimap_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    multimap_stream_read(stream, &value_count, sizeof(unsigned long));
+    multimap_stream_read(stream, stream->record, me->key_size + me->value_size);
+    if (stream->rc != 0) {
+        multimap_free_subtree(left);
+        return stream->rc;
+    }
+    if (value_count == 0
+        || value_count > (unsigned long) (INT_MAX - me->size)
+        || value_count > (size_t) -1 / me->value_size) {
+        multimap_free_subtree(left);
+        return -EINVAL;
+    }
+    item = multimap_create_node(me, stream->record, value, NULL);
+    if (!item) {
+        multimap_free_subtree(left);
+        return -ENOMEM;
+    }
+    if (value_count > 1) {
+        rc = multimap_resize_values(me, item, (int) value_count);
+        if (rc != 0) {
+            multimap_free_subtree(left);
+            multimap_free_subtree(item);
+            return rc;
+        }
+        multimap_stream_read(stream, item->values + me->value_size,
+                             (value_count - 1) * me->value_size);
+        if (stream->rc != 0) {
+            multimap_free_subtree(left);
+            multimap_free_subtree(item);
+            return stream->rc;
+        }
+        item->value_count = (int) value_count;
+        me->size += (int) value_count - 1;
+    }
+    rc = multimap_load_subtree(me, stream, count - 1 - left_count, &right,
+                               &right_height);
+    if (rc != 0) {
+        multimap_free_subtree(left);
+        multimap_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = item->value_count + multimap_weight(left)
+                   + multimap_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the multi-map to a file descriptor. The snapshot
+ * consists of a header, which holds the key size, the value size, and the
+ * amount of distinct keys, followed by the value count, the key, and the values
+ * of each distinct key in sorted order. Since the keys and values are copied
+ * byte for byte, they should not contain pointers unless the snapshot is loaded
+ * by the same process.
+ *
+ * @param me the multi-map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int multimap_save(multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *first = me->root;
+    struct node *traverse;
+    unsigned long node_count = 0;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    if (first) {
+        while (first->left) {
+            first = first->left;
+        }
+    }
+    for (traverse = first; traverse; traverse = multimap_next_node(traverse)) {
+        node_count++;
+    }
+    header.count = node_count;
+    multimap_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    traverse = first;
+    while (stream.rc == 0 && traverse) {
+        const unsigned long value_count = (unsigned long) traverse->value_count;
+        multimap_stream_write(&stream, &value_count, sizeof(unsigned long));
+        multimap_stream_write(&stream, traverse->key, me->key_size);
+        multimap_stream_write(&stream, traverse->values,
+                              traverse->value_count * me->value_size);
+        traverse = multimap_next_node(traverse);
+    }
+    multimap_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by multimap_save into an empty
+ * multi-map. Since the snapshot is sorted, the balanced tree is built directly
+ * from it in linear time without calling the comparator functions. Thus, the
+ * multi-map must have been initialized with the same key size, value size, and
+ * key comparator function as the multi-map which was saved. If an error
+ * occurs, the multi-map is left empty. When the file descriptor is seekable, it
+ * is left positioned right after the snapshot.
+ *
+ * @param me the multi-map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-map is not empty or the snapshot does not
+ *                 match the multi-map
+ * @return -EIO    if the snapshot could not be read
+ */
+int multimap_load(multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer =
+            malloc(SNAPSHOT_BUFFER_SIZE + me->key_size + me->value_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    multimap_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != (unsigned long) me->value_size
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = multimap_load_subtree(me, &stream, header.count, &me->root,
+                                   &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the key-value pairs from the multi-map.
+ *
+ * @param me the multi-map to clear
+ */
+void multimap_clear(multimap me)
+{
+    while (me->root) {
+        multimap_remove_all_element(me, me->root);
+    }
+}
+
+/**
+ * Frees the multi-map memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the multi-map to free from memory
+ *
+ * @return NULL
+ */
+multimap multimap_destroy(multimap me)
+{
+    multimap_clear(me);
+    free(me);
+    return NULL;
+}
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef node
+#undef snapshot_header
+#undef snapshot_stream
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_BUFFER_SIZE multiset_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC multiset_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION multiset_SNAPSHOT_VERSION
+#define merge_entry multiset_merge_entry
+#define node multiset_node
+#define snapshot_header multiset_snapshot_header
+#define snapshot_stream multiset_snapshot_stream
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_multiset {
+    size_t key_size;
+    int (*comparator)(const void *const one, const void *const two);
+    int size;
+    struct node *root;
+};
+
+struct node {
+    int count;
+    struct node *parent;
+    int balance;
+    int weight;
+    void *key;
+    struct node *left;
+    struct node *right;
+};
+
+/*
+ * A key along with its amount of occurrences, used when combining multi-sets.
+ */
+struct merge_entry {
+    const void *key;
+    int count;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is the count followed by the key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
+/**
+ * Initializes a multi-set.
+ *
+ * @param key_size   the size of each element in the multi-set; must be
+ *                   positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized multi-set, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+multiset multiset_init(const size_t key_size,
+                       int (*const comparator)(const void *const,
+                                               const void *const))
+{
+    struct internal_multiset *init;
+    if (key_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_multiset));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->comparator = comparator;
+    init->size = 0;
+    init->root = NULL;
+    return init;
+}
+
+/**
+ * Gets the size of the multi-set.
+ *
+ * @param me the multi-set to check
+ *
+ * @return the size of the multi-set
+ */
+int multiset_size(multiset me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the multi-set is empty.
+ *
+ * @param me the multi-set to check
+ *
+ * @return 1 if the multi-set is empty, otherwise 0
+ */
+int multiset_is_empty(multiset me)
+{
+    return multiset_size(me) == 0;
+}
+
+/*
+ * Resets the parent reference.
+ */
+static void multiset_reference_parent(multiset me,
+                                      struct node *const parent,
+                                      struct node *const child)
+{
+    child->parent = parent->parent;
+    if (!parent->parent) {
+        me->root = child;
+    } else if (parent->parent->left == parent) {
+        parent->parent->left = child;
+    } else {
+        parent->parent->right = child;
+    }
+}
+
+/*
+ * Gets the weight of a subtree, which is the amount of elements in it.
+ */
+static int multiset_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void multiset_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
+/*
+ * Rotates the AVL tree to the left.
+ */
+static void multiset_rotate_left(multiset me,
+                                 struct node *const parent,
+                                 struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    multiset_reference_parent(me, parent, child);
+    grand_child = child->left;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->right = grand_child;
+    child->left = parent;
+    parent->weight += multiset_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Rotates the AVL tree to the right.
+ */
+static void multiset_rotate_right(multiset me,
+                                  struct node *const parent,
+                                  struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    multiset_reference_parent(me, parent, child);
+    grand_child = child->right;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->left = grand_child;
+    child->right = parent;
+    parent->weight += multiset_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Performs a left repair.
+ */
+static struct node *multiset_repair_left(multiset me,
+                                         struct node *const parent,
+                                         struct node *const child)
+{
+    multiset_rotate_left(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = 1;
+        child->balance = -1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a right repair.
+ */
+static struct node *multiset_repair_right(multiset me,
+                                          struct node *const parent,
+                                          struct node *const child)
+{
+    multiset_rotate_right(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = -1;
+        child->balance = 1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a left-right repair.
+ */
+static struct node *multiset_repair_left_right(multiset me,
+                                               struct node *const parent,
+                                               struct node *const child,
+                                               struct node *const grand_child)
+{
+    multiset_rotate_left(me, child, grand_child);
+    multiset_rotate_right(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = 0;
+        child->balance = -1;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 1;
+        child->balance = 0;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Performs a right-left repair.
+ */
+static struct node *multiset_repair_right_left(multiset me,
+                                               struct node *const parent,
+                                               struct node *const child,
+                                               struct node *const grand_child)
+{
+    multiset_rotate_right(me, child, grand_child);
+    multiset_rotate_left(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = -1;
+        child->balance = 0;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 0;
+        child->balance = 1;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Repairs the AVL tree on insert. The only possible values of parent->balance
+ * are {-2, 2} and the only possible values of child->balance are {-1, 0, 1}.
+ */
+static struct node *multiset_repair(multiset me,
+                                    struct node *const parent,
+                                    struct node *const child,
+                                    struct node *const grand_child)
+{
+    if (parent->balance == 2) {
+        if (child->balance == -1) {
+            return multiset_repair_right_left(me, parent, child, grand_child);
+        }
+        return multiset_repair_left(me, parent, child);
+    }
+    if (child->balance == 1) {
+        return multiset_repair_left_right(me, parent, child, grand_child);
+    }
+    return multiset_repair_right(me, parent, child);
+}
+
+/*
+ * Balances the AVL tree on insert.
+ */
+static void multiset_insert_balance(multiset me, struct node *const item)
+{
+    struct node *grand_child = NULL;
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance--;
+        } else {
+            parent->balance++;
+        }
+        /* If balance is zero after modification, then the tree is balanced. */
+        if (parent->balance == 0) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            /* After one repair, the tree is balanced. */
+            multiset_repair(me, parent, child, grand_child);
+            return;
+        }
+        grand_child = child;
+        child = parent;
+        parent = parent->parent;
+    }
+}
+
+/*
+ * Creates and allocates a node.
+ */
+static struct node *multiset_create_node(multiset me,
+                                         const void *const data,
+                                         struct node *const parent)
+{
+    struct node *const insert = malloc(sizeof(struct node));
+    if (!insert) {
+        return NULL;
+    }
+    insert->count = 1;
+    insert->parent = parent;
+    insert->balance = 0;
+    insert->weight = 1;
+    insert->key = malloc(me->key_size);
+    if (!insert->key) {
+        free(insert);
+        return NULL;
+    }
+    memcpy(insert->key, data, me->key_size);
+    insert->left = NULL;
+    insert->right = NULL;
+    me->size++;
+    return insert;
+}
+
+/*
+ * Compares two keys.
+ */
+static int multiset_compare(multiset me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/**
+ * Adds a key to the multi-set. The pointer to the key being passed in should
+ * point to the key type which this multi-set holds. For example, if this
+ * multi-set holds key integers, the key pointer should be a pointer to an
+ * integer. Since the key is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me  the multi-set to add to
+ * @param key the key to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int multiset_put(multiset me, void *const key)
+{
+    struct node *traverse;
+    if (!me->root) {
+        struct node *insert = multiset_create_node(me, key, NULL);
+        if (!insert) {
+            return -ENOMEM;
+        }
+        me->root = insert;
+        return 0;
+    }
+    traverse = me->root;
+    for (;;) {
+        const int compare = multiset_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                struct node *insert = multiset_create_node(me, key, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->left = insert;
+                multiset_add_weight(traverse, 1);
+                multiset_insert_balance(me, insert);
+                return 0;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                struct node *insert = multiset_create_node(me, key, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->right = insert;
+                multiset_add_weight(traverse, 1);
+                multiset_insert_balance(me, insert);
+                return 0;
+            }
+        } else {
+            traverse->count++;
+            multiset_add_weight(traverse, 1);
+            me->size++;
+            return 0;
+        }
+    }
+}
+
+/*
+ * If a match occurs, returns the match. Else, returns NULL.
+ */
+static struct node *multiset_equal_match(multiset me, const void *const key)
+{
+    struct node *traverse = me->root;
+    if (!traverse) {
+        return 0;
+    }
+    for (;;) {
+        const int compare = multiset_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                return NULL;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                return NULL;
+            }
+        } else {
+            return traverse;
+        }
+    }
+}
+
+/**
+ * Determines the count of a specific key in the multi-set. The pointer to the
+ * key being passed in should point to the key type which this multi-set holds.
+ * For example, if this multi-set holds key integers, the key pointer should be
+ * a pointer to an integer. Since the key is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me  the multi-set to check for the count
+ * @param key the key to check
+ *
+ * @return the count of a specific key in the multi-set
+ */
+int multiset_count(multiset me, void *const key)
+{
+    const struct node *const item = multiset_equal_match(me, key);
+    if (!item) {
+        return 0;
+    }
+    return item->count;
+}
+
+/**
+ * Determines if the multi-set contains the specified key. The pointer to the
+ * key being passed in should point to the key type which this multi-set holds.
+ * For example, if this multi-set holds key integers, the key pointer should be
+ * a pointer to an integer. Since the key is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me  the multi-set to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the multiset contained the key, otherwise 0
+ */
+int multiset_contains(multiset me, void *const key)
+{
+    return multiset_equal_match(me, key) != NULL;
+}
+
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of elements in its subtree. The pointer to the key
+ * being passed in should point to the key type which this multi-set holds.
+ *
+ * @param me  the multi-set to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of keys in the multi-set which are less than the key,
+ *         counting each occurrence separately
+ */
+int multiset_rank(multiset me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (multiset_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - multiset_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key at the specified index in sorted order, where each occurrence
+ * of a key has its own index, so that index zero is the smallest key. This
+ * takes logarithmic time, since each node keeps track of the amount of
+ * occurrences in its subtree.
+ *
+ * @param key   the key to copy to
+ * @param me    the multi-set to get the key from
+ * @param index the index of the key in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int multiset_select(void *const key, multiset me, const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = multiset_weight(item->left);
+        const int own = item->weight - left - multiset_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    memcpy(key, item->key, me->key_size);
+    return 0;
+}
+
+/*
+ * Repairs the AVL tree by pivoting on an item.
+ */
+static struct node *multiset_repair_pivot(multiset me,
+                                          struct node *const item,
+                                          const int is_left_pivot)
+{
+    struct node *const child = is_left_pivot ? item->right : item->left;
+    struct node *const grand_child =
+            child->balance == 1 ? child->right : child->left;
+    return multiset_repair(me, item, child, grand_child);
+}
+
+/*
+ * Goes back up the tree repairing it along the way.
+ */
+static void multiset_trace_ancestors(multiset me, struct node *item)
+{
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance++;
+        } else {
+            parent->balance--;
+        }
+        /* The tree is balanced if balance is -1 or +1 after modification. */
+        if (parent->balance == -1 || parent->balance == 1) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            child = multiset_repair_pivot(me, parent, parent->left == child);
+            parent = child->parent;
+            /* If balance is -1 or +1 after modification or the parent is */
+            /* NULL, then the tree is balanced. */
+            if (!parent || child->balance == -1 || child->balance == 1) {
+                return;
+            }
+        } else {
+            child = parent;
+            parent = parent->parent;
+        }
+    }
+}
+
+/*
+ * Balances the AVL tree on deletion.
+ */
+static void multiset_delete_balance(multiset me,
+                                    struct node *item,
+                                    const int is_left_deleted)
+{
+    if (is_left_deleted) {
+        item->balance++;
+    } else {
+        item->balance--;
+    }
+    /* If balance is -1 or +1 after modification, then the tree is balanced. */
+    if (item->balance == -1 || item->balance == 1) {
+        return;
+    }
+    /* Must re-balance if not in {-1, 0, 1} */
+    if (item->balance > 1 || item->balance < -1) {
+        item = multiset_repair_pivot(me, item, is_left_deleted);
+        if (!item->parent || item->balance == -1 || item->balance == 1) {
+            return;
+        }
+    }
+    multiset_trace_ancestors(me, item);
+}
+
+/*
+ * Removes traverse when it has no children.
+ */
+static void multiset_remove_no_children(multiset me,
+                                        const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent and no children, then the only node is traverse. */
+    if (!parent) {
+        me->root = NULL;
+        return;
+    }
+    /* No re-reference needed since traverse has no children. */
+    if (parent->left == traverse) {
+        parent->left = NULL;
+        multiset_delete_balance(me, parent, 1);
+    } else {
+        parent->right = NULL;
+        multiset_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has one child.
+ */
+static void multiset_remove_one_child(multiset me,
+                                      const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent, make the child of traverse the new root. */
+    if (!parent) {
+        if (traverse->left) {
+            traverse->left->parent = NULL;
+            me->root = traverse->left;
+        } else {
+            traverse->right->parent = NULL;
+            me->root = traverse->right;
+        }
+        return;
+    }
+    /* The parent of traverse now references the child of traverse. */
+    if (parent->left == traverse) {
+        if (traverse->left) {
+            parent->left = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->left = traverse->right;
+            traverse->right->parent = parent;
+        }
+        multiset_delete_balance(me, parent, 1);
+    } else {
+        if (traverse->left) {
+            parent->right = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->right = traverse->right;
+            traverse->right->parent = parent;
+        }
+        multiset_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has two children.
+ */
+static void multiset_remove_two_children(multiset me,
+                                         const struct node *const traverse)
+{
+    struct node *item;
+    struct node *parent;
+    const int is_left_deleted = traverse->right->left != NULL;
+    if (!is_left_deleted) {
+        item = traverse->right;
+        parent = item;
+        item->balance = traverse->balance;
+        item->parent = traverse->parent;
+        item->left = traverse->left;
+        item->left->parent = item;
+    } else {
+        item = traverse->right->left;
+        while (item->left) {
+            item = item->left;
+        }
+        parent = item->parent;
+        item->balance = traverse->balance;
+        item->parent->left = item->right;
+        if (item->right) {
+            item->right->parent = item->parent;
+        }
+        item->left = traverse->left;
+        item->left->parent = item;
+        item->right = traverse->right;
+        item->right->parent = item;
+        item->parent = traverse->parent;
+    }
+    if (!traverse->parent) {
+        me->root = item;
+    } else if (traverse->parent->left == traverse) {
+        item->parent->left = item;
+    } else {
+        item->parent->right = item;
+    }
+    multiset_delete_balance(me, parent, is_left_deleted);
+}
+
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void multiset_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - multiset_weight(traverse->left)
+                    - multiset_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    multiset_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - multiset_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
+/*
+ * Removes the element from the set.
+ */
+static void multiset_remove_element(multiset me, struct node *const traverse)
+{
+    multiset_remove_weight(traverse);
+    if (!traverse->left && !traverse->right) {
+        multiset_remove_no_children(me, traverse);
+    } else if (!traverse->left || !traverse->right) {
+        multiset_remove_one_child(me, traverse);
+    } else {
+        multiset_remove_two_children(me, traverse);
+    }
+    free(traverse->key);
+    free(traverse);
+}
+
+/**
+ * Removes a key from the multi-set if it contains it. The pointer to the key
+ * being passed in should point to the key type which this multi-set holds. For
+ * example, if this multi-set holds key integers, the key pointer should be a
+ * pointer to an integer. Since the key is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me  the multi-set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the multi-set contained the key, otherwise 0
+ */
+int multiset_remove(multiset me, void *const key)
+{
+    struct node *const traverse = multiset_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    traverse->count--;
+    multiset_add_weight(traverse, -1);
+    if (traverse->count == 0) {
+        multiset_remove_element(me, traverse);
+    }
+    me->size--;
+    return 1;
+}
+
+/**
+ * Removes all the occurrences of a specified key in the multi-set. The pointer
+ * to the key being passed in should point to the key type which this multi-set
+ * holds. For example, if this multi-set holds key integers, the key pointer
+ * should be a pointer to an integer. Since the key is being copied, the pointer
+ * only has to be valid when this function is called.
+ *
+ * @param me  the multi-set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the multi-set contained the key, otherwise 0
+ */
+int multiset_remove_all(multiset me, void *const key)
+{
+    struct node *const traverse = multiset_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    me->size -= traverse->count;
+    multiset_remove_element(me, traverse);
+    return 1;
+}
+
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *multiset_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was only partially built.
+ */
+static void multiset_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    multiset_free_subtree(item->left);
+    multiset_free_subtree(item->right);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Gets the node with the smallest key in the subtree.
+ */
+static struct node *multiset_first_node(struct node *item)
+{
+    if (item) {
+        while (item->left) {
+            item = item->left;
+        }
+    }
+    return item;
+}
+
+/*
+ * Builds a balanced subtree from the sorted entries. The middle entry is the
+ * root of the subtree, and the entries before and after it form the left and
+ * right subtrees.
+ */
+static int multiset_build_subtree(multiset me,
+                                  const struct merge_entry *const entries,
+                                  const int count,
+                                  struct node **const subtree,
+                                  int *const height)
+{
+    const int left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = multiset_build_subtree(me, entries, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    item = multiset_create_node(me, entries[left_count].key, NULL);
+    if (!item) {
+        multiset_free_subtree(left);
+        return -ENOMEM;
+    }
+    item->count = entries[left_count].count;
+    me->size += item->count - 1;
+    rc = multiset_build_subtree(me, entries + left_count + 1,
+                                count - 1 - left_count, &right, &right_height);
+    if (rc != 0) {
+        multiset_free_subtree(left);
+        multiset_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = item->count + multiset_weight(left) + multiset_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+/*
+ * The amount of occurrences of a key in the union of two multi-sets.
+ */
+static int multiset_union_count(const int one, const int two)
+{
+    return one > two ? one : two;
+}
+
+/*
+ * The amount of occurrences of a key in the intersection of two multi-sets.
+ */
+static int multiset_intersection_count(const int one, const int two)
+{
+    return one < two ? one : two;
+}
+
+/*
+ * The amount of occurrences of a key in the difference of two multi-sets.
+ */
+static int multiset_difference_count(const int one, const int two)
+{
+    return one - two;
+}
+
+/*
+ * Merges the keys of two multi-sets in sorted order into an empty multi-set.
+ * The merge function gets the amount of occurrences of a key in each of the
+ * multi-sets, which is zero if it is not in it, and returns the amount of
+ * occurrences in the result. The key is left out if it is not positive.
+ */
+static int multiset_combine(multiset me,
+                            multiset one,
+                            multiset two,
+                            int (*const merge)(const int, const int))
+{
+    struct node *first = multiset_first_node(one->root);
+    struct node *second = multiset_first_node(two->root);
+    struct merge_entry *entries;
+    int count = 0;
+    int height;
+    int rc;
+    if (me->root || me->key_size != one->key_size
+        || me->key_size != two->key_size) {
+        return -EINVAL;
+    }
+    if (one->size + two->size == 0) {
+        return 0;
+    }
+    entries = malloc((one->size + two->size) * sizeof(struct merge_entry));
+    if (!entries) {
+        return -ENOMEM;
+    }
+    while (first || second) {
+        int compare;
+        if (!first) {
+            compare = 1;
+        } else if (!second) {
+            compare = -1;
+        } else {
+            compare = multiset_compare(one, first->key, second->key);
+        }
+        if (compare < 0) {
+            entries[count].key = first->key;
+            entries[count].count = merge(first->count, 0);
+            first = multiset_next_node(first);
+        } else if (compare > 0) {
+            entries[count].key = second->key;
+            entries[count].count = merge(0, second->count);
+            second = multiset_next_node(second);
+        } else {
+            entries[count].key = first->key;
+            entries[count].count = merge(first->count, second->count);
+            first = multiset_next_node(first);
+            second = multiset_next_node(second);
+        }
+        if (entries[count].count > 0) {
+            count++;
+        }
+    }
+    rc = multiset_build_subtree(me, entries, count, &me->root, &height);
+    if (rc != 0) {
+        me->size = 0;
+    }
+    free(entries);
+    return rc;
+}
+
+/**
+ * Stores the union of two multi-sets in an empty multi-set, which is every key
+ * that is in either of the multi-sets, occurring as many times as it occurs in
+ * the multi-set which has more of it. Since both multi-sets are traversed in
+ * sorted order at the same time, and the balanced tree is built directly from
+ * the result, this takes linear time. The multi-sets must all have the same
+ * key size and comparator function. If an error occurs, the multi-set is left
+ * empty.
+ *
+ * @param me  the empty multi-set to store the union in
+ * @param one the first multi-set
+ * @param two the second multi-set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the key sizes do not match
+ */
+int multiset_union(multiset me, multiset one, multiset two)
+{
+    return multiset_combine(me, one, two, multiset_union_count);
+}
+
+/**
+ * Stores the intersection of two multi-sets in an empty multi-set, which is
+ * every key that is in both of the multi-sets, occurring as many times as it
+ * occurs in the multi-set which has less of it. This takes linear time. The
+ * multi-sets must all have the same key size and comparator function. If an
+ * error occurs, the multi-set is left empty.
+ *
+ * @param me  the empty multi-set to store the intersection in
+ * @param one the first multi-set
+ * @param two the second multi-set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the key sizes do not match
+ */
+int multiset_intersection(multiset me, multiset one, multiset two)
+{
+    return multiset_combine(me, one, two, multiset_intersection_count);
+}
+
+/**
+ * Stores the difference of two multi-sets in an empty multi-set, which is every
+ * key of the first multi-set, occurring as many times as it occurs in the first
+ * multi-set minus the times it occurs in the second multi-set. This takes
+ * linear time. The multi-sets must all have the same key size and comparator
+ * function. If an error occurs, the multi-set is left empty.
+ *
+ * @param me  the empty multi-set to store the difference in
+ * @param one the multi-set to take the keys from
+ * @param two the multi-set of keys to take away
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the key sizes do not match
+ */
+int multiset_difference(multiset me, multiset one, multiset two)
+{
+    return multiset_combine(me, one, two, multiset_difference_count);
+}
+
+/**
+ * Determines if every key of the multi-set occurs at least as many times in the
+ * other multi-set. This takes linear time, since both multi-sets are traversed
+ * in sorted order at the same time. The multi-sets must have the same
+ * comparator function.
+ *
+ * @param me    the multi-set which may be a subset
+ * @param other the multi-set which may contain it
+ *
+ * @return 1 if the multi-set is a subset of the other multi-set, otherwise 0
+ */
+int multiset_is_subset(multiset me, multiset other)
+{
+    struct node *first = multiset_first_node(me->root);
+    struct node *second = multiset_first_node(other->root);
+    if (me->size > other->size) {
+        return 0;
+    }
+    while (first) {
+        int compare;
+        if (!second) {
+            return 0;
+        }
+        compare = multiset_compare(me, first->key, second->key);
+        if (compare < 0) {
+            return 0;
+        }
+        if (compare == 0) {
+            if (first->count > second->count) {
+                return 0;
+            }
+            first = multiset_next_node(first);
+        }
+        second = multiset_next_node(second);
+    }
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void multiset_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void multiset_stream_write(struct snapshot_stream *const stream,
+                                  const void *const data,
+                                  const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            multiset_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void multiset_stream_read(struct snapshot_stream *const stream,
+                                 void *const data,
+                                 const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int multiset_load_subtree(multiset me,
+                                 struct snapshot_stream *const stream,
+                                 const unsigned long count,
+                                 struct node **const subtree,
+                                 int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    unsigned long key_count;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = multiset_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    multiset_stream_read(stream, &key_count, sizeof(unsigned long));
+    multiset_stream_read(stream, stream->record, me->key_size);
+    if (stream->rc != 0) {
+        multiset_free_subtree(left);
+        return stream->rc;
+    }
+    if (key_count == 0 || key_count > (unsigned long) (INT_MAX - me->size)) {
+        multiset_free_subtree(left);
+        return -EINVAL;
+    }
+    item = multiset_create_node(me, stream->record, NULL);
+    if (!item) {
+        multiset_free_subtree(left);
+        return -ENOMEM;
+    }
+    item->count = (int) key_count;
+    me->size += item->count - 1;
+    rc = multiset_load_subtree(me, stream, count - 1 - left_count, &right,
+                               &right_height);
+    if (rc != 0) {
+        multiset_free_subtree(left);
+        multiset_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = item->count + multiset_weight(left) + multiset_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the multi-set to a file descriptor. The snapshot
+ * consists of a header, which holds the key size and the amount of distinct
+ * keys, followed by the count and the key of each distinct key in sorted order.
+ * Since the keys are copied byte for byte, they should not contain pointers
+ * unless the snapshot is loaded by the same process.
+ *
+ * @param me the multi-set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int multiset_save(multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *first = me->root;
+    struct node *traverse;
+    unsigned long node_count = 0;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    if (first) {
+        while (first->left) {
+            first = first->left;
+        }
+    }
+    for (traverse = first; traverse; traverse = multiset_next_node(traverse)) {
+        node_count++;
+    }
+    header.count = node_count;
+    multiset_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    traverse = first;
+    while (stream.rc == 0 && traverse) {
+        const unsigned long key_count = (unsigned long) traverse->count;
+        multiset_stream_write(&stream, &key_count, sizeof(unsigned long));
+        multiset_stream_write(&stream, traverse->key, me->key_size);
+        traverse = multiset_next_node(traverse);
+    }
+    multiset_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by multiset_save into an empty
+ * multi-set. Since the snapshot is sorted, the balanced tree is built directly
+ * from it in linear time without calling the comparator function. Thus, the
+ * multi-set must have been initialized with the same key size and comparator
+ * function as the multi-set which was saved. If an error occurs, the multi-set
+ * is left empty. When the file descriptor is seekable, it is left positioned
+ * right after the snapshot.
+ *
+ * @param me the multi-set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the snapshot does not
+ *                 match the multi-set
+ * @return -EIO    if the snapshot could not be read
+ */
+int multiset_load(multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE + me->key_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    multiset_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != 0
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = multiset_load_subtree(me, &stream, header.count, &me->root,
+                                   &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the keys from the multiset.
+ *
+ * @param me the multi-set to clear
+ */
+void multiset_clear(multiset me)
+{
+    while (me->root) {
+        multiset_remove_element(me, me->root);
+    }
+    me->size = 0;
+}
+
+/**
+ * Frees the multi-set memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the multi-set to free from memory
+ *
+ * @return NULL
+ */
+multiset multiset_destroy(multiset me)
+{
+    multiset_clear(me);
+    free(me);
+    return NULL;
+}
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef merge_entry
+#undef node
+#undef snapshot_header
+#undef snapshot_stream
+
+
+#include <string.h>
+#include <errno.h>
+
+struct internal_priority_queue {
+    vector data;
+    size_t data_size;
+    int (*comparator)(const void *const one, const void *const two);
+};
+
+/**
+ * Initializes a priority queue.
+ *
+ * @param data_size  the size of the data in the priority queue; must be
+ *                   positive
+ * @param comparator the priority comparator function; must not be NULL
+ *
+ * @return the newly-initialized priority queue, or NULL if it was not
+ *         successfully initialized due to either invalid input arguments or
+ *         memory allocation error
+ */
+priority_queue priority_queue_init(const size_t data_size,
+                                   int (*comparator)(const void *const,
+                                                     const void *const))
+{
+    struct internal_priority_queue *init;
+    if (data_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_priority_queue));
+    if (!init) {
+        return NULL;
+    }
+    init->data_size = data_size;
+    init->data = vector_init(data_size);
+    if (!init->data) {
+        free(init);
+        return NULL;
+    }
+    init->comparator = comparator;
+    return init;
+}
+
+/*
+ * Compares the priority of two elements.
+ */
+static int priority_queue_compare(priority_queue me,
+                                  const void *const one,
+                                  const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->data_size, one, two);
+}
+
+/**
+ * Gets the size of the priority queue.
+ *
+ * @param me the priority queue to check
+ *
+ * @return the size of the priority queue
+ */
+int priority_queue_size(priority_queue me)
+{
+    return vector_size(me->data);
+}
+
+/**
+ * Determines whether or not the priority queue is empty.
+ *
+ * @param me the priority queue to check
+ *
+ * @return 1 if the priority queue is empty, otherwise 0
+ */
+int priority_queue_is_empty(priority_queue me)
+{
+    return vector_is_empty(me->data);
+}
+
+/**
+ * Adds an element to the priority queue. The pointer to the data being passed
+ * in should point to the data type which this priority queue holds. For
+ * example, if this priority queue holds integers, the data pointer should be a
+ * pointer to an integer. Since the data is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me   the priority queue to add an element to
+ * @param data the data to add to the queue
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int priority_queue_push(priority_queue me, void *const data)
+{
+    int rc;
+    void *vector_storage;
+    int index;
+    int parent_index;
+    void *data_index;
+    void *data_parent_index;
+    void *const temp = malloc(me->data_size);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    rc = vector_add_last(me->data, data);
+    if (rc != 0) {
+        free(temp);
+        return rc;
+    }
+    vector_storage = vector_get_data(me->data);
+    index = vector_size(me->data) - 1;
+    parent_index = (index - 1) / 2;
+    data_index = (char *) vector_storage + index * me->data_size;
+    data_parent_index = (char *) vector_storage + parent_index * me->data_size;
+    while (index > 0
+           && priority_queue_compare(me, data_index, data_parent_index) > 0) {
+        memcpy(temp, data_parent_index, me->data_size);
+        memcpy(data_parent_index, data_index, me->data_size);
+        memcpy(data_index, temp, me->data_size);
+        index = parent_index;
+        parent_index = (index - 1) / 2;
+        data_index = (char *) vector_storage + index * me->data_size;
+        data_parent_index =
+                (char *) vector_storage + parent_index * me->data_size;
+    }
+    free(temp);
+    return 0;
+}
+
+/**
+ * Removes the highest priority element from the priority queue. The pointer to
+ * the data being obtained should point to the data type which this priority
+ * queue holds. For example, if this priority queue holds integers, the data
+ * pointer should be a pointer to an integer. Since this data is being copied
+ * from the array to the data pointer, the pointer only has to be valid when
+ * this function is called.
+ *
+ * @param data the data to have copied from the priority queue
+ * @param me   the priority queue to pop the next element from
+ *
+ * @return 1 if the priority queue contained elements, otherwise 0
+ */
+int priority_queue_pop(void *const data, priority_queue me)
+{
+    void *vector_storage;
+    int size;
+    void *temp;
+    int index;
+    int left_index;
+    int right_index;
+    void *data_index;
+    void *data_left_index;
+    void *data_right_index;
+    const int rc = vector_get_first(data, me->data);
+    if (rc != 0) {
+        return 0;
+    }
+    vector_storage = vector_get_data(me->data);
+    size = vector_size(me->data) - 1;
+    temp = (char *) vector_storage + size * me->data_size;
+    memcpy(vector_storage, temp, me->data_size);
+    left_index = 1;
+    right_index = 2;
+    data_index = vector_storage;
+    data_left_index = (char *) vector_storage + left_index * me->data_size;
+    data_right_index = (char *) vector_storage + right_index * me->data_size;
+    for (;;) {
+        if (right_index < size &&
+            priority_queue_compare(me, data_right_index, data_left_index) > 0 &&
+            priority_queue_compare(me, data_right_index, data_index) > 0) {
+            /* Swap parent and right child then continue down right child. */
+            memcpy(temp, data_index, me->data_size);
+            memcpy(data_index, data_right_index, me->data_size);
+            memcpy(data_right_index, temp, me->data_size);
+            index = right_index;
+        } else if (left_index < size
+                   && priority_queue_compare(me, data_left_index,
+                                             data_index) > 0) {
+            /* Swap parent and left child then continue down left child. */
+            memcpy(temp, data_index, me->data_size);
+            memcpy(data_index, data_left_index, me->data_size);
+            memcpy(data_left_index, temp, me->data_size);
+            index = left_index;
+        } else {
+            break;
+        }
+        left_index = 2 * index + 1;
+        right_index = 2 * index + 2;
+        data_index = (char *) vector_storage + index * me->data_size;
+        data_left_index = (char *) vector_storage + left_index * me->data_size;
+        data_right_index =
+                (char *) vector_storage + right_index * me->data_size;
+    }
+    vector_remove_last(me->data);
+    return 1;
+}
+
+/**
+ * Gets the highest priority element in the priority queue. The pointer to the
+ * data being obtained should point to the data type which this priority queue
+ * holds. For example, if this priority queue holds integers, the data pointer
+ * should be a pointer to an integer. Since this data is being copied from the
+ * array to the data pointer, the pointer only has to be valid when this
+ * function is called.
+ *
+ * @param data the out copy of the highest priority element in the priority
+ *             queue
+ * @param me   the priority queue to copy from
+ *
+ * @return 1 if the priority queue contained elements, otherwise 0
+ */
+int priority_queue_front(void *const data, priority_queue me)
+{
+    return vector_get_first(data, me->data) == 0;
+}
+
+/**
+ * Clears the elements from the priority queue.
+ *
+ * @param me the priority queue to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int priority_queue_clear(priority_queue me)
+{
+    return vector_clear(me->data);
+}
+
+/**
+ * Frees the priority queue memory. Performing further operations after calling
+ * this function results in undefined behavior.
+ *
+ * @param me the priority queue to free from memory
+ *
+ * @return NULL
+ */
+priority_queue priority_queue_destroy(priority_queue me)
+{
+    vector_destroy(me->data);
+    free(me);
+    return NULL;
+}
+
+
+
+#define TRIM_RATIO queue_TRIM_RATIO
+static const double TRIM_RATIO = 1.5;
+
+struct internal_queue {
+    int trim_count;
+    deque deque_data;
+};
+
+/**
+ * Initializes a queue.
+ *
+ * @param data_size the size of each element; must be positive
+ *
+ * @return the newly-initialized queue, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+queue queue_init(const size_t data_size)
+{
+    struct internal_queue *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_queue));
+    if (!init) {
+        return NULL;
+    }
+    init->trim_count = 0;
+    init->deque_data = deque_init(data_size);
+    if (!init->deque_data) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Determines the size of the queue.
+ *
+ * @param me the queue to get size of
+ *
+ * @return the queue size
+ */
+int queue_size(queue me)
+{
+    return deque_size(me->deque_data);
+}
+
+/**
+ * Determines if the queue is empty. The queue is empty if it contains no
+ * elements.
+ *
+ * @param me the queue to check if empty
+ *
+ * @return 1 if the queue is empty, otherwise 0
+ */
+int queue_is_empty(queue me)
+{
+    return deque_is_empty(me->deque_data);
+}
+
+/**
+ * Frees the unused memory in the queue.
+ *
+ * @param me the queue to trim
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int queue_trim(queue me)
+{
+    return deque_trim(me->deque_data);
+}
+
+/**
+ * Copies the queue to an array. Since it is a copy, the array may be modified
+ * without causing side effects to the queue data structure. Memory is not
+ * allocated, thus the array being used for the copy must be allocated before
+ * this function is called.
+ *
+ * @param arr the initialized array to copy the queue to
+ * @param me  the queue to copy to the array
+ */
+void queue_copy_to_array(void *const arr, queue me)
+{
+    deque_copy_to_array(arr, me->deque_data);
+}
+
+/**
+ * Adds an element to the queue. The pointer to the data being passed in should
+ * point to the data type which this queue holds. For example, if this queue
+ * holds integers, the data pointer should be a pointer to an integer. Since the
+ * data is being copied, the pointer only has to be valid when this function is
+ * called.
+ *
+ * @param me   the queue to add an element to
+ * @param data the data to add to the queue
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int queue_push(queue me, void *const data)
+{
+    return deque_push_back(me->deque_data, data);
+}
+
+/**
+ * Removes the next element in the queue and copies the data. The pointer to the
+ * data being obtained should point to the data type which this queue holds. For
+ * example, if this queue holds integers, the data pointer should be a pointer
+ * to an integer. Since this data is being copied from the array to the data
+ * pointer, the pointer only has to be valid when this function is called.
+ *
+ * @param data the data to have copied from the queue
+ * @param me   the queue to pop the next element from
+ *
+ * @return 1 if the queue contained elements, otherwise 0
+ */
+int queue_pop(void *const data, queue me)
+{
+    me->trim_count++;
+    if (TRIM_RATIO * me->trim_count >= queue_size(me)) {
+        deque_trim(me->deque_data);
+        me->trim_count = 0;
+    }
+    return deque_pop_front(data, me->deque_data) == 0;
+}
+
+/**
+ * Gets the front element of the queue. The pointer to the data being obtained
+ * should point to the data type which this queue holds. For example, if this
+ * queue holds integers, the data pointer should be a pointer to an integer.
+ * Since this data is being copied from the array to the data pointer, the
+ * pointer only has to be valid when this function is called.
+ *
+ * @param data the copy of the front element of the queue
+ * @param me   the queue to copy from
+ *
+ * @return 1 if the queue contained elements, otherwise 0
+ */
+int queue_front(void *const data, queue me)
+{
+    return deque_get_first(data, me->deque_data) == 0;
+}
+
+/**
+ * Gets the back element of the queue. The pointer to the data being obtained
+ * should point to the data type which this queue holds. For example, if this
+ * queue holds integers, the data pointer should be a pointer to an integer.
+ * Since this data is being copied from the array to the data pointer, the
+ * pointer only has to be valid when this function is called.
+ *
+ * @param data the copy of the back element of the queue
+ * @param me   the queue to copy from
+ *
+ * @return 1 if the queue contained elements, otherwise 0
+ */
+int queue_back(void *const data, queue me)
+{
+    return deque_get_last(data, me->deque_data) == 0;
+}
+
+/**
+ * Clears the queue and sets it to the original state from initialization.
+ *
+ * @param me the queue to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int queue_clear(queue me)
+{
+    return deque_clear(me->deque_data);
+}
+
+/**
+ * Destroys the queue. Performing further operations after calling this function
+ * results in undefined behavior.
+ *
+ * @param me the queue to destroy
+ *
+ * @return NULL
+ */
+queue queue_destroy(queue me)
+{
+    deque_destroy(me->deque_data);
+    free(me);
+    return NULL;
+}
+#undef TRIM_RATIO
+
+
+#include <string.h>
+#include <errno.h>
+
+#if defined(__GNUC__)
+#define CONTAINERS_HAS_PREFETCH
+#endif
+
+#define CACHE_LINE_SIZE search_CACHE_LINE_SIZE
+static const size_t CACHE_LINE_SIZE = 64;
+
+/*
+ * Compares two elements.
+ */
+static int containers_search_compare(int (*const comparator)(const void *,
+                                                             const void *),
+                                     const size_t size,
+                                     const void *const one,
+                                     const void *const two)
+{
+    return CONTAINERS_COMPARE(comparator, size, one, two);
+}
+
+/**
+ * Gets the index of the first element which is not less than the key in
+ * elements which are sorted in ascending order, which is the count if there is
+ * no such element. The search range is halved on every step whatever the
+ * outcome of the comparison, so the loop has no data-dependent branch, and the
+ * compiler can select the next base with a conditional move. This avoids the
+ * branch mispredictions of a classic binary search, and both of the elements
+ * which the next step may compare are prefetched, so that the memory latency of
+ * large searches overlaps with the current comparison.
+ *
+ * @param data       the sorted elements to search
+ * @param count      the amount of elements
+ * @param size       the size of each element
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the first element which is not less than the key
+ */
+int containers_lower_bound(void *const data,
+                           const int count,
+                           const size_t size,
+                           void *const key,
+                           int (*const comparator)(const void *const one,
+                                                   const void *const two))
+{
+    const char *const items = data;
+    int remaining = count;
+    int base = 0;
+    if (count <= 0) {
+        return 0;
+    }
+    while (remaining > 1) {
+        const int half = remaining / 2;
+        const char *const item = items + (base + half - 1) * size;
+#ifdef CONTAINERS_HAS_PREFETCH
+        __builtin_prefetch(items + (base + half / 2) * size);
+        __builtin_prefetch(items + (base + half + half / 2) * size);
+#endif
+        base = containers_search_compare(comparator, size, item, key) < 0
+               ? base + half : base;
+        remaining -= half;
+    }
+    return base + (containers_search_compare(comparator, size,
+                                             items + base * size, key) < 0);
+}
+
+/*
+ * Copies the sorted elements into their Eytzinger positions by an in-order
+ * walk of the implicit tree, in which the children of the element at index k
+ * are at 2k + 1 and 2k + 2.
+ */
+static void containers_eytzinger_fill(char *const out,
+                                      const char *const in,
+                                      const size_t size,
+                                      const unsigned long count,
+                                      const unsigned long k,
+                                      unsigned long *const index)
+{
+    if (k >= count) {
+        return;
+    }
+    containers_eytzinger_fill(out, in, size, count, 2 * k + 1, index);
+    memcpy(out + k * size, in + *index * size, size);
+    *index += 1;
+    containers_eytzinger_fill(out, in, size, count, 2 * k + 2, index);
+}
+
+/**
+ * Rearranges elements which are sorted in ascending order into Eytzinger order,
+ * which is the breadth-first order of a complete binary search tree stored
+ * implicitly, where the children of the element at index k are at 2k + 1 and
+ * 2k + 2. The first levels of the tree are then packed together at the start,
+ * so they stay in the cache, and the descendants which a search visits a few
+ * steps later are adjacent, so they can be prefetched. The elements are no
+ * longer sorted afterwards, and must be searched with
+ * containers_eytzinger_lower_bound.
+ *
+ * @param data  the sorted elements to rearrange
+ * @param count the amount of elements
+ * @param size  the size of each element
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int containers_eytzinger_layout(void *const data,
+                                const int count,
+                                const size_t size)
+{
+    unsigned long index = 0;
+    char *sorted;
+    if (count < 0) {
+        return -EINVAL;
+    }
+    if (count <= 1) {
+        return 0;
+    }
+    sorted = malloc(count * size);
+    if (!sorted) {
+        return -ENOMEM;
+    }
+    memcpy(sorted, data, count * size);
+    containers_eytzinger_fill(data, sorted, size, count, 0, &index);
+    free(sorted);
+    return 0;
+}
+
+/**
+ * Gets the index of the smallest element which is not less than the key in
+ * elements which are in Eytzinger order, which is the count if there is no such
+ * element. Each step goes to the left or right child without a data-dependent
+ * branch. The descendants a few levels down are adjacent, so while the current
+ * element is being compared, the cache line holding them is prefetched. The
+ * memory latency of the search is thus overlapped, which makes it much faster
+ * than binary search on tables far larger than the cache.
+ *
+ * @param data       the elements in Eytzinger order to search
+ * @param count      the amount of elements
+ * @param size       the size of each element
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the smallest element which is not less than the key
+ */
+int containers_eytzinger_lower_bound(void *const data,
+                                     const int count,
+                                     const size_t size,
+                                     void *const key,
+                                     int (*const comparator)
+                                         (const void *const one,
+                                          const void *const two))
+{
+    const char *const items = data;
+    unsigned long ahead = 2;
+    unsigned long k = 0;
+    if (count <= 0) {
+        return 0;
+    }
+    while (ahead * 2 * size <= CACHE_LINE_SIZE && ahead < 16) {
+        ahead *= 2;
+    }
+    while (k < (unsigned long) count) {
+#ifdef CONTAINERS_HAS_PREFETCH
+        if (k < count / ahead) {
+            const char *const first = items + (ahead * (k + 1) - 1) * size;
+            __builtin_prefetch(first);
+            __builtin_prefetch(first + (ahead - 1) * size);
+        }
+#endif
+        k = 2 * k + 1
+            + (containers_search_compare(comparator, size, items + k * size,
+                                         key) < 0);
+    }
+    /* The path ends with right turns after the last left turn to the answer. */
+    k++;
+    while (k & 1) {
+        k >>= 1;
+    }
+    k >>= 1;
+    if (k == 0) {
+        return count;
+    }
+    return (int) (k - 1);
+}
+#undef CACHE_LINE_SIZE
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_BUFFER_SIZE set_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC set_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION set_SNAPSHOT_VERSION
+#define node set_node
+#define snapshot_header set_snapshot_header
+#define snapshot_stream set_snapshot_stream
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_set {
+    size_t key_size;
+    int (*comparator)(const void *const one, const void *const two);
+    int size;
+    struct node *root;
+};
+
+struct node {
+    struct node *parent;
+    int balance;
+    int weight;
+    void *key;
+    struct node *left;
+    struct node *right;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is a key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
+/**
+ * Initializes a set.
+ *
+ * @param key_size   the size of each element in the set; must be positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized set, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+set set_init(const size_t key_size,
+             int (*const comparator)(const void *const, const void *const))
+{
+    struct internal_set *init;
+    if (key_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_set));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->comparator = comparator;
+    init->size = 0;
+    init->root = NULL;
+    return init;
+}
+
+/**
+ * Gets the size of the set.
+ *
+ * @param me the set to check
+ *
+ * @return the size of the set
+ */
+int set_size(set me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the set is empty.
+ *
+ * @param me the set to check
+ *
+ * @return 1 if the set is empty, otherwise 0
+ */
+int set_is_empty(set me)
+{
+    return set_size(me) == 0;
+}
+
+/*
+ * Resets the parent reference.
+ */
+static void set_reference_parent(set me,
+                                 struct node *const parent,
+                                 struct node *const child)
+{
+    child->parent = parent->parent;
+    if (!parent->parent) {
+        me->root = child;
+    } else if (parent->parent->left == parent) {
+        parent->parent->left = child;
+    } else {
+        parent->parent->right = child;
+    }
+}
+
+/*
+ * Gets the weight of a subtree, which is the amount of keys in it.
+ */
+static int set_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void set_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
+/*
+ * Rotates the AVL tree to the left.
+ */
+static void set_rotate_left(set me,
+                            struct node *const parent,
+                            struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    set_reference_parent(me, parent, child);
+    grand_child = child->left;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->right = grand_child;
+    child->left = parent;
+    parent->weight += set_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Rotates the AVL tree to the right.
+ */
+static void set_rotate_right(set me,
+                             struct node *const parent,
+                             struct node *const child)
+{
+    const int weight = parent->weight;
+    struct node *grand_child;
+    set_reference_parent(me, parent, child);
+    grand_child = child->right;
+    if (grand_child) {
+        grand_child->parent = parent;
+    }
+    parent->parent = child;
+    parent->left = grand_child;
+    child->right = parent;
+    parent->weight += set_weight(grand_child) - child->weight;
+    child->weight = weight;
+}
+
+/*
+ * Performs a left repair.
+ */
+static struct node *set_repair_left(set me,
+                                    struct node *const parent,
+                                    struct node *const child)
+{
+    set_rotate_left(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = 1;
+        child->balance = -1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a right repair.
+ */
+static struct node *set_repair_right(set me,
+                                     struct node *const parent,
+                                     struct node *const child)
+{
+    set_rotate_right(me, parent, child);
+    if (child->balance == 0) {
+        parent->balance = -1;
+        child->balance = 1;
+    } else {
+        parent->balance = 0;
+        child->balance = 0;
+    }
+    return child;
+}
+
+/*
+ * Performs a left-right repair.
+ */
+static struct node *set_repair_left_right(set me,
+                                          struct node *const parent,
+                                          struct node *const child,
+                                          struct node *const grand_child)
+{
+    set_rotate_left(me, child, grand_child);
+    set_rotate_right(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = 0;
+        child->balance = -1;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 1;
+        child->balance = 0;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Performs a right-left repair.
+ */
+static struct node *set_repair_right_left(set me,
+                                          struct node *const parent,
+                                          struct node *const child,
+                                          struct node *const grand_child)
+{
+    set_rotate_right(me, child, grand_child);
+    set_rotate_left(me, parent, grand_child);
+    if (grand_child->balance == 1) {
+        parent->balance = -1;
+        child->balance = 0;
+    } else if (grand_child->balance == 0) {
+        parent->balance = 0;
+        child->balance = 0;
+    } else {
+        parent->balance = 0;
+        child->balance = 1;
+    }
+    grand_child->balance = 0;
+    return grand_child;
+}
+
+/*
+ * Repairs the AVL tree on insert. The only possible values of parent->balance
+ * are {-2, 2} and the only possible values of child->balance are {-1, 0, 1}.
+ */
+static struct node *set_repair(set me,
+                               struct node *const parent,
+                               struct node *const child,
+                               struct node *const grand_child)
+{
+    if (parent->balance == 2) {
+        if (child->balance == -1) {
+            return set_repair_right_left(me, parent, child, grand_child);
+        }
+        return set_repair_left(me, parent, child);
+    }
+    if (child->balance == 1) {
+        return set_repair_left_right(me, parent, child, grand_child);
+    }
+    return set_repair_right(me, parent, child);
+}
+
+/*
+ * Balances the AVL tree on insert.
+ */
+static void set_insert_balance(set me, struct node *const item)
+{
+    struct node *grand_child = NULL;
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance--;
+        } else {
+            parent->balance++;
+        }
+        /* If balance is zero after modification, then the tree is balanced. */
+        if (parent->balance == 0) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            /* After one repair, the tree is balanced. */
+            set_repair(me, parent, child, grand_child);
+            return;
+        }
+        grand_child = child;
+        child = parent;
+        parent = parent->parent;
+    }
+}
+
+/*
+ * Creates and allocates a node.
+ */
+static struct node *set_create_node(set me,
+                                    const void *const data,
+                                    struct node *const parent)
+{
+    struct node *const insert = malloc(sizeof(struct node));
+    if (!insert) {
+        return NULL;
+    }
+    insert->parent = parent;
+    insert->balance = 0;
+    insert->weight = 1;
+    insert->key = malloc(me->key_size);
+    if (!insert->key) {
+        free(insert);
+        return NULL;
+    }
+    memcpy(insert->key, data, me->key_size);
+    insert->left = NULL;
+    insert->right = NULL;
+    me->size++;
+    return insert;
+}
+
+/*
+ * Compares two keys.
+ */
+static int set_compare(set me, const void *const one, const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/**
+ * Adds a key to the set if the set does not already contain it. The pointer to
+ * the key being passed in should point to the key type which this set holds.
+ * For example, if this set holds key integers, the key pointer should be a
+ * pointer to an integer. Since the key is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me  the set to add to
+ * @param key the key to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int set_put(set me, void *const key)
+{
+    struct node *traverse;
+    if (!me->root) {
+        struct node *insert = set_create_node(me, key, NULL);
+        if (!insert) {
+            return -ENOMEM;
+        }
+        me->root = insert;
+        return 0;
+    }
+    traverse = me->root;
+    for (;;) {
+        const int compare = set_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                struct node *insert = set_create_node(me, key, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->left = insert;
+                set_add_weight(traverse, 1);
+                set_insert_balance(me, insert);
+                return 0;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                struct node *insert = set_create_node(me, key, traverse);
+                if (!insert) {
+                    return -ENOMEM;
+                }
+                traverse->right = insert;
+                set_add_weight(traverse, 1);
+                set_insert_balance(me, insert);
+                return 0;
+            }
+        } else {
+            return 0;
+        }
+    }
+}
+
+/*
+ * If a match occurs, returns the match. Else, returns NULL.
+ */
+static struct node *set_equal_match(set me, const void *const key)
+{
+    struct node *traverse = me->root;
+    if (!traverse) {
+        return NULL;
+    }
+    for (;;) {
+        const int compare = set_compare(me, key, traverse->key);
+        if (compare < 0) {
+            if (traverse->left) {
+                traverse = traverse->left;
+            } else {
+                return NULL;
+            }
+        } else if (compare > 0) {
+            if (traverse->right) {
+                traverse = traverse->right;
+            } else {
+                return NULL;
+            }
+        } else {
+            return traverse;
+        }
+    }
+}
+
+/**
+ * Determines if the set contains the specified key. The pointer to the key
+ * being passed in should point to the key type which this set holds. For
+ * example, if this set holds key integers, the key pointer should be a pointer
+ * to an integer. Since the key is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me  the set to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the set contained the key, otherwise 0
+ */
+int set_contains(set me, void *const key)
+{
+    return set_equal_match(me, key) != NULL;
+}
+
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of keys in its subtree. The pointer to the key
+ * being passed in should point to the key type which this set holds.
+ *
+ * @param me  the set to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of keys in the set which are less than the key
+ */
+int set_rank(set me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (set_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - set_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key at the specified index in sorted order, so that index zero is
+ * the smallest key. This takes logarithmic time, since each node keeps track
+ * of the amount of keys in its subtree.
+ *
+ * @param key   the key to copy to
+ * @param me    the set to get the key from
+ * @param index the index of the key in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int set_select(void *const key, set me, const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = set_weight(item->left);
+        const int own = item->weight - left - set_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    memcpy(key, item->key, me->key_size);
+    return 0;
+}
+
+/*
+ * Repairs the AVL tree by pivoting on an item.
+ */
+static struct node *set_repair_pivot(set me,
+                                     struct node *const item,
+                                     const int is_left_pivot)
+{
+    struct node *const child = is_left_pivot ? item->right : item->left;
+    struct node *const grand_child =
+            child->balance == 1 ? child->right : child->left;
+    return set_repair(me, item, child, grand_child);
+}
+
+/*
+ * Goes back up the tree repairing it along the way.
+ */
+static void set_trace_ancestors(set me, struct node *item)
+{
+    struct node *child = item;
+    struct node *parent = item->parent;
+    while (parent) {
+        if (parent->left == child) {
+            parent->balance++;
+        } else {
+            parent->balance--;
+        }
+        /* The tree is balanced if balance is -1 or +1 after modification. */
+        if (parent->balance == -1 || parent->balance == 1) {
+            return;
+        }
+        /* Must re-balance if not in {-1, 0, 1} */
+        if (parent->balance > 1 || parent->balance < -1) {
+            child = set_repair_pivot(me, parent, parent->left == child);
+            parent = child->parent;
+            /* If balance is -1 or +1 after modification or the parent is */
+            /* NULL, then the tree is balanced. */
+            if (!parent || child->balance == -1 || child->balance == 1) {
+                return;
+            }
+        } else {
+            child = parent;
+            parent = parent->parent;
+        }
+    }
+}
+
+/*
+ * Balances the AVL tree on deletion.
+ */
+static void set_delete_balance(set me,
+                               struct node *item,
+                               const int is_left_deleted)
+{
+    if (is_left_deleted) {
+        item->balance++;
+    } else {
+        item->balance--;
+    }
+    /* If balance is -1 or +1 after modification, then the tree is balanced. */
+    if (item->balance == -1 || item->balance == 1) {
+        return;
+    }
+    /* Must re-balance if not in {-1, 0, 1} */
+    if (item->balance > 1 || item->balance < -1) {
+        item = set_repair_pivot(me, item, is_left_deleted);
+        if (!item->parent || item->balance == -1 || item->balance == 1) {
+            return;
+        }
+    }
+    set_trace_ancestors(me, item);
+}
+
+/*
+ * Removes traverse when it has no children.
+ */
+static void set_remove_no_children(set me, const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent and no children, then the only node is traverse. */
+    if (!parent) {
+        me->root = NULL;
+        return;
+    }
+    /* No re-reference needed since traverse has no children. */
+    if (parent->left == traverse) {
+        parent->left = NULL;
+        set_delete_balance(me, parent, 1);
+    } else {
+        parent->right = NULL;
+        set_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has one child.
+ */
+static void set_remove_one_child(set me, const struct node *const traverse)
+{
+    struct node *const parent = traverse->parent;
+    /* If no parent, make the child of traverse the new root. */
+    if (!parent) {
+        if (traverse->left) {
+            traverse->left->parent = NULL;
+            me->root = traverse->left;
+        } else {
+            traverse->right->parent = NULL;
+            me->root = traverse->right;
+        }
+        return;
+    }
+    /* The parent of traverse now references the child of traverse. */
+    if (parent->left == traverse) {
+        if (traverse->left) {
+            parent->left = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->left = traverse->right;
+            traverse->right->parent = parent;
+        }
+        set_delete_balance(me, parent, 1);
+    } else {
+        if (traverse->left) {
+            parent->right = traverse->left;
+            traverse->left->parent = parent;
+        } else {
+            parent->right = traverse->right;
+            traverse->right->parent = parent;
+        }
+        set_delete_balance(me, parent, 0);
+    }
+}
+
+/*
+ * Removes traverse when it has two children.
+ */
+static void set_remove_two_children(set me, const struct node *const traverse)
+{
+    struct node *item;
+    struct node *parent;
+    const int is_left_deleted = traverse->right->left != NULL;
+    if (!is_left_deleted) {
+        item = traverse->right;
+        parent = item;
+        item->balance = traverse->balance;
+        item->parent = traverse->parent;
+        item->left = traverse->left;
+        item->left->parent = item;
+    } else {
+        item = traverse->right->left;
+        while (item->left) {
+            item = item->left;
+        }
+        parent = item->parent;
+        item->balance = traverse->balance;
+        item->parent->left = item->right;
+        if (item->right) {
+            item->right->parent = item->parent;
+        }
+        item->left = traverse->left;
+        item->left->parent = item;
+        item->right = traverse->right;
+        item->right->parent = item;
+        item->parent = traverse->parent;
+    }
+    if (!traverse->parent) {
+        me->root = item;
+    } else if (traverse->parent->left == traverse) {
+        item->parent->left = item;
+    } else {
+        item->parent->right = item;
+    }
+    set_delete_balance(me, parent, is_left_deleted);
+}
+
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void set_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - set_weight(traverse->left)
+                    - set_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    set_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - set_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
+/*
+ * Removes the element from the set.
+ */
+static void set_remove_element(set me, struct node *const traverse)
+{
+    set_remove_weight(traverse);
+    if (!traverse->left && !traverse->right) {
+        set_remove_no_children(me, traverse);
+    } else if (!traverse->left || !traverse->right) {
+        set_remove_one_child(me, traverse);
+    } else {
+        set_remove_two_children(me, traverse);
+    }
+    free(traverse->key);
+    free(traverse);
+    me->size--;
+}
+
+/**
+ * Removes the key from the set if it contains it. The pointer to the key
+ * being passed in should point to the key type which this set holds. For
+ * example, if this set holds key integers, the key pointer should be a pointer
+ * to an integer. Since the key is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me  the set to remove an key from
+ * @param key the key to remove
+ *
+ * @return 1 if the set contained the key, otherwise 0
+ */
+int set_remove(set me, void *const key)
+{
+    struct node *const traverse = set_equal_match(me, key);
+    if (!traverse) {
+        return 0;
+    }
+    set_remove_element(me, traverse);
+    return 1;
+}
+
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *set_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was only partially built.
+ */
+static void set_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    set_free_subtree(item->left);
+    set_free_subtree(item->right);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Gets the node with the smallest key in the subtree.
+ */
+static struct node *set_first_node(struct node *item)
+{
+    if (item) {
+        while (item->left) {
+            item = item->left;
+        }
+    }
+    return item;
+}
+
+/*
+ * Builds a balanced subtree from the sorted keys. The middle key is the root
+ * of the subtree, and the keys before and after it form the left and right
+ * subtrees.
+ */
+static int set_build_subtree(set me,
+                             const void *const *const keys,
+                             const int count,
+                             struct node **const subtree,
+                             int *const height)
+{
+    const int left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = set_build_subtree(me, keys, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    item = set_create_node(me, keys[left_count], NULL);
+    if (!item) {
+        set_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = set_build_subtree(me, keys + left_count + 1, count - 1 - left_count,
+                           &right, &right_height);
+    if (rc != 0) {
+        set_free_subtree(left);
+        set_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + set_weight(left) + set_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+/*
+ * Merges the keys of two sets in sorted order into an empty set. The flags
+ * specify whether the keys which are only in the first set, in both sets, or
+ * only in the second set are kept.
+ */
+static int set_combine(set me,
+                       set one,
+                       set two,
+                       const int keep_one,
+                       const int keep_both,
+                       const int keep_two)
+{
+    struct node *first = set_first_node(one->root);
+    struct node *second = set_first_node(two->root);
+    const void **keys;
+    int count = 0;
+    int height;
+    int rc;
+    if (me->root || me->key_size != one->key_size
+        || me->key_size != two->key_size) {
+        return -EINVAL;
+    }
+    if (one->size + two->size == 0) {
+        return 0;
+    }
+    keys = malloc((one->size + two->size) * sizeof(const void *));
+    if (!keys) {
+        return -ENOMEM;
+    }
+    while (first || second) {
+        int compare;
+        if (!first) {
+            compare = 1;
+        } else if (!second) {
+            compare = -1;
+        } else {
+            compare = set_compare(one, first->key, second->key);
+        }
+        if (compare < 0) {
+            if (keep_one) {
+                keys[count++] = first->key;
+            }
+            first = set_next_node(first);
+        } else if (compare > 0) {
+            if (keep_two) {
+                keys[count++] = second->key;
+            }
+            second = set_next_node(second);
+        } else {
+            if (keep_both) {
+                keys[count++] = first->key;
+            }
+            first = set_next_node(first);
+            second = set_next_node(second);
+        }
+    }
+    rc = set_build_subtree(me, keys, count, &me->root, &height);
+    if (rc != 0) {
+        me->size = 0;
+    }
+    free(keys);
+    return rc;
+}
+
+/**
+ * Stores the union of two sets in an empty set, which is every key that is in
+ * either of the sets. Since both sets are traversed in sorted order at the
+ * same time, and the balanced tree is built directly from the result, this
+ * takes linear time. The sets must all have the same key size and comparator
+ * function. If an error occurs, the set is left empty.
+ *
+ * @param me  the empty set to store the union in
+ * @param one the first set
+ * @param two the second set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the key sizes do not match
+ */
+int set_union(set me, set one, set two)
+{
+    return set_combine(me, one, two, 1, 1, 1);
+}
+
+/**
+ * Stores the intersection of two sets in an empty set, which is every key that
+ * is in both of the sets. This takes linear time. The sets must all have the
+ * same key size and comparator function. If an error occurs, the set is left
+ * empty.
+ *
+ * @param me  the empty set to store the intersection in
+ * @param one the first set
+ * @param two the second set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the key sizes do not match
+ */
+int set_intersection(set me, set one, set two)
+{
+    return set_combine(me, one, two, 0, 1, 0);
+}
+
+/**
+ * Stores the difference of two sets in an empty set, which is every key that
+ * is in the first set but not in the second set. This takes linear time. The
+ * sets must all have the same key size and comparator function. If an error
+ * occurs, the set is left empty.
+ *
+ * @param me  the empty set to store the difference in
+ * @param one the set to take the keys from
+ * @param two the set of keys to leave out
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the key sizes do not match
+ */
+int set_difference(set me, set one, set two)
+{
+    return set_combine(me, one, two, 1, 0, 0);
+}
+
+/**
+ * Determines if every key of the set is also in the other set. This takes
+ * linear time, since both sets are traversed in sorted order at the same time.
+ * The sets must have the same comparator function.
+ *
+ * @param me    the set which may be a subset
+ * @param other the set which may contain it
+ *
+ * @return 1 if the set is a subset of the other set, otherwise 0
+ */
+int set_is_subset(set me, set other)
+{
+    struct node *first = set_first_node(me->root);
+    struct node *second = set_first_node(other->root);
+    if (me->size > other->size) {
+        return 0;
+    }
+    while (first) {
+        int compare;
+        if (!second) {
+            return 0;
+        }
+        compare = set_compare(me, first->key, second->key);
+        if (compare < 0) {
+            return 0;
+        }
+        if (compare == 0) {
+            first = set_next_node(first);
+        }
+        second = set_next_node(second);
+    }
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void set_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void set_stream_write(struct snapshot_stream *const stream,
+                             const void *const data,
+                             const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            set_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void set_stream_read(struct snapshot_stream *const stream,
+                            void *const data,
+                            const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int set_load_subtree(set me,
+                            struct snapshot_stream *const stream,
+                            const unsigned long count,
+                            struct node **const subtree,
+                            int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = set_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    set_stream_read(stream, stream->record, me->key_size);
+    if (stream->rc != 0) {
+        set_free_subtree(left);
+        return stream->rc;
+    }
+    item = set_create_node(me, stream->record, NULL);
+    if (!item) {
+        set_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = set_load_subtree(me, stream, count - 1 - left_count, &right,
+                          &right_height);
+    if (rc != 0) {
+        set_free_subtree(left);
+        set_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + set_weight(left) + set_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the set to a file descriptor. The snapshot
+ * consists of a header, which holds the key size and the amount of keys,
+ * followed by the keys in sorted order. Since the keys are copied byte for
+ * byte, they should not contain pointers unless the snapshot is loaded by the
+ * same process.
+ *
+ * @param me the set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int set_save(set me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *traverse = me->root;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    header.count = (unsigned long) me->size;
+    set_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    if (traverse) {
+        while (traverse->left) {
+            traverse = traverse->left;
+        }
+    }
+    while (stream.rc == 0 && traverse) {
+        set_stream_write(&stream, traverse->key, me->key_size);
+        traverse = set_next_node(traverse);
+    }
+    set_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by set_save into an empty set.
+ * Since the snapshot is sorted, the balanced tree is built directly from it in
+ * linear time without calling the comparator function. Thus, the set must have
+ * been initialized with the same key size and comparator function as the set
+ * which was saved. If an error occurs, the set is left empty. When the file
+ * descriptor is seekable, it is left positioned right after the snapshot.
+ *
+ * @param me the set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the snapshot does not match the
+ *                 set
+ * @return -EIO    if the snapshot could not be read
+ */
+int set_load(set me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE + me->key_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    set_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != 0
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = set_load_subtree(me, &stream, header.count, &me->root, &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the keys from the set.
+ *
+ * @param me the set to clear
+ */
+void set_clear(set me)
+{
+    while (me->root) {
+        set_remove_element(me, me->root);
+    }
+}
+
+/**
+ * Frees the set memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the set to free from memory
+ *
+ * @return NULL
+ */
+set set_destroy(set me)
+{
+    set_clear(me);
+    free(me);
+    return NULL;
+}
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef node
+#undef snapshot_header
+#undef snapshot_stream
+
+
+#include <string.h>
+#include <limits.h>
+
+#define INSERTION_SORT_SIZE sort_INSERTION_SORT_SIZE
+#define RADIX_SORT_SIZE sort_RADIX_SORT_SIZE
+static const int INSERTION_SORT_SIZE = 16;
+static const int RADIX_SORT_SIZE = 256;
+
+/*
+ * Compares two elements.
+ */
+static int containers_sort_compare(int (*const comparator)(const void *,
+                                                           const void *),
+                                   const size_t size,
+                                   const void *const one,
+                                   const void *const two)
+{
+    return CONTAINERS_COMPARE(comparator, size, one, two);
+}
+
+/*
+ * Swaps two elements. Elements which are the size of a scalar are swapped as a
+ * single scalar, and larger elements a scalar at a time.
+ */
+static void containers_sort_swap(char *const one,
+                                 char *const two,
+                                 const size_t size)
+{
+    size_t i = 0;
+    if (size == sizeof(unsigned int)) {
+        unsigned int temp;
+        memcpy(&temp, one, sizeof(unsigned int));
+        memcpy(one, two, sizeof(unsigned int));
+        memcpy(two, &temp, sizeof(unsigned int));
+        return;
+    }
+    for (; i + sizeof(unsigned long) <= size; i += sizeof(unsigned long)) {
+        unsigned long temp;
+        memcpy(&temp, one + i, sizeof(unsigned long));
+        memcpy(one + i, two + i, sizeof(unsigned long));
+        memcpy(two + i, &temp, sizeof(unsigned long));
+    }
+    for (; i < size; i++) {
+        const char temp = one[i];
+        one[i] = two[i];
+        two[i] = temp;
+    }
+}
+
+/*
+ * Sorts a few elements by inserting each of them into the sorted elements
+ * before it.
+ */
+static void containers_sort_insertion(char *const data,
+                                      const int count,
+                                      const size_t size,
+                                      int (*comparator)(const void *const,
+                                                        const void *const))
+{
+    int i;
+    for (i = 1; i < count; i++) {
+        char *item = data + i * size;
+        while (item > data
+               && containers_sort_compare(comparator, size, item - size,
+                                          item) > 0) {
+            containers_sort_swap(item - size, item, size);
+            item -= size;
+        }
+    }
+}
+
+/*
+ * Moves the element at the root down the heap until both of its children are
+ * not larger than it.
+ */
+static void containers_sort_sift_down(char *const data,
+                                      int root,
+                                      const int count,
+                                      const size_t size,
+                                      int (*comparator)(const void *const,
+                                                        const void *const))
+{
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= count) {
+            return;
+        }
+        if (child + 1 < count
+            && containers_sort_compare(comparator, size, data + child * size,
+                                       data + (child + 1) * size) < 0) {
+            child++;
+        }
+        if (containers_sort_compare(comparator, size, data + root * size,
+                                    data + child * size) >= 0) {
+            return;
+        }
+        containers_sort_swap(data + root * size, data + child * size, size);
+        root = child;
+    }
+}
+
+/*
+ * Sorts the elements with a heap sort, which is used when the quick sort keeps
+ * picking bad pivots, so that the sort never takes more than O(n log n) time.
+ */
+static void containers_sort_heap(char *const data,
+                                 int count,
+                                 const size_t size,
+                                 int (*comparator)(const void *const,
+                                                   const void *const))
+{
+    int i;
+    for (i = count / 2 - 1; i >= 0; i--) {
+        containers_sort_sift_down(data, i, count, size, comparator);
+    }
+    while (count > 1) {
+        count--;
+        containers_sort_swap(data, data + count * size, size);
+        containers_sort_sift_down(data, 0, count, size, comparator);
+    }
+}
+
+/*
+ * Moves the median of the first, middle, and last elements to the front, where
+ * it is used as the pivot.
+ */
+static void containers_sort_median(char *const data,
+                                   const int count,
+                                   const size_t size,
+                                   int (*comparator)(const void *const,
+                                                     const void *const))
+{
+    char *const first = data;
+    char *const middle = data + (count / 2) * size;
+    char *const last = data + (count - 1) * size;
+    char *median = middle;
+    if (containers_sort_compare(comparator, size, first, middle) < 0) {
+        if (containers_sort_compare(comparator, size, middle, last) > 0) {
+            median = containers_sort_compare(comparator, size, first, last) < 0
+                     ? last : first;
+        }
+    } else if (containers_sort_compare(comparator, size, first, last) < 0) {
+        median = first;
+    } else if (containers_sort_compare(comparator, size, middle, last) < 0) {
+        median = last;
+    }
+    if (median != first) {
+        containers_sort_swap(first, median, size);
+    }
+}
+
+/*
+ * Sorts the elements with a quick sort, which falls back to a heap sort once
+ * the depth runs out, and to an insertion sort for a few elements. Only the
+ * smaller side of each partition is sorted recursively, so that the recursion
+ * is at most logarithmic in depth.
+ */
+static void containers_sort_intro(char *data,
+                                  int count,
+                                  const size_t size,
+                                  int (*comparator)(const void *const,
+                                                    const void *const),
+                                  int depth)
+{
+    while (count > INSERTION_SORT_SIZE) {
+        int i = 1;
+        int j = count - 1;
+        if (depth == 0) {
+            containers_sort_heap(data, count, size, comparator);
+            return;
+        }
+        depth--;
+        containers_sort_median(data, count, size, comparator);
+        for (;;) {
+            while (i <= j
+                   && containers_sort_compare(comparator, size, data + i * size,
+                                              data) < 0) {
+                i++;
+            }
+            while (i <= j
+                   && containers_sort_compare(comparator, size, data + j * size,
+                                              data) > 0) {
+                j--;
+            }
+            if (i >= j) {
+                break;
+            }
+            containers_sort_swap(data + i * size, data + j * size, size);
+            i++;
+            j--;
+        }
+        containers_sort_swap(data, data + j * size, size);
+        if (j < count - 1 - j) {
+            containers_sort_intro(data, j, size, comparator, depth);
+            data += (j + 1) * size;
+            count -= j + 1;
+        } else {
+            containers_sort_intro(data + (j + 1) * size, count - 1 - j, size,
+                                  comparator, depth);
+            count = j;
+        }
+    }
+    containers_sort_insertion(data, count, size, comparator);
+}
+
+/*
+ * Determines whether the elements are already sorted, or are sorted in reverse
+ * without any equal elements, in which case they are reversed. This makes the
+ * common cases of sorting sorted data take linear time.
+ */
+static int containers_sort_presorted(char *const data,
+                                     const int count,
+                                     const size_t size,
+                                     int (*comparator)(const void *const,
+                                                       const void *const))
+{
+    char *const end = data + count * size;
+    char *item = data + size;
+    int i;
+    while (item < end
+           && containers_sort_compare(comparator, size, item - size,
+                                      item) <= 0) {
+        item += size;
+    }
+    if (item == end) {
+        return 1;
+    }
+    if (item > data + size) {
+        return 0;
+    }
+    while (item < end
+           && containers_sort_compare(comparator, size, item - size,
+                                      item) > 0) {
+        item += size;
+    }
+    if (item < end) {
+        return 0;
+    }
+    for (i = 0; i < count / 2; i++) {
+        containers_sort_swap(data + i * size, data + (count - 1 - i) * size,
+                             size);
+    }
+    return 1;
+}
+
+/*
+ * Converts the elements to unsigned keys which are in the same order as the
+ * elements, or back again if decode is set. Signed integers have their sign
+ * bit flipped, and floating point numbers have either their sign bit or all of
+ * their bits flipped, depending on the sign. Returns zero if the comparator is
+ * not a built-in scalar comparator of the element size.
+ */
+static int containers_sort_convert(unsigned long *const keys,
+                                   char *const data,
+                                   const int count,
+                                   const size_t size,
+                                   int (*comparator)(const void *const,
+                                                     const void *const),
+                                   const int decode)
+{
+    const unsigned int uint_sign = UINT_MAX ^ (UINT_MAX >> 1);
+    const unsigned long ulong_sign = ULONG_MAX ^ (ULONG_MAX >> 1);
+    unsigned long flip = 0;
+    int is_float = 0;
+    int i;
+    if ((comparator == containers_compare_int && size == sizeof(int))
+        || (comparator == containers_compare_uint
+            && size == sizeof(unsigned int))) {
+        if (comparator == containers_compare_int) {
+            flip = uint_sign;
+        }
+        for (i = 0; i < count; i++) {
+            unsigned int value;
+            if (decode) {
+                value = (unsigned int) (keys[i] ^ flip);
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&value, data + i * size, size);
+                keys[i] = value ^ flip;
+            }
+        }
+        return 1;
+    }
+    if ((comparator == containers_compare_long && size == sizeof(long))
+        || (comparator == containers_compare_ulong
+            && size == sizeof(unsigned long))) {
+        if (comparator == containers_compare_long) {
+            flip = ulong_sign;
+        }
+        for (i = 0; i < count; i++) {
+            if (decode) {
+                const unsigned long value = keys[i] ^ flip;
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&keys[i], data + i * size, size);
+                keys[i] ^= flip;
+            }
+        }
+        return 1;
+    }
+    if (comparator == containers_compare_float && size == sizeof(float)
+        && sizeof(float) == sizeof(unsigned int)) {
+        for (i = 0; i < count; i++) {
+            unsigned int value;
+            if (decode) {
+                value = (unsigned int) keys[i];
+                value = (value & uint_sign) ? value ^ uint_sign : ~value;
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&value, data + i * size, size);
+                keys[i] = (value & uint_sign) ? ~value : value | uint_sign;
+            }
+        }
+        is_float = 1;
+    }
+    if (comparator == containers_compare_double && size == sizeof(double)
+        && sizeof(double) == sizeof(unsigned long)) {
+        for (i = 0; i < count; i++) {
+            unsigned long value;
+            if (decode) {
+                value = keys[i];
+                value = (value & ulong_sign) ? value ^ ulong_sign : ~value;
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&value, data + i * size, size);
+                keys[i] = (value & ulong_sign) ? ~value : value | ulong_sign;
+            }
+        }
+        is_float = 1;
+    }
+    return is_float;
+}
+
+/*
+ * Sorts the elements with a least significant digit radix sort on the keys of
+ * the elements, a byte at a time. Bytes which are the same in every key are
+ * skipped. Returns zero if the elements cannot be radix sorted, or if there is
+ * not enough memory to.
+ */
+static int containers_sort_radix(char *const data,
+                                 const int count,
+                                 const size_t size,
+                                 int (*comparator)(const void *const,
+                                                   const void *const))
+{
+    int counts[sizeof(unsigned long)][256];
+    unsigned long *keys;
+    unsigned long *other;
+    size_t digit;
+    int i;
+    if (size > sizeof(unsigned long)) {
+        return 0;
+    }
+    keys = malloc(2 * (size_t) count * sizeof(unsigned long));
+    if (!keys) {
+        return 0;
+    }
+    if (!containers_sort_convert(keys, data, count, size, comparator, 0)) {
+        free(keys);
+        return 0;
+    }
+    other = keys + count;
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < count; i++) {
+        for (digit = 0; digit < size; digit++) {
+            counts[digit][(keys[i] >> (digit * 8)) & 0xff]++;
+        }
+    }
+    for (digit = 0; digit < size; digit++) {
+        int *const bucket = counts[digit];
+        const int shift = (int) digit * 8;
+        unsigned long *temp;
+        int total = 0;
+        if (bucket[(keys[0] >> shift) & 0xff] == count) {
+            continue;
+        }
+        for (i = 0; i < 256; i++) {
+            const int amount = bucket[i];
+            bucket[i] = total;
+            total += amount;
+        }
+        for (i = 0; i < count; i++) {
+            other[bucket[(keys[i] >> shift) & 0xff]++] = keys[i];
+        }
+        temp = keys;
+        keys = other;
+        other = temp;
+    }
+    containers_sort_convert(keys, data, count, size, comparator, 1);
+    free(keys < other ? keys : other);
+    return 1;
+}
+
+/**
+ * Sorts contiguous elements in ascending order according to the comparator.
+ * Elements which are already sorted, or sorted in reverse, are handled in
+ * linear time. If the comparator is containers_compare_int, _uint, _long,
+ * _ulong, _float, or _double, and the element size is the size of that type,
+ * the elements are sorted with a radix sort in linear time without calling the
+ * comparator. Otherwise, an introsort is used, which takes O(n log n) time in
+ * the worst case. If the comparator is containers_compare_key, the elements are
+ * compared by all of their bytes with memcmp. The sort is not stable.
+ *
+ * @param data       the elements to sort
+ * @param count      the amount of elements
+ * @param size       the size of each element
+ * @param comparator the comparator function which compares two elements
+ */
+void containers_sort(void *const data,
+                     const int count,
+                     const size_t size,
+                     int (*const comparator)(const void *const one,
+                                             const void *const two))
+{
+    int depth = 0;
+    int i;
+    if (count < 2) {
+        return;
+    }
+    if (count >= RADIX_SORT_SIZE
+        && containers_sort_radix(data, count, size, comparator)) {
+        return;
+    }
+    if (containers_sort_presorted(data, count, size, comparator)) {
+        return;
+    }
+    for (i = count; i > 1; i /= 2) {
+        depth += 2;
+    }
+    containers_sort_intro(data, count, size, comparator, depth);
+}
+#undef INSERTION_SORT_SIZE
+#undef RADIX_SORT_SIZE
+
+
+
+struct internal_stack {
+    deque deque_data;
+};
+
+/**
+ * Initializes a stack.
+ *
+ * @param data_size the size of each data element in the stack; must be
+ *                  positive
+ *
+ * @return the newly-initialized stack, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+stack stack_init(const size_t data_size)
+{
+    struct internal_stack *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_stack));
+    if (!init) {
+        return NULL;
+    }
+    init->deque_data = deque_init(data_size);
+    if (!init->deque_data) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Determines the size of the stack.
+ *
+ * @param me the stack to check size of
+ *
+ * @return the size of the stack
+ */
+int stack_size(stack me)
+{
+    return deque_size(me->deque_data);
+}
+
+/**
+ * Determines if the stack is empty, meaning it contains no elements.
+ *
+ * @param me the stack to check if empty
+ *
+ * @return 1 if the stack is empty, otherwise 0
+ */
+int stack_is_empty(stack me)
+{
+    return deque_is_empty(me->deque_data);
+}
+
+/**
+ * Frees unused memory from the stack.
+ *
+ * @param me the stack to trim
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int stack_trim(stack me)
+{
+    return deque_trim(me->deque_data);
+}
+
+/**
+ * Copies the stack to an array. Since it is a copy, the array may be modified
+ * without causing side effects to the stack data structure. Memory is not
+ * allocated, thus the array being used for the copy must be allocated before
+ * this function is called.
+ *
+ * @param arr the initialized array to copy the stack to
+ * @param me  the stack to copy to the array
+ */
+void stack_copy_to_array(void *const arr, stack me)
+{
+    deque_copy_to_array(arr, me->deque_data);
+}
+
+/**
+ * Adds an element to the top of the stack. The pointer to the data being passed
+ * in should point to the data type which this stack holds. For example, if this
+ * stack holds integers, the data pointer should be a pointer to an integer.
+ * Since the data is being copied, the pointer only has to be valid when this
+ * function is called.
+ *
+ * @param me   the stack to add an element to
+ * @param data the data to add to the stack
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int stack_push(stack me, void *const data)
+{
+    return deque_push_back(me->deque_data, data);
+}
+
+/**
+ * Removes the top element of the stack, and copies the data which is being
+ * removed. The pointer to the data being obtained should point to the data type
+ * which this stack holds. For example, if this stack holds integers, the data
+ * pointer should be a pointer to an integer. Since this data is being copied
+ * from the array to the data pointer, the pointer only has to be valid when
+ * this function is called.
+ *
+ * @param data the copy of the element being removed
+ * @param me   the stack to remove the top element from
+ *
+ * @return 1 if the stack contained elements, otherwise 0
+ */
+int stack_pop(void *const data, stack me)
+{
+    return deque_pop_back(data, me->deque_data) == 0;
+}
+
+/**
+ * Copies the top element of the stack. The pointer to the data being obtained
+ * should point to the data type which this stack holds. For example, if this
+ * stack holds integers, the data pointer should be a pointer to an integer.
+ * Since this data is being copied from the array to the data pointer, the
+ * pointer only has to be valid when this function is called.
+ *
+ * @param data the copy of the top element of the stack
+ * @param me   the stack to copy from
+ *
+ * @return 1 if the stack contained elements, otherwise 0
+ */
+int stack_top(void *const data, stack me)
+{
+    return deque_get_last(data, me->deque_data) == 0;
+}
+
+/**
+ * Clears the stack and sets it to the state from original initialization.
+ *
+ * @param me the stack to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int stack_clear(stack me)
+{
+    return deque_clear(me->deque_data);
+}
+
+/**
+ * Frees the stack memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the stack to destroy
+ *
+ * @return NULL
+ */
+stack stack_destroy(stack me)
+{
+    deque_destroy(me->deque_data);
+    free(me);
+    return NULL;
+}
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <unistd.h>
+#endif
+
+#define RESIZE_AT unordered_map_RESIZE_AT
+#define RESIZE_RATIO unordered_map_RESIZE_RATIO
+#define SNAPSHOT_BUFFER_SIZE unordered_map_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC unordered_map_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION unordered_map_SNAPSHOT_VERSION
+#define STARTING_BUCKETS unordered_map_STARTING_BUCKETS
+#define node unordered_map_node
+#define snapshot_header unordered_map_snapshot_header
+static const int STARTING_BUCKETS = 8;
+static const double RESIZE_AT = 0.75;
+static const double RESIZE_RATIO = 1.5;
+static const char SNAPSHOT_MAGIC[8] = "CNTRHASH";
+static const unsigned long SNAPSHOT_VERSION = 2;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_unordered_map {
+    size_t key_size;
+    size_t value_size;
+    unsigned long (*hash)(const void *const key);
+    int (*comparator)(const void *const one, const void *const two);
+    int bytewise_keys;
+    int size;
+    int capacity;
+    double max_load_factor;
+    double min_load_factor;
+    struct node **buckets;
+    int migrate_step;
+    int migrate_index;
+    int old_capacity;
+    struct node **old_buckets;
+    unsigned long seed;
+    int max_chain_length;
+    int reseeded;
+};
+
+struct node {
+    void *key;
+    void *value;
+    unsigned long hash;
+    struct node *next;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header, each
+ * of which is the stored hash followed by the key and the value.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * Mixes all the bits of the value. This is the same mixer as the one used by
+ * the built-in integer hash functions, so that they can be inlined.
+ */
+static unsigned long unordered_map_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Gets the hash of the key. The built-in hash functions are already
+ * well-distributed, so they are inlined or called directly, with the seed fed
+ * into them, so that keys which collide under one seed do not collide under
+ * another. Otherwise, the user-defined hash is called, and then a second hash
+ * is used to prevent hashing clusters if the user-defined hash is sub-optimal.
+ */
+static unsigned long unordered_map_hash(unordered_map me, const void *const key)
+{
+    unsigned long hash;
+    if (me->hash == containers_hash_int) {
+        int value;
+        memcpy(&value, key, sizeof(int));
+        return unordered_map_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_long) {
+        long value;
+        memcpy(&value, key, sizeof(long));
+        return unordered_map_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_key) {
+        return containers_hash_bytes_seeded(key, me->key_size, me->seed);
+    }
+    if (me->hash == containers_hash_string) {
+        const char *string;
+        memcpy(&string, key, sizeof(char *));
+        return containers_hash_bytes_seeded(string, strlen(string), me->seed);
+    }
+    hash = me->hash(key);
+    hash ^= (hash >> 20UL) ^ (hash >> 12UL);
+    return hash ^ (hash >> 7UL) ^ (hash >> 4UL);
+}
+
+/*
+ * Determines whether the stored hashes depend on the seed, which they do for
+ * the built-in hash functions. The hashes of a user-defined hash function do
+ * not, so only their buckets change with the seed.
+ */
+static int unordered_map_is_seeded(unordered_map me)
+{
+    return me->hash == containers_hash_int || me->hash == containers_hash_long
+           || me->hash == containers_hash_key
+           || me->hash == containers_hash_string;
+}
+
+/*
+ * Determines whether two keys are equal exactly when their bytes are equal.
+ */
+static int unordered_map_is_bytewise(unordered_map me)
+{
+    return CONTAINERS_COMPARE_IS_BYTEWISE(me->comparator, me->key_size);
+}
+
+/**
+ * Initializes an unordered map.
+ *
+ * @param key_size   the size of each key in the unordered map; must be
+ *                   positive
+ * @param value_size the size of each value in the unordered map; must be
+ *                   positive
+ * @param hash       the hash function which computes the hash from the key;
+ *                   must not be NULL; may be one of the built-in hash functions
+ *                   from hash.h
+ * @param comparator the comparator function which compares two keys; must not
+ *                   be NULL; may be one of the built-in comparators from
+ *                   compare.h
+ *
+ * @return the newly-initialized unordered map, or NULL if it was not
+ *         successfully initialized due to invalid input arguments, memory
+ *         allocation error, or the random bytes of the operating system not
+ *         being readable
+ */
+unordered_map unordered_map_init(const size_t key_size,
+                                 const size_t value_size,
+                                 unsigned long (*hash)(const void *const),
+                                 int (*comparator)(const void *const,
+                                                   const void *const))
+{
+    struct internal_unordered_map *init;
+    if (key_size == 0 || value_size == 0 || !hash || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_unordered_map));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->value_size = value_size;
+    init->hash = hash;
+    init->comparator = comparator;
+    init->bytewise_keys = unordered_map_is_bytewise(init);
+    init->size = 0;
+    init->capacity = STARTING_BUCKETS;
+    init->max_load_factor = RESIZE_AT;
+    init->min_load_factor = 0;
+    init->migrate_step = 0;
+    init->migrate_index = 0;
+    init->old_capacity = 0;
+    init->old_buckets = NULL;
+    if (containers_hash_new_seed(&init->seed, init) != 0) {
+        free(init);
+        return NULL;
+    }
+    init->max_chain_length = 0;
+    init->reseeded = 0;
+    init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
+    if (!init->buckets) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/*
+ * Gets the index of the bucket which holds the hash. The hash is mixed with the
+ * seed first, so that keys chosen to collide in the buckets of one unordered
+ * container are spread out in any other.
+ */
+static int unordered_map_index(unordered_map me,
+                               const unsigned long hash,
+                               const int capacity)
+{
+    const unsigned long mixed = unordered_map_mix(hash ^ me->seed);
+    return (int) (mixed % (unsigned long) capacity);
+}
+
+/*
+ * Adds the specified node to the map.
+ */
+static void unordered_map_add_item(unordered_map me, struct node *const add)
+{
+    const int index = unordered_map_index(me, add->hash, me->capacity);
+    add->next = me->buckets[index];
+    me->buckets[index] = add;
+}
+
+/*
+ * Gets the bucket which holds the nodes with the specified hash. While the
+ * nodes are being moved to the new buckets, the old buckets which have not
+ * been moved yet still hold their nodes.
+ */
+static struct node **unordered_map_bucket(unordered_map me,
+                                          const unsigned long hash)
+{
+    if (me->old_buckets) {
+        const int old_index = unordered_map_index(me, hash, me->old_capacity);
+        if (old_index >= me->migrate_index) {
+            return &me->old_buckets[old_index];
+        }
+    }
+    return &me->buckets[unordered_map_index(me, hash, me->capacity)];
+}
+
+/*
+ * Moves the nodes of up to count old buckets to the new buckets, and frees the
+ * old buckets once all of their nodes have been moved.
+ */
+static void unordered_map_migrate(unordered_map me, int count)
+{
+    while (me->old_buckets && count > 0) {
+        struct node *traverse = me->old_buckets[me->migrate_index];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_map_add_item(me, traverse);
+            traverse = backup;
+        }
+        me->migrate_index++;
+        count--;
+        if (me->migrate_index == me->old_capacity) {
+            free(me->old_buckets);
+            me->old_buckets = NULL;
+            me->old_capacity = 0;
+            me->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * Rehashes all the keys in the unordered map. Used when storing references and
+ * changing the keys. This should rarely be used.
+ *
+ * @param me the unordered map to rehash
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_map_rehash(unordered_map me)
+{
+    int i;
+    struct node **old_buckets;
+    unordered_map_migrate(me, me->old_capacity);
+    old_buckets = me->buckets;
+    me->buckets = calloc((size_t) me->capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            traverse->hash = unordered_map_hash(me, traverse->key);
+            unordered_map_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/**
+ * Gets the size of the unordered map.
+ *
+ * @param me the unordered map to check
+ *
+ * @return the size of the unordered map
+ */
+int unordered_map_size(unordered_map me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the unordered map is empty.
+ *
+ * @param me the unordered map to check
+ *
+ * @return 1 if the unordered map is empty, otherwise 0
+ */
+int unordered_map_is_empty(unordered_map me)
+{
+    return unordered_map_size(me) == 0;
+}
+
+/*
+ * Changes the amount of buckets of the map and redistributes the nodes.
+ */
+static int unordered_map_resize(unordered_map me, const int new_capacity)
+{
+    int i;
+    const int old_capacity = me->capacity;
+    struct node **old_buckets = me->buckets;
+    unordered_map_migrate(me, me->old_capacity);
+    me->buckets = calloc((size_t) new_capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    me->capacity = new_capacity;
+    me->reseeded = 0;
+    if (me->migrate_step > 0) {
+        me->old_buckets = old_buckets;
+        me->old_capacity = old_capacity;
+        me->migrate_index = 0;
+        return 0;
+    }
+    for (i = 0; i < old_capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_map_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/*
+ * Picks a new seed and redistributes the nodes if a chain has grown longer
+ * than the maximum chain length. This is done at most once between resizes,
+ * since a chain which is still too long after reseeding is made of equal
+ * hashes, which no seed can separate. The nodes are all moved at once, since
+ * the old buckets could not be located with the new seed. The hashes of the
+ * built-in hash functions depend on the seed, so they are computed again. If
+ * no seed can be generated, the chain is left as it is until the next resize.
+ */
+static void unordered_map_check_chain(unordered_map me, const int length)
+{
+    const unsigned long old_seed = me->seed;
+    const int migrate_step = me->migrate_step;
+    unsigned long seed;
+    int rc;
+    if (me->max_chain_length == 0 || length <= me->max_chain_length
+        || me->reseeded) {
+        return;
+    }
+    if (containers_hash_new_seed(&seed, me) != 0) {
+        me->reseeded = 1;
+        return;
+    }
+    unordered_map_migrate(me, me->old_capacity);
+    me->seed = seed;
+    me->migrate_step = 0;
+    if (unordered_map_is_seeded(me)) {
+        rc = unordered_map_rehash(me);
+    } else {
+        rc = unordered_map_resize(me, me->capacity);
+    }
+    if (rc != 0) {
+        me->seed = old_seed;
+    }
+    me->migrate_step = migrate_step;
+    me->reseeded = 1;
+}
+
+/**
+ * Reserves enough buckets for the unordered map to hold the specified amount of
+ * key-value pairs without resizing. If more buckets than needed are already
+ * reserved, then the previous buckets will be kept.
+ *
+ * @param me   the unordered map to reserve buckets for
+ * @param size the amount of key-value pairs to reserve buckets for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if size is negative or too large
+ */
+int unordered_map_reserve(unordered_map me, const int size)
+{
+    const double capacity = size / me->max_load_factor + 1;
+    if (size < 0 || capacity > INT_MAX) {
+        return -EINVAL;
+    }
+    if ((int) capacity <= me->capacity) {
+        return 0;
+    }
+    return unordered_map_resize(me, (int) capacity);
+}
+
+/**
+ * Sets the maximum load factor of the unordered map, which is the ratio of key-
+ * value pairs to buckets at which the buckets are resized. A lower maximum load
+ * factor makes lookups faster at the cost of memory. The default maximum load
+ * factor is 0.75. If the unordered map already exceeds the new maximum load
+ * factor, its buckets are resized right away.
+ *
+ * @param me              the unordered map to change
+ * @param max_load_factor the new maximum load factor; must be more than twice
+ *                        the minimum load factor, and thus positive
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the maximum load factor is out of range
+ */
+int unordered_map_set_max_load_factor(unordered_map me,
+                                      const double max_load_factor)
+{
+    const double old_max_load_factor = me->max_load_factor;
+    int rc;
+    if (!(max_load_factor > 2 * me->min_load_factor)) {
+        return -EINVAL;
+    }
+    me->max_load_factor = max_load_factor;
+    rc = unordered_map_reserve(me, me->size);
+    if (rc != 0) {
+        me->max_load_factor = old_max_load_factor;
+    }
+    return rc;
+}
+
+/**
+ * Sets the minimum load factor of the unordered map, below which the buckets
+ * are shrunk when key-value pairs are removed. The buckets are shrunk so that
+ * the load factor becomes half of the maximum load factor, which is why the
+ * minimum load factor must be less than that, so that the unordered map does
+ * not shrink and grow back repeatedly. The default minimum load factor is zero,
+ * which means that the buckets are never shrunk automatically.
+ *
+ * @param me              the unordered map to change
+ * @param min_load_factor the new minimum load factor; must not be negative,
+ *                        and must be less than half the maximum load factor
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the minimum load factor is out of range
+ */
+int unordered_map_set_min_load_factor(unordered_map me,
+                                      const double min_load_factor)
+{
+    if (!(min_load_factor >= 0 && 2 * min_load_factor < me->max_load_factor)) {
+        return -EINVAL;
+    }
+    me->min_load_factor = min_load_factor;
+    return 0;
+}
+
+/**
+ * Shrinks the buckets of the unordered map to the smallest amount which holds
+ * its key-value pairs without exceeding the maximum load factor. The unordered
+ * map never has fewer than its starting amount of buckets.
+ *
+ * @param me the unordered map to shrink
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_map_shrink_to_fit(unordered_map me)
+{
+    int capacity = (int) (me->size / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity >= me->capacity) {
+        return 0;
+    }
+    return unordered_map_resize(me, capacity);
+}
+
+/*
+ * Shrinks the buckets once the load factor drops below the minimum load factor,
+ * so that the load factor becomes half of the maximum load factor. Since the
+ * unordered map has already been modified, running out of memory is ignored.
+ */
+static void unordered_map_auto_shrink(unordered_map me)
+{
+    int capacity;
+    if (me->size >= me->min_load_factor * me->capacity) {
+        return;
+    }
+    capacity = (int) (2 * me->size / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity < me->capacity) {
+        unordered_map_resize(me, capacity);
+    }
+}
+
+/**
+ * Sets whether the unordered map resizes incrementally. By default, all the
+ * nodes are moved to the new buckets at once when the unordered map resizes, so
+ * the operation which triggers the resize takes time proportional to the size
+ * of the unordered map. When resizing incrementally, the old buckets are kept
+ * alongside the new buckets, and each subsequent put or remove moves the nodes
+ * of up to the specified amount of old buckets, which spreads the cost of the
+ * resize over many operations. If the nodes have not all been moved by the time
+ * the next resize is needed, the rest of them are moved at once, which does not
+ * happen at the default maximum load factor when at least three buckets are
+ * moved per step. Setting the amount to zero turns incremental resizing off and
+ * moves any remaining nodes.
+ *
+ * @param me               the unordered map to change
+ * @param buckets_per_step the amount of old buckets to move per put or
+ *                         remove, or zero to move all the nodes at once
+ *
+ * @return 0       if no error
+ * @return -EINVAL if buckets_per_step is negative
+ */
+int unordered_map_set_incremental_resize(unordered_map me,
+                                         const int buckets_per_step)
+{
+    if (buckets_per_step < 0) {
+        return -EINVAL;
+    }
+    me->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0) {
+        unordered_map_migrate(me, me->old_capacity);
+    }
+    return 0;
+}
+
+/**
+ * Sets the maximum length of a bucket chain. When adding a key makes its chain
+ * longer than this, the unordered map picks a new random seed and redistributes
+ * its keys, which breaks up chains of keys chosen to collide. This is done at
+ * most once between resizes. The chain length guard is disabled by default, and
+ * is disabled again by a maximum chain length of zero.
+ *
+ * @param me               the unordered map to change
+ * @param max_chain_length the maximum length of a chain, or zero to disable
+ *                         the chain length guard
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the maximum chain length is negative
+ */
+int unordered_map_set_max_chain_length(unordered_map me,
+                                       const int max_chain_length)
+{
+    if (max_chain_length < 0) {
+        return -EINVAL;
+    }
+    me->max_chain_length = max_chain_length;
+    return 0;
+}
+
+/*
+ * Determines if an element is equal to the key.
+ */
+static int unordered_map_is_equal(unordered_map me,
+                                  const struct node *const item,
+                                  const unsigned long hash,
+                                  const void *const key)
+{
+    if (item->hash != hash) {
+        return 0;
+    }
+    if (me->bytewise_keys) {
+        return memcmp(item->key, key, me->key_size) == 0;
+    }
+    return me->comparator(item->key, key) == 0;
+}
+
+/*
+ * Creates an element to add.
+ */
+static struct node *unordered_map_create_element(unordered_map me,
+                                                 const unsigned long hash,
+                                                 const void *const key,
+                                                 const void *const value)
+{
+    struct node *const init = malloc(sizeof(struct node));
+    if (!init) {
+        return NULL;
+    }
+    init->key = malloc(me->key_size);
+    if (!init->key) {
+        free(init);
+        return NULL;
+    }
+    memcpy(init->key, key, me->key_size);
+    init->value = malloc(me->value_size);
+    if (!init->value) {
+        free(init->key);
+        free(init);
+        return NULL;
+    }
+    memcpy(init->value, value, me->value_size);
+    init->hash = hash;
+    init->next = NULL;
+    return init;
+}
+
+/*
+ * Adds the key-value pair with the specified hash, or updates the value if the
+ * unordered map already contains the key.
+ */
+static int unordered_map_put_hash(unordered_map me,
+                                  const unsigned long hash,
+                                  const void *const key,
+                                  const void *const value)
+{
+    struct node **bucket;
+    int length = 1;
+    unordered_map_migrate(me, me->migrate_step);
+    if (me->size + 1 >= me->max_load_factor * me->capacity) {
+        const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
+        const int rc = unordered_map_resize(me, new_capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    bucket = unordered_map_bucket(me, hash);
+    if (!*bucket) {
+        *bucket = unordered_map_create_element(me, hash, key, value);
+        if (!*bucket) {
+            return -ENOMEM;
+        }
+    } else {
+        struct node *traverse = *bucket;
+        length++;
+        if (unordered_map_is_equal(me, traverse, hash, key)) {
+            memcpy(traverse->value, value, me->value_size);
+            return 0;
+        }
+        while (traverse->next) {
+            traverse = traverse->next;
+            length++;
+            if (unordered_map_is_equal(me, traverse, hash, key)) {
+                memcpy(traverse->value, value, me->value_size);
+                return 0;
+            }
+        }
+        traverse->next = unordered_map_create_element(me, hash, key, value);
+        if (!traverse->next) {
+            return -ENOMEM;
+        }
+    }
+    me->size++;
+    unordered_map_check_chain(me, length);
+    return 0;
+}
+
+/**
+ * Adds a key-value pair to the unordered map. If the unordered map already
+ * contains the key, the value is updated to the new value. The pointer to the
+ * key and value being passed in should point to the key and value type which
+ * this unordered map holds. For example, if this unordered map holds integer
+ * keys and values, the key and value pointer should be a pointer to an integer.
+ * Since the key and value are being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me    the unordered map to add to
+ * @param key   the key to add
+ * @param value the value to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_map_put(unordered_map me, void *const key, void *const value)
+{
+    return unordered_map_put_hash(me, unordered_map_hash(me, key), key, value);
+}
+
+/**
+ * Gets the value associated with a key in the unordered map. The pointer to the
+ * key being passed in and the value being obtained should point to the key and
+ * value types which this unordered map holds. For example, if this unordered
+ * map holds integer keys and values, the key and value pointers should be a
+ * pointer to an integer. Since the key and value are being copied, the pointer
+ * only has to be valid when this function is called.
+ *
+ * @param value the value to copy to
+ * @param me    the unordered map to get from
+ * @param key   the key to search for
+ *
+ * @return 1 if the unordered map contained the key-value pair, otherwise 0
+ */
+int unordered_map_get(void *const value, unordered_map me, void *const key)
+{
+    const unsigned long hash = unordered_map_hash(me, key);
+    struct node *traverse = *unordered_map_bucket(me, hash);
+    while (traverse) {
+        if (unordered_map_is_equal(me, traverse, hash, key)) {
+            memcpy(value, traverse->value, me->value_size);
+            return 1;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/**
+ * Determines if the unordered map contains the specified key. The pointer to
+ * the key being passed in should point to the key type which this unordered map
+ * holds. For example, if this unordered map holds key integers, the key pointer
+ * should be a pointer to an integer. Since the key is being copied, the pointer
+ * only has to be valid when this function is called.
+ *
+ * @param me  the unordered map to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the unordered map contained the key, otherwise 0
+ */
+int unordered_map_contains(unordered_map me, void *const key)
+{
+    const unsigned long hash = unordered_map_hash(me, key);
+    const struct node *traverse = *unordered_map_bucket(me, hash);
+    while (traverse) {
+        if (unordered_map_is_equal(me, traverse, hash, key)) {
+            return 1;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/**
+ * Removes the key-value pair from the unordered map if it contains it. The
+ * pointer to the key being passed in should point to the key type which this
+ * unordered map holds. For example, if this unordered map holds key integers,
+ * the key pointer should be a pointer to an integer. Since the key is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered map to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the unordered map contained the key, otherwise 0
+ */
+int unordered_map_remove(unordered_map me, void *const key)
+{
+    struct node *traverse;
+    const unsigned long hash = unordered_map_hash(me, key);
+    struct node **bucket;
+    unordered_map_migrate(me, me->migrate_step);
+    bucket = unordered_map_bucket(me, hash);
+    if (!*bucket) {
+        return 0;
+    }
+    traverse = *bucket;
+    if (unordered_map_is_equal(me, traverse, hash, key)) {
+        *bucket = traverse->next;
+        free(traverse->key);
+        free(traverse->value);
+        free(traverse);
+        me->size--;
+        unordered_map_auto_shrink(me);
+        return 1;
+    }
+    while (traverse->next) {
+        if (unordered_map_is_equal(me, traverse->next, hash, key)) {
+            struct node *const backup = traverse->next;
+            traverse->next = traverse->next->next;
+            free(backup->key);
+            free(backup->value);
+            free(backup);
+            me->size--;
+            unordered_map_auto_shrink(me);
+            return 1;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/*
+ * Moves the cursor to the first node in or after its bucket. The new buckets
+ * are scanned first, followed by the old buckets which have not been moved yet.
+ */
+static int unordered_map_cursor_seek(unordered_map me,
+                                     struct unordered_map_cursor *const cursor)
+{
+    for (;;) {
+        struct node **buckets = me->buckets;
+        int capacity = me->capacity;
+        if (cursor->internal_table == 1) {
+            buckets = me->old_buckets;
+            capacity = me->old_capacity;
+        }
+        while (cursor->internal_bucket < capacity) {
+            if (buckets[cursor->internal_bucket]) {
+                cursor->internal_link = &buckets[cursor->internal_bucket];
+                return 1;
+            }
+            cursor->internal_bucket++;
+        }
+        if (cursor->internal_table == 1) {
+            cursor->internal_link = NULL;
+            return 0;
+        }
+        cursor->internal_table = 1;
+        cursor->internal_bucket = me->migrate_index;
+    }
+}
+
+/**
+ * Moves the cursor to the first key-value pair of the unordered map. The key-
+ * value pairs are visited in the order in which they are stored rather than in
+ * any particular order. The cursor is owned by the caller, and remains valid
+ * until the unordered map is modified other than through
+ * unordered_map_cursor_remove.
+ *
+ * @param me     the unordered map to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key-value pair, otherwise 0 if the
+ *         unordered map is empty
+ */
+int unordered_map_first(unordered_map me,
+                        struct unordered_map_cursor *const cursor)
+{
+    cursor->internal_table = 0;
+    cursor->internal_bucket = 0;
+    return unordered_map_cursor_seek(me, cursor);
+}
+
+/**
+ * Moves the cursor to the next key-value pair of the unordered map.
+ *
+ * @param me     the unordered map to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key-value pair, otherwise 0 if there are
+ *         no more key-value pairs
+ */
+int unordered_map_next(unordered_map me,
+                       struct unordered_map_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    if (!link) {
+        return 0;
+    }
+    cursor->internal_link = &(*link)->next;
+    if ((*link)->next) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_map_cursor_seek(me, cursor);
+}
+
+/**
+ * Copies the key and the value at the cursor. Either of the key or the value
+ * may be NULL if it is not needed.
+ *
+ * @param key    the key to copy to, or NULL
+ * @param value  the value to copy to, or NULL
+ * @param me     the unordered map being iterated over
+ * @param cursor the cursor to get from
+ *
+ * @return 1 if the cursor was at a key-value pair, otherwise 0
+ */
+int unordered_map_cursor_get(void *const key,
+                             void *const value,
+                             unordered_map me,
+                             const struct unordered_map_cursor *const cursor)
+{
+    const struct node *item;
+    if (!cursor->internal_link) {
+        return 0;
+    }
+    item = *(struct node **) cursor->internal_link;
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->value, me->value_size);
+    }
+    return 1;
+}
+
+/**
+ * Removes the key-value pair at the cursor from the unordered map, and moves
+ * the cursor to the next key-value pair. Removing through the cursor never
+ * resizes the buckets, so the cursor remains valid.
+ *
+ * @param me     the unordered map to remove from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at a key-value pair after the removal, otherwise 0
+ */
+int unordered_map_cursor_remove(unordered_map me,
+                                struct unordered_map_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    struct node *item;
+    if (!link) {
+        return 0;
+    }
+    item = *link;
+    *link = item->next;
+    free(item->key);
+    free(item->value);
+    free(item);
+    me->size--;
+    if (*link) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_map_cursor_seek(me, cursor);
+}
+
+/*
+ * Gets the hash which a node of another unordered map has in this unordered
+ * map. The stored hash is reused if both use the same hash function, so that
+ * the hash function is not called again. The hashes of the built-in hash
+ * functions are only reused if both also have the same seed, which is cheap
+ * since they are inlined.
+ */
+static unsigned long unordered_map_hash_node(unordered_map me,
+                                             unordered_map other,
+                                             const struct node *const item)
+{
+    if (me->hash == other->hash
+        && (me->seed == other->seed || !unordered_map_is_seeded(me))) {
+        return item->hash;
+    }
+    return unordered_map_hash(me, item->key);
+}
+
+/**
+ * Adds every key-value pair of the other unordered map to the unordered map. If
+ * the unordered map already contains a key, its value is updated to the value
+ * in the other unordered map, just like unordered_map_put. The buckets are
+ * reserved once up front for the keys of both, and the stored hashes are
+ * reused if both have the same hash function, so the hash function is not
+ * called for them. The unordered maps must have the same key size, value size,
+ * and comparator function. If an error occurs, some of the key-value pairs may
+ * already have been added.
+ *
+ * @param me    the unordered map to add to
+ * @param other the unordered map whose key-value pairs to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the key or value sizes do not match
+ */
+int unordered_map_merge(unordered_map me, unordered_map other)
+{
+    struct unordered_map_cursor cursor;
+    int more;
+    int rc;
+    if (me->key_size != other->key_size
+        || me->value_size != other->value_size) {
+        return -EINVAL;
+    }
+    if (me == other) {
+        return 0;
+    }
+    if (me->size > INT_MAX - other->size) {
+        return -EINVAL;
+    }
+    rc = unordered_map_reserve(me, me->size + other->size);
+    if (rc != 0) {
+        return rc;
+    }
+    for (more = unordered_map_first(other, &cursor); more;
+         more = unordered_map_next(other, &cursor)) {
+        const struct node *const item = *(struct node **) cursor.internal_link;
+        const unsigned long hash = unordered_map_hash_node(me, other, item);
+        rc = unordered_map_put_hash(me, hash, item->key, item->value);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the whole buffer to the file descriptor, retrying partial writes.
+ */
+static int unordered_map_write_all(const int fd,
+                                   const void *const data,
+                                   size_t size)
+{
+    const char *position = data;
+    while (size > 0) {
+        const ssize_t written = write(fd, position, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -EIO;
+        }
+        position += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+
+/*
+ * Fills the whole buffer from the file descriptor, retrying partial reads.
+ */
+static int unordered_map_read_all(const int fd, void *const data, size_t size)
+{
+    char *position = data;
+    while (size > 0) {
+        const ssize_t got = read(fd, position, size);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return -EIO;
+        }
+        position += got;
+        size -= (size_t) got;
+    }
+    return 0;
+}
+
+/*
+ * Grows the buckets while a snapshot is loaded, once the pairs which have been
+ * read so far would not fit. The buckets are sized for twice as many, up to the
+ * count of the header, so that a whole snapshot takes few resizes, while a
+ * corrupt count cannot reserve more buckets than the snapshot has pairs.
+ */
+static int unordered_map_load_reserve(unordered_map me,
+                                      const unsigned long needed,
+                                      const unsigned long count)
+{
+    unsigned long size = 2 * needed;
+    if (needed / me->max_load_factor + 1 <= me->capacity) {
+        return 0;
+    }
+    if (size > count) {
+        size = count;
+    }
+    return unordered_map_reserve(me, (int) size);
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the unordered map to a file descriptor. The
+ * snapshot consists of a header, which holds the key size, the value size, and
+ * the amount of key-value pairs, followed by the stored hash, the key, and the
+ * value of each pair. The hash seed is not written, so that it never leaves the
+ * process. Thus, loading the snapshot hashes the keys again if they use a
+ * built-in hash function. Since the keys and values are copied byte for byte,
+ * they should not contain pointers unless the snapshot is loaded by the same
+ * process.
+ *
+ * @param me the unordered map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int unordered_map_save(unordered_map me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size =
+            sizeof(unsigned long) + me->key_size + me->value_size;
+    size_t buffer_size = SNAPSHOT_BUFFER_SIZE;
+    size_t used = 0;
+    char *buffer;
+    int rc;
+    int i;
+    unordered_map_migrate(me, me->old_capacity);
+    if (record_size > buffer_size) {
+        buffer_size = record_size;
+    }
+    buffer = malloc(buffer_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    header.count = (unsigned long) me->size;
+    rc = unordered_map_write_all(fd, &header, sizeof(struct snapshot_header));
+    for (i = 0; rc == 0 && i < me->capacity; i++) {
+        const struct node *traverse = me->buckets[i];
+        while (rc == 0 && traverse) {
+            if (used + record_size > buffer_size) {
+                rc = unordered_map_write_all(fd, buffer, used);
+                used = 0;
+            }
+            memcpy(buffer + used, &traverse->hash, sizeof(unsigned long));
+            used += sizeof(unsigned long);
+            memcpy(buffer + used, traverse->key, me->key_size);
+            used += me->key_size;
+            memcpy(buffer + used, traverse->value, me->value_size);
+            used += me->value_size;
+            traverse = traverse->next;
+        }
+    }
+    if (rc == 0) {
+        rc = unordered_map_write_all(fd, buffer, used);
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by unordered_map_save into an empty
+ * unordered map. The comparator is never called, since the keys of a snapshot
+ * are already distinct. The seed is not in the snapshot, so a fresh seed is
+ * picked. The stored hashes of a user-defined hash function do not depend on
+ * the seed, so they are reused without calling it. The built-in hash functions
+ * do depend on the seed, so each key is hashed again with the fresh seed. The
+ * buckets grow as the key-value pairs are read, rather than being sized from
+ * the count in the header, so that a corrupt count cannot reserve more buckets
+ * than the snapshot holds. Thus, the unordered map must have been initialized
+ * with the same key size, value size, and hash function as the unordered map
+ * which was saved. If an error occurs part of the way through the snapshot, the
+ * key-value pairs which have already been loaded remain in the unordered map.
+ *
+ * @param me the unordered map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered map is not empty or the snapshot does not
+ *                 match the unordered map
+ * @return -EIO    if the snapshot or the random bytes of the operating system
+ *                 could not be read
+ */
+int unordered_map_load(unordered_map me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size =
+            sizeof(unsigned long) + me->key_size + me->value_size;
+    size_t batch_size = SNAPSHOT_BUFFER_SIZE / record_size;
+    unsigned long remaining;
+    char *buffer;
+    int rc;
+    if (me->size != 0) {
+        return -EINVAL;
+    }
+    rc = unordered_map_read_all(fd, &header, sizeof(struct snapshot_header));
+    if (rc != 0) {
+        return rc;
+    }
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION
+        || header.key_size != (unsigned long) me->key_size
+        || header.value_size != (unsigned long) me->value_size
+        || header.count > INT_MAX) {
+        return -EINVAL;
+    }
+    rc = containers_hash_new_seed(&me->seed, me);
+    if (rc != 0) {
+        return rc;
+    }
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+    buffer = malloc(batch_size * record_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    remaining = header.count;
+    while (remaining > 0) {
+        const char *record = buffer;
+        size_t batch = batch_size;
+        if (batch > remaining) {
+            batch = remaining;
+        }
+        rc = unordered_map_read_all(fd, buffer, batch * record_size);
+        if (rc != 0) {
+            break;
+        }
+        remaining -= batch;
+        rc = unordered_map_load_reserve(me, me->size + batch, header.count);
+        if (rc != 0) {
+            break;
+        }
+        for (; batch > 0; batch--) {
+            const char *const key = record + sizeof(unsigned long);
+            unsigned long hash;
+            struct node *add;
+            struct node **bucket;
+            memcpy(&hash, record, sizeof(unsigned long));
+            if (unordered_map_is_seeded(me)) {
+                hash = unordered_map_hash(me, key);
+            }
+            add = unordered_map_create_element(me, hash, key,
+                                               key + me->key_size);
+            if (!add) {
+                free(buffer);
+                return -ENOMEM;
+            }
+            bucket = unordered_map_bucket(me, hash);
+            add->next = *bucket;
+            *bucket = add;
+            me->size++;
+            record += record_size;
+        }
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the key-value pairs from the unordered map.
+ *
+ * @param me the unordered map to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_map_clear(unordered_map me)
+{
+    int i;
+    struct node **temp =
+            calloc((size_t) STARTING_BUCKETS, sizeof(struct node *));
+    if (!temp) {
+        return -ENOMEM;
+    }
+    unordered_map_migrate(me, me->old_capacity);
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = me->buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse;
+            traverse = traverse->next;
+            free(backup->key);
+            free(backup->value);
+            free(backup);
+        }
+        me->buckets[i] = NULL;
+    }
+    me->size = 0;
+    me->capacity = STARTING_BUCKETS;
+    free(me->buckets);
+    me->buckets = temp;
+    return 0;
+}
+
+/**
+ * Frees the unordered map memory. Performing further operations after calling
+ * this function results in undefined behavior.
+ *
+ * @param me the unordered map to free from memory
+ *
+ * @return NULL
+ */
+unordered_map unordered_map_destroy(unordered_map me)
+{
+    unordered_map_clear(me);
+    free(me->buckets);
+    free(me);
+    return NULL;
+}
+#undef RESIZE_AT
+#undef RESIZE_RATIO
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef STARTING_BUCKETS
+#undef node
+#undef snapshot_header
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define RESIZE_AT unordered_multimap_RESIZE_AT
+#define RESIZE_RATIO unordered_multimap_RESIZE_RATIO
+#define SNAPSHOT_BUFFER_SIZE unordered_multimap_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC unordered_multimap_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION unordered_multimap_SNAPSHOT_VERSION
+#define STARTING_BUCKETS unordered_multimap_STARTING_BUCKETS
+#define node unordered_multimap_node
+#define snapshot_header unordered_multimap_snapshot_header
+#define snapshot_stream unordered_multimap_snapshot_stream
+static const int STARTING_BUCKETS = 8;
+static const double RESIZE_AT = 0.75;
+static const double RESIZE_RATIO = 1.5;
+static const char SNAPSHOT_MAGIC[8] = "CNTRHASH";
+static const unsigned long SNAPSHOT_VERSION = 3;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_unordered_multimap {
+    size_t key_size;
+    size_t value_size;
+    unsigned long (*hash)(const void *const key);
+    int (*key_comparator)(const void *const one, const void *const two);
+    int bytewise_keys;
+    int (*value_comparator)(const void *const one, const void *const two);
+    int size;
+    int key_count;
+    int capacity;
+    double max_load_factor;
+    double min_load_factor;
+    struct node **buckets;
+    int migrate_step;
+    int migrate_index;
+    int old_capacity;
+    struct node **old_buckets;
+    unsigned long seed;
+    int max_chain_length;
+    int reseeded;
+    struct unordered_multimap_values iterate;
+};
+
+/*
+ * Each distinct key has a single node, which stores all the values of the key
+ * contiguously in insertion order. Thus, the bucket chains only grow with the
+ * amount of distinct keys, and the values of a key are read sequentially.
+ */
+struct node {
+    void *key;
+    unsigned long hash;
+    int value_count;
+    int value_capacity;
+    char *values;
+    struct node *next;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header, one
+ * for each distinct key, each of which is the stored hash and the value count
+ * followed by the key and the values.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
+/*
+ * Mixes all the bits of the value. This is the same mixer as the one used by
+ * the built-in integer hash functions, so that they can be inlined.
+ */
+static unsigned long unordered_multimap_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Gets the hash of the key. The built-in hash functions are already
+ * well-distributed, so they are inlined or called directly, with the seed fed
+ * into them, so that keys which collide under one seed do not collide under
+ * another. Otherwise, the user-defined hash is called, and then a second hash
+ * is used to prevent hashing clusters if the user-defined hash is sub-optimal.
+ */
+static unsigned long unordered_multimap_hash(unordered_multimap me,
+                                             const void *const key)
+{
+    unsigned long hash;
+    if (me->hash == containers_hash_int) {
+        int value;
+        memcpy(&value, key, sizeof(int));
+        return unordered_multimap_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_long) {
+        long value;
+        memcpy(&value, key, sizeof(long));
+        return unordered_multimap_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_key) {
+        return containers_hash_bytes_seeded(key, me->key_size, me->seed);
+    }
+    if (me->hash == containers_hash_string) {
+        const char *string;
+        memcpy(&string, key, sizeof(char *));
+        return containers_hash_bytes_seeded(string, strlen(string), me->seed);
+    }
+    hash = me->hash(key);
+    hash ^= (hash >> 20UL) ^ (hash >> 12UL);
+    return hash ^ (hash >> 7UL) ^ (hash >> 4UL);
+}
+
+/*
+ * Determines whether the stored hashes depend on the seed, which they do for
+ * the built-in hash functions. The hashes of a user-defined hash function do
+ * not, so only their buckets change with the seed.
+ */
+static int unordered_multimap_is_seeded(unordered_multimap me)
+{
+    return me->hash == containers_hash_int || me->hash == containers_hash_long
+           || me->hash == containers_hash_key
+           || me->hash == containers_hash_string;
+}
+
+/*
+ * Determines whether two keys are equal exactly when their bytes are equal.
+ */
+static int unordered_multimap_is_bytewise(unordered_multimap me)
+{
+    return CONTAINERS_COMPARE_IS_BYTEWISE(me->key_comparator, me->key_size);
+}
+
+/*
+ * Compares two values.
+ */
+static int unordered_multimap_compare_values(unordered_multimap me,
+                                             const void *const one,
+                                             const void *const two)
+{
+    return CONTAINERS_COMPARE(me->value_comparator, me->value_size, one, two);
+}
+
+/**
+ * Initializes an unordered multi-map.
+ *
+ * @param key_size         the size of each key in the unordered multi-map; must
+ *                         be positive
+ * @param value_size       the size of each value in the unordered multi-map;
+ *                         must be positive
+ * @param hash             the hash function which computes the hash from the
+ *                         key; must not be NULL; may be one of the built-in
+ *                         hash functions from hash.h
+ * @param key_comparator   the comparator function which compares two keys; must
+ *                         not be NULL; may be one of the built-in comparators
+ *                         from compare.h
+ * @param value_comparator the comparator function which compares two values;
+ *                         must not be NULL
+ *
+ * @return the newly-initialized unordered multi-map, or NULL if it was not
+ *         successfully initialized due to invalid input arguments, memory
+ *         allocation error, or the random bytes of the operating system not
+ *         being readable
+ */
+unordered_multimap
+unordered_multimap_init(const size_t key_size,
+                        const size_t value_size,
+                        unsigned long (*hash)(const void *const),
+                        int (*key_comparator)(const void *const,
+                                              const void *const),
+                        int (*value_comparator)(const void *const,
+                                                const void *const))
+{
+    struct internal_unordered_multimap *init;
+    if (key_size == 0 || value_size == 0
+        || !hash || !key_comparator || !value_comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_unordered_multimap));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->value_size = value_size;
+    init->hash = hash;
+    init->key_comparator = key_comparator;
+    init->bytewise_keys = unordered_multimap_is_bytewise(init);
+    init->value_comparator = value_comparator;
+    init->size = 0;
+    init->key_count = 0;
+    init->capacity = STARTING_BUCKETS;
+    init->max_load_factor = RESIZE_AT;
+    init->min_load_factor = 0;
+    init->migrate_step = 0;
+    init->migrate_index = 0;
+    init->old_capacity = 0;
+    init->old_buckets = NULL;
+    if (containers_hash_new_seed(&init->seed, init) != 0) {
+        free(init);
+        return NULL;
+    }
+    init->max_chain_length = 0;
+    init->reseeded = 0;
+    init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
+    if (!init->buckets) {
+        free(init);
+        return NULL;
+    }
+    init->iterate.internal_values = NULL;
+    init->iterate.internal_count = 0;
+    init->iterate.internal_index = 0;
+    return init;
+}
+
+/*
+ * Gets the index of the bucket which holds the hash. The hash is mixed with the
+ * seed first, so that keys chosen to collide in the buckets of one unordered
+ * container are spread out in any other.
+ */
+static int unordered_multimap_index(unordered_multimap me,
+                                    const unsigned long hash,
+                                    const int capacity)
+{
+    const unsigned long mixed = unordered_multimap_mix(hash ^ me->seed);
+    return (int) (mixed % (unsigned long) capacity);
+}
+
+/*
+ * Adds the specified node to the multi-map.
+ */
+static void unordered_multimap_add_item(unordered_multimap me,
+                                        struct node *const add)
+{
+    const int index = unordered_multimap_index(me, add->hash, me->capacity);
+    add->next = me->buckets[index];
+    me->buckets[index] = add;
+}
+
+/*
+ * Gets the bucket which holds the nodes with the specified hash. While the
+ * nodes are being moved to the new buckets, the old buckets which have not
+ * been moved yet still hold their nodes.
+ */
+static struct node **unordered_multimap_bucket(unordered_multimap me,
+                                               const unsigned long hash)
+{
+    if (me->old_buckets) {
+        const int old_index =
+                unordered_multimap_index(me, hash, me->old_capacity);
+        if (old_index >= me->migrate_index) {
+            return &me->old_buckets[old_index];
+        }
+    }
+    return &me->buckets[unordered_multimap_index(me, hash, me->capacity)];
+}
+
+/*
+ * Moves the nodes of up to count old buckets to the new buckets, and frees the
+ * old buckets once all of their nodes have been moved.
+ */
+static void unordered_multimap_migrate(unordered_multimap me, int count)
+{
+    while (me->old_buckets && count > 0) {
+        struct node *traverse = me->old_buckets[me->migrate_index];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_multimap_add_item(me, traverse);
+            traverse = backup;
+        }
+        me->migrate_index++;
+        count--;
+        if (me->migrate_index == me->old_capacity) {
+            free(me->old_buckets);
+            me->old_buckets = NULL;
+            me->old_capacity = 0;
+            me->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * Rehashes all the keys in the unordered multi-map. Used when storing
+ * references and changing the keys. This should rarely be used.
+ *
+ * @param me the unordered multi-map to rehash
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multimap_rehash(unordered_multimap me)
+{
+    int i;
+    struct node **old_buckets;
+    unordered_multimap_migrate(me, me->old_capacity);
+    old_buckets = me->buckets;
+    me->buckets = calloc((size_t) me->capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            traverse->hash = unordered_multimap_hash(me, traverse->key);
+            unordered_multimap_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/**
+ * Gets the size of the unordered multi-map.
+ *
+ * @param me the unordered multi-map to check
+ *
+ * @return the size of the unordered multi-map
+ */
+int unordered_multimap_size(unordered_multimap me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the unordered multi-map is empty.
+ *
+ * @param me the unordered multi-map to check
+ *
+ * @return 1 if the unordered multi-map is empty, otherwise 0
+ */
+int unordered_multimap_is_empty(unordered_multimap me)
+{
+    return unordered_multimap_size(me) == 0;
+}
+
+/*
+ * Changes the amount of buckets of the multi-map and redistributes the nodes.
+ */
+static int unordered_multimap_resize(unordered_multimap me,
+                                     const int new_capacity)
+{
+    int i;
+    const int old_capacity = me->capacity;
+    struct node **old_buckets = me->buckets;
+    unordered_multimap_migrate(me, me->old_capacity);
+    me->buckets = calloc((size_t) new_capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    me->capacity = new_capacity;
+    me->reseeded = 0;
+    if (me->migrate_step > 0) {
+        me->old_buckets = old_buckets;
+        me->old_capacity = old_capacity;
+        me->migrate_index = 0;
+        return 0;
+    }
+    for (i = 0; i < old_capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_multimap_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/*
+ * Picks a new seed and redistributes the nodes if a chain has grown longer
+ * than the maximum chain length. This is done at most once between resizes,
+ * since a chain which is still too long after reseeding is made of equal
+ * hashes, which no seed can separate. The nodes are all moved at once, since
+ * the old buckets could not be located with the new seed. The hashes of the
+ * built-in hash functions depend on the seed, so they are computed again. If
+ * no seed can be generated, the chain is left as it is until the next resize.
+ */
+static void unordered_multimap_check_chain(unordered_multimap me,
+                                           const int length)
+{
+    const unsigned long old_seed = me->seed;
+    const int migrate_step = me->migrate_step;
+    unsigned long seed;
+    int rc;
+    if (me->max_chain_length == 0 || length <= me->max_chain_length
+        || me->reseeded) {
+        return;
+    }
+    if (containers_hash_new_seed(&seed, me) != 0) {
+        me->reseeded = 1;
+        return;
+    }
+    unordered_multimap_migrate(me, me->old_capacity);
+    me->seed = seed;
+    me->migrate_step = 0;
+    if (unordered_multimap_is_seeded(me)) {
+        rc = unordered_multimap_rehash(me);
+    } else {
+        rc = unordered_multimap_resize(me, me->capacity);
+    }
+    if (rc != 0) {
+        me->seed = old_seed;
+    }
+    me->migrate_step = migrate_step;
+    me->reseeded = 1;
+}
+
+/**
+ * Reserves enough buckets for the unordered multi-map to hold the specified
+ * amount of distinct keys without resizing. If more buckets than needed are
+ * already reserved, then the previous buckets will be kept.
+ *
+ * @param me   the unordered multi-map to reserve buckets for
+ * @param size the amount of distinct keys to reserve buckets for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if size is negative or too large
+ */
+int unordered_multimap_reserve(unordered_multimap me, const int size)
+{
+    const double capacity = size / me->max_load_factor + 1;
+    if (size < 0 || capacity > INT_MAX) {
+        return -EINVAL;
+    }
+    if ((int) capacity <= me->capacity) {
+        return 0;
+    }
+    return unordered_multimap_resize(me, (int) capacity);
+}
+
+/**
+ * Sets the maximum load factor of the unordered multi-map, which is the ratio
+ * of distinct keys to buckets at which the buckets are resized. A lower
+ * maximum load factor makes lookups faster at the cost of memory. The default
+ * maximum load factor is 0.75. If the unordered multi-map already exceeds the
+ * new maximum load factor, its buckets are resized right away.
+ *
+ * @param me              the unordered multi-map to change
+ * @param max_load_factor the new maximum load factor; must be more than twice
+ *                        the minimum load factor, and thus positive
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the maximum load factor is out of range
+ */
+int unordered_multimap_set_max_load_factor(unordered_multimap me,
+                                           const double max_load_factor)
+{
+    const double old_max_load_factor = me->max_load_factor;
+    int rc;
+    if (!(max_load_factor > 2 * me->min_load_factor)) {
+        return -EINVAL;
+    }
+    me->max_load_factor = max_load_factor;
+    rc = unordered_multimap_reserve(me, me->key_count);
+    if (rc != 0) {
+        me->max_load_factor = old_max_load_factor;
+    }
+    return rc;
+}
+
+/**
+ * Sets the minimum load factor of the unordered multi-map, below which the
+ * buckets are shrunk when keys are removed. The buckets are shrunk
+ * so that the load factor becomes half of the maximum load factor, which is why
+ * the minimum load factor must be less than that, so that the unordered multi-
+ * map does not shrink and grow back repeatedly. The default minimum load factor
+ * is zero, which means that the buckets are never shrunk automatically.
+ *
+ * @param me              the unordered multi-map to change
+ * @param min_load_factor the new minimum load factor; must not be negative,
+ *                        and must be less than half the maximum load factor
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the minimum load factor is out of range
+ */
+int unordered_multimap_set_min_load_factor(unordered_multimap me,
+                                           const double min_load_factor)
+{
+    if (!(min_load_factor >= 0 && 2 * min_load_factor < me->max_load_factor)) {
+        return -EINVAL;
+    }
+    me->min_load_factor = min_load_factor;
+    return 0;
+}
+
+/**
+ * Shrinks the buckets of the unordered multi-map to the smallest amount which
+ * holds its distinct keys without exceeding the maximum load factor. The
+ * unordered multi-map never has fewer than its starting amount of buckets.
+ *
+ * @param me the unordered multi-map to shrink
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multimap_shrink_to_fit(unordered_multimap me)
+{
+    int capacity = (int) (me->key_count / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity >= me->capacity) {
+        return 0;
+    }
+    return unordered_multimap_resize(me, capacity);
+}
+
+/*
+ * Shrinks the buckets once the load factor drops below the minimum load factor,
+ * so that the load factor becomes half of the maximum load factor. Since the
+ * unordered multi-map has already been modified, running out of memory is
+ * ignored.
+ */
+static void unordered_multimap_auto_shrink(unordered_multimap me)
+{
+    int capacity;
+    if (me->key_count >= me->min_load_factor * me->capacity) {
+        return;
+    }
+    capacity = (int) (2 * me->key_count / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity < me->capacity) {
+        unordered_multimap_resize(me, capacity);
+    }
+}
+
+/**
+ * Sets whether the unordered multi-map resizes incrementally. By default, all
+ * the nodes are moved to the new buckets at once when the unordered multi-map
+ * resizes, so the operation which triggers the resize takes time proportional
+ * to the size of the unordered multi-map. When resizing incrementally, the old
+ * buckets are kept alongside the new buckets, and each subsequent put or remove
+ * moves the nodes of up to the specified amount of old buckets, which spreads
+ * the cost of the resize over many operations. If the nodes have not all been
+ * moved by the time the next resize is needed, the rest of them are moved at
+ * once, which does not happen at the default maximum load factor when at least
+ * three buckets are moved per step. Setting the amount to zero turns
+ * incremental resizing off and moves any remaining nodes.
+ *
+ * @param me               the unordered multi-map to change
+ * @param buckets_per_step the amount of old buckets to move per put or
+ *                         remove, or zero to move all the nodes at once
+ *
+ * @return 0       if no error
+ * @return -EINVAL if buckets_per_step is negative
+ */
+int unordered_multimap_set_incremental_resize(unordered_multimap me,
+                                              const int buckets_per_step)
+{
+    if (buckets_per_step < 0) {
+        return -EINVAL;
+    }
+    me->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0) {
+        unordered_multimap_migrate(me, me->old_capacity);
+    }
+    return 0;
+}
+
+/**
+ * Sets the maximum length of a bucket chain. When adding a key makes its chain
+ * longer than this, the unordered multi-map picks a new random seed and
+ * redistributes its keys, which breaks up chains of keys chosen to collide.
+ * This is done at most once between resizes. The chain length guard is disabled
+ * by default, and is disabled again by a maximum chain length of zero.
+ *
+ * @param me               the unordered multi-map to change
+ * @param max_chain_length the maximum length of a chain, or zero to disable
+ *                         the chain length guard
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the maximum chain length is negative
+ */
+int unordered_multimap_set_max_chain_length(unordered_multimap me,
+                                            const int max_chain_length)
+{
+    if (max_chain_length < 0) {
+        return -EINVAL;
+    }
+    me->max_chain_length = max_chain_length;
+    return 0;
+}
+
+/*
+ * Determines if an element is equal to the key.
+ */
+static int unordered_multimap_is_equal(unordered_multimap me,
+                                       const struct node *const item,
+                                       const unsigned long hash,
+                                       const void *const key)
+{
+    if (item->hash != hash) {
+        return 0;
+    }
+    if (me->bytewise_keys) {
+        return memcmp(item->key, key, me->key_size) == 0;
+    }
+    return me->key_comparator(item->key, key) == 0;
+}
+
+/*
+ * Creates an element to add, which holds the key and has room for the specified
+ * amount of values.
+ */
+static struct node *unordered_multimap_create_element(unordered_multimap me,
+                                                      const unsigned long hash,
+                                                      const void *const key,
+                                                      const int capacity)
+{
+    struct node *const init = malloc(sizeof(struct node));
+    if (!init) {
+        return NULL;
+    }
+    init->key = malloc(me->key_size);
+    if (!init->key) {
+        free(init);
+        return NULL;
+    }
+    memcpy(init->key, key, me->key_size);
+    init->values = malloc(capacity * me->value_size);
+    if (!init->values) {
+        free(init->key);
+        free(init);
+        return NULL;
+    }
+    init->hash = hash;
+    init->value_count = 0;
+    init->value_capacity = capacity;
+    init->next = NULL;
+    return init;
+}
+
+/*
+ * Frees an element along with its key and values.
+ */
+static void unordered_multimap_free_element(struct node *const item)
+{
+    free(item->values);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Resizes the array which holds the values of a key.
+ */
+static int unordered_multimap_resize_values(unordered_multimap me,
+                                            struct node *const item,
+                                            const int capacity)
+{
+    char *const temp = realloc(item->values, capacity * me->value_size);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    item->values = temp;
+    item->value_capacity = capacity;
+    return 0;
+}
+
+/*
+ * Appends a value to the values of a key, doubling the capacity of the array
+ * when it is full.
+ */
+static int unordered_multimap_append_value(unordered_multimap me,
+                                           struct node *const item,
+                                           const void *const value)
+{
+    if (item->value_count == item->value_capacity) {
+        const int capacity = 2 * item->value_capacity;
+        const int rc = unordered_multimap_resize_values(me, item, capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    memcpy(item->values + item->value_count * me->value_size, value,
+           me->value_size);
+    item->value_count++;
+    me->size++;
+    return 0;
+}
+
+/*
+ * Removes the value at the specified index of a key, keeping the rest of the
+ * values in order. The array is halved once it is a quarter full, and running
+ * out of memory while doing so is ignored.
+ */
+static void unordered_multimap_remove_value(unordered_multimap me,
+                                            struct node *const item,
+                                            const int index)
+{
+    char *const position = item->values + index * me->value_size;
+    memmove(position, position + me->value_size,
+            (item->value_count - index - 1) * me->value_size);
+    item->value_count--;
+    me->size--;
+    if (item->value_count > 0
+        && item->value_count <= item->value_capacity / 4) {
+        unordered_multimap_resize_values(me, item, item->value_capacity / 2);
+    }
+}
+
+/*
+ * Gets the link which points to the node of the key, or to the end of the
+ * bucket chain if the unordered multi-map does not contain the key.
+ */
+static struct node **unordered_multimap_find(unordered_multimap me,
+                                             const unsigned long hash,
+                                             const void *const key)
+{
+    struct node **link = unordered_multimap_bucket(me, hash);
+    while (*link && !unordered_multimap_is_equal(me, *link, hash, key)) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+/**
+ * Adds a key-value pair to the unordered multi-map. The pointer to the key and
+ * value being passed in should point to the key and value type which this
+ * unordered multi-map holds. For example, if this unordered multi-map holds
+ * integer keys and values, the key and value pointer should be a pointer to an
+ * integer. Since the key and value are being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me    the unordered multi-map to add to
+ * @param key   the key to add
+ * @param value the value to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multimap_put(unordered_multimap me,
+                           void *const key,
+                           void *const value)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    struct node **bucket;
+    struct node *traverse;
+    int length = 1;
+    unordered_multimap_migrate(me, me->migrate_step);
+    if (me->key_count + 1 >= me->max_load_factor * me->capacity) {
+        const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
+        const int rc = unordered_multimap_resize(me, new_capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    bucket = unordered_multimap_bucket(me, hash);
+    for (traverse = *bucket; traverse; traverse = traverse->next) {
+        if (unordered_multimap_is_equal(me, traverse, hash, key)) {
+            return unordered_multimap_append_value(me, traverse, value);
+        }
+        length++;
+    }
+    traverse = unordered_multimap_create_element(me, hash, key, 1);
+    if (!traverse) {
+        return -ENOMEM;
+    }
+    traverse->next = *bucket;
+    *bucket = traverse;
+    me->key_count++;
+    unordered_multimap_append_value(me, traverse, value);
+    unordered_multimap_check_chain(me, length);
+    return 0;
+}
+
+/**
+ * Creates the iterator for the specified key. To iterate over the values, keep
+ * getting the next value. Since the iterator is kept in the unordered
+ * multi-map, only one iteration may be in progress at a time, which
+ * unordered_multimap_values_start avoids. Between starting and iterations, the
+ * unordered multi-map must not be mutated. The pointer to the key being passed
+ * in should point to the key type which this unordered multi-map holds. For
+ * example, if this unordered multi-map holds key integers, the key pointer
+ * should be a pointer to an integer. Since the key is being copied, the pointer
+ * only has to be valid when this function is called.
+ *
+ * @param me  the unordered multi-map to start the iterator for
+ * @param key the key to start the iterator for
+ */
+void unordered_multimap_get_start(unordered_multimap me, void *const key)
+{
+    unordered_multimap_values_start(me, &me->iterate, key);
+}
+
+/**
+ * Iterates over the values for the specified key. Must be called after starting
+ * the iterator. The unordered multi-map must not be mutated between start and
+ * iterations. The pointer to the value being obtained should point to the value
+ * type which this unordered multi-map holds. For example, if this unordered
+ * multi-map holds value integers, the value pointer should be a pointer to an
+ * integer. Since the value is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param value the value to be copied to from iteration
+ * @param me    the unordered multi-map to iterate over
+ *
+ * @return 1 if there exist no more values for the key which is being iterated
+ *         over, otherwise 0
+ */
+int unordered_multimap_get_next(void *const value, unordered_multimap me)
+{
+    return unordered_multimap_values_next(value, me, &me->iterate);
+}
+
+/**
+ * Starts iterating over the values for the specified key with a cursor which is
+ * owned by the caller. Unlike unordered_multimap_get_start, this does not
+ * modify the unordered multi-map, so several iterations may be in progress at
+ * the same time, including from different threads as long as none of them
+ * mutates the unordered multi-map. The cursor is only valid until the unordered
+ * multi-map is next mutated. The pointer to the key being passed in should
+ * point to the key type which this unordered multi-map holds.
+ *
+ * @param me     the unordered multi-map to iterate over
+ * @param cursor the cursor to start
+ * @param key    the key to iterate over the values of
+ *
+ * @return the number of values for the key
+ */
+int
+unordered_multimap_values_start(unordered_multimap me,
+                                struct unordered_multimap_values *const cursor,
+                                void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    const struct node *const item = *unordered_multimap_find(me, hash, key);
+    cursor->internal_index = 0;
+    if (!item) {
+        cursor->internal_values = NULL;
+        cursor->internal_count = 0;
+        return 0;
+    }
+    cursor->internal_values = item->values;
+    cursor->internal_count = item->value_count;
+    return item->value_count;
+}
+
+/**
+ * Copies the next value of the cursor, and advances the cursor. The pointer to
+ * the value being obtained should point to the value type which this unordered
+ * multi-map holds.
+ *
+ * @param value  the value to be copied to
+ * @param me     the unordered multi-map being iterated over
+ * @param cursor the cursor to advance
+ *
+ * @return 1 if a value was copied, otherwise 0 if there are no more values
+ */
+int
+unordered_multimap_values_next(void *const value,
+                               unordered_multimap me,
+                               struct unordered_multimap_values *const cursor)
+{
+    const char *item;
+    if (cursor->internal_index == cursor->internal_count) {
+        return 0;
+    }
+    item = cursor->internal_values;
+    memcpy(value, item + cursor->internal_index * me->value_size,
+           me->value_size);
+    cursor->internal_index++;
+    return 1;
+}
+
+/**
+ * Gets all the values for the specified key at once. The values are stored
+ * contiguously in the order in which they were added, so the span may be read
+ * directly as an array of the value type which this unordered multi-map holds.
+ * The span is owned by the unordered multi-map, and is only valid until the
+ * unordered multi-map is next mutated. The pointer to the key being passed in
+ * should point to the key type which this unordered multi-map holds.
+ *
+ * @param values the pointer to set to the start of the values, or to NULL if
+ *               the unordered multi-map does not contain the key
+ * @param me     the unordered multi-map to get the values from
+ * @param key    the key to get the values for
+ *
+ * @return the number of values in the span
+ */
+int unordered_multimap_get_values(void **const values,
+                                  unordered_multimap me,
+                                  void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    struct node *const item = *unordered_multimap_find(me, hash, key);
+    if (!item) {
+        *values = NULL;
+        return 0;
+    }
+    *values = item->values;
+    return item->value_count;
+}
+
+/**
+ * Determines the number of times the key appears in the unordered multi-map.
+ * The pointer to the key being passed in should point to the key type which
+ * this unordered multi-map holds. For example, if this unordered multi-map
+ * holds key integers, the key pointer should be a pointer to an integer. Since
+ * the key is being copied, the pointer only has to be valid when this function
+ * is called.
+ *
+ * @param me  the unordered multi-map to check for the key
+ * @param key the key to check
+ *
+ * @return the number of times the key appears in the unordered multi-map
+ */
+int unordered_multimap_count(unordered_multimap me, void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    const struct node *const item = *unordered_multimap_find(me, hash, key);
+    if (!item) {
+        return 0;
+    }
+    return item->value_count;
+}
+
+/**
+ * Determines if the unordered multi-map contains the specified key. The pointer
+ * to the key being passed in should point to the key type which this unordered
+ * multi-map holds. For example, if this unordered multi-map holds key integers,
+ * the key pointer should be a pointer to an integer. Since the key is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered multi-map to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the unordered multi-map contained the key, otherwise 0
+ */
+int unordered_multimap_contains(unordered_multimap me, void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    return *unordered_multimap_find(me, hash, key) != NULL;
+}
+
+/**
+ * Removes the key-value pair from the unordered multi-map if it contains it.
+ * The pointer to the key and value being passed in should point to the key and
+ * value type which this unordered multi-map holds. For example, if this
+ * unordered multi-map holds integer keys and values, the key and value pointer
+ * should be a pointer to an integer. Since the key and value are being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me    the unordered multi-map to remove a key from
+ * @param key   the key to remove
+ * @param value the value to remove
+ *
+ * @return 1 if the unordered multi-map contained the key, otherwise 0
+ */
+int unordered_multimap_remove(unordered_multimap me,
+                              void *const key,
+                              void *const value)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    struct node **link;
+    struct node *item;
+    int i;
+    unordered_multimap_migrate(me, me->migrate_step);
+    link = unordered_multimap_find(me, hash, key);
+    item = *link;
+    if (!item) {
+        return 0;
+    }
+    for (i = 0; i < item->value_count; i++) {
+        if (unordered_multimap_compare_values(
+                me, item->values + i * me->value_size, value) == 0) {
+            break;
+        }
+    }
+    if (i == item->value_count) {
+        return 0;
+    }
+    unordered_multimap_remove_value(me, item, i);
+    if (item->value_count == 0) {
+        *link = item->next;
+        unordered_multimap_free_element(item);
+        me->key_count--;
+        unordered_multimap_auto_shrink(me);
+    }
+    return 1;
+}
+
+/**
+ * Removes all the key-value pairs from the unordered multi-map specified by
+ * the key. The pointer to the key being passed in should point to the key
+ * type which this unordered multi-map holds. For example, if this unordered
+ * multi-map holds key integers, the key pointer should be a pointer to an
+ * integer. Since the key is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me  the unordered multi-map to remove a key-value pair from
+ * @param key the key to remove
+ *
+ * @return 1 if the unordered multi-map contained the key, otherwise 0
+ */
+int unordered_multimap_remove_all(unordered_multimap me, void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    struct node **link;
+    struct node *item;
+    unordered_multimap_migrate(me, me->migrate_step);
+    link = unordered_multimap_find(me, hash, key);
+    item = *link;
+    if (!item) {
+        return 0;
+    }
+    *link = item->next;
+    me->size -= item->value_count;
+    me->key_count--;
+    unordered_multimap_free_element(item);
+    unordered_multimap_auto_shrink(me);
+    return 1;
+}
+
+/*
+ * Moves the cursor to the first node in or after its bucket. The new buckets
+ * are scanned first, followed by the old buckets which have not been moved yet.
+ */
+static int
+unordered_multimap_cursor_seek(unordered_multimap me,
+                               struct unordered_multimap_cursor *const cursor)
+{
+    for (;;) {
+        struct node **buckets = me->buckets;
+        int capacity = me->capacity;
+        if (cursor->internal_table == 1) {
+            buckets = me->old_buckets;
+            capacity = me->old_capacity;
+        }
+        while (cursor->internal_bucket < capacity) {
+            if (buckets[cursor->internal_bucket]) {
+                cursor->internal_link = &buckets[cursor->internal_bucket];
+                cursor->internal_index = 0;
+                return 1;
+            }
+            cursor->internal_bucket++;
+        }
+        if (cursor->internal_table == 1) {
+            cursor->internal_link = NULL;
+            return 0;
+        }
+        cursor->internal_table = 1;
+        cursor->internal_bucket = me->migrate_index;
+    }
+}
+
+/**
+ * Moves the cursor to the first key-value pair of the unordered multi-map. The
+ * keys are visited in the order in which they are stored rather than in any
+ * particular order, and the values of each key are visited one after another
+ * in the order in which they were added. The cursor is owned by the caller, and
+ * remains valid until the unordered multi-map is modified other than through
+ * unordered_multimap_cursor_remove.
+ *
+ * @param me     the unordered multi-map to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key-value pair, otherwise 0 if the
+ *         unordered multi-map is empty
+ */
+int unordered_multimap_first(unordered_multimap me,
+                             struct unordered_multimap_cursor *const cursor)
+{
+    cursor->internal_table = 0;
+    cursor->internal_bucket = 0;
+    return unordered_multimap_cursor_seek(me, cursor);
+}
+
+/**
+ * Moves the cursor to the next key-value pair of the unordered multi-map.
+ *
+ * @param me     the unordered multi-map to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key-value pair, otherwise 0 if there are
+ *         no more key-value pairs
+ */
+int unordered_multimap_next(unordered_multimap me,
+                            struct unordered_multimap_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    if (!link) {
+        return 0;
+    }
+    if (cursor->internal_index + 1 < (*link)->value_count) {
+        cursor->internal_index++;
+        return 1;
+    }
+    cursor->internal_index = 0;
+    cursor->internal_link = &(*link)->next;
+    if ((*link)->next) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multimap_cursor_seek(me, cursor);
+}
+
+/**
+ * Copies the key and the value at the cursor. Either of the key or the value
+ * may be NULL if it is not needed.
+ *
+ * @param key    the key to copy to, or NULL
+ * @param value  the value to copy to, or NULL
+ * @param me     the unordered multi-map being iterated over
+ * @param cursor the cursor to get from
+ *
+ * @return 1 if the cursor was at a key-value pair, otherwise 0
+ */
+int
+unordered_multimap_cursor_get(void *const key,
+                              void *const value,
+                              unordered_multimap me,
+                              const struct unordered_multimap_cursor *cursor)
+{
+    const struct node *item;
+    if (!cursor->internal_link) {
+        return 0;
+    }
+    item = *(struct node **) cursor->internal_link;
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->values + cursor->internal_index * me->value_size,
+               me->value_size);
+    }
+    return 1;
+}
+
+/**
+ * Removes the key-value pair at the cursor from the unordered multi-map, and
+ * moves the cursor to the next key-value pair. Removing through the cursor
+ * never resizes the buckets, so the cursor remains valid.
+ *
+ * @param me     the unordered multi-map to remove from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at a key-value pair after the removal, otherwise 0
+ */
+int
+unordered_multimap_cursor_remove(unordered_multimap me,
+                                 struct unordered_multimap_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    struct node *item;
+    if (!link) {
+        return 0;
+    }
+    item = *link;
+    unordered_multimap_remove_value(me, item, cursor->internal_index);
+    if (cursor->internal_index < item->value_count) {
+        return 1;
+    }
+    cursor->internal_index = 0;
+    if (item->value_count == 0) {
+        *link = item->next;
+        unordered_multimap_free_element(item);
+        me->key_count--;
+    } else {
+        cursor->internal_link = &item->next;
+    }
+    if (*(struct node **) cursor->internal_link) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multimap_cursor_seek(me, cursor);
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void
+unordered_multimap_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void
+unordered_multimap_stream_write(struct snapshot_stream *const stream,
+                                const void *const data,
+                                const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            unordered_multimap_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void
+unordered_multimap_stream_read(struct snapshot_stream *const stream,
+                               void *const data,
+                               const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Grows the buckets while a snapshot is loaded, once the keys which have been
+ * read so far would not fit. The buckets are sized for twice as many, up to the
+ * count of the header, so that a whole snapshot takes few resizes, while a
+ * corrupt count cannot reserve more buckets than the snapshot has keys.
+ */
+static int unordered_multimap_load_reserve(unordered_multimap me,
+                                           const unsigned long needed,
+                                           const unsigned long count)
+{
+    unsigned long size = 2 * needed;
+    if (needed / me->max_load_factor + 1 <= me->capacity) {
+        return 0;
+    }
+    if (size > count) {
+        size = count;
+    }
+    return unordered_multimap_reserve(me, (int) size);
+}
+
+/*
+ * Loads the next record of the snapshot, which holds a key and all of its
+ * values, and adds it to the buckets.
+ */
+static int unordered_multimap_load_record(unordered_multimap me,
+                                          struct snapshot_stream *const stream)
+{
+    unsigned long hash;
+    unsigned long value_count;
+    struct node *add;
+    struct node **bucket;
+    unordered_multimap_stream_read(stream, &hash, sizeof(unsigned long));
+    unordered_multimap_stream_read(stream, &value_count,
+                                   sizeof(unsigned long));
+    unordered_multimap_stream_read(stream, stream->record, me->key_size);
+    if (stream->rc != 0) {
+        return stream->rc;
+    }
+    if (unordered_multimap_is_seeded(me)) {
+        hash = unordered_multimap_hash(me, stream->record);
+    }
+    if (value_count == 0
+        || value_count > (unsigned long) (INT_MAX - me->size)
+        || value_count > (size_t) -1 / me->value_size) {
+        return -EINVAL;
+    }
+    add = unordered_multimap_create_element(me, hash, stream->record,
+                                            (int) value_count);
+    if (!add) {
+        return -ENOMEM;
+    }
+    unordered_multimap_stream_read(stream, add->values,
+                                   value_count * me->value_size);
+    if (stream->rc != 0) {
+        unordered_multimap_free_element(add);
+        return stream->rc;
+    }
+    add->value_count = (int) value_count;
+    bucket = unordered_multimap_bucket(me, hash);
+    add->next = *bucket;
+    *bucket = add;
+    me->key_count++;
+    me->size += (int) value_count;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the unordered multi-map to a file descriptor. The
+ * snapshot consists of a header, which holds the key size, the value size, and
+ * the amount of distinct keys, followed by the stored hash, the value count,
+ * the key, and the values of each distinct key. The hash seed is not written,
+ * so that it never leaves the process. Thus, loading the snapshot hashes the
+ * keys again if they use a built-in hash function. Since the keys and values
+ * are copied byte for byte, they should not contain pointers unless the
+ * snapshot is loaded by the same process.
+ *
+ * @param me the unordered multi-map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int unordered_multimap_save(unordered_multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int i;
+    unordered_multimap_migrate(me, me->old_capacity);
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    header.count = (unsigned long) me->key_count;
+    unordered_multimap_stream_write(&stream, &header,
+                                    sizeof(struct snapshot_header));
+    for (i = 0; stream.rc == 0 && i < me->capacity; i++) {
+        const struct node *traverse = me->buckets[i];
+        while (stream.rc == 0 && traverse) {
+            const unsigned long value_count =
+                    (unsigned long) traverse->value_count;
+            unordered_multimap_stream_write(&stream, &traverse->hash,
+                                            sizeof(unsigned long));
+            unordered_multimap_stream_write(&stream, &value_count,
+                                            sizeof(unsigned long));
+            unordered_multimap_stream_write(&stream, traverse->key,
+                                            me->key_size);
+            unordered_multimap_stream_write(&stream, traverse->values,
+                                            traverse->value_count
+                                            * me->value_size);
+            traverse = traverse->next;
+        }
+    }
+    unordered_multimap_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by unordered_multimap_save into an
+ * empty unordered multi-map. The comparator is never called, since the keys of
+ * a snapshot are already distinct. The values of each key are read straight
+ * into its array. The seed is not in the snapshot, so a fresh seed is picked.
+ * The stored hashes of a user-defined hash function do not depend on the seed,
+ * so they are reused without calling it. The built-in hash functions do depend
+ * on the seed, so each key is hashed again with the fresh seed. The buckets
+ * grow as the keys are read, rather than being sized from the count in the
+ * header, so that a corrupt count cannot reserve more buckets than the snapshot
+ * holds. Thus, the unordered multi-map must have been initialized with the same
+ * key size, value size, and hash function as the unordered multi-map which was
+ * saved. If an error occurs part of the way through the snapshot, the keys
+ * which have already been loaded remain in the unordered multi-map. When the
+ * file descriptor is seekable, it is left positioned right after the snapshot.
+ *
+ * @param me the unordered multi-map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered multi-map is not empty or the
+ *                 snapshot does not match the unordered multi-map
+ * @return -EIO    if the snapshot or the random bytes of the operating system
+ *                 could not be read
+ */
+int unordered_multimap_load(unordered_multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    unsigned long remaining;
+    int rc;
+    if (me->size != 0) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE + me->key_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    unordered_multimap_stream_read(&stream, &header,
+                                   sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != (unsigned long) me->value_size
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = containers_hash_new_seed(&me->seed, me);
+    }
+    for (remaining = header.count; rc == 0 && remaining > 0; remaining--) {
+        rc = unordered_multimap_load_reserve(me, me->key_count + 1,
+                                             header.count);
+        if (rc == 0) {
+            rc = unordered_multimap_load_record(me, &stream);
+        }
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the key-value pairs from the unordered multi-map.
+ *
+ * @param me the unordered multi-map to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multimap_clear(unordered_multimap me)
+{
+    int i;
+    struct node **temp =
+            calloc((size_t) STARTING_BUCKETS, sizeof(struct node *));
+    if (!temp) {
+        return -ENOMEM;
+    }
+    unordered_multimap_migrate(me, me->old_capacity);
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = me->buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse;
+            traverse = traverse->next;
+            unordered_multimap_free_element(backup);
+        }
+        me->buckets[i] = NULL;
+    }
+    me->size = 0;
+    me->key_count = 0;
+    me->capacity = STARTING_BUCKETS;
+    free(me->buckets);
+    me->buckets = temp;
+    return 0;
+}
+
+/**
+ * Frees the unordered multi-map memory. Performing further operations after
+ * calling this function results in undefined behavior.
+ *
+ * @param me the unordered multi-map to free from memory
+ *
+ * @return NULL
+ */
+unordered_multimap unordered_multimap_destroy(unordered_multimap me)
+{
+    unordered_multimap_clear(me);
+    free(me->buckets);
+    free(me);
+    return NULL;
+}
+#undef RESIZE_AT
+#undef RESIZE_RATIO
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef STARTING_BUCKETS
+#undef node
+#undef snapshot_header
+#undef snapshot_stream
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <unistd.h>
+#endif
+
+#define RESIZE_AT unordered_multiset_RESIZE_AT
+#define RESIZE_RATIO unordered_multiset_RESIZE_RATIO
+#define SNAPSHOT_BUFFER_SIZE unordered_multiset_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC unordered_multiset_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION unordered_multiset_SNAPSHOT_VERSION
+#define STARTING_BUCKETS unordered_multiset_STARTING_BUCKETS
+#define node unordered_multiset_node
+#define snapshot_header unordered_multiset_snapshot_header
+static const int STARTING_BUCKETS = 8;
+static const double RESIZE_AT = 0.75;
+static const double RESIZE_RATIO = 1.5;
+static const char SNAPSHOT_MAGIC[8] = "CNTRHASH";
+static const unsigned long SNAPSHOT_VERSION = 2;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_unordered_multiset {
+    size_t key_size;
+    unsigned long (*hash)(const void *const key);
+    int (*comparator)(const void *const one, const void *const two);
+    int bytewise_keys;
+    int size;
+    int used;
+    int capacity;
+    double max_load_factor;
+    double min_load_factor;
+    struct node **buckets;
+    int migrate_step;
+    int migrate_index;
+    int old_capacity;
+    struct node **old_buckets;
+    unsigned long seed;
+    int max_chain_length;
+    int reseeded;
+};
+
+struct node {
+    int count;
+    void *key;
+    unsigned long hash;
+    struct node *next;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header, each
+ * of which is the stored hash followed by the count and the key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * Mixes all the bits of the value. This is the same mixer as the one used by
+ * the built-in integer hash functions, so that they can be inlined.
+ */
+static unsigned long unordered_multiset_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Gets the hash of the key. The built-in hash functions are already
+ * well-distributed, so they are inlined or called directly, with the seed fed
+ * into them, so that keys which collide under one seed do not collide under
+ * another. Otherwise, the user-defined hash is called, and then a second hash
+ * is used to prevent hashing clusters if the user-defined hash is sub-optimal.
+ */
+static unsigned long unordered_multiset_hash(unordered_multiset me,
+                                             const void *const key)
+{
+    unsigned long hash;
+    if (me->hash == containers_hash_int) {
+        int value;
+        memcpy(&value, key, sizeof(int));
+        return unordered_multiset_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_long) {
+        long value;
+        memcpy(&value, key, sizeof(long));
+        return unordered_multiset_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_key) {
+        return containers_hash_bytes_seeded(key, me->key_size, me->seed);
+    }
+    if (me->hash == containers_hash_string) {
+        const char *string;
+        memcpy(&string, key, sizeof(char *));
+        return containers_hash_bytes_seeded(string, strlen(string), me->seed);
+    }
+    hash = me->hash(key);
+    hash ^= (hash >> 20UL) ^ (hash >> 12UL);
+    return hash ^ (hash >> 7UL) ^ (hash >> 4UL);
+}
+
+/*
+ * Determines whether the stored hashes depend on the seed, which they do for
+ * the built-in hash functions. The hashes of a user-defined hash function do
+ * not, so only their buckets change with the seed.
+ */
+static int unordered_multiset_is_seeded(unordered_multiset me)
+{
+    return me->hash == containers_hash_int || me->hash == containers_hash_long
+           || me->hash == containers_hash_key
+           || me->hash == containers_hash_string;
+}
+
+/*
+ * Determines whether two keys are equal exactly when their bytes are equal.
+ */
+static int unordered_multiset_is_bytewise(unordered_multiset me)
+{
+    return CONTAINERS_COMPARE_IS_BYTEWISE(me->comparator, me->key_size);
+}
+
+/**
+ * Initializes an unordered multi-set.
+ *
+ * @param key_size   the size of each key in the unordered multi-set; must be
+ *                   positive
+ * @param hash       the hash function which computes the hash from the key;
+ *                   must not be NULL; may be one of the built-in hash functions
+ *                   from hash.h
+ * @param comparator the comparator function which compares two keys; must not
+ *                   be NULL; may be one of the built-in comparators from
+ *                   compare.h
+ *
+ * @return the newly-initialized unordered multi-set, or NULL if it was not
+ *         successfully initialized due to invalid input arguments, memory
+ *         allocation error, or the random bytes of the operating system not
+ *         being readable
+ */
+unordered_multiset
+unordered_multiset_init(const size_t key_size,
+                        unsigned long (*hash)(const void *const),
+                        int (*comparator)(const void *const, const void *const))
+{
+    struct internal_unordered_multiset *init;
+    if (key_size == 0 || !hash || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_unordered_multiset));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->hash = hash;
+    init->comparator = comparator;
+    init->bytewise_keys = unordered_multiset_is_bytewise(init);
+    init->size = 0;
+    init->used = 0;
+    init->capacity = STARTING_BUCKETS;
+    init->max_load_factor = RESIZE_AT;
+    init->min_load_factor = 0;
+    init->migrate_step = 0;
+    init->migrate_index = 0;
+    init->old_capacity = 0;
+    init->old_buckets = NULL;
+    if (containers_hash_new_seed(&init->seed, init) != 0) {
+        free(init);
+        return NULL;
+    }
+    init->max_chain_length = 0;
+    init->reseeded = 0;
+    init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
+    if (!init->buckets) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/*
+ * Gets the index of the bucket which holds the hash. The hash is mixed with the
+ * seed first, so that keys chosen to collide in the buckets of one unordered
+ * container are spread out in any other.
+ */
+static int unordered_multiset_index(unordered_multiset me,
+                                    const unsigned long hash,
+                                    const int capacity)
+{
+    const unsigned long mixed = unordered_multiset_mix(hash ^ me->seed);
+    return (int) (mixed % (unsigned long) capacity);
+}
+
+/*
+ * Adds the specified node to the multi-set.
+ */
+static void unordered_multiset_add_item(unordered_multiset me,
+                                        struct node *const add)
+{
+    const int index = unordered_multiset_index(me, add->hash, me->capacity);
+    add->next = me->buckets[index];
+    me->buckets[index] = add;
+}
+
+/*
+ * Gets the bucket which holds the nodes with the specified hash. While the
+ * nodes are being moved to the new buckets, the old buckets which have not
+ * been moved yet still hold their nodes.
+ */
+static struct node **unordered_multiset_bucket(unordered_multiset me,
+                                               const unsigned long hash)
+{
+    if (me->old_buckets) {
+        const int old_index =
+                unordered_multiset_index(me, hash, me->old_capacity);
+        if (old_index >= me->migrate_index) {
+            return &me->old_buckets[old_index];
+        }
+    }
+    return &me->buckets[unordered_multiset_index(me, hash, me->capacity)];
+}
+
+/*
+ * Moves the nodes of up to count old buckets to the new buckets, and frees the
+ * old buckets once all of their nodes have been moved.
+ */
+static void unordered_multiset_migrate(unordered_multiset me, int count)
+{
+    while (me->old_buckets && count > 0) {
+        struct node *traverse = me->old_buckets[me->migrate_index];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_multiset_add_item(me, traverse);
+            traverse = backup;
+        }
+        me->migrate_index++;
+        count--;
+        if (me->migrate_index == me->old_capacity) {
+            free(me->old_buckets);
+            me->old_buckets = NULL;
+            me->old_capacity = 0;
+            me->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * Rehashes all the keys in the unordered multi-set. Used when storing
+ * references and changing the keys. This should rarely be used.
+ *
+ * @param me the unordered multi-set to rehash
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multiset_rehash(unordered_multiset me)
+{
+    int i;
+    struct node **old_buckets;
+    unordered_multiset_migrate(me, me->old_capacity);
+    old_buckets = me->buckets;
+    me->buckets = calloc((size_t) me->capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            traverse->hash = unordered_multiset_hash(me, traverse->key);
+            unordered_multiset_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/**
+ * Gets the size of the unordered multi-set.
+ *
+ * @param me the unordered multi-set to check
+ *
+ * @return the size of the unordered multi-set
+ */
+int unordered_multiset_size(unordered_multiset me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the unordered multi-set is empty.
+ *
+ * @param me the unordered multi-set to check
+ *
+ * @return 1 if the unordered multi-set is empty, otherwise 0
+ */
+int unordered_multiset_is_empty(unordered_multiset me)
+{
+    return unordered_multiset_size(me) == 0;
+}
+
+/*
+ * Changes the amount of buckets of the multi-set and redistributes the nodes.
+ */
+static int unordered_multiset_resize(unordered_multiset me,
+                                     const int new_capacity)
+{
+    int i;
+    const int old_capacity = me->capacity;
+    struct node **old_buckets = me->buckets;
+    unordered_multiset_migrate(me, me->old_capacity);
+    me->buckets = calloc((size_t) new_capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    me->capacity = new_capacity;
+    me->reseeded = 0;
+    if (me->migrate_step > 0) {
+        me->old_buckets = old_buckets;
+        me->old_capacity = old_capacity;
+        me->migrate_index = 0;
+        return 0;
+    }
+    for (i = 0; i < old_capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_multiset_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/*
+ * Picks a new seed and redistributes the nodes if a chain has grown longer
+ * than the maximum chain length. This is done at most once between resizes,
+ * since a chain which is still too long after reseeding is made of equal
+ * hashes, which no seed can separate. The nodes are all moved at once, since
+ * the old buckets could not be located with the new seed. The hashes of the
+ * built-in hash functions depend on the seed, so they are computed again. If
+ * no seed can be generated, the chain is left as it is until the next resize.
+ */
+static void unordered_multiset_check_chain(unordered_multiset me,
+                                           const int length)
+{
+    const unsigned long old_seed = me->seed;
+    const int migrate_step = me->migrate_step;
+    unsigned long seed;
+    int rc;
+    if (me->max_chain_length == 0 || length <= me->max_chain_length
+        || me->reseeded) {
+        return;
+    }
+    if (containers_hash_new_seed(&seed, me) != 0) {
+        me->reseeded = 1;
+        return;
+    }
+    unordered_multiset_migrate(me, me->old_capacity);
+    me->seed = seed;
+    me->migrate_step = 0;
+    if (unordered_multiset_is_seeded(me)) {
+        rc = unordered_multiset_rehash(me);
+    } else {
+        rc = unordered_multiset_resize(me, me->capacity);
+    }
+    if (rc != 0) {
+        me->seed = old_seed;
+    }
+    me->migrate_step = migrate_step;
+    me->reseeded = 1;
+}
+
+/**
+ * Reserves enough buckets for the unordered multi-set to hold the specified
+ * amount of distinct keys without resizing. If more buckets than needed are
+ * already reserved, then the previous buckets will be kept.
+ *
+ * @param me   the unordered multi-set to reserve buckets for
+ * @param size the amount of distinct keys to reserve buckets for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if size is negative or too large
+ */
+int unordered_multiset_reserve(unordered_multiset me, const int size)
+{
+    const double capacity = size / me->max_load_factor + 1;
+    if (size < 0 || capacity > INT_MAX) {
+        return -EINVAL;
+    }
+    if ((int) capacity <= me->capacity) {
+        return 0;
+    }
+    return unordered_multiset_resize(me, (int) capacity);
+}
+
+/**
+ * Sets the maximum load factor of the unordered multi-set, which is the ratio
+ * of distinct keys to buckets at which the buckets are resized. A lower maximum
+ * load factor makes lookups faster at the cost of memory. The default maximum
+ * load factor is 0.75. If the unordered multi-set already exceeds the new
+ * maximum load factor, its buckets are resized right away.
+ *
+ * @param me              the unordered multi-set to change
+ * @param max_load_factor the new maximum load factor; must be more than twice
+ *                        the minimum load factor, and thus positive
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the maximum load factor is out of range
+ */
+int unordered_multiset_set_max_load_factor(unordered_multiset me,
+                                           const double max_load_factor)
+{
+    const double old_max_load_factor = me->max_load_factor;
+    int rc;
+    if (!(max_load_factor > 2 * me->min_load_factor)) {
+        return -EINVAL;
+    }
+    me->max_load_factor = max_load_factor;
+    rc = unordered_multiset_reserve(me, me->used);
+    if (rc != 0) {
+        me->max_load_factor = old_max_load_factor;
+    }
+    return rc;
+}
+
+/**
+ * Sets the minimum load factor of the unordered multi-set, below which the
+ * buckets are shrunk when distinct keys are removed. The buckets are shrunk so
+ * that the load factor becomes half of the maximum load factor, which is why
+ * the minimum load factor must be less than that, so that the unordered multi-
+ * set does not shrink and grow back repeatedly. The default minimum load factor
+ * is zero, which means that the buckets are never shrunk automatically.
+ *
+ * @param me              the unordered multi-set to change
+ * @param min_load_factor the new minimum load factor; must not be negative,
+ *                        and must be less than half the maximum load factor
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the minimum load factor is out of range
+ */
+int unordered_multiset_set_min_load_factor(unordered_multiset me,
+                                           const double min_load_factor)
+{
+    if (!(min_load_factor >= 0 && 2 * min_load_factor < me->max_load_factor)) {
+        return -EINVAL;
+    }
+    me->min_load_factor = min_load_factor;
+    return 0;
+}
+
+/**
+ * Shrinks the buckets of the unordered multi-set to the smallest amount which
+ * holds its distinct keys without exceeding the maximum load factor. The
+ * unordered multi-set never has fewer than its starting amount of buckets.
+ *
+ * @param me the unordered multi-set to shrink
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multiset_shrink_to_fit(unordered_multiset me)
+{
+    int capacity = (int) (me->used / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity >= me->capacity) {
+        return 0;
+    }
+    return unordered_multiset_resize(me, capacity);
+}
+
+/*
+ * Shrinks the buckets once the load factor drops below the minimum load factor,
+ * so that the load factor becomes half of the maximum load factor. Since the
+ * unordered multi-set has already been modified, running out of memory is
+ * ignored.
+ */
+static void unordered_multiset_auto_shrink(unordered_multiset me)
+{
+    int capacity;
+    if (me->used >= me->min_load_factor * me->capacity) {
+        return;
+    }
+    capacity = (int) (2 * me->used / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity < me->capacity) {
+        unordered_multiset_resize(me, capacity);
+    }
+}
+
+/**
+ * Sets whether the unordered multi-set resizes incrementally. By default, all
+ * the nodes are moved to the new buckets at once when the unordered multi-set
+ * resizes, so the operation which triggers the resize takes time proportional
+ * to the size of the unordered multi-set. When resizing incrementally, the old
+ * buckets are kept alongside the new buckets, and each subsequent put or remove
+ * moves the nodes of up to the specified amount of old buckets, which spreads
+ * the cost of the resize over many operations. If the nodes have not all been
+ * moved by the time the next resize is needed, the rest of them are moved at
+ * once, which does not happen at the default maximum load factor when at least
+ * three buckets are moved per step. Setting the amount to zero turns
+ * incremental resizing off and moves any remaining nodes.
+ *
+ * @param me               the unordered multi-set to change
+ * @param buckets_per_step the amount of old buckets to move per put or
+ *                         remove, or zero to move all the nodes at once
+ *
+ * @return 0       if no error
+ * @return -EINVAL if buckets_per_step is negative
+ */
+int unordered_multiset_set_incremental_resize(unordered_multiset me,
+                                              const int buckets_per_step)
+{
+    if (buckets_per_step < 0) {
+        return -EINVAL;
+    }
+    me->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0) {
+        unordered_multiset_migrate(me, me->old_capacity);
+    }
+    return 0;
+}
+
+/**
+ * Sets the maximum length of a bucket chain. When adding a key makes its chain
+ * longer than this, the unordered multi-set picks a new random seed and
+ * redistributes its keys, which breaks up chains of keys chosen to collide.
+ * This is done at most once between resizes. The chain length guard is disabled
+ * by default, and is disabled again by a maximum chain length of zero.
+ *
+ * @param me               the unordered multi-set to change
+ * @param max_chain_length the maximum length of a chain, or zero to disable
+ *                         the chain length guard
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the maximum chain length is negative
+ */
+int unordered_multiset_set_max_chain_length(unordered_multiset me,
+                                            const int max_chain_length)
+{
+    if (max_chain_length < 0) {
+        return -EINVAL;
+    }
+    me->max_chain_length = max_chain_length;
+    return 0;
+}
+
+/*
+ * Determines if an element is equal to the key.
+ */
+static int unordered_multiset_is_equal(unordered_multiset me,
+                                       const struct node *const item,
+                                       const unsigned long hash,
+                                       const void *const key)
+{
+    if (item->hash != hash) {
+        return 0;
+    }
+    if (me->bytewise_keys) {
+        return memcmp(item->key, key, me->key_size) == 0;
+    }
+    return me->comparator(item->key, key) == 0;
+}
+
+/*
+ * Creates an element to add.
+ */
+static struct node *unordered_multiset_create_element(unordered_multiset me,
+                                                      const unsigned long hash,
+                                                      const void *const key)
+{
+    struct node *const init = malloc(sizeof(struct node));
+    if (!init) {
+        return NULL;
+    }
+    init->count = 1;
+    init->key = malloc(me->key_size);
+    if (!init->key) {
+        free(init);
+        return NULL;
+    }
+    memcpy(init->key, key, me->key_size);
+    init->hash = hash;
+    init->next = NULL;
+    return init;
+}
+
+/**
+ * Adds an element to the unordered multi-set. The pointer to the key being
+ * passed in should point to the key type which this unordered multi-set holds.
+ * For example, if this multi-set holds key integers, the key pointer should be
+ * a pointer to an integer. Since the key is being copied, the pointer only has
+ * to be valid when this function is called.
+ *
+ * @param me  the unordered multi-set to add to
+ * @param key the element to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multiset_put(unordered_multiset me, void *const key)
+{
+    const unsigned long hash = unordered_multiset_hash(me, key);
+    struct node **bucket;
+    int length = 1;
+    unordered_multiset_migrate(me, me->migrate_step);
+    if (me->used + 1 >= me->max_load_factor * me->capacity) {
+        const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
+        const int rc = unordered_multiset_resize(me, new_capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    bucket = unordered_multiset_bucket(me, hash);
+    if (!*bucket) {
+        *bucket = unordered_multiset_create_element(me, hash, key);
+        if (!*bucket) {
+            return -ENOMEM;
+        }
+    } else {
+        struct node *traverse = *bucket;
+        length++;
+        if (unordered_multiset_is_equal(me, traverse, hash, key)) {
+            traverse->count++;
+            me->size++;
+            return 0;
+        }
+        while (traverse->next) {
+            traverse = traverse->next;
+            length++;
+            if (unordered_multiset_is_equal(me, traverse, hash, key)) {
+                traverse->count++;
+                me->size++;
+                return 0;
+            }
+        }
+        traverse->next = unordered_multiset_create_element(me, hash, key);
+        if (!traverse->next) {
+            return -ENOMEM;
+        }
+    }
+    me->size++;
+    me->used++;
+    unordered_multiset_check_chain(me, length);
+    return 0;
+}
+
+/**
+ * Determines the count of a specific key in the unordered multi-set. The
+ * pointer to the key being passed in should point to the key type which this
+ * unordered multi-set holds. For example, if this unordered multi-set holds key
+ * integers, the key pointer should be a pointer to an integer. Since the key is
+ * being copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered multi-set to check for the count
+ * @param key the element to check
+ *
+ * @return the count of a specific key in the unordered multi-set
+ */
+int unordered_multiset_count(unordered_multiset me, void *const key)
+{
+    const unsigned long hash = unordered_multiset_hash(me, key);
+    const struct node *traverse = *unordered_multiset_bucket(me, hash);
+    while (traverse) {
+        if (unordered_multiset_is_equal(me, traverse, hash, key)) {
+            return traverse->count;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/**
+ * Determines if the unordered multi-set contains the specified element. The
+ * pointer to the key being passed in should point to the key type which this
+ * unordered multi-set holds. For example, if this unordered multi-set holds key
+ * integers, the key pointer should be a pointer to an integer. Since the key is
+ * being copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered multi-set to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the unordered multi-set contained the key, otherwise 0
+ */
+int unordered_multiset_contains(unordered_multiset me, void *const key)
+{
+    return unordered_multiset_count(me, key) > 0;
+}
+
+/**
+ * Removes a key from the unordered multi-set if it contains it. The pointer to
+ * the key being passed in should point to the key type which this unordered
+ * multi-set holds. For example, if this unordered multi-set holds key integers,
+ * the key pointer should be a pointer to an integer. Since the key is being
+ * copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered multi-set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the unordered multi-set contained the key, otherwise 0
+ */
+int unordered_multiset_remove(unordered_multiset me, void *const key)
+{
+    struct node *traverse;
+    const unsigned long hash = unordered_multiset_hash(me, key);
+    struct node **bucket;
+    unordered_multiset_migrate(me, me->migrate_step);
+    bucket = unordered_multiset_bucket(me, hash);
+    if (!*bucket) {
+        return 0;
+    }
+    traverse = *bucket;
+    if (unordered_multiset_is_equal(me, traverse, hash, key)) {
+        traverse->count--;
+        if (traverse->count == 0) {
+            *bucket = traverse->next;
+            free(traverse->key);
+            free(traverse);
+            me->used--;
+        }
+        me->size--;
+        unordered_multiset_auto_shrink(me);
+        return 1;
+    }
+    while (traverse->next) {
+        if (unordered_multiset_is_equal(me, traverse->next, hash, key)) {
+            struct node *const backup = traverse->next;
+            backup->count--;
+            if (backup->count == 0) {
+                traverse->next = traverse->next->next;
+                free(backup->key);
+                free(backup);
+                me->used--;
+            }
+            me->size--;
+            unordered_multiset_auto_shrink(me);
+            return 1;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/**
+ * Removes all the keys specified by the key from an unordered multi-set if it
+ * contains the key. The pointer to the key being passed in should point to the
+ * key type which this multi-set holds. For example, if this multi-set holds key
+ * integers, the key pointer should be a pointer to an integer. Since the key is
+ * being copied, the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered multi-set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the unordered multi-set contained the key, otherwise 0
+ */
+int unordered_multiset_remove_all(unordered_multiset me, void *const key)
+{
+    struct node *traverse;
+    const unsigned long hash = unordered_multiset_hash(me, key);
+    struct node **bucket;
+    unordered_multiset_migrate(me, me->migrate_step);
+    bucket = unordered_multiset_bucket(me, hash);
+    if (!*bucket) {
+        return 0;
+    }
+    traverse = *bucket;
+    if (unordered_multiset_is_equal(me, traverse, hash, key)) {
+        *bucket = traverse->next;
+        me->size -= traverse->count;
+        free(traverse->key);
+        free(traverse);
+        me->used--;
+        unordered_multiset_auto_shrink(me);
+        return 1;
+    }
+    while (traverse->next) {
+        if (unordered_multiset_is_equal(me, traverse->next, hash, key)) {
+            struct node *const backup = traverse->next;
+            traverse->next = traverse->next->next;
+            me->size -= backup->count;
+            free(backup->key);
+            free(backup);
+            me->used--;
+            unordered_multiset_auto_shrink(me);
+            return 1;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/*
+ * Moves the cursor to the first node in or after its bucket. The new buckets
+ * are scanned first, followed by the old buckets which have not been moved yet.
+ */
+static int
+unordered_multiset_cursor_seek(unordered_multiset me,
+                               struct unordered_multiset_cursor *const cursor)
+{
+    for (;;) {
+        struct node **buckets = me->buckets;
+        int capacity = me->capacity;
+        if (cursor->internal_table == 1) {
+            buckets = me->old_buckets;
+            capacity = me->old_capacity;
+        }
+        while (cursor->internal_bucket < capacity) {
+            if (buckets[cursor->internal_bucket]) {
+                cursor->internal_link = &buckets[cursor->internal_bucket];
+                return 1;
+            }
+            cursor->internal_bucket++;
+        }
+        if (cursor->internal_table == 1) {
+            cursor->internal_link = NULL;
+            return 0;
+        }
+        cursor->internal_table = 1;
+        cursor->internal_bucket = me->migrate_index;
+    }
+}
+
+/**
+ * Moves the cursor to the first distinct key of the unordered multi-set. The
+ * distinct keys are visited in the order in which they are stored rather than
+ * in any particular order. The cursor is owned by the caller, and remains valid
+ * until the unordered multi-set is modified other than through
+ * unordered_multiset_cursor_remove.
+ *
+ * @param me     the unordered multi-set to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a distinct key, otherwise 0 if the
+ *         unordered multi-set is empty
+ */
+int unordered_multiset_first(unordered_multiset me,
+                             struct unordered_multiset_cursor *const cursor)
+{
+    cursor->internal_table = 0;
+    cursor->internal_bucket = 0;
+    return unordered_multiset_cursor_seek(me, cursor);
+}
+
+/**
+ * Moves the cursor to the next distinct key of the unordered multi-set.
+ *
+ * @param me     the unordered multi-set to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a distinct key, otherwise 0 if there are
+ *         no more distinct keys
+ */
+int unordered_multiset_next(unordered_multiset me,
+                            struct unordered_multiset_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    if (!link) {
+        return 0;
+    }
+    cursor->internal_link = &(*link)->next;
+    if ((*link)->next) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multiset_cursor_seek(me, cursor);
+}
+
+/**
+ * Copies the key at the cursor, and gets the amount of times that it occurs.
+ *
+ * @param key    the key to copy to
+ * @param me     the unordered multi-set being iterated over
+ * @param cursor the cursor to get from
+ *
+ * @return the count of the key, or 0 if the cursor was not at a key
+ */
+int
+unordered_multiset_cursor_get(void *const key,
+                              unordered_multiset me,
+                              const struct unordered_multiset_cursor *cursor)
+{
+    const struct node *item;
+    if (!cursor->internal_link) {
+        return 0;
+    }
+    item = *(struct node **) cursor->internal_link;
+    memcpy(key, item->key, me->key_size);
+    return item->count;
+}
+
+/**
+ * Removes every occurrence of the key at the cursor from the unordered multi-
+ * set, and moves the cursor to the next distinct key. Removing through the
+ * cursor never resizes the buckets, so the cursor remains valid.
+ *
+ * @param me     the unordered multi-set to remove from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at a distinct key after the removal, otherwise 0
+ */
+int
+unordered_multiset_cursor_remove(unordered_multiset me,
+                                 struct unordered_multiset_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    struct node *item;
+    if (!link) {
+        return 0;
+    }
+    item = *link;
+    *link = item->next;
+    me->size -= item->count;
+    free(item->key);
+    free(item);
+    me->used--;
+    if (*link) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multiset_cursor_seek(me, cursor);
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the whole buffer to the file descriptor, retrying partial writes.
+ */
+static int unordered_multiset_write_all(const int fd,
+                                        const void *const data,
+                                        size_t size)
+{
+    const char *position = data;
+    while (size > 0) {
+        const ssize_t written = write(fd, position, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -EIO;
+        }
+        position += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+
+/*
+ * Fills the whole buffer from the file descriptor, retrying partial reads.
+ */
+static int unordered_multiset_read_all(const int fd,
+                                       void *const data,
+                                       size_t size)
+{
+    char *position = data;
+    while (size > 0) {
+        const ssize_t got = read(fd, position, size);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return -EIO;
+        }
+        position += got;
+        size -= (size_t) got;
+    }
+    return 0;
+}
+
+/*
+ * Grows the buckets while a snapshot is loaded, once the keys which have been
+ * read so far would not fit. The buckets are sized for twice as many, up to the
+ * count of the header, so that a whole snapshot takes few resizes, while a
+ * corrupt count cannot reserve more buckets than the snapshot has keys.
+ */
+static int unordered_multiset_load_reserve(unordered_multiset me,
+                                           const unsigned long needed,
+                                           const unsigned long count)
+{
+    unsigned long size = 2 * needed;
+    if (needed / me->max_load_factor + 1 <= me->capacity) {
+        return 0;
+    }
+    if (size > count) {
+        size = count;
+    }
+    return unordered_multiset_reserve(me, (int) size);
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the unordered multi-set to a file descriptor. The
+ * snapshot consists of a header, which holds the key size and the amount of
+ * distinct keys, followed by the stored hash, the count, and the key of each
+ * distinct key. The hash seed is not written, so that it never leaves the
+ * process. Thus, loading the snapshot hashes the keys again if they use a
+ * built-in hash function. Since the keys are copied byte for byte, they should
+ * not contain pointers unless the snapshot is loaded by the same process.
+ *
+ * @param me the unordered multi-set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int unordered_multiset_save(unordered_multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size = 2 * sizeof(unsigned long) + me->key_size;
+    size_t buffer_size = SNAPSHOT_BUFFER_SIZE;
+    size_t used = 0;
+    unsigned long count;
+    char *buffer;
+    int rc;
+    int i;
+    unordered_multiset_migrate(me, me->old_capacity);
+    if (record_size > buffer_size) {
+        buffer_size = record_size;
+    }
+    buffer = malloc(buffer_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    header.count = (unsigned long) me->used;
+    rc = unordered_multiset_write_all(fd, &header,
+                                      sizeof(struct snapshot_header));
+    for (i = 0; rc == 0 && i < me->capacity; i++) {
+        const struct node *traverse = me->buckets[i];
+        while (rc == 0 && traverse) {
+            if (used + record_size > buffer_size) {
+                rc = unordered_multiset_write_all(fd, buffer, used);
+                used = 0;
+            }
+            memcpy(buffer + used, &traverse->hash, sizeof(unsigned long));
+            used += sizeof(unsigned long);
+            count = (unsigned long) traverse->count;
+            memcpy(buffer + used, &count, sizeof(unsigned long));
+            used += sizeof(unsigned long);
+            memcpy(buffer + used, traverse->key, me->key_size);
+            used += me->key_size;
+            traverse = traverse->next;
+        }
+    }
+    if (rc == 0) {
+        rc = unordered_multiset_write_all(fd, buffer, used);
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by unordered_multiset_save into an
+ * empty unordered multi-set. The comparator is never called, since the keys of
+ * a snapshot are already distinct. The seed is not in the snapshot, so a fresh
+ * seed is picked. The stored hashes of a user-defined hash function do not
+ * depend on the seed, so they are reused without calling it. The built-in hash
+ * functions do depend on the seed, so each key is hashed again with the fresh
+ * seed. The buckets grow as the keys are read, rather than being sized from the
+ * count in the header, so that a corrupt count cannot reserve more buckets than
+ * the snapshot holds. Thus, the unordered multi-set must have been initialized
+ * with the same key size and hash function as the unordered multi-set which was
+ * saved. If an error occurs part of the way through the snapshot, the keys
+ * which have already been loaded remain in the unordered multi-set.
+ *
+ * @param me the unordered multi-set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered multi-set is not empty or the
+ *                 snapshot does not match the unordered multi-set
+ * @return -EIO    if the snapshot or the random bytes of the operating system
+ *                 could not be read
+ */
+int unordered_multiset_load(unordered_multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size = 2 * sizeof(unsigned long) + me->key_size;
+    size_t batch_size = SNAPSHOT_BUFFER_SIZE / record_size;
+    unsigned long remaining;
+    char *buffer;
+    int rc;
+    if (me->size != 0) {
+        return -EINVAL;
+    }
+    rc = unordered_multiset_read_all(fd, &header,
+                                     sizeof(struct snapshot_header));
+    if (rc != 0) {
+        return rc;
+    }
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION
+        || header.key_size != (unsigned long) me->key_size
+        || header.value_size != 0
+        || header.count > INT_MAX) {
+        return -EINVAL;
+    }
+    rc = containers_hash_new_seed(&me->seed, me);
+    if (rc != 0) {
+        return rc;
+    }
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+    buffer = malloc(batch_size * record_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    remaining = header.count;
+    while (remaining > 0) {
+        const char *record = buffer;
+        size_t batch = batch_size;
+        if (batch > remaining) {
+            batch = remaining;
+        }
+        rc = unordered_multiset_read_all(fd, buffer, batch * record_size);
+        if (rc != 0) {
+            break;
+        }
+        remaining -= batch;
+        rc = unordered_multiset_load_reserve(me, me->used + batch,
+                                             header.count);
+        if (rc != 0) {
+            break;
+        }
+        for (; batch > 0; batch--) {
+            const char *const key = record + 2 * sizeof(unsigned long);
+            unsigned long hash;
+            unsigned long count;
+            struct node *add;
+            struct node **bucket;
+            memcpy(&hash, record, sizeof(unsigned long));
+            if (unordered_multiset_is_seeded(me)) {
+                hash = unordered_multiset_hash(me, key);
+            }
+            memcpy(&count, record + sizeof(unsigned long),
+                   sizeof(unsigned long));
+            if (count == 0 || count > (unsigned long) (INT_MAX - me->size)) {
+                free(buffer);
+                return -EINVAL;
+            }
+            add = unordered_multiset_create_element(me, hash, key);
+            if (!add) {
+                free(buffer);
+                return -ENOMEM;
+            }
+            add->count = (int) count;
+            bucket = unordered_multiset_bucket(me, hash);
+            add->next = *bucket;
+            *bucket = add;
+            me->size += add->count;
+            me->used++;
+            record += record_size;
+        }
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the keys from the unordered multi-set.
+ *
+ * @param me the unordered multi-set to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multiset_clear(unordered_multiset me)
+{
+    int i;
+    struct node **temp =
+            calloc((size_t) STARTING_BUCKETS, sizeof(struct node *));
+    if (!temp) {
+        return -ENOMEM;
+    }
+    unordered_multiset_migrate(me, me->old_capacity);
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = me->buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse;
+            traverse = traverse->next;
+            free(backup->key);
+            free(backup);
+        }
+        me->buckets[i] = NULL;
+    }
+    me->size = 0;
+    me->used = 0;
+    me->capacity = STARTING_BUCKETS;
+    free(me->buckets);
+    me->buckets = temp;
+    return 0;
+}
+
+/**
+ * Frees the unordered multi-set memory. Performing further operations after
+ * calling this function results in undefined behavior.
+ *
+ * @param me the unordered multi-set to free from memory
+ *
+ * @return NULL
+ */
+unordered_multiset unordered_multiset_destroy(unordered_multiset me)
+{
+    unordered_multiset_clear(me);
+    free(me->buckets);
+    free(me);
+    return NULL;
+}
+#undef RESIZE_AT
+#undef RESIZE_RATIO
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef STARTING_BUCKETS
+#undef node
+#undef snapshot_header
+
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <unistd.h>
+#endif
+
+#define RESIZE_AT unordered_set_RESIZE_AT
+#define RESIZE_RATIO unordered_set_RESIZE_RATIO
+#define SNAPSHOT_BUFFER_SIZE unordered_set_SNAPSHOT_BUFFER_SIZE
+#define SNAPSHOT_MAGIC unordered_set_SNAPSHOT_MAGIC
+#define SNAPSHOT_VERSION unordered_set_SNAPSHOT_VERSION
+#define STARTING_BUCKETS unordered_set_STARTING_BUCKETS
+#define node unordered_set_node
+#define snapshot_header unordered_set_snapshot_header
+static const int STARTING_BUCKETS = 8;
+static const double RESIZE_AT = 0.75;
+static const double RESIZE_RATIO = 1.5;
+static const char SNAPSHOT_MAGIC[8] = "CNTRHASH";
+static const unsigned long SNAPSHOT_VERSION = 2;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
+
+struct internal_unordered_set {
+    size_t key_size;
+    unsigned long (*hash)(const void *const key);
+    int (*comparator)(const void *const one, const void *const two);
+    int bytewise_keys;
+    int size;
+    int capacity;
+    double max_load_factor;
+    double min_load_factor;
+    struct node **buckets;
+    int migrate_step;
+    int migrate_index;
+    int old_capacity;
+    struct node **old_buckets;
+    unsigned long seed;
+    int max_chain_length;
+    int reseeded;
+};
+
+struct node {
+    void *key;
+    unsigned long hash;
+    struct node *next;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header, each
+ * of which is the stored hash followed by the key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * Mixes all the bits of the value. This is the same mixer as the one used by
+ * the built-in integer hash functions, so that they can be inlined.
+ */
+static unsigned long unordered_set_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Gets the hash of the key. The built-in hash functions are already
+ * well-distributed, so they are inlined or called directly, with the seed fed
+ * into them, so that keys which collide under one seed do not collide under
+ * another. Otherwise, the user-defined hash is called, and then a second hash
+ * is used to prevent hashing clusters if the user-defined hash is sub-optimal.
+ */
+static unsigned long unordered_set_hash(unordered_set me, const void *const key)
+{
+    unsigned long hash;
+    if (me->hash == containers_hash_int) {
+        int value;
+        memcpy(&value, key, sizeof(int));
+        return unordered_set_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_long) {
+        long value;
+        memcpy(&value, key, sizeof(long));
+        return unordered_set_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_key) {
+        return containers_hash_bytes_seeded(key, me->key_size, me->seed);
+    }
+    if (me->hash == containers_hash_string) {
+        const char *string;
+        memcpy(&string, key, sizeof(char *));
+        return containers_hash_bytes_seeded(string, strlen(string), me->seed);
+    }
+    hash = me->hash(key);
+    hash ^= (hash >> 20UL) ^ (hash >> 12UL);
+    return hash ^ (hash >> 7UL) ^ (hash >> 4UL);
+}
+
+/*
+ * Determines whether the stored hashes depend on the seed, which they do for
+ * the built-in hash functions. The hashes of a user-defined hash function do
+ * not, so only their buckets change with the seed.
+ */
+static int unordered_set_is_seeded(unordered_set me)
+{
+    return me->hash == containers_hash_int || me->hash == containers_hash_long
+           || me->hash == containers_hash_key
+           || me->hash == containers_hash_string;
+}
+
+/*
+ * Determines whether two keys are equal exactly when their bytes are equal.
+ */
+static int unordered_set_is_bytewise(unordered_set me)
+{
+    return CONTAINERS_COMPARE_IS_BYTEWISE(me->comparator, me->key_size);
+}
+
+/**
+ * Initializes an unordered set.
+ *
+ * @param key_size   the size of each key in the unordered set; must be
+ *                   positive
+ * @param hash       the hash function which computes the hash from the key;
+ *                   must not be NULL; may be one of the built-in hash functions
+ *                   from hash.h
+ * @param comparator the comparator function which compares two keys; must not
+ *                   be NULL; may be one of the built-in comparators from
+ *                   compare.h
+ *
+ * @return the newly-initialized unordered set, or NULL if it was not
+ *         successfully initialized due to invalid input arguments, memory
+ *         allocation error, or the random bytes of the operating system not
+ *         being readable
+ */
+unordered_set unordered_set_init(const size_t key_size,
+                                 unsigned long (*hash)(const void *const),
+                                 int (*comparator)(const void *const,
+                                                   const void *const))
+{
+    struct internal_unordered_set *init;
+    if (key_size == 0 || !hash || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_unordered_set));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->hash = hash;
+    init->comparator = comparator;
+    init->bytewise_keys = unordered_set_is_bytewise(init);
+    init->size = 0;
+    init->capacity = STARTING_BUCKETS;
+    init->max_load_factor = RESIZE_AT;
+    init->min_load_factor = 0;
+    init->migrate_step = 0;
+    init->migrate_index = 0;
+    init->old_capacity = 0;
+    init->old_buckets = NULL;
+    if (containers_hash_new_seed(&init->seed, init) != 0) {
+        free(init);
+        return NULL;
+    }
+    init->max_chain_length = 0;
+    init->reseeded = 0;
+    init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
+    if (!init->buckets) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/*
+ * Gets the index of the bucket which holds the hash. The hash is mixed with the
+ * seed first, so that keys chosen to collide in the buckets of one unordered
+ * container are spread out in any other.
+ */
+static int unordered_set_index(unordered_set me,
+                               const unsigned long hash,
+                               const int capacity)
+{
+    const unsigned long mixed = unordered_set_mix(hash ^ me->seed);
+    return (int) (mixed % (unsigned long) capacity);
+}
+
+/*
+ * Adds the specified node to the set.
+ */
+static void unordered_set_add_item(unordered_set me, struct node *const add)
+{
+    const int index = unordered_set_index(me, add->hash, me->capacity);
+    add->next = me->buckets[index];
+    me->buckets[index] = add;
+}
+
+/*
+ * Gets the bucket which holds the nodes with the specified hash. While the
+ * nodes are being moved to the new buckets, the old buckets which have not
+ * been moved yet still hold their nodes.
+ */
+static struct node **unordered_set_bucket(unordered_set me,
+                                          const unsigned long hash)
+{
+    if (me->old_buckets) {
+        const int old_index = unordered_set_index(me, hash, me->old_capacity);
+        if (old_index >= me->migrate_index) {
+            return &me->old_buckets[old_index];
+        }
+    }
+    return &me->buckets[unordered_set_index(me, hash, me->capacity)];
+}
+
+/*
+ * Moves the nodes of up to count old buckets to the new buckets, and frees the
+ * old buckets once all of their nodes have been moved.
+ */
+static void unordered_set_migrate(unordered_set me, int count)
+{
+    while (me->old_buckets && count > 0) {
+        struct node *traverse = me->old_buckets[me->migrate_index];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_set_add_item(me, traverse);
+            traverse = backup;
+        }
+        me->migrate_index++;
+        count--;
+        if (me->migrate_index == me->old_capacity) {
+            free(me->old_buckets);
+            me->old_buckets = NULL;
+            me->old_capacity = 0;
+            me->migrate_index = 0;
+        }
+    }
+}
+
+/**
+ * Rehashes all the keys in the unordered set. Used when storing references and
+ * changing the keys. This should rarely be used.
+ *
+ * @param me the unordered set to rehash
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_set_rehash(unordered_set me)
+{
+    int i;
+    struct node **old_buckets;
+    unordered_set_migrate(me, me->old_capacity);
+    old_buckets = me->buckets;
+    me->buckets = calloc((size_t) me->capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            traverse->hash = unordered_set_hash(me, traverse->key);
+            unordered_set_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/**
+ * Gets the size of the unordered set.
+ *
+ * @param me the unordered set to check
+ *
+ * @return the size of the unordered set
+ */
+int unordered_set_size(unordered_set me)
+{
+    return me->size;
+}
+
+/**
+ * Determines whether or not the unordered set is empty.
+ *
+ * @param me the unordered set to check
+ *
+ * @return 1 if the unordered set is empty, otherwise 0
+ */
+int unordered_set_is_empty(unordered_set me)
+{
+    return unordered_set_size(me) == 0;
+}
+
+/*
+ * Changes the amount of buckets of the set and redistributes the nodes.
+ */
+static int unordered_set_resize(unordered_set me, const int new_capacity)
+{
+    int i;
+    const int old_capacity = me->capacity;
+    struct node **old_buckets = me->buckets;
+    unordered_set_migrate(me, me->old_capacity);
+    me->buckets = calloc((size_t) new_capacity, sizeof(struct node *));
+    if (!me->buckets) {
+        me->buckets = old_buckets;
+        return -ENOMEM;
+    }
+    me->capacity = new_capacity;
+    me->reseeded = 0;
+    if (me->migrate_step > 0) {
+        me->old_buckets = old_buckets;
+        me->old_capacity = old_capacity;
+        me->migrate_index = 0;
+        return 0;
+    }
+    for (i = 0; i < old_capacity; i++) {
+        struct node *traverse = old_buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_set_add_item(me, traverse);
+            traverse = backup;
+        }
+    }
+    free(old_buckets);
+    return 0;
+}
+
+/*
+ * Picks a new seed and redistributes the nodes if a chain has grown longer
+ * than the maximum chain length. This is done at most once between resizes,
+ * since a chain which is still too long after reseeding is made of equal
+ * hashes, which no seed can separate. The nodes are all moved at once, since
+ * the old buckets could not be located with the new seed. The hashes of the
+ * built-in hash functions depend on the seed, so they are computed again. If
+ * no seed can be generated, the chain is left as it is until the next resize.
+ */
+static void unordered_set_check_chain(unordered_set me, const int length)
+{
+    const unsigned long old_seed = me->seed;
+    const int migrate_step = me->migrate_step;
+    unsigned long seed;
+    int rc;
+    if (me->max_chain_length == 0 || length <= me->max_chain_length
+        || me->reseeded) {
+        return;
+    }
+    if (containers_hash_new_seed(&seed, me) != 0) {
+        me->reseeded = 1;
+        return;
+    }
+    unordered_set_migrate(me, me->old_capacity);
+    me->seed = seed;
+    me->migrate_step = 0;
+    if (unordered_set_is_seeded(me)) {
+        rc = unordered_set_rehash(me);
+    } else {
+        rc = unordered_set_resize(me, me->capacity);
+    }
+    if (rc != 0) {
+        me->seed = old_seed;
+    }
+    me->migrate_step = migrate_step;
+    me->reseeded = 1;
+}
+
+/**
+ * Reserves enough buckets for the unordered set to hold the specified amount of
+ * keys without resizing. If more buckets than needed are already reserved, then
+ * the previous buckets will be kept.
+ *
+ * @param me   the unordered set to reserve buckets for
+ * @param size the amount of keys to reserve buckets for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if size is negative or too large
+ */
+int unordered_set_reserve(unordered_set me, const int size)
+{
+    const double capacity = size / me->max_load_factor + 1;
+    if (size < 0 || capacity > INT_MAX) {
+        return -EINVAL;
+    }
+    if ((int) capacity <= me->capacity) {
+        return 0;
+    }
+    return unordered_set_resize(me, (int) capacity);
+}
+
+/**
+ * Sets the maximum load factor of the unordered set, which is the ratio of keys
+ * to buckets at which the buckets are resized. A lower maximum load factor
+ * makes lookups faster at the cost of memory. The default maximum load factor
+ * is 0.75. If the unordered set already exceeds the new maximum load factor,
+ * its buckets are resized right away.
+ *
+ * @param me              the unordered set to change
+ * @param max_load_factor the new maximum load factor; must be more than twice
+ *                        the minimum load factor, and thus positive
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the maximum load factor is out of range
+ */
+int unordered_set_set_max_load_factor(unordered_set me,
+                                      const double max_load_factor)
+{
+    const double old_max_load_factor = me->max_load_factor;
+    int rc;
+    if (!(max_load_factor > 2 * me->min_load_factor)) {
+        return -EINVAL;
+    }
+    me->max_load_factor = max_load_factor;
+    rc = unordered_set_reserve(me, me->size);
+    if (rc != 0) {
+        me->max_load_factor = old_max_load_factor;
+    }
+    return rc;
+}
+
+/**
+ * Sets the minimum load factor of the unordered set, below which the buckets
+ * are shrunk when keys are removed. The buckets are shrunk so that the load
+ * factor becomes half of the maximum load factor, which is why the minimum load
+ * factor must be less than that, so that the unordered set does not shrink and
+ * grow back repeatedly. The default minimum load factor is zero, which means
+ * that the buckets are never shrunk automatically.
+ *
+ * @param me              the unordered set to change
+ * @param min_load_factor the new minimum load factor; must not be negative,
+ *                        and must be less than half the maximum load factor
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the minimum load factor is out of range
+ */
+int unordered_set_set_min_load_factor(unordered_set me,
+                                      const double min_load_factor)
+{
+    if (!(min_load_factor >= 0 && 2 * min_load_factor < me->max_load_factor)) {
+        return -EINVAL;
+    }
+    me->min_load_factor = min_load_factor;
+    return 0;
+}
+
+/**
+ * Shrinks the buckets of the unordered set to the smallest amount which holds
+ * its keys without exceeding the maximum load factor. The unordered set never
+ * has fewer than its starting amount of buckets.
+ *
+ * @param me the unordered set to shrink
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_set_shrink_to_fit(unordered_set me)
+{
+    int capacity = (int) (me->size / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity >= me->capacity) {
+        return 0;
+    }
+    return unordered_set_resize(me, capacity);
+}
+
+/*
+ * Shrinks the buckets once the load factor drops below the minimum load factor,
+ * so that the load factor becomes half of the maximum load factor. Since the
+ * unordered set has already been modified, running out of memory is ignored.
+ */
+static void unordered_set_auto_shrink(unordered_set me)
+{
+    int capacity;
+    if (me->size >= me->min_load_factor * me->capacity) {
+        return;
+    }
+    capacity = (int) (2 * me->size / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity < me->capacity) {
+        unordered_set_resize(me, capacity);
+    }
+}
+
+/**
+ * Sets whether the unordered set resizes incrementally. By default, all the
+ * nodes are moved to the new buckets at once when the unordered set resizes, so
+ * the operation which triggers the resize takes time proportional to the size
+ * of the unordered set. When resizing incrementally, the old buckets are kept
+ * alongside the new buckets, and each subsequent put or remove moves the nodes
+ * of up to the specified amount of old buckets, which spreads the cost of the
+ * resize over many operations. If the nodes have not all been moved by the time
+ * the next resize is needed, the rest of them are moved at once, which does not
+ * happen at the default maximum load factor when at least three buckets are
+ * moved per step. Setting the amount to zero turns incremental resizing off and
+ * moves any remaining nodes.
+ *
+ * @param me               the unordered set to change
+ * @param buckets_per_step the amount of old buckets to move per put or
+ *                         remove, or zero to move all the nodes at once
+ *
+ * @return 0       if no error
+ * @return -EINVAL if buckets_per_step is negative
+ */
+int unordered_set_set_incremental_resize(unordered_set me,
+                                         const int buckets_per_step)
+{
+    if (buckets_per_step < 0) {
+        return -EINVAL;
+    }
+    me->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0) {
+        unordered_set_migrate(me, me->old_capacity);
+    }
+    return 0;
+}
+
+/**
+ * Sets the maximum length of a bucket chain. When adding a key makes its chain
+ * longer than this, the unordered set picks a new random seed and redistributes
+ * its keys, which breaks up chains of keys chosen to collide. This is done at
+ * most once between resizes. The chain length guard is disabled by default, and
+ * is disabled again by a maximum chain length of zero.
+ *
+ * @param me               the unordered set to change
+ * @param max_chain_length the maximum length of a chain, or zero to disable
+ *                         the chain length guard
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the maximum chain length is negative
+ */
+int unordered_set_set_max_chain_length(unordered_set me,
+                                       const int max_chain_length)
+{
+    if (max_chain_length < 0) {
+        return -EINVAL;
+    }
+    me->max_chain_length = max_chain_length;
+    return 0;
+}
+
+/*
+ * Determines if an element is equal to the key.
+ */
+static int unordered_set_is_equal(unordered_set me,
+                                  const struct node *const item,
+                                  const unsigned long hash,
+                                  const void *const key)
+{
+    if (item->hash != hash) {
+        return 0;
+    }
+    if (me->bytewise_keys) {
+        return memcmp(item->key, key, me->key_size) == 0;
+    }
+    return me->comparator(item->key, key) == 0;
+}
+
+/*
+ * Creates an element to add.
+ */
+static struct node *unordered_set_create_element(unordered_set me,
+                                                 const unsigned long hash,
+                                                 const void *const key)
+{
+    struct node *const init = malloc(sizeof(struct node));
+    if (!init) {
+        return NULL;
+    }
+    init->key = malloc(me->key_size);
+    if (!init->key) {
+        free(init);
+        return NULL;
+    }
+    memcpy(init->key, key, me->key_size);
+    init->hash = hash;
+    init->next = NULL;
+    return init;
+}
+
+/*
+ * Adds the key with the specified hash if the unordered set does not already
+ * contain it.
+ */
+static int unordered_set_put_hash(unordered_set me,
+                                  const unsigned long hash,
+                                  const void *const key)
+{
+    struct node **bucket;
+    int length = 1;
+    unordered_set_migrate(me, me->migrate_step);
+    if (me->size + 1 >= me->max_load_factor * me->capacity) {
+        const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
+        const int rc = unordered_set_resize(me, new_capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    bucket = unordered_set_bucket(me, hash);
+    if (!*bucket) {
+        *bucket = unordered_set_create_element(me, hash, key);
+        if (!*bucket) {
+            return -ENOMEM;
+        }
+    } else {
+        struct node *traverse = *bucket;
+        length++;
+        if (unordered_set_is_equal(me, traverse, hash, key)) {
+            return 0;
+        }
+        while (traverse->next) {
+            traverse = traverse->next;
+            length++;
+            if (unordered_set_is_equal(me, traverse, hash, key)) {
+                return 0;
+            }
+        }
+        traverse->next = unordered_set_create_element(me, hash, key);
+        if (!traverse->next) {
+            return -ENOMEM;
+        }
+    }
+    me->size++;
+    unordered_set_check_chain(me, length);
+    return 0;
+}
+
+/**
+ * Adds an element to the unordered set if the unordered set does not already
+ * contain it. The pointer to the key being passed in should point to the key
+ * type which this unordered set holds. For example, if this unordered set holds
+ * key integers, the key pointer should be a pointer to an integer. Since the
+ * key is being copied, the pointer only has to be valid when this function is
+ * called.
+ *
+ * @param me  the unordered set to add to
+ * @param key the element to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_set_put(unordered_set me, void *const key)
+{
+    return unordered_set_put_hash(me, unordered_set_hash(me, key), key);
+}
+
+/*
+ * Finds the node which is equal to the key with the specified hash.
+ */
+static const struct node *unordered_set_find(unordered_set me,
+                                             const unsigned long hash,
+                                             const void *const key)
+{
+    const struct node *traverse = *unordered_set_bucket(me, hash);
+    while (traverse) {
+        if (unordered_set_is_equal(me, traverse, hash, key)) {
+            return traverse;
+        }
+        traverse = traverse->next;
+    }
+    return NULL;
+}
+
+/**
+ * Determines if the unordered set contains the specified element. The pointer
+ * to the key being passed in should point to the key type which this unordered
+ * set holds. For example, if this unordered set holds key integers, the key
+ * pointer should be a pointer to an integer. Since the key is being copied,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param me  the unordered set to check for the element
+ * @param key the element to check
+ *
+ * @return 1 if the unordered set contained the element, otherwise 0
+ */
+int unordered_set_contains(unordered_set me, void *const key)
+{
+    return unordered_set_find(me, unordered_set_hash(me, key), key) != NULL;
+}
+
+/**
+ * Removes the key from the unordered set if it contains it. The pointer to the
+ * key being passed in should point to the key type which this unordered set
+ * holds. For example, if this unordered set holds key integers, the key pointer
+ * should be a pointer to an integer. Since the key is being copied, the pointer
+ * only has to be valid when this function is called.
+ *
+ * @param me  the unordered set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the unordered set contained the key, otherwise 0
+ */
+int unordered_set_remove(unordered_set me, void *const key)
+{
+    struct node *traverse;
+    const unsigned long hash = unordered_set_hash(me, key);
+    struct node **bucket;
+    unordered_set_migrate(me, me->migrate_step);
+    bucket = unordered_set_bucket(me, hash);
+    if (!*bucket) {
+        return 0;
+    }
+    traverse = *bucket;
+    if (unordered_set_is_equal(me, traverse, hash, key)) {
+        *bucket = traverse->next;
+        free(traverse->key);
+        free(traverse);
+        me->size--;
+        unordered_set_auto_shrink(me);
+        return 1;
+    }
+    while (traverse->next) {
+        if (unordered_set_is_equal(me, traverse->next, hash, key)) {
+            struct node *const backup = traverse->next;
+            traverse->next = traverse->next->next;
+            free(backup->key);
+            free(backup);
+            me->size--;
+            unordered_set_auto_shrink(me);
+            return 1;
+        }
+        traverse = traverse->next;
+    }
+    return 0;
+}
+
+/*
+ * Moves the cursor to the first node in or after its bucket. The new buckets
+ * are scanned first, followed by the old buckets which have not been moved yet.
+ */
+static int unordered_set_cursor_seek(unordered_set me,
+                                     struct unordered_set_cursor *const cursor)
+{
+    for (;;) {
+        struct node **buckets = me->buckets;
+        int capacity = me->capacity;
+        if (cursor->internal_table == 1) {
+            buckets = me->old_buckets;
+            capacity = me->old_capacity;
+        }
+        while (cursor->internal_bucket < capacity) {
+            if (buckets[cursor->internal_bucket]) {
+                cursor->internal_link = &buckets[cursor->internal_bucket];
+                return 1;
+            }
+            cursor->internal_bucket++;
+        }
+        if (cursor->internal_table == 1) {
+            cursor->internal_link = NULL;
+            return 0;
+        }
+        cursor->internal_table = 1;
+        cursor->internal_bucket = me->migrate_index;
+    }
+}
+
+/**
+ * Moves the cursor to the first key of the unordered set. The keys are visited
+ * in the order in which they are stored rather than in any particular order.
+ * The cursor is owned by the caller, and remains valid until the unordered set
+ * is modified other than through unordered_set_cursor_remove.
+ *
+ * @param me     the unordered set to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key, otherwise 0 if the
+ *         unordered set is empty
+ */
+int unordered_set_first(unordered_set me,
+                        struct unordered_set_cursor *const cursor)
+{
+    cursor->internal_table = 0;
+    cursor->internal_bucket = 0;
+    return unordered_set_cursor_seek(me, cursor);
+}
+
+/**
+ * Moves the cursor to the next key of the unordered set.
+ *
+ * @param me     the unordered set to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key, otherwise 0 if there are
+ *         no more keys
+ */
+int unordered_set_next(unordered_set me,
+                       struct unordered_set_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    if (!link) {
+        return 0;
+    }
+    cursor->internal_link = &(*link)->next;
+    if ((*link)->next) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_set_cursor_seek(me, cursor);
+}
+
+/**
+ * Copies the key at the cursor.
+ *
+ * @param key    the key to copy to
+ * @param me     the unordered set being iterated over
+ * @param cursor the cursor to get from
+ *
+ * @return 1 if the cursor was at a key, otherwise 0
+ */
+int unordered_set_cursor_get(void *const key,
+                             unordered_set me,
+                             const struct unordered_set_cursor *const cursor)
+{
+    const struct node *item;
+    if (!cursor->internal_link) {
+        return 0;
+    }
+    item = *(struct node **) cursor->internal_link;
+    memcpy(key, item->key, me->key_size);
+    return 1;
+}
+
+/**
+ * Removes the key at the cursor from the unordered set, and moves the cursor to
+ * the next key. Removing through the cursor never resizes the buckets, so the
+ * cursor remains valid.
+ *
+ * @param me     the unordered set to remove from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at a key after the removal, otherwise 0
+ */
+int unordered_set_cursor_remove(unordered_set me,
+                                struct unordered_set_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    struct node *item;
+    if (!link) {
+        return 0;
+    }
+    item = *link;
+    *link = item->next;
+    free(item->key);
+    free(item);
+    me->size--;
+    if (*link) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_set_cursor_seek(me, cursor);
+}
+
+/*
+ * Gets the hash which a node of another unordered set has in this unordered
+ * set. The stored hash is reused if both use the same hash function, so that
+ * the hash function is not called again. The hashes of the built-in hash
+ * functions are only reused if both also have the same seed, which is cheap
+ * since they are inlined.
+ */
+static unsigned long unordered_set_hash_node(unordered_set me,
+                                             unordered_set other,
+                                             const struct node *const item)
+{
+    if (me->hash == other->hash
+        && (me->seed == other->seed || !unordered_set_is_seeded(me))) {
+        return item->hash;
+    }
+    return unordered_set_hash(me, item->key);
+}
+
+/*
+ * Removes all the keys without allocating, which is used to leave the
+ * unordered set empty when combining unordered sets fails part of the way.
+ */
+static void unordered_set_remove_all(unordered_set me)
+{
+    struct unordered_set_cursor cursor;
+    int more = unordered_set_first(me, &cursor);
+    while (more) {
+        more = unordered_set_cursor_remove(me, &cursor);
+    }
+}
+
+/*
+ * Adds the keys of the source to the empty unordered set, keeping only the
+ * keys which the other unordered set contains if keep_common is set, or the
+ * keys which it does not contain otherwise.
+ */
+static int unordered_set_filter(unordered_set me,
+                                unordered_set source,
+                                unordered_set other,
+                                const int keep_common)
+{
+    struct unordered_set_cursor cursor;
+    int more;
+    int rc;
+    if (me->size != 0 || me->key_size != source->key_size
+        || me->key_size != other->key_size) {
+        return -EINVAL;
+    }
+    rc = unordered_set_reserve(me, source->size);
+    if (rc != 0) {
+        return rc;
+    }
+    for (more = unordered_set_first(source, &cursor); more;
+         more = unordered_set_next(source, &cursor)) {
+        const struct node *const item = *(struct node **) cursor.internal_link;
+        const unsigned long hash = unordered_set_hash_node(other, source, item);
+        if ((unordered_set_find(other, hash, item->key) != NULL)
+            != keep_common) {
+            continue;
+        }
+        rc = unordered_set_put_hash(me,
+                                    unordered_set_hash_node(me, source, item),
+                                    item->key);
+        if (rc != 0) {
+            unordered_set_remove_all(me);
+            return rc;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Stores the intersection of two unordered sets in an empty unordered set,
+ * which is every key that is in both of the unordered sets. Only the smaller of
+ * the two unordered sets is iterated over, and the buckets are reserved once up
+ * front. The stored hashes are reused between unordered sets which have the
+ * same hash function, so the hash function is not called for them. The
+ * unordered sets must all have the same key size and comparator function. If
+ * an error occurs, the unordered set is left empty.
+ *
+ * @param me  the empty unordered set to store the intersection in
+ * @param one the first unordered set
+ * @param two the second unordered set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered set is not empty or the key sizes do not
+ *                 match
+ */
+int unordered_set_intersect(unordered_set me,
+                            unordered_set one,
+                            unordered_set two)
+{
+    if (one->size > two->size) {
+        return unordered_set_filter(me, two, one, 1);
+    }
+    return unordered_set_filter(me, one, two, 1);
+}
+
+/**
+ * Stores the difference of two unordered sets in an empty unordered set, which
+ * is every key that is in the first unordered set but not in the second one.
+ * The buckets are reserved once up front, and the stored hashes are reused
+ * between unordered sets which have the same hash function. The unordered sets
+ * must all have the same key size and comparator function. If an error occurs,
+ * the unordered set is left empty.
+ *
+ * @param me  the empty unordered set to store the difference in
+ * @param one the unordered set to take the keys from
+ * @param two the unordered set of keys to leave out
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered set is not empty or the key sizes do not
+ *                 match
+ */
+int unordered_set_difference(unordered_set me,
+                             unordered_set one,
+                             unordered_set two)
+{
+    return unordered_set_filter(me, one, two, 0);
+}
+
+/**
+ * Adds every key of the other unordered set to the unordered set. The buckets
+ * are reserved once up front for the keys of both, and the stored hashes are
+ * reused if both have the same hash function. The unordered sets must have the
+ * same key size and comparator function. If an error occurs, some of the keys
+ * may already have been added.
+ *
+ * @param me    the unordered set to add to
+ * @param other the unordered set whose keys to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the key sizes do not match
+ */
+int unordered_set_union_into(unordered_set me, unordered_set other)
+{
+    struct unordered_set_cursor cursor;
+    int more;
+    int rc;
+    if (me->key_size != other->key_size) {
+        return -EINVAL;
+    }
+    if (me == other) {
+        return 0;
+    }
+    if (me->size > INT_MAX - other->size) {
+        return -EINVAL;
+    }
+    rc = unordered_set_reserve(me, me->size + other->size);
+    if (rc != 0) {
+        return rc;
+    }
+    for (more = unordered_set_first(other, &cursor); more;
+         more = unordered_set_next(other, &cursor)) {
+        const struct node *const item = *(struct node **) cursor.internal_link;
+        const unsigned long hash = unordered_set_hash_node(me, other, item);
+        rc = unordered_set_put_hash(me, hash, item->key);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the whole buffer to the file descriptor, retrying partial writes.
+ */
+static int unordered_set_write_all(const int fd,
+                                   const void *const data,
+                                   size_t size)
+{
+    const char *position = data;
+    while (size > 0) {
+        const ssize_t written = write(fd, position, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -EIO;
+        }
+        position += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+
+/*
+ * Fills the whole buffer from the file descriptor, retrying partial reads.
+ */
+static int unordered_set_read_all(const int fd,
+                                  void *const data,
+                                  size_t size)
+{
+    char *position = data;
+    while (size > 0) {
+        const ssize_t got = read(fd, position, size);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return -EIO;
+        }
+        position += got;
+        size -= (size_t) got;
+    }
+    return 0;
+}
+
+/*
+ * Grows the buckets while a snapshot is loaded, once the keys which have been
+ * read so far would not fit. The buckets are sized for twice as many, up to the
+ * count of the header, so that a whole snapshot takes few resizes, while a
+ * corrupt count cannot reserve more buckets than the snapshot has keys.
+ */
+static int unordered_set_load_reserve(unordered_set me,
+                                      const unsigned long needed,
+                                      const unsigned long count)
+{
+    unsigned long size = 2 * needed;
+    if (needed / me->max_load_factor + 1 <= me->capacity) {
+        return 0;
+    }
+    if (size > count) {
+        size = count;
+    }
+    return unordered_set_reserve(me, (int) size);
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the unordered set to a file descriptor. The
+ * snapshot consists of a header, which holds the key size and the amount of
+ * keys, followed by the stored hash and the key of each element. The hash seed
+ * is not written, so that it never leaves the process. Thus, loading the
+ * snapshot hashes the keys again if they use a built-in hash function. Since
+ * the keys are copied byte for byte, they should not contain pointers unless
+ * the snapshot is loaded by the same process.
+ *
+ * @param me the unordered set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int unordered_set_save(unordered_set me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size = sizeof(unsigned long) + me->key_size;
+    size_t buffer_size = SNAPSHOT_BUFFER_SIZE;
+    size_t used = 0;
+    char *buffer;
+    int rc;
+    int i;
+    unordered_set_migrate(me, me->old_capacity);
+    if (record_size > buffer_size) {
+        buffer_size = record_size;
+    }
+    buffer = malloc(buffer_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    header.count = (unsigned long) me->size;
+    rc = unordered_set_write_all(fd, &header,
+                                 sizeof(struct snapshot_header));
+    for (i = 0; rc == 0 && i < me->capacity; i++) {
+        const struct node *traverse = me->buckets[i];
+        while (rc == 0 && traverse) {
+            if (used + record_size > buffer_size) {
+                rc = unordered_set_write_all(fd, buffer, used);
+                used = 0;
+            }
+            memcpy(buffer + used, &traverse->hash, sizeof(unsigned long));
+            used += sizeof(unsigned long);
+            memcpy(buffer + used, traverse->key, me->key_size);
+            used += me->key_size;
+            traverse = traverse->next;
+        }
+    }
+    if (rc == 0) {
+        rc = unordered_set_write_all(fd, buffer, used);
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by unordered_set_save into an empty
+ * unordered set. The comparator is never called, since the keys of a snapshot
+ * are already distinct. The seed is not in the snapshot, so a fresh seed is
+ * picked. The stored hashes of a user-defined hash function do not depend on
+ * the seed, so they are reused without calling it. The built-in hash functions
+ * do depend on the seed, so each key is hashed again with the fresh seed. The
+ * buckets grow as the keys are read, rather than being sized from the count in
+ * the header, so that a corrupt count cannot reserve more buckets than the
+ * snapshot holds. Thus, the unordered set must have been initialized with the
+ * same key size and hash function as the unordered set which was saved. If an
+ * error occurs part of the way through the snapshot, the keys which have
+ * already been loaded remain in the unordered set.
+ *
+ * @param me the unordered set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered set is not empty or the
+ *                 snapshot does not match the unordered set
+ * @return -EIO    if the snapshot or the random bytes of the operating system
+ *                 could not be read
+ */
+int unordered_set_load(unordered_set me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size = sizeof(unsigned long) + me->key_size;
+    size_t batch_size = SNAPSHOT_BUFFER_SIZE / record_size;
+    unsigned long remaining;
+    char *buffer;
+    int rc;
+    if (me->size != 0) {
+        return -EINVAL;
+    }
+    rc = unordered_set_read_all(fd, &header,
+                                sizeof(struct snapshot_header));
+    if (rc != 0) {
+        return rc;
+    }
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION
+        || header.key_size != (unsigned long) me->key_size
+        || header.value_size != 0
+        || header.count > INT_MAX) {
+        return -EINVAL;
+    }
+    rc = containers_hash_new_seed(&me->seed, me);
+    if (rc != 0) {
+        return rc;
+    }
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+    buffer = malloc(batch_size * record_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    remaining = header.count;
+    while (remaining > 0) {
+        const char *record = buffer;
+        size_t batch = batch_size;
+        if (batch > remaining) {
+            batch = remaining;
+        }
+        rc = unordered_set_read_all(fd, buffer, batch * record_size);
+        if (rc != 0) {
+            break;
+        }
+        remaining -= batch;
+        rc = unordered_set_load_reserve(me, me->size + batch, header.count);
+        if (rc != 0) {
+            break;
+        }
+        for (; batch > 0; batch--) {
+            const char *const key = record + sizeof(unsigned long);
+            unsigned long hash;
+            struct node *add;
+            struct node **bucket;
+            memcpy(&hash, record, sizeof(unsigned long));
+            if (unordered_set_is_seeded(me)) {
+                hash = unordered_set_hash(me, key);
+            }
+            add = unordered_set_create_element(me, hash, key);
+            if (!add) {
+                free(buffer);
+                return -ENOMEM;
+            }
+            bucket = unordered_set_bucket(me, hash);
+            add->next = *bucket;
+            *bucket = add;
+            me->size++;
+            record += record_size;
+        }
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Clears the keys from the unordered set.
+ *
+ * @param me the unordered set to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_set_clear(unordered_set me)
+{
+    int i;
+    struct node **temp =
+            calloc((size_t) STARTING_BUCKETS, sizeof(struct node *));
+    if (!temp) {
+        return -ENOMEM;
+    }
+    unordered_set_migrate(me, me->old_capacity);
+    for (i = 0; i < me->capacity; i++) {
+        struct node *traverse = me->buckets[i];
+        while (traverse) {
+            struct node *const backup = traverse;
+            traverse = traverse->next;
+            free(backup->key);
+            free(backup);
+        }
+        me->buckets[i] = NULL;
+    }
+    me->size = 0;
+    me->capacity = STARTING_BUCKETS;
+    free(me->buckets);
+    me->buckets = temp;
+    return 0;
+}
+
+/**
+ * Frees the unordered set memory. Performing further operations after calling
+ * this function results in undefined behavior.
+ *
+ * @param me the unordered set to free from memory
+ *
+ * @return NULL
+ */
+unordered_set unordered_set_destroy(unordered_set me)
+{
+    unordered_set_clear(me);
+    free(me->buckets);
+    free(me);
+    return NULL;
+}
+#undef RESIZE_AT
+#undef RESIZE_RATIO
+#undef SNAPSHOT_BUFFER_SIZE
+#undef SNAPSHOT_MAGIC
+#undef SNAPSHOT_VERSION
+#undef STARTING_BUCKETS
+#undef node
+#undef snapshot_header
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_MMAP
+#define CONTAINERS_HAS_THREADS
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#define HEADER_SIZE vector_HEADER_SIZE
+#define HUGE_PAGE_SIZE vector_HUGE_PAGE_SIZE
+#define MAPPED_MAGIC vector_MAPPED_MAGIC
+#define PARALLEL_SORT_SIZE vector_PARALLEL_SORT_SIZE
+#define RESIZE_RATIO vector_RESIZE_RATIO
+#define START_SPACE vector_START_SPACE
+#define mapped_header vector_mapped_header
+#define parallel_sort vector_parallel_sort
+#define parallel_task vector_parallel_task
+static const int START_SPACE = 8;
+static const double RESIZE_RATIO = 1.5;
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t HEADER_SIZE = 64;
+static const char MAPPED_MAGIC[8] = "CNTRDATA";
+static const int PARALLEL_SORT_SIZE = 65536;
+
+struct internal_vector {
+    size_t bytes_per_item;
+    int item_count;
+    int item_capacity;
+    void *data;
+    int flags;
+    size_t mapped_size;
+    size_t map_offset;
+    int fd;
+};
+
+/*
+ * The header at the start of a mapped file. The data follows the header, at
+ * an offset of HEADER_SIZE bytes from the start of the file.
+ */
+struct mapped_header {
+    char magic[8];
+    unsigned long data_size;
+    unsigned long item_count;
+};
+
+/*
+ * The state of a parallel sort which is shared between the threads. The runs
+ * lie between consecutive bounds, and each merge phase merges them in pairs
+ * from one buffer into the other.
+ */
+struct parallel_sort {
+    char *from;
+    char *to;
+    size_t size;
+    int (*comparator)(const void *const one, const void *const two);
+    int count;
+    int thread_count;
+    int run_count;
+    int *bounds;
+};
+
+/*
+ * The part of a parallel sort which one thread does.
+ */
+struct parallel_task {
+    struct parallel_sort *sort;
+    int index;
+};
+
+/**
+ * Initializes a vector.
+ *
+ * @param data_size the size of each element in the vector; must be positive
+ *
+ * @return the newly-initialized vector, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+vector vector_init(const size_t data_size)
+{
+    struct internal_vector *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_vector));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = 0;
+    init->item_capacity = START_SPACE;
+    init->flags = 0;
+    init->mapped_size = 0;
+    init->map_offset = 0;
+    init->fd = -1;
+    init->data = malloc(init->item_capacity * init->bytes_per_item);
+    if (!init->data) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Rounds the amount of bytes up to the granularity of the mapping, which is
+ * the huge page size if huge pages were requested, otherwise the page size.
+ */
+static size_t vector_map_round(vector me, size_t size)
+{
+    size_t granularity = (size_t) sysconf(_SC_PAGESIZE);
+    if (me->flags & VECTOR_HUGE_PAGES) {
+        granularity = HUGE_PAGE_SIZE;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+/*
+ * Advises the kernel to back the mapping with transparent huge pages if the
+ * vector requested it.
+ */
+static void vector_map_advise(vector me)
+{
+#ifdef MADV_HUGEPAGE
+    if (me->flags & VECTOR_HUGE_PAGES) {
+        madvise((char *) me->data - me->map_offset, me->mapped_size,
+                MADV_HUGEPAGE);
+    }
+#else
+    (void) me;
+#endif
+}
+
+/*
+ * Sets the capacity based on how many items fit in the mapping.
+ */
+static void vector_map_capacity(vector me)
+{
+    const size_t capacity =
+            (me->mapped_size - me->map_offset) / me->bytes_per_item;
+    me->item_capacity = capacity > INT_MAX ? INT_MAX : (int) capacity;
+}
+
+/*
+ * Maps the file which is open as fd, and either validates its header or, if
+ * the file has just been created, writes the header. The item count of the
+ * header is rejected with -EINVAL if it does not fit in an int, or if it is
+ * larger than the capacity of the file.
+ */
+static int vector_map_file(vector me, const int fd, const int is_new)
+{
+    struct mapped_header *header;
+    const int is_read_only = me->flags & VECTOR_READ_ONLY;
+    void *const base = mmap(NULL, me->mapped_size, PROT_READ | PROT_WRITE,
+                            is_read_only ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    me->data = (char *) base + me->map_offset;
+    vector_map_capacity(me);
+    header = base;
+    if (is_new) {
+        memcpy(header->magic, MAPPED_MAGIC, sizeof(header->magic));
+        header->data_size = me->bytes_per_item;
+        header->item_count = 0;
+    } else if (memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) != 0
+               || header->data_size != me->bytes_per_item
+               || header->item_count > INT_MAX
+               || header->item_count > (unsigned long) me->item_capacity) {
+        munmap(base, me->mapped_size);
+        return -EINVAL;
+    }
+    me->item_count = (int) header->item_count;
+    vector_map_advise(me);
+    return 0;
+}
+
+/*
+ * Opens the file at path, creating it if requested, and maps it.
+ */
+static int vector_open_file(vector me, const char *const path)
+{
+    struct stat info;
+    int is_new = 0;
+    int mode = O_RDWR;
+    int rc;
+    int fd;
+    if (me->flags & VECTOR_READ_ONLY) {
+        mode = O_RDONLY;
+    } else if (me->flags & VECTOR_CREATE) {
+        mode |= O_CREAT;
+    }
+    fd = open(path, mode, 0644);
+    if (fd == -1) {
+        return -EIO;
+    }
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return -EIO;
+    }
+    me->mapped_size = (size_t) info.st_size;
+    if (me->mapped_size == 0 && (me->flags & VECTOR_CREATE)
+        && !(me->flags & VECTOR_READ_ONLY)) {
+        is_new = 1;
+        me->mapped_size = vector_map_round(me, me->map_offset
+                                               + START_SPACE
+                                                 * me->bytes_per_item);
+        if (ftruncate(fd, (off_t) me->mapped_size) == -1) {
+            close(fd);
+            return -ENOMEM;
+        }
+    }
+    rc = -EINVAL;
+    if (me->mapped_size >= me->map_offset) {
+        rc = vector_map_file(me, fd, is_new);
+    }
+    if (rc != 0) {
+        close(fd);
+        return rc;
+    }
+    if (me->flags & VECTOR_READ_ONLY) {
+        close(fd);
+    } else {
+        me->fd = fd;
+    }
+    return 0;
+}
+
+#endif
+
+/**
+ * Initializes a vector which stores its data in an anonymous memory mapping
+ * rather than on the heap. The mapping grows and shrinks by remapping its pages
+ * rather than by copying the data, which makes it suitable for vectors which
+ * are several gigabytes in size. If VECTOR_HUGE_PAGES is specified in the
+ * flags, the mapping is sized in multiples of the huge page size and the
+ * kernel is advised to back it with transparent huge pages, which reduces TLB
+ * pressure when scanning the data. On platforms without memory mappings, the
+ * vector is stored on the heap instead.
+ *
+ * @param data_size the size of each element in the vector; must be positive
+ * @param flags     either 0 or VECTOR_HUGE_PAGES
+ *
+ * @return the newly-initialized vector, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+vector vector_init_mapped(const size_t data_size, const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_vector *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_vector));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = 0;
+    init->flags = flags;
+    init->map_offset = 0;
+    init->fd = -1;
+    init->mapped_size = vector_map_round(init, START_SPACE * data_size);
+    init->data = mmap(NULL, init->mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (init->data == MAP_FAILED) {
+        free(init);
+        return NULL;
+    }
+    vector_map_capacity(init);
+    vector_map_advise(init);
+    return init;
+#else
+    (void) flags;
+    return vector_init(data_size);
+#endif
+}
+
+/**
+ * Opens a vector which is backed by the file at the specified path. The file
+ * is memory-mapped, so opening a prebuilt file takes constant time regardless
+ * of its size, and the data is neither parsed nor copied. The file starts with
+ * a small header which records the size of each element and the amount of
+ * elements, followed by the contiguous elements.
+ *
+ * By default, the file is mapped as shared and writable, thus modifications to
+ * the vector are written to the file, and the file grows as the vector grows.
+ * If VECTOR_READ_ONLY is specified in the flags, the file is opened as
+ * read-only and its pages are shared with every other process which maps the
+ * file. Modifications to a read-only vector are private to it and are never
+ * written to the file. If VECTOR_CREATE is specified in the flags, the file is
+ * created if it does not exist yet. If VECTOR_HUGE_PAGES is specified in the
+ * flags, the kernel is advised to back the mapping with huge pages.
+ *
+ * The file stores the raw bytes of the elements, thus it should only be opened
+ * on a machine with the same data representation as the one it was written on.
+ *
+ * @param path      the path of the file to back the vector with
+ * @param data_size the size of each element in the vector; must be positive
+ *                  and must match the element size which the file was created
+ *                  with
+ * @param flags     a combination of VECTOR_READ_ONLY, VECTOR_CREATE and
+ *                  VECTOR_HUGE_PAGES
+ *
+ * @return the newly-opened vector, or NULL if it was not successfully opened
+ *         due to either invalid input arguments, the file not being a valid
+ *         vector file, an error opening or mapping the file, or memory
+ *         allocation error
+ */
+vector vector_open_mapped(const char *const path,
+                          const size_t data_size,
+                          const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_vector *init;
+    if (!path || data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_vector));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->flags = flags;
+    init->map_offset = HEADER_SIZE;
+    init->fd = -1;
+    if (vector_open_file(init, path) != 0) {
+        free(init);
+        return NULL;
+    }
+    return init;
+#else
+    (void) path;
+    (void) data_size;
+    (void) flags;
+    return NULL;
+#endif
+}
+
+/**
+ * Gets the size being used by the vector.
+ *
+ * @param me the vector to check
+ *
+ * @return the size being used by the vector
+ */
+int vector_size(vector me)
+{
+    return me->item_count;
+}
+
+/**
+ * Gets the capacity that the internal storage of the vector is using.
+ *
+ * @param me the vector to check
+ *
+ * @return the capacity that the internal storage of the vector is using
+ */
+int vector_capacity(vector me)
+{
+    return me->item_capacity;
+}
+
+/**
+ * Determines whether or not the vector is empty.
+ *
+ * @param me the vector to check
+ *
+ * @return 1 if the vector is empty, otherwise 0
+ */
+int vector_is_empty(vector me)
+{
+    return vector_size(me) == 0;
+}
+
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Sets the space of a file-backed buffer by resizing the file and remapping
+ * it. The data is never copied since it lives in the file.
+ */
+static int vector_set_file_space(vector me, const int size)
+{
+    char *const base = (char *) me->data - me->map_offset;
+    const size_t new_size =
+            vector_map_round(me, me->map_offset + size * me->bytes_per_item);
+    void *temp;
+    if (new_size == me->mapped_size) {
+        return 0;
+    }
+    if (new_size > me->mapped_size
+        && ftruncate(me->fd, (off_t) new_size) == -1) {
+        return -ENOMEM;
+    }
+#ifdef MREMAP_MAYMOVE
+    temp = mremap(base, me->mapped_size, new_size, MREMAP_MAYMOVE);
+#else
+    temp = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, me->fd, 0);
+    if (temp != MAP_FAILED) {
+        munmap(base, me->mapped_size);
+    }
+#endif
+    /*
+     * Truncating the file back after a failed remap, or down after a shrink,
+     * only gives back space. If it fails, the file is left larger than the
+     * mapping, which is harmless: the header holds the count, and the extra
+     * space is reused by the next resize or open.
+     */
+    if (temp == MAP_FAILED) {
+        if (new_size > me->mapped_size) {
+            (void) ftruncate(me->fd, (off_t) me->mapped_size);
+        }
+        return -ENOMEM;
+    }
+    if (new_size < me->mapped_size) {
+        (void) ftruncate(me->fd, (off_t) new_size);
+    }
+    me->data = (char *) temp + me->map_offset;
+    me->mapped_size = new_size;
+    vector_map_capacity(me);
+    vector_map_advise(me);
+    return 0;
+}
+
+/*
+ * Moves the data of a read-only file-backed buffer into an anonymous mapping,
+ * since a private file mapping cannot grow past the end of the file.
+ */
+static int vector_detach_file_space(vector me, const int size)
+{
+    char *const base = (char *) me->data - me->map_offset;
+    const size_t old_size = me->mapped_size;
+    const size_t new_size = vector_map_round(me, size * me->bytes_per_item);
+    void *const temp = mmap(NULL, new_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (temp == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    memcpy(temp, me->data, me->item_count * me->bytes_per_item);
+    munmap(base, old_size);
+    me->data = temp;
+    me->mapped_size = new_size;
+    me->map_offset = 0;
+    vector_map_capacity(me);
+    vector_map_advise(me);
+    return 0;
+}
+
+/*
+ * Sets the space of a mapped buffer. The pages are remapped rather than copied
+ * when the platform supports it, and shrinking only releases the tail pages.
+ */
+static int vector_set_mapped_space(vector me, const int size)
+{
+    const size_t new_size = vector_map_round(me, size * me->bytes_per_item);
+    void *temp;
+    if (new_size == me->mapped_size) {
+        return 0;
+    }
+#ifdef MREMAP_MAYMOVE
+    temp = mremap(me->data, me->mapped_size, new_size, MREMAP_MAYMOVE);
+    if (temp == MAP_FAILED) {
+        return -ENOMEM;
+    }
+#else
+    if (new_size < me->mapped_size) {
+        munmap((char *) me->data + new_size, me->mapped_size - new_size);
+        me->mapped_size = new_size;
+        vector_map_capacity(me);
+        return 0;
+    }
+    temp = mmap(NULL, new_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (temp == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    memcpy(temp, me->data, me->item_count * me->bytes_per_item);
+    munmap(me->data, me->mapped_size);
+#endif
+    me->data = temp;
+    me->mapped_size = new_size;
+    vector_map_capacity(me);
+    vector_map_advise(me);
+    return 0;
+}
+
+#endif
+
+/*
+ * Sets the space of the buffer. Assumes that size is at least the same as the
+ * number of items currently in the vector.
+ */
+static int vector_set_space(vector me, const int size)
+{
+    void *temp;
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->map_offset && me->fd != -1) {
+        return vector_set_file_space(me, size);
+    }
+    if (me->map_offset) {
+        return vector_detach_file_space(me, size);
+    }
+    if (me->mapped_size) {
+        return vector_set_mapped_space(me, size);
+    }
+#endif
+    temp = realloc(me->data, size * me->bytes_per_item);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    me->data = temp;
+    me->item_capacity = size;
+    return 0;
+}
+
+/**
+ * Reserves space specified. If more space than specified is already reserved,
+ * then the previous space will be kept.
+ *
+ * @param me   the vector to reserve space for
+ * @param size the space to reserve
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_reserve(vector me, int size)
+{
+    if (me->item_capacity >= size) {
+        return 0;
+    }
+    return vector_set_space(me, size);
+}
+
+/**
+ * Sets the size of the vector buffer to the current size being used.
+ *
+ * @param me the vector to trim
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_trim(vector me)
+{
+    return vector_set_space(me, me->item_count);
+}
+
+/**
+ * Writes the elements of a file-backed vector to its file, and waits for the
+ * write to complete. The amount of elements is recorded in the file when the
+ * vector is synchronized or destroyed. For vectors which are not backed by a
+ * file, or which were opened as read-only, this has no effect.
+ *
+ * @param me the vector to synchronize
+ *
+ * @return 0    if no error
+ * @return -EIO if the file could not be written
+ */
+int vector_sync(vector me)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct mapped_header *header;
+    if (!me->map_offset || me->fd == -1) {
+        return 0;
+    }
+    header = (struct mapped_header *) ((char *) me->data - me->map_offset);
+    header->item_count = (unsigned long) me->item_count;
+    if (msync(header, me->mapped_size, MS_SYNC) == -1) {
+        return -EIO;
+    }
+#else
+    (void) me;
+#endif
+    return 0;
+}
+
+/**
+ * Copies the vector to an array. Since it is a copy, the array may be modified
+ * without causing side effects to the vector data structure. Memory is not
+ * allocated, thus the array being used for the copy must be allocated before
+ * this function is called. The size of the vector should be queried prior to
+ * calling this function, which also serves as the size of the newly-copied
+ * array.
+ *
+ * @param arr the initialized array to copy the vector to
+ * @param me  the vector to copy to the array
+ */
+void vector_copy_to_array(void *const arr, vector me)
+{
+    memcpy(arr, me->data, me->item_count * me->bytes_per_item);
+}
+
+/**
+ * Gets the storage element of the vector structure. The storage element is
+ * contiguous in memory. The data pointer should be assigned to the correct
+ * array type. For example, if the vector holds integers, the data pointer
+ * should be assigned to an integer array. The size of the vector should be
+ * obtained prior to calling this function, which also serves as the size of
+ * the queried array. This pointer is not a copy, thus any modification to the
+ * data will cause the vector structure data to be modified. Operations using
+ * the vector functions may invalidate this pointer. The vector owns this
+ * memory, thus it should not be freed.
+ *
+ * @param me the vector to get the storage element from
+ *
+ * @return the storage element of the vector
+ */
+void *vector_get_data(vector me)
+{
+    return me->data;
+}
+
+/**
+ * Sorts the elements of the vector in ascending order according to the
+ * comparator. The built-in scalar comparators from compare.h select a radix
+ * sort when they match the element size, and any other comparator is used by
+ * an introsort. The sort is not stable.
+ *
+ * @param me         the vector to sort
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ */
+void vector_sort(vector me,
+                 int (*const comparator)(const void *const one,
+                                         const void *const two))
+{
+    containers_sort(me->data, me->item_count, me->bytes_per_item, comparator);
+}
+
+/**
+ * Gets the index of the first element of the vector which is not less than the
+ * key, which is the size of the vector if there is no such element. The vector
+ * must be sorted in ascending order according to the comparator. The search
+ * is branchless, so it does not suffer branch mispredictions.
+ *
+ * @param me         the vector to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the first element which is not less than the key
+ */
+int vector_lower_bound(vector me,
+                       void *const key,
+                       int (*const comparator)(const void *const one,
+                                               const void *const two))
+{
+    return containers_lower_bound(me->data, me->item_count, me->bytes_per_item,
+                                  key, comparator);
+}
+
+/**
+ * Rearranges the elements of the vector, which must be sorted in ascending
+ * order, into Eytzinger order. This is the breadth-first order of an implicit
+ * binary search tree, which makes searches of large vectors cache-friendly. The
+ * vector is no longer sorted afterwards, and must be searched with
+ * vector_eytzinger_lower_bound.
+ *
+ * @param me the vector to rearrange
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_eytzinger_layout(vector me)
+{
+    return containers_eytzinger_layout(me->data, me->item_count,
+                                       me->bytes_per_item);
+}
+
+/**
+ * Gets the index of the smallest element of the vector which is not less than
+ * the key, which is the size of the vector if there is no such element. The
+ * vector must have been rearranged with vector_eytzinger_layout. The search
+ * prefetches the elements it visits a few steps ahead, so on vectors far larger
+ * than the cache it is much faster than vector_lower_bound.
+ *
+ * @param me         the vector to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the smallest element which is not less than the key
+ */
+int vector_eytzinger_lower_bound(vector me,
+                                 void *const key,
+                                 int (*const comparator)(const void *const one,
+                                                         const void *const two))
+{
+    return containers_eytzinger_lower_bound(me->data, me->item_count,
+                                            me->bytes_per_item, key,
+                                            comparator);
+}
+
+#ifdef CONTAINERS_HAS_THREADS
+
+/*
+ * Gets the start of the part with the specified index, when the elements are
+ * split into the specified amount of parts which differ in size by at most one.
+ */
+static int vector_part_start(const int count, const int parts, const int index)
+{
+    const int remainder = count % parts;
+    return index * (count / parts) + (index < remainder ? index : remainder);
+}
+
+/*
+ * Compares two elements of a parallel sort.
+ */
+static int vector_merge_compare(const struct parallel_sort *const sort,
+                                const void *const one,
+                                const void *const two)
+{
+    return CONTAINERS_COMPARE(sort->comparator, sort->size, one, two);
+}
+
+/*
+ * Finds how many of the first k merged elements come from the first run, so
+ * that a merge can be split at any position. Elements of the first run come
+ * before equal elements of the second run.
+ */
+static int vector_merge_split(const struct parallel_sort *const sort,
+                              const char *const one,
+                              const int one_count,
+                              const char *const two,
+                              const int two_count,
+                              const int k)
+{
+    const size_t size = sort->size;
+    int low = k > two_count ? k - two_count : 0;
+    int high = k < one_count ? k : one_count;
+    while (low < high) {
+        const int i = low + (high - low) / 2;
+        if (vector_merge_compare(sort, one + i * size,
+                                 two + (k - i - 1) * size) <= 0) {
+            low = i + 1;
+        } else {
+            high = i;
+        }
+    }
+    return low;
+}
+
+/*
+ * Merges the elements of a range of the output of a pair of runs.
+ */
+static void vector_merge_range(const struct parallel_sort *const sort,
+                               const int pair,
+                               const int low,
+                               const int high)
+{
+    const size_t size = sort->size;
+    const int start = sort->bounds[2 * pair];
+    const int middle = sort->bounds[2 * pair + 1];
+    const int end = 2 * pair + 2 <= sort->run_count
+                    ? sort->bounds[2 * pair + 2] : middle;
+    const char *const one = sort->from + start * size;
+    const char *const two = sort->from + middle * size;
+    const int one_start = vector_merge_split(sort, one, middle - start, two,
+                                             end - middle, low - start);
+    const int one_end = vector_merge_split(sort, one, middle - start, two,
+                                           end - middle, high - start);
+    const char *first = one + one_start * size;
+    const char *const first_end = one + one_end * size;
+    const char *second = two + (low - start - one_start) * size;
+    const char *const second_end = two + (high - start - one_end) * size;
+    char *out = sort->to + low * size;
+    while (first < first_end && second < second_end) {
+        if (vector_merge_compare(sort, second, first) < 0) {
+            memcpy(out, second, size);
+            second += size;
+        } else {
+            memcpy(out, first, size);
+            first += size;
+        }
+        out += size;
+    }
+    memcpy(out, first, first_end - first);
+    out += first_end - first;
+    memcpy(out, second, second_end - second);
+}
+
+/*
+ * Does the part of the current phase of the sort which belongs to a thread.
+ * In the first phase, each thread sorts its own run. In each merge phase, the
+ * output is split evenly between the threads, and each thread merges the part
+ * of each pair of runs which falls within its share of the output.
+ */
+static void *vector_parallel_sort_task(void *const argument)
+{
+    const struct parallel_task *const task = argument;
+    const struct parallel_sort *const sort = task->sort;
+    const int low = vector_part_start(sort->count, sort->thread_count,
+                                      task->index);
+    const int high = vector_part_start(sort->count, sort->thread_count,
+                                       task->index + 1);
+    int pair;
+    if (!sort->to) {
+        containers_sort(sort->from + low * sort->size, high - low, sort->size,
+                        sort->comparator);
+        return NULL;
+    }
+    for (pair = 0; 2 * pair < sort->run_count; pair++) {
+        const int start = sort->bounds[2 * pair];
+        const int end = sort->bounds[2 * pair + 2 <= sort->run_count
+                                     ? 2 * pair + 2 : sort->run_count];
+        if (start < high && end > low) {
+            vector_merge_range(sort, pair, start > low ? start : low,
+                               end < high ? end : high);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Runs the current phase of the sort on all the threads, where the calling
+ * thread does the first part. If a thread cannot be created, the calling
+ * thread does its part as well.
+ */
+static void vector_parallel_sort_phase(struct parallel_sort *const sort,
+                                       struct parallel_task *const tasks,
+                                       pthread_t *const threads,
+                                       char *const started)
+{
+    int i;
+    for (i = 1; i < sort->thread_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL,
+                                    vector_parallel_sort_task, &tasks[i]) == 0;
+        if (!started[i]) {
+            vector_parallel_sort_task(&tasks[i]);
+        }
+    }
+    vector_parallel_sort_task(&tasks[0]);
+    for (i = 1; i < sort->thread_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+#endif
+
+/**
+ * Sorts the elements of the vector in ascending order according to the
+ * comparator, using multiple threads. The vector is split into a run per
+ * thread, each thread sorts its run as vector_sort does, and then the runs are
+ * merged in pairs until one is left. Each merge is split evenly between all the
+ * threads by output position, so that all of them are busy in every merge
+ * phase. Thus, the comparator is called from multiple threads at the same time.
+ * Fewer threads are used when each would get only a small amount of elements,
+ * and a single thread is used on platforms without POSIX threads. The sort is
+ * not stable.
+ *
+ * @param me           the vector to sort
+ * @param comparator   the comparator function which compares two elements;
+ *                     must be safe to call from multiple threads at once
+ * @param thread_count the amount of threads to use, or zero to use one per
+ *                     online processor
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the thread count is negative
+ */
+int vector_parallel_sort(vector me,
+                         int (*const comparator)(const void *const one,
+                                                 const void *const two),
+                         int thread_count)
+{
+#ifdef CONTAINERS_HAS_THREADS
+    struct parallel_sort sort;
+    struct parallel_task *tasks;
+    pthread_t *threads;
+    char *started;
+    char *temp;
+    int i;
+    if (thread_count < 0) {
+        return -EINVAL;
+    }
+    if (thread_count == 0) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = processors > 0 && processors < INT_MAX
+                       ? (int) processors : 1;
+    }
+    if (thread_count > me->item_count / PARALLEL_SORT_SIZE) {
+        thread_count = me->item_count / PARALLEL_SORT_SIZE;
+    }
+    if (thread_count <= 1) {
+        vector_sort(me, comparator);
+        return 0;
+    }
+    temp = malloc(me->item_count * me->bytes_per_item);
+    sort.bounds = malloc((thread_count + 1) * sizeof(int));
+    tasks = malloc(thread_count * sizeof(struct parallel_task));
+    threads = malloc(thread_count * sizeof(pthread_t));
+    started = malloc((size_t) thread_count);
+    if (!temp || !sort.bounds || !tasks || !threads || !started) {
+        free(temp);
+        free(sort.bounds);
+        free(tasks);
+        free(threads);
+        free(started);
+        return -ENOMEM;
+    }
+    sort.from = me->data;
+    sort.to = NULL;
+    sort.size = me->bytes_per_item;
+    sort.comparator = comparator;
+    sort.count = me->item_count;
+    sort.thread_count = thread_count;
+    sort.run_count = thread_count;
+    for (i = 0; i < thread_count; i++) {
+        tasks[i].sort = &sort;
+        tasks[i].index = i;
+    }
+    for (i = 0; i <= thread_count; i++) {
+        sort.bounds[i] = vector_part_start(sort.count, thread_count, i);
+    }
+    vector_parallel_sort_phase(&sort, tasks, threads, started);
+    sort.to = temp;
+    while (sort.run_count > 1) {
+        char *const merged = sort.to;
+        vector_parallel_sort_phase(&sort, tasks, threads, started);
+        for (i = 0; 2 * i < sort.run_count; i++) {
+            sort.bounds[i] = sort.bounds[2 * i];
+        }
+        sort.run_count = (sort.run_count + 1) / 2;
+        sort.bounds[sort.run_count] = sort.count;
+        sort.to = sort.from;
+        sort.from = merged;
+    }
+    if (sort.from != me->data) {
+        memcpy(me->data, sort.from, me->item_count * me->bytes_per_item);
+    }
+    free(temp);
+    free(sort.bounds);
+    free(tasks);
+    free(threads);
+    free(started);
+    return 0;
+#else
+    if (thread_count < 0) {
+        return -EINVAL;
+    }
+    vector_sort(me, comparator);
+    return 0;
+#endif
+}
+
+/**
+ * Adds an element to the start of the vector. The pointer to the data being
+ * passed in should point to the data type which this vector holds. For example,
+ * if this vector holds integers, the data pointer should be a pointer to an
+ * integer. Since the data is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me   the vector to add to
+ * @param data the data to add to the vector
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_add_first(vector me, void *const data)
+{
+    return vector_add_at(me, 0, data);
+}
+
+/**
+ * Adds an element to the location specified. The pointer to the data being
+ * passed in should point to the data type which this vector holds. For example,
+ * if this vector holds integers, the data pointer should be a pointer to an
+ * integer. Since the data is being copied, the pointer only has to be valid
+ * when this function is called.
+ *
+ * @param me    the vector to add to
+ * @param index the location in the vector to add the data to
+ * @param data  the data to add to the vector
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if invalid argument
+ */
+int vector_add_at(vector me, const int index, void *const data)
+{
+    if (index < 0 || index > me->item_count) {
+        return -EINVAL;
+    }
+    if (me->item_count + 1 >= me->item_capacity) {
+        const int new_space = (int) (me->item_capacity * RESIZE_RATIO);
+        const int rc = vector_set_space(me, new_space);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    if (index != me->item_count) {
+        memmove((char *) me->data + (index + 1) * me->bytes_per_item,
+                (char *) me->data + index * me->bytes_per_item,
+                (me->item_count - index) * me->bytes_per_item);
+    }
+    memcpy((char *) me->data + index * me->bytes_per_item, data,
+           me->bytes_per_item);
+    me->item_count++;
+    return 0;
+}
+
+/**
+ * Adds an element to the end of the vector.
+ *
+ * @param me   the vector to add to
+ * @param data the data to add to the vector
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_add_last(vector me, void *const data)
+{
+    return vector_add_at(me, me->item_count, data);
+}
+
+/*
+ * Determines if the input is illegal.
+ */
+static int vector_is_illegal_input(vector me, const int index)
+{
+    return index < 0 || index >= me->item_count;
+}
+
+/**
+ * Removes the first element from the vector.
+ *
+ * @param me the vector to remove from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_remove_first(vector me)
+{
+    return vector_remove_at(me, 0);
+}
+
+/**
+ * Removes element based on its index.
+ *
+ * @param me    the vector to remove from
+ * @param index the location in the vector to remove the data from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_remove_at(vector me, const int index)
+{
+    if (vector_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    me->item_count--;
+    memmove((char *) me->data + index * me->bytes_per_item,
+            (char *) me->data + (index + 1) * me->bytes_per_item,
+            (me->item_count - index) * me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Removes the last element from the vector.
+ *
+ * @param me the vector to remove from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_remove_last(vector me)
+{
+    if (me->item_count == 0) {
+        return -EINVAL;
+    }
+    me->item_count--;
+    return 0;
+}
+
+/**
+ * Sets the data for the first element in the vector. The pointer to the data
+ * being passed in should point to the data type which this vector holds. For
+ * example, if this vector holds integers, the data pointer should be a pointer
+ * to an integer. Since the data is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me   the vector to set data for
+ * @param data the data to set at the start of the vector
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_set_first(vector me, void *const data)
+{
+    return vector_set_at(me, 0, data);
+}
+
+/**
+ * Sets the data for a specified element in the vector. The pointer to the data
+ * being passed in should point to the data type which this vector holds. For
+ * example, if this vector holds integers, the data pointer should be a pointer
+ * to an integer. Since the data is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me    the vector to set data for
+ * @param index the location to set data at in the vector
+ * @param data  the data to set at the location in the vector
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_set_at(vector me, const int index, void *const data)
+{
+    if (vector_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    memcpy((char *) me->data + index * me->bytes_per_item, data,
+           me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the data for the last element in the vector. The pointer to the data
+ * being passed in should point to the data type which this vector holds. For
+ * example, if this vector holds integers, the data pointer should be a pointer
+ * to an integer. Since the data is being copied, the pointer only has to be
+ * valid when this function is called.
+ *
+ * @param me   the vector to set data for
+ * @param data the data to set at the end of the vector
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_set_last(vector me, void *const data)
+{
+    return vector_set_at(me, me->item_count - 1, data);
+}
+
+/**
+ * Copies the first element of the vector to data. The pointer to the data being
+ * obtained should point to the data type which this vector holds. For example,
+ * if this vector holds integers, the data pointer should be a pointer to an
+ * integer. Since this data is being copied from the array to the data pointer,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param data the data to copy to
+ * @param me   the vector to copy from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_get_first(void *const data, vector me)
+{
+    return vector_get_at(data, me, 0);
+}
+
+/**
+ * Copies the element at index of the vector to data. The pointer to the data
+ * being obtained should point to the data type which this vector holds. For
+ * example, if this vector holds integers, the data pointer should be a pointer
+ * to an integer. Since this data is being copied from the array to the data
+ * pointer, the pointer only has to be valid when this function is called.
+ *
+ * @param data  the data to copy to
+ * @param me    the vector to copy from
+ * @param index the index to copy from in the vector
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_get_at(void *const data, vector me, const int index)
+{
+    if (vector_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    memcpy(data, (char *) me->data + index * me->bytes_per_item,
+           me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Copies the last element of the vector to data. The pointer to the data being
+ * obtained should point to the data type which this vector holds. For example,
+ * if this vector holds integers, the data pointer should be a pointer to an
+ * integer. Since this data is being copied from the array to the data pointer,
+ * the pointer only has to be valid when this function is called.
+ *
+ * @param data the data to copy to
+ * @param me   the vector to copy from
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int vector_get_last(void *const data, vector me)
+{
+    return vector_get_at(data, me, me->item_count - 1);
+}
+
+/**
+ * Clears the elements from the vector.
+ *
+ * @param me the vector to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_clear(vector me)
+{
+    me->item_count = 0;
+    return vector_set_space(me, START_SPACE);
+}
+
+/**
+ * Frees the vector memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the vector to free from memory
+ *
+ * @return NULL
+ */
+vector vector_destroy(vector me)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->map_offset && me->fd != -1) {
+        struct mapped_header *const header = (struct mapped_header *)
+                ((char *) me->data - me->map_offset);
+        header->item_count = (unsigned long) me->item_count;
+        munmap(header, me->mapped_size);
+        close(me->fd);
+        me->mapped_size = 0;
+    } else if (me->mapped_size) {
+        munmap((char *) me->data - me->map_offset, me->mapped_size);
+        me->mapped_size = 0;
+    } else {
+        free(me->data);
+    }
+#else
+    free(me->data);
+#endif
+    me->data = NULL;
+    free(me);
+    return NULL;
+}
+#undef HEADER_SIZE
+#undef HUGE_PAGE_SIZE
+#undef MAPPED_MAGIC
+#undef PARALLEL_SORT_SIZE
+#undef RESIZE_RATIO
+#undef START_SPACE
+#undef mapped_header
+#undef parallel_sort
+#undef parallel_task
+
+#endif /* CONTAINERS_IMPLEMENTATION */
@@ -20,14 +20,50 @@
  * SOFTWARE.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/array.h"
+#include "include/sort.h"
+#include "include/search.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t HEADER_SIZE = 64;
+static const char MAPPED_MAGIC[8] = "CNTRDATA";
 
 struct internal_array {
     size_t bytes_per_item;
     int item_count;
     void *data;
+    size_t mapped_size;
+    size_t map_offset;
+};
+
+/*
+ * The header at the start of a mapped file. The data follows the header, at
+ * an offset of HEADER_SIZE bytes from the start of the file. This is the same
+ * format as mapped vector files.
+ */
+struct mapped_header {
+    char magic[8];
+    unsigned long data_size;
+    unsigned long item_count;
 };
 
 /**
@@ -53,6 +89,8 @@ array array_init(const int element_count, const size_t data_size)
     }
     init->bytes_per_item = data_size;
     init->item_count = element_count;
+    init->mapped_size = 0;
+    init->map_offset = 0;
     if (init->item_count == 0) {
         init->data = NULL;
         return init;
@@ -65,6 +103,233 @@ array array_init(const int element_count, const size_t data_size)
     return init;
 }
 
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Rounds the amount of bytes up to the granularity of the mapping, which is
+ * the huge page size if huge pages were requested, otherwise the page size.
+ */
+static size_t array_map_round(const size_t size, const int flags)
+{
+    size_t granularity = (size_t) sysconf(_SC_PAGESIZE);
+    if (flags & ARRAY_HUGE_PAGES) {
+        granularity = HUGE_PAGE_SIZE;
+    }
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+/*
+ * Advises the kernel to back the mapping with transparent huge pages if the
+ * array requested it.
+ */
+static void array_map_advise(array me, const int flags)
+{
+#ifdef MADV_HUGEPAGE
+    if (flags & ARRAY_HUGE_PAGES) {
+        madvise((char *) me->data - me->map_offset, me->mapped_size,
+                MADV_HUGEPAGE);
+    }
+#else
+    (void) me;
+    (void) flags;
+#endif
+}
+
+#endif
+
+/**
+ * Initializes an array which stores its data in an anonymous memory mapping
+ * rather than on the heap. The elements are zero-initialized. If
+ * ARRAY_HUGE_PAGES is specified in the flags, the mapping is sized in multiples
+ * of the huge page size and the kernel is advised to back it with transparent
+ * huge pages, which reduces TLB pressure when scanning the data. On platforms
+ * without memory mappings, the array is stored on the heap instead.
+ *
+ * @param element_count the number of elements in the array; must not be
+ *                      negative
+ * @param data_size     the size of each element in the array; must be positive
+ * @param flags         either 0 or ARRAY_HUGE_PAGES
+ *
+ * @return the newly-initialized array, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+array array_init_mapped(const int element_count,
+                        const size_t data_size,
+                        const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_array *init;
+    if (element_count <= 0 || data_size == 0) {
+        return array_init(element_count, data_size);
+    }
+    init = malloc(sizeof(struct internal_array));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = element_count;
+    init->map_offset = 0;
+    init->mapped_size = array_map_round(element_count * data_size, flags);
+    init->data = mmap(NULL, init->mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (init->data == MAP_FAILED) {
+        free(init);
+        return NULL;
+    }
+    array_map_advise(init, flags);
+    return init;
+#else
+    (void) flags;
+    return array_init(element_count, data_size);
+#endif
+}
+
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Maps the file which is open as fd, and either validates its header or, if
+ * the file has just been created, writes the header. The item count of the
+ * header is rejected with -EINVAL if it does not fit in an int, or if the
+ * file is too small to hold that many elements.
+ */
+static int array_map_file(array me, const int fd, const int is_new,
+                          const int flags)
+{
+    struct mapped_header *header;
+    void *const base = mmap(NULL, me->mapped_size, PROT_READ | PROT_WRITE,
+                            (flags & ARRAY_READ_ONLY) ? MAP_PRIVATE
+                                                      : MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    header = base;
+    if (is_new) {
+        memcpy(header->magic, MAPPED_MAGIC, sizeof(header->magic));
+        header->data_size = me->bytes_per_item;
+        header->item_count = (unsigned long) me->item_count;
+    } else if (memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) != 0
+               || header->data_size != me->bytes_per_item
+               || header->item_count > INT_MAX
+               || header->item_count > (me->mapped_size - me->map_offset)
+                                       / me->bytes_per_item) {
+        munmap(base, me->mapped_size);
+        return -EINVAL;
+    }
+    me->item_count = (int) header->item_count;
+    me->data = (char *) base + me->map_offset;
+    array_map_advise(me, flags);
+    return 0;
+}
+
+/*
+ * Opens the file at path, creating it if requested, and maps it.
+ */
+static int array_open_file(array me, const char *const path, const int flags)
+{
+    struct stat info;
+    int is_new = 0;
+    int mode = O_RDWR;
+    int rc;
+    int fd;
+    if (flags & ARRAY_READ_ONLY) {
+        mode = O_RDONLY;
+    } else if (flags & ARRAY_CREATE) {
+        mode |= O_CREAT;
+    }
+    fd = open(path, mode, 0644);
+    if (fd == -1) {
+        return -EIO;
+    }
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return -EIO;
+    }
+    me->mapped_size = (size_t) info.st_size;
+    if (me->mapped_size == 0 && (flags & ARRAY_CREATE)
+        && !(flags & ARRAY_READ_ONLY)) {
+        is_new = 1;
+        me->mapped_size = me->map_offset + me->item_count * me->bytes_per_item;
+        if (ftruncate(fd, (off_t) me->mapped_size) == -1) {
+            close(fd);
+            return -ENOMEM;
+        }
+    }
+    rc = -EINVAL;
+    if (me->mapped_size >= me->map_offset) {
+        rc = array_map_file(me, fd, is_new, flags);
+    }
+    close(fd);
+    return rc;
+}
+
+#endif
+
+/**
+ * Opens an array which is backed by the file at the specified path. The file
+ * is memory-mapped, so opening a prebuilt file takes constant time regardless
+ * of its size, and the data is neither parsed nor copied. The file uses the
+ * same format as files opened with vector_open_mapped, thus an array may be
+ * opened from a file which was built using a vector.
+ *
+ * By default, the file is mapped as shared and writable, thus modifications to
+ * the array are written to the file. If ARRAY_READ_ONLY is specified in the
+ * flags, the file is opened as read-only and its pages are shared with every
+ * other process which maps the file. Modifications to a read-only array are
+ * private to it and are never written to the file. If ARRAY_CREATE is
+ * specified in the flags, the file is created with element_count zeroed
+ * elements if it does not exist yet. If ARRAY_HUGE_PAGES is specified in the
+ * flags, the kernel is advised to back the mapping with huge pages.
+ *
+ * The file stores the raw bytes of the elements, thus it should only be opened
+ * on a machine with the same data representation as the one it was written on.
+ *
+ * @param path          the path of the file to back the array with
+ * @param element_count the number of elements in the array if the file is
+ *                      created; otherwise, the number of elements is read from
+ *                      the file; must not be negative
+ * @param data_size     the size of each element in the array; must be positive
+ *                      and must match the element size which the file was
+ *                      created with
+ * @param flags         a combination of ARRAY_READ_ONLY, ARRAY_CREATE and
+ *                      ARRAY_HUGE_PAGES
+ *
+ * @return the newly-opened array, or NULL if it was not successfully opened
+ *         due to either invalid input arguments, the file not being a valid
+ *         array file, an error opening or mapping the file, or memory
+ *         allocation error
+ */
+array array_open_mapped(const char *const path,
+                        const int element_count,
+                        const size_t data_size,
+                        const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_array *init;
+    if (!path || element_count < 0 || data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_array));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = element_count;
+    init->map_offset = HEADER_SIZE;
+    if (array_open_file(init, path, flags) != 0) {
+        free(init);
+        return NULL;
+    }
+    return init;
+#else
+    (void) path;
+    (void) element_count;
+    (void) data_size;
+    (void) flags;
+    return NULL;
+#endif
+}
+
 /**
  * Gets the size of the array.
  *
@@ -116,6 +381,110 @@ void *array_get_data(array me)
     return me->data;
 }
 
+/**
+ * Sorts the elements of the array in ascending order according to the
+ * comparator. The built-in scalar comparators from compare.h select a radix
+ * sort when they match the element size, and any other comparator is used by
+ * an introsort. The sort is not stable.
+ *
+ * @param me         the array to sort
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ */
+void array_sort(array me,
+                int (*const comparator)(const void *const one,
+                                        const void *const two))
+{
+    containers_sort(me->data, me->item_count, me->bytes_per_item, comparator);
+}
+
+/**
+ * Gets the index of the first element of the array which is not less than the
+ * key, which is the size of the array if there is no such element. The array
+ * must be sorted in ascending order according to the comparator. The search
+ * is branchless, so it does not suffer branch mispredictions.
+ *
+ * @param me         the array to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the first element which is not less than the key
+ */
+int array_lower_bound(array me,
+                      void *const key,
+                      int (*const comparator)(const void *const one,
+                                              const void *const two))
+{
+    return containers_lower_bound(me->data, me->item_count, me->bytes_per_item,
+                                  key, comparator);
+}
+
+/**
+ * Rearranges the elements of the array, which must be sorted in ascending
+ * order, into Eytzinger order. This is the breadth-first order of an implicit
+ * binary search tree, which makes searches of large arrays cache-friendly. The
+ * array is no longer sorted afterwards, and must be searched with
+ * array_eytzinger_lower_bound.
+ *
+ * @param me the array to rearrange
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int array_eytzinger_layout(array me)
+{
+    return containers_eytzinger_layout(me->data, me->item_count,
+                                       me->bytes_per_item);
+}
+
+/**
+ * Gets the index of the smallest element of the array which is not less than
+ * the key, which is the size of the array if there is no such element. The
+ * array must have been rearranged with array_eytzinger_layout. The search
+ * prefetches the elements it visits a few steps ahead, so on arrays far larger
+ * than the cache it is much faster than array_lower_bound.
+ *
+ * @param me         the array to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the smallest element which is not less than the key
+ */
+int array_eytzinger_lower_bound(array me,
+                                void *const key,
+                                int (*const comparator)(const void *const one,
+                                                        const void *const two))
+{
+    return containers_eytzinger_lower_bound(me->data, me->item_count,
+                                            me->bytes_per_item, key,
+                                            comparator);
+}
+
+/**
+ * Writes the elements of a file-backed array to its file, and waits for the
+ * write to complete. For arrays which are not backed by a file, or which were
+ * opened as read-only, this has no effect.
+ *
+ * @param me the array to synchronize
+ *
+ * @return 0    if no error
+ * @return -EIO if the file could not be written
+ */
+int array_sync(array me)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->map_offset && msync((char *) me->data - me->map_offset,
+                                me->mapped_size, MS_SYNC) == -1) {
+        return -EIO;
+    }
+#else
+    (void) me;
+#endif
+    return 0;
+}
+
 /*
  * Determines if the input is illegal.
  */
@@ -183,7 +552,15 @@ int array_get(void *const data, array me, const int index)
  */
 array array_destroy(array me)
 {
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->mapped_size) {
+        munmap((char *) me->data - me->map_offset, me->mapped_size);
+    } else {
+        free(me->data);
+    }
+#else
     free(me->data);
+#endif
     free(me);
     return NULL;
 }
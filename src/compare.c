@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "include/compare.h"
+
+/**
+ * Compares two keys which are ints.
+ *
+ * @param one the first int
+ * @param two the second int
+ *
+ * @return a negative value if the first int is smaller, a positive value if it
+ *         is larger, otherwise 0
+ */
+int containers_compare_int(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are longs.
+ *
+ * @param one the first long
+ * @param two the second long
+ *
+ * @return a negative value if the first long is smaller, a positive value if it
+ *         is larger, otherwise 0
+ */
+int containers_compare_long(const void *const one, const void *const two)
+{
+    const long a = *(const long *) one;
+    const long b = *(const long *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are unsigned ints.
+ *
+ * @param one the first unsigned int
+ * @param two the second unsigned int
+ *
+ * @return a negative value if the first unsigned int is smaller, a positive
+ *         value if it is larger, otherwise 0
+ */
+int containers_compare_uint(const void *const one, const void *const two)
+{
+    const unsigned int a = *(const unsigned int *) one;
+    const unsigned int b = *(const unsigned int *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are unsigned longs.
+ *
+ * @param one the first unsigned long
+ * @param two the second unsigned long
+ *
+ * @return a negative value if the first unsigned long is smaller, a positive
+ *         value if it is larger, otherwise 0
+ */
+int containers_compare_ulong(const void *const one, const void *const two)
+{
+    const unsigned long a = *(const unsigned long *) one;
+    const unsigned long b = *(const unsigned long *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are floats.
+ *
+ * @param one the first float
+ * @param two the second float
+ *
+ * @return a negative value if the first float is smaller, a positive value if
+ *         it is larger, otherwise 0
+ */
+int containers_compare_float(const void *const one, const void *const two)
+{
+    const float a = *(const float *) one;
+    const float b = *(const float *) two;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Compares two keys which are doubles.
+ *
+ * @param one the first double
+ * @param two the second double
+ *
+ * @return a negative value if the first double is smaller, a positive value if
+ *         it is larger, otherwise 0
+ */
+int containers_compare_double(const void *const one, const void *const two)
+{
+    const double a = *(const double *) one;
+    const double b = *(const double *) two;
+    return (a > b) - (a < b);
+}
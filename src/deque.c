@@ -23,6 +23,7 @@
 #include <string.h>
 #include <errno.h>
 #include "include/deque.h"
+#include "include/sort.h"
 
 static const int BLOCK_SIZE = 8;
 static const double RESIZE_RATIO = 1.5;
@@ -165,6 +166,67 @@ void deque_copy_to_array(void *const arr, deque me)
     }
 }
 
+/*
+ * Copies the elements between the blocks of the deque and a contiguous array,
+ * a run of contiguous elements at a time. The elements are copied into the
+ * deque if to_deque is set, and out of it otherwise.
+ */
+static void deque_copy_blocks(deque me, char *arr, const int to_deque)
+{
+    int index = me->start_index + 1;
+    while (index < me->end_index) {
+        const int inner_index = index % BLOCK_SIZE;
+        char *const run = (char *) me->block[index / BLOCK_SIZE].data
+                          + inner_index * me->data_size;
+        int count = BLOCK_SIZE - inner_index;
+        if (count > me->end_index - index) {
+            count = me->end_index - index;
+        }
+        if (to_deque) {
+            memcpy(run, arr, count * me->data_size);
+        } else {
+            memcpy(arr, run, count * me->data_size);
+        }
+        arr += count * me->data_size;
+        index += count;
+    }
+}
+
+/**
+ * Sorts the elements of the deque in ascending order according to the
+ * comparator. Since the elements are stored in blocks, they are copied into a
+ * contiguous array, sorted there, and copied back. The built-in scalar
+ * comparators from compare.h select a radix sort when they match the element
+ * size, and any other comparator is used by an introsort. The sort is not
+ * stable.
+ *
+ * @param me         the deque to sort
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int deque_sort(deque me,
+               int (*const comparator)(const void *const one,
+                                       const void *const two))
+{
+    const int size = deque_size(me);
+    char *temp;
+    if (size < 2) {
+        return 0;
+    }
+    temp = malloc(size * me->data_size);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    deque_copy_blocks(me, temp, 0);
+    containers_sort(temp, size, me->data_size, comparator);
+    deque_copy_blocks(me, temp, 1);
+    free(temp);
+    return 0;
+}
+
 /**
  * Adds an element to the front of the deque. The pointer to the data being
  * passed in should point to the data type which this deque holds. For example,
@@ -460,6 +522,66 @@ int deque_get_at(void *const data, deque me, int index)
     return 0;
 }
 
+/**
+ * Gets a reference to the element of the deque at the specified index. Since
+ * the elements are stored in blocks which are never moved, the reference
+ * remains valid when elements are added to either end of the deque. It is
+ * invalidated when its element is removed, or when the deque is trimmed,
+ * cleared, or destroyed. The element may be modified through the reference.
+ *
+ * @param me    the deque to get the reference from
+ * @param index the index of the element
+ *
+ * @return the reference to the element, or NULL if the index is out of bounds
+ */
+void *deque_get_ref_at(deque me, int index)
+{
+    if (index < 0 || index >= deque_size(me)) {
+        return NULL;
+    }
+    index += me->start_index + 1;
+    return (char *) me->block[index / BLOCK_SIZE].data
+           + (index % BLOCK_SIZE) * me->data_size;
+}
+
+/**
+ * Calls the callback on each run of contiguous elements of the deque, from the
+ * front to the back. Each call receives a pointer to the first element of the
+ * run, the amount of elements in the run, and the context. Thus, the elements
+ * can be processed in place, a block at a time. The elements may be modified,
+ * but elements must not be added to or removed from the deque by the callback.
+ * If the callback returns a non-zero value, the iteration stops.
+ *
+ * @param me       the deque to iterate over
+ * @param callback the function to call on each run of elements
+ * @param context  the context to pass to the callback
+ *
+ * @return 0 if every run was visited, otherwise the non-zero value which the
+ *         callback returned
+ */
+int deque_for_each_block(deque me,
+                         int (*const callback)(void *data, int count,
+                                               void *context),
+                         void *const context)
+{
+    int index = me->start_index + 1;
+    while (index < me->end_index) {
+        const int inner_index = index % BLOCK_SIZE;
+        int count = BLOCK_SIZE - inner_index;
+        int rc;
+        if (count > me->end_index - index) {
+            count = me->end_index - index;
+        }
+        rc = callback((char *) me->block[index / BLOCK_SIZE].data
+                      + inner_index * me->data_size, count, context);
+        if (rc != 0) {
+            return rc;
+        }
+        index += count;
+    }
+    return 0;
+}
+
 /**
  * Gets the last value of the deque. The pointer to the data being obtained
  * should point to the data type which this deque holds. For example, if this
@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "include/flat_map.h"
+#include "include/vector.h"
+#include "include/sort.h"
+#include "include/search.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+struct internal_flat_map {
+    size_t key_size;
+    size_t value_size;
+    int (*comparator)(const void *const one, const void *const two);
+    vector keys;
+    vector values;
+};
+
+/**
+ * Initializes a flat map, which keeps its keys sorted in a vector, and their
+ * values in a separate vector in the same order.
+ *
+ * @param key_size   the size of each key in the flat map; must be positive
+ * @param value_size the size of each value in the flat map; must be positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized flat map, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+flat_map flat_map_init(const size_t key_size,
+                       const size_t value_size,
+                       int (*const comparator)(const void *const,
+                                               const void *const))
+{
+    struct internal_flat_map *init;
+    if (key_size == 0 || value_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_flat_map));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->value_size = value_size;
+    init->comparator = comparator;
+    init->keys = vector_init(key_size);
+    if (!init->keys) {
+        free(init);
+        return NULL;
+    }
+    init->values = vector_init(value_size);
+    if (!init->values) {
+        vector_destroy(init->keys);
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Gets the size of the flat map.
+ *
+ * @param me the flat map to check
+ *
+ * @return the size of the flat map
+ */
+int flat_map_size(flat_map me)
+{
+    return vector_size(me->keys);
+}
+
+/**
+ * Determines whether or not the flat map is empty.
+ *
+ * @param me the flat map to check
+ *
+ * @return 1 if the flat map is empty, otherwise 0
+ */
+int flat_map_is_empty(flat_map me)
+{
+    return flat_map_size(me) == 0;
+}
+
+/**
+ * Reserves space for the specified amount of key-value pairs. If more space
+ * than specified is already reserved, then the previous space will be kept.
+ *
+ * @param me   the flat map to reserve space for
+ * @param size the amount of key-value pairs to reserve space for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_map_reserve(flat_map me, const int size)
+{
+    const int rc = vector_reserve(me->keys, size);
+    if (rc != 0) {
+        return rc;
+    }
+    return vector_reserve(me->values, size);
+}
+
+/**
+ * Gets the storage of the keys of the flat map, which are held contiguously in
+ * sorted order. This pointer is not a copy, and is invalidated by operations
+ * which add or remove keys. The keys must not be modified in a way which
+ * changes their order. The flat map owns this memory, thus it should not be
+ * freed.
+ *
+ * @param me the flat map to get the keys of
+ *
+ * @return the storage of the keys
+ */
+void *flat_map_get_keys(flat_map me)
+{
+    return vector_get_data(me->keys);
+}
+
+/**
+ * Gets the storage of the values of the flat map, which are held contiguously
+ * in the same order as their keys. This pointer is not a copy, and is
+ * invalidated by operations which add or remove keys. The flat map owns this
+ * memory, thus it should not be freed.
+ *
+ * @param me the flat map to get the values of
+ *
+ * @return the storage of the values
+ */
+void *flat_map_get_values(flat_map me)
+{
+    return vector_get_data(me->values);
+}
+
+/*
+ * Compares two keys.
+ */
+static int flat_map_compare(flat_map me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/*
+ * Gets the index of the first key which is not less than the specified key,
+ * with the branchless binary search of containers_lower_bound.
+ */
+static int flat_map_search(flat_map me, const void *const key)
+{
+    return containers_lower_bound(vector_get_data(me->keys),
+                                  vector_size(me->keys), me->key_size,
+                                  (void *) key, me->comparator);
+}
+
+/*
+ * Determines whether the key at the index is equal to the specified key.
+ */
+static int flat_map_is_at(flat_map me, const int index, const void *const key)
+{
+    const char *const data = vector_get_data(me->keys);
+    return index < vector_size(me->keys)
+           && flat_map_compare(me, data + index * me->key_size, key) == 0;
+}
+
+/**
+ * Adds a key-value pair to the flat map. If the flat map already contains the
+ * key, the value is updated to the new value. The pairs after it are moved to
+ * make room for it, so adding a new key takes linear time. To add many pairs,
+ * flat_map_put_all is faster. The pointers to the key and value being passed
+ * in should point to the key and value type which this flat map holds. Since
+ * the key and value are being copied, the pointers only have to be valid when
+ * this function is called.
+ *
+ * @param me    the flat map to add to
+ * @param key   the key to add
+ * @param value the value that the key maps to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_map_put(flat_map me, void *const key, void *const value)
+{
+    const int index = flat_map_search(me, key);
+    int rc;
+    if (flat_map_is_at(me, index, key)) {
+        return vector_set_at(me->values, index, value);
+    }
+    rc = vector_add_at(me->keys, index, key);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = vector_add_at(me->values, index, value);
+    if (rc != 0) {
+        vector_remove_at(me->keys, index);
+    }
+    return rc;
+}
+
+/**
+ * Adds many key-value pairs to the flat map at once. The pairs are copied and
+ * sorted with one sort, and are then merged with the pairs of the flat map from
+ * the back, so that each pair of the flat map is moved at most once. Thus, this
+ * takes O(n + k log k) time for k pairs, rather than the O(n k) time of adding
+ * them one at a time. If the flat map already contains a key, its value is
+ * updated to the new value. If a key is repeated in the pairs being added, it
+ * is only added once, with one of its values.
+ *
+ * @param me     the flat map to add to
+ * @param keys   the keys to add
+ * @param values the values that the keys map to, in the same order
+ * @param count  the amount of key-value pairs to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_map_put_all(flat_map me,
+                     void *const keys,
+                     void *const values,
+                     const int count)
+{
+    const size_t key_size = me->key_size;
+    const size_t value_size = me->value_size;
+    const size_t pair_size = key_size + value_size;
+    const int size = vector_size(me->keys);
+    char *key_data = vector_get_data(me->keys);
+    char *value_data = vector_get_data(me->values);
+    char *batch;
+    int unique = 0;
+    int index = 0;
+    int out;
+    int rc;
+    int i;
+    if (count < 0) {
+        return -EINVAL;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    batch = malloc(count * pair_size);
+    if (!batch) {
+        return -ENOMEM;
+    }
+    for (i = 0; i < count; i++) {
+        memcpy(batch + i * pair_size, (char *) keys + i * key_size, key_size);
+        memcpy(batch + i * pair_size + key_size,
+               (char *) values + i * value_size, value_size);
+    }
+    /*
+     * The pairs are larger than the keys, so the comparator only sees keys. The
+     * containers_compare_key marker compares all the bytes of each pair, which
+     * orders the pairs by their keys since the keys come first, and only orders
+     * repeated keys by their values.
+     */
+    containers_sort(batch, count, pair_size, me->comparator);
+    for (i = 0; i < count; i++) {
+        const char *const pair = batch + i * pair_size;
+        if (i > 0 && flat_map_compare(me, pair - pair_size, pair) == 0) {
+            continue;
+        }
+        while (index < size
+               && flat_map_compare(me, key_data + index * key_size, pair) < 0) {
+            index++;
+        }
+        if (flat_map_is_at(me, index, pair)) {
+            memcpy(value_data + index * value_size, pair + key_size,
+                   value_size);
+            continue;
+        }
+        if (unique != i) {
+            memcpy(batch + unique * pair_size, pair, pair_size);
+        }
+        unique++;
+    }
+    rc = flat_map_reserve(me, size + unique);
+    if (rc != 0) {
+        free(batch);
+        return rc;
+    }
+    for (i = 0; i < unique; i++) {
+        const char *const pair = batch + i * pair_size;
+        vector_add_last(me->keys, (void *) pair);
+        vector_add_last(me->values, (void *) (pair + key_size));
+    }
+    key_data = vector_get_data(me->keys);
+    value_data = vector_get_data(me->values);
+    index = size - 1;
+    out = size + unique - 1;
+    for (i = unique - 1; i >= 0; out--) {
+        const char *const pair = batch + i * pair_size;
+        if (index >= 0
+            && flat_map_compare(me, key_data + index * key_size, pair) > 0) {
+            memcpy(key_data + out * key_size, key_data + index * key_size,
+                   key_size);
+            memcpy(value_data + out * value_size,
+                   value_data + index * value_size, value_size);
+            index--;
+        } else {
+            memcpy(key_data + out * key_size, pair, key_size);
+            memcpy(value_data + out * value_size, pair + key_size, value_size);
+            i--;
+        }
+    }
+    free(batch);
+    return 0;
+}
+
+/**
+ * Replaces the key-value pairs of the flat map with the specified pairs, which
+ * are sorted with one sort. If an error occurs, the flat map is left empty.
+ *
+ * @param me     the flat map to replace the key-value pairs of
+ * @param keys   the keys to hold
+ * @param values the values that the keys map to, in the same order
+ * @param count  the amount of key-value pairs
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_map_assign(flat_map me,
+                    void *const keys,
+                    void *const values,
+                    const int count)
+{
+    if (count < 0) {
+        return -EINVAL;
+    }
+    /* The pairs are removed even if the storage could not be shrunk. */
+    vector_clear(me->keys);
+    vector_clear(me->values);
+    return flat_map_put_all(me, keys, values, count);
+}
+
+/**
+ * Gets the value associated with a key in the flat map. This takes logarithmic
+ * time. The pointer to the key being passed in and the value being obtained
+ * should point to the key and value type which this flat map holds.
+ *
+ * @param value the value to copy to
+ * @param me    the flat map to get from
+ * @param key   the key to search for
+ *
+ * @return 1 if the flat map contained the key, otherwise 0
+ */
+int flat_map_get(void *const value, flat_map me, void *const key)
+{
+    const int index = flat_map_search(me, key);
+    if (!flat_map_is_at(me, index, key)) {
+        return 0;
+    }
+    vector_get_at(value, me->values, index);
+    return 1;
+}
+
+/**
+ * Determines if the flat map contains the specified key. This takes
+ * logarithmic time. The pointer to the key being passed in should point to the
+ * key type which this flat map holds.
+ *
+ * @param me  the flat map to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the flat map contained the key, otherwise 0
+ */
+int flat_map_contains(flat_map me, void *const key)
+{
+    return flat_map_is_at(me, flat_map_search(me, key), key);
+}
+
+/**
+ * Gets the index of the first key in the flat map which is not less than the
+ * specified key, which is the size of the flat map if there is no such key.
+ * This takes logarithmic time.
+ *
+ * @param me  the flat map to search
+ * @param key the key to search for
+ *
+ * @return the index of the first key which is not less than the key
+ */
+int flat_map_lower_bound(flat_map me, void *const key)
+{
+    return flat_map_search(me, key);
+}
+
+/**
+ * Copies the key-value pair at the specified index in sorted order. Either the
+ * key or the value may be NULL if it is not needed.
+ *
+ * @param key   the key to copy to
+ * @param value the value to copy to
+ * @param me    the flat map to get the key-value pair from
+ * @param index the index of the key-value pair
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int flat_map_get_at(void *const key,
+                    void *const value,
+                    flat_map me,
+                    const int index)
+{
+    if (index < 0 || index >= vector_size(me->keys)) {
+        return -EINVAL;
+    }
+    if (key) {
+        vector_get_at(key, me->keys, index);
+    }
+    if (value) {
+        vector_get_at(value, me->values, index);
+    }
+    return 0;
+}
+
+/**
+ * Removes the key-value pair from the flat map if it contains it. The pairs
+ * after it are moved to close the gap, so this takes linear time.
+ *
+ * @param me  the flat map to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the flat map contained the key, otherwise 0
+ */
+int flat_map_remove(flat_map me, void *const key)
+{
+    const int index = flat_map_search(me, key);
+    if (!flat_map_is_at(me, index, key)) {
+        return 0;
+    }
+    vector_remove_at(me->keys, index);
+    vector_remove_at(me->values, index);
+    return 1;
+}
+
+/**
+ * Clears the key-value pairs from the flat map.
+ *
+ * @param me the flat map to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_map_clear(flat_map me)
+{
+    const int rc = vector_clear(me->keys);
+    const int value_rc = vector_clear(me->values);
+    return rc != 0 ? rc : value_rc;
+}
+
+/**
+ * Frees the flat map memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the flat map to free from memory
+ *
+ * @return NULL
+ */
+flat_map flat_map_destroy(flat_map me)
+{
+    vector_destroy(me->keys);
+    vector_destroy(me->values);
+    free(me);
+    return NULL;
+}
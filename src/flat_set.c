@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "include/flat_set.h"
+#include "include/vector.h"
+#include "include/sort.h"
+#include "include/search.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+struct internal_flat_set {
+    size_t key_size;
+    int (*comparator)(const void *const one, const void *const two);
+    vector keys;
+};
+
+/**
+ * Initializes a flat set, which keeps its keys sorted in a vector.
+ *
+ * @param key_size   the size of each key in the flat set; must be positive
+ * @param comparator the comparator function used for key ordering; must not be
+ *                   NULL; may be one of the built-in comparators from compare.h
+ *
+ * @return the newly-initialized flat set, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+flat_set flat_set_init(const size_t key_size,
+                       int (*const comparator)(const void *const,
+                                               const void *const))
+{
+    struct internal_flat_set *init;
+    if (key_size == 0 || !comparator) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_flat_set));
+    if (!init) {
+        return NULL;
+    }
+    init->key_size = key_size;
+    init->comparator = comparator;
+    init->keys = vector_init(key_size);
+    if (!init->keys) {
+        free(init);
+        return NULL;
+    }
+    return init;
+}
+
+/**
+ * Gets the size of the flat set.
+ *
+ * @param me the flat set to check
+ *
+ * @return the size of the flat set
+ */
+int flat_set_size(flat_set me)
+{
+    return vector_size(me->keys);
+}
+
+/**
+ * Determines whether or not the flat set is empty.
+ *
+ * @param me the flat set to check
+ *
+ * @return 1 if the flat set is empty, otherwise 0
+ */
+int flat_set_is_empty(flat_set me)
+{
+    return flat_set_size(me) == 0;
+}
+
+/**
+ * Reserves space for the specified amount of keys. If more space than
+ * specified is already reserved, then the previous space will be kept.
+ *
+ * @param me   the flat set to reserve space for
+ * @param size the amount of keys to reserve space for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_set_reserve(flat_set me, const int size)
+{
+    return vector_reserve(me->keys, size);
+}
+
+/**
+ * Gets the storage of the flat set, which holds the keys contiguously in
+ * sorted order. This pointer is not a copy, and is invalidated by operations
+ * which add or remove keys. The keys must not be modified in a way which
+ * changes their order. The flat set owns this memory, thus it should not be
+ * freed.
+ *
+ * @param me the flat set to get the storage of
+ *
+ * @return the storage of the flat set
+ */
+void *flat_set_get_data(flat_set me)
+{
+    return vector_get_data(me->keys);
+}
+
+/*
+ * Compares two keys.
+ */
+static int flat_set_compare(flat_set me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
+/*
+ * Gets the index of the first key which is not less than the specified key,
+ * with the branchless binary search of containers_lower_bound.
+ */
+static int flat_set_search(flat_set me, const void *const key)
+{
+    return containers_lower_bound(vector_get_data(me->keys),
+                                  vector_size(me->keys), me->key_size,
+                                  (void *) key, me->comparator);
+}
+
+/*
+ * Determines whether the key at the index is equal to the specified key.
+ */
+static int flat_set_is_at(flat_set me, const int index, const void *const key)
+{
+    const char *const data = vector_get_data(me->keys);
+    return index < vector_size(me->keys)
+           && flat_set_compare(me, data + index * me->key_size, key) == 0;
+}
+
+/**
+ * Adds a key to the flat set if the flat set does not already contain it. The
+ * keys after it are moved to make room for it, so this takes linear time. To
+ * add many keys, flat_set_put_all is faster. The pointer to the key being
+ * passed in should point to the key type which this flat set holds. Since the
+ * key is being copied, the pointer only has to be valid when this function is
+ * called.
+ *
+ * @param me  the flat set to add to
+ * @param key the key to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_set_put(flat_set me, void *const key)
+{
+    const int index = flat_set_search(me, key);
+    if (flat_set_is_at(me, index, key)) {
+        return 0;
+    }
+    return vector_add_at(me->keys, index, key);
+}
+
+/**
+ * Adds many keys to the flat set at once. The keys are copied and sorted with
+ * one sort, and are then merged with the keys of the flat set from the back,
+ * so that each key of the flat set is moved at most once. Thus, this takes
+ * O(n + k log k) time for k keys, rather than the O(n k) time of adding them
+ * one at a time. Keys which the flat set already contains, and repeated keys,
+ * are only added once.
+ *
+ * @param me    the flat set to add to
+ * @param keys  the keys to add
+ * @param count the amount of keys to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_set_put_all(flat_set me, void *const keys, const int count)
+{
+    const size_t key_size = me->key_size;
+    const int size = vector_size(me->keys);
+    char *data = vector_get_data(me->keys);
+    char *batch;
+    int unique = 0;
+    int index = 0;
+    int out;
+    int rc;
+    int i;
+    if (count < 0) {
+        return -EINVAL;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    batch = malloc(count * key_size);
+    if (!batch) {
+        return -ENOMEM;
+    }
+    memcpy(batch, keys, count * key_size);
+    containers_sort(batch, count, key_size, me->comparator);
+    for (i = 0; i < count; i++) {
+        const char *const key = batch + i * key_size;
+        if (i > 0 && flat_set_compare(me, key - key_size, key) == 0) {
+            continue;
+        }
+        while (index < size
+               && flat_set_compare(me, data + index * key_size, key) < 0) {
+            index++;
+        }
+        if (flat_set_is_at(me, index, key)) {
+            continue;
+        }
+        if (unique != i) {
+            memcpy(batch + unique * key_size, key, key_size);
+        }
+        unique++;
+    }
+    rc = vector_reserve(me->keys, size + unique);
+    if (rc != 0) {
+        free(batch);
+        return rc;
+    }
+    for (i = 0; i < unique; i++) {
+        vector_add_last(me->keys, batch + i * key_size);
+    }
+    data = vector_get_data(me->keys);
+    index = size - 1;
+    out = size + unique - 1;
+    for (i = unique - 1; i >= 0; out--) {
+        const char *const key = batch + i * key_size;
+        if (index >= 0
+            && flat_set_compare(me, data + index * key_size, key) > 0) {
+            memcpy(data + out * key_size, data + index * key_size,
+                   key_size);
+            index--;
+        } else {
+            memcpy(data + out * key_size, key, key_size);
+            i--;
+        }
+    }
+    free(batch);
+    return 0;
+}
+
+/**
+ * Replaces the keys of the flat set with the specified keys, which are sorted
+ * with one sort. If an error occurs, the flat set is left empty.
+ *
+ * @param me    the flat set to replace the keys of
+ * @param keys  the keys to hold
+ * @param count the amount of keys
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int flat_set_assign(flat_set me, void *const keys, const int count)
+{
+    if (count < 0) {
+        return -EINVAL;
+    }
+    /* The keys are removed even if the storage could not be shrunk. */
+    vector_clear(me->keys);
+    return flat_set_put_all(me, keys, count);
+}
+
+/**
+ * Determines if the flat set contains the specified key. This takes
+ * logarithmic time. The pointer to the key being passed in should point to the
+ * key type which this flat set holds.
+ *
+ * @param me  the flat set to check for the key
+ * @param key the key to check
+ *
+ * @return 1 if the flat set contained the key, otherwise 0
+ */
+int flat_set_contains(flat_set me, void *const key)
+{
+    return flat_set_is_at(me, flat_set_search(me, key), key);
+}
+
+/**
+ * Gets the index of the first key in the flat set which is not less than the
+ * specified key, which is the size of the flat set if there is no such key.
+ * This takes logarithmic time.
+ *
+ * @param me  the flat set to search
+ * @param key the key to search for
+ *
+ * @return the index of the first key which is not less than the key
+ */
+int flat_set_lower_bound(flat_set me, void *const key)
+{
+    return flat_set_search(me, key);
+}
+
+/**
+ * Copies the key at the specified index in sorted order.
+ *
+ * @param key   the key to copy to
+ * @param me    the flat set to get the key from
+ * @param index the index of the key
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int flat_set_get_at(void *const key, flat_set me, const int index)
+{
+    return vector_get_at(key, me->keys, index);
+}
+
+/**
+ * Removes the key from the flat set if it contains it. The keys after it are
+ * moved to close the gap, so this takes linear time.
+ *
+ * @param me  the flat set to remove a key from
+ * @param key the key to remove
+ *
+ * @return 1 if the flat set contained the key, otherwise 0
+ */
+int flat_set_remove(flat_set me, void *const key)
+{
+    const int index = flat_set_search(me, key);
+    if (!flat_set_is_at(me, index, key)) {
+        return 0;
+    }
+    vector_remove_at(me->keys, index);
+    return 1;
+}
+
+/**
+ * Clears the keys from the flat set.
+ *
+ * @param me the flat set to clear
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int flat_set_clear(flat_set me)
+{
+    return vector_clear(me->keys);
+}
+
+/**
+ * Frees the flat set memory. Performing further operations after calling this
+ * function results in undefined behavior.
+ *
+ * @param me the flat set to free from memory
+ *
+ * @return NULL
+ */
+flat_set flat_set_destroy(flat_set me)
+{
+    vector_destroy(me->keys);
+    free(me);
+    return NULL;
+}
@@ -29,6 +29,8 @@ struct internal_forward_list {
     int item_count;
     struct node *head;
     struct node *tail;
+    int cache_index;
+    struct node *cache;
 };
 
 struct node {
@@ -59,6 +61,8 @@ forward_list forward_list_init(const size_t data_size)
     init->item_count = 0;
     init->head = NULL;
     init->tail = NULL;
+    init->cache_index = 0;
+    init->cache = NULL;
     return init;
 }
 
@@ -109,24 +113,103 @@ void forward_list_copy_to_array(void *const arr, forward_list me)
 }
 
 /*
- * Gets the node at the specified index.
+ * Gets the node at the specified index. The walk starts from the most recently
+ * accessed node if it is not past the index, so that accessing increasing
+ * indices one after another takes constant time.
  */
 static struct node *forward_list_get_node_at(forward_list me, const int index)
 {
     struct node *traverse = me->head;
-    int i;
-    if (me->tail && index == me->item_count - 1) {
+    int position = 0;
+    if (index == me->item_count - 1) {
         return me->tail;
     }
-    for (i = 0; i < index; i++) {
-        traverse = traverse->next;
+    if (me->cache && me->cache_index <= index) {
+        traverse = me->cache;
+        position = me->cache_index;
     }
-    if (!traverse->next) {
-        me->tail = traverse;
+    while (position < index) {
+        traverse = traverse->next;
+        position++;
     }
+    me->cache = traverse;
+    me->cache_index = index;
     return traverse;
 }
 
+/*
+ * Creates a node which holds a copy of the data.
+ */
+static struct node *forward_list_create_node(forward_list me,
+                                             const void *const data)
+{
+    struct node *const add = malloc(sizeof(struct node));
+    if (!add) {
+        return NULL;
+    }
+    add->data = malloc(me->bytes_per_item);
+    if (!add->data) {
+        free(add);
+        return NULL;
+    }
+    memcpy(add->data, data, me->bytes_per_item);
+    return add;
+}
+
+/*
+ * Links the node in after the specified node, or at the start if there is
+ * none, where the index is the index which the node ends up at.
+ */
+static void forward_list_link(forward_list me,
+                              struct node *const add,
+                              struct node *const prev,
+                              const int index)
+{
+    if (prev) {
+        add->next = prev->next;
+        prev->next = add;
+    } else {
+        add->next = me->head;
+        me->head = add;
+    }
+    if (!add->next) {
+        me->tail = add;
+    }
+    if (me->cache && index <= me->cache_index) {
+        me->cache_index++;
+    }
+    me->item_count++;
+}
+
+/*
+ * Unlinks and frees the node after the specified node, or the first node if
+ * there is none, where the index is the index of the node being removed. If it
+ * is the most recently accessed node, its predecessor takes its place.
+ */
+static void forward_list_unlink(forward_list me,
+                                struct node *const prev,
+                                const int index)
+{
+    struct node *const item = prev ? prev->next : me->head;
+    if (prev) {
+        prev->next = item->next;
+    } else {
+        me->head = item->next;
+    }
+    if (me->tail == item) {
+        me->tail = prev;
+    }
+    if (me->cache == item) {
+        me->cache = prev;
+        me->cache_index--;
+    } else if (me->cache && index < me->cache_index) {
+        me->cache_index--;
+    }
+    free(item->data);
+    free(item);
+    me->item_count--;
+}
+
 /**
  * Adds data at the first index in the singly-linked list. The pointer to the
  * data being passed in should point to the data type which this singly-linked
@@ -166,28 +249,16 @@ int forward_list_add_at(forward_list me, const int index, void *const data)
     if (index < 0 || index > me->item_count) {
         return -EINVAL;
     }
-    add = malloc(sizeof(struct node));
+    add = forward_list_create_node(me, data);
     if (!add) {
         return -ENOMEM;
     }
-    add->data = malloc(me->bytes_per_item);
-    if (!add->data) {
-        free(add);
-        return -ENOMEM;
-    }
-    memcpy(add->data, data, me->bytes_per_item);
     if (index == 0) {
-        add->next = me->head;
-        me->head = add;
+        forward_list_link(me, add, NULL, index);
     } else {
-        struct node *const traverse = forward_list_get_node_at(me, index - 1);
-        add->next = traverse->next;
-        traverse->next = add;
-        if (!add->next) {
-            me->tail = add;
-        }
+        forward_list_link(me, add, forward_list_get_node_at(me, index - 1),
+                          index);
     }
-    me->item_count++;
     return 0;
 }
 
@@ -245,21 +316,11 @@ int forward_list_remove_at(forward_list me, const int index)
         return -EINVAL;
     }
     if (index == 0) {
-        struct node *const temp = me->head;
-        me->head = temp->next;
-        free(temp->data);
-        free(temp);
+        forward_list_unlink(me, NULL, index);
     } else {
-        struct node *const traverse = forward_list_get_node_at(me, index - 1);
-        struct node *const backup = traverse->next;
-        traverse->next = traverse->next->next;
-        if (!traverse->next) {
-            me->tail = NULL;
-        }
-        free(backup->data);
-        free(backup);
+        forward_list_unlink(me, forward_list_get_node_at(me, index - 1),
+                            index);
     }
-    me->item_count--;
     return 0;
 }
 
@@ -401,6 +462,190 @@ int forward_list_get_last(void *const data, forward_list me)
     return forward_list_get_at(data, me, me->item_count - 1);
 }
 
+/**
+ * Moves the cursor to the first element of the singly-linked list. The cursor
+ * is owned by the caller, and remains valid until the singly-linked list is
+ * modified other than through the cursor.
+ *
+ * @param me     the singly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if the singly-linked
+ *         list is empty
+ */
+int forward_list_cursor_first(forward_list me,
+                              struct forward_list_cursor *const cursor)
+{
+    cursor->internal_prev = NULL;
+    cursor->internal_node = me->head;
+    cursor->internal_index = 0;
+    return me->head != NULL;
+}
+
+/**
+ * Moves the cursor to the next element of the singly-linked list.
+ *
+ * @param me     the singly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if it moved past the
+ *         last element
+ */
+int forward_list_cursor_next(forward_list me,
+                             struct forward_list_cursor *const cursor)
+{
+    struct node *const item = cursor->internal_node;
+    (void) me;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_prev = item;
+    cursor->internal_node = item->next;
+    cursor->internal_index++;
+    return item->next != NULL;
+}
+
+/**
+ * Gets the index of the element at the cursor.
+ *
+ * @param cursor the cursor to check
+ *
+ * @return the index of the element, or -1 if the cursor is not at an element
+ */
+int forward_list_cursor_index(const struct forward_list_cursor *const cursor)
+{
+    if (!cursor->internal_node) {
+        return -1;
+    }
+    return cursor->internal_index;
+}
+
+/**
+ * Copies the element at the cursor to data. The pointer to the data being
+ * obtained should point to the data type which this singly-linked list holds.
+ *
+ * @param data   the data to get
+ * @param me     the singly-linked list to get data from
+ * @param cursor the cursor to get at
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_get(void *const data,
+                            forward_list me,
+                            const struct forward_list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(data, item->data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the element at the cursor. The pointer to the data being passed in
+ * should point to the data type which this singly-linked list holds.
+ *
+ * @param me     the singly-linked list to set data for
+ * @param cursor the cursor to set at
+ * @param data   the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_set(forward_list me,
+                            const struct forward_list_cursor *const cursor,
+                            void *const data)
+{
+    struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(item->data, data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Adds data before the element at the cursor in constant time. The cursor
+ * stays at the same element.
+ *
+ * @param me     the singly-linked list to add data to
+ * @param cursor the cursor to add before
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_add_before(forward_list me,
+                                   struct forward_list_cursor *const cursor,
+                                   void *const data)
+{
+    struct node *add;
+    if (!cursor->internal_node) {
+        return -EINVAL;
+    }
+    add = forward_list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    forward_list_link(me, add, cursor->internal_prev, cursor->internal_index);
+    cursor->internal_prev = add;
+    cursor->internal_index++;
+    return 0;
+}
+
+/**
+ * Adds data after the element at the cursor in constant time. The cursor stays
+ * at the same element.
+ *
+ * @param me     the singly-linked list to add data to
+ * @param cursor the cursor to add after
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int forward_list_cursor_add_after(forward_list me,
+                                  struct forward_list_cursor *const cursor,
+                                  void *const data)
+{
+    struct node *add;
+    if (!cursor->internal_node) {
+        return -EINVAL;
+    }
+    add = forward_list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    forward_list_link(me, add, cursor->internal_node,
+                      cursor->internal_index + 1);
+    return 0;
+}
+
+/**
+ * Removes the element at the cursor in constant time, and moves the cursor to
+ * the next element.
+ *
+ * @param me     the singly-linked list to remove data from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at an element after the removal, otherwise 0
+ */
+int forward_list_cursor_remove(forward_list me,
+                               struct forward_list_cursor *const cursor)
+{
+    struct node *const prev = cursor->internal_prev;
+    if (!cursor->internal_node) {
+        return 0;
+    }
+    forward_list_unlink(me, prev, cursor->internal_index);
+    cursor->internal_node = prev ? prev->next : me->head;
+    return cursor->internal_node != NULL;
+}
+
 /**
  * Clears all elements from the singly-linked list.
  *
@@ -416,7 +661,9 @@ void forward_list_clear(forward_list me)
         free(temp);
     }
     me->head = NULL;
+    me->tail = NULL;
     me->item_count = 0;
+    me->cache = NULL;
 }
 
 /**
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include "include/hash.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#define CONTAINERS_HAS_THREADS
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const unsigned long HASH_SEED = 0x9e3779b9UL;
+
+#if ULONG_MAX > 0xffffffffUL
+static const unsigned long HASH_SECRET_ONE = 0xa0761d6478bd642fUL;
+static const unsigned long HASH_SECRET_TWO = 0xe7037ed1a0b428dbUL;
+#else
+static const unsigned long HASH_SECRET_ONE = 0x53c5ca59UL;
+static const unsigned long HASH_SECRET_TWO = 0x74743c1bUL;
+#endif
+
+#if defined(__SIZEOF_INT128__) && ULONG_MAX > 0xffffffffUL
+#define CONTAINERS_HAS_WIDE_MULTIPLY
+__extension__ typedef unsigned __int128 hash_wide;
+#endif
+
+/*
+ * The state from which the seeds of the unordered containers are generated.
+ * The random bytes are read once, and the counter makes each seed distinct.
+ */
+static unsigned long hash_entropy = 0;
+static int hash_has_entropy = 0;
+static unsigned long hash_counter = 0;
+#ifdef CONTAINERS_HAS_THREADS
+static pthread_mutex_t hash_seed_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*
+ * Mixes all the bits of the value so that each bit of the input affects each
+ * bit of the output. The constants are those of splitmix64 when unsigned long
+ * is 64 bits, and those of the lowbias32 integer hash otherwise.
+ */
+static unsigned long hash_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Computes the full double-width product of two words, and stores its low and
+ * high halves. Without a double-width type, the product is assembled from the
+ * products of the half-words.
+ */
+static void hash_multiply(unsigned long *const low,
+                          unsigned long *const high,
+                          const unsigned long one,
+                          const unsigned long two)
+{
+#ifdef CONTAINERS_HAS_WIDE_MULTIPLY
+    const hash_wide product = (hash_wide) one * two;
+    *low = (unsigned long) product;
+    *high = (unsigned long) (product >> 64);
+#else
+    const int half_bits = (int) sizeof(unsigned long) * CHAR_BIT / 2;
+    const unsigned long mask = ULONG_MAX >> half_bits;
+    const unsigned long low_low = (one & mask) * (two & mask);
+    const unsigned long low_high = (one & mask) * (two >> half_bits);
+    const unsigned long high_low = (one >> half_bits) * (two & mask);
+    const unsigned long high_high = (one >> half_bits) * (two >> half_bits);
+    const unsigned long middle =
+            (low_low >> half_bits) + (low_high & mask) + (high_low & mask);
+    *low = (low_low & mask) | (middle << half_bits);
+    *high = high_high + (low_high >> half_bits) + (high_low >> half_bits)
+            + (middle >> half_bits);
+#endif
+}
+
+/*
+ * Multiplies two words and folds the halves of the product together, so that
+ * each bit of the result depends on every bit of both words.
+ */
+static unsigned long hash_fold(const unsigned long one, const unsigned long two)
+{
+    unsigned long low;
+    unsigned long high;
+    hash_multiply(&low, &high, one, two);
+    return low ^ high;
+}
+
+/**
+ * Hashes an arbitrary sequence of bytes with a seed. This is a multiply-fold
+ * hash in the style of wyhash: two words are consumed at a time, each keyed
+ * with the state, and folded into the state with one full-width multiply. The
+ * seed is mixed into the state before the first word, so the keys which
+ * collide under one seed do not collide under another. Thus, containers which
+ * pick a secret seed are not open to keys chosen to collide.
+ *
+ * @param data the bytes to hash
+ * @param size the amount of bytes to hash
+ * @param seed the seed which selects the hash function
+ *
+ * @return the hash of the bytes
+ */
+unsigned long containers_hash_bytes_seeded(const void *const data,
+                                           const size_t size,
+                                           unsigned long seed)
+{
+    const size_t word = sizeof(unsigned long);
+    const unsigned char *const bytes = data;
+    unsigned long one = 0;
+    unsigned long two = 0;
+    size_t remaining = size;
+    size_t i = 0;
+    seed ^= hash_fold(seed ^ HASH_SECRET_ONE, HASH_SECRET_TWO);
+    while (remaining > 2 * word) {
+        memcpy(&one, bytes + i, word);
+        memcpy(&two, bytes + i + word, word);
+        seed = hash_fold(one ^ HASH_SECRET_TWO, two ^ seed);
+        i += 2 * word;
+        remaining -= 2 * word;
+    }
+    /* The tail is zero-padded rather than mixed with the previous block. */
+    one = 0;
+    two = 0;
+    if (remaining > word) {
+        memcpy(&one, bytes + i, word);
+        memcpy(&two, bytes + i + word, remaining - word);
+    } else {
+        memcpy(&one, bytes + i, remaining);
+    }
+    hash_multiply(&one, &two, one ^ HASH_SECRET_TWO, two ^ seed);
+    return hash_fold(one ^ HASH_SECRET_ONE ^ (unsigned long) size,
+                     two ^ HASH_SECRET_TWO);
+}
+
+/**
+ * Hashes an arbitrary sequence of bytes. This is containers_hash_bytes_seeded
+ * with a fixed seed, so its collisions can be found by anyone; the unordered
+ * containers use their own secret seeds instead.
+ *
+ * @param data the bytes to hash
+ * @param size the amount of bytes to hash
+ *
+ * @return the hash of the bytes
+ */
+unsigned long containers_hash_bytes(const void *const data, const size_t size)
+{
+    return containers_hash_bytes_seeded(data, size, HASH_SEED);
+}
+
+/**
+ * Hashes a key which is an int.
+ *
+ * @param key the int to hash
+ *
+ * @return the hash of the int
+ */
+unsigned long containers_hash_int(const void *const key)
+{
+    int value;
+    memcpy(&value, key, sizeof(int));
+    return hash_mix((unsigned long) value);
+}
+
+/**
+ * Hashes a key which is a long.
+ *
+ * @param key the long to hash
+ *
+ * @return the hash of the long
+ */
+unsigned long containers_hash_long(const void *const key)
+{
+    long value;
+    memcpy(&value, key, sizeof(long));
+    return hash_mix((unsigned long) value);
+}
+
+/**
+ * Hashes a key which is a pointer to a null-terminated string. Thus, the key
+ * size of the container must be the size of a char pointer, and the characters
+ * of the string are hashed rather than the pointer itself.
+ *
+ * @param key the string pointer to hash
+ *
+ * @return the hash of the string
+ */
+unsigned long containers_hash_string(const void *const key)
+{
+    const char *string;
+    memcpy(&string, key, sizeof(char *));
+    return containers_hash_bytes(string, strlen(string));
+}
+
+/*
+ * Reads random bytes of the operating system into the entropy, unless they have
+ * already been read. A failed read is not remembered, so the next seed tries
+ * again. Without a source of random bytes, the entropy stays zero.
+ */
+static int hash_read_entropy(void)
+{
+#ifdef CONTAINERS_HAS_FD
+    ssize_t size;
+    int fd;
+    if (hash_has_entropy) {
+        return 0;
+    }
+    fd = open("/dev/urandom", O_RDONLY);
+    if (fd == -1) {
+        return -EIO;
+    }
+    size = read(fd, &hash_entropy, sizeof(unsigned long));
+    close(fd);
+    if (size != (ssize_t) sizeof(unsigned long)) {
+        return -EIO;
+    }
+#endif
+    hash_has_entropy = 1;
+    return 0;
+}
+
+/**
+ * Generates a secret seed for an unordered container, which differs between
+ * containers and between runs of the program, so that which keys share a
+ * bucket cannot be predicted. The seed is derived from random bytes of the
+ * operating system, which are read by the first call, since the time and the
+ * address of the container alone can be guessed. On Unix, the read and the
+ * counter are guarded by a lock, so seeds may be generated from several threads
+ * at once. Other platforms have neither a lock nor a source of random bytes, so
+ * there, the seed only depends on the time, the salt, and a counter, and seeds
+ * must not be generated from several threads at once.
+ *
+ * @param seed the seed to generate
+ * @param salt a value which differs between containers, such as the address
+ *             of the container
+ *
+ * @return 0    if no error
+ * @return -EIO if the random bytes of the operating system could not be read
+ */
+int containers_hash_new_seed(unsigned long *const seed, const void *const salt)
+{
+    unsigned long count;
+    int rc;
+#ifdef CONTAINERS_HAS_THREADS
+    pthread_mutex_lock(&hash_seed_lock);
+#endif
+    rc = hash_read_entropy();
+    hash_counter++;
+    count = hash_counter;
+#ifdef CONTAINERS_HAS_THREADS
+    pthread_mutex_unlock(&hash_seed_lock);
+#endif
+    if (rc != 0) {
+        return rc;
+    }
+    *seed = hash_entropy ^ (unsigned long) time(NULL);
+    *seed ^= (unsigned long) clock() << 16;
+    *seed ^= (unsigned long) (size_t) salt;
+    *seed ^= count * 0x9e3779b9UL;
+    *seed = hash_mix(*seed);
+    return 0;
+}
@@ -30,13 +30,36 @@
  */
 typedef struct internal_array *array;
 
+/* Flags for mapped storage */
+#define ARRAY_HUGE_PAGES 0x1
+#define ARRAY_READ_ONLY 0x2
+#define ARRAY_CREATE 0x4
+
 /* Starting */
 array array_init(int element_count, size_t data_size);
+array array_init_mapped(int element_count, size_t data_size, int flags);
+array array_open_mapped(const char *path,
+                        int element_count,
+                        size_t data_size,
+                        int flags);
 
 /* Utility */
 int array_size(array me);
 void array_copy_to_array(void *arr, array me);
 void *array_get_data(array me);
+int array_sync(array me);
+void array_sort(array me,
+                int (*comparator)(const void *const one,
+                                  const void *const two));
+int array_lower_bound(array me,
+                      void *key,
+                      int (*comparator)(const void *const one,
+                                        const void *const two));
+int array_eytzinger_layout(array me);
+int array_eytzinger_lower_bound(array me,
+                                void *key,
+                                int (*comparator)(const void *const one,
+                                                  const void *const two));
 
 /* Accessing */
 int array_set(array me, int index, void *data);
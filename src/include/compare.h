@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_COMPARE_H
+#define CONTAINERS_COMPARE_H
+
+/*
+ * Built-in comparators, which can be passed as the key comparator of the set,
+ * map, multi-set, multi-map, and unordered containers. The containers recognize
+ * them, and compare the keys inline rather than through the function pointer
+ * when the key size matches the type. The scalar comparators also select a
+ * radix sort in containers_sort. containers_compare_key is not a function, but
+ * a marker for comparing all the bytes of the key, since the key size is only
+ * known to the container. Like SIG_IGN, it must not be called.
+ */
+
+/* Comparing */
+int containers_compare_int(const void *one, const void *two);
+int containers_compare_long(const void *one, const void *two);
+int containers_compare_uint(const void *one, const void *two);
+int containers_compare_ulong(const void *one, const void *two);
+int containers_compare_float(const void *one, const void *two);
+int containers_compare_double(const void *one, const void *two);
+
+#define containers_compare_key ((int (*)(const void *, const void *)) 1)
+
+#endif /* CONTAINERS_COMPARE_H */
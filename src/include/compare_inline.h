@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_COMPARE_INLINE_H
+#define CONTAINERS_COMPARE_INLINE_H
+
+#include <string.h>
+
+/*
+ * Internal to the library. Inline dispatch of the built-in comparators from
+ * compare.h, which must be included before these are used. Each container and
+ * algorithm which accepts a comparator compares through these macros, so that
+ * the built-in comparators are recognized in one place.
+ */
+
+/*
+ * Compares the scalars of type T which one and two point to.
+ */
+#define CONTAINERS_COMPARE_AS(T, one, two)                                    \
+    ((*(const T *) (one) > *(const T *) (two))                                \
+     - (*(const T *) (one) < *(const T *) (two)))
+
+/*
+ * Compares two elements of the given size. The built-in scalar comparators are
+ * inlined rather than called through the function pointer when they match the
+ * size, and the containers_compare_key marker, which is not callable, compares
+ * all the bytes of the elements. Any other comparator is called.
+ */
+#define CONTAINERS_COMPARE(comparator, size, one, two)                        \
+    ((comparator) == containers_compare_int && (size) == sizeof(int)          \
+     ? CONTAINERS_COMPARE_AS(int, one, two)                                   \
+     : (comparator) == containers_compare_long && (size) == sizeof(long)      \
+     ? CONTAINERS_COMPARE_AS(long, one, two)                                  \
+     : (comparator) == containers_compare_uint                                \
+       && (size) == sizeof(unsigned int)                                      \
+     ? CONTAINERS_COMPARE_AS(unsigned int, one, two)                          \
+     : (comparator) == containers_compare_ulong                               \
+       && (size) == sizeof(unsigned long)                                     \
+     ? CONTAINERS_COMPARE_AS(unsigned long, one, two)                         \
+     : (comparator) == containers_compare_key                                 \
+     ? memcmp(one, two, size)                                                 \
+     : (comparator)(one, two))
+
+/*
+ * Determines whether the comparator considers two elements of the given size
+ * to be equal exactly when their bytes are equal, which is the case for the
+ * built-in comparators other than those of floating point numbers, as long as
+ * the scalar comparators match the size.
+ */
+#define CONTAINERS_COMPARE_IS_BYTEWISE(comparator, size)                      \
+    (((comparator) == containers_compare_int && (size) == sizeof(int))        \
+     || ((comparator) == containers_compare_long && (size) == sizeof(long))   \
+     || ((comparator) == containers_compare_uint                              \
+         && (size) == sizeof(unsigned int))                                   \
+     || ((comparator) == containers_compare_ulong                             \
+         && (size) == sizeof(unsigned long))                                  \
+     || (comparator) == containers_compare_key)
+
+#endif /* CONTAINERS_COMPARE_INLINE_H */
@@ -38,6 +38,8 @@ int deque_size(deque me);
 int deque_is_empty(deque me);
 int deque_trim(deque me);
 void deque_copy_to_array(void *arr, deque me);
+int deque_sort(deque me,
+               int (*comparator)(const void *const one, const void *const two));
 
 /* Adding */
 int deque_push_front(deque me, void *data);
@@ -56,6 +58,10 @@ int deque_set_last(deque me, void *data);
 int deque_get_first(void *data, deque me);
 int deque_get_at(void *data, deque me, int index);
 int deque_get_last(void *data, deque me);
+void *deque_get_ref_at(deque me, int index);
+int deque_for_each_block(deque me,
+                         int (*callback)(void *data, int count, void *context),
+                         void *context);
 
 /* Ending */
 int deque_clear(deque me);
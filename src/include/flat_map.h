@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_FLAT_MAP_H
+#define CONTAINERS_FLAT_MAP_H
+
+#include <stdlib.h>
+
+/**
+ * The flat_map data structure, which is a collection of key-value pairs with
+ * unique keys, kept sorted in contiguous storage.
+ */
+typedef struct internal_flat_map *flat_map;
+
+/* Starting */
+flat_map flat_map_init(size_t key_size,
+                       size_t value_size,
+                       int (*comparator)(const void *const one,
+                                         const void *const two));
+
+/* Capacity */
+int flat_map_size(flat_map me);
+int flat_map_is_empty(flat_map me);
+int flat_map_reserve(flat_map me, int size);
+
+/* Utility */
+void *flat_map_get_keys(flat_map me);
+void *flat_map_get_values(flat_map me);
+int flat_map_put_all(flat_map me, void *keys, void *values, int count);
+int flat_map_assign(flat_map me, void *keys, void *values, int count);
+
+/* Accessing */
+int flat_map_put(flat_map me, void *key, void *value);
+int flat_map_get(void *value, flat_map me, void *key);
+int flat_map_contains(flat_map me, void *key);
+int flat_map_lower_bound(flat_map me, void *key);
+int flat_map_get_at(void *key, void *value, flat_map me, int index);
+int flat_map_remove(flat_map me, void *key);
+
+/* Ending */
+int flat_map_clear(flat_map me);
+flat_map flat_map_destroy(flat_map me);
+
+#endif /* CONTAINERS_FLAT_MAP_H */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_FLAT_SET_H
+#define CONTAINERS_FLAT_SET_H
+
+#include <stdlib.h>
+
+/**
+ * The flat_set data structure, which is a collection of unique keys, kept
+ * sorted in contiguous storage.
+ */
+typedef struct internal_flat_set *flat_set;
+
+/* Starting */
+flat_set flat_set_init(size_t key_size,
+                       int (*comparator)(const void *const one,
+                                         const void *const two));
+
+/* Capacity */
+int flat_set_size(flat_set me);
+int flat_set_is_empty(flat_set me);
+int flat_set_reserve(flat_set me, int size);
+
+/* Utility */
+void *flat_set_get_data(flat_set me);
+int flat_set_put_all(flat_set me, void *keys, int count);
+int flat_set_assign(flat_set me, void *keys, int count);
+
+/* Accessing */
+int flat_set_put(flat_set me, void *key);
+int flat_set_contains(flat_set me, void *key);
+int flat_set_lower_bound(flat_set me, void *key);
+int flat_set_get_at(void *key, flat_set me, int index);
+int flat_set_remove(flat_set me, void *key);
+
+/* Ending */
+int flat_set_clear(flat_set me);
+flat_set flat_set_destroy(flat_set me);
+
+#endif /* CONTAINERS_FLAT_SET_H */
@@ -30,6 +30,16 @@
  */
 typedef struct internal_forward_list *forward_list;
 
+/**
+ * A position in a singly-linked list, which is owned by the caller. Its members
+ * are internal and should not be used directly.
+ */
+struct forward_list_cursor {
+    void *internal_prev;
+    void *internal_node;
+    int internal_index;
+};
+
 /* Starting */
 forward_list forward_list_init(size_t data_size);
 
@@ -58,6 +68,27 @@ int forward_list_get_first(void *data, forward_list me);
 int forward_list_get_at(void *data, forward_list me, int index);
 int forward_list_get_last(void *data, forward_list me);
 
+/* Cursors */
+int forward_list_cursor_first(forward_list me,
+                              struct forward_list_cursor *cursor);
+int forward_list_cursor_next(forward_list me,
+                             struct forward_list_cursor *cursor);
+int forward_list_cursor_index(const struct forward_list_cursor *cursor);
+int forward_list_cursor_get(void *data,
+                            forward_list me,
+                            const struct forward_list_cursor *cursor);
+int forward_list_cursor_set(forward_list me,
+                            const struct forward_list_cursor *cursor,
+                            void *data);
+int forward_list_cursor_add_before(forward_list me,
+                                   struct forward_list_cursor *cursor,
+                                   void *data);
+int forward_list_cursor_add_after(forward_list me,
+                                  struct forward_list_cursor *cursor,
+                                  void *data);
+int forward_list_cursor_remove(forward_list me,
+                               struct forward_list_cursor *cursor);
+
 /* Ending */
 void forward_list_clear(forward_list me);
 forward_list forward_list_destroy(forward_list me);
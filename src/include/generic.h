@@ -0,0 +1,1239 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_GENERIC_H
+#define CONTAINERS_GENERIC_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+ * Generators of type-specialized containers. Each generator defines a handle
+ * type called name, and static functions prefixed by name which behave like
+ * the functions of the matching generic container, except that the elements
+ * are passed and returned by value. Since the element types and the hash and
+ * comparison functions are known at compile-time, the compiler can inline
+ * them. Each generator should be used at most once per name in a translation
+ * unit, and the functions which are not used are not emitted.
+ */
+
+#if defined(__GNUC__)
+#define CONTAINERS_GENERIC_API static __attribute__((unused))
+#else
+#define CONTAINERS_GENERIC_API static
+#endif
+
+#define CONTAINERS_GENERIC_START 8
+
+/**
+ * Defines a vector of T called name, which is a dynamic contiguous array. The
+ * functions are init, size, is_empty, reserve, get_data, add_at, add_last,
+ * remove_at, remove_last, set_at, get_at, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_VECTOR(name, T)                                     \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    T *data;                                                                  \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->data = malloc(CONTAINERS_GENERIC_START * sizeof(T));                \
+    if (!init->data) {                                                        \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_reserve(name me, const int size)            \
+{                                                                             \
+    T *temp;                                                                  \
+    if (size <= me->capacity) {                                               \
+        return 0;                                                             \
+    }                                                                         \
+    temp = realloc(me->data, (size_t) size * sizeof(T));                      \
+    if (!temp) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    me->data = temp;                                                          \
+    me->capacity = size;                                                      \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API T *name##_get_data(name me)                            \
+{                                                                             \
+    return me->data;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_add_at(name me, const int index, T data)    \
+{                                                                             \
+    if (index < 0 || index > me->size) {                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_reserve(me, me->capacity + me->capacity / 2);   \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    memmove(me->data + index + 1, me->data + index,                           \
+            (size_t) (me->size - index) * sizeof(T));                         \
+    me->data[index] = data;                                                   \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_add_last(name me, T data)                   \
+{                                                                             \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_reserve(me, me->capacity + me->capacity / 2);   \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    me->data[me->size] = data;                                                \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove_at(name me, const int index)         \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->size--;                                                               \
+    memmove(me->data + index, me->data + index + 1,                           \
+            (size_t) (me->size - index) * sizeof(T));                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove_last(name me)                        \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->size--;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_set_at(name me, const int index, T data)    \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->data[index] = data;                                                   \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get_at(T *const data, name me,              \
+                                         const int index)                     \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    *data = me->data[index];                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    free(me->data);                                                           \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a deque of T called name, which is a double-ended queue stored in a
+ * circular buffer. The functions are init, size, is_empty, push_front,
+ * push_back, pop_front, pop_back, set_at, get_at, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_DEQUE(name, T)                                      \
+typedef struct name##_internal {                                              \
+    int start;                                                                \
+    int size;                                                                 \
+    int capacity;                                                             \
+    T *data;                                                                  \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->start = 0;                                                          \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->data = malloc(CONTAINERS_GENERIC_START * sizeof(T));                \
+    if (!init->data) {                                                        \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_grow(name me)                               \
+{                                                                             \
+    const int capacity = 2 * me->capacity;                                    \
+    const int head = me->capacity - me->start;                                \
+    T *const data = malloc((size_t) capacity * sizeof(T));                    \
+    if (!data) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    if (me->size <= head) {                                                   \
+        memcpy(data, me->data + me->start, (size_t) me->size * sizeof(T));    \
+    } else {                                                                  \
+        memcpy(data, me->data + me->start, (size_t) head * sizeof(T));        \
+        memcpy(data + head, me->data,                                         \
+               (size_t) (me->size - head) * sizeof(T));                       \
+    }                                                                         \
+    free(me->data);                                                           \
+    me->data = data;                                                          \
+    me->start = 0;                                                            \
+    me->capacity = capacity;                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_push_front(name me, T data)                 \
+{                                                                             \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_grow(me);                                       \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    me->start = (me->start + me->capacity - 1) % me->capacity;                \
+    me->data[me->start] = data;                                               \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_push_back(name me, T data)                  \
+{                                                                             \
+    if (me->size == me->capacity) {                                           \
+        const int rc = name##_grow(me);                                       \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    me->data[(me->start + me->size) % me->capacity] = data;                   \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_pop_front(T *const data, name me)           \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    *data = me->data[me->start];                                              \
+    me->start = (me->start + 1) % me->capacity;                               \
+    me->size--;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_pop_back(T *const data, name me)            \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->size--;                                                               \
+    *data = me->data[(me->start + me->size) % me->capacity];                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_set_at(name me, const int index, T data)    \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    me->data[(me->start + index) % me->capacity] = data;                      \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get_at(T *const data, name me,              \
+                                         const int index)                     \
+{                                                                             \
+    if (index < 0 || index >= me->size) {                                     \
+        return -EINVAL;                                                       \
+    }                                                                         \
+    *data = me->data[(me->start + index) % me->capacity];                     \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    me->start = 0;                                                            \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    free(me->data);                                                           \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a priority queue of T called name. The compare function or macro is
+ * called with two elements, and returns a positive value if the first has a
+ * higher priority than the second. The functions are init, size, is_empty,
+ * push, pop, front, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_PRIORITY_QUEUE(name, T, compare)                    \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    T *data;                                                                  \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->data = malloc(CONTAINERS_GENERIC_START * sizeof(T));                \
+    if (!init->data) {                                                        \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_push(name me, T data)                       \
+{                                                                             \
+    int index;                                                                \
+    if (me->size == me->capacity) {                                           \
+        const int capacity = me->capacity + me->capacity / 2;                 \
+        T *const temp = realloc(me->data, (size_t) capacity * sizeof(T));     \
+        if (!temp) {                                                          \
+            return -ENOMEM;                                                   \
+        }                                                                     \
+        me->data = temp;                                                      \
+        me->capacity = capacity;                                              \
+    }                                                                         \
+    index = me->size;                                                         \
+    me->size++;                                                               \
+    while (index > 0) {                                                       \
+        const int parent = (index - 1) / 2;                                   \
+        if (compare(data, me->data[parent]) <= 0) {                           \
+            break;                                                            \
+        }                                                                     \
+        me->data[index] = me->data[parent];                                   \
+        index = parent;                                                       \
+    }                                                                         \
+    me->data[index] = data;                                                   \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_pop(T *const data, name me)                 \
+{                                                                             \
+    int index = 0;                                                            \
+    T last;                                                                   \
+    if (me->size == 0) {                                                      \
+        return 0;                                                             \
+    }                                                                         \
+    *data = me->data[0];                                                      \
+    me->size--;                                                               \
+    last = me->data[me->size];                                                \
+    for (;;) {                                                                \
+        int child = 2 * index + 1;                                            \
+        if (child >= me->size) {                                              \
+            break;                                                            \
+        }                                                                     \
+        if (child + 1 < me->size                                              \
+            && compare(me->data[child + 1], me->data[child]) > 0) {           \
+            child++;                                                          \
+        }                                                                     \
+        if (compare(me->data[child], last) <= 0) {                            \
+            break;                                                            \
+        }                                                                     \
+        me->data[index] = me->data[child];                                    \
+        index = child;                                                        \
+    }                                                                         \
+    me->data[index] = last;                                                   \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_front(T *const data, name me)               \
+{                                                                             \
+    if (me->size == 0) {                                                      \
+        return 0;                                                             \
+    }                                                                         \
+    *data = me->data[0];                                                      \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    free(me->data);                                                           \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines an unordered map from K to V called name. The hash function or macro
+ * is called with a key and returns an unsigned long, and the equal function or
+ * macro is called with two keys and returns non-zero if they are equal. The
+ * functions are init, size, is_empty, put, get, contains, remove, clear, and
+ * destroy.
+ */
+#define CONTAINERS_DEFINE_UNORDERED_MAP(name, K, V, hash, equal)              \
+struct name##_node {                                                          \
+    K key;                                                                    \
+    V value;                                                                  \
+    unsigned long hash;                                                       \
+    struct name##_node *next;                                                 \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    struct name##_node **buckets;                                             \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API unsigned long name##_hash(K key)                       \
+{                                                                             \
+    unsigned long hash_value = hash(key);                                     \
+    hash_value ^= (hash_value >> 20UL) ^ (hash_value >> 12UL);                \
+    return hash_value ^ (hash_value >> 7UL) ^ (hash_value >> 4UL);            \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->buckets = calloc(CONTAINERS_GENERIC_START,                          \
+                           sizeof(struct name##_node *));                     \
+    if (!init->buckets) {                                                     \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_resize(name me, const int capacity)         \
+{                                                                             \
+    int i;                                                                    \
+    struct name##_node **const buckets =                                      \
+            calloc((size_t) capacity, sizeof(struct name##_node *));          \
+    if (!buckets) {                                                           \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            const int index = (int) (traverse->hash % capacity);              \
+            traverse->next = buckets[index];                                  \
+            buckets[index] = traverse;                                        \
+            traverse = next;                                                  \
+        }                                                                     \
+    }                                                                         \
+    free(me->buckets);                                                        \
+    me->buckets = buckets;                                                    \
+    me->capacity = capacity;                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_find(                       \
+        name me, K key, const unsigned long h)                                \
+{                                                                             \
+    struct name##_node *traverse = me->buckets[(int) (h % me->capacity)];     \
+    while (traverse) {                                                        \
+        if (traverse->hash == h && equal(traverse->key, key)) {               \
+            return traverse;                                                  \
+        }                                                                     \
+        traverse = traverse->next;                                            \
+    }                                                                         \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, K key, V value)                \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node *item = name##_find(me, key, h);                       \
+    int index;                                                                \
+    if (item) {                                                               \
+        item->value = value;                                                  \
+        return 0;                                                             \
+    }                                                                         \
+    if (4 * (me->size + 1) >= 3 * me->capacity) {                             \
+        const int rc = name##_resize(me, me->capacity + me->capacity / 2);    \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    item = malloc(sizeof(struct name##_node));                                \
+    if (!item) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    index = (int) (h % me->capacity);                                         \
+    item->key = key;                                                          \
+    item->value = value;                                                      \
+    item->hash = h;                                                           \
+    item->next = me->buckets[index];                                          \
+    me->buckets[index] = item;                                                \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get(V *const value, name me, K key)         \
+{                                                                             \
+    const struct name##_node *const item =                                    \
+            name##_find(me, key, name##_hash(key));                           \
+    if (!item) {                                                              \
+        return 0;                                                             \
+    }                                                                         \
+    *value = item->value;                                                     \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, K key)                    \
+{                                                                             \
+    return name##_find(me, key, name##_hash(key)) != NULL;                    \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, K key)                      \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node **link = &me->buckets[(int) (h % me->capacity)];       \
+    while (*link) {                                                           \
+        struct name##_node *const item = *link;                               \
+        if (item->hash == h && equal(item->key, key)) {                       \
+            *link = item->next;                                               \
+            free(item);                                                       \
+            me->size--;                                                       \
+            return 1;                                                         \
+        }                                                                     \
+        link = &item->next;                                                   \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    int i;                                                                    \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            free(traverse);                                                   \
+            traverse = next;                                                  \
+        }                                                                     \
+        me->buckets[i] = NULL;                                                \
+    }                                                                         \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me->buckets);                                                        \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines an unordered set of T called name. The hash function or macro is
+ * called with a key and returns an unsigned long, and the equal function or
+ * macro is called with two keys and returns non-zero if they are equal. The
+ * functions are init, size, is_empty, put, contains, remove, clear, and
+ * destroy.
+ */
+#define CONTAINERS_DEFINE_UNORDERED_SET(name, T, hash, equal)                 \
+struct name##_node {                                                          \
+    T key;                                                                    \
+    unsigned long hash;                                                       \
+    struct name##_node *next;                                                 \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    int capacity;                                                             \
+    struct name##_node **buckets;                                             \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API unsigned long name##_hash(T key)                       \
+{                                                                             \
+    unsigned long hash_value = hash(key);                                     \
+    hash_value ^= (hash_value >> 20UL) ^ (hash_value >> 12UL);                \
+    return hash_value ^ (hash_value >> 7UL) ^ (hash_value >> 4UL);            \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->capacity = CONTAINERS_GENERIC_START;                                \
+    init->buckets = calloc(CONTAINERS_GENERIC_START,                          \
+                           sizeof(struct name##_node *));                     \
+    if (!init->buckets) {                                                     \
+        free(init);                                                           \
+        return NULL;                                                          \
+    }                                                                         \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_resize(name me, const int capacity)         \
+{                                                                             \
+    int i;                                                                    \
+    struct name##_node **const buckets =                                      \
+            calloc((size_t) capacity, sizeof(struct name##_node *));          \
+    if (!buckets) {                                                           \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            const int index = (int) (traverse->hash % capacity);              \
+            traverse->next = buckets[index];                                  \
+            buckets[index] = traverse;                                        \
+            traverse = next;                                                  \
+        }                                                                     \
+    }                                                                         \
+    free(me->buckets);                                                        \
+    me->buckets = buckets;                                                    \
+    me->capacity = capacity;                                                  \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_find(                       \
+        name me, T key, const unsigned long h)                                \
+{                                                                             \
+    struct name##_node *traverse = me->buckets[(int) (h % me->capacity)];     \
+    while (traverse) {                                                        \
+        if (traverse->hash == h && equal(traverse->key, key)) {               \
+            return traverse;                                                  \
+        }                                                                     \
+        traverse = traverse->next;                                            \
+    }                                                                         \
+    return NULL;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, T key)                         \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node *item = name##_find(me, key, h);                       \
+    int index;                                                                \
+    if (item) {                                                               \
+        return 0;                                                             \
+    }                                                                         \
+    if (4 * (me->size + 1) >= 3 * me->capacity) {                             \
+        const int rc = name##_resize(me, me->capacity + me->capacity / 2);    \
+        if (rc != 0) {                                                        \
+            return rc;                                                        \
+        }                                                                     \
+    }                                                                         \
+    item = malloc(sizeof(struct name##_node));                                \
+    if (!item) {                                                              \
+        return -ENOMEM;                                                       \
+    }                                                                         \
+    index = (int) (h % me->capacity);                                         \
+    item->key = key;                                                          \
+    item->hash = h;                                                           \
+    item->next = me->buckets[index];                                          \
+    me->buckets[index] = item;                                                \
+    me->size++;                                                               \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, T key)                    \
+{                                                                             \
+    return name##_find(me, key, name##_hash(key)) != NULL;                    \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, T key)                      \
+{                                                                             \
+    const unsigned long h = name##_hash(key);                                 \
+    struct name##_node **link = &me->buckets[(int) (h % me->capacity)];       \
+    while (*link) {                                                           \
+        struct name##_node *const item = *link;                               \
+        if (item->hash == h && equal(item->key, key)) {                       \
+            *link = item->next;                                               \
+            free(item);                                                       \
+            me->size--;                                                       \
+            return 1;                                                         \
+        }                                                                     \
+        link = &item->next;                                                   \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    int i;                                                                    \
+    for (i = 0; i < me->capacity; i++) {                                      \
+        struct name##_node *traverse = me->buckets[i];                        \
+        while (traverse) {                                                    \
+            struct name##_node *const next = traverse->next;                  \
+            free(traverse);                                                   \
+            traverse = next;                                                  \
+        }                                                                     \
+        me->buckets[i] = NULL;                                                \
+    }                                                                         \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me->buckets);                                                        \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a map from K to V called name, which is sorted by keys. The compare
+ * function or macro is called with two keys, and returns a negative value,
+ * zero, or a positive value like the comparator of a map. The functions are
+ * init, size, is_empty, put, get, contains, remove, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_MAP(name, K, V, compare)                            \
+struct name##_node {                                                          \
+    K key;                                                                    \
+    V value;                                                                  \
+    int height;                                                               \
+    struct name##_node *left;                                                 \
+    struct name##_node *right;                                                \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    struct name##_node *root;                                                 \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->root = NULL;                                                        \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_height(const struct name##_node *item)      \
+{                                                                             \
+    return item ? item->height : 0;                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_update(struct name##_node *const item)     \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    item->height = 1 + (left > right ? left : right);                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_rotate(                     \
+        struct name##_node *const item, const int is_left)                    \
+{                                                                             \
+    struct name##_node *pivot;                                                \
+    if (is_left) {                                                            \
+        pivot = item->right;                                                  \
+        item->right = pivot->left;                                            \
+        pivot->left = item;                                                   \
+    } else {                                                                  \
+        pivot = item->left;                                                   \
+        item->left = pivot->right;                                            \
+        pivot->right = item;                                                  \
+    }                                                                         \
+    name##_update(item);                                                      \
+    name##_update(pivot);                                                     \
+    return pivot;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_balance(                    \
+        struct name##_node *const item)                                       \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    name##_update(item);                                                      \
+    if (left - right > 1) {                                                   \
+        if (name##_height(item->left->left)                                   \
+            < name##_height(item->left->right)) {                             \
+            item->left = name##_rotate(item->left, 1);                        \
+        }                                                                     \
+        return name##_rotate(item, 0);                                        \
+    }                                                                         \
+    if (right - left > 1) {                                                   \
+        if (name##_height(item->right->right)                                 \
+            < name##_height(item->right->left)) {                             \
+            item->right = name##_rotate(item->right, 0);                      \
+        }                                                                     \
+        return name##_rotate(item, 1);                                        \
+    }                                                                         \
+    return item;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_insert(                     \
+        name me, struct name##_node *const item, K key, V value, int *rc)     \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        struct name##_node *const add = malloc(sizeof(struct name##_node));   \
+        if (!add) {                                                           \
+            *rc = -ENOMEM;                                                    \
+            return NULL;                                                      \
+        }                                                                     \
+        add->key = key;                                                       \
+        add->value = value;                                                   \
+        add->height = 1;                                                      \
+        add->left = NULL;                                                     \
+        add->right = NULL;                                                    \
+        me->size++;                                                           \
+        return add;                                                           \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result == 0) {                                                        \
+        item->value = value;                                                  \
+        return item;                                                          \
+    }                                                                         \
+    if (result < 0) {                                                         \
+        struct name##_node *const left =                                      \
+                name##_insert(me, item->left, key, value, rc);                \
+        if (!left) {                                                          \
+            return item;                                                      \
+        }                                                                     \
+        item->left = left;                                                    \
+    } else {                                                                  \
+        struct name##_node *const right =                                     \
+                name##_insert(me, item->right, key, value, rc);               \
+        if (!right) {                                                         \
+            return item;                                                      \
+        }                                                                     \
+        item->right = right;                                                  \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_erase(                      \
+        name me, struct name##_node *item, K key, int *removed)               \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result < 0) {                                                         \
+        item->left = name##_erase(me, item->left, key, removed);              \
+    } else if (result > 0) {                                                  \
+        item->right = name##_erase(me, item->right, key, removed);            \
+    } else if (item->left && item->right) {                                   \
+        struct name##_node *successor = item->right;                          \
+        while (successor->left) {                                             \
+            successor = successor->left;                                      \
+        }                                                                     \
+        item->key = successor->key;                                           \
+        item->value = successor->value;                                       \
+        item->right =                                                         \
+                name##_erase(me, item->right, successor->key, removed);       \
+    } else {                                                                  \
+        struct name##_node *const child =                                     \
+                item->left ? item->left : item->right;                        \
+        free(item);                                                           \
+        me->size--;                                                           \
+        *removed = 1;                                                         \
+        return child;                                                         \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, K key, V value)                \
+{                                                                             \
+    int rc = 0;                                                               \
+    struct name##_node *const root =                                          \
+            name##_insert(me, me->root, key, value, &rc);                     \
+    if (root) {                                                               \
+        me->root = root;                                                      \
+    }                                                                         \
+    return rc;                                                                \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_get(V *const value, name me, K key)         \
+{                                                                             \
+    const struct name##_node *traverse = me->root;                            \
+    while (traverse) {                                                        \
+        const int result = compare(key, traverse->key);                       \
+        if (result == 0) {                                                    \
+            *value = traverse->value;                                         \
+            return 1;                                                         \
+        }                                                                     \
+        traverse = result < 0 ? traverse->left : traverse->right;             \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, K key)                    \
+{                                                                             \
+    const struct name##_node *traverse = me->root;                            \
+    while (traverse) {                                                        \
+        const int result = compare(key, traverse->key);                       \
+        if (result == 0) {                                                    \
+            return 1;                                                         \
+        }                                                                     \
+        traverse = result < 0 ? traverse->left : traverse->right;             \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, K key)                      \
+{                                                                             \
+    int removed = 0;                                                          \
+    me->root = name##_erase(me, me->root, key, &removed);                     \
+    return removed;                                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_free_subtree(struct name##_node *item)     \
+{                                                                             \
+    while (item) {                                                            \
+        struct name##_node *const right = item->right;                        \
+        name##_free_subtree(item->left);                                      \
+        free(item);                                                           \
+        item = right;                                                         \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    name##_free_subtree(me->root);                                            \
+    me->root = NULL;                                                          \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+/**
+ * Defines a set of T called name, which is sorted. The compare function or
+ * macro is called with two keys, and returns a negative value, zero, or a
+ * positive value like the comparator of a set. The functions are init, size,
+ * is_empty, put, contains, remove, clear, and destroy.
+ */
+#define CONTAINERS_DEFINE_SET(name, T, compare)                               \
+struct name##_node {                                                          \
+    T key;                                                                    \
+    int height;                                                               \
+    struct name##_node *left;                                                 \
+    struct name##_node *right;                                                \
+};                                                                            \
+                                                                              \
+typedef struct name##_internal {                                              \
+    int size;                                                                 \
+    struct name##_node *root;                                                 \
+} *name;                                                                      \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_init(void)                                 \
+{                                                                             \
+    name init = malloc(sizeof(struct name##_internal));                       \
+    if (!init) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    init->size = 0;                                                           \
+    init->root = NULL;                                                        \
+    return init;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_size(name me)                               \
+{                                                                             \
+    return me->size;                                                          \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_is_empty(name me)                           \
+{                                                                             \
+    return me->size == 0;                                                     \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_height(const struct name##_node *item)      \
+{                                                                             \
+    return item ? item->height : 0;                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_update(struct name##_node *const item)     \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    item->height = 1 + (left > right ? left : right);                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_rotate(                     \
+        struct name##_node *const item, const int is_left)                    \
+{                                                                             \
+    struct name##_node *pivot;                                                \
+    if (is_left) {                                                            \
+        pivot = item->right;                                                  \
+        item->right = pivot->left;                                            \
+        pivot->left = item;                                                   \
+    } else {                                                                  \
+        pivot = item->left;                                                   \
+        item->left = pivot->right;                                            \
+        pivot->right = item;                                                  \
+    }                                                                         \
+    name##_update(item);                                                      \
+    name##_update(pivot);                                                     \
+    return pivot;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_balance(                    \
+        struct name##_node *const item)                                       \
+{                                                                             \
+    const int left = name##_height(item->left);                               \
+    const int right = name##_height(item->right);                             \
+    name##_update(item);                                                      \
+    if (left - right > 1) {                                                   \
+        if (name##_height(item->left->left)                                   \
+            < name##_height(item->left->right)) {                             \
+            item->left = name##_rotate(item->left, 1);                        \
+        }                                                                     \
+        return name##_rotate(item, 0);                                        \
+    }                                                                         \
+    if (right - left > 1) {                                                   \
+        if (name##_height(item->right->right)                                 \
+            < name##_height(item->right->left)) {                             \
+            item->right = name##_rotate(item->right, 0);                      \
+        }                                                                     \
+        return name##_rotate(item, 1);                                        \
+    }                                                                         \
+    return item;                                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_insert(                     \
+        name me, struct name##_node *const item, T key, int *rc)              \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        struct name##_node *const add = malloc(sizeof(struct name##_node));   \
+        if (!add) {                                                           \
+            *rc = -ENOMEM;                                                    \
+            return NULL;                                                      \
+        }                                                                     \
+        add->key = key;                                                       \
+        add->height = 1;                                                      \
+        add->left = NULL;                                                     \
+        add->right = NULL;                                                    \
+        me->size++;                                                           \
+        return add;                                                           \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result == 0) {                                                        \
+        return item;                                                          \
+    }                                                                         \
+    if (result < 0) {                                                         \
+        struct name##_node *const left =                                      \
+                name##_insert(me, item->left, key, rc);                       \
+        if (!left) {                                                          \
+            return item;                                                      \
+        }                                                                     \
+        item->left = left;                                                    \
+    } else {                                                                  \
+        struct name##_node *const right =                                     \
+                name##_insert(me, item->right, key, rc);                      \
+        if (!right) {                                                         \
+            return item;                                                      \
+        }                                                                     \
+        item->right = right;                                                  \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API struct name##_node *name##_erase(                      \
+        name me, struct name##_node *item, T key, int *removed)               \
+{                                                                             \
+    int result;                                                               \
+    if (!item) {                                                              \
+        return NULL;                                                          \
+    }                                                                         \
+    result = compare(key, item->key);                                         \
+    if (result < 0) {                                                         \
+        item->left = name##_erase(me, item->left, key, removed);              \
+    } else if (result > 0) {                                                  \
+        item->right = name##_erase(me, item->right, key, removed);            \
+    } else if (item->left && item->right) {                                   \
+        struct name##_node *successor = item->right;                          \
+        while (successor->left) {                                             \
+            successor = successor->left;                                      \
+        }                                                                     \
+        item->key = successor->key;                                           \
+        item->right =                                                         \
+                name##_erase(me, item->right, successor->key, removed);       \
+    } else {                                                                  \
+        struct name##_node *const child =                                     \
+                item->left ? item->left : item->right;                        \
+        free(item);                                                           \
+        me->size--;                                                           \
+        *removed = 1;                                                         \
+        return child;                                                         \
+    }                                                                         \
+    return name##_balance(item);                                              \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_put(name me, T key)                         \
+{                                                                             \
+    int rc = 0;                                                               \
+    struct name##_node *const root =                                          \
+            name##_insert(me, me->root, key, &rc);                            \
+    if (root) {                                                               \
+        me->root = root;                                                      \
+    }                                                                         \
+    return rc;                                                                \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_contains(name me, T key)                    \
+{                                                                             \
+    const struct name##_node *traverse = me->root;                            \
+    while (traverse) {                                                        \
+        const int result = compare(key, traverse->key);                       \
+        if (result == 0) {                                                    \
+            return 1;                                                         \
+        }                                                                     \
+        traverse = result < 0 ? traverse->left : traverse->right;             \
+    }                                                                         \
+    return 0;                                                                 \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API int name##_remove(name me, T key)                      \
+{                                                                             \
+    int removed = 0;                                                          \
+    me->root = name##_erase(me, me->root, key, &removed);                     \
+    return removed;                                                           \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_free_subtree(struct name##_node *item)     \
+{                                                                             \
+    while (item) {                                                            \
+        struct name##_node *const right = item->right;                        \
+        name##_free_subtree(item->left);                                      \
+        free(item);                                                           \
+        item = right;                                                         \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API void name##_clear(name me)                             \
+{                                                                             \
+    name##_free_subtree(me->root);                                            \
+    me->root = NULL;                                                          \
+    me->size = 0;                                                             \
+}                                                                             \
+                                                                              \
+CONTAINERS_GENERIC_API name name##_destroy(name me)                           \
+{                                                                             \
+    name##_clear(me);                                                         \
+    free(me);                                                                 \
+    return NULL;                                                              \
+}
+
+#endif /* CONTAINERS_GENERIC_H */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_HASH_H
+#define CONTAINERS_HASH_H
+
+#include <stdlib.h>
+
+/*
+ * Built-in hash functions, which can be passed as the hash function of any of
+ * the unordered containers. The unordered containers recognize them, and call
+ * them directly rather than through the function pointer.
+ *
+ * containers_hash_key is not a function, but a marker which selects hashing
+ * all the bytes of the key, since the key size is only known to the container.
+ * Like SIG_IGN, it must not be called, so outside of a container, use
+ * containers_hash_bytes with the key size instead.
+ */
+
+/* Hashing */
+unsigned long containers_hash_bytes_seeded(const void *data,
+                                           size_t size,
+                                           unsigned long seed);
+unsigned long containers_hash_bytes(const void *data, size_t size);
+unsigned long containers_hash_int(const void *key);
+unsigned long containers_hash_long(const void *key);
+unsigned long containers_hash_string(const void *key);
+
+/* Seeding */
+int containers_hash_new_seed(unsigned long *seed, const void *salt);
+
+#define containers_hash_key ((unsigned long (*)(const void *)) 1)
+
+#endif /* CONTAINERS_HASH_H */
@@ -30,6 +30,15 @@
  */
 typedef struct internal_list *list;
 
+/**
+ * A position in a doubly-linked list, which is owned by the caller. Its members
+ * are internal and should not be used directly.
+ */
+struct list_cursor {
+    void *internal_node;
+    int internal_index;
+};
+
 /* Starting */
 list list_init(size_t data_size);
 
@@ -58,6 +67,19 @@ int list_get_first(void *data, list me);
 int list_get_at(void *data, list me, int index);
 int list_get_last(void *data, list me);
 
+/* Cursors */
+int list_cursor_first(list me, struct list_cursor *cursor);
+int list_cursor_last(list me, struct list_cursor *cursor);
+int list_cursor_at(list me, struct list_cursor *cursor, int index);
+int list_cursor_next(list me, struct list_cursor *cursor);
+int list_cursor_prev(list me, struct list_cursor *cursor);
+int list_cursor_index(const struct list_cursor *cursor);
+int list_cursor_get(void *data, list me, const struct list_cursor *cursor);
+int list_cursor_set(list me, const struct list_cursor *cursor, void *data);
+int list_cursor_add_before(list me, struct list_cursor *cursor, void *data);
+int list_cursor_add_after(list me, struct list_cursor *cursor, void *data);
+int list_cursor_remove(list me, struct list_cursor *cursor);
+
 /* Ending */
 void list_clear(list me);
 list list_destroy(list me);
@@ -40,12 +40,24 @@ map map_init(size_t key_size,
 int map_size(map me);
 int map_is_empty(map me);
 
+/* Utility */
+int map_save(map me, int fd);
+int map_load(map me, int fd);
+
 /* Accessing */
 int map_put(map me, void *key, void *value);
 int map_get(void *value, map me, void *key);
 int map_contains(map me, void *key);
+int map_rank(map me, void *key);
+int map_select(void *key, void *value, map me, int index);
 int map_remove(map me, void *key);
 
+/* Combining */
+int map_union(map me, map one, map two);
+int map_intersection(map me, map one, map two);
+int map_difference(map me, map one, map two);
+int map_is_subset(map me, map other);
+
 /* Ending */
 void map_clear(map me);
 map map_destroy(map me);
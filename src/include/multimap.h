@@ -31,6 +31,16 @@
  */
 typedef struct internal_multimap *multimap;
 
+/**
+ * A cursor over the values of a key in a multi-map, which is owned by the
+ * caller. Its members are internal and should not be used directly.
+ */
+struct multimap_values {
+    void *internal_values;
+    int internal_count;
+    int internal_index;
+};
+
 /* Starting */
 multimap multimap_init(size_t key_size,
                        size_t value_size,
@@ -43,12 +53,25 @@ multimap multimap_init(size_t key_size,
 int multimap_size(multimap me);
 int multimap_is_empty(multimap me);
 
+/* Utility */
+int multimap_save(multimap me, int fd);
+int multimap_load(multimap me, int fd);
+
 /* Accessing */
 int multimap_put(multimap me, void *key, void *value);
 void multimap_get_start(multimap me, void *key);
 int multimap_get_next(void *value, multimap me);
+int multimap_values_start(multimap me,
+                          struct multimap_values *cursor,
+                          void *key);
+int multimap_values_next(void *value,
+                         multimap me,
+                         struct multimap_values *cursor);
+int multimap_get_values(void **values, multimap me, void *key);
 int multimap_count(multimap me, void *key);
 int multimap_contains(multimap me, void *key);
+int multimap_rank(multimap me, void *key);
+int multimap_select(void *key, void *value, multimap me, int index);
 int multimap_remove(multimap me, void *key, void *value);
 int multimap_remove_all(multimap me, void *key);
 
@@ -40,13 +40,25 @@ multiset multiset_init(size_t key_size,
 int multiset_size(multiset me);
 int multiset_is_empty(multiset me);
 
+/* Utility */
+int multiset_save(multiset me, int fd);
+int multiset_load(multiset me, int fd);
+
 /* Accessing */
 int multiset_put(multiset me, void *key);
 int multiset_count(multiset me, void *key);
 int multiset_contains(multiset me, void *key);
+int multiset_rank(multiset me, void *key);
+int multiset_select(void *key, multiset me, int index);
 int multiset_remove(multiset me, void *key);
 int multiset_remove_all(multiset me, void *key);
 
+/* Combining */
+int multiset_union(multiset me, multiset one, multiset two);
+int multiset_intersection(multiset me, multiset one, multiset two);
+int multiset_difference(multiset me, multiset one, multiset two);
+int multiset_is_subset(multiset me, multiset other);
+
 /* Ending */
 void multiset_clear(multiset me);
 multiset multiset_destroy(multiset me);
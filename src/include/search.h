@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_SEARCH_H
+#define CONTAINERS_SEARCH_H
+
+#include <stdlib.h>
+
+/*
+ * Searching of contiguous sorted elements, which is what the vector and array
+ * search functions are built on. Large read-mostly tables can be rearranged
+ * into Eytzinger order once, after which their searches are cache-friendly.
+ */
+
+/* Searching */
+int containers_lower_bound(void *data,
+                           int count,
+                           size_t size,
+                           void *key,
+                           int (*comparator)(const void *const one,
+                                             const void *const two));
+int containers_eytzinger_layout(void *data, int count, size_t size);
+int containers_eytzinger_lower_bound(void *data,
+                                     int count,
+                                     size_t size,
+                                     void *key,
+                                     int (*comparator)(const void *const one,
+                                                       const void *const two));
+
+#endif /* CONTAINERS_SEARCH_H */
@@ -38,11 +38,23 @@ set set_init(size_t key_size,
 int set_size(set me);
 int set_is_empty(set me);
 
+/* Utility */
+int set_save(set me, int fd);
+int set_load(set me, int fd);
+
 /* Accessing */
 int set_put(set me, void *key);
 int set_contains(set me, void *key);
+int set_rank(set me, void *key);
+int set_select(void *key, set me, int index);
 int set_remove(set me, void *key);
 
+/* Combining */
+int set_union(set me, set one, set two);
+int set_intersection(set me, set one, set two);
+int set_difference(set me, set one, set two);
+int set_is_subset(set me, set other);
+
 /* Ending */
 void set_clear(set me);
 set set_destroy(set me);
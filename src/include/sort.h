@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONTAINERS_SORT_H
+#define CONTAINERS_SORT_H
+
+#include <stdlib.h>
+
+/*
+ * Sorting of contiguous elements, which is what the vector, array, and deque
+ * sort functions are built on. When the comparator is one of the built-in
+ * scalar comparators from compare.h and it matches the element size, the
+ * elements are sorted by their bits with a radix sort instead of calling the
+ * comparator. The containers_compare_key marker sorts the elements by all of
+ * their bytes.
+ */
+
+/* Sorting */
+void containers_sort(void *data,
+                     int count,
+                     size_t size,
+                     int (*comparator)(const void *const one,
+                                       const void *const two));
+
+#endif /* CONTAINERS_SORT_H */
@@ -31,6 +31,16 @@
  */
 typedef struct internal_unordered_map *unordered_map;
 
+/**
+ * A cursor over the key-value pairs of an unordered map, which is owned by the
+ * caller. Its members are internal and should not be used directly.
+ */
+struct unordered_map_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+};
+
 /* Starting */
 unordered_map unordered_map_init(size_t key_size,
                                  size_t value_size,
@@ -42,6 +52,15 @@ unordered_map unordered_map_init(size_t key_size,
 int unordered_map_rehash(unordered_map me);
 int unordered_map_size(unordered_map me);
 int unordered_map_is_empty(unordered_map me);
+int unordered_map_reserve(unordered_map me, int size);
+int unordered_map_set_max_load_factor(unordered_map me, double max_load_factor);
+int unordered_map_set_min_load_factor(unordered_map me, double min_load_factor);
+int unordered_map_shrink_to_fit(unordered_map me);
+int unordered_map_set_incremental_resize(unordered_map me,
+                                         int buckets_per_step);
+int unordered_map_set_max_chain_length(unordered_map me, int max_chain_length);
+int unordered_map_save(unordered_map me, int fd);
+int unordered_map_load(unordered_map me, int fd);
 
 /* Accessing */
 int unordered_map_put(unordered_map me, void *key, void *value);
@@ -49,6 +68,19 @@ int unordered_map_get(void *value, unordered_map me, void *key);
 int unordered_map_contains(unordered_map me, void *key);
 int unordered_map_remove(unordered_map me, void *key);
 
+/* Iterating */
+int unordered_map_first(unordered_map me, struct unordered_map_cursor *cursor);
+int unordered_map_next(unordered_map me, struct unordered_map_cursor *cursor);
+int unordered_map_cursor_get(void *key,
+                             void *value,
+                             unordered_map me,
+                             const struct unordered_map_cursor *cursor);
+int unordered_map_cursor_remove(unordered_map me,
+                                struct unordered_map_cursor *cursor);
+
+/* Combining */
+int unordered_map_merge(unordered_map me, unordered_map other);
+
 /* Ending */
 int unordered_map_clear(unordered_map me);
 unordered_map unordered_map_destroy(unordered_map me);
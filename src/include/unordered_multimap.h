@@ -31,6 +31,27 @@
  */
 typedef struct internal_unordered_multimap *unordered_multimap;
 
+/**
+ * A cursor over the key-value pairs of an unordered multi-map, which is owned
+ * by the caller. Its members are internal and should not be used directly.
+ */
+struct unordered_multimap_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+    int internal_index;
+};
+
+/**
+ * A cursor over the values of a key in an unordered multi-map, which is owned
+ * by the caller. Its members are internal and should not be used directly.
+ */
+struct unordered_multimap_values {
+    void *internal_values;
+    int internal_count;
+    int internal_index;
+};
+
 /* Starting */
 unordered_multimap
 unordered_multimap_init(size_t key_size,
@@ -45,16 +66,50 @@ unordered_multimap_init(size_t key_size,
 int unordered_multimap_rehash(unordered_multimap me);
 int unordered_multimap_size(unordered_multimap me);
 int unordered_multimap_is_empty(unordered_multimap me);
+int unordered_multimap_reserve(unordered_multimap me, int size);
+int unordered_multimap_set_max_load_factor(unordered_multimap me,
+                                           double max_load_factor);
+int unordered_multimap_set_min_load_factor(unordered_multimap me,
+                                           double min_load_factor);
+int unordered_multimap_shrink_to_fit(unordered_multimap me);
+int unordered_multimap_set_incremental_resize(unordered_multimap me,
+                                              int buckets_per_step);
+int unordered_multimap_set_max_chain_length(unordered_multimap me,
+                                            int max_chain_length);
+int unordered_multimap_save(unordered_multimap me, int fd);
+int unordered_multimap_load(unordered_multimap me, int fd);
 
 /* Accessing */
 int unordered_multimap_put(unordered_multimap me, void *key, void *value);
 void unordered_multimap_get_start(unordered_multimap me, void *key);
 int unordered_multimap_get_next(void *value, unordered_multimap me);
+int unordered_multimap_values_start(unordered_multimap me,
+                                    struct unordered_multimap_values *cursor,
+                                    void *key);
+int unordered_multimap_values_next(void *value,
+                                   unordered_multimap me,
+                                   struct unordered_multimap_values *cursor);
+int unordered_multimap_get_values(void **values,
+                                  unordered_multimap me,
+                                  void *key);
 int unordered_multimap_count(unordered_multimap me, void *key);
 int unordered_multimap_contains(unordered_multimap me, void *key);
 int unordered_multimap_remove(unordered_multimap me, void *key, void *value);
 int unordered_multimap_remove_all(unordered_multimap me, void *key);
 
+/* Iterating */
+int unordered_multimap_first(unordered_multimap me,
+                             struct unordered_multimap_cursor *cursor);
+int unordered_multimap_next(unordered_multimap me,
+                            struct unordered_multimap_cursor *cursor);
+int
+unordered_multimap_cursor_get(void *key,
+                              void *value,
+                              unordered_multimap me,
+                              const struct unordered_multimap_cursor *cursor);
+int unordered_multimap_cursor_remove(unordered_multimap me,
+                                     struct unordered_multimap_cursor *cursor);
+
 /* Ending */
 int unordered_multimap_clear(unordered_multimap me);
 unordered_multimap unordered_multimap_destroy(unordered_multimap me);
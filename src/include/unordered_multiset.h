@@ -31,6 +31,16 @@
  */
 typedef struct internal_unordered_multiset *unordered_multiset;
 
+/**
+ * A cursor over the distinct keys of an unordered multi-set, which is owned by
+ * the caller. Its members are internal and should not be used directly.
+ */
+struct unordered_multiset_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+};
+
 /* Starting */
 unordered_multiset
 unordered_multiset_init(size_t key_size,
@@ -42,6 +52,18 @@ unordered_multiset_init(size_t key_size,
 int unordered_multiset_rehash(unordered_multiset me);
 int unordered_multiset_size(unordered_multiset me);
 int unordered_multiset_is_empty(unordered_multiset me);
+int unordered_multiset_reserve(unordered_multiset me, int size);
+int unordered_multiset_set_max_load_factor(unordered_multiset me,
+                                           double max_load_factor);
+int unordered_multiset_set_min_load_factor(unordered_multiset me,
+                                           double min_load_factor);
+int unordered_multiset_shrink_to_fit(unordered_multiset me);
+int unordered_multiset_set_incremental_resize(unordered_multiset me,
+                                              int buckets_per_step);
+int unordered_multiset_set_max_chain_length(unordered_multiset me,
+                                            int max_chain_length);
+int unordered_multiset_save(unordered_multiset me, int fd);
+int unordered_multiset_load(unordered_multiset me, int fd);
 
 /* Accessing */
 int unordered_multiset_put(unordered_multiset me, void *key);
@@ -50,6 +72,18 @@ int unordered_multiset_contains(unordered_multiset me, void *key);
 int unordered_multiset_remove(unordered_multiset me, void *key);
 int unordered_multiset_remove_all(unordered_multiset me, void *key);
 
+/* Iterating */
+int unordered_multiset_first(unordered_multiset me,
+                             struct unordered_multiset_cursor *cursor);
+int unordered_multiset_next(unordered_multiset me,
+                            struct unordered_multiset_cursor *cursor);
+int
+unordered_multiset_cursor_get(void *key,
+                              unordered_multiset me,
+                              const struct unordered_multiset_cursor *cursor);
+int unordered_multiset_cursor_remove(unordered_multiset me,
+                                     struct unordered_multiset_cursor *cursor);
+
 /* Ending */
 int unordered_multiset_clear(unordered_multiset me);
 unordered_multiset unordered_multiset_destroy(unordered_multiset me);
@@ -31,6 +31,16 @@
  */
 typedef struct internal_unordered_set *unordered_set;
 
+/**
+ * A cursor over the keys of an unordered set, which is owned by the caller. Its
+ * members are internal and should not be used directly.
+ */
+struct unordered_set_cursor {
+    int internal_table;
+    int internal_bucket;
+    void *internal_link;
+};
+
 /* Starting */
 unordered_set unordered_set_init(size_t key_size,
                                  unsigned long (*hash)(const void *const key),
@@ -41,12 +51,39 @@ unordered_set unordered_set_init(size_t key_size,
 int unordered_set_rehash(unordered_set me);
 int unordered_set_size(unordered_set me);
 int unordered_set_is_empty(unordered_set me);
+int unordered_set_reserve(unordered_set me, int size);
+int unordered_set_set_max_load_factor(unordered_set me, double max_load_factor);
+int unordered_set_set_min_load_factor(unordered_set me, double min_load_factor);
+int unordered_set_shrink_to_fit(unordered_set me);
+int unordered_set_set_incremental_resize(unordered_set me,
+                                         int buckets_per_step);
+int unordered_set_set_max_chain_length(unordered_set me, int max_chain_length);
+int unordered_set_save(unordered_set me, int fd);
+int unordered_set_load(unordered_set me, int fd);
 
 /* Accessing */
 int unordered_set_put(unordered_set me, void *key);
 int unordered_set_contains(unordered_set me, void *key);
 int unordered_set_remove(unordered_set me, void *key);
 
+/* Iterating */
+int unordered_set_first(unordered_set me, struct unordered_set_cursor *cursor);
+int unordered_set_next(unordered_set me, struct unordered_set_cursor *cursor);
+int unordered_set_cursor_get(void *key,
+                             unordered_set me,
+                             const struct unordered_set_cursor *cursor);
+int unordered_set_cursor_remove(unordered_set me,
+                                struct unordered_set_cursor *cursor);
+
+/* Combining */
+int unordered_set_intersect(unordered_set me,
+                            unordered_set one,
+                            unordered_set two);
+int unordered_set_difference(unordered_set me,
+                             unordered_set one,
+                             unordered_set two);
+int unordered_set_union_into(unordered_set me, unordered_set other);
+
 /* Ending */
 int unordered_set_clear(unordered_set me);
 unordered_set unordered_set_destroy(unordered_set me);
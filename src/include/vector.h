@@ -30,8 +30,15 @@
  */
 typedef struct internal_vector *vector;
 
+/* Flags for mapped storage */
+#define VECTOR_HUGE_PAGES 0x1
+#define VECTOR_READ_ONLY 0x2
+#define VECTOR_CREATE 0x4
+
 /* Starting */
 vector vector_init(size_t data_size);
+vector vector_init_mapped(size_t data_size, int flags);
+vector vector_open_mapped(const char *path, size_t data_size, int flags);
 
 /* Utility */
 int vector_size(vector me);
@@ -41,6 +48,23 @@ int vector_reserve(vector me, int size);
 int vector_trim(vector me);
 void vector_copy_to_array(void *arr, vector me);
 void *vector_get_data(vector me);
+int vector_sync(vector me);
+void vector_sort(vector me,
+                 int (*comparator)(const void *const one,
+                                   const void *const two));
+int vector_parallel_sort(vector me,
+                         int (*comparator)(const void *const one,
+                                           const void *const two),
+                         int thread_count);
+int vector_lower_bound(vector me,
+                       void *key,
+                       int (*comparator)(const void *const one,
+                                         const void *const two));
+int vector_eytzinger_layout(vector me);
+int vector_eytzinger_lower_bound(vector me,
+                                 void *key,
+                                 int (*comparator)(const void *const one,
+                                                   const void *const two));
 
 /* Adding */
 int vector_add_first(vector me, void *data);
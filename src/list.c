@@ -29,6 +29,8 @@ struct internal_list {
     int item_count;
     struct node *head;
     struct node *tail;
+    int cache_index;
+    struct node *cache;
 };
 
 struct node {
@@ -60,6 +62,8 @@ list list_init(const size_t data_size)
     init->item_count = 0;
     init->head = NULL;
     init->tail = NULL;
+    init->cache_index = 0;
+    init->cache = NULL;
     return init;
 }
 
@@ -110,40 +114,115 @@ void list_copy_to_array(void *const arr, list me)
 }
 
 /*
- * Gets the node at index starting from the head.
+ * Gets the node at the specified index. The walk starts from whichever of the
+ * head, the tail, and the most recently accessed node is closest to the index,
+ * so that accessing neighbouring indices one after another takes constant time.
  */
-static struct node *list_get_node_from_head(list me, const int index)
+static struct node *list_get_node_at(list me, const int index)
 {
     struct node *traverse = me->head;
-    int i;
-    for (i = 0; i < index; i++) {
+    int position = 0;
+    int distance = index;
+    if (me->item_count - 1 - index < distance) {
+        traverse = me->tail;
+        position = me->item_count - 1;
+        distance = position - index;
+    }
+    if (me->cache) {
+        const int cache_distance = index > me->cache_index
+                                   ? index - me->cache_index
+                                   : me->cache_index - index;
+        if (cache_distance < distance) {
+            traverse = me->cache;
+            position = me->cache_index;
+        }
+    }
+    while (position < index) {
         traverse = traverse->next;
+        position++;
     }
+    while (position > index) {
+        traverse = traverse->prev;
+        position--;
+    }
+    me->cache = traverse;
+    me->cache_index = index;
     return traverse;
 }
 
 /*
- * Gets the node at index starting from the tail.
+ * Creates a node which holds a copy of the data.
  */
-static struct node *list_get_node_from_tail(list me, const int index)
+static struct node *list_create_node(list me, const void *const data)
 {
-    struct node *traverse = me->tail;
-    int i;
-    for (i = me->item_count - 1; i > index; i--) {
-        traverse = traverse->prev;
+    struct node *const add = malloc(sizeof(struct node));
+    if (!add) {
+        return NULL;
     }
-    return traverse;
+    add->data = malloc(me->bytes_per_item);
+    if (!add->data) {
+        free(add);
+        return NULL;
+    }
+    memcpy(add->data, data, me->bytes_per_item);
+    return add;
 }
 
 /*
- * Gets the node at the specified index.
+ * Links the node in before the specified node, or at the end if there is none,
+ * where the index is the index which the node ends up at.
  */
-static struct node *list_get_node_at(list me, const int index)
+static void list_link(list me,
+                      struct node *const add,
+                      struct node *const before,
+                      const int index)
 {
-    if (index < me->item_count / 2) {
-        return list_get_node_from_head(me, index);
+    add->next = before;
+    add->prev = before ? before->prev : me->tail;
+    if (add->prev) {
+        add->prev->next = add;
+    } else {
+        me->head = add;
+    }
+    if (before) {
+        before->prev = add;
+    } else {
+        me->tail = add;
     }
-    return list_get_node_from_tail(me, index);
+    if (me->cache && index <= me->cache_index) {
+        me->cache_index++;
+    }
+    me->item_count++;
+}
+
+/*
+ * Unlinks and frees the node at the specified index. If it is the most recently
+ * accessed node, one of its neighbours takes its place.
+ */
+static void list_unlink(list me, struct node *const item, const int index)
+{
+    if (item->prev) {
+        item->prev->next = item->next;
+    } else {
+        me->head = item->next;
+    }
+    if (item->next) {
+        item->next->prev = item->prev;
+    } else {
+        me->tail = item->prev;
+    }
+    if (me->cache == item) {
+        me->cache = item->next;
+        if (!me->cache) {
+            me->cache = item->prev;
+            me->cache_index--;
+        }
+    } else if (me->cache && index < me->cache_index) {
+        me->cache_index--;
+    }
+    free(item->data);
+    free(item);
+    me->item_count--;
 }
 
 /**
@@ -185,41 +264,15 @@ int list_add_at(list me, const int index, void *const data)
     if (index < 0 || index > me->item_count) {
         return -EINVAL;
     }
-    add = malloc(sizeof(struct node));
+    add = list_create_node(me, data);
     if (!add) {
         return -ENOMEM;
     }
-    add->data = malloc(me->bytes_per_item);
-    if (!add->data) {
-        free(add);
-        return -ENOMEM;
-    }
-    memcpy(add->data, data, me->bytes_per_item);
-    if (!me->head) {
-        add->prev = NULL;
-        add->next = NULL;
-        me->head = add;
-        me->tail = add;
-    } else if (index == 0) {
-        struct node *const traverse = me->head;
-        traverse->prev = add;
-        add->prev = NULL;
-        add->next = traverse;
-        me->head = add;
-    } else if (index == me->item_count) {
-        struct node *const traverse = me->tail;
-        traverse->next = add;
-        add->prev = traverse;
-        add->next = NULL;
-        me->tail = add;
+    if (index == me->item_count) {
+        list_link(me, add, NULL, index);
     } else {
-        struct node *const traverse = list_get_node_at(me, index);
-        add->prev = traverse->prev;
-        add->next = traverse;
-        traverse->prev->next = add;
-        traverse->prev = add;
+        list_link(me, add, list_get_node_at(me, index), index);
     }
-    me->item_count++;
     return 0;
 }
 
@@ -273,24 +326,10 @@ int list_remove_first(list me)
  */
 int list_remove_at(list me, const int index)
 {
-    struct node *traverse;
     if (list_is_illegal_input(me, index)) {
         return -EINVAL;
     }
-    traverse = list_get_node_at(me, index);
-    if (index == 0) {
-        traverse->next->prev = NULL;
-        me->head = traverse->next;
-    } else if (index == me->item_count - 1) {
-        traverse->prev->next = NULL;
-        me->tail = traverse->prev;
-    } else {
-        traverse->prev->next = traverse->next;
-        traverse->next->prev = traverse->prev;
-    }
-    free(traverse->data);
-    free(traverse);
-    me->item_count--;
+    list_unlink(me, list_get_node_at(me, index), index);
     return 0;
 }
 
@@ -432,6 +471,242 @@ int list_get_last(void *const data, list me)
     return list_get_at(data, me, me->item_count - 1);
 }
 
+/**
+ * Moves the cursor to the first element of the doubly-linked list. The cursor
+ * is owned by the caller, and remains valid until the doubly-linked list is
+ * modified other than through the cursor.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if the doubly-linked
+ *         list is empty
+ */
+int list_cursor_first(list me, struct list_cursor *const cursor)
+{
+    cursor->internal_node = me->head;
+    cursor->internal_index = 0;
+    return me->head != NULL;
+}
+
+/**
+ * Moves the cursor to the last element of the doubly-linked list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if the doubly-linked
+ *         list is empty
+ */
+int list_cursor_last(list me, struct list_cursor *const cursor)
+{
+    cursor->internal_node = me->tail;
+    cursor->internal_index = me->item_count - 1;
+    return me->tail != NULL;
+}
+
+/**
+ * Moves the cursor to the element at the specified index of the doubly-linked
+ * list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ * @param index  the index to move the cursor to
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int list_cursor_at(list me, struct list_cursor *const cursor, const int index)
+{
+    if (list_is_illegal_input(me, index)) {
+        return -EINVAL;
+    }
+    cursor->internal_node = list_get_node_at(me, index);
+    cursor->internal_index = index;
+    return 0;
+}
+
+/**
+ * Moves the cursor to the next element of the doubly-linked list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if it moved past the
+ *         last element
+ */
+int list_cursor_next(list me, struct list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    (void) me;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_node = item->next;
+    cursor->internal_index++;
+    return item->next != NULL;
+}
+
+/**
+ * Moves the cursor to the previous element of the doubly-linked list.
+ *
+ * @param me     the doubly-linked list to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at an element, otherwise 0 if it moved past the
+ *         first element
+ */
+int list_cursor_prev(list me, struct list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    (void) me;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_node = item->prev;
+    cursor->internal_index--;
+    return item->prev != NULL;
+}
+
+/**
+ * Gets the index of the element at the cursor.
+ *
+ * @param cursor the cursor to check
+ *
+ * @return the index of the element, or -1 if the cursor is not at an element
+ */
+int list_cursor_index(const struct list_cursor *const cursor)
+{
+    if (!cursor->internal_node) {
+        return -1;
+    }
+    return cursor->internal_index;
+}
+
+/**
+ * Copies the element at the cursor to data. The pointer to the data being
+ * obtained should point to the data type which this doubly-linked list holds.
+ *
+ * @param data   the data to get
+ * @param me     the doubly-linked list to get data from
+ * @param cursor the cursor to get at
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_get(void *const data,
+                    list me,
+                    const struct list_cursor *const cursor)
+{
+    const struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(data, item->data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Sets the element at the cursor. The pointer to the data being passed in
+ * should point to the data type which this doubly-linked list holds.
+ *
+ * @param me     the doubly-linked list to set data for
+ * @param cursor the cursor to set at
+ * @param data   the data to set
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_set(list me,
+                    const struct list_cursor *const cursor,
+                    void *const data)
+{
+    struct node *const item = cursor->internal_node;
+    if (!item) {
+        return -EINVAL;
+    }
+    memcpy(item->data, data, me->bytes_per_item);
+    return 0;
+}
+
+/**
+ * Adds data before the element at the cursor in constant time. The cursor
+ * stays at the same element.
+ *
+ * @param me     the doubly-linked list to add data to
+ * @param cursor the cursor to add before
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_add_before(list me,
+                           struct list_cursor *const cursor,
+                           void *const data)
+{
+    struct node *add;
+    if (!cursor->internal_node) {
+        return -EINVAL;
+    }
+    add = list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    list_link(me, add, cursor->internal_node, cursor->internal_index);
+    cursor->internal_index++;
+    return 0;
+}
+
+/**
+ * Adds data after the element at the cursor in constant time. The cursor stays
+ * at the same element.
+ *
+ * @param me     the doubly-linked list to add data to
+ * @param cursor the cursor to add after
+ * @param data   the data to add
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the cursor is not at an element
+ */
+int list_cursor_add_after(list me,
+                          struct list_cursor *const cursor,
+                          void *const data)
+{
+    const struct node *const item = cursor->internal_node;
+    struct node *add;
+    if (!item) {
+        return -EINVAL;
+    }
+    add = list_create_node(me, data);
+    if (!add) {
+        return -ENOMEM;
+    }
+    list_link(me, add, item->next, cursor->internal_index + 1);
+    return 0;
+}
+
+/**
+ * Removes the element at the cursor in constant time, and moves the cursor to
+ * the next element.
+ *
+ * @param me     the doubly-linked list to remove data from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at an element after the removal, otherwise 0
+ */
+int list_cursor_remove(list me, struct list_cursor *const cursor)
+{
+    struct node *const item = cursor->internal_node;
+    if (!item) {
+        return 0;
+    }
+    cursor->internal_node = item->next;
+    list_unlink(me, item, cursor->internal_index);
+    return cursor->internal_node != NULL;
+}
+
 /**
  * Clears all elements from the doubly-linked list.
  *
@@ -449,6 +724,7 @@ void list_clear(list me)
     me->head = NULL;
     me->item_count = 0;
     me->tail = NULL;
+    me->cache = NULL;
 }
 
 /**
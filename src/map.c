@@ -22,7 +22,20 @@
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/map.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
 
 struct internal_map {
     size_t key_size;
@@ -35,19 +48,46 @@ struct internal_map {
 struct node {
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     void *value;
     struct node *left;
     struct node *right;
 };
 
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is the key followed by the value.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
 /**
  * Initializes a map.
  *
  * @param key_size   the size of each key in the map; must be positive
  * @param value_size the size of each value in the map; must be positive
  * @param comparator the comparator function used for key ordering; must not be
- *                   NULL
+ *                   NULL; may be one of the built-in comparators from compare.h
  *
  * @return the newly-initialized map, or NULL if it was not successfully
  *         initialized due to either invalid input arguments or memory
@@ -114,6 +154,25 @@ static void map_reference_parent(map me,
     }
 }
 
+/*
+ * Gets the weight of a subtree, which is the amount of keys in it.
+ */
+static int map_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void map_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
 /*
  * Rotates the AVL tree to the left.
  */
@@ -121,6 +180,7 @@ static void map_rotate_left(map me,
                             struct node *const parent,
                             struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     map_reference_parent(me, parent, child);
     grand_child = child->left;
@@ -130,6 +190,8 @@ static void map_rotate_left(map me,
     parent->parent = child;
     parent->right = grand_child;
     child->left = parent;
+    parent->weight += map_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -139,6 +201,7 @@ static void map_rotate_right(map me,
                              struct node *const parent,
                              struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     map_reference_parent(me, parent, child);
     grand_child = child->right;
@@ -148,6 +211,8 @@ static void map_rotate_right(map me,
     parent->parent = child;
     parent->left = grand_child;
     child->right = parent;
+    parent->weight += map_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -299,6 +364,7 @@ static struct node *map_create_node(map me,
     }
     insert->parent = parent;
     insert->balance = 0;
+    insert->weight = 1;
     insert->key = malloc(me->key_size);
     if (!insert->key) {
         free(insert);
@@ -318,6 +384,14 @@ static struct node *map_create_node(map me,
     return insert;
 }
 
+/*
+ * Compares two keys.
+ */
+static int map_compare(map me, const void *const one, const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
 /**
  * Adds a key-value pair to the map. If the map already contains the key, the
  * value is updated to the new value. The pointer to the key and value being
@@ -346,7 +420,7 @@ int map_put(map me, void *const key, void *const value)
     }
     traverse = me->root;
     for (;;) {
-        const int compare = me->comparator(key, traverse->key);
+        const int compare = map_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -356,6 +430,7 @@ int map_put(map me, void *const key, void *const value)
                     return -ENOMEM;
                 }
                 traverse->left = insert;
+                map_add_weight(traverse, 1);
                 map_insert_balance(me, insert);
                 return 0;
             }
@@ -368,6 +443,7 @@ int map_put(map me, void *const key, void *const value)
                     return -ENOMEM;
                 }
                 traverse->right = insert;
+                map_add_weight(traverse, 1);
                 map_insert_balance(me, insert);
                 return 0;
             }
@@ -388,7 +464,7 @@ static struct node *map_equal_match(map me, const void *const key)
         return NULL;
     }
     for (;;) {
-        const int compare = me->comparator(key, traverse->key);
+        const int compare = map_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -448,6 +524,78 @@ int map_contains(map me, void *const key)
     return map_equal_match(me, key) != NULL;
 }
 
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of keys in its subtree. The pointer to the key
+ * being passed in should point to the key type which this map holds.
+ *
+ * @param me  the map to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of keys in the map which are less than the key
+ */
+int map_rank(map me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (map_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - map_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key-value pair at the specified index in sorted key order, so that
+ * index zero is the pair with the smallest key. Either of the key or the value
+ * may be NULL if it is not needed. This takes logarithmic time, since each node
+ * keeps track of the amount of keys in its subtree.
+ *
+ * @param key   the key to copy to, or NULL
+ * @param value the value to copy to, or NULL
+ * @param me    the map to get the key-value pair from
+ * @param index the index of the key-value pair in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int map_select(void *const key,
+               void *const value,
+               map me,
+               const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = map_weight(item->left);
+        const int own = item->weight - left - map_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            offset -= left;
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->value, me->value_size);
+    }
+    return 0;
+}
+
 /*
  * Repairs the AVL tree by pivoting on an item.
  */
@@ -622,11 +770,39 @@ static void map_remove_two_children(map me, const struct node *const traverse)
     map_delete_balance(me, parent, is_left_deleted);
 }
 
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void map_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - map_weight(traverse->left)
+                    - map_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    map_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - map_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
 /*
  * Removes the element from the map.
  */
 static void map_remove_element(map me, struct node *const traverse)
 {
+    map_remove_weight(traverse);
     if (!traverse->left && !traverse->right) {
         map_remove_no_children(me, traverse);
     } else if (!traverse->left || !traverse->right) {
@@ -662,6 +838,534 @@ int map_remove(map me, void *const key)
     return 1;
 }
 
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *map_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was only partially built.
+ */
+static void map_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    map_free_subtree(item->left);
+    map_free_subtree(item->right);
+    free(item->key);
+    free(item->value);
+    free(item);
+}
+
+/*
+ * Gets the node with the smallest key in the subtree.
+ */
+static struct node *map_first_node(struct node *item)
+{
+    if (item) {
+        while (item->left) {
+            item = item->left;
+        }
+    }
+    return item;
+}
+
+/*
+ * Builds a balanced subtree from copies of the sorted items. The middle item is
+ * the root of the subtree, and the items before and after it form the left and
+ * right subtrees.
+ */
+static int map_build_subtree(map me,
+                             const struct node *const *const items,
+                             const int count,
+                             struct node **const subtree,
+                             int *const height)
+{
+    const int left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = map_build_subtree(me, items, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    item = map_create_node(me, items[left_count]->key,
+                           items[left_count]->value, NULL);
+    if (!item) {
+        map_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = map_build_subtree(me, items + left_count + 1,
+                           count - 1 - left_count, &right, &right_height);
+    if (rc != 0) {
+        map_free_subtree(left);
+        map_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + map_weight(left) + map_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+/*
+ * Merges the key-value pairs of two maps in sorted key order into an empty map.
+ * The flags specify whether the keys which are only in the first map, in both
+ * maps, or only in the second map are kept. When a key is in both maps, its
+ * value is taken from the first map.
+ */
+static int map_combine(map me,
+                       map one,
+                       map two,
+                       const int keep_one,
+                       const int keep_both,
+                       const int keep_two)
+{
+    struct node *first = map_first_node(one->root);
+    struct node *second = map_first_node(two->root);
+    const struct node **items;
+    int count = 0;
+    int height;
+    int rc;
+    if (me->root || me->key_size != one->key_size
+        || me->key_size != two->key_size || me->value_size != one->value_size
+        || me->value_size != two->value_size) {
+        return -EINVAL;
+    }
+    if (one->size + two->size == 0) {
+        return 0;
+    }
+    items = malloc((one->size + two->size) * sizeof(const struct node *));
+    if (!items) {
+        return -ENOMEM;
+    }
+    while (first || second) {
+        int compare;
+        if (!first) {
+            compare = 1;
+        } else if (!second) {
+            compare = -1;
+        } else {
+            compare = map_compare(one, first->key, second->key);
+        }
+        if (compare < 0) {
+            if (keep_one) {
+                items[count++] = first;
+            }
+            first = map_next_node(first);
+        } else if (compare > 0) {
+            if (keep_two) {
+                items[count++] = second;
+            }
+            second = map_next_node(second);
+        } else {
+            if (keep_both) {
+                items[count++] = first;
+            }
+            first = map_next_node(first);
+            second = map_next_node(second);
+        }
+    }
+    rc = map_build_subtree(me, items, count, &me->root, &height);
+    if (rc != 0) {
+        me->size = 0;
+    }
+    free(items);
+    return rc;
+}
+
+/**
+ * Stores the union of two maps in an empty map, which is every key that is in
+ * either of the maps. The value of a key which is in both maps is taken from
+ * the first map. Since both maps are traversed in sorted order at the same
+ * time, and the balanced tree is built directly from the result, this takes
+ * linear time. The maps must all have the same key size, value size, and
+ * comparator function. If an error occurs, the map is left empty.
+ *
+ * @param me  the empty map to store the union in
+ * @param one the first map
+ * @param two the second map
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the key or value sizes do not
+ *                 match
+ */
+int map_union(map me, map one, map two)
+{
+    return map_combine(me, one, two, 1, 1, 1);
+}
+
+/**
+ * Stores the intersection of two maps in an empty map, which is every key that
+ * is in both of the maps, along with its value in the first map. This takes
+ * linear time. The maps must all have the same key size, value size, and
+ * comparator function. If an error occurs, the map is left empty.
+ *
+ * @param me  the empty map to store the intersection in
+ * @param one the first map
+ * @param two the second map
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the key or value sizes do not
+ *                 match
+ */
+int map_intersection(map me, map one, map two)
+{
+    return map_combine(me, one, two, 0, 1, 0);
+}
+
+/**
+ * Stores the difference of two maps in an empty map, which is every key that is
+ * in the first map but not in the second map, along with its value. This takes
+ * linear time. The maps must all have the same key size, value size, and
+ * comparator function. If an error occurs, the map is left empty.
+ *
+ * @param me  the empty map to store the difference in
+ * @param one the map to take the keys from
+ * @param two the map whose keys to leave out
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the key or value sizes do not
+ *                 match
+ */
+int map_difference(map me, map one, map two)
+{
+    return map_combine(me, one, two, 1, 0, 0);
+}
+
+/**
+ * Determines if every key of the map is also in the other map. The values are
+ * not compared. This takes linear time, since both maps are traversed in sorted
+ * order at the same time. The maps must have the same comparator function.
+ *
+ * @param me    the map which may be a subset
+ * @param other the map which may contain it
+ *
+ * @return 1 if the map is a subset of the other map, otherwise 0
+ */
+int map_is_subset(map me, map other)
+{
+    struct node *first = map_first_node(me->root);
+    struct node *second = map_first_node(other->root);
+    if (me->size > other->size) {
+        return 0;
+    }
+    while (first) {
+        int compare;
+        if (!second) {
+            return 0;
+        }
+        compare = map_compare(me, first->key, second->key);
+        if (compare < 0) {
+            return 0;
+        }
+        if (compare == 0) {
+            first = map_next_node(first);
+        }
+        second = map_next_node(second);
+    }
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void map_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void map_stream_write(struct snapshot_stream *const stream,
+                             const void *const data,
+                             const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            map_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void map_stream_read(struct snapshot_stream *const stream,
+                            void *const data,
+                            const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int map_load_subtree(map me,
+                            struct snapshot_stream *const stream,
+                            const unsigned long count,
+                            struct node **const subtree,
+                            int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = map_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    map_stream_read(stream, stream->record, me->key_size + me->value_size);
+    if (stream->rc != 0) {
+        map_free_subtree(left);
+        return stream->rc;
+    }
+    item = map_create_node(me, stream->record,
+                           stream->record + me->key_size, NULL);
+    if (!item) {
+        map_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = map_load_subtree(me, stream, count - 1 - left_count, &right,
+                          &right_height);
+    if (rc != 0) {
+        map_free_subtree(left);
+        map_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + map_weight(left) + map_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the map to a file descriptor. The snapshot
+ * consists of a header, which holds the key size, the value size, and the
+ * amount of key-value pairs, followed by the key and the value of each pair in
+ * sorted order. Since the keys and values are copied byte for byte, they should
+ * not contain pointers unless the snapshot is loaded by the same process.
+ *
+ * @param me the map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int map_save(map me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *traverse = me->root;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    header.count = (unsigned long) me->size;
+    map_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    if (traverse) {
+        while (traverse->left) {
+            traverse = traverse->left;
+        }
+    }
+    while (stream.rc == 0 && traverse) {
+        map_stream_write(&stream, traverse->key, me->key_size);
+        map_stream_write(&stream, traverse->value, me->value_size);
+        traverse = map_next_node(traverse);
+    }
+    map_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by map_save into an empty map.
+ * Since the snapshot is sorted, the balanced tree is built directly from it in
+ * linear time without calling the comparator function. Thus, the map must have
+ * been initialized with the same key size, value size, and comparator function
+ * as the map which was saved. If an error occurs, the map is left empty. When
+ * the file descriptor is seekable, it is left positioned right after the
+ * snapshot.
+ *
+ * @param me the map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the map is not empty or the snapshot does not match the
+ *                 map
+ * @return -EIO    if the snapshot could not be read
+ */
+int map_load(map me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer =
+            malloc(SNAPSHOT_BUFFER_SIZE + me->key_size + me->value_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    map_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != (unsigned long) me->value_size
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = map_load_subtree(me, &stream, header.count, &me->root, &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
 /**
  * Clears the key-value pairs from the map.
  *
@@ -22,7 +22,20 @@
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/multimap.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
 
 struct internal_multimap {
     size_t key_size;
@@ -31,22 +44,46 @@ struct internal_multimap {
     int (*value_comparator)(const void *const one, const void *const two);
     int size;
     struct node *root;
-    struct value_node *iterate_get;
+    struct multimap_values iterate;
 };
 
 struct node {
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     int value_count;
-    struct value_node *head;
+    int value_capacity;
+    char *values;
     struct node *left;
     struct node *right;
 };
 
-struct value_node {
-    void *value;
-    struct value_node *next;
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is the value count followed by the key and the
+ * values.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
 };
 
 /**
@@ -56,7 +93,8 @@ struct value_node {
  *                         positive
  * @param value_size       the size of each value in the multi-map; must be
  *                         positive
- * @param key_comparator   the key comparator function; must not be NULL
+ * @param key_comparator   the key comparator function; must not be NULL; may be
+ *                         one of the built-in comparators from compare.h
  * @param value_comparator the value comparator function; must not be NULL
  *
  * @return the newly-initialized multi-map, or NULL if it was not successfully
@@ -85,7 +123,9 @@ multimap multimap_init(const size_t key_size,
     init->value_comparator = value_comparator;
     init->size = 0;
     init->root = NULL;
-    init->iterate_get = NULL;
+    init->iterate.internal_values = NULL;
+    init->iterate.internal_count = 0;
+    init->iterate.internal_index = 0;
     return init;
 }
 
@@ -130,6 +170,25 @@ static void multimap_reference_parent(multimap me,
     }
 }
 
+/*
+ * Gets the weight of a subtree, which is the amount of elements in it.
+ */
+static int multimap_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void multimap_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
 /*
  * Rotates the AVL tree to the left.
  */
@@ -137,6 +196,7 @@ static void multimap_rotate_left(multimap me,
                                  struct node *const parent,
                                  struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     multimap_reference_parent(me, parent, child);
     grand_child = child->left;
@@ -146,6 +206,8 @@ static void multimap_rotate_left(multimap me,
     parent->parent = child;
     parent->right = grand_child;
     child->left = parent;
+    parent->weight += multimap_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -155,6 +217,7 @@ static void multimap_rotate_right(multimap me,
                                   struct node *const parent,
                                   struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     multimap_reference_parent(me, parent, child);
     grand_child = child->right;
@@ -164,6 +227,8 @@ static void multimap_rotate_right(multimap me,
     parent->parent = child;
     parent->left = grand_child;
     child->right = parent;
+    parent->weight += multimap_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -302,23 +367,43 @@ static void multimap_insert_balance(multimap me, struct node *const item)
 }
 
 /*
- * Creates and allocates a value node.
+ * Resizes the array which holds the values of a key. The values of a key are
+ * stored contiguously in insertion order.
  */
-static struct value_node *multimap_create_value_node(multimap me,
-                                                     const void *const value)
+static int multimap_resize_values(multimap me,
+                                  struct node *const item,
+                                  const int capacity)
 {
-    struct value_node *const add = malloc(sizeof(struct value_node));
-    if (!add) {
-        return NULL;
+    char *const temp = realloc(item->values, capacity * me->value_size);
+    if (!temp) {
+        return -ENOMEM;
     }
-    add->value = malloc(me->value_size);
-    if (!add->value) {
-        free(add);
-        return NULL;
+    item->values = temp;
+    item->value_capacity = capacity;
+    return 0;
+}
+
+/*
+ * Appends a value to the values of a key, doubling the capacity of the array
+ * when it is full.
+ */
+static int multimap_append_value(multimap me,
+                                 struct node *const item,
+                                 const void *const value)
+{
+    if (item->value_count == item->value_capacity) {
+        const int rc = multimap_resize_values(me, item,
+                                              2 * item->value_capacity);
+        if (rc != 0) {
+            return rc;
+        }
     }
-    memcpy(add->value, value, me->value_size);
-    add->next = NULL;
-    return add;
+    memcpy(item->values + item->value_count * me->value_size, value,
+           me->value_size);
+    item->value_count++;
+    multimap_add_weight(item, 1);
+    me->size++;
+    return 0;
 }
 
 /*
@@ -335,6 +420,7 @@ static struct node *multimap_create_node(multimap me,
     }
     insert->parent = parent;
     insert->balance = 0;
+    insert->weight = 1;
     insert->key = malloc(me->key_size);
     if (!insert->key) {
         free(insert);
@@ -342,18 +428,40 @@ static struct node *multimap_create_node(multimap me,
     }
     memcpy(insert->key, key, me->key_size);
     insert->value_count = 1;
-    insert->head = multimap_create_value_node(me, value);
-    if (!insert->head) {
+    insert->value_capacity = 1;
+    insert->values = malloc(me->value_size);
+    if (!insert->values) {
         free(insert->key);
         free(insert);
         return NULL;
     }
+    memcpy(insert->values, value, me->value_size);
     insert->left = NULL;
     insert->right = NULL;
     me->size++;
     return insert;
 }
 
+/*
+ * Compares two keys.
+ */
+static int multimap_compare(multimap me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->key_comparator, me->key_size, one, two);
+}
+
+/*
+ * Compares two values.
+ */
+static int multimap_compare_values(multimap me,
+                                   const void *const one,
+                                   const void *const two)
+{
+    return CONTAINERS_COMPARE(me->value_comparator, me->value_size, one, two);
+}
+
 /**
  * Adds a key-value pair to the multi-map. If the multi-map already contains the
  * key, the value is updated to the new value. The pointer to the key and value
@@ -383,7 +491,7 @@ int multimap_put(multimap me, void *const key, void *const value)
     }
     traverse = me->root;
     for (;;) {
-        const int compare = me->key_comparator(key, traverse->key);
+        const int compare = multimap_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -394,6 +502,7 @@ int multimap_put(multimap me, void *const key, void *const value)
                     return -ENOMEM;
                 }
                 traverse->left = insert;
+                multimap_add_weight(traverse, 1);
                 multimap_insert_balance(me, insert);
                 return 0;
             }
@@ -407,18 +516,12 @@ int multimap_put(multimap me, void *const key, void *const value)
                     return -ENOMEM;
                 }
                 traverse->right = insert;
+                multimap_add_weight(traverse, 1);
                 multimap_insert_balance(me, insert);
                 return 0;
             }
         } else {
-            struct value_node *value_traverse = traverse->head;
-            while (value_traverse->next) {
-                value_traverse = value_traverse->next;
-            }
-            value_traverse->next = multimap_create_value_node(me, value);
-            traverse->value_count++;
-            me->size++;
-            return 0;
+            return multimap_append_value(me, traverse, value);
         }
     }
 }
@@ -433,7 +536,7 @@ static struct node *multimap_equal_match(multimap me, const void *const key)
         return 0;
     }
     for (;;) {
-        const int compare = me->key_comparator(key, traverse->key);
+        const int compare = multimap_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -454,21 +557,20 @@ static struct node *multimap_equal_match(multimap me, const void *const key)
 
 /**
  * Creates the iterator for the specified key. To iterate over the values, keep
- * getting the next value. Between starting and iterations, the multi-map must
- * not be mutated. The pointer to the key being passed in should point to the
- * key type which this multi-map holds. For example, if this multi-map holds key
- * integers, the key pointer should be a pointer to an integer. Since the key is
- * being copied, the pointer only has to be valid when this function is called.
+ * getting the next value. Since the iterator is kept in the multi-map, only one
+ * iteration may be in progress at a time, which multimap_values_start avoids.
+ * Between starting and iterations, the multi-map must not be mutated. The
+ * pointer to the key being passed in should point to the key type which this
+ * multi-map holds. For example, if this multi-map holds key integers, the key
+ * pointer should be a pointer to an integer. Since the key is being copied, the
+ * pointer only has to be valid when this function is called.
  *
  * @param me  the multi-map to start the iterator for
  * @param key the key to start the iterator for
  */
 void multimap_get_start(multimap me, void *const key)
 {
-    const struct node *const traverse = multimap_equal_match(me, key);
-    if (traverse) {
-        me->iterate_get = traverse->head;
-    }
+    multimap_values_start(me, &me->iterate, key);
 }
 
 /**
@@ -487,16 +589,92 @@ void multimap_get_start(multimap me, void *const key)
  */
 int multimap_get_next(void *const value, multimap me)
 {
-    const struct value_node *item;
-    if (!me->iterate_get) {
+    return multimap_values_next(value, me, &me->iterate);
+}
+
+/**
+ * Starts iterating over the values for the specified key with a cursor which is
+ * owned by the caller. Unlike multimap_get_start, this does not modify the
+ * multi-map, so several iterations may be in progress at the same time,
+ * including from different threads as long as none of them mutates the
+ * multi-map. The cursor is only valid until the multi-map is next mutated. The
+ * pointer to the key being passed in should point to the key type which this
+ * multi-map holds.
+ *
+ * @param me     the multi-map to iterate over
+ * @param cursor the cursor to start
+ * @param key    the key to iterate over the values of
+ *
+ * @return the number of values for the key
+ */
+int multimap_values_start(multimap me,
+                          struct multimap_values *const cursor,
+                          void *const key)
+{
+    const struct node *const item = multimap_equal_match(me, key);
+    cursor->internal_index = 0;
+    if (!item) {
+        cursor->internal_values = NULL;
+        cursor->internal_count = 0;
+        return 0;
+    }
+    cursor->internal_values = item->values;
+    cursor->internal_count = item->value_count;
+    return item->value_count;
+}
+
+/**
+ * Copies the next value of the cursor, and advances the cursor. The pointer to
+ * the value being obtained should point to the value type which this multi-map
+ * holds.
+ *
+ * @param value  the value to be copied to
+ * @param me     the multi-map being iterated over
+ * @param cursor the cursor to advance
+ *
+ * @return 1 if a value was copied, otherwise 0 if there are no more values
+ */
+int multimap_values_next(void *const value,
+                         multimap me,
+                         struct multimap_values *const cursor)
+{
+    const char *item;
+    if (cursor->internal_index == cursor->internal_count) {
         return 0;
     }
-    item = me->iterate_get;
-    memcpy(value, item->value, me->value_size);
-    me->iterate_get = item->next;
+    item = cursor->internal_values;
+    memcpy(value, item + cursor->internal_index * me->value_size,
+           me->value_size);
+    cursor->internal_index++;
     return 1;
 }
 
+/**
+ * Gets all the values for the specified key at once. The values are stored
+ * contiguously in the order in which they were added, so the span may be read
+ * directly as an array of the value type which this multi-map holds. The span
+ * is owned by the multi-map, and is only valid until the multi-map is next
+ * mutated. The pointer to the key being passed in should point to the key type
+ * which this multi-map holds.
+ *
+ * @param values the pointer to set to the start of the values, or to NULL if
+ *               the multi-map does not contain the key
+ * @param me     the multi-map to get the values from
+ * @param key    the key to get the values for
+ *
+ * @return the number of values in the span
+ */
+int multimap_get_values(void **const values, multimap me, void *const key)
+{
+    struct node *const traverse = multimap_equal_match(me, key);
+    if (!traverse) {
+        *values = NULL;
+        return 0;
+    }
+    *values = traverse->values;
+    return traverse->value_count;
+}
+
 /**
  * Determines the number of times the key appears in the multi-map. The pointer
  * to the key being passed in should point to the key type which this multi-map
@@ -535,6 +713,80 @@ int multimap_contains(multimap me, void *const key)
     return multimap_equal_match(me, key) != NULL;
 }
 
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of key-value pairs in its subtree. The pointer to the key
+ * being passed in should point to the key type which this multi-map holds.
+ *
+ * @param me  the multi-map to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of key-value pairs in the multi-map whose key is less
+ *         than the key
+ */
+int multimap_rank(multimap me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (multimap_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - multimap_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key-value pair at the specified index in sorted key order, where
+ * the values of a key are in the order in which they were added, so that index
+ * zero is the first value of the smallest key. Either of the key or the value
+ * may be NULL if it is not needed. This takes logarithmic time, since each node
+ * keeps track of the amount of key-value pairs in its subtree.
+ *
+ * @param key   the key to copy to, or NULL
+ * @param value the value to copy to, or NULL
+ * @param me    the multi-map to get the key-value pair from
+ * @param index the index of the key-value pair in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int multimap_select(void *const key,
+                    void *const value,
+                    multimap me,
+                    const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = multimap_weight(item->left);
+        const int own = item->weight - left - multimap_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            offset -= left;
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->values + offset * me->value_size, me->value_size);
+    }
+    return 0;
+}
+
 /*
  * Repairs the AVL tree by pivoting on an item.
  */
@@ -712,11 +964,39 @@ static void multimap_remove_two_children(multimap me,
     multimap_delete_balance(me, parent, is_left_deleted);
 }
 
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void multimap_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - multimap_weight(traverse->left)
+                    - multimap_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    multimap_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - multimap_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
 /*
  * Removes the element from the map.
  */
 static void multimap_remove_element(multimap me, struct node *const traverse)
 {
+    multimap_remove_weight(traverse);
     if (!traverse->left && !traverse->right) {
         multimap_remove_no_children(me, traverse);
     } else if (!traverse->left || !traverse->right) {
@@ -724,6 +1004,7 @@ static void multimap_remove_element(multimap me, struct node *const traverse)
     } else {
         multimap_remove_two_children(me, traverse);
     }
+    free(traverse->values);
     free(traverse->key);
     free(traverse);
 }
@@ -744,33 +1025,31 @@ static void multimap_remove_element(multimap me, struct node *const traverse)
  */
 int multimap_remove(multimap me, void *const key, void *const value)
 {
-    struct value_node *current;
+    char *position;
+    char *end;
     struct node *const traverse = multimap_equal_match(me, key);
     if (!traverse) {
         return 0;
     }
-    current = traverse->head;
-    if (me->value_comparator(current->value, value) == 0) {
-        traverse->head = current->next;
-    } else {
-        struct value_node *previous = current;
-        current = current->next;
-        while (current && me->value_comparator(current->value, value) != 0) {
-            previous = current;
-            current = current->next;
-        }
-        if (!current) {
-            return 0;
-        }
-        previous->next = current->next;
+    position = traverse->values;
+    end = traverse->values + traverse->value_count * me->value_size;
+    while (position < end
+           && multimap_compare_values(me, position, value) != 0) {
+        position += me->value_size;
     }
-    free(current->value);
-    free(current);
+    if (position == end) {
+        return 0;
+    }
+    memmove(position, position + me->value_size,
+            end - position - me->value_size);
     traverse->value_count--;
+    multimap_add_weight(traverse, -1);
+    me->size--;
     if (traverse->value_count == 0) {
         multimap_remove_element(me, traverse);
+    } else if (traverse->value_count <= traverse->value_capacity / 4) {
+        multimap_resize_values(me, traverse, traverse->value_capacity / 2);
     }
-    me->size--;
     return 1;
 }
 
@@ -780,13 +1059,6 @@ int multimap_remove(multimap me, void *const key, void *const value)
 static void multimap_remove_all_element(multimap me,
                                         struct node *const traverse)
 {
-    struct value_node *value_traverse = traverse->head;
-    while (value_traverse) {
-        struct value_node *temp = value_traverse;
-        value_traverse = value_traverse->next;
-        free(temp->value);
-        free(temp);
-    }
     me->size -= traverse->value_count;
     multimap_remove_element(me, traverse);
 }
@@ -813,6 +1085,341 @@ int multimap_remove_all(multimap me, void *const key)
     return 1;
 }
 
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void multimap_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void multimap_stream_write(struct snapshot_stream *const stream,
+                                  const void *const data,
+                                  const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            multimap_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void multimap_stream_read(struct snapshot_stream *const stream,
+                                 void *const data,
+                                 const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *multimap_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was partially loaded from a snapshot.
+ */
+static void multimap_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    multimap_free_subtree(item->left);
+    multimap_free_subtree(item->right);
+    free(item->values);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int multimap_load_subtree(multimap me,
+                                 struct snapshot_stream *const stream,
+                                 const unsigned long count,
+                                 struct node **const subtree,
+                                 int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    char *const value = stream->record + me->key_size;
+    unsigned long value_count;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = multimap_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    multimap_stream_read(stream, &value_count, sizeof(unsigned long));
+    multimap_stream_read(stream, stream->record, me->key_size + me->value_size);
+    if (stream->rc != 0) {
+        multimap_free_subtree(left);
+        return stream->rc;
+    }
+    if (value_count == 0
+        || value_count > (unsigned long) (INT_MAX - me->size)
+        || value_count > (size_t) -1 / me->value_size) {
+        multimap_free_subtree(left);
+        return -EINVAL;
+    }
+    item = multimap_create_node(me, stream->record, value, NULL);
+    if (!item) {
+        multimap_free_subtree(left);
+        return -ENOMEM;
+    }
+    if (value_count > 1) {
+        rc = multimap_resize_values(me, item, (int) value_count);
+        if (rc != 0) {
+            multimap_free_subtree(left);
+            multimap_free_subtree(item);
+            return rc;
+        }
+        multimap_stream_read(stream, item->values + me->value_size,
+                             (value_count - 1) * me->value_size);
+        if (stream->rc != 0) {
+            multimap_free_subtree(left);
+            multimap_free_subtree(item);
+            return stream->rc;
+        }
+        item->value_count = (int) value_count;
+        me->size += (int) value_count - 1;
+    }
+    rc = multimap_load_subtree(me, stream, count - 1 - left_count, &right,
+                               &right_height);
+    if (rc != 0) {
+        multimap_free_subtree(left);
+        multimap_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = item->value_count + multimap_weight(left)
+                   + multimap_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the multi-map to a file descriptor. The snapshot
+ * consists of a header, which holds the key size, the value size, and the
+ * amount of distinct keys, followed by the value count, the key, and the values
+ * of each distinct key in sorted order. Since the keys and values are copied
+ * byte for byte, they should not contain pointers unless the snapshot is loaded
+ * by the same process.
+ *
+ * @param me the multi-map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int multimap_save(multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *first = me->root;
+    struct node *traverse;
+    unsigned long node_count = 0;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    if (first) {
+        while (first->left) {
+            first = first->left;
+        }
+    }
+    for (traverse = first; traverse; traverse = multimap_next_node(traverse)) {
+        node_count++;
+    }
+    header.count = node_count;
+    multimap_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    traverse = first;
+    while (stream.rc == 0 && traverse) {
+        const unsigned long value_count = (unsigned long) traverse->value_count;
+        multimap_stream_write(&stream, &value_count, sizeof(unsigned long));
+        multimap_stream_write(&stream, traverse->key, me->key_size);
+        multimap_stream_write(&stream, traverse->values,
+                              traverse->value_count * me->value_size);
+        traverse = multimap_next_node(traverse);
+    }
+    multimap_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by multimap_save into an empty
+ * multi-map. Since the snapshot is sorted, the balanced tree is built directly
+ * from it in linear time without calling the comparator functions. Thus, the
+ * multi-map must have been initialized with the same key size, value size, and
+ * key comparator function as the multi-map which was saved. If an error
+ * occurs, the multi-map is left empty. When the file descriptor is seekable, it
+ * is left positioned right after the snapshot.
+ *
+ * @param me the multi-map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-map is not empty or the snapshot does not
+ *                 match the multi-map
+ * @return -EIO    if the snapshot could not be read
+ */
+int multimap_load(multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer =
+            malloc(SNAPSHOT_BUFFER_SIZE + me->key_size + me->value_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    multimap_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != (unsigned long) me->value_size
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = multimap_load_subtree(me, &stream, header.count, &me->root,
+                                   &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
 /**
  * Clears the key-value pairs from the multi-map.
  *
@@ -22,7 +22,20 @@
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/multiset.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
 
 struct internal_multiset {
     size_t key_size;
@@ -35,18 +48,53 @@ struct node {
     int count;
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     struct node *left;
     struct node *right;
 };
 
+/*
+ * A key along with its amount of occurrences, used when combining multi-sets.
+ */
+struct merge_entry {
+    const void *key;
+    int count;
+};
+
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is the count followed by the key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
 /**
  * Initializes a multi-set.
  *
  * @param key_size   the size of each element in the multi-set; must be
  *                   positive
  * @param comparator the comparator function used for key ordering; must not be
- *                   NULL
+ *                   NULL; may be one of the built-in comparators from compare.h
  *
  * @return the newly-initialized multi-set, or NULL if it was not successfully
  *         initialized due to either invalid input arguments or memory
@@ -112,6 +160,25 @@ static void multiset_reference_parent(multiset me,
     }
 }
 
+/*
+ * Gets the weight of a subtree, which is the amount of elements in it.
+ */
+static int multiset_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void multiset_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
 /*
  * Rotates the AVL tree to the left.
  */
@@ -119,6 +186,7 @@ static void multiset_rotate_left(multiset me,
                                  struct node *const parent,
                                  struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     multiset_reference_parent(me, parent, child);
     grand_child = child->left;
@@ -128,6 +196,8 @@ static void multiset_rotate_left(multiset me,
     parent->parent = child;
     parent->right = grand_child;
     child->left = parent;
+    parent->weight += multiset_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -137,6 +207,7 @@ static void multiset_rotate_right(multiset me,
                                   struct node *const parent,
                                   struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     multiset_reference_parent(me, parent, child);
     grand_child = child->right;
@@ -146,6 +217,8 @@ static void multiset_rotate_right(multiset me,
     parent->parent = child;
     parent->left = grand_child;
     child->right = parent;
+    parent->weight += multiset_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -297,6 +370,7 @@ static struct node *multiset_create_node(multiset me,
     insert->count = 1;
     insert->parent = parent;
     insert->balance = 0;
+    insert->weight = 1;
     insert->key = malloc(me->key_size);
     if (!insert->key) {
         free(insert);
@@ -309,6 +383,16 @@ static struct node *multiset_create_node(multiset me,
     return insert;
 }
 
+/*
+ * Compares two keys.
+ */
+static int multiset_compare(multiset me,
+                            const void *const one,
+                            const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
 /**
  * Adds a key to the multi-set. The pointer to the key being passed in should
  * point to the key type which this multi-set holds. For example, if this
@@ -335,7 +419,7 @@ int multiset_put(multiset me, void *const key)
     }
     traverse = me->root;
     for (;;) {
-        const int compare = me->comparator(key, traverse->key);
+        const int compare = multiset_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -345,6 +429,7 @@ int multiset_put(multiset me, void *const key)
                     return -ENOMEM;
                 }
                 traverse->left = insert;
+                multiset_add_weight(traverse, 1);
                 multiset_insert_balance(me, insert);
                 return 0;
             }
@@ -357,11 +442,13 @@ int multiset_put(multiset me, void *const key)
                     return -ENOMEM;
                 }
                 traverse->right = insert;
+                multiset_add_weight(traverse, 1);
                 multiset_insert_balance(me, insert);
                 return 0;
             }
         } else {
             traverse->count++;
+            multiset_add_weight(traverse, 1);
             me->size++;
             return 0;
         }
@@ -378,7 +465,7 @@ static struct node *multiset_equal_match(multiset me, const void *const key)
         return 0;
     }
     for (;;) {
-        const int compare = me->comparator(key, traverse->key);
+        const int compare = multiset_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -435,6 +522,69 @@ int multiset_contains(multiset me, void *const key)
     return multiset_equal_match(me, key) != NULL;
 }
 
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of elements in its subtree. The pointer to the key
+ * being passed in should point to the key type which this multi-set holds.
+ *
+ * @param me  the multi-set to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of keys in the multi-set which are less than the key,
+ *         counting each occurrence separately
+ */
+int multiset_rank(multiset me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (multiset_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - multiset_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key at the specified index in sorted order, where each occurrence
+ * of a key has its own index, so that index zero is the smallest key. This
+ * takes logarithmic time, since each node keeps track of the amount of
+ * occurrences in its subtree.
+ *
+ * @param key   the key to copy to
+ * @param me    the multi-set to get the key from
+ * @param index the index of the key in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int multiset_select(void *const key, multiset me, const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = multiset_weight(item->left);
+        const int own = item->weight - left - multiset_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    memcpy(key, item->key, me->key_size);
+    return 0;
+}
+
 /*
  * Repairs the AVL tree by pivoting on an item.
  */
@@ -612,11 +762,39 @@ static void multiset_remove_two_children(multiset me,
     multiset_delete_balance(me, parent, is_left_deleted);
 }
 
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void multiset_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - multiset_weight(traverse->left)
+                    - multiset_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    multiset_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - multiset_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
 /*
  * Removes the element from the set.
  */
 static void multiset_remove_element(multiset me, struct node *const traverse)
 {
+    multiset_remove_weight(traverse);
     if (!traverse->left && !traverse->right) {
         multiset_remove_no_children(me, traverse);
     } else if (!traverse->left || !traverse->right) {
@@ -647,6 +825,7 @@ int multiset_remove(multiset me, void *const key)
         return 0;
     }
     traverse->count--;
+    multiset_add_weight(traverse, -1);
     if (traverse->count == 0) {
         multiset_remove_element(me, traverse);
     }
@@ -677,6 +856,573 @@ int multiset_remove_all(multiset me, void *const key)
     return 1;
 }
 
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *multiset_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was only partially built.
+ */
+static void multiset_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    multiset_free_subtree(item->left);
+    multiset_free_subtree(item->right);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Gets the node with the smallest key in the subtree.
+ */
+static struct node *multiset_first_node(struct node *item)
+{
+    if (item) {
+        while (item->left) {
+            item = item->left;
+        }
+    }
+    return item;
+}
+
+/*
+ * Builds a balanced subtree from the sorted entries. The middle entry is the
+ * root of the subtree, and the entries before and after it form the left and
+ * right subtrees.
+ */
+static int multiset_build_subtree(multiset me,
+                                  const struct merge_entry *const entries,
+                                  const int count,
+                                  struct node **const subtree,
+                                  int *const height)
+{
+    const int left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = multiset_build_subtree(me, entries, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    item = multiset_create_node(me, entries[left_count].key, NULL);
+    if (!item) {
+        multiset_free_subtree(left);
+        return -ENOMEM;
+    }
+    item->count = entries[left_count].count;
+    me->size += item->count - 1;
+    rc = multiset_build_subtree(me, entries + left_count + 1,
+                                count - 1 - left_count, &right, &right_height);
+    if (rc != 0) {
+        multiset_free_subtree(left);
+        multiset_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = item->count + multiset_weight(left) + multiset_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+/*
+ * The amount of occurrences of a key in the union of two multi-sets.
+ */
+static int multiset_union_count(const int one, const int two)
+{
+    return one > two ? one : two;
+}
+
+/*
+ * The amount of occurrences of a key in the intersection of two multi-sets.
+ */
+static int multiset_intersection_count(const int one, const int two)
+{
+    return one < two ? one : two;
+}
+
+/*
+ * The amount of occurrences of a key in the difference of two multi-sets.
+ */
+static int multiset_difference_count(const int one, const int two)
+{
+    return one - two;
+}
+
+/*
+ * Merges the keys of two multi-sets in sorted order into an empty multi-set.
+ * The merge function gets the amount of occurrences of a key in each of the
+ * multi-sets, which is zero if it is not in it, and returns the amount of
+ * occurrences in the result. The key is left out if it is not positive.
+ */
+static int multiset_combine(multiset me,
+                            multiset one,
+                            multiset two,
+                            int (*const merge)(const int, const int))
+{
+    struct node *first = multiset_first_node(one->root);
+    struct node *second = multiset_first_node(two->root);
+    struct merge_entry *entries;
+    int count = 0;
+    int height;
+    int rc;
+    if (me->root || me->key_size != one->key_size
+        || me->key_size != two->key_size) {
+        return -EINVAL;
+    }
+    if (one->size + two->size == 0) {
+        return 0;
+    }
+    entries = malloc((one->size + two->size) * sizeof(struct merge_entry));
+    if (!entries) {
+        return -ENOMEM;
+    }
+    while (first || second) {
+        int compare;
+        if (!first) {
+            compare = 1;
+        } else if (!second) {
+            compare = -1;
+        } else {
+            compare = multiset_compare(one, first->key, second->key);
+        }
+        if (compare < 0) {
+            entries[count].key = first->key;
+            entries[count].count = merge(first->count, 0);
+            first = multiset_next_node(first);
+        } else if (compare > 0) {
+            entries[count].key = second->key;
+            entries[count].count = merge(0, second->count);
+            second = multiset_next_node(second);
+        } else {
+            entries[count].key = first->key;
+            entries[count].count = merge(first->count, second->count);
+            first = multiset_next_node(first);
+            second = multiset_next_node(second);
+        }
+        if (entries[count].count > 0) {
+            count++;
+        }
+    }
+    rc = multiset_build_subtree(me, entries, count, &me->root, &height);
+    if (rc != 0) {
+        me->size = 0;
+    }
+    free(entries);
+    return rc;
+}
+
+/**
+ * Stores the union of two multi-sets in an empty multi-set, which is every key
+ * that is in either of the multi-sets, occurring as many times as it occurs in
+ * the multi-set which has more of it. Since both multi-sets are traversed in
+ * sorted order at the same time, and the balanced tree is built directly from
+ * the result, this takes linear time. The multi-sets must all have the same
+ * key size and comparator function. If an error occurs, the multi-set is left
+ * empty.
+ *
+ * @param me  the empty multi-set to store the union in
+ * @param one the first multi-set
+ * @param two the second multi-set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the key sizes do not match
+ */
+int multiset_union(multiset me, multiset one, multiset two)
+{
+    return multiset_combine(me, one, two, multiset_union_count);
+}
+
+/**
+ * Stores the intersection of two multi-sets in an empty multi-set, which is
+ * every key that is in both of the multi-sets, occurring as many times as it
+ * occurs in the multi-set which has less of it. This takes linear time. The
+ * multi-sets must all have the same key size and comparator function. If an
+ * error occurs, the multi-set is left empty.
+ *
+ * @param me  the empty multi-set to store the intersection in
+ * @param one the first multi-set
+ * @param two the second multi-set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the key sizes do not match
+ */
+int multiset_intersection(multiset me, multiset one, multiset two)
+{
+    return multiset_combine(me, one, two, multiset_intersection_count);
+}
+
+/**
+ * Stores the difference of two multi-sets in an empty multi-set, which is every
+ * key of the first multi-set, occurring as many times as it occurs in the first
+ * multi-set minus the times it occurs in the second multi-set. This takes
+ * linear time. The multi-sets must all have the same key size and comparator
+ * function. If an error occurs, the multi-set is left empty.
+ *
+ * @param me  the empty multi-set to store the difference in
+ * @param one the multi-set to take the keys from
+ * @param two the multi-set of keys to take away
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the key sizes do not match
+ */
+int multiset_difference(multiset me, multiset one, multiset two)
+{
+    return multiset_combine(me, one, two, multiset_difference_count);
+}
+
+/**
+ * Determines if every key of the multi-set occurs at least as many times in the
+ * other multi-set. This takes linear time, since both multi-sets are traversed
+ * in sorted order at the same time. The multi-sets must have the same
+ * comparator function.
+ *
+ * @param me    the multi-set which may be a subset
+ * @param other the multi-set which may contain it
+ *
+ * @return 1 if the multi-set is a subset of the other multi-set, otherwise 0
+ */
+int multiset_is_subset(multiset me, multiset other)
+{
+    struct node *first = multiset_first_node(me->root);
+    struct node *second = multiset_first_node(other->root);
+    if (me->size > other->size) {
+        return 0;
+    }
+    while (first) {
+        int compare;
+        if (!second) {
+            return 0;
+        }
+        compare = multiset_compare(me, first->key, second->key);
+        if (compare < 0) {
+            return 0;
+        }
+        if (compare == 0) {
+            if (first->count > second->count) {
+                return 0;
+            }
+            first = multiset_next_node(first);
+        }
+        second = multiset_next_node(second);
+    }
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void multiset_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void multiset_stream_write(struct snapshot_stream *const stream,
+                                  const void *const data,
+                                  const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            multiset_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void multiset_stream_read(struct snapshot_stream *const stream,
+                                 void *const data,
+                                 const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int multiset_load_subtree(multiset me,
+                                 struct snapshot_stream *const stream,
+                                 const unsigned long count,
+                                 struct node **const subtree,
+                                 int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    unsigned long key_count;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = multiset_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    multiset_stream_read(stream, &key_count, sizeof(unsigned long));
+    multiset_stream_read(stream, stream->record, me->key_size);
+    if (stream->rc != 0) {
+        multiset_free_subtree(left);
+        return stream->rc;
+    }
+    if (key_count == 0 || key_count > (unsigned long) (INT_MAX - me->size)) {
+        multiset_free_subtree(left);
+        return -EINVAL;
+    }
+    item = multiset_create_node(me, stream->record, NULL);
+    if (!item) {
+        multiset_free_subtree(left);
+        return -ENOMEM;
+    }
+    item->count = (int) key_count;
+    me->size += item->count - 1;
+    rc = multiset_load_subtree(me, stream, count - 1 - left_count, &right,
+                               &right_height);
+    if (rc != 0) {
+        multiset_free_subtree(left);
+        multiset_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = item->count + multiset_weight(left) + multiset_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the multi-set to a file descriptor. The snapshot
+ * consists of a header, which holds the key size and the amount of distinct
+ * keys, followed by the count and the key of each distinct key in sorted order.
+ * Since the keys are copied byte for byte, they should not contain pointers
+ * unless the snapshot is loaded by the same process.
+ *
+ * @param me the multi-set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int multiset_save(multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *first = me->root;
+    struct node *traverse;
+    unsigned long node_count = 0;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    if (first) {
+        while (first->left) {
+            first = first->left;
+        }
+    }
+    for (traverse = first; traverse; traverse = multiset_next_node(traverse)) {
+        node_count++;
+    }
+    header.count = node_count;
+    multiset_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    traverse = first;
+    while (stream.rc == 0 && traverse) {
+        const unsigned long key_count = (unsigned long) traverse->count;
+        multiset_stream_write(&stream, &key_count, sizeof(unsigned long));
+        multiset_stream_write(&stream, traverse->key, me->key_size);
+        traverse = multiset_next_node(traverse);
+    }
+    multiset_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by multiset_save into an empty
+ * multi-set. Since the snapshot is sorted, the balanced tree is built directly
+ * from it in linear time without calling the comparator function. Thus, the
+ * multi-set must have been initialized with the same key size and comparator
+ * function as the multi-set which was saved. If an error occurs, the multi-set
+ * is left empty. When the file descriptor is seekable, it is left positioned
+ * right after the snapshot.
+ *
+ * @param me the multi-set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the multi-set is not empty or the snapshot does not
+ *                 match the multi-set
+ * @return -EIO    if the snapshot could not be read
+ */
+int multiset_load(multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE + me->key_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    multiset_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != 0
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = multiset_load_subtree(me, &stream, header.count, &me->root,
+                                   &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
 /**
  * Clears the keys from the multiset.
  *
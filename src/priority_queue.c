@@ -24,6 +24,8 @@
 #include <errno.h>
 #include "include/vector.h"
 #include "include/priority_queue.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
 
 struct internal_priority_queue {
     vector data;
@@ -64,6 +66,16 @@ priority_queue priority_queue_init(const size_t data_size,
     return init;
 }
 
+/*
+ * Compares the priority of two elements.
+ */
+static int priority_queue_compare(priority_queue me,
+                                  const void *const one,
+                                  const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->data_size, one, two);
+}
+
 /**
  * Gets the size of the priority queue.
  *
@@ -123,7 +135,8 @@ int priority_queue_push(priority_queue me, void *const data)
     parent_index = (index - 1) / 2;
     data_index = (char *) vector_storage + index * me->data_size;
     data_parent_index = (char *) vector_storage + parent_index * me->data_size;
-    while (index > 0 && me->comparator(data_index, data_parent_index) > 0) {
+    while (index > 0
+           && priority_queue_compare(me, data_index, data_parent_index) > 0) {
         memcpy(temp, data_parent_index, me->data_size);
         memcpy(data_parent_index, data_index, me->data_size);
         memcpy(data_index, temp, me->data_size);
@@ -176,15 +189,16 @@ int priority_queue_pop(void *const data, priority_queue me)
     data_right_index = (char *) vector_storage + right_index * me->data_size;
     for (;;) {
         if (right_index < size &&
-            me->comparator(data_right_index, data_left_index) > 0 &&
-            me->comparator(data_right_index, data_index) > 0) {
+            priority_queue_compare(me, data_right_index, data_left_index) > 0 &&
+            priority_queue_compare(me, data_right_index, data_index) > 0) {
             /* Swap parent and right child then continue down right child. */
             memcpy(temp, data_index, me->data_size);
             memcpy(data_index, data_right_index, me->data_size);
             memcpy(data_right_index, temp, me->data_size);
             index = right_index;
-        } else if (left_index < size &&
-                   me->comparator(data_left_index, data_index) > 0) {
+        } else if (left_index < size
+                   && priority_queue_compare(me, data_left_index,
+                                             data_index) > 0) {
             /* Swap parent and left child then continue down left child. */
             memcpy(temp, data_index, me->data_size);
             memcpy(data_index, data_left_index, me->data_size);
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "include/search.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__GNUC__)
+#define CONTAINERS_HAS_PREFETCH
+#endif
+
+static const size_t CACHE_LINE_SIZE = 64;
+
+/*
+ * Compares two elements.
+ */
+static int containers_search_compare(int (*const comparator)(const void *,
+                                                             const void *),
+                                     const size_t size,
+                                     const void *const one,
+                                     const void *const two)
+{
+    return CONTAINERS_COMPARE(comparator, size, one, two);
+}
+
+/**
+ * Gets the index of the first element which is not less than the key in
+ * elements which are sorted in ascending order, which is the count if there is
+ * no such element. The search range is halved on every step whatever the
+ * outcome of the comparison, so the loop has no data-dependent branch, and the
+ * compiler can select the next base with a conditional move. This avoids the
+ * branch mispredictions of a classic binary search, and both of the elements
+ * which the next step may compare are prefetched, so that the memory latency of
+ * large searches overlaps with the current comparison.
+ *
+ * @param data       the sorted elements to search
+ * @param count      the amount of elements
+ * @param size       the size of each element
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the first element which is not less than the key
+ */
+int containers_lower_bound(void *const data,
+                           const int count,
+                           const size_t size,
+                           void *const key,
+                           int (*const comparator)(const void *const one,
+                                                   const void *const two))
+{
+    const char *const items = data;
+    int remaining = count;
+    int base = 0;
+    if (count <= 0) {
+        return 0;
+    }
+    while (remaining > 1) {
+        const int half = remaining / 2;
+        const char *const item = items + (base + half - 1) * size;
+#ifdef CONTAINERS_HAS_PREFETCH
+        __builtin_prefetch(items + (base + half / 2) * size);
+        __builtin_prefetch(items + (base + half + half / 2) * size);
+#endif
+        base = containers_search_compare(comparator, size, item, key) < 0
+               ? base + half : base;
+        remaining -= half;
+    }
+    return base + (containers_search_compare(comparator, size,
+                                             items + base * size, key) < 0);
+}
+
+/*
+ * Copies the sorted elements into their Eytzinger positions by an in-order
+ * walk of the implicit tree, in which the children of the element at index k
+ * are at 2k + 1 and 2k + 2.
+ */
+static void containers_eytzinger_fill(char *const out,
+                                      const char *const in,
+                                      const size_t size,
+                                      const unsigned long count,
+                                      const unsigned long k,
+                                      unsigned long *const index)
+{
+    if (k >= count) {
+        return;
+    }
+    containers_eytzinger_fill(out, in, size, count, 2 * k + 1, index);
+    memcpy(out + k * size, in + *index * size, size);
+    *index += 1;
+    containers_eytzinger_fill(out, in, size, count, 2 * k + 2, index);
+}
+
+/**
+ * Rearranges elements which are sorted in ascending order into Eytzinger order,
+ * which is the breadth-first order of a complete binary search tree stored
+ * implicitly, where the children of the element at index k are at 2k + 1 and
+ * 2k + 2. The first levels of the tree are then packed together at the start,
+ * so they stay in the cache, and the descendants which a search visits a few
+ * steps later are adjacent, so they can be prefetched. The elements are no
+ * longer sorted afterwards, and must be searched with
+ * containers_eytzinger_lower_bound.
+ *
+ * @param data  the sorted elements to rearrange
+ * @param count the amount of elements
+ * @param size  the size of each element
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the count is negative
+ */
+int containers_eytzinger_layout(void *const data,
+                                const int count,
+                                const size_t size)
+{
+    unsigned long index = 0;
+    char *sorted;
+    if (count < 0) {
+        return -EINVAL;
+    }
+    if (count <= 1) {
+        return 0;
+    }
+    sorted = malloc(count * size);
+    if (!sorted) {
+        return -ENOMEM;
+    }
+    memcpy(sorted, data, count * size);
+    containers_eytzinger_fill(data, sorted, size, count, 0, &index);
+    free(sorted);
+    return 0;
+}
+
+/**
+ * Gets the index of the smallest element which is not less than the key in
+ * elements which are in Eytzinger order, which is the count if there is no such
+ * element. Each step goes to the left or right child without a data-dependent
+ * branch. The descendants a few levels down are adjacent, so while the current
+ * element is being compared, the cache line holding them is prefetched. The
+ * memory latency of the search is thus overlapped, which makes it much faster
+ * than binary search on tables far larger than the cache.
+ *
+ * @param data       the elements in Eytzinger order to search
+ * @param count      the amount of elements
+ * @param size       the size of each element
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the smallest element which is not less than the key
+ */
+int containers_eytzinger_lower_bound(void *const data,
+                                     const int count,
+                                     const size_t size,
+                                     void *const key,
+                                     int (*const comparator)
+                                         (const void *const one,
+                                          const void *const two))
+{
+    const char *const items = data;
+    unsigned long ahead = 2;
+    unsigned long k = 0;
+    if (count <= 0) {
+        return 0;
+    }
+    while (ahead * 2 * size <= CACHE_LINE_SIZE && ahead < 16) {
+        ahead *= 2;
+    }
+    while (k < (unsigned long) count) {
+#ifdef CONTAINERS_HAS_PREFETCH
+        if (k < count / ahead) {
+            const char *const first = items + (ahead * (k + 1) - 1) * size;
+            __builtin_prefetch(first);
+            __builtin_prefetch(first + (ahead - 1) * size);
+        }
+#endif
+        k = 2 * k + 1
+            + (containers_search_compare(comparator, size, items + k * size,
+                                         key) < 0);
+    }
+    /* The path ends with right turns after the last left turn to the answer. */
+    k++;
+    while (k & 1) {
+        k >>= 1;
+    }
+    k >>= 1;
+    if (k == 0) {
+        return count;
+    }
+    return (int) (k - 1);
+}
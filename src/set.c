@@ -22,7 +22,20 @@
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/set.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+static const char SNAPSHOT_MAGIC[8] = "CNTRTREE";
+static const unsigned long SNAPSHOT_VERSION = 1;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
 
 struct internal_set {
     size_t key_size;
@@ -34,17 +47,44 @@ struct internal_set {
 struct node {
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     struct node *left;
     struct node *right;
 };
 
+/*
+ * The header at the start of a snapshot. The records follow the header in
+ * sorted order, each of which is a key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
 /**
  * Initializes a set.
  *
  * @param key_size   the size of each element in the set; must be positive
  * @param comparator the comparator function used for key ordering; must not be
- *                   NULL
+ *                   NULL; may be one of the built-in comparators from compare.h
  *
  * @return the newly-initialized set, or NULL if it was not successfully
  *         initialized due to either invalid input arguments or memory
@@ -109,6 +149,25 @@ static void set_reference_parent(set me,
     }
 }
 
+/*
+ * Gets the weight of a subtree, which is the amount of keys in it.
+ */
+static int set_weight(const struct node *const item)
+{
+    return item ? item->weight : 0;
+}
+
+/*
+ * Adds to the weight of the item and of all its ancestors.
+ */
+static void set_add_weight(struct node *item, const int amount)
+{
+    while (item) {
+        item->weight += amount;
+        item = item->parent;
+    }
+}
+
 /*
  * Rotates the AVL tree to the left.
  */
@@ -116,6 +175,7 @@ static void set_rotate_left(set me,
                             struct node *const parent,
                             struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     set_reference_parent(me, parent, child);
     grand_child = child->left;
@@ -125,6 +185,8 @@ static void set_rotate_left(set me,
     parent->parent = child;
     parent->right = grand_child;
     child->left = parent;
+    parent->weight += set_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -134,6 +196,7 @@ static void set_rotate_right(set me,
                              struct node *const parent,
                              struct node *const child)
 {
+    const int weight = parent->weight;
     struct node *grand_child;
     set_reference_parent(me, parent, child);
     grand_child = child->right;
@@ -143,6 +206,8 @@ static void set_rotate_right(set me,
     parent->parent = child;
     parent->left = grand_child;
     child->right = parent;
+    parent->weight += set_weight(grand_child) - child->weight;
+    child->weight = weight;
 }
 
 /*
@@ -293,6 +358,7 @@ static struct node *set_create_node(set me,
     }
     insert->parent = parent;
     insert->balance = 0;
+    insert->weight = 1;
     insert->key = malloc(me->key_size);
     if (!insert->key) {
         free(insert);
@@ -305,6 +371,14 @@ static struct node *set_create_node(set me,
     return insert;
 }
 
+/*
+ * Compares two keys.
+ */
+static int set_compare(set me, const void *const one, const void *const two)
+{
+    return CONTAINERS_COMPARE(me->comparator, me->key_size, one, two);
+}
+
 /**
  * Adds a key to the set if the set does not already contain it. The pointer to
  * the key being passed in should point to the key type which this set holds.
@@ -331,7 +405,7 @@ int set_put(set me, void *const key)
     }
     traverse = me->root;
     for (;;) {
-        const int compare = me->comparator(key, traverse->key);
+        const int compare = set_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -341,6 +415,7 @@ int set_put(set me, void *const key)
                     return -ENOMEM;
                 }
                 traverse->left = insert;
+                set_add_weight(traverse, 1);
                 set_insert_balance(me, insert);
                 return 0;
             }
@@ -353,6 +428,7 @@ int set_put(set me, void *const key)
                     return -ENOMEM;
                 }
                 traverse->right = insert;
+                set_add_weight(traverse, 1);
                 set_insert_balance(me, insert);
                 return 0;
             }
@@ -372,7 +448,7 @@ static struct node *set_equal_match(set me, const void *const key)
         return NULL;
     }
     for (;;) {
-        const int compare = me->comparator(key, traverse->key);
+        const int compare = set_compare(me, key, traverse->key);
         if (compare < 0) {
             if (traverse->left) {
                 traverse = traverse->left;
@@ -408,6 +484,67 @@ int set_contains(set me, void *const key)
     return set_equal_match(me, key) != NULL;
 }
 
+/**
+ * Determines the rank of the key, which is the index that the key has or would
+ * have in sorted order. This takes logarithmic time, since each node keeps
+ * track of the amount of keys in its subtree. The pointer to the key
+ * being passed in should point to the key type which this set holds.
+ *
+ * @param me  the set to check
+ * @param key the key to find the rank of
+ *
+ * @return the amount of keys in the set which are less than the key
+ */
+int set_rank(set me, void *const key)
+{
+    const struct node *traverse = me->root;
+    int rank = 0;
+    while (traverse) {
+        if (set_compare(me, key, traverse->key) <= 0) {
+            traverse = traverse->left;
+        } else {
+            rank += traverse->weight - set_weight(traverse->right);
+            traverse = traverse->right;
+        }
+    }
+    return rank;
+}
+
+/**
+ * Copies the key at the specified index in sorted order, so that index zero is
+ * the smallest key. This takes logarithmic time, since each node keeps track
+ * of the amount of keys in its subtree.
+ *
+ * @param key   the key to copy to
+ * @param me    the set to get the key from
+ * @param index the index of the key in sorted order
+ *
+ * @return 0       if no error
+ * @return -EINVAL if invalid argument
+ */
+int set_select(void *const key, set me, const int index)
+{
+    const struct node *item = me->root;
+    int offset = index;
+    if (index < 0 || index >= me->size) {
+        return -EINVAL;
+    }
+    for (;;) {
+        const int left = set_weight(item->left);
+        const int own = item->weight - left - set_weight(item->right);
+        if (offset < left) {
+            item = item->left;
+        } else if (offset < left + own) {
+            break;
+        } else {
+            offset -= left + own;
+            item = item->right;
+        }
+    }
+    memcpy(key, item->key, me->key_size);
+    return 0;
+}
+
 /*
  * Repairs the AVL tree by pivoting on an item.
  */
@@ -582,11 +719,39 @@ static void set_remove_two_children(set me, const struct node *const traverse)
     set_delete_balance(me, parent, is_left_deleted);
 }
 
+/*
+ * Takes the weight of the item out of its ancestors before it is unlinked. If
+ * the item has two children, its successor takes its place, so the weight of
+ * the successor moves along with it.
+ */
+static void set_remove_weight(struct node *const traverse)
+{
+    const int own = traverse->weight - set_weight(traverse->left)
+                    - set_weight(traverse->right);
+    struct node *item;
+    struct node *parent;
+    int moved;
+    set_add_weight(traverse->parent, -own);
+    if (!traverse->left || !traverse->right) {
+        return;
+    }
+    item = traverse->right;
+    while (item->left) {
+        item = item->left;
+    }
+    moved = item->weight - set_weight(item->right);
+    for (parent = item->parent; parent != traverse; parent = parent->parent) {
+        parent->weight -= moved;
+    }
+    item->weight = traverse->weight - own;
+}
+
 /*
  * Removes the element from the set.
  */
 static void set_remove_element(set me, struct node *const traverse)
 {
+    set_remove_weight(traverse);
     if (!traverse->left && !traverse->right) {
         set_remove_no_children(me, traverse);
     } else if (!traverse->left || !traverse->right) {
@@ -621,6 +786,522 @@ int set_remove(set me, void *const key)
     return 1;
 }
 
+/*
+ * Gets the node which follows the specified node in key order.
+ */
+static struct node *set_next_node(struct node *item)
+{
+    struct node *parent;
+    if (item->right) {
+        item = item->right;
+        while (item->left) {
+            item = item->left;
+        }
+        return item;
+    }
+    parent = item->parent;
+    while (parent && parent->right == item) {
+        item = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/*
+ * Frees a subtree which was only partially built.
+ */
+static void set_free_subtree(struct node *const item)
+{
+    if (!item) {
+        return;
+    }
+    set_free_subtree(item->left);
+    set_free_subtree(item->right);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Gets the node with the smallest key in the subtree.
+ */
+static struct node *set_first_node(struct node *item)
+{
+    if (item) {
+        while (item->left) {
+            item = item->left;
+        }
+    }
+    return item;
+}
+
+/*
+ * Builds a balanced subtree from the sorted keys. The middle key is the root
+ * of the subtree, and the keys before and after it form the left and right
+ * subtrees.
+ */
+static int set_build_subtree(set me,
+                             const void *const *const keys,
+                             const int count,
+                             struct node **const subtree,
+                             int *const height)
+{
+    const int left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = set_build_subtree(me, keys, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    item = set_create_node(me, keys[left_count], NULL);
+    if (!item) {
+        set_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = set_build_subtree(me, keys + left_count + 1, count - 1 - left_count,
+                           &right, &right_height);
+    if (rc != 0) {
+        set_free_subtree(left);
+        set_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + set_weight(left) + set_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+/*
+ * Merges the keys of two sets in sorted order into an empty set. The flags
+ * specify whether the keys which are only in the first set, in both sets, or
+ * only in the second set are kept.
+ */
+static int set_combine(set me,
+                       set one,
+                       set two,
+                       const int keep_one,
+                       const int keep_both,
+                       const int keep_two)
+{
+    struct node *first = set_first_node(one->root);
+    struct node *second = set_first_node(two->root);
+    const void **keys;
+    int count = 0;
+    int height;
+    int rc;
+    if (me->root || me->key_size != one->key_size
+        || me->key_size != two->key_size) {
+        return -EINVAL;
+    }
+    if (one->size + two->size == 0) {
+        return 0;
+    }
+    keys = malloc((one->size + two->size) * sizeof(const void *));
+    if (!keys) {
+        return -ENOMEM;
+    }
+    while (first || second) {
+        int compare;
+        if (!first) {
+            compare = 1;
+        } else if (!second) {
+            compare = -1;
+        } else {
+            compare = set_compare(one, first->key, second->key);
+        }
+        if (compare < 0) {
+            if (keep_one) {
+                keys[count++] = first->key;
+            }
+            first = set_next_node(first);
+        } else if (compare > 0) {
+            if (keep_two) {
+                keys[count++] = second->key;
+            }
+            second = set_next_node(second);
+        } else {
+            if (keep_both) {
+                keys[count++] = first->key;
+            }
+            first = set_next_node(first);
+            second = set_next_node(second);
+        }
+    }
+    rc = set_build_subtree(me, keys, count, &me->root, &height);
+    if (rc != 0) {
+        me->size = 0;
+    }
+    free(keys);
+    return rc;
+}
+
+/**
+ * Stores the union of two sets in an empty set, which is every key that is in
+ * either of the sets. Since both sets are traversed in sorted order at the
+ * same time, and the balanced tree is built directly from the result, this
+ * takes linear time. The sets must all have the same key size and comparator
+ * function. If an error occurs, the set is left empty.
+ *
+ * @param me  the empty set to store the union in
+ * @param one the first set
+ * @param two the second set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the key sizes do not match
+ */
+int set_union(set me, set one, set two)
+{
+    return set_combine(me, one, two, 1, 1, 1);
+}
+
+/**
+ * Stores the intersection of two sets in an empty set, which is every key that
+ * is in both of the sets. This takes linear time. The sets must all have the
+ * same key size and comparator function. If an error occurs, the set is left
+ * empty.
+ *
+ * @param me  the empty set to store the intersection in
+ * @param one the first set
+ * @param two the second set
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the key sizes do not match
+ */
+int set_intersection(set me, set one, set two)
+{
+    return set_combine(me, one, two, 0, 1, 0);
+}
+
+/**
+ * Stores the difference of two sets in an empty set, which is every key that
+ * is in the first set but not in the second set. This takes linear time. The
+ * sets must all have the same key size and comparator function. If an error
+ * occurs, the set is left empty.
+ *
+ * @param me  the empty set to store the difference in
+ * @param one the set to take the keys from
+ * @param two the set of keys to leave out
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the key sizes do not match
+ */
+int set_difference(set me, set one, set two)
+{
+    return set_combine(me, one, two, 1, 0, 0);
+}
+
+/**
+ * Determines if every key of the set is also in the other set. This takes
+ * linear time, since both sets are traversed in sorted order at the same time.
+ * The sets must have the same comparator function.
+ *
+ * @param me    the set which may be a subset
+ * @param other the set which may contain it
+ *
+ * @return 1 if the set is a subset of the other set, otherwise 0
+ */
+int set_is_subset(set me, set other)
+{
+    struct node *first = set_first_node(me->root);
+    struct node *second = set_first_node(other->root);
+    if (me->size > other->size) {
+        return 0;
+    }
+    while (first) {
+        int compare;
+        if (!second) {
+            return 0;
+        }
+        compare = set_compare(me, first->key, second->key);
+        if (compare < 0) {
+            return 0;
+        }
+        if (compare == 0) {
+            first = set_next_node(first);
+        }
+        second = set_next_node(second);
+    }
+    return 1;
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void set_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void set_stream_write(struct snapshot_stream *const stream,
+                             const void *const data,
+                             const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            set_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void set_stream_read(struct snapshot_stream *const stream,
+                            void *const data,
+                            const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Builds a balanced subtree from the next count records of the snapshot. Since
+ * the records are sorted, the middle record is the root of the subtree, and the
+ * records before and after it form the left and right subtrees.
+ */
+static int set_load_subtree(set me,
+                            struct snapshot_stream *const stream,
+                            const unsigned long count,
+                            struct node **const subtree,
+                            int *const height)
+{
+    const unsigned long left_count = (count - 1) / 2;
+    struct node *left;
+    struct node *right;
+    struct node *item;
+    int left_height;
+    int right_height;
+    int rc;
+    *subtree = NULL;
+    *height = 0;
+    if (count == 0) {
+        return 0;
+    }
+    rc = set_load_subtree(me, stream, left_count, &left, &left_height);
+    if (rc != 0) {
+        return rc;
+    }
+    set_stream_read(stream, stream->record, me->key_size);
+    if (stream->rc != 0) {
+        set_free_subtree(left);
+        return stream->rc;
+    }
+    item = set_create_node(me, stream->record, NULL);
+    if (!item) {
+        set_free_subtree(left);
+        return -ENOMEM;
+    }
+    rc = set_load_subtree(me, stream, count - 1 - left_count, &right,
+                          &right_height);
+    if (rc != 0) {
+        set_free_subtree(left);
+        set_free_subtree(item);
+        return rc;
+    }
+    item->left = left;
+    item->right = right;
+    if (left) {
+        left->parent = item;
+    }
+    if (right) {
+        right->parent = item;
+    }
+    item->balance = right_height - left_height;
+    item->weight = 1 + set_weight(left) + set_weight(right);
+    *subtree = item;
+    *height = (right_height > left_height ? right_height : left_height) + 1;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the set to a file descriptor. The snapshot
+ * consists of a header, which holds the key size and the amount of keys,
+ * followed by the keys in sorted order. Since the keys are copied byte for
+ * byte, they should not contain pointers unless the snapshot is loaded by the
+ * same process.
+ *
+ * @param me the set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int set_save(set me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    struct node *traverse = me->root;
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    header.count = (unsigned long) me->size;
+    set_stream_write(&stream, &header, sizeof(struct snapshot_header));
+    if (traverse) {
+        while (traverse->left) {
+            traverse = traverse->left;
+        }
+    }
+    while (stream.rc == 0 && traverse) {
+        set_stream_write(&stream, traverse->key, me->key_size);
+        traverse = set_next_node(traverse);
+    }
+    set_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by set_save into an empty set.
+ * Since the snapshot is sorted, the balanced tree is built directly from it in
+ * linear time without calling the comparator function. Thus, the set must have
+ * been initialized with the same key size and comparator function as the set
+ * which was saved. If an error occurs, the set is left empty. When the file
+ * descriptor is seekable, it is left positioned right after the snapshot.
+ *
+ * @param me the set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the set is not empty or the snapshot does not match the
+ *                 set
+ * @return -EIO    if the snapshot could not be read
+ */
+int set_load(set me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int height;
+    int rc;
+    if (me->root) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE + me->key_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    set_stream_read(&stream, &header, sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != 0
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = set_load_subtree(me, &stream, header.count, &me->root, &height);
+    }
+    if (rc != 0) {
+        me->size = 0;
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
 /**
  * Clears the keys from the set.
  *
@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2017-2019 Bailey Thompson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <limits.h>
+#include "include/sort.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+static const int INSERTION_SORT_SIZE = 16;
+static const int RADIX_SORT_SIZE = 256;
+
+/*
+ * Compares two elements.
+ */
+static int containers_sort_compare(int (*const comparator)(const void *,
+                                                           const void *),
+                                   const size_t size,
+                                   const void *const one,
+                                   const void *const two)
+{
+    return CONTAINERS_COMPARE(comparator, size, one, two);
+}
+
+/*
+ * Swaps two elements. Elements which are the size of a scalar are swapped as a
+ * single scalar, and larger elements a scalar at a time.
+ */
+static void containers_sort_swap(char *const one,
+                                 char *const two,
+                                 const size_t size)
+{
+    size_t i = 0;
+    if (size == sizeof(unsigned int)) {
+        unsigned int temp;
+        memcpy(&temp, one, sizeof(unsigned int));
+        memcpy(one, two, sizeof(unsigned int));
+        memcpy(two, &temp, sizeof(unsigned int));
+        return;
+    }
+    for (; i + sizeof(unsigned long) <= size; i += sizeof(unsigned long)) {
+        unsigned long temp;
+        memcpy(&temp, one + i, sizeof(unsigned long));
+        memcpy(one + i, two + i, sizeof(unsigned long));
+        memcpy(two + i, &temp, sizeof(unsigned long));
+    }
+    for (; i < size; i++) {
+        const char temp = one[i];
+        one[i] = two[i];
+        two[i] = temp;
+    }
+}
+
+/*
+ * Sorts a few elements by inserting each of them into the sorted elements
+ * before it.
+ */
+static void containers_sort_insertion(char *const data,
+                                      const int count,
+                                      const size_t size,
+                                      int (*comparator)(const void *const,
+                                                        const void *const))
+{
+    int i;
+    for (i = 1; i < count; i++) {
+        char *item = data + i * size;
+        while (item > data
+               && containers_sort_compare(comparator, size, item - size,
+                                          item) > 0) {
+            containers_sort_swap(item - size, item, size);
+            item -= size;
+        }
+    }
+}
+
+/*
+ * Moves the element at the root down the heap until both of its children are
+ * not larger than it.
+ */
+static void containers_sort_sift_down(char *const data,
+                                      int root,
+                                      const int count,
+                                      const size_t size,
+                                      int (*comparator)(const void *const,
+                                                        const void *const))
+{
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= count) {
+            return;
+        }
+        if (child + 1 < count
+            && containers_sort_compare(comparator, size, data + child * size,
+                                       data + (child + 1) * size) < 0) {
+            child++;
+        }
+        if (containers_sort_compare(comparator, size, data + root * size,
+                                    data + child * size) >= 0) {
+            return;
+        }
+        containers_sort_swap(data + root * size, data + child * size, size);
+        root = child;
+    }
+}
+
+/*
+ * Sorts the elements with a heap sort, which is used when the quick sort keeps
+ * picking bad pivots, so that the sort never takes more than O(n log n) time.
+ */
+static void containers_sort_heap(char *const data,
+                                 int count,
+                                 const size_t size,
+                                 int (*comparator)(const void *const,
+                                                   const void *const))
+{
+    int i;
+    for (i = count / 2 - 1; i >= 0; i--) {
+        containers_sort_sift_down(data, i, count, size, comparator);
+    }
+    while (count > 1) {
+        count--;
+        containers_sort_swap(data, data + count * size, size);
+        containers_sort_sift_down(data, 0, count, size, comparator);
+    }
+}
+
+/*
+ * Moves the median of the first, middle, and last elements to the front, where
+ * it is used as the pivot.
+ */
+static void containers_sort_median(char *const data,
+                                   const int count,
+                                   const size_t size,
+                                   int (*comparator)(const void *const,
+                                                     const void *const))
+{
+    char *const first = data;
+    char *const middle = data + (count / 2) * size;
+    char *const last = data + (count - 1) * size;
+    char *median = middle;
+    if (containers_sort_compare(comparator, size, first, middle) < 0) {
+        if (containers_sort_compare(comparator, size, middle, last) > 0) {
+            median = containers_sort_compare(comparator, size, first, last) < 0
+                     ? last : first;
+        }
+    } else if (containers_sort_compare(comparator, size, first, last) < 0) {
+        median = first;
+    } else if (containers_sort_compare(comparator, size, middle, last) < 0) {
+        median = last;
+    }
+    if (median != first) {
+        containers_sort_swap(first, median, size);
+    }
+}
+
+/*
+ * Sorts the elements with a quick sort, which falls back to a heap sort once
+ * the depth runs out, and to an insertion sort for a few elements. Only the
+ * smaller side of each partition is sorted recursively, so that the recursion
+ * is at most logarithmic in depth.
+ */
+static void containers_sort_intro(char *data,
+                                  int count,
+                                  const size_t size,
+                                  int (*comparator)(const void *const,
+                                                    const void *const),
+                                  int depth)
+{
+    while (count > INSERTION_SORT_SIZE) {
+        int i = 1;
+        int j = count - 1;
+        if (depth == 0) {
+            containers_sort_heap(data, count, size, comparator);
+            return;
+        }
+        depth--;
+        containers_sort_median(data, count, size, comparator);
+        for (;;) {
+            while (i <= j
+                   && containers_sort_compare(comparator, size, data + i * size,
+                                              data) < 0) {
+                i++;
+            }
+            while (i <= j
+                   && containers_sort_compare(comparator, size, data + j * size,
+                                              data) > 0) {
+                j--;
+            }
+            if (i >= j) {
+                break;
+            }
+            containers_sort_swap(data + i * size, data + j * size, size);
+            i++;
+            j--;
+        }
+        containers_sort_swap(data, data + j * size, size);
+        if (j < count - 1 - j) {
+            containers_sort_intro(data, j, size, comparator, depth);
+            data += (j + 1) * size;
+            count -= j + 1;
+        } else {
+            containers_sort_intro(data + (j + 1) * size, count - 1 - j, size,
+                                  comparator, depth);
+            count = j;
+        }
+    }
+    containers_sort_insertion(data, count, size, comparator);
+}
+
+/*
+ * Determines whether the elements are already sorted, or are sorted in reverse
+ * without any equal elements, in which case they are reversed. This makes the
+ * common cases of sorting sorted data take linear time.
+ */
+static int containers_sort_presorted(char *const data,
+                                     const int count,
+                                     const size_t size,
+                                     int (*comparator)(const void *const,
+                                                       const void *const))
+{
+    char *const end = data + count * size;
+    char *item = data + size;
+    int i;
+    while (item < end
+           && containers_sort_compare(comparator, size, item - size,
+                                      item) <= 0) {
+        item += size;
+    }
+    if (item == end) {
+        return 1;
+    }
+    if (item > data + size) {
+        return 0;
+    }
+    while (item < end
+           && containers_sort_compare(comparator, size, item - size,
+                                      item) > 0) {
+        item += size;
+    }
+    if (item < end) {
+        return 0;
+    }
+    for (i = 0; i < count / 2; i++) {
+        containers_sort_swap(data + i * size, data + (count - 1 - i) * size,
+                             size);
+    }
+    return 1;
+}
+
+/*
+ * Converts the elements to unsigned keys which are in the same order as the
+ * elements, or back again if decode is set. Signed integers have their sign
+ * bit flipped, and floating point numbers have either their sign bit or all of
+ * their bits flipped, depending on the sign. Returns zero if the comparator is
+ * not a built-in scalar comparator of the element size.
+ */
+static int containers_sort_convert(unsigned long *const keys,
+                                   char *const data,
+                                   const int count,
+                                   const size_t size,
+                                   int (*comparator)(const void *const,
+                                                     const void *const),
+                                   const int decode)
+{
+    const unsigned int uint_sign = UINT_MAX ^ (UINT_MAX >> 1);
+    const unsigned long ulong_sign = ULONG_MAX ^ (ULONG_MAX >> 1);
+    unsigned long flip = 0;
+    int is_float = 0;
+    int i;
+    if ((comparator == containers_compare_int && size == sizeof(int))
+        || (comparator == containers_compare_uint
+            && size == sizeof(unsigned int))) {
+        if (comparator == containers_compare_int) {
+            flip = uint_sign;
+        }
+        for (i = 0; i < count; i++) {
+            unsigned int value;
+            if (decode) {
+                value = (unsigned int) (keys[i] ^ flip);
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&value, data + i * size, size);
+                keys[i] = value ^ flip;
+            }
+        }
+        return 1;
+    }
+    if ((comparator == containers_compare_long && size == sizeof(long))
+        || (comparator == containers_compare_ulong
+            && size == sizeof(unsigned long))) {
+        if (comparator == containers_compare_long) {
+            flip = ulong_sign;
+        }
+        for (i = 0; i < count; i++) {
+            if (decode) {
+                const unsigned long value = keys[i] ^ flip;
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&keys[i], data + i * size, size);
+                keys[i] ^= flip;
+            }
+        }
+        return 1;
+    }
+    if (comparator == containers_compare_float && size == sizeof(float)
+        && sizeof(float) == sizeof(unsigned int)) {
+        for (i = 0; i < count; i++) {
+            unsigned int value;
+            if (decode) {
+                value = (unsigned int) keys[i];
+                value = (value & uint_sign) ? value ^ uint_sign : ~value;
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&value, data + i * size, size);
+                keys[i] = (value & uint_sign) ? ~value : value | uint_sign;
+            }
+        }
+        is_float = 1;
+    }
+    if (comparator == containers_compare_double && size == sizeof(double)
+        && sizeof(double) == sizeof(unsigned long)) {
+        for (i = 0; i < count; i++) {
+            unsigned long value;
+            if (decode) {
+                value = keys[i];
+                value = (value & ulong_sign) ? value ^ ulong_sign : ~value;
+                memcpy(data + i * size, &value, size);
+            } else {
+                memcpy(&value, data + i * size, size);
+                keys[i] = (value & ulong_sign) ? ~value : value | ulong_sign;
+            }
+        }
+        is_float = 1;
+    }
+    return is_float;
+}
+
+/*
+ * Sorts the elements with a least significant digit radix sort on the keys of
+ * the elements, a byte at a time. Bytes which are the same in every key are
+ * skipped. Returns zero if the elements cannot be radix sorted, or if there is
+ * not enough memory to.
+ */
+static int containers_sort_radix(char *const data,
+                                 const int count,
+                                 const size_t size,
+                                 int (*comparator)(const void *const,
+                                                   const void *const))
+{
+    int counts[sizeof(unsigned long)][256];
+    unsigned long *keys;
+    unsigned long *other;
+    size_t digit;
+    int i;
+    if (size > sizeof(unsigned long)) {
+        return 0;
+    }
+    keys = malloc(2 * (size_t) count * sizeof(unsigned long));
+    if (!keys) {
+        return 0;
+    }
+    if (!containers_sort_convert(keys, data, count, size, comparator, 0)) {
+        free(keys);
+        return 0;
+    }
+    other = keys + count;
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < count; i++) {
+        for (digit = 0; digit < size; digit++) {
+            counts[digit][(keys[i] >> (digit * 8)) & 0xff]++;
+        }
+    }
+    for (digit = 0; digit < size; digit++) {
+        int *const bucket = counts[digit];
+        const int shift = (int) digit * 8;
+        unsigned long *temp;
+        int total = 0;
+        if (bucket[(keys[0] >> shift) & 0xff] == count) {
+            continue;
+        }
+        for (i = 0; i < 256; i++) {
+            const int amount = bucket[i];
+            bucket[i] = total;
+            total += amount;
+        }
+        for (i = 0; i < count; i++) {
+            other[bucket[(keys[i] >> shift) & 0xff]++] = keys[i];
+        }
+        temp = keys;
+        keys = other;
+        other = temp;
+    }
+    containers_sort_convert(keys, data, count, size, comparator, 1);
+    free(keys < other ? keys : other);
+    return 1;
+}
+
+/**
+ * Sorts contiguous elements in ascending order according to the comparator.
+ * Elements which are already sorted, or sorted in reverse, are handled in
+ * linear time. If the comparator is containers_compare_int, _uint, _long,
+ * _ulong, _float, or _double, and the element size is the size of that type,
+ * the elements are sorted with a radix sort in linear time without calling the
+ * comparator. Otherwise, an introsort is used, which takes O(n log n) time in
+ * the worst case. If the comparator is containers_compare_key, the elements are
+ * compared by all of their bytes with memcmp. The sort is not stable.
+ *
+ * @param data       the elements to sort
+ * @param count      the amount of elements
+ * @param size       the size of each element
+ * @param comparator the comparator function which compares two elements
+ */
+void containers_sort(void *const data,
+                     const int count,
+                     const size_t size,
+                     int (*const comparator)(const void *const one,
+                                             const void *const two))
+{
+    int depth = 0;
+    int i;
+    if (count < 2) {
+        return;
+    }
+    if (count >= RADIX_SORT_SIZE
+        && containers_sort_radix(data, count, size, comparator)) {
+        return;
+    }
+    if (containers_sort_presorted(data, count, size, comparator)) {
+        return;
+    }
+    for (i = count; i > 1; i /= 2) {
+        depth += 2;
+    }
+    containers_sort_intro(data, count, size, comparator, depth);
+}
@@ -22,46 +22,175 @@
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/unordered_multimap.h"
+#include "include/hash.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <sys/types.h>
+#include <unistd.h>
+#endif
 
 static const int STARTING_BUCKETS = 8;
 static const double RESIZE_AT = 0.75;
 static const double RESIZE_RATIO = 1.5;
+static const char SNAPSHOT_MAGIC[8] = "CNTRHASH";
+static const unsigned long SNAPSHOT_VERSION = 3;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
 
 struct internal_unordered_multimap {
     size_t key_size;
     size_t value_size;
     unsigned long (*hash)(const void *const key);
     int (*key_comparator)(const void *const one, const void *const two);
+    int bytewise_keys;
     int (*value_comparator)(const void *const one, const void *const two);
     int size;
+    int key_count;
     int capacity;
+    double max_load_factor;
+    double min_load_factor;
     struct node **buckets;
-    unsigned long iterate_hash;
-    void *iterate_key;
-    struct node *iterate_element;
+    int migrate_step;
+    int migrate_index;
+    int old_capacity;
+    struct node **old_buckets;
+    unsigned long seed;
+    int max_chain_length;
+    int reseeded;
+    struct unordered_multimap_values iterate;
 };
 
+/*
+ * Each distinct key has a single node, which stores all the values of the key
+ * contiguously in insertion order. Thus, the bucket chains only grow with the
+ * amount of distinct keys, and the values of a key are read sequentially.
+ */
 struct node {
     void *key;
-    void *value;
     unsigned long hash;
+    int value_count;
+    int value_capacity;
+    char *values;
     struct node *next;
 };
 
 /*
- * Gets the hash by first calling the user-defined hash, and then using a
- * second hash to prevent hashing clusters if the user-defined hash is
- * sub-optimal.
+ * The header at the start of a snapshot. The records follow the header, one
+ * for each distinct key, each of which is the stored hash and the value count
+ * followed by the key and the values.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * A buffered stream over a file descriptor, used to save and load snapshots.
+ * The first error which occurs is kept in rc, after which the stream does
+ * nothing.
+ */
+struct snapshot_stream {
+    int fd;
+    int rc;
+    char *buffer;
+    size_t used;
+    size_t position;
+    char *record;
+};
+
+/*
+ * Mixes all the bits of the value. This is the same mixer as the one used by
+ * the built-in integer hash functions, so that they can be inlined.
+ */
+static unsigned long unordered_multimap_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Gets the hash of the key. The built-in hash functions are already
+ * well-distributed, so they are inlined or called directly, with the seed fed
+ * into them, so that keys which collide under one seed do not collide under
+ * another. Otherwise, the user-defined hash is called, and then a second hash
+ * is used to prevent hashing clusters if the user-defined hash is sub-optimal.
  */
 static unsigned long unordered_multimap_hash(unordered_multimap me,
                                              const void *const key)
 {
-    unsigned long hash = me->hash(key);
+    unsigned long hash;
+    if (me->hash == containers_hash_int) {
+        int value;
+        memcpy(&value, key, sizeof(int));
+        return unordered_multimap_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_long) {
+        long value;
+        memcpy(&value, key, sizeof(long));
+        return unordered_multimap_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_key) {
+        return containers_hash_bytes_seeded(key, me->key_size, me->seed);
+    }
+    if (me->hash == containers_hash_string) {
+        const char *string;
+        memcpy(&string, key, sizeof(char *));
+        return containers_hash_bytes_seeded(string, strlen(string), me->seed);
+    }
+    hash = me->hash(key);
     hash ^= (hash >> 20UL) ^ (hash >> 12UL);
     return hash ^ (hash >> 7UL) ^ (hash >> 4UL);
 }
 
+/*
+ * Determines whether the stored hashes depend on the seed, which they do for
+ * the built-in hash functions. The hashes of a user-defined hash function do
+ * not, so only their buckets change with the seed.
+ */
+static int unordered_multimap_is_seeded(unordered_multimap me)
+{
+    return me->hash == containers_hash_int || me->hash == containers_hash_long
+           || me->hash == containers_hash_key
+           || me->hash == containers_hash_string;
+}
+
+/*
+ * Determines whether two keys are equal exactly when their bytes are equal.
+ */
+static int unordered_multimap_is_bytewise(unordered_multimap me)
+{
+    return CONTAINERS_COMPARE_IS_BYTEWISE(me->key_comparator, me->key_size);
+}
+
+/*
+ * Compares two values.
+ */
+static int unordered_multimap_compare_values(unordered_multimap me,
+                                             const void *const one,
+                                             const void *const two)
+{
+    return CONTAINERS_COMPARE(me->value_comparator, me->value_size, one, two);
+}
+
 /**
  * Initializes an unordered multi-map.
  *
@@ -69,16 +198,19 @@ static unsigned long unordered_multimap_hash(unordered_multimap me,
  *                         be positive
  * @param value_size       the size of each value in the unordered multi-map;
  *                         must be positive
- * @param hash             the hash function which computes the hash from key;
- *                         must not be NULL
+ * @param hash             the hash function which computes the hash from the
+ *                         key; must not be NULL; may be one of the built-in
+ *                         hash functions from hash.h
  * @param key_comparator   the comparator function which compares two keys; must
- *                         not be NULL
+ *                         not be NULL; may be one of the built-in comparators
+ *                         from compare.h
  * @param value_comparator the comparator function which compares two values;
  *                         must not be NULL
  *
  * @return the newly-initialized unordered multi-map, or NULL if it was not
- *         successfully initialized due to either invalid input arguments or
- *         memory allocation error
+ *         successfully initialized due to invalid input arguments, memory
+ *         allocation error, or the random bytes of the operating system not
+ *         being readable
  */
 unordered_multimap
 unordered_multimap_init(const size_t key_size,
@@ -102,43 +234,98 @@ unordered_multimap_init(const size_t key_size,
     init->value_size = value_size;
     init->hash = hash;
     init->key_comparator = key_comparator;
+    init->bytewise_keys = unordered_multimap_is_bytewise(init);
     init->value_comparator = value_comparator;
     init->size = 0;
+    init->key_count = 0;
     init->capacity = STARTING_BUCKETS;
-    init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
-    if (!init->buckets) {
+    init->max_load_factor = RESIZE_AT;
+    init->min_load_factor = 0;
+    init->migrate_step = 0;
+    init->migrate_index = 0;
+    init->old_capacity = 0;
+    init->old_buckets = NULL;
+    if (containers_hash_new_seed(&init->seed, init) != 0) {
         free(init);
         return NULL;
     }
-    init->iterate_hash = 0;
-    init->iterate_key = calloc(1, init->key_size);
-    if (!init->iterate_key) {
-        free(init->buckets);
+    init->max_chain_length = 0;
+    init->reseeded = 0;
+    init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
+    if (!init->buckets) {
         free(init);
         return NULL;
     }
-    init->iterate_element = NULL;
+    init->iterate.internal_values = NULL;
+    init->iterate.internal_count = 0;
+    init->iterate.internal_index = 0;
     return init;
 }
 
+/*
+ * Gets the index of the bucket which holds the hash. The hash is mixed with the
+ * seed first, so that keys chosen to collide in the buckets of one unordered
+ * container are spread out in any other.
+ */
+static int unordered_multimap_index(unordered_multimap me,
+                                    const unsigned long hash,
+                                    const int capacity)
+{
+    const unsigned long mixed = unordered_multimap_mix(hash ^ me->seed);
+    return (int) (mixed % (unsigned long) capacity);
+}
+
 /*
  * Adds the specified node to the multi-map.
  */
 static void unordered_multimap_add_item(unordered_multimap me,
                                         struct node *const add)
 {
-    struct node *traverse;
-    const int index = (int) (add->hash % me->capacity);
-    add->next = NULL;
-    if (!me->buckets[index]) {
-        me->buckets[index] = add;
-        return;
+    const int index = unordered_multimap_index(me, add->hash, me->capacity);
+    add->next = me->buckets[index];
+    me->buckets[index] = add;
+}
+
+/*
+ * Gets the bucket which holds the nodes with the specified hash. While the
+ * nodes are being moved to the new buckets, the old buckets which have not
+ * been moved yet still hold their nodes.
+ */
+static struct node **unordered_multimap_bucket(unordered_multimap me,
+                                               const unsigned long hash)
+{
+    if (me->old_buckets) {
+        const int old_index =
+                unordered_multimap_index(me, hash, me->old_capacity);
+        if (old_index >= me->migrate_index) {
+            return &me->old_buckets[old_index];
+        }
     }
-    traverse = me->buckets[index];
-    while (traverse->next) {
-        traverse = traverse->next;
+    return &me->buckets[unordered_multimap_index(me, hash, me->capacity)];
+}
+
+/*
+ * Moves the nodes of up to count old buckets to the new buckets, and frees the
+ * old buckets once all of their nodes have been moved.
+ */
+static void unordered_multimap_migrate(unordered_multimap me, int count)
+{
+    while (me->old_buckets && count > 0) {
+        struct node *traverse = me->old_buckets[me->migrate_index];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_multimap_add_item(me, traverse);
+            traverse = backup;
+        }
+        me->migrate_index++;
+        count--;
+        if (me->migrate_index == me->old_capacity) {
+            free(me->old_buckets);
+            me->old_buckets = NULL;
+            me->old_capacity = 0;
+            me->migrate_index = 0;
+        }
     }
-    traverse->next = add;
 }
 
 /**
@@ -153,7 +340,9 @@ static void unordered_multimap_add_item(unordered_multimap me,
 int unordered_multimap_rehash(unordered_multimap me)
 {
     int i;
-    struct node **old_buckets = me->buckets;
+    struct node **old_buckets;
+    unordered_multimap_migrate(me, me->old_capacity);
+    old_buckets = me->buckets;
     me->buckets = calloc((size_t) me->capacity, sizeof(struct node *));
     if (!me->buckets) {
         me->buckets = old_buckets;
@@ -197,20 +386,28 @@ int unordered_multimap_is_empty(unordered_multimap me)
 }
 
 /*
- * Increases the size of the multi-map and redistributes the nodes.
+ * Changes the amount of buckets of the multi-map and redistributes the nodes.
  */
-static int unordered_multimap_resize(unordered_multimap me)
+static int unordered_multimap_resize(unordered_multimap me,
+                                     const int new_capacity)
 {
     int i;
     const int old_capacity = me->capacity;
-    const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
     struct node **old_buckets = me->buckets;
+    unordered_multimap_migrate(me, me->old_capacity);
     me->buckets = calloc((size_t) new_capacity, sizeof(struct node *));
     if (!me->buckets) {
         me->buckets = old_buckets;
         return -ENOMEM;
     }
     me->capacity = new_capacity;
+    me->reseeded = 0;
+    if (me->migrate_step > 0) {
+        me->old_buckets = old_buckets;
+        me->old_capacity = old_capacity;
+        me->migrate_index = 0;
+        return 0;
+    }
     for (i = 0; i < old_capacity; i++) {
         struct node *traverse = old_buckets[i];
         while (traverse) {
@@ -223,6 +420,225 @@ static int unordered_multimap_resize(unordered_multimap me)
     return 0;
 }
 
+/*
+ * Picks a new seed and redistributes the nodes if a chain has grown longer
+ * than the maximum chain length. This is done at most once between resizes,
+ * since a chain which is still too long after reseeding is made of equal
+ * hashes, which no seed can separate. The nodes are all moved at once, since
+ * the old buckets could not be located with the new seed. The hashes of the
+ * built-in hash functions depend on the seed, so they are computed again. If
+ * no seed can be generated, the chain is left as it is until the next resize.
+ */
+static void unordered_multimap_check_chain(unordered_multimap me,
+                                           const int length)
+{
+    const unsigned long old_seed = me->seed;
+    const int migrate_step = me->migrate_step;
+    unsigned long seed;
+    int rc;
+    if (me->max_chain_length == 0 || length <= me->max_chain_length
+        || me->reseeded) {
+        return;
+    }
+    if (containers_hash_new_seed(&seed, me) != 0) {
+        me->reseeded = 1;
+        return;
+    }
+    unordered_multimap_migrate(me, me->old_capacity);
+    me->seed = seed;
+    me->migrate_step = 0;
+    if (unordered_multimap_is_seeded(me)) {
+        rc = unordered_multimap_rehash(me);
+    } else {
+        rc = unordered_multimap_resize(me, me->capacity);
+    }
+    if (rc != 0) {
+        me->seed = old_seed;
+    }
+    me->migrate_step = migrate_step;
+    me->reseeded = 1;
+}
+
+/**
+ * Reserves enough buckets for the unordered multi-map to hold the specified
+ * amount of distinct keys without resizing. If more buckets than needed are
+ * already reserved, then the previous buckets will be kept.
+ *
+ * @param me   the unordered multi-map to reserve buckets for
+ * @param size the amount of distinct keys to reserve buckets for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if size is negative or too large
+ */
+int unordered_multimap_reserve(unordered_multimap me, const int size)
+{
+    const double capacity = size / me->max_load_factor + 1;
+    if (size < 0 || capacity > INT_MAX) {
+        return -EINVAL;
+    }
+    if ((int) capacity <= me->capacity) {
+        return 0;
+    }
+    return unordered_multimap_resize(me, (int) capacity);
+}
+
+/**
+ * Sets the maximum load factor of the unordered multi-map, which is the ratio
+ * of distinct keys to buckets at which the buckets are resized. A lower
+ * maximum load factor makes lookups faster at the cost of memory. The default
+ * maximum load factor is 0.75. If the unordered multi-map already exceeds the
+ * new maximum load factor, its buckets are resized right away.
+ *
+ * @param me              the unordered multi-map to change
+ * @param max_load_factor the new maximum load factor; must be more than twice
+ *                        the minimum load factor, and thus positive
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the maximum load factor is out of range
+ */
+int unordered_multimap_set_max_load_factor(unordered_multimap me,
+                                           const double max_load_factor)
+{
+    const double old_max_load_factor = me->max_load_factor;
+    int rc;
+    if (!(max_load_factor > 2 * me->min_load_factor)) {
+        return -EINVAL;
+    }
+    me->max_load_factor = max_load_factor;
+    rc = unordered_multimap_reserve(me, me->key_count);
+    if (rc != 0) {
+        me->max_load_factor = old_max_load_factor;
+    }
+    return rc;
+}
+
+/**
+ * Sets the minimum load factor of the unordered multi-map, below which the
+ * buckets are shrunk when keys are removed. The buckets are shrunk
+ * so that the load factor becomes half of the maximum load factor, which is why
+ * the minimum load factor must be less than that, so that the unordered multi-
+ * map does not shrink and grow back repeatedly. The default minimum load factor
+ * is zero, which means that the buckets are never shrunk automatically.
+ *
+ * @param me              the unordered multi-map to change
+ * @param min_load_factor the new minimum load factor; must not be negative,
+ *                        and must be less than half the maximum load factor
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the minimum load factor is out of range
+ */
+int unordered_multimap_set_min_load_factor(unordered_multimap me,
+                                           const double min_load_factor)
+{
+    if (!(min_load_factor >= 0 && 2 * min_load_factor < me->max_load_factor)) {
+        return -EINVAL;
+    }
+    me->min_load_factor = min_load_factor;
+    return 0;
+}
+
+/**
+ * Shrinks the buckets of the unordered multi-map to the smallest amount which
+ * holds its distinct keys without exceeding the maximum load factor. The
+ * unordered multi-map never has fewer than its starting amount of buckets.
+ *
+ * @param me the unordered multi-map to shrink
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multimap_shrink_to_fit(unordered_multimap me)
+{
+    int capacity = (int) (me->key_count / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity >= me->capacity) {
+        return 0;
+    }
+    return unordered_multimap_resize(me, capacity);
+}
+
+/*
+ * Shrinks the buckets once the load factor drops below the minimum load factor,
+ * so that the load factor becomes half of the maximum load factor. Since the
+ * unordered multi-map has already been modified, running out of memory is
+ * ignored.
+ */
+static void unordered_multimap_auto_shrink(unordered_multimap me)
+{
+    int capacity;
+    if (me->key_count >= me->min_load_factor * me->capacity) {
+        return;
+    }
+    capacity = (int) (2 * me->key_count / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity < me->capacity) {
+        unordered_multimap_resize(me, capacity);
+    }
+}
+
+/**
+ * Sets whether the unordered multi-map resizes incrementally. By default, all
+ * the nodes are moved to the new buckets at once when the unordered multi-map
+ * resizes, so the operation which triggers the resize takes time proportional
+ * to the size of the unordered multi-map. When resizing incrementally, the old
+ * buckets are kept alongside the new buckets, and each subsequent put or remove
+ * moves the nodes of up to the specified amount of old buckets, which spreads
+ * the cost of the resize over many operations. If the nodes have not all been
+ * moved by the time the next resize is needed, the rest of them are moved at
+ * once, which does not happen at the default maximum load factor when at least
+ * three buckets are moved per step. Setting the amount to zero turns
+ * incremental resizing off and moves any remaining nodes.
+ *
+ * @param me               the unordered multi-map to change
+ * @param buckets_per_step the amount of old buckets to move per put or
+ *                         remove, or zero to move all the nodes at once
+ *
+ * @return 0       if no error
+ * @return -EINVAL if buckets_per_step is negative
+ */
+int unordered_multimap_set_incremental_resize(unordered_multimap me,
+                                              const int buckets_per_step)
+{
+    if (buckets_per_step < 0) {
+        return -EINVAL;
+    }
+    me->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0) {
+        unordered_multimap_migrate(me, me->old_capacity);
+    }
+    return 0;
+}
+
+/**
+ * Sets the maximum length of a bucket chain. When adding a key makes its chain
+ * longer than this, the unordered multi-map picks a new random seed and
+ * redistributes its keys, which breaks up chains of keys chosen to collide.
+ * This is done at most once between resizes. The chain length guard is disabled
+ * by default, and is disabled again by a maximum chain length of zero.
+ *
+ * @param me               the unordered multi-map to change
+ * @param max_chain_length the maximum length of a chain, or zero to disable
+ *                         the chain length guard
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the maximum chain length is negative
+ */
+int unordered_multimap_set_max_chain_length(unordered_multimap me,
+                                            const int max_chain_length)
+{
+    if (max_chain_length < 0) {
+        return -EINVAL;
+    }
+    me->max_chain_length = max_chain_length;
+    return 0;
+}
+
 /*
  * Determines if an element is equal to the key.
  */
@@ -231,16 +647,23 @@ static int unordered_multimap_is_equal(unordered_multimap me,
                                        const unsigned long hash,
                                        const void *const key)
 {
-    return item->hash == hash && me->key_comparator(item->key, key) == 0;
+    if (item->hash != hash) {
+        return 0;
+    }
+    if (me->bytewise_keys) {
+        return memcmp(item->key, key, me->key_size) == 0;
+    }
+    return me->key_comparator(item->key, key) == 0;
 }
 
 /*
- * Creates an element to add.
+ * Creates an element to add, which holds the key and has room for the specified
+ * amount of values.
  */
 static struct node *unordered_multimap_create_element(unordered_multimap me,
                                                       const unsigned long hash,
                                                       const void *const key,
-                                                      const void *const value)
+                                                      const int capacity)
 {
     struct node *const init = malloc(sizeof(struct node));
     if (!init) {
@@ -252,18 +675,102 @@ static struct node *unordered_multimap_create_element(unordered_multimap me,
         return NULL;
     }
     memcpy(init->key, key, me->key_size);
-    init->value = malloc(me->value_size);
-    if (!init->value) {
+    init->values = malloc(capacity * me->value_size);
+    if (!init->values) {
         free(init->key);
         free(init);
         return NULL;
     }
-    memcpy(init->value, value, me->value_size);
     init->hash = hash;
+    init->value_count = 0;
+    init->value_capacity = capacity;
     init->next = NULL;
     return init;
 }
 
+/*
+ * Frees an element along with its key and values.
+ */
+static void unordered_multimap_free_element(struct node *const item)
+{
+    free(item->values);
+    free(item->key);
+    free(item);
+}
+
+/*
+ * Resizes the array which holds the values of a key.
+ */
+static int unordered_multimap_resize_values(unordered_multimap me,
+                                            struct node *const item,
+                                            const int capacity)
+{
+    char *const temp = realloc(item->values, capacity * me->value_size);
+    if (!temp) {
+        return -ENOMEM;
+    }
+    item->values = temp;
+    item->value_capacity = capacity;
+    return 0;
+}
+
+/*
+ * Appends a value to the values of a key, doubling the capacity of the array
+ * when it is full.
+ */
+static int unordered_multimap_append_value(unordered_multimap me,
+                                           struct node *const item,
+                                           const void *const value)
+{
+    if (item->value_count == item->value_capacity) {
+        const int capacity = 2 * item->value_capacity;
+        const int rc = unordered_multimap_resize_values(me, item, capacity);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    memcpy(item->values + item->value_count * me->value_size, value,
+           me->value_size);
+    item->value_count++;
+    me->size++;
+    return 0;
+}
+
+/*
+ * Removes the value at the specified index of a key, keeping the rest of the
+ * values in order. The array is halved once it is a quarter full, and running
+ * out of memory while doing so is ignored.
+ */
+static void unordered_multimap_remove_value(unordered_multimap me,
+                                            struct node *const item,
+                                            const int index)
+{
+    char *const position = item->values + index * me->value_size;
+    memmove(position, position + me->value_size,
+            (item->value_count - index - 1) * me->value_size);
+    item->value_count--;
+    me->size--;
+    if (item->value_count > 0
+        && item->value_count <= item->value_capacity / 4) {
+        unordered_multimap_resize_values(me, item, item->value_capacity / 2);
+    }
+}
+
+/*
+ * Gets the link which points to the node of the key, or to the end of the
+ * bucket chain if the unordered multi-map does not contain the key.
+ */
+static struct node **unordered_multimap_find(unordered_multimap me,
+                                             const unsigned long hash,
+                                             const void *const key)
+{
+    struct node **link = unordered_multimap_bucket(me, hash);
+    while (*link && !unordered_multimap_is_equal(me, *link, hash, key)) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
 /**
  * Adds a key-value pair to the unordered multi-map. The pointer to the key and
  * value being passed in should point to the key and value type which this
@@ -284,63 +791,53 @@ int unordered_multimap_put(unordered_multimap me,
                            void *const value)
 {
     const unsigned long hash = unordered_multimap_hash(me, key);
-    int index;
-    if (me->size + 1 >= RESIZE_AT * me->capacity) {
-        const int rc = unordered_multimap_resize(me);
+    struct node **bucket;
+    struct node *traverse;
+    int length = 1;
+    unordered_multimap_migrate(me, me->migrate_step);
+    if (me->key_count + 1 >= me->max_load_factor * me->capacity) {
+        const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
+        const int rc = unordered_multimap_resize(me, new_capacity);
         if (rc != 0) {
             return rc;
         }
     }
-    index = (int) (hash % me->capacity);
-    if (!me->buckets[index]) {
-        me->buckets[index] =
-                unordered_multimap_create_element(me, hash, key, value);
-        if (!me->buckets[index]) {
-            return -ENOMEM;
-        }
-    } else {
-        struct node *traverse = me->buckets[index];
-        while (traverse->next) {
-            traverse = traverse->next;
-        }
-        traverse->next =
-                unordered_multimap_create_element(me, hash, key, value);
-        if (!traverse->next) {
-            return -ENOMEM;
+    bucket = unordered_multimap_bucket(me, hash);
+    for (traverse = *bucket; traverse; traverse = traverse->next) {
+        if (unordered_multimap_is_equal(me, traverse, hash, key)) {
+            return unordered_multimap_append_value(me, traverse, value);
         }
+        length++;
     }
-    me->size++;
+    traverse = unordered_multimap_create_element(me, hash, key, 1);
+    if (!traverse) {
+        return -ENOMEM;
+    }
+    traverse->next = *bucket;
+    *bucket = traverse;
+    me->key_count++;
+    unordered_multimap_append_value(me, traverse, value);
+    unordered_multimap_check_chain(me, length);
     return 0;
 }
 
 /**
  * Creates the iterator for the specified key. To iterate over the values, keep
- * getting the next value. Between starting and iterations, the unordered
- * multi-map must not be mutated. The pointer to the key being passed in should
- * point to the key type which this unordered multi-map holds. For example, if
- * this unordered multi-map holds key integers, the key pointer should be a
- * pointer to an integer. Since the key is being copied, the pointer only has
- * to be valid when this function is called.
+ * getting the next value. Since the iterator is kept in the unordered
+ * multi-map, only one iteration may be in progress at a time, which
+ * unordered_multimap_values_start avoids. Between starting and iterations, the
+ * unordered multi-map must not be mutated. The pointer to the key being passed
+ * in should point to the key type which this unordered multi-map holds. For
+ * example, if this unordered multi-map holds key integers, the key pointer
+ * should be a pointer to an integer. Since the key is being copied, the pointer
+ * only has to be valid when this function is called.
  *
  * @param me  the unordered multi-map to start the iterator for
  * @param key the key to start the iterator for
  */
 void unordered_multimap_get_start(unordered_multimap me, void *const key)
 {
-    int index;
-    struct node *traverse;
-    me->iterate_hash = unordered_multimap_hash(me, key);
-    memcpy(me->iterate_key, key, me->key_size);
-    me->iterate_element = NULL;
-    index = (int) (me->iterate_hash % me->capacity);
-    traverse = me->buckets[index];
-    while (traverse) {
-        if (unordered_multimap_is_equal(me, traverse, me->iterate_hash, key)) {
-            me->iterate_element = traverse;
-            return;
-        }
-        traverse = traverse->next;
-    }
+    unordered_multimap_values_start(me, &me->iterate, key);
 }
 
 /**
@@ -360,27 +857,98 @@ void unordered_multimap_get_start(unordered_multimap me, void *const key)
  */
 int unordered_multimap_get_next(void *const value, unordered_multimap me)
 {
-    struct node *item;
-    struct node *traverse;
-    if (!me->iterate_element) {
+    return unordered_multimap_values_next(value, me, &me->iterate);
+}
+
+/**
+ * Starts iterating over the values for the specified key with a cursor which is
+ * owned by the caller. Unlike unordered_multimap_get_start, this does not
+ * modify the unordered multi-map, so several iterations may be in progress at
+ * the same time, including from different threads as long as none of them
+ * mutates the unordered multi-map. The cursor is only valid until the unordered
+ * multi-map is next mutated. The pointer to the key being passed in should
+ * point to the key type which this unordered multi-map holds.
+ *
+ * @param me     the unordered multi-map to iterate over
+ * @param cursor the cursor to start
+ * @param key    the key to iterate over the values of
+ *
+ * @return the number of values for the key
+ */
+int
+unordered_multimap_values_start(unordered_multimap me,
+                                struct unordered_multimap_values *const cursor,
+                                void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    const struct node *const item = *unordered_multimap_find(me, hash, key);
+    cursor->internal_index = 0;
+    if (!item) {
+        cursor->internal_values = NULL;
+        cursor->internal_count = 0;
         return 0;
     }
-    item = me->iterate_element;
-    traverse = item->next;
-    while (traverse) {
-        if (unordered_multimap_is_equal(me, traverse, me->iterate_hash,
-                                        me->iterate_key)) {
-            me->iterate_element = traverse;
-            memcpy(value, item->value, me->value_size);
-            return 1;
-        }
-        traverse = traverse->next;
+    cursor->internal_values = item->values;
+    cursor->internal_count = item->value_count;
+    return item->value_count;
+}
+
+/**
+ * Copies the next value of the cursor, and advances the cursor. The pointer to
+ * the value being obtained should point to the value type which this unordered
+ * multi-map holds.
+ *
+ * @param value  the value to be copied to
+ * @param me     the unordered multi-map being iterated over
+ * @param cursor the cursor to advance
+ *
+ * @return 1 if a value was copied, otherwise 0 if there are no more values
+ */
+int
+unordered_multimap_values_next(void *const value,
+                               unordered_multimap me,
+                               struct unordered_multimap_values *const cursor)
+{
+    const char *item;
+    if (cursor->internal_index == cursor->internal_count) {
+        return 0;
     }
-    me->iterate_element = NULL;
-    memcpy(value, item->value, me->value_size);
+    item = cursor->internal_values;
+    memcpy(value, item + cursor->internal_index * me->value_size,
+           me->value_size);
+    cursor->internal_index++;
     return 1;
 }
 
+/**
+ * Gets all the values for the specified key at once. The values are stored
+ * contiguously in the order in which they were added, so the span may be read
+ * directly as an array of the value type which this unordered multi-map holds.
+ * The span is owned by the unordered multi-map, and is only valid until the
+ * unordered multi-map is next mutated. The pointer to the key being passed in
+ * should point to the key type which this unordered multi-map holds.
+ *
+ * @param values the pointer to set to the start of the values, or to NULL if
+ *               the unordered multi-map does not contain the key
+ * @param me     the unordered multi-map to get the values from
+ * @param key    the key to get the values for
+ *
+ * @return the number of values in the span
+ */
+int unordered_multimap_get_values(void **const values,
+                                  unordered_multimap me,
+                                  void *const key)
+{
+    const unsigned long hash = unordered_multimap_hash(me, key);
+    struct node *const item = *unordered_multimap_find(me, hash, key);
+    if (!item) {
+        *values = NULL;
+        return 0;
+    }
+    *values = item->values;
+    return item->value_count;
+}
+
 /**
  * Determines the number of times the key appears in the unordered multi-map.
  * The pointer to the key being passed in should point to the key type which
@@ -396,17 +964,12 @@ int unordered_multimap_get_next(void *const value, unordered_multimap me)
  */
 int unordered_multimap_count(unordered_multimap me, void *const key)
 {
-    int count = 0;
     const unsigned long hash = unordered_multimap_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    const struct node *traverse = me->buckets[index];
-    while (traverse) {
-        if (unordered_multimap_is_equal(me, traverse, hash, key)) {
-            count++;
-        }
-        traverse = traverse->next;
+    const struct node *const item = *unordered_multimap_find(me, hash, key);
+    if (!item) {
+        return 0;
     }
-    return count;
+    return item->value_count;
 }
 
 /**
@@ -424,15 +987,7 @@ int unordered_multimap_count(unordered_multimap me, void *const key)
 int unordered_multimap_contains(unordered_multimap me, void *const key)
 {
     const unsigned long hash = unordered_multimap_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    const struct node *traverse = me->buckets[index];
-    while (traverse) {
-        if (unordered_multimap_is_equal(me, traverse, hash, key)) {
-            return 1;
-        }
-        traverse = traverse->next;
-    }
-    return 0;
+    return *unordered_multimap_find(me, hash, key) != NULL;
 }
 
 /**
@@ -453,38 +1008,33 @@ int unordered_multimap_remove(unordered_multimap me,
                               void *const key,
                               void *const value)
 {
-    struct node *traverse;
-    int is_key_equal;
     const unsigned long hash = unordered_multimap_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    if (!me->buckets[index]) {
+    struct node **link;
+    struct node *item;
+    int i;
+    unordered_multimap_migrate(me, me->migrate_step);
+    link = unordered_multimap_find(me, hash, key);
+    item = *link;
+    if (!item) {
         return 0;
     }
-    traverse = me->buckets[index];
-    is_key_equal = unordered_multimap_is_equal(me, traverse, hash, key);
-    if (is_key_equal && me->value_comparator(traverse->value, value) == 0) {
-        me->buckets[index] = traverse->next;
-        free(traverse->key);
-        free(traverse->value);
-        free(traverse);
-        me->size--;
-        return 1;
-    }
-    while (traverse->next) {
-        is_key_equal =
-                unordered_multimap_is_equal(me, traverse->next, hash, key);
-        if (is_key_equal && me->value_comparator(traverse->value, value) == 0) {
-            struct node *const backup = traverse->next;
-            traverse->next = traverse->next->next;
-            free(backup->key);
-            free(backup->value);
-            free(backup);
-            me->size--;
-            return 1;
+    for (i = 0; i < item->value_count; i++) {
+        if (unordered_multimap_compare_values(
+                me, item->values + i * me->value_size, value) == 0) {
+            break;
         }
-        traverse = traverse->next;
     }
-    return 0;
+    if (i == item->value_count) {
+        return 0;
+    }
+    unordered_multimap_remove_value(me, item, i);
+    if (item->value_count == 0) {
+        *link = item->next;
+        unordered_multimap_free_element(item);
+        me->key_count--;
+        unordered_multimap_auto_shrink(me);
+    }
+    return 1;
 }
 
 /**
@@ -503,38 +1053,469 @@ int unordered_multimap_remove(unordered_multimap me,
 int unordered_multimap_remove_all(unordered_multimap me, void *const key)
 {
     const unsigned long hash = unordered_multimap_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    int was_modified = 0;
+    struct node **link;
+    struct node *item;
+    unordered_multimap_migrate(me, me->migrate_step);
+    link = unordered_multimap_find(me, hash, key);
+    item = *link;
+    if (!item) {
+        return 0;
+    }
+    *link = item->next;
+    me->size -= item->value_count;
+    me->key_count--;
+    unordered_multimap_free_element(item);
+    unordered_multimap_auto_shrink(me);
+    return 1;
+}
+
+/*
+ * Moves the cursor to the first node in or after its bucket. The new buckets
+ * are scanned first, followed by the old buckets which have not been moved yet.
+ */
+static int
+unordered_multimap_cursor_seek(unordered_multimap me,
+                               struct unordered_multimap_cursor *const cursor)
+{
     for (;;) {
-        struct node *traverse = me->buckets[index];
-        if (!traverse) {
-            break;
+        struct node **buckets = me->buckets;
+        int capacity = me->capacity;
+        if (cursor->internal_table == 1) {
+            buckets = me->old_buckets;
+            capacity = me->old_capacity;
         }
-        if (unordered_multimap_is_equal(me, traverse, hash, key)) {
-            me->buckets[index] = traverse->next;
-            free(traverse->key);
-            free(traverse->value);
-            free(traverse);
-            me->size--;
-            was_modified = 1;
+        while (cursor->internal_bucket < capacity) {
+            if (buckets[cursor->internal_bucket]) {
+                cursor->internal_link = &buckets[cursor->internal_bucket];
+                cursor->internal_index = 0;
+                return 1;
+            }
+            cursor->internal_bucket++;
+        }
+        if (cursor->internal_table == 1) {
+            cursor->internal_link = NULL;
+            return 0;
+        }
+        cursor->internal_table = 1;
+        cursor->internal_bucket = me->migrate_index;
+    }
+}
+
+/**
+ * Moves the cursor to the first key-value pair of the unordered multi-map. The
+ * keys are visited in the order in which they are stored rather than in any
+ * particular order, and the values of each key are visited one after another
+ * in the order in which they were added. The cursor is owned by the caller, and
+ * remains valid until the unordered multi-map is modified other than through
+ * unordered_multimap_cursor_remove.
+ *
+ * @param me     the unordered multi-map to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key-value pair, otherwise 0 if the
+ *         unordered multi-map is empty
+ */
+int unordered_multimap_first(unordered_multimap me,
+                             struct unordered_multimap_cursor *const cursor)
+{
+    cursor->internal_table = 0;
+    cursor->internal_bucket = 0;
+    return unordered_multimap_cursor_seek(me, cursor);
+}
+
+/**
+ * Moves the cursor to the next key-value pair of the unordered multi-map.
+ *
+ * @param me     the unordered multi-map to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a key-value pair, otherwise 0 if there are
+ *         no more key-value pairs
+ */
+int unordered_multimap_next(unordered_multimap me,
+                            struct unordered_multimap_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    if (!link) {
+        return 0;
+    }
+    if (cursor->internal_index + 1 < (*link)->value_count) {
+        cursor->internal_index++;
+        return 1;
+    }
+    cursor->internal_index = 0;
+    cursor->internal_link = &(*link)->next;
+    if ((*link)->next) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multimap_cursor_seek(me, cursor);
+}
+
+/**
+ * Copies the key and the value at the cursor. Either of the key or the value
+ * may be NULL if it is not needed.
+ *
+ * @param key    the key to copy to, or NULL
+ * @param value  the value to copy to, or NULL
+ * @param me     the unordered multi-map being iterated over
+ * @param cursor the cursor to get from
+ *
+ * @return 1 if the cursor was at a key-value pair, otherwise 0
+ */
+int
+unordered_multimap_cursor_get(void *const key,
+                              void *const value,
+                              unordered_multimap me,
+                              const struct unordered_multimap_cursor *cursor)
+{
+    const struct node *item;
+    if (!cursor->internal_link) {
+        return 0;
+    }
+    item = *(struct node **) cursor->internal_link;
+    if (key) {
+        memcpy(key, item->key, me->key_size);
+    }
+    if (value) {
+        memcpy(value, item->values + cursor->internal_index * me->value_size,
+               me->value_size);
+    }
+    return 1;
+}
+
+/**
+ * Removes the key-value pair at the cursor from the unordered multi-map, and
+ * moves the cursor to the next key-value pair. Removing through the cursor
+ * never resizes the buckets, so the cursor remains valid.
+ *
+ * @param me     the unordered multi-map to remove from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at a key-value pair after the removal, otherwise 0
+ */
+int
+unordered_multimap_cursor_remove(unordered_multimap me,
+                                 struct unordered_multimap_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    struct node *item;
+    if (!link) {
+        return 0;
+    }
+    item = *link;
+    unordered_multimap_remove_value(me, item, cursor->internal_index);
+    if (cursor->internal_index < item->value_count) {
+        return 1;
+    }
+    cursor->internal_index = 0;
+    if (item->value_count == 0) {
+        *link = item->next;
+        unordered_multimap_free_element(item);
+        me->key_count--;
+    } else {
+        cursor->internal_link = &item->next;
+    }
+    if (*(struct node **) cursor->internal_link) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multimap_cursor_seek(me, cursor);
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the buffered bytes of the stream to its file descriptor.
+ */
+static void
+unordered_multimap_stream_flush(struct snapshot_stream *const stream)
+{
+    size_t written = 0;
+    while (stream->rc == 0 && written < stream->used) {
+        const ssize_t rc = write(stream->fd, stream->buffer + written,
+                                 stream->used - written);
+        if (rc == -1 && errno == EINTR) {
             continue;
         }
-        while (traverse->next) {
-            if (unordered_multimap_is_equal(me, traverse->next, hash, key)) {
-                struct node *const backup = traverse->next;
-                traverse->next = traverse->next->next;
-                free(backup->key);
-                free(backup->value);
-                free(backup);
-                me->size--;
-                was_modified = 1;
+        if (rc == -1) {
+            stream->rc = -EIO;
+        } else {
+            written += (size_t) rc;
+        }
+    }
+    stream->used = 0;
+}
+
+/*
+ * Appends bytes to the stream, flushing the buffer whenever it fills up.
+ */
+static void
+unordered_multimap_stream_write(struct snapshot_stream *const stream,
+                                const void *const data,
+                                const size_t size)
+{
+    const char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = SNAPSHOT_BUFFER_SIZE - stream->used;
+        if (chunk == 0) {
+            unordered_multimap_stream_flush(stream);
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(stream->buffer + stream->used, position, chunk);
+        stream->used += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Reads bytes from the stream, refilling the buffer whenever it runs out.
+ */
+static void
+unordered_multimap_stream_read(struct snapshot_stream *const stream,
+                               void *const data,
+                               const size_t size)
+{
+    char *position = data;
+    size_t remaining = size;
+    while (stream->rc == 0 && remaining > 0) {
+        size_t chunk = stream->used - stream->position;
+        if (chunk == 0) {
+            const ssize_t rc = read(stream->fd, stream->buffer,
+                                    SNAPSHOT_BUFFER_SIZE);
+            if (rc == -1 && errno == EINTR) {
                 continue;
             }
+            if (rc <= 0) {
+                stream->rc = -EIO;
+                return;
+            }
+            stream->used = (size_t) rc;
+            stream->position = 0;
+            continue;
+        }
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+        memcpy(position, stream->buffer + stream->position, chunk);
+        stream->position += chunk;
+        position += chunk;
+        remaining -= chunk;
+    }
+}
+
+/*
+ * Grows the buckets while a snapshot is loaded, once the keys which have been
+ * read so far would not fit. The buckets are sized for twice as many, up to the
+ * count of the header, so that a whole snapshot takes few resizes, while a
+ * corrupt count cannot reserve more buckets than the snapshot has keys.
+ */
+static int unordered_multimap_load_reserve(unordered_multimap me,
+                                           const unsigned long needed,
+                                           const unsigned long count)
+{
+    unsigned long size = 2 * needed;
+    if (needed / me->max_load_factor + 1 <= me->capacity) {
+        return 0;
+    }
+    if (size > count) {
+        size = count;
+    }
+    return unordered_multimap_reserve(me, (int) size);
+}
+
+/*
+ * Loads the next record of the snapshot, which holds a key and all of its
+ * values, and adds it to the buckets.
+ */
+static int unordered_multimap_load_record(unordered_multimap me,
+                                          struct snapshot_stream *const stream)
+{
+    unsigned long hash;
+    unsigned long value_count;
+    struct node *add;
+    struct node **bucket;
+    unordered_multimap_stream_read(stream, &hash, sizeof(unsigned long));
+    unordered_multimap_stream_read(stream, &value_count,
+                                   sizeof(unsigned long));
+    unordered_multimap_stream_read(stream, stream->record, me->key_size);
+    if (stream->rc != 0) {
+        return stream->rc;
+    }
+    if (unordered_multimap_is_seeded(me)) {
+        hash = unordered_multimap_hash(me, stream->record);
+    }
+    if (value_count == 0
+        || value_count > (unsigned long) (INT_MAX - me->size)
+        || value_count > (size_t) -1 / me->value_size) {
+        return -EINVAL;
+    }
+    add = unordered_multimap_create_element(me, hash, stream->record,
+                                            (int) value_count);
+    if (!add) {
+        return -ENOMEM;
+    }
+    unordered_multimap_stream_read(stream, add->values,
+                                   value_count * me->value_size);
+    if (stream->rc != 0) {
+        unordered_multimap_free_element(add);
+        return stream->rc;
+    }
+    add->value_count = (int) value_count;
+    bucket = unordered_multimap_bucket(me, hash);
+    add->next = *bucket;
+    *bucket = add;
+    me->key_count++;
+    me->size += (int) value_count;
+    return 0;
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the unordered multi-map to a file descriptor. The
+ * snapshot consists of a header, which holds the key size, the value size, and
+ * the amount of distinct keys, followed by the stored hash, the value count,
+ * the key, and the values of each distinct key. The hash seed is not written,
+ * so that it never leaves the process. Thus, loading the snapshot hashes the
+ * keys again if they use a built-in hash function. Since the keys and values
+ * are copied byte for byte, they should not contain pointers unless the
+ * snapshot is loaded by the same process.
+ *
+ * @param me the unordered multi-map to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int unordered_multimap_save(unordered_multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    int i;
+    unordered_multimap_migrate(me, me->old_capacity);
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = (unsigned long) me->value_size;
+    header.count = (unsigned long) me->key_count;
+    unordered_multimap_stream_write(&stream, &header,
+                                    sizeof(struct snapshot_header));
+    for (i = 0; stream.rc == 0 && i < me->capacity; i++) {
+        const struct node *traverse = me->buckets[i];
+        while (stream.rc == 0 && traverse) {
+            const unsigned long value_count =
+                    (unsigned long) traverse->value_count;
+            unordered_multimap_stream_write(&stream, &traverse->hash,
+                                            sizeof(unsigned long));
+            unordered_multimap_stream_write(&stream, &value_count,
+                                            sizeof(unsigned long));
+            unordered_multimap_stream_write(&stream, traverse->key,
+                                            me->key_size);
+            unordered_multimap_stream_write(&stream, traverse->values,
+                                            traverse->value_count
+                                            * me->value_size);
             traverse = traverse->next;
         }
-        break;
     }
-    return was_modified;
+    unordered_multimap_stream_flush(&stream);
+    free(stream.buffer);
+    return stream.rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by unordered_multimap_save into an
+ * empty unordered multi-map. The comparator is never called, since the keys of
+ * a snapshot are already distinct. The values of each key are read straight
+ * into its array. The seed is not in the snapshot, so a fresh seed is picked.
+ * The stored hashes of a user-defined hash function do not depend on the seed,
+ * so they are reused without calling it. The built-in hash functions do depend
+ * on the seed, so each key is hashed again with the fresh seed. The buckets
+ * grow as the keys are read, rather than being sized from the count in the
+ * header, so that a corrupt count cannot reserve more buckets than the snapshot
+ * holds. Thus, the unordered multi-map must have been initialized with the same
+ * key size, value size, and hash function as the unordered multi-map which was
+ * saved. If an error occurs part of the way through the snapshot, the keys
+ * which have already been loaded remain in the unordered multi-map. When the
+ * file descriptor is seekable, it is left positioned right after the snapshot.
+ *
+ * @param me the unordered multi-map to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered multi-map is not empty or the
+ *                 snapshot does not match the unordered multi-map
+ * @return -EIO    if the snapshot or the random bytes of the operating system
+ *                 could not be read
+ */
+int unordered_multimap_load(unordered_multimap me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    struct snapshot_stream stream;
+    unsigned long remaining;
+    int rc;
+    if (me->size != 0) {
+        return -EINVAL;
+    }
+    memset(&stream, 0, sizeof(struct snapshot_stream));
+    stream.fd = fd;
+    stream.buffer = malloc(SNAPSHOT_BUFFER_SIZE + me->key_size);
+    if (!stream.buffer) {
+        return -ENOMEM;
+    }
+    stream.record = stream.buffer + SNAPSHOT_BUFFER_SIZE;
+    unordered_multimap_stream_read(&stream, &header,
+                                   sizeof(struct snapshot_header));
+    rc = stream.rc;
+    if (rc == 0
+        && (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+            || header.version != SNAPSHOT_VERSION
+            || header.key_size != (unsigned long) me->key_size
+            || header.value_size != (unsigned long) me->value_size
+            || header.count > INT_MAX)) {
+        rc = -EINVAL;
+    }
+    if (rc == 0) {
+        rc = containers_hash_new_seed(&me->seed, me);
+    }
+    for (remaining = header.count; rc == 0 && remaining > 0; remaining--) {
+        rc = unordered_multimap_load_reserve(me, me->key_count + 1,
+                                             header.count);
+        if (rc == 0) {
+            rc = unordered_multimap_load_record(me, &stream);
+        }
+    }
+    if (stream.used > stream.position) {
+        lseek(fd, -(off_t) (stream.used - stream.position), SEEK_CUR);
+    }
+    free(stream.buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
 }
 
 /**
@@ -553,18 +1534,18 @@ int unordered_multimap_clear(unordered_multimap me)
     if (!temp) {
         return -ENOMEM;
     }
+    unordered_multimap_migrate(me, me->old_capacity);
     for (i = 0; i < me->capacity; i++) {
         struct node *traverse = me->buckets[i];
         while (traverse) {
             struct node *const backup = traverse;
             traverse = traverse->next;
-            free(backup->key);
-            free(backup->value);
-            free(backup);
+            unordered_multimap_free_element(backup);
         }
         me->buckets[i] = NULL;
     }
     me->size = 0;
+    me->key_count = 0;
     me->capacity = STARTING_BUCKETS;
     free(me->buckets);
     me->buckets = temp;
@@ -582,7 +1563,6 @@ int unordered_multimap_clear(unordered_multimap me)
 unordered_multimap unordered_multimap_destroy(unordered_multimap me)
 {
     unordered_multimap_clear(me);
-    free(me->iterate_key);
     free(me->buckets);
     free(me);
     return NULL;
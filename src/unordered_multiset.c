@@ -22,20 +22,42 @@
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/unordered_multiset.h"
+#include "include/hash.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_FD
+#include <unistd.h>
+#endif
 
 static const int STARTING_BUCKETS = 8;
 static const double RESIZE_AT = 0.75;
 static const double RESIZE_RATIO = 1.5;
+static const char SNAPSHOT_MAGIC[8] = "CNTRHASH";
+static const unsigned long SNAPSHOT_VERSION = 2;
+static const size_t SNAPSHOT_BUFFER_SIZE = 64 * 1024;
 
 struct internal_unordered_multiset {
     size_t key_size;
     unsigned long (*hash)(const void *const key);
     int (*comparator)(const void *const one, const void *const two);
+    int bytewise_keys;
     int size;
     int used;
     int capacity;
+    double max_load_factor;
+    double min_load_factor;
     struct node **buckets;
+    int migrate_step;
+    int migrate_index;
+    int old_capacity;
+    struct node **old_buckets;
+    unsigned long seed;
+    int max_chain_length;
+    int reseeded;
 };
 
 struct node {
@@ -46,31 +68,109 @@ struct node {
 };
 
 /*
- * Gets the hash by first calling the user-defined hash, and then using a
- * second hash to prevent hashing clusters if the user-defined hash is
- * sub-optimal.
+ * The header at the start of a snapshot. The records follow the header, each
+ * of which is the stored hash followed by the count and the key.
+ */
+struct snapshot_header {
+    char magic[8];
+    unsigned long version;
+    unsigned long key_size;
+    unsigned long value_size;
+    unsigned long count;
+};
+
+/*
+ * Mixes all the bits of the value. This is the same mixer as the one used by
+ * the built-in integer hash functions, so that they can be inlined.
+ */
+static unsigned long unordered_multiset_mix(unsigned long value)
+{
+#if ULONG_MAX > 0xffffffffUL
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9UL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebUL;
+    value ^= value >> 31;
+#else
+    value ^= value >> 16;
+    value *= 0x7feb352dUL;
+    value ^= value >> 15;
+    value *= 0x846ca68bUL;
+    value ^= value >> 16;
+#endif
+    return value;
+}
+
+/*
+ * Gets the hash of the key. The built-in hash functions are already
+ * well-distributed, so they are inlined or called directly, with the seed fed
+ * into them, so that keys which collide under one seed do not collide under
+ * another. Otherwise, the user-defined hash is called, and then a second hash
+ * is used to prevent hashing clusters if the user-defined hash is sub-optimal.
  */
 static unsigned long unordered_multiset_hash(unordered_multiset me,
                                              const void *const key)
 {
-    unsigned long hash = me->hash(key);
+    unsigned long hash;
+    if (me->hash == containers_hash_int) {
+        int value;
+        memcpy(&value, key, sizeof(int));
+        return unordered_multiset_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_long) {
+        long value;
+        memcpy(&value, key, sizeof(long));
+        return unordered_multiset_mix((unsigned long) value ^ me->seed);
+    }
+    if (me->hash == containers_hash_key) {
+        return containers_hash_bytes_seeded(key, me->key_size, me->seed);
+    }
+    if (me->hash == containers_hash_string) {
+        const char *string;
+        memcpy(&string, key, sizeof(char *));
+        return containers_hash_bytes_seeded(string, strlen(string), me->seed);
+    }
+    hash = me->hash(key);
     hash ^= (hash >> 20UL) ^ (hash >> 12UL);
     return hash ^ (hash >> 7UL) ^ (hash >> 4UL);
 }
 
+/*
+ * Determines whether the stored hashes depend on the seed, which they do for
+ * the built-in hash functions. The hashes of a user-defined hash function do
+ * not, so only their buckets change with the seed.
+ */
+static int unordered_multiset_is_seeded(unordered_multiset me)
+{
+    return me->hash == containers_hash_int || me->hash == containers_hash_long
+           || me->hash == containers_hash_key
+           || me->hash == containers_hash_string;
+}
+
+/*
+ * Determines whether two keys are equal exactly when their bytes are equal.
+ */
+static int unordered_multiset_is_bytewise(unordered_multiset me)
+{
+    return CONTAINERS_COMPARE_IS_BYTEWISE(me->comparator, me->key_size);
+}
+
 /**
  * Initializes an unordered multi-set.
  *
  * @param key_size   the size of each key in the unordered multi-set; must be
  *                   positive
  * @param hash       the hash function which computes the hash from the key;
- *                   must not be NULL
+ *                   must not be NULL; may be one of the built-in hash functions
+ *                   from hash.h
  * @param comparator the comparator function which compares two keys; must not
- *                   be NULL
+ *                   be NULL; may be one of the built-in comparators from
+ *                   compare.h
  *
  * @return the newly-initialized unordered multi-set, or NULL if it was not
- *         successfully initialized due to either invalid input arguments or
- *         memory allocation error
+ *         successfully initialized due to invalid input arguments, memory
+ *         allocation error, or the random bytes of the operating system not
+ *         being readable
  */
 unordered_multiset
 unordered_multiset_init(const size_t key_size,
@@ -88,9 +188,22 @@ unordered_multiset_init(const size_t key_size,
     init->key_size = key_size;
     init->hash = hash;
     init->comparator = comparator;
+    init->bytewise_keys = unordered_multiset_is_bytewise(init);
     init->size = 0;
     init->used = 0;
     init->capacity = STARTING_BUCKETS;
+    init->max_load_factor = RESIZE_AT;
+    init->min_load_factor = 0;
+    init->migrate_step = 0;
+    init->migrate_index = 0;
+    init->old_capacity = 0;
+    init->old_buckets = NULL;
+    if (containers_hash_new_seed(&init->seed, init) != 0) {
+        free(init);
+        return NULL;
+    }
+    init->max_chain_length = 0;
+    init->reseeded = 0;
     init->buckets = calloc(STARTING_BUCKETS, sizeof(struct node *));
     if (!init->buckets) {
         free(init);
@@ -99,24 +212,70 @@ unordered_multiset_init(const size_t key_size,
     return init;
 }
 
+/*
+ * Gets the index of the bucket which holds the hash. The hash is mixed with the
+ * seed first, so that keys chosen to collide in the buckets of one unordered
+ * container are spread out in any other.
+ */
+static int unordered_multiset_index(unordered_multiset me,
+                                    const unsigned long hash,
+                                    const int capacity)
+{
+    const unsigned long mixed = unordered_multiset_mix(hash ^ me->seed);
+    return (int) (mixed % (unsigned long) capacity);
+}
+
 /*
  * Adds the specified node to the multi-set.
  */
 static void unordered_multiset_add_item(unordered_multiset me,
                                         struct node *const add)
 {
-    struct node *traverse;
-    const int index = (int) (add->hash % me->capacity);
-    add->next = NULL;
-    if (!me->buckets[index]) {
-        me->buckets[index] = add;
-        return;
+    const int index = unordered_multiset_index(me, add->hash, me->capacity);
+    add->next = me->buckets[index];
+    me->buckets[index] = add;
+}
+
+/*
+ * Gets the bucket which holds the nodes with the specified hash. While the
+ * nodes are being moved to the new buckets, the old buckets which have not
+ * been moved yet still hold their nodes.
+ */
+static struct node **unordered_multiset_bucket(unordered_multiset me,
+                                               const unsigned long hash)
+{
+    if (me->old_buckets) {
+        const int old_index =
+                unordered_multiset_index(me, hash, me->old_capacity);
+        if (old_index >= me->migrate_index) {
+            return &me->old_buckets[old_index];
+        }
     }
-    traverse = me->buckets[index];
-    while (traverse->next) {
-        traverse = traverse->next;
+    return &me->buckets[unordered_multiset_index(me, hash, me->capacity)];
+}
+
+/*
+ * Moves the nodes of up to count old buckets to the new buckets, and frees the
+ * old buckets once all of their nodes have been moved.
+ */
+static void unordered_multiset_migrate(unordered_multiset me, int count)
+{
+    while (me->old_buckets && count > 0) {
+        struct node *traverse = me->old_buckets[me->migrate_index];
+        while (traverse) {
+            struct node *const backup = traverse->next;
+            unordered_multiset_add_item(me, traverse);
+            traverse = backup;
+        }
+        me->migrate_index++;
+        count--;
+        if (me->migrate_index == me->old_capacity) {
+            free(me->old_buckets);
+            me->old_buckets = NULL;
+            me->old_capacity = 0;
+            me->migrate_index = 0;
+        }
     }
-    traverse->next = add;
 }
 
 /**
@@ -131,7 +290,9 @@ static void unordered_multiset_add_item(unordered_multiset me,
 int unordered_multiset_rehash(unordered_multiset me)
 {
     int i;
-    struct node **old_buckets = me->buckets;
+    struct node **old_buckets;
+    unordered_multiset_migrate(me, me->old_capacity);
+    old_buckets = me->buckets;
     me->buckets = calloc((size_t) me->capacity, sizeof(struct node *));
     if (!me->buckets) {
         me->buckets = old_buckets;
@@ -175,20 +336,28 @@ int unordered_multiset_is_empty(unordered_multiset me)
 }
 
 /*
- * Increases the size of the multi-set and redistributes the nodes.
+ * Changes the amount of buckets of the multi-set and redistributes the nodes.
  */
-static int unordered_multiset_resize(unordered_multiset me)
+static int unordered_multiset_resize(unordered_multiset me,
+                                     const int new_capacity)
 {
     int i;
     const int old_capacity = me->capacity;
-    const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
     struct node **old_buckets = me->buckets;
+    unordered_multiset_migrate(me, me->old_capacity);
     me->buckets = calloc((size_t) new_capacity, sizeof(struct node *));
     if (!me->buckets) {
         me->buckets = old_buckets;
         return -ENOMEM;
     }
     me->capacity = new_capacity;
+    me->reseeded = 0;
+    if (me->migrate_step > 0) {
+        me->old_buckets = old_buckets;
+        me->old_capacity = old_capacity;
+        me->migrate_index = 0;
+        return 0;
+    }
     for (i = 0; i < old_capacity; i++) {
         struct node *traverse = old_buckets[i];
         while (traverse) {
@@ -201,6 +370,225 @@ static int unordered_multiset_resize(unordered_multiset me)
     return 0;
 }
 
+/*
+ * Picks a new seed and redistributes the nodes if a chain has grown longer
+ * than the maximum chain length. This is done at most once between resizes,
+ * since a chain which is still too long after reseeding is made of equal
+ * hashes, which no seed can separate. The nodes are all moved at once, since
+ * the old buckets could not be located with the new seed. The hashes of the
+ * built-in hash functions depend on the seed, so they are computed again. If
+ * no seed can be generated, the chain is left as it is until the next resize.
+ */
+static void unordered_multiset_check_chain(unordered_multiset me,
+                                           const int length)
+{
+    const unsigned long old_seed = me->seed;
+    const int migrate_step = me->migrate_step;
+    unsigned long seed;
+    int rc;
+    if (me->max_chain_length == 0 || length <= me->max_chain_length
+        || me->reseeded) {
+        return;
+    }
+    if (containers_hash_new_seed(&seed, me) != 0) {
+        me->reseeded = 1;
+        return;
+    }
+    unordered_multiset_migrate(me, me->old_capacity);
+    me->seed = seed;
+    me->migrate_step = 0;
+    if (unordered_multiset_is_seeded(me)) {
+        rc = unordered_multiset_rehash(me);
+    } else {
+        rc = unordered_multiset_resize(me, me->capacity);
+    }
+    if (rc != 0) {
+        me->seed = old_seed;
+    }
+    me->migrate_step = migrate_step;
+    me->reseeded = 1;
+}
+
+/**
+ * Reserves enough buckets for the unordered multi-set to hold the specified
+ * amount of distinct keys without resizing. If more buckets than needed are
+ * already reserved, then the previous buckets will be kept.
+ *
+ * @param me   the unordered multi-set to reserve buckets for
+ * @param size the amount of distinct keys to reserve buckets for
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if size is negative or too large
+ */
+int unordered_multiset_reserve(unordered_multiset me, const int size)
+{
+    const double capacity = size / me->max_load_factor + 1;
+    if (size < 0 || capacity > INT_MAX) {
+        return -EINVAL;
+    }
+    if ((int) capacity <= me->capacity) {
+        return 0;
+    }
+    return unordered_multiset_resize(me, (int) capacity);
+}
+
+/**
+ * Sets the maximum load factor of the unordered multi-set, which is the ratio
+ * of distinct keys to buckets at which the buckets are resized. A lower maximum
+ * load factor makes lookups faster at the cost of memory. The default maximum
+ * load factor is 0.75. If the unordered multi-set already exceeds the new
+ * maximum load factor, its buckets are resized right away.
+ *
+ * @param me              the unordered multi-set to change
+ * @param max_load_factor the new maximum load factor; must be more than twice
+ *                        the minimum load factor, and thus positive
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the maximum load factor is out of range
+ */
+int unordered_multiset_set_max_load_factor(unordered_multiset me,
+                                           const double max_load_factor)
+{
+    const double old_max_load_factor = me->max_load_factor;
+    int rc;
+    if (!(max_load_factor > 2 * me->min_load_factor)) {
+        return -EINVAL;
+    }
+    me->max_load_factor = max_load_factor;
+    rc = unordered_multiset_reserve(me, me->used);
+    if (rc != 0) {
+        me->max_load_factor = old_max_load_factor;
+    }
+    return rc;
+}
+
+/**
+ * Sets the minimum load factor of the unordered multi-set, below which the
+ * buckets are shrunk when distinct keys are removed. The buckets are shrunk so
+ * that the load factor becomes half of the maximum load factor, which is why
+ * the minimum load factor must be less than that, so that the unordered multi-
+ * set does not shrink and grow back repeatedly. The default minimum load factor
+ * is zero, which means that the buckets are never shrunk automatically.
+ *
+ * @param me              the unordered multi-set to change
+ * @param min_load_factor the new minimum load factor; must not be negative,
+ *                        and must be less than half the maximum load factor
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the minimum load factor is out of range
+ */
+int unordered_multiset_set_min_load_factor(unordered_multiset me,
+                                           const double min_load_factor)
+{
+    if (!(min_load_factor >= 0 && 2 * min_load_factor < me->max_load_factor)) {
+        return -EINVAL;
+    }
+    me->min_load_factor = min_load_factor;
+    return 0;
+}
+
+/**
+ * Shrinks the buckets of the unordered multi-set to the smallest amount which
+ * holds its distinct keys without exceeding the maximum load factor. The
+ * unordered multi-set never has fewer than its starting amount of buckets.
+ *
+ * @param me the unordered multi-set to shrink
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int unordered_multiset_shrink_to_fit(unordered_multiset me)
+{
+    int capacity = (int) (me->used / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity >= me->capacity) {
+        return 0;
+    }
+    return unordered_multiset_resize(me, capacity);
+}
+
+/*
+ * Shrinks the buckets once the load factor drops below the minimum load factor,
+ * so that the load factor becomes half of the maximum load factor. Since the
+ * unordered multi-set has already been modified, running out of memory is
+ * ignored.
+ */
+static void unordered_multiset_auto_shrink(unordered_multiset me)
+{
+    int capacity;
+    if (me->used >= me->min_load_factor * me->capacity) {
+        return;
+    }
+    capacity = (int) (2 * me->used / me->max_load_factor) + 1;
+    if (capacity < STARTING_BUCKETS) {
+        capacity = STARTING_BUCKETS;
+    }
+    if (capacity < me->capacity) {
+        unordered_multiset_resize(me, capacity);
+    }
+}
+
+/**
+ * Sets whether the unordered multi-set resizes incrementally. By default, all
+ * the nodes are moved to the new buckets at once when the unordered multi-set
+ * resizes, so the operation which triggers the resize takes time proportional
+ * to the size of the unordered multi-set. When resizing incrementally, the old
+ * buckets are kept alongside the new buckets, and each subsequent put or remove
+ * moves the nodes of up to the specified amount of old buckets, which spreads
+ * the cost of the resize over many operations. If the nodes have not all been
+ * moved by the time the next resize is needed, the rest of them are moved at
+ * once, which does not happen at the default maximum load factor when at least
+ * three buckets are moved per step. Setting the amount to zero turns
+ * incremental resizing off and moves any remaining nodes.
+ *
+ * @param me               the unordered multi-set to change
+ * @param buckets_per_step the amount of old buckets to move per put or
+ *                         remove, or zero to move all the nodes at once
+ *
+ * @return 0       if no error
+ * @return -EINVAL if buckets_per_step is negative
+ */
+int unordered_multiset_set_incremental_resize(unordered_multiset me,
+                                              const int buckets_per_step)
+{
+    if (buckets_per_step < 0) {
+        return -EINVAL;
+    }
+    me->migrate_step = buckets_per_step;
+    if (buckets_per_step == 0) {
+        unordered_multiset_migrate(me, me->old_capacity);
+    }
+    return 0;
+}
+
+/**
+ * Sets the maximum length of a bucket chain. When adding a key makes its chain
+ * longer than this, the unordered multi-set picks a new random seed and
+ * redistributes its keys, which breaks up chains of keys chosen to collide.
+ * This is done at most once between resizes. The chain length guard is disabled
+ * by default, and is disabled again by a maximum chain length of zero.
+ *
+ * @param me               the unordered multi-set to change
+ * @param max_chain_length the maximum length of a chain, or zero to disable
+ *                         the chain length guard
+ *
+ * @return 0       if no error
+ * @return -EINVAL if the maximum chain length is negative
+ */
+int unordered_multiset_set_max_chain_length(unordered_multiset me,
+                                            const int max_chain_length)
+{
+    if (max_chain_length < 0) {
+        return -EINVAL;
+    }
+    me->max_chain_length = max_chain_length;
+    return 0;
+}
+
 /*
  * Determines if an element is equal to the key.
  */
@@ -209,7 +597,13 @@ static int unordered_multiset_is_equal(unordered_multiset me,
                                        const unsigned long hash,
                                        const void *const key)
 {
-    return item->hash == hash && me->comparator(item->key, key) == 0;
+    if (item->hash != hash) {
+        return 0;
+    }
+    if (me->bytewise_keys) {
+        return memcmp(item->key, key, me->key_size) == 0;
+    }
+    return me->comparator(item->key, key) == 0;
 }
 
 /*
@@ -251,21 +645,25 @@ static struct node *unordered_multiset_create_element(unordered_multiset me,
 int unordered_multiset_put(unordered_multiset me, void *const key)
 {
     const unsigned long hash = unordered_multiset_hash(me, key);
-    int index;
-    if (me->used + 1 >= RESIZE_AT * me->capacity) {
-        const int rc = unordered_multiset_resize(me);
+    struct node **bucket;
+    int length = 1;
+    unordered_multiset_migrate(me, me->migrate_step);
+    if (me->used + 1 >= me->max_load_factor * me->capacity) {
+        const int new_capacity = (int) (me->capacity * RESIZE_RATIO);
+        const int rc = unordered_multiset_resize(me, new_capacity);
         if (rc != 0) {
             return rc;
         }
     }
-    index = (int) (hash % me->capacity);
-    if (!me->buckets[index]) {
-        me->buckets[index] = unordered_multiset_create_element(me, hash, key);
-        if (!me->buckets[index]) {
+    bucket = unordered_multiset_bucket(me, hash);
+    if (!*bucket) {
+        *bucket = unordered_multiset_create_element(me, hash, key);
+        if (!*bucket) {
             return -ENOMEM;
         }
     } else {
-        struct node *traverse = me->buckets[index];
+        struct node *traverse = *bucket;
+        length++;
         if (unordered_multiset_is_equal(me, traverse, hash, key)) {
             traverse->count++;
             me->size++;
@@ -273,6 +671,7 @@ int unordered_multiset_put(unordered_multiset me, void *const key)
         }
         while (traverse->next) {
             traverse = traverse->next;
+            length++;
             if (unordered_multiset_is_equal(me, traverse, hash, key)) {
                 traverse->count++;
                 me->size++;
@@ -286,6 +685,7 @@ int unordered_multiset_put(unordered_multiset me, void *const key)
     }
     me->size++;
     me->used++;
+    unordered_multiset_check_chain(me, length);
     return 0;
 }
 
@@ -304,8 +704,7 @@ int unordered_multiset_put(unordered_multiset me, void *const key)
 int unordered_multiset_count(unordered_multiset me, void *const key)
 {
     const unsigned long hash = unordered_multiset_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    const struct node *traverse = me->buckets[index];
+    const struct node *traverse = *unordered_multiset_bucket(me, hash);
     while (traverse) {
         if (unordered_multiset_is_equal(me, traverse, hash, key)) {
             return traverse->count;
@@ -348,20 +747,23 @@ int unordered_multiset_remove(unordered_multiset me, void *const key)
 {
     struct node *traverse;
     const unsigned long hash = unordered_multiset_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    if (!me->buckets[index]) {
+    struct node **bucket;
+    unordered_multiset_migrate(me, me->migrate_step);
+    bucket = unordered_multiset_bucket(me, hash);
+    if (!*bucket) {
         return 0;
     }
-    traverse = me->buckets[index];
+    traverse = *bucket;
     if (unordered_multiset_is_equal(me, traverse, hash, key)) {
         traverse->count--;
         if (traverse->count == 0) {
-            me->buckets[index] = traverse->next;
+            *bucket = traverse->next;
             free(traverse->key);
             free(traverse);
             me->used--;
         }
         me->size--;
+        unordered_multiset_auto_shrink(me);
         return 1;
     }
     while (traverse->next) {
@@ -375,6 +777,7 @@ int unordered_multiset_remove(unordered_multiset me, void *const key)
                 me->used--;
             }
             me->size--;
+            unordered_multiset_auto_shrink(me);
             return 1;
         }
         traverse = traverse->next;
@@ -398,17 +801,20 @@ int unordered_multiset_remove_all(unordered_multiset me, void *const key)
 {
     struct node *traverse;
     const unsigned long hash = unordered_multiset_hash(me, key);
-    const int index = (int) (hash % me->capacity);
-    if (!me->buckets[index]) {
+    struct node **bucket;
+    unordered_multiset_migrate(me, me->migrate_step);
+    bucket = unordered_multiset_bucket(me, hash);
+    if (!*bucket) {
         return 0;
     }
-    traverse = me->buckets[index];
+    traverse = *bucket;
     if (unordered_multiset_is_equal(me, traverse, hash, key)) {
-        me->buckets[index] = traverse->next;
+        *bucket = traverse->next;
         me->size -= traverse->count;
         free(traverse->key);
         free(traverse);
         me->used--;
+        unordered_multiset_auto_shrink(me);
         return 1;
     }
     while (traverse->next) {
@@ -419,6 +825,7 @@ int unordered_multiset_remove_all(unordered_multiset me, void *const key)
             free(backup->key);
             free(backup);
             me->used--;
+            unordered_multiset_auto_shrink(me);
             return 1;
         }
         traverse = traverse->next;
@@ -426,6 +833,392 @@ int unordered_multiset_remove_all(unordered_multiset me, void *const key)
     return 0;
 }
 
+/*
+ * Moves the cursor to the first node in or after its bucket. The new buckets
+ * are scanned first, followed by the old buckets which have not been moved yet.
+ */
+static int
+unordered_multiset_cursor_seek(unordered_multiset me,
+                               struct unordered_multiset_cursor *const cursor)
+{
+    for (;;) {
+        struct node **buckets = me->buckets;
+        int capacity = me->capacity;
+        if (cursor->internal_table == 1) {
+            buckets = me->old_buckets;
+            capacity = me->old_capacity;
+        }
+        while (cursor->internal_bucket < capacity) {
+            if (buckets[cursor->internal_bucket]) {
+                cursor->internal_link = &buckets[cursor->internal_bucket];
+                return 1;
+            }
+            cursor->internal_bucket++;
+        }
+        if (cursor->internal_table == 1) {
+            cursor->internal_link = NULL;
+            return 0;
+        }
+        cursor->internal_table = 1;
+        cursor->internal_bucket = me->migrate_index;
+    }
+}
+
+/**
+ * Moves the cursor to the first distinct key of the unordered multi-set. The
+ * distinct keys are visited in the order in which they are stored rather than
+ * in any particular order. The cursor is owned by the caller, and remains valid
+ * until the unordered multi-set is modified other than through
+ * unordered_multiset_cursor_remove.
+ *
+ * @param me     the unordered multi-set to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a distinct key, otherwise 0 if the
+ *         unordered multi-set is empty
+ */
+int unordered_multiset_first(unordered_multiset me,
+                             struct unordered_multiset_cursor *const cursor)
+{
+    cursor->internal_table = 0;
+    cursor->internal_bucket = 0;
+    return unordered_multiset_cursor_seek(me, cursor);
+}
+
+/**
+ * Moves the cursor to the next distinct key of the unordered multi-set.
+ *
+ * @param me     the unordered multi-set to iterate over
+ * @param cursor the cursor to move
+ *
+ * @return 1 if the cursor is at a distinct key, otherwise 0 if there are
+ *         no more distinct keys
+ */
+int unordered_multiset_next(unordered_multiset me,
+                            struct unordered_multiset_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    if (!link) {
+        return 0;
+    }
+    cursor->internal_link = &(*link)->next;
+    if ((*link)->next) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multiset_cursor_seek(me, cursor);
+}
+
+/**
+ * Copies the key at the cursor, and gets the amount of times that it occurs.
+ *
+ * @param key    the key to copy to
+ * @param me     the unordered multi-set being iterated over
+ * @param cursor the cursor to get from
+ *
+ * @return the count of the key, or 0 if the cursor was not at a key
+ */
+int
+unordered_multiset_cursor_get(void *const key,
+                              unordered_multiset me,
+                              const struct unordered_multiset_cursor *cursor)
+{
+    const struct node *item;
+    if (!cursor->internal_link) {
+        return 0;
+    }
+    item = *(struct node **) cursor->internal_link;
+    memcpy(key, item->key, me->key_size);
+    return item->count;
+}
+
+/**
+ * Removes every occurrence of the key at the cursor from the unordered multi-
+ * set, and moves the cursor to the next distinct key. Removing through the
+ * cursor never resizes the buckets, so the cursor remains valid.
+ *
+ * @param me     the unordered multi-set to remove from
+ * @param cursor the cursor to remove at
+ *
+ * @return 1 if the cursor is at a distinct key after the removal, otherwise 0
+ */
+int
+unordered_multiset_cursor_remove(unordered_multiset me,
+                                 struct unordered_multiset_cursor *const cursor)
+{
+    struct node **const link = cursor->internal_link;
+    struct node *item;
+    if (!link) {
+        return 0;
+    }
+    item = *link;
+    *link = item->next;
+    me->size -= item->count;
+    free(item->key);
+    free(item);
+    me->used--;
+    if (*link) {
+        return 1;
+    }
+    cursor->internal_bucket++;
+    return unordered_multiset_cursor_seek(me, cursor);
+}
+
+#ifdef CONTAINERS_HAS_FD
+
+/*
+ * Writes the whole buffer to the file descriptor, retrying partial writes.
+ */
+static int unordered_multiset_write_all(const int fd,
+                                        const void *const data,
+                                        size_t size)
+{
+    const char *position = data;
+    while (size > 0) {
+        const ssize_t written = write(fd, position, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -EIO;
+        }
+        position += written;
+        size -= (size_t) written;
+    }
+    return 0;
+}
+
+/*
+ * Fills the whole buffer from the file descriptor, retrying partial reads.
+ */
+static int unordered_multiset_read_all(const int fd,
+                                       void *const data,
+                                       size_t size)
+{
+    char *position = data;
+    while (size > 0) {
+        const ssize_t got = read(fd, position, size);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return -EIO;
+        }
+        position += got;
+        size -= (size_t) got;
+    }
+    return 0;
+}
+
+/*
+ * Grows the buckets while a snapshot is loaded, once the keys which have been
+ * read so far would not fit. The buckets are sized for twice as many, up to the
+ * count of the header, so that a whole snapshot takes few resizes, while a
+ * corrupt count cannot reserve more buckets than the snapshot has keys.
+ */
+static int unordered_multiset_load_reserve(unordered_multiset me,
+                                           const unsigned long needed,
+                                           const unsigned long count)
+{
+    unsigned long size = 2 * needed;
+    if (needed / me->max_load_factor + 1 <= me->capacity) {
+        return 0;
+    }
+    if (size > count) {
+        size = count;
+    }
+    return unordered_multiset_reserve(me, (int) size);
+}
+
+#endif
+
+/**
+ * Writes a binary snapshot of the unordered multi-set to a file descriptor. The
+ * snapshot consists of a header, which holds the key size and the amount of
+ * distinct keys, followed by the stored hash, the count, and the key of each
+ * distinct key. The hash seed is not written, so that it never leaves the
+ * process. Thus, loading the snapshot hashes the keys again if they use a
+ * built-in hash function. Since the keys are copied byte for byte, they should
+ * not contain pointers unless the snapshot is loaded by the same process.
+ *
+ * @param me the unordered multi-set to save
+ * @param fd the file descriptor to write to
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EIO    if the snapshot could not be written
+ */
+int unordered_multiset_save(unordered_multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size = 2 * sizeof(unsigned long) + me->key_size;
+    size_t buffer_size = SNAPSHOT_BUFFER_SIZE;
+    size_t used = 0;
+    unsigned long count;
+    char *buffer;
+    int rc;
+    int i;
+    unordered_multiset_migrate(me, me->old_capacity);
+    if (record_size > buffer_size) {
+        buffer_size = record_size;
+    }
+    buffer = malloc(buffer_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    memset(&header, 0, sizeof(struct snapshot_header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.key_size = (unsigned long) me->key_size;
+    header.value_size = 0;
+    header.count = (unsigned long) me->used;
+    rc = unordered_multiset_write_all(fd, &header,
+                                      sizeof(struct snapshot_header));
+    for (i = 0; rc == 0 && i < me->capacity; i++) {
+        const struct node *traverse = me->buckets[i];
+        while (rc == 0 && traverse) {
+            if (used + record_size > buffer_size) {
+                rc = unordered_multiset_write_all(fd, buffer, used);
+                used = 0;
+            }
+            memcpy(buffer + used, &traverse->hash, sizeof(unsigned long));
+            used += sizeof(unsigned long);
+            count = (unsigned long) traverse->count;
+            memcpy(buffer + used, &count, sizeof(unsigned long));
+            used += sizeof(unsigned long);
+            memcpy(buffer + used, traverse->key, me->key_size);
+            used += me->key_size;
+            traverse = traverse->next;
+        }
+    }
+    if (rc == 0) {
+        rc = unordered_multiset_write_all(fd, buffer, used);
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
+/**
+ * Loads a binary snapshot which was written by unordered_multiset_save into an
+ * empty unordered multi-set. The comparator is never called, since the keys of
+ * a snapshot are already distinct. The seed is not in the snapshot, so a fresh
+ * seed is picked. The stored hashes of a user-defined hash function do not
+ * depend on the seed, so they are reused without calling it. The built-in hash
+ * functions do depend on the seed, so each key is hashed again with the fresh
+ * seed. The buckets grow as the keys are read, rather than being sized from the
+ * count in the header, so that a corrupt count cannot reserve more buckets than
+ * the snapshot holds. Thus, the unordered multi-set must have been initialized
+ * with the same key size and hash function as the unordered multi-set which was
+ * saved. If an error occurs part of the way through the snapshot, the keys
+ * which have already been loaded remain in the unordered multi-set.
+ *
+ * @param me the unordered multi-set to load into
+ * @param fd the file descriptor to read from
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the unordered multi-set is not empty or the
+ *                 snapshot does not match the unordered multi-set
+ * @return -EIO    if the snapshot or the random bytes of the operating system
+ *                 could not be read
+ */
+int unordered_multiset_load(unordered_multiset me, const int fd)
+{
+#ifdef CONTAINERS_HAS_FD
+    struct snapshot_header header;
+    const size_t record_size = 2 * sizeof(unsigned long) + me->key_size;
+    size_t batch_size = SNAPSHOT_BUFFER_SIZE / record_size;
+    unsigned long remaining;
+    char *buffer;
+    int rc;
+    if (me->size != 0) {
+        return -EINVAL;
+    }
+    rc = unordered_multiset_read_all(fd, &header,
+                                     sizeof(struct snapshot_header));
+    if (rc != 0) {
+        return rc;
+    }
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION
+        || header.key_size != (unsigned long) me->key_size
+        || header.value_size != 0
+        || header.count > INT_MAX) {
+        return -EINVAL;
+    }
+    rc = containers_hash_new_seed(&me->seed, me);
+    if (rc != 0) {
+        return rc;
+    }
+    if (batch_size == 0) {
+        batch_size = 1;
+    }
+    buffer = malloc(batch_size * record_size);
+    if (!buffer) {
+        return -ENOMEM;
+    }
+    remaining = header.count;
+    while (remaining > 0) {
+        const char *record = buffer;
+        size_t batch = batch_size;
+        if (batch > remaining) {
+            batch = remaining;
+        }
+        rc = unordered_multiset_read_all(fd, buffer, batch * record_size);
+        if (rc != 0) {
+            break;
+        }
+        remaining -= batch;
+        rc = unordered_multiset_load_reserve(me, me->used + batch,
+                                             header.count);
+        if (rc != 0) {
+            break;
+        }
+        for (; batch > 0; batch--) {
+            const char *const key = record + 2 * sizeof(unsigned long);
+            unsigned long hash;
+            unsigned long count;
+            struct node *add;
+            struct node **bucket;
+            memcpy(&hash, record, sizeof(unsigned long));
+            if (unordered_multiset_is_seeded(me)) {
+                hash = unordered_multiset_hash(me, key);
+            }
+            memcpy(&count, record + sizeof(unsigned long),
+                   sizeof(unsigned long));
+            if (count == 0 || count > (unsigned long) (INT_MAX - me->size)) {
+                free(buffer);
+                return -EINVAL;
+            }
+            add = unordered_multiset_create_element(me, hash, key);
+            if (!add) {
+                free(buffer);
+                return -ENOMEM;
+            }
+            add->count = (int) count;
+            bucket = unordered_multiset_bucket(me, hash);
+            add->next = *bucket;
+            *bucket = add;
+            me->size += add->count;
+            me->used++;
+            record += record_size;
+        }
+    }
+    free(buffer);
+    return rc;
+#else
+    (void) me;
+    (void) fd;
+    return -EIO;
+#endif
+}
+
 /**
  * Clears the keys from the unordered multi-set.
  *
@@ -442,6 +1235,7 @@ int unordered_multiset_clear(unordered_multiset me)
     if (!temp) {
         return -ENOMEM;
     }
+    unordered_multiset_migrate(me, me->old_capacity);
     for (i = 0; i < me->capacity; i++) {
         struct node *traverse = me->buckets[i];
         while (traverse) {
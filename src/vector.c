@@ -20,18 +20,83 @@
  * SOFTWARE.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "include/vector.h"
+#include "include/sort.h"
+#include "include/search.h"
+#include "include/compare.h"
+#include "include/compare_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONTAINERS_HAS_MMAP
+#define CONTAINERS_HAS_THREADS
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
 
 static const int START_SPACE = 8;
 static const double RESIZE_RATIO = 1.5;
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const size_t HEADER_SIZE = 64;
+static const char MAPPED_MAGIC[8] = "CNTRDATA";
+static const int PARALLEL_SORT_SIZE = 65536;
 
 struct internal_vector {
     size_t bytes_per_item;
     int item_count;
     int item_capacity;
     void *data;
+    int flags;
+    size_t mapped_size;
+    size_t map_offset;
+    int fd;
+};
+
+/*
+ * The header at the start of a mapped file. The data follows the header, at
+ * an offset of HEADER_SIZE bytes from the start of the file.
+ */
+struct mapped_header {
+    char magic[8];
+    unsigned long data_size;
+    unsigned long item_count;
+};
+
+/*
+ * The state of a parallel sort which is shared between the threads. The runs
+ * lie between consecutive bounds, and each merge phase merges them in pairs
+ * from one buffer into the other.
+ */
+struct parallel_sort {
+    char *from;
+    char *to;
+    size_t size;
+    int (*comparator)(const void *const one, const void *const two);
+    int count;
+    int thread_count;
+    int run_count;
+    int *bounds;
+};
+
+/*
+ * The part of a parallel sort which one thread does.
+ */
+struct parallel_task {
+    struct parallel_sort *sort;
+    int index;
 };
 
 /**
@@ -56,6 +121,10 @@ vector vector_init(const size_t data_size)
     init->bytes_per_item = data_size;
     init->item_count = 0;
     init->item_capacity = START_SPACE;
+    init->flags = 0;
+    init->mapped_size = 0;
+    init->map_offset = 0;
+    init->fd = -1;
     init->data = malloc(init->item_capacity * init->bytes_per_item);
     if (!init->data) {
         free(init);
@@ -64,6 +133,247 @@ vector vector_init(const size_t data_size)
     return init;
 }
 
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Rounds the amount of bytes up to the granularity of the mapping, which is
+ * the huge page size if huge pages were requested, otherwise the page size.
+ */
+static size_t vector_map_round(vector me, size_t size)
+{
+    size_t granularity = (size_t) sysconf(_SC_PAGESIZE);
+    if (me->flags & VECTOR_HUGE_PAGES) {
+        granularity = HUGE_PAGE_SIZE;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+/*
+ * Advises the kernel to back the mapping with transparent huge pages if the
+ * vector requested it.
+ */
+static void vector_map_advise(vector me)
+{
+#ifdef MADV_HUGEPAGE
+    if (me->flags & VECTOR_HUGE_PAGES) {
+        madvise((char *) me->data - me->map_offset, me->mapped_size,
+                MADV_HUGEPAGE);
+    }
+#else
+    (void) me;
+#endif
+}
+
+/*
+ * Sets the capacity based on how many items fit in the mapping.
+ */
+static void vector_map_capacity(vector me)
+{
+    const size_t capacity =
+            (me->mapped_size - me->map_offset) / me->bytes_per_item;
+    me->item_capacity = capacity > INT_MAX ? INT_MAX : (int) capacity;
+}
+
+/*
+ * Maps the file which is open as fd, and either validates its header or, if
+ * the file has just been created, writes the header. The item count of the
+ * header is rejected with -EINVAL if it does not fit in an int, or if it is
+ * larger than the capacity of the file.
+ */
+static int vector_map_file(vector me, const int fd, const int is_new)
+{
+    struct mapped_header *header;
+    const int is_read_only = me->flags & VECTOR_READ_ONLY;
+    void *const base = mmap(NULL, me->mapped_size, PROT_READ | PROT_WRITE,
+                            is_read_only ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    me->data = (char *) base + me->map_offset;
+    vector_map_capacity(me);
+    header = base;
+    if (is_new) {
+        memcpy(header->magic, MAPPED_MAGIC, sizeof(header->magic));
+        header->data_size = me->bytes_per_item;
+        header->item_count = 0;
+    } else if (memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) != 0
+               || header->data_size != me->bytes_per_item
+               || header->item_count > INT_MAX
+               || header->item_count > (unsigned long) me->item_capacity) {
+        munmap(base, me->mapped_size);
+        return -EINVAL;
+    }
+    me->item_count = (int) header->item_count;
+    vector_map_advise(me);
+    return 0;
+}
+
+/*
+ * Opens the file at path, creating it if requested, and maps it.
+ */
+static int vector_open_file(vector me, const char *const path)
+{
+    struct stat info;
+    int is_new = 0;
+    int mode = O_RDWR;
+    int rc;
+    int fd;
+    if (me->flags & VECTOR_READ_ONLY) {
+        mode = O_RDONLY;
+    } else if (me->flags & VECTOR_CREATE) {
+        mode |= O_CREAT;
+    }
+    fd = open(path, mode, 0644);
+    if (fd == -1) {
+        return -EIO;
+    }
+    if (fstat(fd, &info) == -1) {
+        close(fd);
+        return -EIO;
+    }
+    me->mapped_size = (size_t) info.st_size;
+    if (me->mapped_size == 0 && (me->flags & VECTOR_CREATE)
+        && !(me->flags & VECTOR_READ_ONLY)) {
+        is_new = 1;
+        me->mapped_size = vector_map_round(me, me->map_offset
+                                               + START_SPACE
+                                                 * me->bytes_per_item);
+        if (ftruncate(fd, (off_t) me->mapped_size) == -1) {
+            close(fd);
+            return -ENOMEM;
+        }
+    }
+    rc = -EINVAL;
+    if (me->mapped_size >= me->map_offset) {
+        rc = vector_map_file(me, fd, is_new);
+    }
+    if (rc != 0) {
+        close(fd);
+        return rc;
+    }
+    if (me->flags & VECTOR_READ_ONLY) {
+        close(fd);
+    } else {
+        me->fd = fd;
+    }
+    return 0;
+}
+
+#endif
+
+/**
+ * Initializes a vector which stores its data in an anonymous memory mapping
+ * rather than on the heap. The mapping grows and shrinks by remapping its pages
+ * rather than by copying the data, which makes it suitable for vectors which
+ * are several gigabytes in size. If VECTOR_HUGE_PAGES is specified in the
+ * flags, the mapping is sized in multiples of the huge page size and the
+ * kernel is advised to back it with transparent huge pages, which reduces TLB
+ * pressure when scanning the data. On platforms without memory mappings, the
+ * vector is stored on the heap instead.
+ *
+ * @param data_size the size of each element in the vector; must be positive
+ * @param flags     either 0 or VECTOR_HUGE_PAGES
+ *
+ * @return the newly-initialized vector, or NULL if it was not successfully
+ *         initialized due to either invalid input arguments or memory
+ *         allocation error
+ */
+vector vector_init_mapped(const size_t data_size, const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_vector *init;
+    if (data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_vector));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->item_count = 0;
+    init->flags = flags;
+    init->map_offset = 0;
+    init->fd = -1;
+    init->mapped_size = vector_map_round(init, START_SPACE * data_size);
+    init->data = mmap(NULL, init->mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (init->data == MAP_FAILED) {
+        free(init);
+        return NULL;
+    }
+    vector_map_capacity(init);
+    vector_map_advise(init);
+    return init;
+#else
+    (void) flags;
+    return vector_init(data_size);
+#endif
+}
+
+/**
+ * Opens a vector which is backed by the file at the specified path. The file
+ * is memory-mapped, so opening a prebuilt file takes constant time regardless
+ * of its size, and the data is neither parsed nor copied. The file starts with
+ * a small header which records the size of each element and the amount of
+ * elements, followed by the contiguous elements.
+ *
+ * By default, the file is mapped as shared and writable, thus modifications to
+ * the vector are written to the file, and the file grows as the vector grows.
+ * If VECTOR_READ_ONLY is specified in the flags, the file is opened as
+ * read-only and its pages are shared with every other process which maps the
+ * file. Modifications to a read-only vector are private to it and are never
+ * written to the file. If VECTOR_CREATE is specified in the flags, the file is
+ * created if it does not exist yet. If VECTOR_HUGE_PAGES is specified in the
+ * flags, the kernel is advised to back the mapping with huge pages.
+ *
+ * The file stores the raw bytes of the elements, thus it should only be opened
+ * on a machine with the same data representation as the one it was written on.
+ *
+ * @param path      the path of the file to back the vector with
+ * @param data_size the size of each element in the vector; must be positive
+ *                  and must match the element size which the file was created
+ *                  with
+ * @param flags     a combination of VECTOR_READ_ONLY, VECTOR_CREATE and
+ *                  VECTOR_HUGE_PAGES
+ *
+ * @return the newly-opened vector, or NULL if it was not successfully opened
+ *         due to either invalid input arguments, the file not being a valid
+ *         vector file, an error opening or mapping the file, or memory
+ *         allocation error
+ */
+vector vector_open_mapped(const char *const path,
+                          const size_t data_size,
+                          const int flags)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct internal_vector *init;
+    if (!path || data_size == 0) {
+        return NULL;
+    }
+    init = malloc(sizeof(struct internal_vector));
+    if (!init) {
+        return NULL;
+    }
+    init->bytes_per_item = data_size;
+    init->flags = flags;
+    init->map_offset = HEADER_SIZE;
+    init->fd = -1;
+    if (vector_open_file(init, path) != 0) {
+        free(init);
+        return NULL;
+    }
+    return init;
+#else
+    (void) path;
+    (void) data_size;
+    (void) flags;
+    return NULL;
+#endif
+}
+
 /**
  * Gets the size being used by the vector.
  *
@@ -100,13 +410,138 @@ int vector_is_empty(vector me)
     return vector_size(me) == 0;
 }
 
+#ifdef CONTAINERS_HAS_MMAP
+
+/*
+ * Sets the space of a file-backed buffer by resizing the file and remapping
+ * it. The data is never copied since it lives in the file.
+ */
+static int vector_set_file_space(vector me, const int size)
+{
+    char *const base = (char *) me->data - me->map_offset;
+    const size_t new_size =
+            vector_map_round(me, me->map_offset + size * me->bytes_per_item);
+    void *temp;
+    if (new_size == me->mapped_size) {
+        return 0;
+    }
+    if (new_size > me->mapped_size
+        && ftruncate(me->fd, (off_t) new_size) == -1) {
+        return -ENOMEM;
+    }
+#ifdef MREMAP_MAYMOVE
+    temp = mremap(base, me->mapped_size, new_size, MREMAP_MAYMOVE);
+#else
+    temp = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, me->fd, 0);
+    if (temp != MAP_FAILED) {
+        munmap(base, me->mapped_size);
+    }
+#endif
+    /*
+     * Truncating the file back after a failed remap, or down after a shrink,
+     * only gives back space. If it fails, the file is left larger than the
+     * mapping, which is harmless: the header holds the count, and the extra
+     * space is reused by the next resize or open.
+     */
+    if (temp == MAP_FAILED) {
+        if (new_size > me->mapped_size) {
+            (void) ftruncate(me->fd, (off_t) me->mapped_size);
+        }
+        return -ENOMEM;
+    }
+    if (new_size < me->mapped_size) {
+        (void) ftruncate(me->fd, (off_t) new_size);
+    }
+    me->data = (char *) temp + me->map_offset;
+    me->mapped_size = new_size;
+    vector_map_capacity(me);
+    vector_map_advise(me);
+    return 0;
+}
+
+/*
+ * Moves the data of a read-only file-backed buffer into an anonymous mapping,
+ * since a private file mapping cannot grow past the end of the file.
+ */
+static int vector_detach_file_space(vector me, const int size)
+{
+    char *const base = (char *) me->data - me->map_offset;
+    const size_t old_size = me->mapped_size;
+    const size_t new_size = vector_map_round(me, size * me->bytes_per_item);
+    void *const temp = mmap(NULL, new_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (temp == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    memcpy(temp, me->data, me->item_count * me->bytes_per_item);
+    munmap(base, old_size);
+    me->data = temp;
+    me->mapped_size = new_size;
+    me->map_offset = 0;
+    vector_map_capacity(me);
+    vector_map_advise(me);
+    return 0;
+}
+
+/*
+ * Sets the space of a mapped buffer. The pages are remapped rather than copied
+ * when the platform supports it, and shrinking only releases the tail pages.
+ */
+static int vector_set_mapped_space(vector me, const int size)
+{
+    const size_t new_size = vector_map_round(me, size * me->bytes_per_item);
+    void *temp;
+    if (new_size == me->mapped_size) {
+        return 0;
+    }
+#ifdef MREMAP_MAYMOVE
+    temp = mremap(me->data, me->mapped_size, new_size, MREMAP_MAYMOVE);
+    if (temp == MAP_FAILED) {
+        return -ENOMEM;
+    }
+#else
+    if (new_size < me->mapped_size) {
+        munmap((char *) me->data + new_size, me->mapped_size - new_size);
+        me->mapped_size = new_size;
+        vector_map_capacity(me);
+        return 0;
+    }
+    temp = mmap(NULL, new_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (temp == MAP_FAILED) {
+        return -ENOMEM;
+    }
+    memcpy(temp, me->data, me->item_count * me->bytes_per_item);
+    munmap(me->data, me->mapped_size);
+#endif
+    me->data = temp;
+    me->mapped_size = new_size;
+    vector_map_capacity(me);
+    vector_map_advise(me);
+    return 0;
+}
+
+#endif
+
 /*
  * Sets the space of the buffer. Assumes that size is at least the same as the
  * number of items currently in the vector.
  */
 static int vector_set_space(vector me, const int size)
 {
-    void *const temp = realloc(me->data, size * me->bytes_per_item);
+    void *temp;
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->map_offset && me->fd != -1) {
+        return vector_set_file_space(me, size);
+    }
+    if (me->map_offset) {
+        return vector_detach_file_space(me, size);
+    }
+    if (me->mapped_size) {
+        return vector_set_mapped_space(me, size);
+    }
+#endif
+    temp = realloc(me->data, size * me->bytes_per_item);
     if (!temp) {
         return -ENOMEM;
     }
@@ -146,6 +581,35 @@ int vector_trim(vector me)
     return vector_set_space(me, me->item_count);
 }
 
+/**
+ * Writes the elements of a file-backed vector to its file, and waits for the
+ * write to complete. The amount of elements is recorded in the file when the
+ * vector is synchronized or destroyed. For vectors which are not backed by a
+ * file, or which were opened as read-only, this has no effect.
+ *
+ * @param me the vector to synchronize
+ *
+ * @return 0    if no error
+ * @return -EIO if the file could not be written
+ */
+int vector_sync(vector me)
+{
+#ifdef CONTAINERS_HAS_MMAP
+    struct mapped_header *header;
+    if (!me->map_offset || me->fd == -1) {
+        return 0;
+    }
+    header = (struct mapped_header *) ((char *) me->data - me->map_offset);
+    header->item_count = (unsigned long) me->item_count;
+    if (msync(header, me->mapped_size, MS_SYNC) == -1) {
+        return -EIO;
+    }
+#else
+    (void) me;
+#endif
+    return 0;
+}
+
 /**
  * Copies the vector to an array. Since it is a copy, the array may be modified
  * without causing side effects to the vector data structure. Memory is not
@@ -182,6 +646,341 @@ void *vector_get_data(vector me)
     return me->data;
 }
 
+/**
+ * Sorts the elements of the vector in ascending order according to the
+ * comparator. The built-in scalar comparators from compare.h select a radix
+ * sort when they match the element size, and any other comparator is used by
+ * an introsort. The sort is not stable.
+ *
+ * @param me         the vector to sort
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ */
+void vector_sort(vector me,
+                 int (*const comparator)(const void *const one,
+                                         const void *const two))
+{
+    containers_sort(me->data, me->item_count, me->bytes_per_item, comparator);
+}
+
+/**
+ * Gets the index of the first element of the vector which is not less than the
+ * key, which is the size of the vector if there is no such element. The vector
+ * must be sorted in ascending order according to the comparator. The search
+ * is branchless, so it does not suffer branch mispredictions.
+ *
+ * @param me         the vector to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the first element which is not less than the key
+ */
+int vector_lower_bound(vector me,
+                       void *const key,
+                       int (*const comparator)(const void *const one,
+                                               const void *const two))
+{
+    return containers_lower_bound(me->data, me->item_count, me->bytes_per_item,
+                                  key, comparator);
+}
+
+/**
+ * Rearranges the elements of the vector, which must be sorted in ascending
+ * order, into Eytzinger order. This is the breadth-first order of an implicit
+ * binary search tree, which makes searches of large vectors cache-friendly. The
+ * vector is no longer sorted afterwards, and must be searched with
+ * vector_eytzinger_lower_bound.
+ *
+ * @param me the vector to rearrange
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ */
+int vector_eytzinger_layout(vector me)
+{
+    return containers_eytzinger_layout(me->data, me->item_count,
+                                       me->bytes_per_item);
+}
+
+/**
+ * Gets the index of the smallest element of the vector which is not less than
+ * the key, which is the size of the vector if there is no such element. The
+ * vector must have been rearranged with vector_eytzinger_layout. The search
+ * prefetches the elements it visits a few steps ahead, so on vectors far larger
+ * than the cache it is much faster than vector_lower_bound.
+ *
+ * @param me         the vector to search
+ * @param key        the key to search for
+ * @param comparator the comparator function which compares two elements; may
+ *                   be one of the built-in comparators from compare.h
+ *
+ * @return the index of the smallest element which is not less than the key
+ */
+int vector_eytzinger_lower_bound(vector me,
+                                 void *const key,
+                                 int (*const comparator)(const void *const one,
+                                                         const void *const two))
+{
+    return containers_eytzinger_lower_bound(me->data, me->item_count,
+                                            me->bytes_per_item, key,
+                                            comparator);
+}
+
+#ifdef CONTAINERS_HAS_THREADS
+
+/*
+ * Gets the start of the part with the specified index, when the elements are
+ * split into the specified amount of parts which differ in size by at most one.
+ */
+static int vector_part_start(const int count, const int parts, const int index)
+{
+    const int remainder = count % parts;
+    return index * (count / parts) + (index < remainder ? index : remainder);
+}
+
+/*
+ * Compares two elements of a parallel sort.
+ */
+static int vector_merge_compare(const struct parallel_sort *const sort,
+                                const void *const one,
+                                const void *const two)
+{
+    return CONTAINERS_COMPARE(sort->comparator, sort->size, one, two);
+}
+
+/*
+ * Finds how many of the first k merged elements come from the first run, so
+ * that a merge can be split at any position. Elements of the first run come
+ * before equal elements of the second run.
+ */
+static int vector_merge_split(const struct parallel_sort *const sort,
+                              const char *const one,
+                              const int one_count,
+                              const char *const two,
+                              const int two_count,
+                              const int k)
+{
+    const size_t size = sort->size;
+    int low = k > two_count ? k - two_count : 0;
+    int high = k < one_count ? k : one_count;
+    while (low < high) {
+        const int i = low + (high - low) / 2;
+        if (vector_merge_compare(sort, one + i * size,
+                                 two + (k - i - 1) * size) <= 0) {
+            low = i + 1;
+        } else {
+            high = i;
+        }
+    }
+    return low;
+}
+
+/*
+ * Merges the elements of a range of the output of a pair of runs.
+ */
+static void vector_merge_range(const struct parallel_sort *const sort,
+                               const int pair,
+                               const int low,
+                               const int high)
+{
+    const size_t size = sort->size;
+    const int start = sort->bounds[2 * pair];
+    const int middle = sort->bounds[2 * pair + 1];
+    const int end = 2 * pair + 2 <= sort->run_count
+                    ? sort->bounds[2 * pair + 2] : middle;
+    const char *const one = sort->from + start * size;
+    const char *const two = sort->from + middle * size;
+    const int one_start = vector_merge_split(sort, one, middle - start, two,
+                                             end - middle, low - start);
+    const int one_end = vector_merge_split(sort, one, middle - start, two,
+                                           end - middle, high - start);
+    const char *first = one + one_start * size;
+    const char *const first_end = one + one_end * size;
+    const char *second = two + (low - start - one_start) * size;
+    const char *const second_end = two + (high - start - one_end) * size;
+    char *out = sort->to + low * size;
+    while (first < first_end && second < second_end) {
+        if (vector_merge_compare(sort, second, first) < 0) {
+            memcpy(out, second, size);
+            second += size;
+        } else {
+            memcpy(out, first, size);
+            first += size;
+        }
+        out += size;
+    }
+    memcpy(out, first, first_end - first);
+    out += first_end - first;
+    memcpy(out, second, second_end - second);
+}
+
+/*
+ * Does the part of the current phase of the sort which belongs to a thread.
+ * In the first phase, each thread sorts its own run. In each merge phase, the
+ * output is split evenly between the threads, and each thread merges the part
+ * of each pair of runs which falls within its share of the output.
+ */
+static void *vector_parallel_sort_task(void *const argument)
+{
+    const struct parallel_task *const task = argument;
+    const struct parallel_sort *const sort = task->sort;
+    const int low = vector_part_start(sort->count, sort->thread_count,
+                                      task->index);
+    const int high = vector_part_start(sort->count, sort->thread_count,
+                                       task->index + 1);
+    int pair;
+    if (!sort->to) {
+        containers_sort(sort->from + low * sort->size, high - low, sort->size,
+                        sort->comparator);
+        return NULL;
+    }
+    for (pair = 0; 2 * pair < sort->run_count; pair++) {
+        const int start = sort->bounds[2 * pair];
+        const int end = sort->bounds[2 * pair + 2 <= sort->run_count
+                                     ? 2 * pair + 2 : sort->run_count];
+        if (start < high && end > low) {
+            vector_merge_range(sort, pair, start > low ? start : low,
+                               end < high ? end : high);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Runs the current phase of the sort on all the threads, where the calling
+ * thread does the first part. If a thread cannot be created, the calling
+ * thread does its part as well.
+ */
+static void vector_parallel_sort_phase(struct parallel_sort *const sort,
+                                       struct parallel_task *const tasks,
+                                       pthread_t *const threads,
+                                       char *const started)
+{
+    int i;
+    for (i = 1; i < sort->thread_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL,
+                                    vector_parallel_sort_task, &tasks[i]) == 0;
+        if (!started[i]) {
+            vector_parallel_sort_task(&tasks[i]);
+        }
+    }
+    vector_parallel_sort_task(&tasks[0]);
+    for (i = 1; i < sort->thread_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+#endif
+
+/**
+ * Sorts the elements of the vector in ascending order according to the
+ * comparator, using multiple threads. The vector is split into a run per
+ * thread, each thread sorts its run as vector_sort does, and then the runs are
+ * merged in pairs until one is left. Each merge is split evenly between all the
+ * threads by output position, so that all of them are busy in every merge
+ * phase. Thus, the comparator is called from multiple threads at the same time.
+ * Fewer threads are used when each would get only a small amount of elements,
+ * and a single thread is used on platforms without POSIX threads. The sort is
+ * not stable.
+ *
+ * @param me           the vector to sort
+ * @param comparator   the comparator function which compares two elements;
+ *                     must be safe to call from multiple threads at once
+ * @param thread_count the amount of threads to use, or zero to use one per
+ *                     online processor
+ *
+ * @return 0       if no error
+ * @return -ENOMEM if out of memory
+ * @return -EINVAL if the thread count is negative
+ */
+int vector_parallel_sort(vector me,
+                         int (*const comparator)(const void *const one,
+                                                 const void *const two),
+                         int thread_count)
+{
+#ifdef CONTAINERS_HAS_THREADS
+    struct parallel_sort sort;
+    struct parallel_task *tasks;
+    pthread_t *threads;
+    char *started;
+    char *temp;
+    int i;
+    if (thread_count < 0) {
+        return -EINVAL;
+    }
+    if (thread_count == 0) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = processors > 0 && processors < INT_MAX
+                       ? (int) processors : 1;
+    }
+    if (thread_count > me->item_count / PARALLEL_SORT_SIZE) {
+        thread_count = me->item_count / PARALLEL_SORT_SIZE;
+    }
+    if (thread_count <= 1) {
+        vector_sort(me, comparator);
+        return 0;
+    }
+    temp = malloc(me->item_count * me->bytes_per_item);
+    sort.bounds = malloc((thread_count + 1) * sizeof(int));
+    tasks = malloc(thread_count * sizeof(struct parallel_task));
+    threads = malloc(thread_count * sizeof(pthread_t));
+    started = malloc((size_t) thread_count);
+    if (!temp || !sort.bounds || !tasks || !threads || !started) {
+        free(temp);
+        free(sort.bounds);
+        free(tasks);
+        free(threads);
+        free(started);
+        return -ENOMEM;
+    }
+    sort.from = me->data;
+    sort.to = NULL;
+    sort.size = me->bytes_per_item;
+    sort.comparator = comparator;
+    sort.count = me->item_count;
+    sort.thread_count = thread_count;
+    sort.run_count = thread_count;
+    for (i = 0; i < thread_count; i++) {
+        tasks[i].sort = &sort;
+        tasks[i].index = i;
+    }
+    for (i = 0; i <= thread_count; i++) {
+        sort.bounds[i] = vector_part_start(sort.count, thread_count, i);
+    }
+    vector_parallel_sort_phase(&sort, tasks, threads, started);
+    sort.to = temp;
+    while (sort.run_count > 1) {
+        char *const merged = sort.to;
+        vector_parallel_sort_phase(&sort, tasks, threads, started);
+        for (i = 0; 2 * i < sort.run_count; i++) {
+            sort.bounds[i] = sort.bounds[2 * i];
+        }
+        sort.run_count = (sort.run_count + 1) / 2;
+        sort.bounds[sort.run_count] = sort.count;
+        sort.to = sort.from;
+        sort.from = merged;
+    }
+    if (sort.from != me->data) {
+        memcpy(me->data, sort.from, me->item_count * me->bytes_per_item);
+    }
+    free(temp);
+    free(sort.bounds);
+    free(tasks);
+    free(threads);
+    free(started);
+    return 0;
+#else
+    if (thread_count < 0) {
+        return -EINVAL;
+    }
+    vector_sort(me, comparator);
+    return 0;
+#endif
+}
+
 /**
  * Adds an element to the start of the vector. The pointer to the data being
  * passed in should point to the data type which this vector holds. For example,
@@ -222,12 +1021,10 @@ int vector_add_at(vector me, const int index, void *const data)
     }
     if (me->item_count + 1 >= me->item_capacity) {
         const int new_space = (int) (me->item_capacity * RESIZE_RATIO);
-        void *const temp = realloc(me->data, new_space * me->bytes_per_item);
-        if (!temp) {
-            return -ENOMEM;
+        const int rc = vector_set_space(me, new_space);
+        if (rc != 0) {
+            return rc;
         }
-        me->data = temp;
-        me->item_capacity = new_space;
     }
     if (index != me->item_count) {
         memmove((char *) me->data + (index + 1) * me->bytes_per_item,
@@ -457,7 +1254,23 @@ int vector_clear(vector me)
  */
 vector vector_destroy(vector me)
 {
+#ifdef CONTAINERS_HAS_MMAP
+    if (me->map_offset && me->fd != -1) {
+        struct mapped_header *const header = (struct mapped_header *)
+                ((char *) me->data - me->map_offset);
+        header->item_count = (unsigned long) me->item_count;
+        munmap(header, me->mapped_size);
+        close(me->fd);
+        me->mapped_size = 0;
+    } else if (me->mapped_size) {
+        munmap((char *) me->data - me->map_offset, me->mapped_size);
+        me->mapped_size = 0;
+    } else {
+        free(me->data);
+    }
+#else
     free(me->data);
+#endif
     me->data = NULL;
     free(me);
     return NULL;
@@ -1,5 +1,8 @@
+#include <stdio.h>
+#include <limits.h>
 #include "test.h"
 #include "../src/include/array.h"
+#include "../src/include/compare.h"
 
 static void test_invalid_init(void)
 {
@@ -86,10 +89,156 @@ static void test_init_out_of_memory(void)
     assert(!array_init(10, sizeof(int)));
 }
 
+static void test_mapped(void)
+{
+    int i;
+    int *data;
+    array me;
+    assert(!array_init_mapped(-1, sizeof(int), 0));
+    assert(!array_init_mapped(1, 0, 0));
+    me = array_init_mapped(0, sizeof(int), 0);
+    assert(me);
+    assert(array_size(me) == 0);
+    assert(!array_get_data(me));
+    assert(!array_destroy(me));
+    me = array_init_mapped(10, sizeof(int), 0);
+    assert(me);
+    assert(array_size(me) == 10);
+    test_individual_operations(me);
+    test_array_copying(me);
+    test_out_of_bounds(me);
+    assert(!array_destroy(me));
+    me = array_init_mapped(100000, sizeof(int), ARRAY_HUGE_PAGES);
+    assert(me);
+    data = array_get_data(me);
+    for (i = 0; i < 100000; i++) {
+        assert(data[i] == 0);
+        data[i] = i;
+    }
+    for (i = 0; i < 100000; i++) {
+        int get = 0xdeadbeef;
+        array_get(&get, me, i);
+        assert(get == i);
+    }
+    assert(!array_destroy(me));
+    fail_malloc = 1;
+    assert(!array_init_mapped(10, sizeof(int), 0));
+}
+
+/*
+ * Overwrites the item count in the header of a mapped file, which follows the
+ * magic bytes and the element size.
+ */
+static void set_mapped_count(const char *const path, const unsigned long count)
+{
+    FILE *const file = fopen(path, "r+b");
+    assert(file);
+    assert(fseek(file, (long) (8 + sizeof(unsigned long)), SEEK_SET) == 0);
+    assert(fwrite(&count, sizeof(count), 1, file) == 1);
+    assert(fclose(file) == 0);
+}
+
+static void test_open_mapped(void)
+{
+    const char *const path = "test_array_mapped.bin";
+    int i;
+    int *data;
+    array me;
+    remove(path);
+    assert(!array_open_mapped(NULL, 10, sizeof(int), ARRAY_CREATE));
+    assert(!array_open_mapped(path, -1, sizeof(int), ARRAY_CREATE));
+    assert(!array_open_mapped(path, 10, 0, ARRAY_CREATE));
+    assert(!array_open_mapped(path, 10, sizeof(int), 0));
+    me = array_open_mapped(path, 10, sizeof(int), ARRAY_CREATE);
+    assert(me);
+    assert(array_size(me) == 10);
+    test_individual_operations(me);
+    assert(array_sync(me) == 0);
+    assert(!array_destroy(me));
+    assert(!array_open_mapped(path, 0, sizeof(long) + 1, 0));
+    set_mapped_count(path, 11);
+    assert(!array_open_mapped(path, 0, sizeof(int), 0));
+    set_mapped_count(path, (unsigned long) INT_MAX + 1);
+    assert(!array_open_mapped(path, 0, sizeof(int), 0));
+    set_mapped_count(path, 10);
+    me = array_open_mapped(path, 0, sizeof(int), ARRAY_READ_ONLY);
+    assert(me);
+    assert(array_size(me) == 10);
+    test_array_copying(me);
+    i = 50;
+    array_set(me, 0, &i);
+    assert(!array_destroy(me));
+    me = array_open_mapped(path, 0, sizeof(int), ARRAY_HUGE_PAGES);
+    assert(me);
+    data = array_get_data(me);
+    assert(data[0] == 0);
+    data[0] = 100;
+    assert(!array_destroy(me));
+    me = array_open_mapped(path, 0, sizeof(int), 0);
+    assert(me);
+    i = 0xdeadbeef;
+    array_get(&i, me, 0);
+    assert(i == 100);
+    assert(!array_destroy(me));
+    fail_malloc = 1;
+    assert(!array_open_mapped(path, 0, sizeof(int), 0));
+    remove(path);
+}
+
+static void test_sorting(void)
+{
+    int i;
+    int value;
+    int *data;
+    array me = array_init(300, sizeof(int));
+    assert(me);
+    for (i = 0; i < 300; i++) {
+        value = (i * 7) % 300;
+        assert(array_set(me, i, &value) == 0);
+    }
+    array_sort(me, containers_compare_int);
+    data = array_get_data(me);
+    for (i = 0; i < 300; i++) {
+        assert(data[i] == i);
+    }
+    assert(!array_destroy(me));
+}
+
+static void test_searching(void)
+{
+    int i;
+    int key;
+    int index;
+    int *data;
+    array me = array_init(300, sizeof(int));
+    assert(me);
+    for (i = 0; i < 300; i++) {
+        key = 2 * i;
+        assert(array_set(me, i, &key) == 0);
+    }
+    key = 51;
+    assert(array_lower_bound(me, &key, containers_compare_int) == 26);
+    key = 600;
+    assert(array_lower_bound(me, &key, containers_compare_int) == 300);
+    assert(array_eytzinger_layout(me) == 0);
+    data = array_get_data(me);
+    for (key = -1; key < 599; key++) {
+        index = array_eytzinger_lower_bound(me, &key, containers_compare_int);
+        assert(data[index] == key + (key & 1));
+    }
+    assert(array_eytzinger_lower_bound(me, &key, containers_compare_int)
+           == 300);
+    assert(!array_destroy(me));
+}
+
 void test_array(void)
 {
     test_invalid_init();
     test_empty_array();
     test_not_empty_array();
     test_init_out_of_memory();
+    test_mapped();
+    test_open_mapped();
+    test_sorting();
+    test_searching();
 }
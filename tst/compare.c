@@ -0,0 +1,284 @@
+#include <string.h>
+#include <limits.h>
+#include "test.h"
+#include "../src/include/compare.h"
+#include "../src/include/set.h"
+#include "../src/include/map.h"
+#include "../src/include/multimap.h"
+#include "../src/include/unordered_set.h"
+#include "../src/include/unordered_map.h"
+#include "../src/include/unordered_multimap.h"
+#include "../src/include/priority_queue.h"
+
+struct point {
+    int x;
+    int y;
+};
+
+static unsigned long hash_int(const void *const key)
+{
+    return (unsigned long) *(int *) key;
+}
+
+static unsigned long hash_point(const void *const key)
+{
+    const struct point *const point = key;
+    return (unsigned long) (31 * point->x + point->y);
+}
+
+static unsigned long hash_point_x(const void *const key)
+{
+    const struct point *const point = key;
+    return (unsigned long) point->x;
+}
+
+static int compare_int(const void *const one, const void *const two)
+{
+    const int a = *(int *) one;
+    const int b = *(int *) two;
+    return a - b;
+}
+
+static void test_scalar_keys(void)
+{
+    int int_one = INT_MIN;
+    int int_two = INT_MAX;
+    long long_one = LONG_MIN;
+    long long_two = LONG_MAX;
+    unsigned int uint_one = 0;
+    unsigned int uint_two = UINT_MAX;
+    unsigned long ulong_one = 0;
+    unsigned long ulong_two = ULONG_MAX;
+    assert(containers_compare_int(&int_one, &int_two) < 0);
+    assert(containers_compare_int(&int_two, &int_one) > 0);
+    assert(containers_compare_int(&int_one, &int_one) == 0);
+    assert(containers_compare_long(&long_one, &long_two) < 0);
+    assert(containers_compare_long(&long_two, &long_one) > 0);
+    assert(containers_compare_long(&long_two, &long_two) == 0);
+    assert(containers_compare_uint(&uint_one, &uint_two) < 0);
+    assert(containers_compare_uint(&uint_two, &uint_one) > 0);
+    assert(containers_compare_uint(&uint_two, &uint_two) == 0);
+    assert(containers_compare_ulong(&ulong_one, &ulong_two) < 0);
+    assert(containers_compare_ulong(&ulong_two, &ulong_one) > 0);
+    assert(containers_compare_ulong(&ulong_one, &ulong_one) == 0);
+}
+
+static void test_set_keys(void)
+{
+    int key;
+    set me = set_init(sizeof(int), containers_compare_int);
+    assert(me);
+    for (key = -500; key < 500; key++) {
+        assert(set_put(me, &key) == 0);
+    }
+    key = INT_MIN;
+    assert(set_put(me, &key) == 0);
+    key = INT_MAX;
+    assert(set_put(me, &key) == 0);
+    assert(set_size(me) == 1002);
+    assert(set_contains(me, &key));
+    key = INT_MIN;
+    assert(set_contains(me, &key));
+    for (key = -500; key < 500; key += 2) {
+        assert(set_remove(me, &key));
+    }
+    for (key = -500; key < 500; key++) {
+        assert(set_contains(me, &key) == (key % 2 != 0));
+    }
+    assert(!set_destroy(me));
+}
+
+static void test_map_keys(void)
+{
+    struct point key;
+    int value;
+    int i;
+    map me = map_init(sizeof(struct point), sizeof(int),
+                      containers_compare_key);
+    assert(me);
+    memset(&key, 0, sizeof(key));
+    for (i = 0; i < 1000; i++) {
+        key.x = i % 10;
+        key.y = i;
+        assert(map_put(me, &key, &i) == 0);
+    }
+    assert(map_size(me) == 1000);
+    for (i = 0; i < 1000; i++) {
+        key.x = i % 10;
+        key.y = i;
+        assert(map_get(&value, me, &key));
+        assert(value == i);
+    }
+    key.x = 1;
+    key.y = 2;
+    assert(!map_contains(me, &key));
+    assert(!map_destroy(me));
+}
+
+static void test_multimap_keys(void)
+{
+    unsigned long key;
+    int value;
+    multimap me = multimap_init(sizeof(unsigned long), sizeof(int),
+                                containers_compare_ulong, compare_int);
+    assert(me);
+    for (key = 0; key < 100; key++) {
+        value = (int) key;
+        assert(multimap_put(me, &key, &value) == 0);
+        value = -value;
+        assert(multimap_put(me, &key, &value) == 0);
+    }
+    key = ULONG_MAX;
+    assert(multimap_put(me, &key, &value) == 0);
+    assert(multimap_count(me, &key) == 1);
+    for (key = 0; key < 100; key++) {
+        assert(multimap_count(me, &key) == 2);
+    }
+    assert(!multimap_destroy(me));
+}
+
+static void test_unordered_keys(void)
+{
+    struct point point;
+    int key;
+    unordered_set set = unordered_set_init(sizeof(int), hash_int,
+                                           containers_compare_int);
+    unordered_map map = unordered_map_init(sizeof(struct point), sizeof(int),
+                                           hash_point, containers_compare_key);
+    assert(set);
+    assert(map);
+    memset(&point, 0, sizeof(point));
+    for (key = 0; key < 1000; key++) {
+        assert(unordered_set_put(set, &key) == 0);
+        point.x = key;
+        point.y = key % 7;
+        assert(unordered_map_put(map, &point, &key) == 0);
+    }
+    for (key = 0; key < 1000; key++) {
+        assert(unordered_set_put(set, &key) == 0);
+    }
+    assert(unordered_set_size(set) == 1000);
+    assert(unordered_map_size(map) == 1000);
+    for (key = 0; key < 1000; key++) {
+        assert(unordered_set_contains(set, &key));
+        point.x = key;
+        point.y = key % 7;
+        assert(unordered_map_contains(map, &point));
+        point.y++;
+        assert(!unordered_map_contains(map, &point));
+    }
+    assert(!unordered_set_destroy(set));
+    assert(!unordered_map_destroy(map));
+}
+
+static void test_mismatched_key_size(void)
+{
+    struct point point;
+    set tree = set_init(sizeof(struct point), containers_compare_int);
+    unordered_set hashed = unordered_set_init(sizeof(struct point),
+                                              hash_point_x,
+                                              containers_compare_int);
+    assert(tree);
+    assert(hashed);
+    memset(&point, 0, sizeof(point));
+    for (point.x = 0; point.x < 100; point.x++) {
+        point.y = point.x;
+        assert(set_put(tree, &point) == 0);
+        assert(unordered_set_put(hashed, &point) == 0);
+    }
+    for (point.x = 0; point.x < 100; point.x++) {
+        point.y = -1;
+        assert(set_contains(tree, &point));
+        assert(unordered_set_contains(hashed, &point));
+        assert(set_put(tree, &point) == 0);
+        assert(unordered_set_put(hashed, &point) == 0);
+    }
+    assert(set_size(tree) == 100);
+    assert(unordered_set_size(hashed) == 100);
+    assert(!set_destroy(tree));
+    assert(!unordered_set_destroy(hashed));
+}
+
+static void test_value_keys(void)
+{
+    struct point value;
+    int key;
+    multimap tree = multimap_init(sizeof(int), sizeof(struct point),
+                                  containers_compare_int,
+                                  containers_compare_key);
+    unordered_multimap hashed =
+            unordered_multimap_init(sizeof(int), sizeof(struct point),
+                                    hash_int, containers_compare_int,
+                                    containers_compare_key);
+    assert(tree);
+    assert(hashed);
+    memset(&value, 0, sizeof(value));
+    for (key = 0; key < 10; key++) {
+        for (value.y = 0; value.y < 10; value.y++) {
+            value.x = key;
+            assert(multimap_put(tree, &key, &value) == 0);
+            assert(unordered_multimap_put(hashed, &key, &value) == 0);
+        }
+    }
+    key = 3;
+    value.x = 3;
+    value.y = 7;
+    assert(multimap_remove(tree, &key, &value));
+    assert(unordered_multimap_remove(hashed, &key, &value));
+    assert(!multimap_remove(tree, &key, &value));
+    assert(!unordered_multimap_remove(hashed, &key, &value));
+    value.x = 4;
+    value.y = 0;
+    assert(!multimap_remove(tree, &key, &value));
+    assert(!unordered_multimap_remove(hashed, &key, &value));
+    assert(multimap_count(tree, &key) == 9);
+    assert(unordered_multimap_count(hashed, &key) == 9);
+    assert(!multimap_destroy(tree));
+    assert(!unordered_multimap_destroy(hashed));
+}
+
+static void test_priority_queue_keys(void)
+{
+    unsigned char byte;
+    int key;
+    int previous;
+    priority_queue bytes = priority_queue_init(sizeof(unsigned char),
+                                               containers_compare_key);
+    priority_queue ints = priority_queue_init(sizeof(int),
+                                              containers_compare_int);
+    assert(bytes);
+    assert(ints);
+    for (key = 0; key < 256; key++) {
+        byte = (unsigned char) ((key * 37) % 256);
+        assert(priority_queue_push(bytes, &byte) == 0);
+        key = -key;
+        assert(priority_queue_push(ints, &key) == 0);
+        key = -key;
+    }
+    for (key = 255; key >= 0; key--) {
+        assert(priority_queue_pop(&byte, bytes));
+        assert(byte == key);
+    }
+    assert(!priority_queue_pop(&byte, bytes));
+    assert(priority_queue_pop(&previous, ints));
+    assert(previous == 0);
+    while (priority_queue_pop(&key, ints)) {
+        assert(key < previous);
+        previous = key;
+    }
+    assert(previous == -255);
+    assert(!priority_queue_destroy(bytes));
+    assert(!priority_queue_destroy(ints));
+}
+
+void test_compare(void)
+{
+    test_scalar_keys();
+    test_set_keys();
+    test_map_keys();
+    test_multimap_keys();
+    test_unordered_keys();
+    test_mismatched_key_size();
+    test_value_keys();
+    test_priority_queue_keys();
+}
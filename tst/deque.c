@@ -1,5 +1,6 @@
 #include "test.h"
 #include "../src/include/deque.h"
+#include "../src/include/compare.h"
 
 static void test_invalid_init(void)
 {
@@ -272,6 +273,92 @@ void test_single_full_block(void)
     deque_destroy(me);
 }
 
+static int sum_block(void *const data, const int count, void *const context)
+{
+    const int *const block = data;
+    int *const sum = context;
+    int i;
+    assert(count > 0);
+    for (i = 0; i < count; i++) {
+        sum[0] += block[i];
+    }
+    sum[1] += count;
+    return 0;
+}
+
+static int stop_block(void *const data, const int count, void *const context)
+{
+    int *const calls = context;
+    (void) data;
+    (void) count;
+    calls[0]++;
+    return 7;
+}
+
+static void test_get_ref_at(void)
+{
+    int *refs[100];
+    int sum[2] = {0, 0};
+    int calls = 0;
+    int val;
+    int i;
+    deque me = deque_init(sizeof(int));
+    assert(me);
+    assert(!deque_get_ref_at(me, 0));
+    assert(deque_for_each_block(me, sum_block, sum) == 0);
+    assert(sum[1] == 0);
+    for (i = 0; i < 100; i++) {
+        assert(deque_push_back(me, &i) == 0);
+        refs[i] = deque_get_ref_at(me, i);
+        assert(refs[i]);
+        assert(*refs[i] == i);
+    }
+    for (i = 0; i < 100; i++) {
+        val = -i - 1;
+        assert(deque_push_front(me, &val) == 0);
+    }
+    for (i = 0; i < 100; i++) {
+        assert(refs[i] == deque_get_ref_at(me, i + 100));
+        assert(*refs[i] == i);
+        *refs[i] = 2 * i;
+    }
+    assert(!deque_get_ref_at(me, -1));
+    assert(!deque_get_ref_at(me, 200));
+    assert(deque_get_at(&val, me, 150) == 0);
+    assert(val == 100);
+    assert(deque_for_each_block(me, sum_block, sum) == 0);
+    assert(sum[1] == 200);
+    assert(sum[0] == 99 * 100 - 100 * 101 / 2);
+    assert(deque_for_each_block(me, stop_block, &calls) == 7);
+    assert(calls == 1);
+    assert(!deque_destroy(me));
+}
+
+static void test_sorting(void)
+{
+    int i;
+    int value;
+    deque me = deque_init(sizeof(int));
+    assert(me);
+    assert(deque_sort(me, containers_compare_int) == 0);
+    for (i = 0; i < 500; i++) {
+        value = i * 37 % 500;
+        if (i % 2 == 0) {
+            assert(deque_push_front(me, &value) == 0);
+        } else {
+            assert(deque_push_back(me, &value) == 0);
+        }
+    }
+    assert(deque_sort(me, containers_compare_int) == 0);
+    for (i = 0; i < 500; i++) {
+        assert(deque_get_at(&value, me, i) == 0);
+        assert(value == i);
+    }
+    fail_malloc = 1;
+    assert(deque_sort(me, containers_compare_int) == -ENOMEM);
+    assert(!deque_destroy(me));
+}
+
 void test_deque(void)
 {
     test_invalid_init();
@@ -283,4 +370,6 @@ void test_deque(void)
     test_push_back_out_of_memory();
     test_clear_out_of_memory();
     test_single_full_block();
+    test_get_ref_at();
+    test_sorting();
 }
@@ -0,0 +1,242 @@
+#include <string.h>
+#include "test.h"
+#include "../src/include/compare.h"
+#include "../src/include/flat_map.h"
+
+static int compare_int(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return a - b;
+}
+
+static void flat_map_verify(flat_map me)
+{
+    const int *const keys = flat_map_get_keys(me);
+    const int *const values = flat_map_get_values(me);
+    int i;
+    for (i = 0; i < flat_map_size(me); i++) {
+        if (i > 0) {
+            assert(keys[i - 1] < keys[i]);
+        }
+        assert(values[i] == keys[i] * 2 || values[i] == -keys[i]);
+    }
+}
+
+static void test_invalid_init(void)
+{
+    assert(!flat_map_init(0, sizeof(int), compare_int));
+    assert(!flat_map_init(sizeof(int), 0, compare_int));
+    assert(!flat_map_init(sizeof(int), sizeof(int), NULL));
+}
+
+static void test_basic(void)
+{
+    flat_map me = flat_map_init(sizeof(int), sizeof(int), compare_int);
+    int key_arr[8] = {5, 3, 9, 1, 7, 3, 0, 8};
+    int key;
+    int value;
+    int i;
+    assert(me);
+    assert(flat_map_is_empty(me));
+    key = 4;
+    assert(!flat_map_get(&value, me, &key));
+    assert(!flat_map_remove(me, &key));
+    assert(flat_map_lower_bound(me, &key) == 0);
+    for (i = 0; i < 8; i++) {
+        value = key_arr[i] * 2;
+        assert(flat_map_put(me, &key_arr[i], &value) == 0);
+        flat_map_verify(me);
+    }
+    assert(flat_map_size(me) == 7);
+    key = 3;
+    value = -3;
+    assert(flat_map_put(me, &key, &value) == 0);
+    assert(flat_map_size(me) == 7);
+    value = 0;
+    assert(flat_map_get(&value, me, &key));
+    assert(value == -3);
+    assert(flat_map_contains(me, &key));
+    key = 6;
+    assert(!flat_map_contains(me, &key));
+    assert(flat_map_lower_bound(me, &key) == 4);
+    assert(flat_map_get_at(&key, &value, me, 4) == 0);
+    assert(key == 7);
+    assert(value == 14);
+    assert(flat_map_get_at(NULL, &value, me, 0) == 0);
+    assert(value == 0);
+    assert(flat_map_get_at(&key, NULL, me, 6) == 0);
+    assert(key == 9);
+    assert(flat_map_get_at(&key, &value, me, 7) == -EINVAL);
+    assert(flat_map_get_at(&key, &value, me, -1) == -EINVAL);
+    key = 5;
+    assert(flat_map_remove(me, &key));
+    assert(!flat_map_remove(me, &key));
+    assert(flat_map_size(me) == 6);
+    flat_map_verify(me);
+    assert(flat_map_clear(me) == 0);
+    assert(flat_map_is_empty(me));
+    assert(!flat_map_destroy(me));
+}
+
+static void test_put_all(void)
+{
+    flat_map me = flat_map_init(sizeof(int), sizeof(int),
+                                containers_compare_int);
+    int keys[6] = {10, 30, 20, 50, 40, 0};
+    int values[6] = {20, 60, 40, 100, 80, 0};
+    int more_keys[5] = {35, 10, 5, 55, 40};
+    int more_values[5] = {70, -10, 10, 110, -40};
+    int key;
+    int value;
+    assert(me);
+    assert(flat_map_put_all(me, keys, values, -1) == -EINVAL);
+    assert(flat_map_put_all(me, keys, values, 0) == 0);
+    assert(flat_map_is_empty(me));
+    assert(flat_map_put_all(me, keys, values, 6) == 0);
+    assert(flat_map_size(me) == 6);
+    flat_map_verify(me);
+    assert(flat_map_put_all(me, more_keys, more_values, 5) == 0);
+    assert(flat_map_size(me) == 9);
+    flat_map_verify(me);
+    key = 10;
+    assert(flat_map_get(&value, me, &key));
+    assert(value == -10);
+    key = 40;
+    assert(flat_map_get(&value, me, &key));
+    assert(value == -40);
+    key = 55;
+    assert(flat_map_get(&value, me, &key));
+    assert(value == 110);
+    assert(flat_map_assign(me, more_keys, more_values, -1) == -EINVAL);
+    assert(flat_map_assign(me, more_keys, more_values, 5) == 0);
+    assert(flat_map_size(me) == 5);
+    flat_map_verify(me);
+    key = 20;
+    assert(!flat_map_contains(me, &key));
+    assert(!flat_map_destroy(me));
+}
+
+static void test_put_all_key_bytes(void)
+{
+    flat_map me = flat_map_init(3, sizeof(int), containers_compare_key);
+    unsigned char keys[3 * 600];
+    unsigned char key[3];
+    unsigned char previous[3];
+    int values[600];
+    unsigned long seed = 11;
+    int value;
+    int i;
+    assert(me);
+    for (i = 0; i < 600; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        keys[3 * i] = (unsigned char) ((seed >> 16) & 0x3);
+        keys[3 * i + 1] = (unsigned char) ((seed >> 18) & 0x3);
+        keys[3 * i + 2] = (unsigned char) ((seed >> 20) & 0x3);
+        values[i] = keys[3 * i] + 4 * keys[3 * i + 1] + 16 * keys[3 * i + 2];
+    }
+    assert(flat_map_put_all(me, keys, values, 300) == 0);
+    assert(flat_map_put_all(me, keys + 3 * 300, values + 300, 300) == 0);
+    assert(flat_map_size(me) == 64);
+    for (i = 0; i < flat_map_size(me); i++) {
+        assert(flat_map_get_at(key, &value, me, i) == 0);
+        assert(value == key[0] + 4 * key[1] + 16 * key[2]);
+        if (i > 0) {
+            assert(memcmp(previous, key, 3) < 0);
+        }
+        memcpy(previous, key, 3);
+    }
+    for (i = 0; i < 600; i++) {
+        assert(flat_map_get(&value, me, keys + 3 * i));
+        assert(value == values[i]);
+    }
+    assert(!flat_map_destroy(me));
+}
+
+static void test_stress(void)
+{
+    flat_map me = flat_map_init(sizeof(int), sizeof(int), compare_int);
+    char present[2000] = {0};
+    int keys[300];
+    int values[300];
+    int count = 0;
+    int i;
+    assert(me);
+    assert(flat_map_reserve(me, 100) == 0);
+    for (i = 0; i < 20; i++) {
+        int j;
+        for (j = 0; j < 300; j++) {
+            keys[j] = (i * 7919 + j * 104729) % 2000;
+            values[j] = i % 3 == 0 ? -keys[j] : keys[j] * 2;
+            if (!present[keys[j]]) {
+                present[keys[j]] = 1;
+                count++;
+            }
+        }
+        if (i % 2 == 0) {
+            assert(flat_map_put_all(me, keys, values, 300) == 0);
+        } else {
+            for (j = 0; j < 300; j++) {
+                assert(flat_map_put(me, &keys[j], &values[j]) == 0);
+            }
+        }
+        assert(flat_map_size(me) == count);
+        flat_map_verify(me);
+    }
+    for (i = 0; i < 2000; i++) {
+        assert(flat_map_contains(me, &i) == present[i]);
+        if (i % 3 == 0 && present[i]) {
+            assert(flat_map_remove(me, &i));
+            count--;
+        }
+    }
+    assert(flat_map_size(me) == count);
+    flat_map_verify(me);
+    assert(!flat_map_destroy(me));
+}
+
+static void test_init_out_of_memory(void)
+{
+    fail_malloc = 1;
+    assert(!flat_map_init(sizeof(int), sizeof(int), compare_int));
+    fail_malloc = 1;
+    delay_fail_malloc = 2;
+    assert(!flat_map_init(sizeof(int), sizeof(int), compare_int));
+    fail_malloc = 1;
+    delay_fail_malloc = 4;
+    assert(!flat_map_init(sizeof(int), sizeof(int), compare_int));
+}
+
+static void test_put_all_out_of_memory(void)
+{
+    flat_map me = flat_map_init(sizeof(int), sizeof(int), compare_int);
+    int keys[100];
+    int values[100];
+    int i;
+    assert(me);
+    for (i = 0; i < 100; i++) {
+        keys[i] = 99 - i;
+        values[i] = keys[i] * 2;
+    }
+    fail_malloc = 1;
+    assert(flat_map_put_all(me, keys, values, 100) == -ENOMEM);
+    assert(flat_map_is_empty(me));
+    fail_realloc = 1;
+    assert(flat_map_put_all(me, keys, values, 100) == -ENOMEM);
+    assert(flat_map_is_empty(me));
+    assert(flat_map_put_all(me, keys, values, 100) == 0);
+    assert(flat_map_size(me) == 100);
+    flat_map_verify(me);
+    assert(!flat_map_destroy(me));
+}
+
+void test_flat_map(void)
+{
+    test_invalid_init();
+    test_basic();
+    test_put_all();
+    test_put_all_key_bytes();
+    test_stress();
+    test_init_out_of_memory();
+    test_put_all_out_of_memory();
+}
@@ -0,0 +1,210 @@
+#include <string.h>
+#include "test.h"
+#include "../src/include/compare.h"
+#include "../src/include/flat_set.h"
+
+static int compare_int(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return a - b;
+}
+
+static void flat_set_verify(flat_set me)
+{
+    const int *const data = flat_set_get_data(me);
+    int i;
+    for (i = 1; i < flat_set_size(me); i++) {
+        assert(data[i - 1] < data[i]);
+    }
+}
+
+static void test_invalid_init(void)
+{
+    assert(!flat_set_init(0, compare_int));
+    assert(!flat_set_init(sizeof(int), NULL));
+}
+
+static void test_basic(void)
+{
+    flat_set me = flat_set_init(sizeof(int), compare_int);
+    int val_arr[10] = {5, 3, 9, 1, 7, 3, 0, 8, 2, 5};
+    int key;
+    int i;
+    assert(me);
+    assert(flat_set_is_empty(me));
+    key = 4;
+    assert(flat_set_lower_bound(me, &key) == 0);
+    assert(!flat_set_contains(me, &key));
+    assert(!flat_set_remove(me, &key));
+    for (i = 0; i < 10; i++) {
+        assert(flat_set_put(me, &val_arr[i]) == 0);
+        assert(flat_set_contains(me, &val_arr[i]));
+        flat_set_verify(me);
+    }
+    assert(flat_set_size(me) == 8);
+    assert(!flat_set_is_empty(me));
+    key = 4;
+    assert(!flat_set_contains(me, &key));
+    assert(flat_set_lower_bound(me, &key) == 4);
+    key = 5;
+    assert(flat_set_lower_bound(me, &key) == 4);
+    key = -1;
+    assert(flat_set_lower_bound(me, &key) == 0);
+    key = 10;
+    assert(flat_set_lower_bound(me, &key) == 8);
+    assert(flat_set_get_at(&key, me, 0) == 0);
+    assert(key == 0);
+    assert(flat_set_get_at(&key, me, 7) == 0);
+    assert(key == 9);
+    assert(flat_set_get_at(&key, me, 8) == -EINVAL);
+    assert(flat_set_get_at(&key, me, -1) == -EINVAL);
+    key = 5;
+    assert(flat_set_remove(me, &key));
+    assert(!flat_set_remove(me, &key));
+    assert(!flat_set_contains(me, &key));
+    assert(flat_set_size(me) == 7);
+    flat_set_verify(me);
+    assert(flat_set_clear(me) == 0);
+    assert(flat_set_is_empty(me));
+    assert(!flat_set_destroy(me));
+}
+
+static void test_put_all(void)
+{
+    flat_set me = flat_set_init(sizeof(int), containers_compare_int);
+    int first[6] = {10, 30, 20, 20, 50, 40};
+    int second[8] = {35, 10, 5, 55, 35, 40, 45, 0};
+    int expected[10] = {0, 5, 10, 20, 30, 35, 40, 45, 50, 55};
+    int i;
+    assert(me);
+    assert(flat_set_put_all(me, first, -1) == -EINVAL);
+    assert(flat_set_put_all(me, first, 0) == 0);
+    assert(flat_set_is_empty(me));
+    assert(flat_set_put_all(me, first, 6) == 0);
+    assert(flat_set_size(me) == 5);
+    flat_set_verify(me);
+    assert(flat_set_put_all(me, second, 8) == 0);
+    assert(flat_set_size(me) == 10);
+    assert(memcmp(flat_set_get_data(me), expected, sizeof(expected)) == 0);
+    assert(flat_set_put_all(me, expected, 10) == 0);
+    assert(flat_set_size(me) == 10);
+    assert(flat_set_assign(me, second, -1) == -EINVAL);
+    assert(flat_set_assign(me, second, 8) == 0);
+    assert(flat_set_size(me) == 7);
+    flat_set_verify(me);
+    for (i = 0; i < 8; i++) {
+        assert(flat_set_contains(me, &second[i]));
+    }
+    assert(!flat_set_contains(me, &first[2]));
+    assert(!flat_set_destroy(me));
+}
+
+static void test_put_all_key_bytes(void)
+{
+    flat_set me = flat_set_init(3, containers_compare_key);
+    const unsigned char *data;
+    unsigned char keys[3 * 600];
+    unsigned long seed = 7;
+    int i;
+    assert(me);
+    for (i = 0; i < 3 * 600; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        keys[i] = (unsigned char) ((seed >> 16) & 0x3);
+    }
+    assert(flat_set_put_all(me, keys, 300) == 0);
+    assert(flat_set_put_all(me, keys + 3 * 300, 300) == 0);
+    assert(flat_set_size(me) == 64);
+    data = flat_set_get_data(me);
+    for (i = 1; i < flat_set_size(me); i++) {
+        assert(memcmp(data + 3 * (i - 1), data + 3 * i, 3) < 0);
+    }
+    for (i = 0; i < 600; i++) {
+        assert(flat_set_contains(me, keys + 3 * i));
+    }
+    assert(!flat_set_destroy(me));
+}
+
+static void test_stress(void)
+{
+    flat_set me = flat_set_init(sizeof(int), compare_int);
+    char present[2000] = {0};
+    int batch[300];
+    int count = 0;
+    int i;
+    assert(me);
+    assert(flat_set_reserve(me, 100) == 0);
+    for (i = 0; i < 20; i++) {
+        int j;
+        for (j = 0; j < 300; j++) {
+            batch[j] = (i * 7919 + j * 104729) % 2000;
+            if (!present[batch[j]]) {
+                present[batch[j]] = 1;
+                count++;
+            }
+        }
+        if (i % 2 == 0) {
+            assert(flat_set_put_all(me, batch, 300) == 0);
+        } else {
+            for (j = 0; j < 300; j++) {
+                assert(flat_set_put(me, &batch[j]) == 0);
+            }
+        }
+        assert(flat_set_size(me) == count);
+        flat_set_verify(me);
+    }
+    for (i = 0; i < 2000; i++) {
+        assert(flat_set_contains(me, &i) == present[i]);
+        if (i % 3 == 0 && present[i]) {
+            assert(flat_set_remove(me, &i));
+            count--;
+        }
+    }
+    assert(flat_set_size(me) == count);
+    flat_set_verify(me);
+    assert(!flat_set_destroy(me));
+}
+
+static void test_init_out_of_memory(void)
+{
+    fail_malloc = 1;
+    assert(!flat_set_init(sizeof(int), compare_int));
+    fail_malloc = 1;
+    delay_fail_malloc = 1;
+    assert(!flat_set_init(sizeof(int), compare_int));
+    fail_malloc = 1;
+    delay_fail_malloc = 2;
+    assert(!flat_set_init(sizeof(int), compare_int));
+}
+
+static void test_put_all_out_of_memory(void)
+{
+    flat_set me = flat_set_init(sizeof(int), compare_int);
+    int keys[100];
+    int i;
+    assert(me);
+    for (i = 0; i < 100; i++) {
+        keys[i] = 99 - i;
+    }
+    fail_malloc = 1;
+    assert(flat_set_put_all(me, keys, 100) == -ENOMEM);
+    assert(flat_set_is_empty(me));
+    fail_realloc = 1;
+    assert(flat_set_put_all(me, keys, 100) == -ENOMEM);
+    assert(flat_set_is_empty(me));
+    assert(flat_set_put_all(me, keys, 100) == 0);
+    assert(flat_set_size(me) == 100);
+    flat_set_verify(me);
+    assert(!flat_set_destroy(me));
+}
+
+void test_flat_set(void)
+{
+    test_invalid_init();
+    test_basic();
+    test_put_all();
+    test_put_all_key_bytes();
+    test_stress();
+    test_init_out_of_memory();
+    test_put_all_out_of_memory();
+}
@@ -0,0 +1,298 @@
+#include "test.h"
+#include "../src/include/generic.h"
+
+#define INT_COMPARE(a, b) (((a) > (b)) - ((a) < (b)))
+#define INT_HASH(a) ((unsigned long) (a))
+#define INT_EQUAL(a, b) ((a) == (b))
+
+static unsigned long bad_hash(const int key)
+{
+    (void) key;
+    return 5;
+}
+
+CONTAINERS_DEFINE_VECTOR(int_vector, int)
+CONTAINERS_DEFINE_DEQUE(int_deque, int)
+CONTAINERS_DEFINE_PRIORITY_QUEUE(int_priority_queue, int, INT_COMPARE)
+CONTAINERS_DEFINE_UNORDERED_MAP(int_unordered_map, int, double, INT_HASH,
+                                INT_EQUAL)
+CONTAINERS_DEFINE_UNORDERED_MAP(bad_unordered_map, int, int, bad_hash,
+                                INT_EQUAL)
+CONTAINERS_DEFINE_UNORDERED_SET(int_unordered_set, int, INT_HASH, INT_EQUAL)
+CONTAINERS_DEFINE_UNORDERED_SET(bad_unordered_set, int, bad_hash, INT_EQUAL)
+CONTAINERS_DEFINE_MAP(int_map, int, long, INT_COMPARE)
+CONTAINERS_DEFINE_SET(int_set, int, INT_COMPARE)
+
+static void test_generic_vector(void)
+{
+    int data;
+    int i;
+    int_vector me = int_vector_init();
+    assert(me);
+    assert(int_vector_is_empty(me));
+    assert(int_vector_get_at(&data, me, 0) == -EINVAL);
+    assert(int_vector_remove_last(me) == -EINVAL);
+    for (i = 0; i < 1000; i++) {
+        assert(int_vector_add_last(me, i) == 0);
+    }
+    assert(int_vector_add_at(me, 0, -1) == 0);
+    assert(int_vector_add_at(me, 1002, 0) == -EINVAL);
+    assert(int_vector_size(me) == 1001);
+    for (i = 0; i < 1001; i++) {
+        assert(int_vector_get_at(&data, me, i) == 0);
+        assert(data == i - 1);
+    }
+    assert(int_vector_remove_at(me, 0) == 0);
+    assert(int_vector_remove_at(me, 1000) == -EINVAL);
+    assert(int_vector_set_at(me, 999, 5) == 0);
+    assert(int_vector_get_data(me)[999] == 5);
+    assert(int_vector_remove_last(me) == 0);
+    assert(int_vector_size(me) == 999);
+    assert(int_vector_get_data(me)[998] == 998);
+    assert(int_vector_reserve(me, 5000) == 0);
+    assert(me->capacity == 5000);
+    int_vector_clear(me);
+    assert(int_vector_is_empty(me));
+    assert(!int_vector_destroy(me));
+}
+
+static void test_generic_deque(void)
+{
+    int data;
+    int i;
+    int_deque me = int_deque_init();
+    assert(me);
+    assert(int_deque_pop_front(&data, me) == -EINVAL);
+    assert(int_deque_pop_back(&data, me) == -EINVAL);
+    for (i = 0; i < 500; i++) {
+        assert(int_deque_push_front(me, -i - 1) == 0);
+        assert(int_deque_push_back(me, i) == 0);
+    }
+    assert(int_deque_size(me) == 1000);
+    for (i = 0; i < 1000; i++) {
+        assert(int_deque_get_at(&data, me, i) == 0);
+        assert(data == i - 500);
+    }
+    assert(int_deque_get_at(&data, me, 1000) == -EINVAL);
+    assert(int_deque_set_at(me, 0, 7) == 0);
+    assert(int_deque_pop_front(&data, me) == 0);
+    assert(data == 7);
+    assert(int_deque_pop_back(&data, me) == 0);
+    assert(data == 499);
+    for (i = 0; i < 100; i++) {
+        assert(int_deque_pop_front(&data, me) == 0);
+        assert(int_deque_push_back(me, data) == 0);
+    }
+    assert(int_deque_get_at(&data, me, 0) == 0);
+    assert(data == -399);
+    int_deque_clear(me);
+    assert(int_deque_is_empty(me));
+    assert(!int_deque_destroy(me));
+}
+
+static void test_generic_priority_queue(void)
+{
+    int data;
+    int i;
+    int_priority_queue me = int_priority_queue_init();
+    assert(me);
+    assert(!int_priority_queue_front(&data, me));
+    assert(!int_priority_queue_pop(&data, me));
+    for (i = 0; i < 1000; i++) {
+        assert(int_priority_queue_push(me, (i * 7919) % 1000) == 0);
+    }
+    assert(int_priority_queue_front(&data, me));
+    assert(data == 999);
+    for (i = 999; i >= 0; i--) {
+        assert(int_priority_queue_pop(&data, me));
+        assert(data == i);
+    }
+    assert(int_priority_queue_is_empty(me));
+    assert(int_priority_queue_push(me, 3) == 0);
+    int_priority_queue_clear(me);
+    assert(int_priority_queue_size(me) == 0);
+    assert(!int_priority_queue_destroy(me));
+}
+
+static void test_generic_unordered_map(void)
+{
+    double value;
+    int bad_value;
+    int i;
+    int_unordered_map me = int_unordered_map_init();
+    bad_unordered_map bad = bad_unordered_map_init();
+    assert(me);
+    assert(bad);
+    for (i = 0; i < 1000; i++) {
+        assert(int_unordered_map_put(me, i, i / 2.0) == 0);
+        assert(bad_unordered_map_put(bad, i, i) == 0);
+    }
+    assert(int_unordered_map_put(me, 0, 5.0) == 0);
+    assert(int_unordered_map_size(me) == 1000);
+    assert(bad_unordered_map_size(bad) == 1000);
+    assert(int_unordered_map_get(&value, me, 0));
+    assert(value == 5.0);
+    for (i = 1; i < 1000; i++) {
+        assert(int_unordered_map_get(&value, me, i));
+        assert(value == i / 2.0);
+        assert(bad_unordered_map_get(&bad_value, bad, i));
+        assert(bad_value == i);
+    }
+    assert(!int_unordered_map_contains(me, 1000));
+    for (i = 0; i < 1000; i += 2) {
+        assert(int_unordered_map_remove(me, i));
+        assert(bad_unordered_map_remove(bad, i));
+    }
+    assert(!int_unordered_map_remove(me, 0));
+    for (i = 0; i < 1000; i++) {
+        assert(int_unordered_map_contains(me, i) == i % 2);
+        assert(bad_unordered_map_contains(bad, i) == i % 2);
+    }
+    int_unordered_map_clear(me);
+    assert(int_unordered_map_is_empty(me));
+    assert(!int_unordered_map_destroy(me));
+    assert(!bad_unordered_map_destroy(bad));
+}
+
+static void test_generic_unordered_set(void)
+{
+    int i;
+    int_unordered_set me = int_unordered_set_init();
+    bad_unordered_set bad = bad_unordered_set_init();
+    assert(me);
+    assert(bad);
+    for (i = 0; i < 1000; i++) {
+        assert(int_unordered_set_put(me, i) == 0);
+        assert(bad_unordered_set_put(bad, i) == 0);
+    }
+    assert(int_unordered_set_put(me, 0) == 0);
+    assert(bad_unordered_set_put(bad, 999) == 0);
+    assert(int_unordered_set_size(me) == 1000);
+    assert(bad_unordered_set_size(bad) == 1000);
+    assert(!int_unordered_set_contains(me, 1000));
+    for (i = 0; i < 1000; i += 2) {
+        assert(int_unordered_set_remove(me, i));
+        assert(bad_unordered_set_remove(bad, i));
+    }
+    assert(!int_unordered_set_remove(me, 0));
+    for (i = 0; i < 1000; i++) {
+        assert(int_unordered_set_contains(me, i) == i % 2);
+        assert(bad_unordered_set_contains(bad, i) == i % 2);
+    }
+    fail_malloc = 1;
+    assert(int_unordered_set_put(me, 2000) == -ENOMEM);
+    assert(!int_unordered_set_contains(me, 2000));
+    int_unordered_set_clear(me);
+    assert(int_unordered_set_is_empty(me));
+    assert(!int_unordered_set_destroy(me));
+    assert(!bad_unordered_set_destroy(bad));
+}
+
+static int int_map_verify(const struct int_map_node *const item)
+{
+    int left;
+    int right;
+    if (!item) {
+        return 0;
+    }
+    left = int_map_verify(item->left);
+    right = int_map_verify(item->right);
+    assert(left - right <= 1 && right - left <= 1);
+    assert(item->height == 1 + (left > right ? left : right));
+    assert(!item->left || item->left->key < item->key);
+    assert(!item->right || item->right->key > item->key);
+    return item->height;
+}
+
+static void test_generic_map(void)
+{
+    long value;
+    int i;
+    int_map me = int_map_init();
+    assert(me);
+    assert(!int_map_get(&value, me, 0));
+    for (i = 0; i < 1000; i++) {
+        const int key = (i * 7919) % 1000;
+        assert(int_map_put(me, key, key * 2L) == 0);
+        int_map_verify(me->root);
+    }
+    assert(int_map_put(me, 5, -5L) == 0);
+    assert(int_map_size(me) == 1000);
+    assert(int_map_get(&value, me, 5));
+    assert(value == -5L);
+    for (i = 0; i < 1000; i += 3) {
+        assert(int_map_remove(me, i));
+        int_map_verify(me->root);
+    }
+    assert(!int_map_remove(me, 0));
+    assert(!int_map_remove(me, 1000));
+    for (i = 0; i < 1000; i++) {
+        assert(int_map_contains(me, i) == (i % 3 != 0));
+    }
+    assert(int_map_get(&value, me, 998));
+    assert(value == 1996L);
+    fail_malloc = 1;
+    assert(int_map_put(me, 3000, 0L) == -ENOMEM);
+    assert(!int_map_contains(me, 3000));
+    int_map_verify(me->root);
+    int_map_clear(me);
+    assert(int_map_is_empty(me));
+    assert(!int_map_destroy(me));
+}
+
+static int int_set_verify(const struct int_set_node *const item)
+{
+    int left;
+    int right;
+    if (!item) {
+        return 0;
+    }
+    left = int_set_verify(item->left);
+    right = int_set_verify(item->right);
+    assert(left - right <= 1 && right - left <= 1);
+    assert(item->height == 1 + (left > right ? left : right));
+    assert(!item->left || item->left->key < item->key);
+    assert(!item->right || item->right->key > item->key);
+    return item->height;
+}
+
+static void test_generic_set(void)
+{
+    int i;
+    int_set me = int_set_init();
+    assert(me);
+    assert(!int_set_contains(me, 0));
+    for (i = 0; i < 1000; i++) {
+        assert(int_set_put(me, (i * 7919) % 1000) == 0);
+        int_set_verify(me->root);
+    }
+    assert(int_set_put(me, 5) == 0);
+    assert(int_set_size(me) == 1000);
+    for (i = 0; i < 1000; i += 3) {
+        assert(int_set_remove(me, i));
+        int_set_verify(me->root);
+    }
+    assert(!int_set_remove(me, 0));
+    assert(!int_set_remove(me, 1000));
+    for (i = 0; i < 1000; i++) {
+        assert(int_set_contains(me, i) == (i % 3 != 0));
+    }
+    fail_malloc = 1;
+    assert(int_set_put(me, 3000) == -ENOMEM);
+    assert(!int_set_contains(me, 3000));
+    int_set_verify(me->root);
+    int_set_clear(me);
+    assert(int_set_is_empty(me));
+    assert(!int_set_destroy(me));
+}
+
+void test_generic(void)
+{
+    test_generic_vector();
+    test_generic_deque();
+    test_generic_priority_queue();
+    test_generic_unordered_map();
+    test_generic_unordered_set();
+    test_generic_map();
+    test_generic_set();
+}
@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "../src/include/hash.h"
+#include "../src/include/unordered_set.h"
+#include "../src/include/unordered_map.h"
+#include "../src/include/unordered_multiset.h"
+
+struct point {
+    int x;
+    int y;
+};
+
+static int compare_int(const void *const one, const void *const two)
+{
+    const int a = *(int *) one;
+    const int b = *(int *) two;
+    return a - b;
+}
+
+static int compare_long(const void *const one, const void *const two)
+{
+    const long a = *(long *) one;
+    const long b = *(long *) two;
+    return (a > b) - (a < b);
+}
+
+static int compare_string(const void *const one, const void *const two)
+{
+    const char *const a = *(char **) one;
+    const char *const b = *(char **) two;
+    return strcmp(a, b);
+}
+
+static int compare_point(const void *const one, const void *const two)
+{
+    return memcmp(one, two, sizeof(struct point));
+}
+
+static void test_bytes(void)
+{
+    const char data[] = "the quick brown fox jumps over the lazy dog";
+    char copy[sizeof(data)];
+    int i;
+    memcpy(copy, data, sizeof(data));
+    assert(containers_hash_bytes(data, sizeof(data))
+           == containers_hash_bytes(copy, sizeof(copy)));
+    for (i = 0; i < (int) sizeof(data); i++) {
+        assert(containers_hash_bytes(data, (size_t) i)
+               != containers_hash_bytes(data, (size_t) i + 1));
+    }
+    copy[sizeof(copy) - 2] = 'G';
+    assert(containers_hash_bytes(data, sizeof(data))
+           != containers_hash_bytes(copy, sizeof(copy)));
+}
+
+static void test_seeded(void)
+{
+    const char data[] = "0123456789abcdef0123456789abcdef";
+    unsigned long hashes[32];
+    char copy[sizeof(data)];
+    int buckets[64];
+    int i;
+    int j;
+    for (i = 0; i < 32; i++) {
+        hashes[i] = containers_hash_bytes_seeded(data, sizeof(data),
+                                                 (unsigned long) i);
+        for (j = 0; j < i; j++) {
+            assert(hashes[i] != hashes[j]);
+        }
+    }
+    memcpy(copy, data, sizeof(data));
+    for (i = 0; i < (int) sizeof(data) * 8; i++) {
+        copy[i / 8] ^= (char) (1 << i % 8);
+        assert(containers_hash_bytes_seeded(copy, sizeof(copy), 7)
+               != containers_hash_bytes_seeded(data, sizeof(data), 7));
+        copy[i / 8] ^= (char) (1 << i % 8);
+    }
+    memset(buckets, 0, sizeof(buckets));
+    for (i = 0; i < 64 * 1000; i++) {
+        const long key = (long) i << 8;
+        buckets[containers_hash_bytes_seeded(&key, sizeof(long), 12345)
+                % 64]++;
+    }
+    for (i = 0; i < 64; i++) {
+        assert(buckets[i] > 800 && buckets[i] < 1200);
+    }
+}
+
+static void test_distribution(void)
+{
+    int buckets[64];
+    int i;
+    memset(buckets, 0, sizeof(buckets));
+    for (i = 0; i < 64 * 1000; i++) {
+        const int key = i * 64;
+        buckets[containers_hash_int(&key) % 64]++;
+    }
+    for (i = 0; i < 64; i++) {
+        assert(buckets[i] > 800 && buckets[i] < 1200);
+    }
+}
+
+static void test_scalars(void)
+{
+    const char one[] = "hello";
+    const char two[] = "hello";
+    const char *string;
+    int key = 5;
+    long long_key = 5;
+    string = one;
+    assert(containers_hash_string(&string) == containers_hash_bytes(one, 5));
+    string = two;
+    assert(containers_hash_string(&string) == containers_hash_bytes(one, 5));
+    assert(containers_hash_int(&key) == containers_hash_long(&long_key));
+    key = 6;
+    assert(containers_hash_int(&key) != containers_hash_long(&long_key));
+}
+
+static void test_int_set(void)
+{
+    int i;
+    unordered_set me = unordered_set_init(sizeof(int), containers_hash_int,
+                                         compare_int);
+    assert(me);
+    for (i = -1000; i < 1000; i++) {
+        assert(unordered_set_put(me, &i) == 0);
+    }
+    assert(unordered_set_rehash(me) == 0);
+    assert(unordered_set_size(me) == 2000);
+    for (i = -1000; i < 1000; i++) {
+        assert(unordered_set_contains(me, &i));
+    }
+    i = 1000;
+    assert(!unordered_set_contains(me, &i));
+    assert(!unordered_set_destroy(me));
+}
+
+static void test_string_set(void)
+{
+    char words[3][8] = {"alpha", "beta", "gamma"};
+    char other[8] = "beta";
+    char *key;
+    int i;
+    unordered_set me = unordered_set_init(sizeof(char *),
+                                         containers_hash_string,
+                                         compare_string);
+    assert(me);
+    for (i = 0; i < 3; i++) {
+        key = words[i];
+        assert(unordered_set_put(me, &key) == 0);
+    }
+    key = other;
+    assert(unordered_set_put(me, &key) == 0);
+    assert(unordered_set_size(me) == 3);
+    assert(unordered_set_contains(me, &key));
+    key = "delta";
+    assert(!unordered_set_contains(me, &key));
+    assert(!unordered_set_destroy(me));
+}
+
+static void test_key_map(void)
+{
+    struct point key;
+    int value;
+    int i;
+    unordered_map me = unordered_map_init(sizeof(struct point), sizeof(int),
+                                         containers_hash_key, compare_point);
+    assert(me);
+    memset(&key, 0, sizeof(key));
+    for (i = 0; i < 1000; i++) {
+        key.x = i;
+        key.y = -i;
+        assert(unordered_map_put(me, &key, &i) == 0);
+    }
+    assert(unordered_map_size(me) == 1000);
+    for (i = 0; i < 1000; i++) {
+        key.x = i;
+        key.y = -i;
+        assert(unordered_map_get(&value, me, &key));
+        assert(value == i);
+    }
+    key.x = 1;
+    key.y = 1;
+    assert(!unordered_map_contains(me, &key));
+    assert(!unordered_map_destroy(me));
+}
+
+static void test_long_multiset(void)
+{
+    long key;
+    unordered_multiset me = unordered_multiset_init(sizeof(long),
+                                                   containers_hash_long,
+                                                   compare_long);
+    assert(me);
+    for (key = 0; key < 1000; key++) {
+        assert(unordered_multiset_put(me, &key) == 0);
+        assert(unordered_multiset_put(me, &key) == 0);
+    }
+    assert(unordered_multiset_size(me) == 2000);
+    for (key = 0; key < 1000; key++) {
+        assert(unordered_multiset_count(me, &key) == 2);
+    }
+    assert(!unordered_multiset_destroy(me));
+}
+
+static void test_seeded_chain_guard(void)
+{
+    int i;
+    unordered_set me = unordered_set_init(sizeof(int), containers_hash_int,
+                                         compare_int);
+    assert(me);
+    assert(unordered_set_set_max_chain_length(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_set_put(me, &i) == 0);
+    }
+    fail_calloc = 1;
+    for (i = 1000; i < 1010; i++) {
+        assert(unordered_set_put(me, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_set_size(me) == 1010);
+    for (i = 0; i < 1010; i++) {
+        assert(unordered_set_contains(me, &i));
+    }
+    assert(!unordered_set_destroy(me));
+}
+
+static void test_seeded_save_load(void)
+{
+    FILE *const file = tmpfile();
+    struct point key;
+    int value;
+    int fd;
+    int i;
+    unordered_map me = unordered_map_init(sizeof(struct point), sizeof(int),
+                                         containers_hash_key, compare_point);
+    unordered_map load = unordered_map_init(sizeof(struct point), sizeof(int),
+                                           containers_hash_key,
+                                           compare_point);
+    assert(file && me && load);
+    fd = fileno(file);
+    memset(&key, 0, sizeof(key));
+    for (i = 0; i < 1000; i++) {
+        key.x = i;
+        key.y = i * i;
+        assert(unordered_map_put(me, &key, &i) == 0);
+    }
+    assert(unordered_map_save(me, fd) == 0);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_map_load(load, fd) == 0);
+    assert(unordered_map_size(load) == 1000);
+    for (i = 0; i < 1000; i++) {
+        key.x = i;
+        key.y = i * i;
+        assert(unordered_map_get(&value, load, &key));
+        assert(value == i);
+    }
+    assert(!unordered_map_destroy(load));
+    assert(!unordered_map_destroy(me));
+    fclose(file);
+}
+
+static void test_new_seed(void)
+{
+    unsigned long seeds[16];
+    int i;
+    int j;
+    for (i = 0; i < 16; i++) {
+        assert(containers_hash_new_seed(&seeds[i], seeds) == 0);
+        for (j = 0; j < i; j++) {
+            assert(seeds[i] != seeds[j]);
+        }
+    }
+}
+
+void test_hash(void)
+{
+    test_bytes();
+    test_seeded();
+    test_new_seed();
+    test_distribution();
+    test_scalars();
+    test_int_set();
+    test_string_set();
+    test_key_map();
+    test_long_multiset();
+    test_seeded_chain_guard();
+    test_seeded_save_load();
+}
@@ -260,6 +260,141 @@ static void test_add_last_out_of_memory(void)
     assert(!list_destroy(me));
 }
 
+static void test_cursor(void)
+{
+    struct list_cursor cursor;
+    int arr[10];
+    int get;
+    int i;
+    list me = list_init(sizeof(int));
+    assert(me);
+    assert(!list_cursor_first(me, &cursor));
+    assert(list_cursor_index(&cursor) == -1);
+    assert(list_cursor_get(&get, me, &cursor) == -EINVAL);
+    assert(list_cursor_add_after(me, &cursor, &get) == -EINVAL);
+    assert(!list_cursor_remove(me, &cursor));
+    for (i = 0; i < 5; i++) {
+        assert(list_add_last(me, &i) == 0);
+    }
+    assert(list_cursor_first(me, &cursor));
+    for (i = 0; i < 5; i++) {
+        get = 0xdeadbeef;
+        assert(list_cursor_index(&cursor) == i);
+        assert(list_cursor_get(&get, me, &cursor) == 0);
+        assert(get == i);
+        get = 10 * i;
+        assert(list_cursor_set(me, &cursor, &get) == 0);
+        assert(list_cursor_next(me, &cursor) == (i < 4));
+    }
+    assert(list_cursor_first(me, &cursor));
+    get = -1;
+    assert(list_cursor_add_before(me, &cursor, &get) == 0);
+    assert(list_cursor_index(&cursor) == 1);
+    get = 5;
+    assert(list_cursor_add_after(me, &cursor, &get) == 0);
+    assert(list_cursor_next(me, &cursor));
+    assert(list_cursor_next(me, &cursor));
+    assert(list_cursor_remove(me, &cursor));
+    assert(list_cursor_index(&cursor) == 3);
+    assert(list_size(me) == 6);
+    list_copy_to_array(arr, me);
+    assert(arr[0] == -1);
+    assert(arr[1] == 0);
+    assert(arr[2] == 5);
+    assert(arr[3] == 20);
+    assert(arr[4] == 30);
+    assert(arr[5] == 40);
+    assert(list_cursor_last(me, &cursor));
+    assert(list_cursor_index(&cursor) == 5);
+    assert(list_cursor_prev(me, &cursor));
+    assert(list_cursor_next(me, &cursor));
+    assert(!list_cursor_remove(me, &cursor));
+    assert(list_size(me) == 5);
+    get = 0xdeadbeef;
+    assert(list_get_last(&get, me) == 0);
+    assert(get == 30);
+    get = 50;
+    assert(list_add_last(me, &get) == 0);
+    get = 0xdeadbeef;
+    assert(list_get_at(&get, me, 4) == 0);
+    assert(get == 30);
+    get = 0xdeadbeef;
+    assert(list_get_last(&get, me) == 0);
+    assert(get == 50);
+    assert(list_cursor_first(me, &cursor));
+    while (list_cursor_remove(me, &cursor)) {
+    }
+    assert(list_is_empty(me));
+    get = 1;
+    assert(list_add_last(me, &get) == 0);
+    get = 0xdeadbeef;
+    assert(list_get_last(&get, me) == 0);
+    assert(get == 1);
+    assert(list_cursor_first(me, &cursor));
+    fail_malloc = 1;
+    assert(list_cursor_add_after(me, &cursor, &get) == -ENOMEM);
+    fail_malloc = 1;
+    delay_fail_malloc = 1;
+    assert(list_cursor_add_before(me, &cursor, &get) == -ENOMEM);
+    assert(list_size(me) == 1);
+    assert(!list_destroy(me));
+}
+
+static void test_sequential_access(void)
+{
+    int model[200];
+    int count = 0;
+    int get;
+    int i;
+    int j;
+    list me = list_init(sizeof(int));
+    assert(me);
+    for (i = 0; i < 100; i++) {
+        const int index = (i * 7) % (count + 1);
+        for (j = count; j > index; j--) {
+            model[j] = model[j - 1];
+        }
+        model[index] = i;
+        count++;
+        assert(list_add_at(me, index, &i) == 0);
+        get = 0xdeadbeef;
+        assert(list_get_at(&get, me, count / 2) == 0);
+        assert(get == model[count / 2]);
+    }
+    for (i = 0; i < 40; i++) {
+        const int index = (i * 13) % count;
+        for (j = index; j < count - 1; j++) {
+            model[j] = model[j + 1];
+        }
+        count--;
+        assert(list_remove_at(me, index) == 0);
+        if (count > 0) {
+            get = 0xdeadbeef;
+            assert(list_get_at(&get, me, index % count) == 0);
+            assert(get == model[index % count]);
+        }
+    }
+    for (i = 0; i < count; i++) {
+        get = 0xdeadbeef;
+        assert(list_get_at(&get, me, i) == 0);
+        assert(get == model[i]);
+        get = -i;
+        assert(list_set_at(me, i, &get) == 0);
+    }
+    for (i = count - 1; i >= 0; i--) {
+        get = 0xdeadbeef;
+        assert(list_get_at(&get, me, i) == 0);
+        assert(get == -i);
+    }
+    list_clear(me);
+    assert(list_remove_first(me) == -EINVAL);
+    assert(list_add_first(me, &i) == 0);
+    get = 0xdeadbeef;
+    assert(list_get_last(&get, me) == 0);
+    assert(get == i);
+    assert(!list_destroy(me));
+}
+
 void test_list(void)
 {
     test_invalid_init();
@@ -268,4 +403,6 @@ void test_list(void)
     test_add_first_out_of_memory();
     test_add_at_out_of_memory();
     test_add_last_out_of_memory();
+    test_cursor();
+    test_sequential_access();
 }
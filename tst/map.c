@@ -1,3 +1,5 @@
+#include <stdio.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/map.h"
 
@@ -18,6 +20,7 @@ struct internal_map {
 struct node {
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     void *value;
     struct node *left;
@@ -66,9 +69,25 @@ static int map_compute_size(struct node *const item)
     return 1 + map_compute_size(item->left) + map_compute_size(item->right);
 }
 
+/*
+ * Verifies that the weight of each item is the amount of keys in its subtree.
+ */
+static int map_verify_weight(struct node *const item)
+{
+    int weight;
+    if (!item) {
+        return 0;
+    }
+    weight = 1 + map_verify_weight(item->left) +
+             map_verify_weight(item->right);
+    assert(item->weight == weight);
+    return weight;
+}
+
 static void map_verify(map me)
 {
     map_verify_recursive(me->root);
+    map_verify_weight(me->root);
     assert(map_compute_size(me->root) == map_size(me));
 }
 
@@ -549,6 +568,179 @@ static void test_put_out_of_memory(void)
     assert(!map_destroy(me));
 }
 
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    map me;
+    map load;
+    map empty;
+    assert(file);
+    fd = fileno(file);
+    me = map_init(sizeof(int), sizeof(int), compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int key = i * 37 % 1000;
+        int value = 2 * key;
+        assert(map_put(me, &key, &value) == 0);
+    }
+    empty = map_init(sizeof(int), sizeof(int), compare_int);
+    assert(empty);
+    assert(map_save(me, fd) == 0);
+    assert(map_save(empty, fd) == 0);
+    assert(map_load(me, fd) == -EINVAL);
+    load = map_init(sizeof(int), sizeof(int), compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(map_load(load, fd) == 0);
+    map_verify(load);
+    assert(map_size(load) == 1000);
+    for (i = 0; i < 1000; i++) {
+        int value = 0;
+        assert(map_get(&value, load, &i));
+        assert(value == 2 * i);
+    }
+    assert(map_load(empty, fd) == 0);
+    assert(map_is_empty(empty));
+    assert(map_load(empty, fd) == -EIO);
+    for (i = 0; i < 1000; i += 2) {
+        assert(map_remove(load, &i));
+    }
+    map_verify(load);
+    assert(map_size(load) == 500);
+    map_clear(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    fail_malloc = 1;
+    assert(map_load(load, fd) == -ENOMEM);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    delay_fail_malloc = 1000;
+    fail_malloc = 1;
+    assert(map_load(load, fd) == -ENOMEM);
+    delay_fail_malloc = 0;
+    fail_malloc = 0;
+    assert(map_is_empty(load));
+    assert(!map_destroy(load));
+    fail_malloc = 1;
+    assert(map_save(me, fd) == -ENOMEM);
+    load = map_init(sizeof(int), sizeof(long), compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(map_load(load, fd) == -EINVAL);
+    assert(!map_destroy(load));
+    assert(!map_destroy(empty));
+    assert(!map_destroy(me));
+    fclose(file);
+}
+
+static void test_rank_select(void)
+{
+    int i;
+    int key;
+    int value;
+    map me = map_init(sizeof(int), sizeof(int), compare_int);
+    assert(me);
+    assert(map_select(&key, &value, me, 0) == -EINVAL);
+    key = 5;
+    assert(map_rank(me, &key) == 0);
+    for (i = 0; i < 1000; i++) {
+        key = i * 37 % 1000 * 2;
+        value = key + 1;
+        assert(map_put(me, &key, &value) == 0);
+    }
+    map_verify(me);
+    for (i = 0; i < 1000; i++) {
+        key = 2 * i;
+        assert(map_rank(me, &key) == i);
+        key = 2 * i + 1;
+        assert(map_rank(me, &key) == i + 1);
+        assert(map_select(&key, &value, me, i) == 0);
+        assert(key == 2 * i);
+        assert(value == 2 * i + 1);
+    }
+    value = 0;
+    assert(map_select(NULL, &value, me, 7) == 0);
+    assert(value == 15);
+    assert(map_select(&key, NULL, me, 8) == 0);
+    assert(key == 16);
+    assert(map_select(&key, &value, me, -1) == -EINVAL);
+    assert(map_select(&key, &value, me, 1000) == -EINVAL);
+    for (i = 0; i < 1000; i += 3) {
+        key = 2 * i;
+        assert(map_remove(me, &key));
+    }
+    map_verify(me);
+    for (i = 0; i < map_size(me); i++) {
+        assert(map_select(&key, NULL, me, i) == 0);
+        assert(map_rank(me, &key) == i);
+    }
+    assert(!map_destroy(me));
+}
+
+static void test_combine(void)
+{
+    int i;
+    int key;
+    int value;
+    map one = map_init(sizeof(int), sizeof(int), compare_int);
+    map two = map_init(sizeof(int), sizeof(int), compare_int);
+    map result = map_init(sizeof(int), sizeof(int), compare_int);
+    map other = map_init(sizeof(int), sizeof(long), compare_int);
+    assert(one && two && result && other);
+    for (i = 0; i < 1000; i++) {
+        key = i * 37 % 1000;
+        if (key % 2 == 0) {
+            value = 1;
+            assert(map_put(one, &key, &value) == 0);
+        }
+        if (key % 3 == 0) {
+            value = 2;
+            assert(map_put(two, &key, &value) == 0);
+        }
+    }
+    assert(map_union(result, one, two) == 0);
+    map_verify(result);
+    assert(map_size(result) == 667);
+    for (i = 0; i < 1000; i++) {
+        value = 0;
+        assert(map_get(&value, result, &i) == (i % 2 == 0 || i % 3 == 0));
+        if (i % 2 == 0) {
+            assert(value == 1);
+        } else if (i % 3 == 0) {
+            assert(value == 2);
+        }
+    }
+    map_clear(result);
+    assert(map_intersection(result, two, one) == 0);
+    map_verify(result);
+    assert(map_size(result) == 167);
+    for (i = 0; i < 1000; i += 6) {
+        assert(map_get(&value, result, &i));
+        assert(value == 2);
+    }
+    assert(map_is_subset(result, one));
+    assert(!map_is_subset(two, result));
+    map_clear(result);
+    assert(map_difference(result, two, one) == 0);
+    map_verify(result);
+    assert(map_size(result) == 167);
+    for (i = 0; i < 1000; i++) {
+        assert(map_contains(result, &i) == (i % 3 == 0 && i % 2 != 0));
+    }
+    assert(map_union(result, one, two) == -EINVAL);
+    assert(map_union(other, one, two) == -EINVAL);
+    map_clear(result);
+    fail_malloc = 1;
+    delay_fail_malloc = 100;
+    assert(map_union(result, one, two) == -ENOMEM);
+    delay_fail_malloc = 0;
+    assert(map_is_empty(result));
+    assert(!map_destroy(one));
+    assert(!map_destroy(two));
+    assert(!map_destroy(result));
+    assert(!map_destroy(other));
+}
+
 void test_map(void)
 {
     test_invalid_init();
@@ -562,4 +754,7 @@ void test_map(void)
     test_override_value();
     test_init_out_of_memory();
     test_put_out_of_memory();
+    test_save_load();
+    test_rank_select();
+    test_combine();
 }
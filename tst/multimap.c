@@ -1,3 +1,5 @@
+#include <stdio.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/multimap.h"
 
@@ -11,7 +13,7 @@ struct internal_multimap {
     int (*value_comparator)(const void *const one, const void *const two);
     int size;
     struct node *root;
-    struct value_node *iterate_get;
+    struct multimap_values iterate;
 };
 
 /*
@@ -20,9 +22,11 @@ struct internal_multimap {
 struct node {
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     int value_count;
-    struct value_node *head;
+    int value_capacity;
+    char *values;
     struct node *left;
     struct node *right;
 };
@@ -65,13 +69,30 @@ static int multimap_compute_size(struct node *const item)
     if (!item) {
         return 0;
     }
-    return 1 + multimap_compute_size(item->left) +
+    return item->value_count + multimap_compute_size(item->left) +
            multimap_compute_size(item->right);
 }
 
+/*
+ * Verifies that the weight of each item is the amount of elements in its
+ * subtree.
+ */
+static int multimap_verify_weight(struct node *const item)
+{
+    int weight;
+    if (!item) {
+        return 0;
+    }
+    weight = item->value_count + multimap_verify_weight(item->left) +
+             multimap_verify_weight(item->right);
+    assert(item->weight == weight);
+    return weight;
+}
+
 static void multimap_verify(multimap me)
 {
     multimap_verify_recursive(me->root);
+    multimap_verify_weight(me->root);
     assert(multimap_compute_size(me->root) == multimap_size(me));
 }
 
@@ -561,9 +582,6 @@ static void test_put_root_out_of_memory(multimap me)
     fail_malloc = 1;
     delay_fail_malloc = 2;
     assert(multimap_put(me, &key, &key) == -ENOMEM);
-    fail_malloc = 1;
-    delay_fail_malloc = 3;
-    assert(multimap_put(me, &key, &key) == -ENOMEM);
 }
 
 static void test_put_on_left_out_of_memory(multimap me)
@@ -577,9 +595,6 @@ static void test_put_on_left_out_of_memory(multimap me)
     fail_malloc = 1;
     delay_fail_malloc = 2;
     assert(multimap_put(me, &key, &key) == -ENOMEM);
-    fail_malloc = 1;
-    delay_fail_malloc = 3;
-    assert(multimap_put(me, &key, &key) == -ENOMEM);
 }
 
 static void test_put_on_right_out_of_memory(multimap me)
@@ -593,9 +608,6 @@ static void test_put_on_right_out_of_memory(multimap me)
     fail_malloc = 1;
     delay_fail_malloc = 2;
     assert(multimap_put(me, &key, &key) == -ENOMEM);
-    fail_malloc = 1;
-    delay_fail_malloc = 3;
-    assert(multimap_put(me, &key, &key) == -ENOMEM);
 }
 
 static void test_put_out_of_memory(void)
@@ -608,6 +620,214 @@ static void test_put_out_of_memory(void)
     assert(multimap_put(me, &key, &key) == 0);
     test_put_on_left_out_of_memory(me);
     test_put_on_right_out_of_memory(me);
+    fail_realloc = 1;
+    assert(multimap_put(me, &key, &key) == -ENOMEM);
+    assert(multimap_count(me, &key) == 1);
+    assert(multimap_size(me) == 1);
+    assert(!multimap_destroy(me));
+}
+
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    multimap me;
+    multimap load;
+    assert(file);
+    fd = fileno(file);
+    me = multimap_init(sizeof(int), sizeof(int), compare_int, compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int key = i * 37 % 500;
+        assert(multimap_put(me, &key, &i) == 0);
+    }
+    assert(multimap_save(me, fd) == 0);
+    assert(multimap_load(me, fd) == -EINVAL);
+    load = multimap_init(sizeof(int), sizeof(int), compare_int, compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(multimap_load(load, fd) == 0);
+    multimap_verify_recursive(load->root);
+    assert(multimap_size(load) == 1000);
+    for (i = 0; i < 500; i++) {
+        int first = -1;
+        int second = -1;
+        assert(multimap_count(load, &i) == 2);
+        multimap_get_start(load, &i);
+        assert(multimap_get_next(&first, load));
+        assert(multimap_get_next(&second, load));
+        assert(!multimap_get_next(&second, load));
+        assert(first < second);
+        assert(first * 37 % 500 == i);
+        assert(second * 37 % 500 == i);
+    }
+    multimap_clear(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    delay_fail_malloc = 1000;
+    fail_malloc = 1;
+    assert(multimap_load(load, fd) == -ENOMEM);
+    delay_fail_malloc = 0;
+    fail_malloc = 0;
+    assert(multimap_is_empty(load));
+    assert(!multimap_destroy(load));
+    fail_malloc = 1;
+    assert(multimap_save(me, fd) == -ENOMEM);
+    load = multimap_init(sizeof(int), sizeof(long), compare_int, compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(multimap_load(load, fd) == -EINVAL);
+    assert(!multimap_destroy(load));
+    assert(!multimap_destroy(me));
+    fclose(file);
+}
+
+static void test_get_values(void)
+{
+    int *values;
+    int key = -1;
+    int i;
+    multimap me = multimap_init(sizeof(int), sizeof(int), compare_int,
+                                compare_int);
+    assert(me);
+    assert(multimap_get_values((void **) &values, me, &key) == 0);
+    assert(!values);
+    for (i = 0; i < 1000; i++) {
+        assert(multimap_put(me, &key, &i) == 0);
+        assert(multimap_put(me, &i, &i) == 0);
+    }
+    assert(multimap_get_values((void **) &values, me, &key) == 1000);
+    for (i = 0; i < 1000; i++) {
+        assert(values[i] == i);
+    }
+    for (i = 0; i < 1000; i += 2) {
+        assert(multimap_remove(me, &key, &i) == 1);
+    }
+    assert(!multimap_remove(me, &key, &key));
+    assert(multimap_count(me, &key) == 500);
+    assert(multimap_get_values((void **) &values, me, &key) == 500);
+    for (i = 0; i < 500; i++) {
+        assert(values[i] == 2 * i + 1);
+    }
+    multimap_get_start(me, &key);
+    for (i = 0; i < 500; i++) {
+        int get = 0xdeadbeef;
+        assert(multimap_get_next(&get, me));
+        assert(get == values[i]);
+    }
+    assert(!multimap_get_next(&i, me));
+    for (i = 1; i < 999; i += 2) {
+        assert(multimap_remove(me, &key, &i) == 1);
+    }
+    assert(multimap_get_values((void **) &values, me, &key) == 1);
+    assert(values[0] == 999);
+    i = 999;
+    assert(multimap_remove(me, &key, &i) == 1);
+    assert(!multimap_contains(me, &key));
+    multimap_get_start(me, &key);
+    assert(!multimap_get_next(&i, me));
+    assert(multimap_size(me) == 1000);
+    multimap_verify(me);
+    assert(!multimap_destroy(me));
+}
+
+static void test_values_cursor(void)
+{
+    struct multimap_values one;
+    struct multimap_values two;
+    int key;
+    int value;
+    int i;
+    int j;
+    multimap me = multimap_init(sizeof(int), sizeof(int), compare_int,
+                                compare_int);
+    assert(me);
+    key = 3;
+    assert(multimap_values_start(me, &one, &key) == 0);
+    assert(!multimap_values_next(&value, me, &one));
+    for (i = 0; i < 10; i++) {
+        key = i % 2;
+        assert(multimap_put(me, &key, &i) == 0);
+    }
+    key = 0;
+    assert(multimap_values_start(me, &one, &key) == 5);
+    key = 1;
+    assert(multimap_values_start(me, &two, &key) == 5);
+    multimap_get_start(me, &key);
+    for (i = 0; i < 5; i++) {
+        value = -1;
+        assert(multimap_values_next(&value, me, &one));
+        assert(value == 2 * i);
+        for (j = 0; j < 2; j++) {
+            value = -1;
+            assert(multimap_values_next(&value, me, &two));
+            assert(value == 2 * ((2 * i + j) % 5) + 1);
+            if ((2 * i + j) % 5 == 4) {
+                key = 1;
+                assert(multimap_values_start(me, &two, &key) == 5);
+            }
+        }
+        value = -1;
+        assert(multimap_get_next(&value, me));
+        assert(value == 2 * i + 1);
+    }
+    assert(!multimap_values_next(&value, me, &one));
+    assert(!multimap_get_next(&value, me));
+    assert(!multimap_destroy(me));
+}
+
+static void test_rank_select(void)
+{
+    int i;
+    int key;
+    int value;
+    multimap me = multimap_init(sizeof(int), sizeof(int), compare_int,
+                                compare_int);
+    assert(me);
+    assert(multimap_select(&key, &value, me, 0) == -EINVAL);
+    for (i = 0; i < 300; i++) {
+        key = i * 37 % 300;
+        value = 0;
+        assert(multimap_put(me, &key, &value) == 0);
+        if (key % 2 == 0) {
+            value = 1;
+            assert(multimap_put(me, &key, &value) == 0);
+        }
+    }
+    multimap_verify(me);
+    assert(multimap_size(me) == 450);
+    for (i = 0; i < 300; i++) {
+        const int rank = i + (i + 1) / 2;
+        key = i;
+        assert(multimap_rank(me, &key) == rank);
+        assert(multimap_select(&key, &value, me, rank) == 0);
+        assert(key == i);
+        assert(value == 0);
+        if (i % 2 == 0) {
+            assert(multimap_select(&key, &value, me, rank + 1) == 0);
+            assert(key == i);
+            assert(value == 1);
+        }
+    }
+    key = 300;
+    assert(multimap_rank(me, &key) == 450);
+    assert(multimap_select(&key, &value, me, -1) == -EINVAL);
+    assert(multimap_select(&key, &value, me, 450) == -EINVAL);
+    for (i = 0; i < 300; i += 2) {
+        key = i;
+        value = 0;
+        assert(multimap_remove(me, &key, &value));
+    }
+    multimap_verify(me);
+    for (i = 0; i < 300; i += 3) {
+        key = i;
+        assert(multimap_remove_all(me, &key));
+    }
+    multimap_verify(me);
+    for (i = 0; i < multimap_size(me); i++) {
+        assert(multimap_select(&key, NULL, me, i) == 0);
+        assert(multimap_rank(me, &key) <= i);
+    }
     assert(!multimap_destroy(me));
 }
 
@@ -625,4 +845,8 @@ void test_multimap(void)
     test_multiple_operations();
     test_init_out_of_memory();
     test_put_out_of_memory();
+    test_save_load();
+    test_get_values();
+    test_values_cursor();
+    test_rank_select();
 }
@@ -1,3 +1,5 @@
+#include <stdio.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/multiset.h"
 
@@ -18,6 +20,7 @@ struct node {
     int count;
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     struct node *left;
     struct node *right;
@@ -61,13 +64,30 @@ static int multiset_compute_size(struct node *const item)
     if (!item) {
         return 0;
     }
-    return 1 + multiset_compute_size(item->left) +
+    return item->count + multiset_compute_size(item->left) +
            multiset_compute_size(item->right);
 }
 
+/*
+ * Verifies that the weight of each item is the amount of elements in its
+ * subtree.
+ */
+static int multiset_verify_weight(struct node *const item)
+{
+    int weight;
+    if (!item) {
+        return 0;
+    }
+    weight = item->count + multiset_verify_weight(item->left) +
+             multiset_verify_weight(item->right);
+    assert(item->weight == weight);
+    return weight;
+}
+
 static void multiset_verify(multiset me)
 {
     multiset_verify_recursive(me->root);
+    multiset_verify_weight(me->root);
     assert(multiset_compute_size(me->root) == multiset_size(me));
 }
 
@@ -531,6 +551,160 @@ static void test_put_out_of_memory(void)
     assert(!multiset_destroy(me));
 }
 
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    multiset me;
+    multiset load;
+    assert(file);
+    fd = fileno(file);
+    me = multiset_init(sizeof(int), compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int key = i * 37 % 1000;
+        int j;
+        for (j = 0; j <= key % 3; j++) {
+            assert(multiset_put(me, &key) == 0);
+        }
+    }
+    assert(multiset_size(me) == 1999);
+    assert(multiset_save(me, fd) == 0);
+    assert(multiset_load(me, fd) == -EINVAL);
+    load = multiset_init(sizeof(int), compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(multiset_load(load, fd) == 0);
+    multiset_verify_recursive(load->root);
+    assert(multiset_size(load) == 1999);
+    for (i = 0; i < 1000; i++) {
+        assert(multiset_count(load, &i) == i % 3 + 1);
+    }
+    i = 2;
+    assert(multiset_remove_all(load, &i));
+    assert(multiset_size(load) == 1996);
+    multiset_verify_recursive(load->root);
+    multiset_clear(load);
+    assert(multiset_load(load, fd) == -EIO);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    delay_fail_malloc = 1000;
+    fail_malloc = 1;
+    assert(multiset_load(load, fd) == -ENOMEM);
+    delay_fail_malloc = 0;
+    fail_malloc = 0;
+    assert(multiset_is_empty(load));
+    assert(!multiset_destroy(load));
+    fail_malloc = 1;
+    assert(multiset_save(me, fd) == -ENOMEM);
+    assert(!multiset_destroy(me));
+    fclose(file);
+}
+
+static void test_rank_select(void)
+{
+    int i;
+    int key;
+    multiset me = multiset_init(sizeof(int), compare_int);
+    assert(me);
+    assert(multiset_select(&key, me, 0) == -EINVAL);
+    for (i = 0; i < 300; i++) {
+        key = i * 37 % 300;
+        assert(multiset_put(me, &key) == 0);
+        if (key % 2 == 0) {
+            assert(multiset_put(me, &key) == 0);
+        }
+    }
+    multiset_verify(me);
+    assert(multiset_size(me) == 450);
+    for (i = 0; i < 300; i++) {
+        const int rank = i + (i + 1) / 2;
+        key = i;
+        assert(multiset_rank(me, &key) == rank);
+        assert(multiset_select(&key, me, rank) == 0);
+        assert(key == i);
+        if (i % 2 == 0) {
+            assert(multiset_select(&key, me, rank + 1) == 0);
+            assert(key == i);
+        }
+    }
+    key = 300;
+    assert(multiset_rank(me, &key) == 450);
+    assert(multiset_select(&key, me, -1) == -EINVAL);
+    assert(multiset_select(&key, me, 450) == -EINVAL);
+    for (i = 0; i < 300; i += 2) {
+        key = i;
+        assert(multiset_remove(me, &key));
+    }
+    multiset_verify(me);
+    for (i = 0; i < 300; i += 3) {
+        key = i;
+        assert(multiset_remove_all(me, &key));
+    }
+    multiset_verify(me);
+    for (i = 0; i < multiset_size(me); i++) {
+        assert(multiset_select(&key, me, i) == 0);
+        assert(multiset_rank(me, &key) == i);
+    }
+    assert(!multiset_destroy(me));
+}
+
+static void test_combine(void)
+{
+    int i;
+    int key;
+    multiset one = multiset_init(sizeof(int), compare_int);
+    multiset two = multiset_init(sizeof(int), compare_int);
+    multiset result = multiset_init(sizeof(int), compare_int);
+    assert(one && two && result);
+    for (i = 0; i < 100; i++) {
+        int j;
+        key = i * 37 % 100;
+        for (j = 0; j < key % 3; j++) {
+            assert(multiset_put(one, &key) == 0);
+        }
+        for (j = 0; j < key % 4; j++) {
+            assert(multiset_put(two, &key) == 0);
+        }
+    }
+    assert(multiset_union(result, one, two) == 0);
+    multiset_verify(result);
+    for (i = 0; i < 100; i++) {
+        const int count = i % 3 > i % 4 ? i % 3 : i % 4;
+        assert(multiset_count(result, &i) == count);
+    }
+    multiset_clear(result);
+    assert(multiset_intersection(result, one, two) == 0);
+    multiset_verify(result);
+    for (i = 0; i < 100; i++) {
+        const int count = i % 3 < i % 4 ? i % 3 : i % 4;
+        assert(multiset_count(result, &i) == count);
+    }
+    assert(multiset_is_subset(result, one));
+    assert(multiset_is_subset(result, two));
+    assert(!multiset_is_subset(one, two));
+    assert(!multiset_is_subset(two, one));
+    multiset_clear(result);
+    assert(multiset_difference(result, one, two) == 0);
+    multiset_verify(result);
+    for (i = 0; i < 100; i++) {
+        const int count = i % 3 > i % 4 ? i % 3 - i % 4 : 0;
+        assert(multiset_count(result, &i) == count);
+    }
+    assert(multiset_union(result, one, two) == -EINVAL);
+    multiset_clear(result);
+    fail_malloc = 1;
+    assert(multiset_union(result, one, two) == -ENOMEM);
+    fail_malloc = 1;
+    delay_fail_malloc = 20;
+    assert(multiset_union(result, one, two) == -ENOMEM);
+    delay_fail_malloc = 0;
+    assert(multiset_is_empty(result));
+    assert(!multiset_destroy(one));
+    assert(!multiset_destroy(two));
+    assert(!multiset_destroy(result));
+}
+
 void test_multiset(void)
 {
     test_invalid_init();
@@ -544,4 +718,7 @@ void test_multiset(void)
     test_multiple_operations();
     test_init_out_of_memory();
     test_put_out_of_memory();
+    test_save_load();
+    test_rank_select();
+    test_combine();
 }
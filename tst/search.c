@@ -0,0 +1,154 @@
+#include <string.h>
+#include "test.h"
+#include "../src/include/compare.h"
+#include "../src/include/search.h"
+
+struct record {
+    int key;
+    int payload;
+};
+
+static int compare_int(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return (a > b) - (a < b);
+}
+
+static int compare_record(const void *const one, const void *const two)
+{
+    const struct record *const a = one;
+    const struct record *const b = two;
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static int linear_lower_bound(const int *const arr,
+                              const int count,
+                              const int key)
+{
+    int i = 0;
+    while (i < count && arr[i] < key) {
+        i++;
+    }
+    return i;
+}
+
+static void test_lower_bound(void)
+{
+    int *arr = malloc(1000 * sizeof(int));
+    int count;
+    assert(arr);
+    for (count = 0; count <= 1000; count += count < 70 ? 1 : 93) {
+        int key;
+        int i;
+        for (i = 0; i < count; i++) {
+            arr[i] = 2 * (i / 3);
+        }
+        for (key = -1; key <= 2 * (count / 3) + 2; key++) {
+            const int expected = linear_lower_bound(arr, count, key);
+            assert(containers_lower_bound(arr, count, sizeof(int), &key,
+                                          compare_int) == expected);
+            assert(containers_lower_bound(arr, count, sizeof(int), &key,
+                                          containers_compare_int)
+                   == expected);
+        }
+    }
+    free(arr);
+}
+
+static void test_eytzinger(void)
+{
+    int *sorted = malloc(1000 * sizeof(int));
+    int *arr = malloc(1000 * sizeof(int));
+    int count;
+    assert(sorted && arr);
+    assert(containers_eytzinger_layout(arr, -1, sizeof(int)) == -EINVAL);
+    for (count = 0; count <= 1000; count += count < 70 ? 1 : 93) {
+        int key;
+        int i;
+        for (i = 0; i < count; i++) {
+            sorted[i] = 2 * i;
+        }
+        memcpy(arr, sorted, count * sizeof(int));
+        assert(containers_eytzinger_layout(arr, count, sizeof(int)) == 0);
+        for (i = 0; i < count; i++) {
+            if (2 * i + 1 < count) {
+                assert(arr[2 * i + 1] < arr[i]);
+            }
+            if (2 * i + 2 < count) {
+                assert(arr[i] < arr[2 * i + 2]);
+            }
+        }
+        for (key = -1; key <= 2 * count; key++) {
+            const int expected = linear_lower_bound(sorted, count, key);
+            int index = containers_eytzinger_lower_bound(arr, count,
+                                                         sizeof(int), &key,
+                                                         compare_int);
+            if (expected == count) {
+                assert(index == count);
+            } else {
+                assert(index >= 0 && index < count);
+                assert(arr[index] == sorted[expected]);
+            }
+            index = containers_eytzinger_lower_bound(arr, count, sizeof(int),
+                                                     &key,
+                                                     containers_compare_int);
+            assert(expected == count ? index == count
+                                     : arr[index] == sorted[expected]);
+        }
+    }
+    free(sorted);
+    free(arr);
+}
+
+static void test_records(void)
+{
+    struct record arr[300];
+    struct record key;
+    int index;
+    int i;
+    for (i = 0; i < 300; i++) {
+        arr[i].key = 3 * i;
+        arr[i].payload = -i;
+    }
+    key.key = 31;
+    key.payload = 0;
+    index = containers_lower_bound(arr, 300, sizeof(struct record), &key,
+                                   compare_record);
+    assert(index == 11);
+    assert(containers_eytzinger_layout(arr, 300, sizeof(struct record)) == 0);
+    index = containers_eytzinger_lower_bound(arr, 300, sizeof(struct record),
+                                             &key, compare_record);
+    assert(arr[index].key == 33);
+    assert(arr[index].payload == -11);
+    key.key = 897;
+    index = containers_eytzinger_lower_bound(arr, 300, sizeof(struct record),
+                                             &key, compare_record);
+    assert(arr[index].payload == -299);
+    key.key = 898;
+    index = containers_eytzinger_lower_bound(arr, 300, sizeof(struct record),
+                                             &key, compare_record);
+    assert(index == 300);
+}
+
+static void test_eytzinger_out_of_memory(void)
+{
+    int arr[100];
+    int i;
+    for (i = 0; i < 100; i++) {
+        arr[i] = i;
+    }
+    fail_malloc = 1;
+    assert(containers_eytzinger_layout(arr, 100, sizeof(int)) == -ENOMEM);
+    for (i = 0; i < 100; i++) {
+        assert(arr[i] == i);
+    }
+}
+
+void test_search(void)
+{
+    test_lower_bound();
+    test_eytzinger();
+    test_records();
+    test_eytzinger_out_of_memory();
+}
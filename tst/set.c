@@ -1,3 +1,5 @@
+#include <stdio.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/set.h"
 
@@ -17,6 +19,7 @@ struct internal_set {
 struct node {
     struct node *parent;
     int balance;
+    int weight;
     void *key;
     struct node *left;
     struct node *right;
@@ -63,9 +66,25 @@ static int set_compute_size(struct node *const item)
     return 1 + set_compute_size(item->left) + set_compute_size(item->right);
 }
 
+/*
+ * Verifies that the weight of each item is the amount of keys in its subtree.
+ */
+static int set_verify_weight(struct node *const item)
+{
+    int weight;
+    if (!item) {
+        return 0;
+    }
+    weight = 1 + set_verify_weight(item->left) +
+             set_verify_weight(item->right);
+    assert(item->weight == weight);
+    return weight;
+}
+
 static void set_verify(set me)
 {
     set_verify_recursive(me->root);
+    set_verify_weight(me->root);
     assert(set_compute_size(me->root) == set_size(me));
 }
 
@@ -509,6 +528,162 @@ static void test_put_out_of_memory(void)
     assert(!set_destroy(me));
 }
 
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    set me;
+    set load;
+    assert(file);
+    fd = fileno(file);
+    me = set_init(sizeof(int), compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int key = i * 37 % 1000;
+        assert(set_put(me, &key) == 0);
+    }
+    assert(set_save(me, fd) == 0);
+    assert(set_load(me, fd) == -EINVAL);
+    load = set_init(sizeof(int), compare_int);
+    assert(load);
+    assert(set_load(load, fd) == -EIO);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(set_load(load, fd) == 0);
+    set_verify(load);
+    assert(set_size(load) == 1000);
+    for (i = 0; i < 1000; i++) {
+        assert(set_contains(load, &i));
+    }
+    for (i = 1; i < 1000; i += 2) {
+        assert(set_remove(load, &i));
+    }
+    set_verify(load);
+    assert(set_size(load) == 500);
+    set_clear(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    delay_fail_malloc = 1000;
+    fail_malloc = 1;
+    assert(set_load(load, fd) == -ENOMEM);
+    delay_fail_malloc = 0;
+    fail_malloc = 0;
+    assert(set_is_empty(load));
+    assert(!set_destroy(load));
+    fail_malloc = 1;
+    assert(set_save(me, fd) == -ENOMEM);
+    load = set_init(sizeof(long), compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(set_load(load, fd) == -EINVAL);
+    assert(!set_destroy(load));
+    assert(!set_destroy(me));
+    fclose(file);
+}
+
+static void test_rank_select(void)
+{
+    int i;
+    int key;
+    set me = set_init(sizeof(int), compare_int);
+    assert(me);
+    assert(set_select(&key, me, 0) == -EINVAL);
+    key = 5;
+    assert(set_rank(me, &key) == 0);
+    for (i = 0; i < 1000; i++) {
+        key = i * 37 % 1000 * 2;
+        assert(set_put(me, &key) == 0);
+    }
+    set_verify(me);
+    for (i = 0; i < 1000; i++) {
+        key = 2 * i;
+        assert(set_rank(me, &key) == i);
+        key = 2 * i + 1;
+        assert(set_rank(me, &key) == i + 1);
+        assert(set_select(&key, me, i) == 0);
+        assert(key == 2 * i);
+    }
+    assert(set_select(&key, me, -1) == -EINVAL);
+    assert(set_select(&key, me, 1000) == -EINVAL);
+    for (i = 0; i < 1000; i += 3) {
+        key = 2 * i;
+        assert(set_remove(me, &key));
+    }
+    set_verify(me);
+    for (i = 0; i < set_size(me); i++) {
+        assert(set_select(&key, me, i) == 0);
+        assert(set_rank(me, &key) == i);
+    }
+    assert(!set_destroy(me));
+}
+
+static void test_combine(void)
+{
+    int i;
+    int key;
+    set one = set_init(sizeof(int), compare_int);
+    set two = set_init(sizeof(int), compare_int);
+    set result = set_init(sizeof(int), compare_int);
+    set other = set_init(sizeof(long), compare_int);
+    assert(one && two && result && other);
+    assert(set_union(result, one, two) == 0);
+    assert(set_is_empty(result));
+    for (i = 0; i < 1000; i++) {
+        key = i * 37 % 1000;
+        if (key % 2 == 0) {
+            assert(set_put(one, &key) == 0);
+        }
+        if (key % 3 == 0) {
+            assert(set_put(two, &key) == 0);
+        }
+    }
+    assert(set_union(result, one, two) == 0);
+    set_verify(result);
+    assert(set_size(result) == 667);
+    for (i = 0; i < 1000; i++) {
+        assert(set_contains(result, &i) == (i % 2 == 0 || i % 3 == 0));
+    }
+    assert(set_union(result, one, two) == -EINVAL);
+    set_clear(result);
+    assert(set_intersection(result, one, two) == 0);
+    set_verify(result);
+    assert(set_size(result) == 167);
+    for (i = 0; i < 1000; i++) {
+        assert(set_contains(result, &i) == (i % 6 == 0));
+    }
+    assert(set_is_subset(result, one));
+    assert(set_is_subset(result, two));
+    assert(!set_is_subset(one, result));
+    assert(!set_is_subset(one, two));
+    assert(set_is_subset(one, one));
+    set_clear(result);
+    assert(set_difference(result, one, two) == 0);
+    set_verify(result);
+    assert(set_size(result) == 333);
+    for (i = 0; i < 1000; i++) {
+        assert(set_contains(result, &i) == (i % 2 == 0 && i % 3 != 0));
+    }
+    for (i = 0; i < 1000; i += 4) {
+        assert(set_remove(result, &i) == (i % 3 != 0));
+    }
+    set_verify(result);
+    set_clear(result);
+    assert(set_is_subset(result, one));
+    assert(set_difference(result, one, one) == 0);
+    assert(set_is_empty(result));
+    assert(set_union(other, one, two) == -EINVAL);
+    fail_malloc = 1;
+    assert(set_union(result, one, two) == -ENOMEM);
+    fail_malloc = 1;
+    delay_fail_malloc = 100;
+    assert(set_union(result, one, two) == -ENOMEM);
+    delay_fail_malloc = 0;
+    assert(set_is_empty(result));
+    assert(!set_destroy(one));
+    assert(!set_destroy(two));
+    assert(!set_destroy(result));
+    assert(!set_destroy(other));
+}
+
 void test_set(void)
 {
     test_invalid_init();
@@ -521,4 +696,7 @@ void test_set(void)
     test_unique_deletion_patterns();
     test_init_out_of_memory();
     test_put_out_of_memory();
+    test_save_load();
+    test_rank_select();
+    test_combine();
 }
@@ -0,0 +1,236 @@
+#include <string.h>
+#include <limits.h>
+#include "test.h"
+#include "../src/include/compare.h"
+#include "../src/include/sort.h"
+
+struct record {
+    int key;
+    int payload[2];
+};
+
+static unsigned long seed = 1;
+
+static int next_random(void)
+{
+    seed = seed * 1103515245UL + 12345UL;
+    return (int) ((seed >> 8) & 0xffffff);
+}
+
+static int compare_int(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return (a > b) - (a < b);
+}
+
+static int compare_record(const void *const one, const void *const two)
+{
+    const struct record *const a = one;
+    const struct record *const b = two;
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static void fill_pattern(int *const arr, const int count, const int pattern)
+{
+    int i;
+    for (i = 0; i < count; i++) {
+        switch (pattern) {
+            case 0:
+                arr[i] = next_random() - 0x800000;
+                break;
+            case 1:
+                arr[i] = i;
+                break;
+            case 2:
+                arr[i] = count - i;
+                break;
+            case 3:
+                arr[i] = 7;
+                break;
+            case 4:
+                arr[i] = next_random() % 4;
+                break;
+            default:
+                arr[i] = i < count / 2 ? i : count - i;
+                break;
+        }
+    }
+}
+
+static void verify_sorted(const int *const arr,
+                          const int count,
+                          const long sum)
+{
+    long total = 0;
+    int i;
+    for (i = 0; i < count; i++) {
+        total += arr[i];
+        if (i > 0) {
+            assert(arr[i - 1] <= arr[i]);
+        }
+    }
+    assert(total == sum);
+}
+
+static void test_patterns(void)
+{
+    static const int sizes[] = {0, 1, 2, 3, 16, 17, 100, 255, 256, 1000, 5000};
+    int *arr = malloc(5000 * sizeof(int));
+    int i;
+    assert(arr);
+    for (i = 0; i < (int) (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        int pattern;
+        for (pattern = 0; pattern < 6; pattern++) {
+            long sum = 0;
+            int j;
+            seed = (unsigned long) pattern + 1;
+            fill_pattern(arr, sizes[i], pattern);
+            for (j = 0; j < sizes[i]; j++) {
+                sum += arr[j];
+            }
+            containers_sort(arr, sizes[i], sizeof(int), compare_int);
+            verify_sorted(arr, sizes[i], sum);
+            seed = (unsigned long) pattern + 1;
+            fill_pattern(arr, sizes[i], pattern);
+            containers_sort(arr, sizes[i], sizeof(int), containers_compare_int);
+            verify_sorted(arr, sizes[i], sum);
+        }
+    }
+    free(arr);
+}
+
+static void test_records(void)
+{
+    struct record *arr = malloc(3000 * sizeof(struct record));
+    int i;
+    assert(arr);
+    for (i = 0; i < 3000; i++) {
+        arr[i].key = next_random() % 500;
+        arr[i].payload[0] = arr[i].key * 2;
+        arr[i].payload[1] = -arr[i].key;
+    }
+    containers_sort(arr, 3000, sizeof(struct record), compare_record);
+    for (i = 0; i < 3000; i++) {
+        assert(arr[i].payload[0] == arr[i].key * 2);
+        assert(arr[i].payload[1] == -arr[i].key);
+        if (i > 0) {
+            assert(arr[i - 1].key <= arr[i].key);
+        }
+    }
+    free(arr);
+}
+
+static void test_key_bytes(void)
+{
+    const int counts[4] = {10, 3000, 3000, 3000};
+    unsigned char *const arr = malloc(3000 * 3);
+    int test;
+    int i;
+    assert(arr);
+    for (test = 0; test < 4; test++) {
+        const int count = counts[test];
+        for (i = 0; i < 3 * count; i++) {
+            arr[i] = (unsigned char) next_random();
+        }
+        if (test == 2) {
+            containers_sort(arr, count, 3, containers_compare_key);
+        } else if (test == 3) {
+            for (i = 0; i < count; i++) {
+                arr[3 * i] = (unsigned char) (255 - i * 255 / count);
+            }
+        }
+        containers_sort(arr, count, 3, containers_compare_key);
+        for (i = 1; i < count; i++) {
+            assert(memcmp(arr + 3 * (i - 1), arr + 3 * i, 3) <= 0);
+        }
+    }
+    free(arr);
+}
+
+static void test_radix_types(void)
+{
+    long *longs = malloc(1000 * sizeof(long));
+    unsigned int *uints = malloc(1000 * sizeof(unsigned int));
+    unsigned long *ulongs = malloc(1000 * sizeof(unsigned long));
+    double *doubles = malloc(1000 * sizeof(double));
+    float *floats = malloc(1000 * sizeof(float));
+    int *ints = malloc(1000 * sizeof(int));
+    int i;
+    assert(longs && uints && ulongs && doubles && floats && ints);
+    for (i = 0; i < 1000; i++) {
+        const int value = next_random() - 0x800000;
+        ints[i] = value;
+        longs[i] = (long) value * 4096;
+        uints[i] = (unsigned int) value;
+        ulongs[i] = (unsigned long) value;
+        doubles[i] = value / 7.0;
+        floats[i] = (float) (value / 3.0);
+    }
+    ints[0] = INT_MIN;
+    ints[1] = INT_MAX;
+    longs[0] = LONG_MIN;
+    longs[1] = LONG_MAX;
+    uints[0] = UINT_MAX;
+    ulongs[0] = ULONG_MAX;
+    doubles[0] = -0.0;
+    doubles[1] = 0.0;
+    doubles[2] = -1e300;
+    floats[0] = -0.0f;
+    floats[1] = 1e30f;
+    containers_sort(ints, 1000, sizeof(int), containers_compare_int);
+    containers_sort(longs, 1000, sizeof(long), containers_compare_long);
+    containers_sort(uints, 1000, sizeof(unsigned int), containers_compare_uint);
+    containers_sort(ulongs, 1000, sizeof(unsigned long),
+                    containers_compare_ulong);
+    containers_sort(doubles, 1000, sizeof(double), containers_compare_double);
+    containers_sort(floats, 1000, sizeof(float), containers_compare_float);
+    for (i = 1; i < 1000; i++) {
+        assert(ints[i - 1] <= ints[i]);
+        assert(longs[i - 1] <= longs[i]);
+        assert(uints[i - 1] <= uints[i]);
+        assert(ulongs[i - 1] <= ulongs[i]);
+        assert(doubles[i - 1] <= doubles[i]);
+        assert(floats[i - 1] <= floats[i]);
+    }
+    assert(ints[0] == INT_MIN);
+    assert(ints[999] == INT_MAX);
+    assert(longs[0] == LONG_MIN);
+    assert(longs[999] == LONG_MAX);
+    assert(uints[999] == UINT_MAX);
+    assert(ulongs[999] == ULONG_MAX);
+    assert(doubles[0] == -1e300);
+    assert(floats[999] == 1e30f);
+    free(ints);
+    free(longs);
+    free(uints);
+    free(ulongs);
+    free(doubles);
+    free(floats);
+}
+
+static void test_radix_out_of_memory(void)
+{
+    int *arr = malloc(1000 * sizeof(int));
+    long sum = 0;
+    int i;
+    assert(arr);
+    fill_pattern(arr, 1000, 0);
+    for (i = 0; i < 1000; i++) {
+        sum += arr[i];
+    }
+    fail_malloc = 1;
+    containers_sort(arr, 1000, sizeof(int), containers_compare_int);
+    fail_malloc = 0;
+    verify_sorted(arr, 1000, sum);
+    free(arr);
+}
+
+void test_sort(void)
+{
+    test_patterns();
+    test_records();
+    test_key_bytes();
+    test_radix_types();
+    test_radix_out_of_memory();
+}
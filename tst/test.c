@@ -80,6 +80,13 @@ int main(void)
     test_unordered_map();
     test_unordered_multiset();
     test_unordered_multimap();
+    test_hash();
+    test_compare();
+    test_sort();
+    test_search();
+    test_flat_set();
+    test_flat_map();
+    test_generic();
     test_stack();
     test_queue();
     test_priority_queue();
@@ -26,6 +26,13 @@ void test_unordered_set(void);
 void test_unordered_map(void);
 void test_unordered_multiset(void);
 void test_unordered_multimap(void);
+void test_hash(void);
+void test_compare(void);
+void test_sort(void);
+void test_search(void);
+void test_flat_set(void);
+void test_flat_map(void);
+void test_generic(void);
 void test_stack(void);
 void test_queue(void);
 void test_priority_queue(void);
@@ -1,3 +1,7 @@
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/unordered_map.h"
 
@@ -293,6 +297,396 @@ static void test_clear_out_of_memory(void)
     assert(!unordered_map_destroy(me));
 }
 
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    unordered_map me;
+    unordered_map load;
+    unsigned long count = INT_MAX / 2;
+    assert(file);
+    fd = fileno(file);
+    me = unordered_map_init(sizeof(int), sizeof(int), hash_int, compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int value = 2 * i;
+        assert(unordered_map_put(me, &i, &value) == 0);
+    }
+    assert(unordered_map_save(me, fd) == 0);
+    /* The header holds no seed, only the sizes and the count. */
+    assert(lseek(fd, 0, SEEK_CUR)
+           == (off_t) (8 + 4 * sizeof(unsigned long)
+                       + 1000 * (sizeof(unsigned long) + 2 * sizeof(int))));
+    assert(unordered_map_load(me, fd) == -EINVAL);
+    load = unordered_map_init(sizeof(int), sizeof(int), hash_int, compare_int);
+    assert(load);
+    assert(unordered_map_load(load, fd) == -EIO);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    hash_count = 0;
+    assert(unordered_map_load(load, fd) == 0);
+    assert(hash_count == 0);
+    assert(unordered_map_size(load) == 1000);
+    for (i = 0; i < 1000; i++) {
+        int value = 0;
+        assert(unordered_map_get(&value, load, &i));
+        assert(value == 2 * i);
+    }
+    i = 1000;
+    assert(unordered_map_put(load, &i, &i) == 0);
+    assert(unordered_map_size(load) == 1001);
+    assert(unordered_map_remove(load, &i));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_map_clear(load) == 0);
+    fail_calloc = 1;
+    assert(unordered_map_load(load, fd) == -ENOMEM);
+    assert(unordered_map_is_empty(load));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    fail_malloc = 1;
+    assert(unordered_map_load(load, fd) == -ENOMEM);
+    assert(unordered_map_is_empty(load));
+    fail_malloc = 1;
+    assert(unordered_map_save(me, fd) == -ENOMEM);
+    assert(!unordered_map_destroy(load));
+    load = unordered_map_init(sizeof(int), sizeof(long), hash_int,
+                              compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_map_load(load, fd) == -EINVAL);
+    assert(!unordered_map_destroy(load));
+    /* A corrupt count only reserves buckets for the records which exist. */
+    load = unordered_map_init(sizeof(int), sizeof(int), hash_int, compare_int);
+    assert(load);
+    assert(lseek(fd, (off_t) (8 + 3 * sizeof(unsigned long)), SEEK_SET) > 0);
+    assert(write(fd, &count, sizeof(unsigned long))
+           == (ssize_t) sizeof(unsigned long));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_map_load(load, fd) == -EIO);
+    assert(unordered_map_size(load) <= 1000);
+    assert(!unordered_map_destroy(load));
+    assert(!unordered_map_destroy(me));
+    fclose(file);
+}
+
+static void test_reserve(void)
+{
+    int i;
+    unordered_map me = unordered_map_init(sizeof(int), sizeof(int), hash_int,
+                                         compare_int);
+    assert(me);
+    assert(unordered_map_reserve(me, -1) == -EINVAL);
+    assert(unordered_map_reserve(me, INT_MAX) == -EINVAL);
+    fail_calloc = 1;
+    assert(unordered_map_reserve(me, 1000) == -ENOMEM);
+    assert(unordered_map_reserve(me, 1000) == 0);
+    assert(unordered_map_reserve(me, 10) == 0);
+    fail_calloc = 1;
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    assert(unordered_map_put(me, &i, &i) == -ENOMEM);
+    assert(unordered_map_size(me) == 1000);
+    assert(unordered_map_set_max_load_factor(me, 0) == -EINVAL);
+    assert(unordered_map_set_max_load_factor(me, -1.0) == -EINVAL);
+    fail_calloc = 1;
+    assert(unordered_map_set_max_load_factor(me, 0.25) == -ENOMEM);
+    assert(unordered_map_set_max_load_factor(me, 0.25) == 0);
+    assert(unordered_map_set_max_load_factor(me, 4.0) == 0);
+    fail_calloc = 1;
+    for (i = 1000; i < 5000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_map_size(me) == 5000);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_map_contains(me, &i));
+    }
+    assert(!unordered_map_destroy(me));
+}
+
+static void test_incremental_resize(void)
+{
+    int i;
+    unordered_map me = unordered_map_init(sizeof(int), sizeof(int), hash_int,
+                                         compare_int);
+    assert(me);
+    assert(unordered_map_set_incremental_resize(me, -1) == -EINVAL);
+    assert(unordered_map_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+        assert(unordered_map_contains(me, &i));
+    }
+    assert(unordered_map_size(me) == 5000);
+    for (i = 0; i < 5000; i += 2) {
+        assert(unordered_map_remove(me, &i));
+    }
+    assert(unordered_map_size(me) == 2500);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_map_contains(me, &i) == i % 2);
+    }
+    assert(unordered_map_set_incremental_resize(me, 3) == 0);
+    for (i = 5000; i < 6000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    hash_count = 0;
+    assert(unordered_map_rehash(me) == 0);
+    assert(hash_count == 3500);
+    for (i = 6000; i < 7000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    assert(unordered_map_set_incremental_resize(me, 0) == 0);
+    assert(unordered_map_size(me) == 4500);
+    for (i = 5000; i < 7000; i++) {
+        assert(unordered_map_contains(me, &i));
+    }
+    assert(unordered_map_set_incremental_resize(me, 2) == 0);
+    for (i = 7000; i < 20000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    assert(unordered_map_clear(me) == 0);
+    assert(unordered_map_is_empty(me));
+    for (i = 0; i < 20000; i++) {
+        assert(!unordered_map_contains(me, &i));
+    }
+    for (i = 0; i < 100; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    assert(unordered_map_size(me) == 100);
+    assert(!unordered_map_destroy(me));
+}
+
+static void test_shrink(void)
+{
+    int i;
+    unordered_map me = unordered_map_init(sizeof(int), sizeof(int), hash_int,
+                                         compare_int);
+    assert(me);
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    for (i = 10; i < 10000; i++) {
+        assert(unordered_map_remove(me, &i));
+    }
+    fail_calloc = 1;
+    assert(unordered_map_shrink_to_fit(me) == -ENOMEM);
+    assert(unordered_map_shrink_to_fit(me) == 0);
+    fail_calloc = 1;
+    assert(unordered_map_shrink_to_fit(me) == 0);
+    fail_calloc = 0;
+    assert(unordered_map_size(me) == 10);
+    for (i = 0; i < 10; i++) {
+        assert(unordered_map_contains(me, &i));
+    }
+    assert(unordered_map_set_min_load_factor(me, -0.1) == -EINVAL);
+    assert(unordered_map_set_min_load_factor(me, 0.375) == -EINVAL);
+    assert(unordered_map_set_min_load_factor(me, 0.2) == 0);
+    assert(unordered_map_set_max_load_factor(me, 0.4) == -EINVAL);
+    assert(unordered_map_set_max_load_factor(me, 0.5) == 0);
+    assert(unordered_map_set_max_load_factor(me, 0.75) == 0);
+    for (i = 10; i < 10000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_map_remove(me, &i));
+    }
+    assert(unordered_map_is_empty(me));
+    fail_calloc = 1;
+    assert(unordered_map_shrink_to_fit(me) == 0);
+    fail_calloc = 0;
+    assert(unordered_map_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    for (i = 0; i < 9000; i++) {
+        assert(unordered_map_remove(me, &i));
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_map_contains(me, &i) == (i >= 9000));
+    }
+    assert(!unordered_map_destroy(me));
+}
+
+static void test_cursor(void)
+{
+    struct unordered_map_cursor cursor;
+    char seen[1000];
+    int more;
+    int key;
+    int value;
+    int i;
+    unordered_map me = unordered_map_init(sizeof(int), sizeof(int), hash_int,
+                                         compare_int);
+    assert(me);
+    assert(!unordered_map_first(me, &cursor));
+    assert(!unordered_map_next(me, &cursor));
+    assert(!unordered_map_cursor_get(&key, &value, me, &cursor));
+    assert(!unordered_map_cursor_remove(me, &cursor));
+    assert(unordered_map_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    memset(seen, 0, sizeof(seen));
+    more = unordered_map_first(me, &cursor);
+    while (more) {
+        assert(unordered_map_cursor_get(&key, &value, me, &cursor));
+        assert(key == value);
+        assert(!seen[key]);
+        seen[key] = 1;
+        if (key % 2) {
+            more = unordered_map_cursor_remove(me, &cursor);
+        } else {
+            more = unordered_map_next(me, &cursor);
+        }
+    }
+    for (i = 0; i < 1000; i++) {
+        assert(seen[i]);
+        assert(unordered_map_contains(me, &i) == !(i % 2));
+    }
+    assert(unordered_map_size(me) == 500);
+    i = 0;
+    more = unordered_map_first(me, &cursor);
+    while (more) {
+        more = unordered_map_cursor_remove(me, &cursor);
+        i++;
+    }
+    assert(i == 500);
+    assert(unordered_map_is_empty(me));
+    assert(!unordered_map_destroy(me));
+}
+
+static void test_seed(void)
+{
+    struct unordered_map_cursor one_cursor;
+    struct unordered_map_cursor two_cursor;
+    int one_key;
+    int two_key;
+    int is_same = 1;
+    int i;
+    unordered_map one = unordered_map_init(sizeof(int), sizeof(int), hash_int,
+                                          compare_int);
+    unordered_map two = unordered_map_init(sizeof(int), sizeof(int), hash_int,
+                                          compare_int);
+    assert(one);
+    assert(two);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_map_put(one, &i, &i) == 0);
+        assert(unordered_map_put(two, &i, &i) == 0);
+    }
+    unordered_map_first(one, &one_cursor);
+    unordered_map_first(two, &two_cursor);
+    for (i = 0; i < 100; i++) {
+        unordered_map_cursor_get(&one_key, NULL, one, &one_cursor);
+        unordered_map_cursor_get(&two_key, NULL, two, &two_cursor);
+        if (one_key != two_key) {
+            is_same = 0;
+        }
+        unordered_map_next(one, &one_cursor);
+        unordered_map_next(two, &two_cursor);
+    }
+    assert(!is_same);
+    assert(!unordered_map_destroy(two));
+    assert(!unordered_map_destroy(one));
+}
+
+static void test_chain_guard(void)
+{
+    int i;
+    unordered_map me = unordered_map_init(sizeof(int), sizeof(int),
+                                         bad_hash_int, compare_int);
+    assert(me);
+    assert(unordered_map_set_max_chain_length(me, -1) == -EINVAL);
+    assert(unordered_map_set_max_chain_length(me, 4) == 0);
+    assert(unordered_map_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    assert(unordered_map_size(me) == 100);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_map_contains(me, &i));
+    }
+    assert(!unordered_map_destroy(me));
+    me = unordered_map_init(sizeof(int), sizeof(int), hash_int, compare_int);
+    assert(me);
+    assert(unordered_map_set_max_chain_length(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    fail_calloc = 1;
+    for (i = 1000; i < 1010; i++) {
+        assert(unordered_map_put(me, &i, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_map_set_max_chain_length(me, 0) == 0);
+    for (i = 0; i < 1010; i++) {
+        assert(unordered_map_contains(me, &i));
+    }
+    assert(!unordered_map_destroy(me));
+}
+
+static void test_merge(void)
+{
+    int i;
+    int key;
+    int value;
+    unordered_map me =
+            unordered_map_init(sizeof(int), sizeof(int), hash_int, compare_int);
+    unordered_map other =
+            unordered_map_init(sizeof(int), sizeof(int), hash_int, compare_int);
+    unordered_map bad = unordered_map_init(sizeof(int), sizeof(int),
+                                           bad_hash_int, compare_int);
+    unordered_map wide = unordered_map_init(sizeof(int), sizeof(long),
+                                            hash_int, compare_int);
+    assert(me && other && bad && wide);
+    for (i = 0; i < 1000; i++) {
+        key = i;
+        value = 1;
+        if (key % 2 == 0) {
+            assert(unordered_map_put(me, &key, &value) == 0);
+        }
+        value = 2;
+        if (key % 3 == 0) {
+            assert(unordered_map_put(other, &key, &value) == 0);
+        }
+    }
+    hash_count = 0;
+    assert(unordered_map_merge(me, other) == 0);
+    assert(hash_count == 0);
+    assert(unordered_map_size(me) == 667);
+    assert(unordered_map_size(other) == 334);
+    for (i = 0; i < 1000; i++) {
+        value = 0;
+        assert(unordered_map_get(&value, me, &i)
+               == (i % 2 == 0 || i % 3 == 0));
+        if (i % 3 == 0) {
+            assert(value == 2);
+        } else if (i % 2 == 0) {
+            assert(value == 1);
+        }
+    }
+    assert(unordered_map_merge(me, me) == 0);
+    assert(unordered_map_size(me) == 667);
+    assert(unordered_map_merge(wide, me) == -EINVAL);
+    hash_count = 0;
+    assert(unordered_map_merge(bad, other) == 0);
+    assert(hash_count == 0);
+    assert(unordered_map_size(bad) == 334);
+    key = 3;
+    assert(unordered_map_get(&value, bad, &key));
+    assert(value == 2);
+    hash_count = 0;
+    assert(unordered_map_merge(other, bad) == 0);
+    assert(hash_count == 334);
+    assert(unordered_map_size(other) == 334);
+    fail_malloc = 1;
+    assert(unordered_map_merge(wide, wide) == 0);
+    assert(unordered_map_merge(other, me) == -ENOMEM);
+    fail_malloc = 0;
+    assert(!unordered_map_destroy(me));
+    assert(!unordered_map_destroy(other));
+    assert(!unordered_map_destroy(bad));
+    assert(!unordered_map_destroy(wide));
+}
+
 void test_unordered_map(void)
 {
     test_invalid_init();
@@ -303,4 +697,12 @@ void test_unordered_map(void)
     test_put_out_of_memory();
     test_resize_out_of_memory();
     test_clear_out_of_memory();
+    test_save_load();
+    test_reserve();
+    test_incremental_resize();
+    test_shrink();
+    test_cursor();
+    test_seed();
+    test_chain_guard();
+    test_merge();
 }
@@ -1,3 +1,7 @@
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/unordered_multimap.h"
 
@@ -311,10 +315,6 @@ static void test_init_out_of_memory(void)
     fail_calloc = 1;
     assert(!unordered_multimap_init(sizeof(int), sizeof(int), hash_int,
                                     compare_int, compare_int));
-    fail_calloc = 1;
-    delay_fail_calloc = 1;
-    assert(!unordered_multimap_init(sizeof(int), sizeof(int), hash_int,
-                                    compare_int, compare_int));
 }
 
 static void test_rehash_out_of_memory(void)
@@ -361,6 +361,11 @@ static void test_put_out_of_memory(void)
     fail_malloc = 1;
     delay_fail_malloc = 2;
     assert(unordered_multimap_put(me, &key, &value) == -ENOMEM);
+    key = 5;
+    fail_realloc = 1;
+    assert(unordered_multimap_put(me, &key, &value) == -ENOMEM);
+    assert(unordered_multimap_count(me, &key) == 1);
+    assert(unordered_multimap_size(me) == 1);
     assert(!unordered_multimap_destroy(me));
 }
 
@@ -402,6 +407,451 @@ static void test_clear_out_of_memory(void)
     assert(!unordered_multimap_destroy(me));
 }
 
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    unordered_multimap me;
+    unordered_multimap load;
+    unsigned long count = INT_MAX / 2;
+    assert(file);
+    fd = fileno(file);
+    me = unordered_multimap_init(sizeof(int), sizeof(int), hash_int,
+                                 compare_int, compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int key = i / 2;
+        assert(unordered_multimap_put(me, &key, &i) == 0);
+    }
+    assert(unordered_multimap_save(me, fd) == 0);
+    assert(unordered_multimap_load(me, fd) == -EINVAL);
+    load = unordered_multimap_init(sizeof(int), sizeof(int), hash_int,
+                                   compare_int, compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    hash_count = 0;
+    assert(unordered_multimap_load(load, fd) == 0);
+    assert(hash_count == 0);
+    assert(unordered_multimap_size(load) == 1000);
+    for (i = 0; i < 500; i++) {
+        int value = 0;
+        int sum = 0;
+        assert(unordered_multimap_count(load, &i) == 2);
+        unordered_multimap_get_start(load, &i);
+        while (unordered_multimap_get_next(&value, load)) {
+            sum += value;
+        }
+        assert(sum == 4 * i + 1);
+    }
+    assert(unordered_multimap_clear(load) == 0);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    fail_malloc = 1;
+    assert(unordered_multimap_load(load, fd) == -ENOMEM);
+    assert(unordered_multimap_is_empty(load));
+    fail_malloc = 1;
+    assert(unordered_multimap_save(me, fd) == -ENOMEM);
+    assert(!unordered_multimap_destroy(load));
+    load = unordered_multimap_init(sizeof(long), sizeof(int), hash_int,
+                                   compare_int, compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_multimap_load(load, fd) == -EINVAL);
+    assert(!unordered_multimap_destroy(load));
+    /* A corrupt count only reserves buckets for the records which exist. */
+    load = unordered_multimap_init(sizeof(int), sizeof(int), hash_int,
+                                   compare_int, compare_int);
+    assert(load);
+    assert(lseek(fd, (off_t) (8 + 3 * sizeof(unsigned long)), SEEK_SET) > 0);
+    assert(write(fd, &count, sizeof(unsigned long))
+           == (ssize_t) sizeof(unsigned long));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_multimap_load(load, fd) == -EIO);
+    assert(unordered_multimap_size(load) <= 1000);
+    assert(!unordered_multimap_destroy(load));
+    assert(!unordered_multimap_destroy(me));
+    fclose(file);
+}
+
+static void test_reserve(void)
+{
+    int i;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    assert(unordered_multimap_reserve(me, -1) == -EINVAL);
+    assert(unordered_multimap_reserve(me, INT_MAX) == -EINVAL);
+    fail_calloc = 1;
+    assert(unordered_multimap_reserve(me, 1000) == -ENOMEM);
+    assert(unordered_multimap_reserve(me, 1000) == 0);
+    assert(unordered_multimap_reserve(me, 10) == 0);
+    fail_calloc = 1;
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    assert(unordered_multimap_put(me, &i, &i) == -ENOMEM);
+    assert(unordered_multimap_size(me) == 1000);
+    assert(unordered_multimap_set_max_load_factor(me, 0) == -EINVAL);
+    assert(unordered_multimap_set_max_load_factor(me, -1.0) == -EINVAL);
+    fail_calloc = 1;
+    assert(unordered_multimap_set_max_load_factor(me, 0.25) == -ENOMEM);
+    assert(unordered_multimap_set_max_load_factor(me, 0.25) == 0);
+    assert(unordered_multimap_set_max_load_factor(me, 4.0) == 0);
+    fail_calloc = 1;
+    for (i = 1000; i < 5000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_multimap_size(me) == 5000);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_multimap_contains(me, &i));
+    }
+    assert(!unordered_multimap_destroy(me));
+}
+
+static void test_incremental_resize(void)
+{
+    int i;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    assert(unordered_multimap_set_incremental_resize(me, -1) == -EINVAL);
+    assert(unordered_multimap_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+        assert(unordered_multimap_contains(me, &i));
+    }
+    assert(unordered_multimap_size(me) == 5000);
+    for (i = 0; i < 5000; i += 2) {
+        assert(unordered_multimap_remove(me, &i, &i));
+    }
+    assert(unordered_multimap_size(me) == 2500);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_multimap_contains(me, &i) == i % 2);
+    }
+    assert(unordered_multimap_set_incremental_resize(me, 3) == 0);
+    for (i = 5000; i < 6000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    hash_count = 0;
+    assert(unordered_multimap_rehash(me) == 0);
+    assert(hash_count == 3500);
+    for (i = 6000; i < 7000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    assert(unordered_multimap_set_incremental_resize(me, 0) == 0);
+    assert(unordered_multimap_size(me) == 4500);
+    for (i = 5000; i < 7000; i++) {
+        assert(unordered_multimap_contains(me, &i));
+    }
+    assert(unordered_multimap_set_incremental_resize(me, 2) == 0);
+    for (i = 7000; i < 20000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    assert(unordered_multimap_clear(me) == 0);
+    assert(unordered_multimap_is_empty(me));
+    for (i = 0; i < 20000; i++) {
+        assert(!unordered_multimap_contains(me, &i));
+    }
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    assert(unordered_multimap_size(me) == 100);
+    assert(!unordered_multimap_destroy(me));
+}
+
+static void test_shrink(void)
+{
+    int i;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    for (i = 10; i < 10000; i++) {
+        assert(unordered_multimap_remove(me, &i, &i));
+    }
+    fail_calloc = 1;
+    assert(unordered_multimap_shrink_to_fit(me) == -ENOMEM);
+    assert(unordered_multimap_shrink_to_fit(me) == 0);
+    fail_calloc = 1;
+    assert(unordered_multimap_shrink_to_fit(me) == 0);
+    fail_calloc = 0;
+    assert(unordered_multimap_size(me) == 10);
+    for (i = 0; i < 10; i++) {
+        assert(unordered_multimap_contains(me, &i));
+    }
+    assert(unordered_multimap_set_min_load_factor(me, -0.1) == -EINVAL);
+    assert(unordered_multimap_set_min_load_factor(me, 0.375) == -EINVAL);
+    assert(unordered_multimap_set_min_load_factor(me, 0.2) == 0);
+    assert(unordered_multimap_set_max_load_factor(me, 0.4) == -EINVAL);
+    assert(unordered_multimap_set_max_load_factor(me, 0.5) == 0);
+    assert(unordered_multimap_set_max_load_factor(me, 0.75) == 0);
+    for (i = 10; i < 10000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multimap_remove(me, &i, &i));
+    }
+    assert(unordered_multimap_is_empty(me));
+    fail_calloc = 1;
+    assert(unordered_multimap_shrink_to_fit(me) == 0);
+    fail_calloc = 0;
+    assert(unordered_multimap_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    for (i = 0; i < 9000; i++) {
+        assert(unordered_multimap_remove(me, &i, &i));
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multimap_contains(me, &i) == (i >= 9000));
+    }
+    assert(!unordered_multimap_destroy(me));
+}
+
+static void test_cursor(void)
+{
+    struct unordered_multimap_cursor cursor;
+    char seen[1000];
+    int more;
+    int key;
+    int value;
+    int i;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    assert(!unordered_multimap_first(me, &cursor));
+    assert(!unordered_multimap_next(me, &cursor));
+    assert(!unordered_multimap_cursor_get(&key, &value, me, &cursor));
+    assert(!unordered_multimap_cursor_remove(me, &cursor));
+    assert(unordered_multimap_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    memset(seen, 0, sizeof(seen));
+    more = unordered_multimap_first(me, &cursor);
+    while (more) {
+        assert(unordered_multimap_cursor_get(&key, &value, me, &cursor));
+        assert(key == value);
+        assert(!seen[key]);
+        seen[key] = 1;
+        if (key % 2) {
+            more = unordered_multimap_cursor_remove(me, &cursor);
+        } else {
+            more = unordered_multimap_next(me, &cursor);
+        }
+    }
+    for (i = 0; i < 1000; i++) {
+        assert(seen[i]);
+        assert(unordered_multimap_contains(me, &i) == !(i % 2));
+    }
+    assert(unordered_multimap_size(me) == 500);
+    i = 0;
+    more = unordered_multimap_first(me, &cursor);
+    while (more) {
+        more = unordered_multimap_cursor_remove(me, &cursor);
+        i++;
+    }
+    assert(i == 500);
+    assert(unordered_multimap_is_empty(me));
+    assert(!unordered_multimap_destroy(me));
+}
+
+static void test_grouped_values(void)
+{
+    struct unordered_multimap_cursor cursor;
+    int *values;
+    int more;
+    int key;
+    int value;
+    int i;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   bad_hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    key = 1;
+    assert(unordered_multimap_get_values((void **) &values, me, &key) == 0);
+    assert(!values);
+    for (i = 0; i < 1000; i++) {
+        key = i % 4 == 0 ? 2 : 1;
+        assert(unordered_multimap_put(me, &key, &i) == 0);
+    }
+    assert(unordered_multimap_size(me) == 1000);
+    key = 1;
+    assert(unordered_multimap_count(me, &key) == 750);
+    assert(unordered_multimap_get_values((void **) &values, me, &key) == 750);
+    for (i = 0; i < 750; i++) {
+        assert(values[i] == i + i / 3 + 1);
+    }
+    key = 2;
+    unordered_multimap_get_start(me, &key);
+    for (i = 0; i < 250; i++) {
+        value = -1;
+        assert(unordered_multimap_get_next(&value, me));
+        assert(value == 4 * i);
+    }
+    assert(!unordered_multimap_get_next(&value, me));
+    key = 1;
+    for (i = 0; i < 1000; i++) {
+        if (i % 4 != 0 && i % 2 == 0) {
+            assert(unordered_multimap_remove(me, &key, &i));
+        }
+    }
+    value = -1;
+    assert(!unordered_multimap_remove(me, &key, &value));
+    assert(unordered_multimap_get_values((void **) &values, me, &key) == 500);
+    for (i = 0; i < 500; i++) {
+        assert(values[i] == 2 * i + 1);
+    }
+    i = 0;
+    more = unordered_multimap_first(me, &cursor);
+    while (more) {
+        assert(unordered_multimap_cursor_get(&key, &value, me, &cursor));
+        assert(key == (value % 4 == 0 ? 2 : 1));
+        if (value % 3 == 0) {
+            more = unordered_multimap_cursor_remove(me, &cursor);
+        } else {
+            more = unordered_multimap_next(me, &cursor);
+        }
+        i++;
+    }
+    assert(i == 750);
+    assert(unordered_multimap_size(me) == 499);
+    key = 2;
+    assert(unordered_multimap_count(me, &key) == 166);
+    assert(unordered_multimap_remove_all(me, &key));
+    assert(!unordered_multimap_contains(me, &key));
+    assert(unordered_multimap_size(me) == 333);
+    key = 1;
+    assert(unordered_multimap_count(me, &key) == 333);
+    assert(!unordered_multimap_destroy(me));
+}
+
+static void test_seed(void)
+{
+    struct unordered_multimap_cursor one_cursor;
+    struct unordered_multimap_cursor two_cursor;
+    int one_key;
+    int two_key;
+    int is_same = 1;
+    int i;
+    unordered_multimap one = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                    hash_int, compare_int,
+                                                    compare_int);
+    unordered_multimap two = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                    hash_int, compare_int,
+                                                    compare_int);
+    assert(one);
+    assert(two);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multimap_put(one, &i, &i) == 0);
+        assert(unordered_multimap_put(two, &i, &i) == 0);
+    }
+    unordered_multimap_first(one, &one_cursor);
+    unordered_multimap_first(two, &two_cursor);
+    for (i = 0; i < 100; i++) {
+        unordered_multimap_cursor_get(&one_key, NULL, one, &one_cursor);
+        unordered_multimap_cursor_get(&two_key, NULL, two, &two_cursor);
+        if (one_key != two_key) {
+            is_same = 0;
+        }
+        unordered_multimap_next(one, &one_cursor);
+        unordered_multimap_next(two, &two_cursor);
+    }
+    assert(!is_same);
+    assert(!unordered_multimap_destroy(two));
+    assert(!unordered_multimap_destroy(one));
+}
+
+static void test_chain_guard(void)
+{
+    int i;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   bad_hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    assert(unordered_multimap_set_max_chain_length(me, -1) == -EINVAL);
+    assert(unordered_multimap_set_max_chain_length(me, 4) == 0);
+    assert(unordered_multimap_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    assert(unordered_multimap_size(me) == 100);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multimap_contains(me, &i));
+    }
+    assert(!unordered_multimap_destroy(me));
+    me = unordered_multimap_init(sizeof(int), sizeof(int), hash_int,
+                                compare_int, compare_int);
+    assert(me);
+    assert(unordered_multimap_set_max_chain_length(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    fail_calloc = 1;
+    for (i = 1000; i < 1010; i++) {
+        assert(unordered_multimap_put(me, &i, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_multimap_set_max_chain_length(me, 0) == 0);
+    for (i = 0; i < 1010; i++) {
+        assert(unordered_multimap_contains(me, &i));
+    }
+    assert(!unordered_multimap_destroy(me));
+}
+
+static void test_values_cursor(void)
+{
+    struct unordered_multimap_values one;
+    struct unordered_multimap_values two;
+    int key;
+    int value;
+    int i;
+    int j;
+    unordered_multimap me = unordered_multimap_init(sizeof(int), sizeof(int),
+                                                   hash_int, compare_int,
+                                                   compare_int);
+    assert(me);
+    key = 3;
+    assert(unordered_multimap_values_start(me, &one, &key) == 0);
+    assert(!unordered_multimap_values_next(&value, me, &one));
+    for (i = 0; i < 10; i++) {
+        key = i % 2;
+        assert(unordered_multimap_put(me, &key, &i) == 0);
+    }
+    key = 0;
+    assert(unordered_multimap_values_start(me, &one, &key) == 5);
+    key = 1;
+    assert(unordered_multimap_values_start(me, &two, &key) == 5);
+    unordered_multimap_get_start(me, &key);
+    for (i = 0; i < 5; i++) {
+        value = -1;
+        assert(unordered_multimap_values_next(&value, me, &one));
+        assert(value == 2 * i);
+        for (j = 0; j < 2; j++) {
+            value = -1;
+            assert(unordered_multimap_values_next(&value, me, &two));
+            assert(value == 2 * ((2 * i + j) % 5) + 1);
+            if ((2 * i + j) % 5 == 4) {
+                key = 1;
+                assert(unordered_multimap_values_start(me, &two, &key) == 5);
+            }
+        }
+        value = -1;
+        assert(unordered_multimap_get_next(&value, me));
+        assert(value == 2 * i + 1);
+    }
+    assert(!unordered_multimap_values_next(&value, me, &one));
+    assert(!unordered_multimap_get_next(&value, me));
+    assert(!unordered_multimap_destroy(me));
+}
+
 void test_unordered_multimap(void)
 {
     test_invalid_init();
@@ -414,4 +864,13 @@ void test_unordered_multimap(void)
     test_put_out_of_memory();
     test_resize_out_of_memory();
     test_clear_out_of_memory();
+    test_save_load();
+    test_reserve();
+    test_incremental_resize();
+    test_grouped_values();
+    test_shrink();
+    test_cursor();
+    test_seed();
+    test_chain_guard();
+    test_values_cursor();
 }
@@ -1,3 +1,7 @@
+#include <stdio.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
 #include "test.h"
 #include "../src/include/unordered_multiset.h"
 
@@ -321,6 +325,319 @@ static void test_clear_out_of_memory(void)
     assert(!unordered_multiset_destroy(me));
 }
 
+static void test_save_load(void)
+{
+    FILE *const file = tmpfile();
+    int i;
+    int fd;
+    unordered_multiset me;
+    unordered_multiset load;
+    unsigned long count = INT_MAX / 2;
+    assert(file);
+    fd = fileno(file);
+    me = unordered_multiset_init(sizeof(int), hash_int, compare_int);
+    assert(me);
+    for (i = 0; i < 1000; i++) {
+        int j;
+        for (j = 0; j <= i % 3; j++) {
+            assert(unordered_multiset_put(me, &i) == 0);
+        }
+    }
+    assert(unordered_multiset_size(me) == 1999);
+    assert(unordered_multiset_save(me, fd) == 0);
+    assert(unordered_multiset_load(me, fd) == -EINVAL);
+    load = unordered_multiset_init(sizeof(int), hash_int, compare_int);
+    assert(load);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    hash_count = 0;
+    assert(unordered_multiset_load(load, fd) == 0);
+    assert(hash_count == 0);
+    assert(unordered_multiset_size(load) == 1999);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multiset_count(load, &i) == i % 3 + 1);
+    }
+    i = 0;
+    assert(unordered_multiset_remove_all(load, &i));
+    assert(unordered_multiset_size(load) == 1998);
+    assert(unordered_multiset_put(load, &i) == 0);
+    assert(unordered_multiset_size(load) == 1999);
+    assert(unordered_multiset_load(load, fd) == -EINVAL);
+    assert(unordered_multiset_clear(load) == 0);
+    assert(unordered_multiset_load(load, fd) == -EIO);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    fail_malloc = 1;
+    assert(unordered_multiset_load(load, fd) == -ENOMEM);
+    fail_malloc = 1;
+    assert(unordered_multiset_save(me, fd) == -ENOMEM);
+    assert(!unordered_multiset_destroy(load));
+    /* A corrupt count only reserves buckets for the records which exist. */
+    load = unordered_multiset_init(sizeof(int), hash_int, compare_int);
+    assert(load);
+    assert(lseek(fd, (off_t) (8 + 3 * sizeof(unsigned long)), SEEK_SET) > 0);
+    assert(write(fd, &count, sizeof(unsigned long))
+           == (ssize_t) sizeof(unsigned long));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(unordered_multiset_load(load, fd) == -EIO);
+    assert(unordered_multiset_size(load) <= 1999);
+    assert(!unordered_multiset_destroy(load));
+    assert(!unordered_multiset_destroy(me));
+    fclose(file);
+}
+
+static void test_reserve(void)
+{
+    int i;
+    unordered_multiset me = unordered_multiset_init(sizeof(int), hash_int,
+                                                   compare_int);
+    assert(me);
+    assert(unordered_multiset_reserve(me, -1) == -EINVAL);
+    assert(unordered_multiset_reserve(me, INT_MAX) == -EINVAL);
+    fail_calloc = 1;
+    assert(unordered_multiset_reserve(me, 1000) == -ENOMEM);
+    assert(unordered_multiset_reserve(me, 1000) == 0);
+    assert(unordered_multiset_reserve(me, 10) == 0);
+    fail_calloc = 1;
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    assert(unordered_multiset_put(me, &i) == -ENOMEM);
+    assert(unordered_multiset_size(me) == 1000);
+    assert(unordered_multiset_set_max_load_factor(me, 0) == -EINVAL);
+    assert(unordered_multiset_set_max_load_factor(me, -1.0) == -EINVAL);
+    fail_calloc = 1;
+    assert(unordered_multiset_set_max_load_factor(me, 0.25) == -ENOMEM);
+    assert(unordered_multiset_set_max_load_factor(me, 0.25) == 0);
+    assert(unordered_multiset_set_max_load_factor(me, 4.0) == 0);
+    fail_calloc = 1;
+    for (i = 1000; i < 5000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_multiset_size(me) == 5000);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_multiset_contains(me, &i));
+    }
+    assert(!unordered_multiset_destroy(me));
+}
+
+static void test_incremental_resize(void)
+{
+    int i;
+    unordered_multiset me = unordered_multiset_init(sizeof(int), hash_int,
+                                                   compare_int);
+    assert(me);
+    assert(unordered_multiset_set_incremental_resize(me, -1) == -EINVAL);
+    assert(unordered_multiset_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+        assert(unordered_multiset_contains(me, &i));
+    }
+    assert(unordered_multiset_size(me) == 5000);
+    for (i = 0; i < 5000; i += 2) {
+        assert(unordered_multiset_remove(me, &i));
+    }
+    assert(unordered_multiset_size(me) == 2500);
+    for (i = 0; i < 5000; i++) {
+        assert(unordered_multiset_contains(me, &i) == i % 2);
+    }
+    assert(unordered_multiset_set_incremental_resize(me, 3) == 0);
+    for (i = 5000; i < 6000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    hash_count = 0;
+    assert(unordered_multiset_rehash(me) == 0);
+    assert(hash_count == 3500);
+    for (i = 6000; i < 7000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    assert(unordered_multiset_set_incremental_resize(me, 0) == 0);
+    assert(unordered_multiset_size(me) == 4500);
+    for (i = 5000; i < 7000; i++) {
+        assert(unordered_multiset_contains(me, &i));
+    }
+    assert(unordered_multiset_set_incremental_resize(me, 2) == 0);
+    for (i = 7000; i < 20000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    assert(unordered_multiset_clear(me) == 0);
+    assert(unordered_multiset_is_empty(me));
+    for (i = 0; i < 20000; i++) {
+        assert(!unordered_multiset_contains(me, &i));
+    }
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    assert(unordered_multiset_size(me) == 100);
+    assert(!unordered_multiset_destroy(me));
+}
+
+static void test_shrink(void)
+{
+    int i;
+    unordered_multiset me = unordered_multiset_init(sizeof(int), hash_int,
+                                                   compare_int);
+    assert(me);
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    for (i = 10; i < 10000; i++) {
+        assert(unordered_multiset_remove(me, &i));
+    }
+    fail_calloc = 1;
+    assert(unordered_multiset_shrink_to_fit(me) == -ENOMEM);
+    assert(unordered_multiset_shrink_to_fit(me) == 0);
+    fail_calloc = 1;
+    assert(unordered_multiset_shrink_to_fit(me) == 0);
+    fail_calloc = 0;
+    assert(unordered_multiset_size(me) == 10);
+    for (i = 0; i < 10; i++) {
+        assert(unordered_multiset_contains(me, &i));
+    }
+    assert(unordered_multiset_set_min_load_factor(me, -0.1) == -EINVAL);
+    assert(unordered_multiset_set_min_load_factor(me, 0.375) == -EINVAL);
+    assert(unordered_multiset_set_min_load_factor(me, 0.2) == 0);
+    assert(unordered_multiset_set_max_load_factor(me, 0.4) == -EINVAL);
+    assert(unordered_multiset_set_max_load_factor(me, 0.5) == 0);
+    assert(unordered_multiset_set_max_load_factor(me, 0.75) == 0);
+    for (i = 10; i < 10000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multiset_remove(me, &i));
+    }
+    assert(unordered_multiset_is_empty(me));
+    fail_calloc = 1;
+    assert(unordered_multiset_shrink_to_fit(me) == 0);
+    fail_calloc = 0;
+    assert(unordered_multiset_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    for (i = 0; i < 9000; i++) {
+        assert(unordered_multiset_remove(me, &i));
+    }
+    for (i = 0; i < 10000; i++) {
+        assert(unordered_multiset_contains(me, &i) == (i >= 9000));
+    }
+    assert(!unordered_multiset_destroy(me));
+}
+
+static void test_cursor(void)
+{
+    struct unordered_multiset_cursor cursor;
+    char seen[1000];
+    int more;
+    int key;
+    int i;
+    unordered_multiset me = unordered_multiset_init(sizeof(int), hash_int,
+                                                   compare_int);
+    assert(me);
+    assert(!unordered_multiset_first(me, &cursor));
+    assert(!unordered_multiset_next(me, &cursor));
+    assert(!unordered_multiset_cursor_get(&key, me, &cursor));
+    assert(!unordered_multiset_cursor_remove(me, &cursor));
+    assert(unordered_multiset_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    memset(seen, 0, sizeof(seen));
+    more = unordered_multiset_first(me, &cursor);
+    while (more) {
+        assert(unordered_multiset_cursor_get(&key, me, &cursor) == 2);
+        assert(!seen[key]);
+        seen[key] = 1;
+        if (key % 2) {
+            more = unordered_multiset_cursor_remove(me, &cursor);
+        } else {
+            more = unordered_multiset_next(me, &cursor);
+        }
+    }
+    for (i = 0; i < 1000; i++) {
+        assert(seen[i]);
+        assert(unordered_multiset_contains(me, &i) == !(i % 2));
+    }
+    assert(unordered_multiset_size(me) == 1000);
+    i = 0;
+    more = unordered_multiset_first(me, &cursor);
+    while (more) {
+        more = unordered_multiset_cursor_remove(me, &cursor);
+        i++;
+    }
+    assert(i == 500);
+    assert(unordered_multiset_is_empty(me));
+    assert(!unordered_multiset_destroy(me));
+}
+
+static void test_seed(void)
+{
+    struct unordered_multiset_cursor one_cursor;
+    struct unordered_multiset_cursor two_cursor;
+    int one_key;
+    int two_key;
+    int is_same = 1;
+    int i;
+    unordered_multiset one = unordered_multiset_init(sizeof(int), hash_int,
+                                                    compare_int);
+    unordered_multiset two = unordered_multiset_init(sizeof(int), hash_int,
+                                                    compare_int);
+    assert(one);
+    assert(two);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multiset_put(one, &i) == 0);
+        assert(unordered_multiset_put(two, &i) == 0);
+    }
+    unordered_multiset_first(one, &one_cursor);
+    unordered_multiset_first(two, &two_cursor);
+    for (i = 0; i < 100; i++) {
+        unordered_multiset_cursor_get(&one_key, one, &one_cursor);
+        unordered_multiset_cursor_get(&two_key, two, &two_cursor);
+        if (one_key != two_key) {
+            is_same = 0;
+        }
+        unordered_multiset_next(one, &one_cursor);
+        unordered_multiset_next(two, &two_cursor);
+    }
+    assert(!is_same);
+    assert(!unordered_multiset_destroy(two));
+    assert(!unordered_multiset_destroy(one));
+}
+
+static void test_chain_guard(void)
+{
+    int i;
+    unordered_multiset me = unordered_multiset_init(sizeof(int), bad_hash_int,
+                                                   compare_int);
+    assert(me);
+    assert(unordered_multiset_set_max_chain_length(me, -1) == -EINVAL);
+    assert(unordered_multiset_set_max_chain_length(me, 4) == 0);
+    assert(unordered_multiset_set_incremental_resize(me, 1) == 0);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    assert(unordered_multiset_size(me) == 100);
+    for (i = 0; i < 100; i++) {
+        assert(unordered_multiset_contains(me, &i));
+    }
+    assert(!unordered_multiset_destroy(me));
+    me = unordered_multiset_init(sizeof(int), hash_int, compare_int);
+    assert(me);
+    assert(unordered_multiset_set_max_chain_length(me, 1) == 0);
+    for (i = 0; i < 1000; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    fail_calloc = 1;
+    for (i = 1000; i < 1010; i++) {
+        assert(unordered_multiset_put(me, &i) == 0);
+    }
+    fail_calloc = 0;
+    assert(unordered_multiset_set_max_chain_length(me, 0) == 0);
+    for (i = 0; i < 1010; i++) {
+        assert(unordered_multiset_contains(me, &i));
+    }
+    assert(!unordered_multiset_destroy(me));
+}
+
 void test_unordered_multiset(void)
 {
     test_invalid_init();
@@ -332,4 +649,11 @@ void test_unordered_multiset(void)
     test_put_out_of_memory();
     test_resize_out_of_memory();
     test_clear_out_of_memory();
+    test_save_load();
+    test_reserve();
+    test_incremental_resize();
+    test_shrink();
+    test_cursor();
+    test_seed();
+    test_chain_guard();
 }
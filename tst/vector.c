@@ -1,6 +1,9 @@
+#include <stdio.h>
+#include <limits.h>
 #include <string.h>
 #include "test.h"
 #include "../src/include/vector.h"
+#include "../src/include/compare.h"
 
 static void test_invalid_init(void)
 {
@@ -266,6 +269,270 @@ static void test_add_out_of_memory(void)
     assert(!vector_destroy(me));
 }
 
+static void test_mapped_flags(const int flags)
+{
+    vector me = vector_init_mapped(sizeof(int), flags);
+    int capacity;
+    int *data;
+    int i;
+    assert(me);
+    assert(vector_is_empty(me));
+    assert(vector_capacity(me) >= 8);
+    for (i = 0; i < 100000; i++) {
+        assert(vector_add_last(me, &i) == 0);
+    }
+    assert(vector_size(me) == 100000);
+    assert(vector_capacity(me) >= vector_size(me));
+    data = vector_get_data(me);
+    for (i = 0; i < 100000; i++) {
+        assert(data[i] == i);
+    }
+    for (i = 0; i < 90000; i++) {
+        vector_remove_last(me);
+    }
+    capacity = vector_capacity(me);
+    assert(vector_trim(me) == 0);
+    assert(vector_capacity(me) >= 10000);
+    assert(vector_capacity(me) <= capacity);
+    for (i = 0; i < 10000; i++) {
+        int get = 0xdeadbeef;
+        vector_get_at(&get, me, i);
+        assert(get == i);
+    }
+    assert(vector_reserve(me, 200000) == 0);
+    assert(vector_capacity(me) >= 200000);
+    i = -1;
+    assert(vector_add_first(me, &i) == 0);
+    data = vector_get_data(me);
+    assert(data[0] == -1);
+    assert(data[10000] == 9999);
+    assert(vector_clear(me) == 0);
+    assert(vector_is_empty(me));
+    assert(!vector_destroy(me));
+}
+
+static void test_mapped(void)
+{
+    assert(!vector_init_mapped(0, 0));
+    test_mapped_flags(0);
+    test_mapped_flags(VECTOR_HUGE_PAGES);
+    fail_malloc = 1;
+    assert(!vector_init_mapped(sizeof(int), 0));
+}
+
+/*
+ * Overwrites the item count in the header of a mapped file, which follows the
+ * magic bytes and the element size.
+ */
+static void set_mapped_count(const char *const path, const unsigned long count)
+{
+    FILE *const file = fopen(path, "r+b");
+    assert(file);
+    assert(fseek(file, (long) (8 + sizeof(unsigned long)), SEEK_SET) == 0);
+    assert(fwrite(&count, sizeof(count), 1, file) == 1);
+    assert(fclose(file) == 0);
+}
+
+static void test_open_mapped(void)
+{
+    const char *const path = "test_vector_mapped.bin";
+    vector me;
+    int *data;
+    int i;
+    remove(path);
+    assert(!vector_open_mapped(NULL, sizeof(int), VECTOR_CREATE));
+    assert(!vector_open_mapped(path, 0, VECTOR_CREATE));
+    assert(!vector_open_mapped(path, sizeof(int), 0));
+    assert(!vector_open_mapped(path, sizeof(int), VECTOR_READ_ONLY));
+    me = vector_open_mapped(path, sizeof(int), VECTOR_CREATE);
+    assert(me);
+    assert(vector_is_empty(me));
+    for (i = 0; i < 10000; i++) {
+        assert(vector_add_last(me, &i) == 0);
+    }
+    assert(vector_sync(me) == 0);
+    assert(!vector_destroy(me));
+    assert(!vector_open_mapped(path, sizeof(long) + 1, 0));
+    set_mapped_count(path, 1000000);
+    assert(!vector_open_mapped(path, sizeof(int), 0));
+    set_mapped_count(path, (unsigned long) INT_MAX + 1);
+    assert(!vector_open_mapped(path, sizeof(int), 0));
+    set_mapped_count(path, 10000);
+    me = vector_open_mapped(path, sizeof(int), 0);
+    assert(me);
+    assert(vector_size(me) == 10000);
+    data = vector_get_data(me);
+    for (i = 0; i < 10000; i++) {
+        assert(data[i] == i);
+    }
+    for (i = 0; i < 5000; i++) {
+        vector_remove_last(me);
+    }
+    assert(vector_trim(me) == 0);
+    assert(!vector_destroy(me));
+    me = vector_open_mapped(path, sizeof(int), VECTOR_READ_ONLY);
+    assert(me);
+    assert(vector_size(me) == 5000);
+    assert(vector_sync(me) == 0);
+    i = -1;
+    assert(vector_set_first(me, &i) == 0);
+    for (i = 0; i < 10000; i++) {
+        assert(vector_add_last(me, &i) == 0);
+    }
+    assert(vector_size(me) == 15000);
+    data = vector_get_data(me);
+    assert(data[0] == -1);
+    assert(data[4999] == 4999);
+    assert(data[5000] == 0);
+    assert(!vector_destroy(me));
+    me = vector_open_mapped(path, sizeof(int), VECTOR_READ_ONLY);
+    assert(me);
+    assert(vector_size(me) == 5000);
+    data = vector_get_data(me);
+    for (i = 0; i < 5000; i++) {
+        assert(data[i] == i);
+    }
+    assert(!vector_destroy(me));
+    me = vector_open_mapped(path, sizeof(int), VECTOR_HUGE_PAGES);
+    assert(me);
+    assert(vector_clear(me) == 0);
+    assert(!vector_destroy(me));
+    me = vector_open_mapped(path, sizeof(int), 0);
+    assert(me);
+    assert(vector_is_empty(me));
+    assert(!vector_destroy(me));
+    fail_malloc = 1;
+    assert(!vector_open_mapped(path, sizeof(int), 0));
+    remove(path);
+}
+
+static int compare_descending(const void *const one, const void *const two)
+{
+    const int a = *(const int *) one;
+    const int b = *(const int *) two;
+    return (b > a) - (b < a);
+}
+
+static void test_sorting(void)
+{
+    int i;
+    int value;
+    int *data;
+    vector me = vector_init(sizeof(int));
+    assert(me);
+    vector_sort(me, containers_compare_int);
+    for (i = 0; i < 1000; i++) {
+        value = i * 37 % 1000 - 500;
+        assert(vector_add_last(me, &value) == 0);
+    }
+    vector_sort(me, containers_compare_int);
+    data = vector_get_data(me);
+    for (i = 0; i < 1000; i++) {
+        assert(data[i] == i - 500);
+    }
+    vector_sort(me, compare_descending);
+    for (i = 0; i < 1000; i++) {
+        assert(data[i] == 499 - i);
+    }
+    assert(!vector_destroy(me));
+}
+
+static void test_searching(void)
+{
+    int i;
+    int key;
+    int index;
+    int *data;
+    vector me = vector_init(sizeof(int));
+    assert(me);
+    key = 5;
+    assert(vector_lower_bound(me, &key, containers_compare_int) == 0);
+    assert(vector_eytzinger_layout(me) == 0);
+    assert(vector_eytzinger_lower_bound(me, &key, containers_compare_int)
+           == 0);
+    for (i = 0; i < 1000; i++) {
+        key = 999 - i;
+        assert(vector_add_last(me, &key) == 0);
+    }
+    key = 400;
+    assert(vector_lower_bound(me, &key, compare_descending) == 599);
+    vector_sort(me, containers_compare_int);
+    assert(vector_lower_bound(me, &key, containers_compare_int) == 400);
+    fail_malloc = 1;
+    assert(vector_eytzinger_layout(me) == -ENOMEM);
+    assert(vector_eytzinger_layout(me) == 0);
+    data = vector_get_data(me);
+    for (key = -1; key < 1000; key++) {
+        index = vector_eytzinger_lower_bound(me, &key, containers_compare_int);
+        assert(data[index] == (key < 0 ? 0 : key));
+    }
+    assert(vector_eytzinger_lower_bound(me, &key, containers_compare_int)
+           == 1000);
+    assert(!vector_destroy(me));
+}
+
+static void test_parallel_sort(void)
+{
+    unsigned long seed = 1;
+    long sum = 0;
+    int thread_count;
+    int i;
+    int *data;
+    vector me = vector_init(sizeof(int));
+    assert(me);
+    assert(vector_parallel_sort(me, compare_descending, -1) == -EINVAL);
+    assert(vector_parallel_sort(me, compare_descending, 4) == 0);
+    for (i = 0; i < 400000; i++) {
+        int value;
+        seed = seed * 1103515245UL + 12345UL;
+        value = (int) ((seed >> 8) & 0xfffff);
+        sum += value;
+        assert(vector_add_last(me, &value) == 0);
+    }
+    fail_malloc = 1;
+    assert(vector_parallel_sort(me, compare_descending, 4) == -ENOMEM);
+    for (thread_count = 0; thread_count <= 7; thread_count++) {
+        long total = 0;
+        assert(vector_parallel_sort(me, compare_descending, thread_count) == 0);
+        data = vector_get_data(me);
+        for (i = 0; i < 400000; i++) {
+            total += data[i];
+            if (i > 0) {
+                assert(data[i - 1] >= data[i]);
+            }
+        }
+        assert(total == sum);
+        for (i = 0; i < 400000; i++) {
+            const int other = (int) ((unsigned long) i * 7919 % 400000);
+            const int temp = data[i];
+            data[i] = data[other];
+            data[other] = temp;
+        }
+    }
+    assert(vector_parallel_sort(me, containers_compare_int, 3) == 0);
+    data = vector_get_data(me);
+    for (i = 1; i < 400000; i++) {
+        assert(data[i - 1] <= data[i]);
+    }
+    assert(!vector_destroy(me));
+    me = vector_init(3);
+    assert(me);
+    for (i = 0; i < 100000; i++) {
+        unsigned char bytes[3];
+        seed = seed * 1103515245UL + 12345UL;
+        bytes[0] = (unsigned char) (seed >> 8);
+        bytes[1] = (unsigned char) (seed >> 16);
+        bytes[2] = (unsigned char) (seed >> 24);
+        assert(vector_add_last(me, bytes) == 0);
+    }
+    assert(vector_parallel_sort(me, containers_compare_key, 4) == 0);
+    for (i = 1; i < 100000; i++) {
+        const unsigned char *const bytes = vector_get_data(me);
+        assert(memcmp(bytes + 3 * (i - 1), bytes + 3 * i, 3) <= 0);
+    }
+    assert(!vector_destroy(me));
+}
+
 void test_vector(void)
 {
     test_invalid_init();
@@ -275,4 +542,9 @@ void test_vector(void)
     test_init_out_of_memory();
     test_set_space_out_of_memory();
     test_add_out_of_memory();
+    test_mapped();
+    test_open_mapped();
+    test_sorting();
+    test_searching();
+    test_parallel_sort();
 }